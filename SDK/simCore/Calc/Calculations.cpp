@@ -25,6 +25,8 @@
 #include <iomanip>
 #include <iostream>
 #include <algorithm>
+#include <functional>
+#include <vector>
 #include <time.h>
 
 #include "simNotify/Notify.h"
@@ -34,6 +36,8 @@
 #include "simCore/Calc/CoordinateConverter.h"
 #include "simCore/Calc/CoordinateSystem.h"
 #include "simCore/Calc/Calculations.h"
+#include "simCore/Calc/Geodesic.h"
+#include "simCore/System/ParallelRanges.h"
 
 namespace
 {
@@ -112,6 +116,20 @@ void calculateRelAzEl(const Vec3 &fromLla, const Vec3 &fromOriLla, const Vec3 &t
 
 }
 
+void calculateRelAzEl(const LocalFrame& fromFrame, const Vec3 &fromOriLla, const Vec3 &toLla, double *azim, double *elev, double *cmp)
+{
+  assert(azim || elev || cmp);
+  if (!azim && !elev && !cmp)
+  {
+    SIM_ERROR << "calculateRelAzEl, invalid angles: " << __LINE__ << std::endl;
+    return;
+  }
+
+  Vec3 enuPos;
+  fromFrame.geodeticToEnu(toLla, enuPos);
+  calculateRelAng(enuPos, fromOriLla, azim, elev, cmp);
+}
+
 /**
 * Calculates the absolute azimuth, elevation, and composite angles from one entity to another in the given coordinate frame.
 * The calculation is performed with 0 degrees at true north
@@ -194,6 +212,31 @@ void calculateAbsAzEl(const Vec3 &fromLla, const Vec3 &toLla, double *azim, doub
   }
 }
 
+void calculateAbsAzEl(const LocalFrame& fromFrame, const Vec3 &toLla, double *azim, double *elev, double *cmp)
+{
+  assert(azim || elev || cmp);
+  if (!azim && !elev && !cmp)
+  {
+    SIM_ERROR << "calculateAbsAzEl, invalid angles: " << __LINE__ << std::endl;
+    return;
+  }
+
+  Vec3 ENUDelta;
+  fromFrame.geodeticToEnu(toLla, ENUDelta);
+
+  if (azim)
+    *azim = angFix2PI(atan2(ENUDelta[0], ENUDelta[1]));
+
+  if (elev)
+    *elev = atan2(ENUDelta[2], sqrt(ENUDelta[0]*ENUDelta[0] + ENUDelta[1]*ENUDelta[1]));
+
+  if (cmp)
+  {
+    Vec3 northVector(0.0, 1.0, 0.0);
+    *cmp = v3Angle(northVector, ENUDelta);
+  }
+}
+
 /**
 * Calculates the slant distance between two positions in space in the given coordinate system.  Order of entities (from/to)
 * will not affect the calculation.
@@ -282,6 +325,13 @@ double calculateSlant(const Vec3 &fromLla, const Vec3 &toLla, const EarthModelCa
   return v3Distance(toPos.position(), fromPos.position());
 }
 
+double calculateSlant(const LocalFrame& fromFrame, const Vec3 &toLla)
+{
+  Vec3 toEcef;
+  CoordinateConverter::convertGeodeticPosToEcef(toLla, toEcef);
+  return v3Distance(toEcef, fromFrame.originEcef());
+}
+
 /**
 * Calculates the ground distance from one object to another.  This is calculated by "dropping a line" to the surface of the
 * earth for both entities and calculating the distance of the line that connects the two surface points.  Order of the entities
@@ -428,6 +478,32 @@ void calculateDRCRDownValue(const Vec3 &fromLla, const double &yaw, const Vec3 &
     *crossRng = downRangeCrossRangeHypotenuse * sin(downRangeCrossRangeAngle);
 }
 
+void calculateDRCRDownValue(const LocalFrame& fromFrame, double yaw, const Vec3 &toLla, double* downRng, double* crossRng, double* downValue)
+{
+  assert(downRng || crossRng || downValue);
+  if (!downRng && !crossRng && !downValue)
+  {
+    SIM_ERROR << "calculateDRCRDownValue, invalid ranges: " << __LINE__ << std::endl;
+    return;
+  }
+
+  Vec3 enuPos;
+  fromFrame.geodeticToEnu(toLla, enuPos);
+
+  // Equal to the slant distance times the sine of the true elevation
+  if (downValue)
+    *downValue = enuPos.z();
+
+  // Rotate the horizontal offset by the yaw, rather than going through the true azimuth
+  const double cosYaw = cos(yaw);
+  const double sinYaw = sin(yaw);
+  if (downRng)
+    *downRng = enuPos.y() * cosYaw + enuPos.x() * sinYaw;
+
+  if (crossRng)
+    *crossRng = enuPos.x() * cosYaw - enuPos.y() * sinYaw;
+}
+
 /**
 * Calculates the closing velocity, which is the velocity at which the from and to entity are moving towards one another.  Closing
 * velocity is positive when the distance between two entities is decreasing (moving towards one another), and negative when moving apart.
@@ -1766,4 +1842,302 @@ bool laserInGate(const simCore::Vec3& gateHostLLA, const simCore::Vec3& laserHos
   return false;
 }
 
+//------------------------------------------------------------------------
+// One to many relative geometry
+
+/// Fewest entities worth giving a thread of their own
+static const size_t RELATIVE_GEOMETRY_MIN_PER_THREAD = 4096;
+/// Entities per block of intermediate arrays
+static const size_t RELATIVE_GEOMETRY_BLOCK_SIZE = 512;
+
+/// Input arrays that do not alias the outputs, so loops over blocks vectorize
+typedef const double* __restrict RelativeGeometryInArray;
+/// Output arrays that do not alias the inputs
+typedef double* __restrict RelativeGeometryOutArray;
+
+namespace
+{
+  /// Values of the 'from' entity shared by every 'to' entity
+  struct RelativeGeometryHost
+  {
+    EarthModelCalculations model = WGS_84;
+    const CoordinateConverter* coordConv = nullptr;
+    Vec3 lla;
+    /// Tangent plane at the 'from' entity, for the WGS-84 models
+    LocalFrame frame;
+    /// WGS-84 geodesics for ground distance
+    Geodesic geodesic;
+    /// Velocity in ECEF for the WGS-84 models, or in the flat earth ENU frame
+    Vec3 vel;
+    /// Position in the flat earth ENU frame
+    Vec3 flatEnu;
+    /// Flat earth centered on the 'from' entity, for flat earth closing velocity as calculateClosingVelocity() does
+    CoordinateConverter closingConv;
+    /// Rotation from NED to the body frame of the 'from' entity
+    double nedToBody[3][3];
+    /// Body X unit vector of the 'from' entity, NED
+    Vec3 bodyUnitX;
+    /// True if the ECEF offsets of the 'to' entities are needed
+    bool needEcef = false;
+  };
+
+  /// Fills the requested results for a range of 'to' entities
+  void calculateRelativeGeometryRange(const RelativeGeometryHost& host, const RelativeGeometryTargets& targets, const RelativeGeometryResults& results, size_t begin, size_t end)
+  {
+    const bool wgs84 = (host.model != FLAT_EARTH);
+    const bool needEnu = !results.slant.empty() || !results.groundDistance.empty() || !results.relAzimuth.empty() ||
+      !results.relElevation.empty() || !results.relComposite.empty();
+
+    // Per block: latitude and longitude sines and cosines, ECEF offset, local ENU offset, distance, and flat earth offset for closing velocity
+    std::vector<double> scratch(14 * RELATIVE_GEOMETRY_BLOCK_SIZE);
+    const RelativeGeometryOutArray sinLat = scratch.data();
+    const RelativeGeometryOutArray cosLat = sinLat + RELATIVE_GEOMETRY_BLOCK_SIZE;
+    const RelativeGeometryOutArray sinLon = cosLat + RELATIVE_GEOMETRY_BLOCK_SIZE;
+    const RelativeGeometryOutArray cosLon = sinLon + RELATIVE_GEOMETRY_BLOCK_SIZE;
+    const RelativeGeometryOutArray dx = cosLon + RELATIVE_GEOMETRY_BLOCK_SIZE;
+    const RelativeGeometryOutArray dy = dx + RELATIVE_GEOMETRY_BLOCK_SIZE;
+    const RelativeGeometryOutArray dz = dy + RELATIVE_GEOMETRY_BLOCK_SIZE;
+    const RelativeGeometryOutArray east = dz + RELATIVE_GEOMETRY_BLOCK_SIZE;
+    const RelativeGeometryOutArray north = east + RELATIVE_GEOMETRY_BLOCK_SIZE;
+    const RelativeGeometryOutArray up = north + RELATIVE_GEOMETRY_BLOCK_SIZE;
+    const RelativeGeometryOutArray range = up + RELATIVE_GEOMETRY_BLOCK_SIZE;
+    const RelativeGeometryOutArray closingEast = range + RELATIVE_GEOMETRY_BLOCK_SIZE;
+    const RelativeGeometryOutArray closingNorth = closingEast + RELATIVE_GEOMETRY_BLOCK_SIZE;
+    const RelativeGeometryOutArray closingUp = closingNorth + RELATIVE_GEOMETRY_BLOCK_SIZE;
+
+    const Vec3& hostEcef = host.frame.originEcef();
+    double ecefToEnu[3][3];
+    host.frame.localToEarthMatrix(LOCAL_LEVEL_FRAME_ENU, ecefToEnu);
+
+    for (size_t first = begin; first < end; first += RELATIVE_GEOMETRY_BLOCK_SIZE)
+    {
+      const size_t count = std::min(RELATIVE_GEOMETRY_BLOCK_SIZE, end - first);
+      const RelativeGeometryInArray lat = targets.lla.x.data() + first;
+      const RelativeGeometryInArray lon = targets.lla.y.data() + first;
+      const RelativeGeometryInArray alt = targets.lla.z.data() + first;
+
+      if (host.needEcef)
+      {
+        for (size_t ii = 0; ii < count; ++ii)
+        {
+          sinLat[ii] = sin(lat[ii]);
+          cosLat[ii] = cos(lat[ii]);
+          sinLon[ii] = sin(lon[ii]);
+          cosLon[ii] = cos(lon[ii]);
+        }
+        for (size_t ii = 0; ii < count; ++ii)
+        {
+          const double rN = WGS_A / sqrt(1.0 - WGS_ESQ * sinLat[ii] * sinLat[ii]);
+          const double horizontal = (rN + alt[ii]) * cosLat[ii];
+          dx[ii] = cosLon[ii] * horizontal - hostEcef.x();
+          dy[ii] = sinLon[ii] * horizontal - hostEcef.y();
+          dz[ii] = (WGS_ESQC * rN + alt[ii]) * sinLat[ii] - hostEcef.z();
+        }
+      }
+
+      if (needEnu)
+      {
+        if (wgs84)
+        {
+          // Same as X-East from the 'from' entity
+          for (size_t ii = 0; ii < count; ++ii)
+          {
+            east[ii] = ecefToEnu[0][0] * dx[ii] + ecefToEnu[0][1] * dy[ii] + ecefToEnu[0][2] * dz[ii];
+            north[ii] = ecefToEnu[1][0] * dx[ii] + ecefToEnu[1][1] * dy[ii] + ecefToEnu[1][2] * dz[ii];
+            up[ii] = ecefToEnu[2][0] * dx[ii] + ecefToEnu[2][1] * dy[ii] + ecefToEnu[2][2] * dz[ii];
+          }
+        }
+        else
+        {
+          const PositionSpans<const double> llaBlock = { std::span<const double>(lat, count), std::span<const double>(lon, count), std::span<const double>(alt, count) };
+          host.coordConv->convertPositions(COORD_SYS_LLA, llaBlock, COORD_SYS_ENU, { std::span<double>(east, count), std::span<double>(north, count), std::span<double>(up, count) });
+          for (size_t ii = 0; ii < count; ++ii)
+          {
+            east[ii] -= host.flatEnu.x();
+            north[ii] -= host.flatEnu.y();
+            up[ii] -= host.flatEnu.z();
+          }
+        }
+        for (size_t ii = 0; ii < count; ++ii)
+          range[ii] = sqrt(east[ii] * east[ii] + north[ii] * north[ii] + up[ii] * up[ii]);
+      }
+
+      if (!results.slant.empty())
+      {
+        const RelativeGeometryOutArray slant = results.slant.data() + first;
+        for (size_t ii = 0; ii < count; ++ii)
+          slant[ii] = range[ii];
+      }
+
+      if (!results.groundDistance.empty())
+      {
+        const RelativeGeometryOutArray ground = results.groundDistance.data() + first;
+        if (host.model == WGS_84)
+        {
+          // Same as sodanoInverse(), with the 'from' entity terms calculated once
+          const double hostLat = host.lla.lat();
+          const double hostLon = host.lla.lon();
+          const GeodesicInverseInputs pairs = { std::span<const double>(&hostLat, 1), std::span<const double>(&hostLon, 1), std::span<const double>(lat, count), std::span<const double>(lon, count) };
+          host.geodesic.inverse(pairs, { std::span<double>(ground, count), {}, {} }, Geodesic::GEODESIC_SODANO);
+        }
+        else
+        {
+          for (size_t ii = 0; ii < count; ++ii)
+            ground[ii] = sqrt(east[ii] * east[ii] + north[ii] * north[ii]);
+        }
+      }
+
+      if (!results.relAzimuth.empty() || !results.relElevation.empty() || !results.relComposite.empty())
+      {
+        // As calculateRelAng(): the NED pointing vector rotated into the body frame of the 'from' entity
+        for (size_t ii = 0; ii < count; ++ii)
+        {
+          Vec3 pntVec(1.0, 0.0, 0.0);
+          if (range[ii] > 0.0)
+            pntVec.set(north[ii] / range[ii], east[ii] / range[ii], -up[ii] / range[ii]);
+          if (!results.relAzimuth.empty() || !results.relElevation.empty())
+          {
+            Vec3 body;
+            d3Mv3Mult(host.nedToBody, pntVec, body);
+            double az;
+            double el;
+            calculateYawPitchFromBodyUnitX(body, az, el);
+            if (!results.relAzimuth.empty())
+              results.relAzimuth[first + ii] = az;
+            if (!results.relElevation.empty())
+              results.relElevation[first + ii] = el;
+          }
+          if (!results.relComposite.empty())
+            results.relComposite[first + ii] = v3Angle(host.bodyUnitX, pntVec);
+        }
+      }
+
+      if (!results.closingVelocity.empty())
+      {
+        const RelativeGeometryInArray velX = targets.velocity.x.data() + first;
+        const RelativeGeometryInArray velY = targets.velocity.y.data() + first;
+        const RelativeGeometryInArray velZ = targets.velocity.z.data() + first;
+        const RelativeGeometryOutArray closing = results.closingVelocity.data() + first;
+        if (wgs84)
+        {
+          // ENU velocities of the 'to' entities rotated to ECEF, along the ECEF line of sight
+          for (size_t ii = 0; ii < count; ++ii)
+          {
+            const double vx = -sinLon[ii] * velX[ii] - sinLat[ii] * cosLon[ii] * velY[ii] + cosLat[ii] * cosLon[ii] * velZ[ii];
+            const double vy = cosLon[ii] * velX[ii] - sinLat[ii] * sinLon[ii] * velY[ii] + cosLat[ii] * sinLon[ii] * velZ[ii];
+            const double vz = cosLat[ii] * velY[ii] + sinLat[ii] * velZ[ii];
+            const double length = sqrt(dx[ii] * dx[ii] + dy[ii] * dy[ii] + dz[ii] * dz[ii]);
+            const double dot = (host.vel.x() - vx) * dx[ii] + (host.vel.y() - vy) * dy[ii] + (host.vel.z() - vz) * dz[ii];
+            closing[ii] = (length > 0.0) ? dot / length : 0.0;
+          }
+        }
+        else
+        {
+          // The 'from' entity is at the origin of closingConv
+          const PositionSpans<const double> llaBlock = { std::span<const double>(lat, count), std::span<const double>(lon, count), std::span<const double>(alt, count) };
+          host.closingConv.convertPositions(COORD_SYS_LLA, llaBlock, COORD_SYS_ENU, { std::span<double>(closingEast, count), std::span<double>(closingNorth, count), std::span<double>(closingUp, count) });
+          for (size_t ii = 0; ii < count; ++ii)
+          {
+            const double length = sqrt(closingEast[ii] * closingEast[ii] + closingNorth[ii] * closingNorth[ii] + closingUp[ii] * closingUp[ii]);
+            const double dot = (host.vel.x() - velX[ii]) * closingEast[ii] + (host.vel.y() - velY[ii]) * closingNorth[ii] + (host.vel.z() - velZ[ii]) * closingUp[ii];
+            closing[ii] = (length > 0.0) ? dot / length : 0.0;
+          }
+        }
+      }
+
+      if (!results.aspectAngle.empty())
+      {
+        // As calculateAspectAngle(): the body X axis of the 'to' entity in ECEF against the ECEF line of sight
+        const RelativeGeometryInArray yaw = targets.yaw.data() + first;
+        const RelativeGeometryInArray pitch = targets.pitch.data() + first;
+        const RelativeGeometryOutArray aspect = results.aspectAngle.data() + first;
+        for (size_t ii = 0; ii < count; ++ii)
+        {
+          const double bodyN = cos(yaw[ii]) * cos(pitch[ii]);
+          const double bodyE = sin(yaw[ii]) * cos(pitch[ii]);
+          const double bodyU = sin(pitch[ii]);
+          const double bodyX = -sinLat[ii] * cosLon[ii] * bodyN - sinLon[ii] * bodyE + cosLat[ii] * cosLon[ii] * bodyU;
+          const double bodyY = -sinLat[ii] * sinLon[ii] * bodyN + cosLon[ii] * bodyE + cosLat[ii] * sinLon[ii] * bodyU;
+          const double bodyZ = cosLat[ii] * bodyN + sinLat[ii] * bodyU;
+          const double length = sqrt(dx[ii] * dx[ii] + dy[ii] * dy[ii] + dz[ii] * dz[ii]);
+          const double dot = (length > 0.0) ? (dx[ii] * bodyX + dy[ii] * bodyY + dz[ii] * bodyZ) / length : 0.0;
+          aspect[ii] = inverseCosine(-dot);
+        }
+      }
+    }
+  }
+}
+
+int calculateRelativeGeometry(const Vec3& fromLla, const Vec3& fromOriLla, const Vec3& fromVel, const RelativeGeometryTargets& targets,
+  const EarthModelCalculations model, const CoordinateConverter* coordConv, const RelativeGeometryResults& results, unsigned int numThreads)
+{
+  const size_t count = targets.lla.size();
+  const auto sizeOk = [count](size_t size) { return size == 0 || size == count; };
+  if (targets.lla.y.size() != count || targets.lla.z.size() != count || !sizeOk(results.slant.size()) || !sizeOk(results.groundDistance.size()) ||
+    !sizeOk(results.relAzimuth.size()) || !sizeOk(results.relElevation.size()) || !sizeOk(results.relComposite.size()) ||
+    !sizeOk(results.closingVelocity.size()) || !sizeOk(results.aspectAngle.size()))
+  {
+    SIM_ERROR << "calculateRelativeGeometry, array sizes differ: " << __LINE__ << std::endl;
+    return 1;
+  }
+  if (!results.closingVelocity.empty() && (targets.velocity.x.size() != count || targets.velocity.y.size() != count || targets.velocity.z.size() != count))
+  {
+    SIM_ERROR << "calculateRelativeGeometry, closing velocity needs a velocity for each entity: " << __LINE__ << std::endl;
+    return 1;
+  }
+  if (!results.aspectAngle.empty() && (targets.yaw.size() != count || targets.pitch.size() != count))
+  {
+    SIM_ERROR << "calculateRelativeGeometry, aspect angle needs a yaw and pitch for each entity: " << __LINE__ << std::endl;
+    return 1;
+  }
+  if (model != WGS_84 && model != TANGENT_PLANE_WGS_84 && model != FLAT_EARTH)
+  {
+    SIM_ERROR << "calculateRelativeGeometry, unsupported earth model: " << __LINE__ << std::endl;
+    return 1;
+  }
+  if (model == FLAT_EARTH && (!coordConv || !coordConv->hasReferenceOrigin()))
+  {
+    SIM_ERROR << "calculateRelativeGeometry, CoordinateConverter not set for FLAT_EARTH: " << __LINE__ << std::endl;
+    return 1;
+  }
+
+  RelativeGeometryHost host;
+  host.model = model;
+  host.coordConv = coordConv;
+  host.lla = fromLla;
+  host.frame.setOrigin(fromLla);
+  d3EulertoDCM(fromOriLla, host.nedToBody);
+  calculateBodyUnitX(fromOriLla.yaw(), fromOriLla.pitch(), host.bodyUnitX);
+  host.needEcef = (model != FLAT_EARTH) || !results.aspectAngle.empty();
+  if (model == FLAT_EARTH)
+  {
+    const std::optional<Coordinate> fromEnu = coordConv->convert(Coordinate(COORD_SYS_LLA, fromLla), COORD_SYS_ENU);
+    if (fromEnu)
+      host.flatEnu = fromEnu->position();
+    host.vel = fromVel;
+    if (!results.closingVelocity.empty())
+      host.closingConv.setReferenceOrigin(fromLla);
+  }
+  else
+  {
+    double enuToEcef[3][3];
+    host.frame.localToEarthMatrix(LOCAL_LEVEL_FRAME_ENU, enuToEcef);
+    d3MTv3Mult(enuToEcef, fromVel, host.vel);
+  }
+
+  const size_t maxRanges = (count + RELATIVE_GEOMETRY_MIN_PER_THREAD - 1) / RELATIVE_GEOMETRY_MIN_PER_THREAD;
+  const size_t numRanges = std::min<size_t>(std::max(numThreads, 1u), maxRanges);
+  if (numRanges <= 1)
+  {
+    calculateRelativeGeometryRange(host, targets, results, 0, count);
+    return 0;
+  }
+
+  runRanges(count, numRanges, [&host, &targets, &results](size_t begin, size_t end)
+    {
+      calculateRelativeGeometryRange(host, targets, results, begin, end);
+    });
+  return 0;
+}
+
 }
@@ -29,6 +29,7 @@
 * radians for latitude/longitude and other angles, and meters per second for velocity.
 */
 
+#include <span>
 #include "simCore/Common/Common.h"
 #include "simCore/Calc/NumericalAnalysis.h"
 #include "simCore/Calc/CoordinateConverter.h"
@@ -53,6 +54,20 @@ namespace simCore
   */
   SDKCORE_EXPORT void calculateRelAzEl(const Vec3 &fromLla, const Vec3 &fromOriLla, const Vec3 &toLla, double* azim, double* elev, double* cmp, const EarthModelCalculations model, const CoordinateConverter* coordConv);
 
+  /**
+  * @brief Calculates the relative azimuth, elevation, and composite angles from a cached local frame
+  *
+  * Same as calculateRelAzEl() with a WGS_84 or TANGENT_PLANE_WGS_84 model, reusing the frame of the 'from' entity
+  * @param[in ] fromFrame Local frame at the position of the 'from' entity
+  * @param[in ] fromOriLla Vector of yaw, pitch, roll that describes current pointing angles for the 'from' entity
+  * @param[in ] toLla Location in space consisting of latitude, longitude, altitude that is the 'to' entity, to which the angles are calculated
+  * @param[out] azim Azimuth value from one entity to another along the from's line of sight
+  * @param[out] elev Elevation value from one entity to another along the from's line of sight
+  * @param[out] cmp Composite value from one entity to another along the from's line of sight
+  * @pre one of the azim, elev and cmp params must be valid
+  */
+  SDKCORE_EXPORT void calculateRelAzEl(const LocalFrame& fromFrame, const Vec3 &fromOriLla, const Vec3 &toLla, double* azim, double* elev, double* cmp);
+
   /**
   * @brief Calculates the absolute azimuth, elevation, and composite angles between two entities
   *
@@ -69,6 +84,19 @@ namespace simCore
   */
   SDKCORE_EXPORT void calculateAbsAzEl(const Vec3 &fromLla, const Vec3 &toLla, double* azim, double* elev, double* cmp, const EarthModelCalculations model, const CoordinateConverter* coordConv);
 
+  /**
+  * @brief Calculates the absolute azimuth, elevation, and composite angles from a cached local frame
+  *
+  * Same as calculateAbsAzEl() with a WGS_84 or TANGENT_PLANE_WGS_84 model, reusing the frame of the 'from' entity
+  * @param[in ] fromFrame Local frame at the position of the 'from' entity
+  * @param[in ] toLla Location in space consisting of latitude, longitude, altitude that is the 'to' entity, to which the angles are calculated
+  * @param[out] azim Azimuth value from one entity to another
+  * @param[out] elev Elevation value from one entity to another
+  * @param[out] cmp Composite value from one entity to another
+  * @pre one of the azim, elev and cmp params must be valid
+  */
+  SDKCORE_EXPORT void calculateAbsAzEl(const LocalFrame& fromFrame, const Vec3 &toLla, double* azim, double* elev, double* cmp);
+
   /**
   * @brief Calculates the slant distance between two entities
   *
@@ -83,6 +111,16 @@ namespace simCore
   */
   SDKCORE_EXPORT double calculateSlant(const Vec3 &fromLla, const Vec3 &toLla, const EarthModelCalculations model, const CoordinateConverter* coordConv);
 
+  /**
+  * @brief Calculates the slant distance from a cached local frame
+  *
+  * Same as calculateSlant() with a WGS_84 or TANGENT_PLANE_WGS_84 model, reusing the ECEF position of the 'from' entity
+  * @param[in ] fromFrame Local frame at the position of the 'from' entity
+  * @param[in ] toLla Location in space consisting of latitude, longitude, altitude that is the 'to' entity
+  * @return Slant distance between two objects in meters
+  */
+  SDKCORE_EXPORT double calculateSlant(const LocalFrame& fromFrame, const Vec3 &toLla);
+
   /**
   * @brief Calculates the ground distance between two entities
   *
@@ -129,6 +167,19 @@ namespace simCore
   */
   SDKCORE_EXPORT void calculateDRCRDownValue(const Vec3 &fromLla, const double &yaw, const Vec3 &toLla, const EarthModelCalculations model, const CoordinateConverter* coordConv, double* downRng, double* crossRng, double* downValue);
 
+  /**
+  * @brief Calculates the downrange, crossrange, and down values from a cached local frame
+  *
+  * Same as calculateDRCRDownValue() with a WGS_84 or TANGENT_PLANE_WGS_84 model, reusing the frame of the 'from' entity
+  * @param[in ] fromFrame Local frame at the position of the 'from' entity
+  * @param[in ] yaw Yaw (heading) pointing angle for the 'from' entity
+  * @param[in ] toLla Location in space consisting of latitude, longitude, altitude that is the 'to' entity, to which the angles are calculated
+  * @param[out] downRng Range along the x-axis normal to the to entity, where the x-axis is aligned with the yaw of the from entity
+  * @param[out] crossRng Distance measured along a line whose direction is either 90deg CW (positive) or 90deg CCW (neg) to the projection of from's yaw into a horizontal plane
+  * @param[out] downValue Shortest distance between a plane tangent to the earth at from's position and altitude and the to entity
+  */
+  SDKCORE_EXPORT void calculateDRCRDownValue(const LocalFrame& fromFrame, double yaw, const Vec3 &toLla, double* downRng, double* crossRng, double* downValue);
+
   /**
   * @brief Calculates the geodesic downrange and crossrange values between two entities
   *
@@ -251,6 +302,52 @@ namespace simCore
   */
   SDKCORE_EXPORT std::string formatBearingAspectAngle(double angleRadians);
 
+  /** States of the 'to' entities for calculateRelativeGeometry(), one entry per entity in each array */
+  struct RelativeGeometryTargets
+  {
+    /// Latitude (rad), longitude (rad) and altitude (m) of each entity
+    PositionSpans<const double> lla;
+    /// Velocity X/Y/Z in m/s in an LLA frame; needed only for closing velocity
+    PositionSpans<const double> velocity;
+    /// Yaw (rad); needed only for aspect angle
+    std::span<const double> yaw;
+    /// Pitch (rad); needed only for aspect angle
+    std::span<const double> pitch;
+  };
+
+  /** Outputs of calculateRelativeGeometry(), one entry per 'to' entity; quantities with an empty array are not calculated */
+  struct RelativeGeometryResults
+  {
+    std::span<double> slant;            ///< Slant distance (m), as calculateSlant()
+    std::span<double> groundDistance;   ///< Ground distance (m), as calculateGroundDist()
+    std::span<double> relAzimuth;       ///< Relative azimuth (rad), as calculateRelAzEl()
+    std::span<double> relElevation;     ///< Relative elevation (rad), as calculateRelAzEl()
+    std::span<double> relComposite;     ///< Relative composite angle (rad), as calculateRelAzEl()
+    std::span<double> closingVelocity;  ///< Closing velocity (m/s), as calculateClosingVelocity()
+    std::span<double> aspectAngle;      ///< Aspect angle (rad), as calculateAspectAngle()
+  };
+
+  /**
+  * @brief Calculates relative geometry from one entity to many
+  *
+  * Fills each requested quantity from the 'from' entity to every 'to' entity, with the same results as the
+  * single entity functions.  Values shared by all the entities, such as the tangent plane of the 'from'
+  * entity, are calculated once, and the entities are processed in blocks of arrays that the compiler can
+  * vectorize.  Large counts are split across the shared worker threads of simCore::runRanges().
+  * @param[in ] fromLla Vector of latitude, longitude, and altitude that describes current position for the 'from' entity
+  * @param[in ] fromOriLla Vector of yaw, pitch, roll that describes current pointing angles for the 'from' entity
+  * @param[in ] fromVel Velocity X/Y/Z for the from entity in m/s in an LLA frame; used only for closing velocity
+  * @param[in ] targets States of the 'to' entities
+  * @param[in ] model Earth model to perform the calculations in: WGS_84, TANGENT_PLANE_WGS_84 or FLAT_EARTH
+  * @param[in ] coordConv If model is flat earth, then this must point to an initialized CoordinateConverter structure with a reference origin set. Not used otherwise
+  * @param[out] results Arrays to fill; each non-empty array must hold one value per 'to' entity
+  * @param[in ] numThreads Most threads to use, including the calling thread
+  * @return 0 on success, non-zero if an array size does not match, an input needed for a requested quantity is missing,
+  *   or the model is not supported
+  */
+  SDKCORE_EXPORT int calculateRelativeGeometry(const Vec3& fromLla, const Vec3& fromOriLla, const Vec3& fromVel, const RelativeGeometryTargets& targets,
+    const EarthModelCalculations model, const CoordinateConverter* coordConv, const RelativeGeometryResults& results, unsigned int numThreads = 1);
+
   //////////////////////////////////////////////////////////////////////
   ////////////////// Helper functions for Calculation //////////////////
   //////////////////////////////////////////////////////////////////////
@@ -332,6 +429,7 @@ namespace simCore
   * This function implements Sodano's direct solution algorithm to determine geodetic
   * longitude and latitude and back azimuth given a geodetic reference longitude
   * and latitude, a geodesic length, a forward azimuth  and an ellipsoid definition.
+  * simCore::Geodesic solves arrays of lines, and has the more accurate Karney method.
   * @param[in ] refLat Geodetic latitude of reference point (rad)
   * @param[in ] refLon Geodetic longitude of reference point (rad)
   * @param[in ] refAlt Height above ellipsoid of reference point (m)
@@ -351,6 +449,7 @@ namespace simCore
   * to determine geodesic length or distance, forward
   * azimuth, and backward azimuth from a given pair of
   * geodetic longitudes and latitudes and a given ellipsoid.
+  * simCore::Geodesic solves arrays of pairs, and has the more accurate Karney method.
   * @param[in ] refLat Geodetic latitude of reference point (rad)
   * @param[in ] refLon Geodetic longitude of reference point (rad)
   * @param[in ] refAlt Height above ellipsoid of reference point (m)
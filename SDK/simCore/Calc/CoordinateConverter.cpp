@@ -20,16 +20,20 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 #include <cassert>
+#include <functional>
 #include <limits>
+#include <vector>
 
 #include "simNotify/Notify.h"
 #include "simCore/Calc/Angle.h"
 #include "simCore/Calc/Dcm.h"
 #include "simCore/Calc/Math.h"
 #include "simCore/Calc/CoordinateConverter.h"
+#include "simCore/System/ParallelRanges.h"
 
 namespace simCore
 {
@@ -1468,14 +1472,9 @@ void CoordinateConverter::setLocalToEarthDcm(double lat, double lon, const Local
 }
 // state independent CoordinateConverter members
 //--------------------------------------------------------------------------
-///@pre system is NED/NWU/ENU
-void CoordinateConverter::setLocalToEarthMatrix(double lat, double lon, const LocalLevelFrame localLevelFrame, double localToEarth[][3])
+/// Local to Earth rotation matrix from the sines and cosines of latitude and longitude
+static void fillLocalToEarthMatrix(double slat, double clat, double slon, double clon, LocalLevelFrame localLevelFrame, double localToEarth[][3])
 {
-  double slat = sin(lat);
-  double clat = cos(lat);
-  double slon = sin(lon);
-  double clon = cos(lon);
-
   // Compute local to Earth rotation matrix based on input coordinate system
   switch (localLevelFrame)
   {
@@ -1545,6 +1544,12 @@ void CoordinateConverter::setLocalToEarthMatrix(double lat, double lon, const Lo
   }
 }
 
+///@pre system is NED/NWU/ENU
+void CoordinateConverter::setLocalToEarthMatrix(double lat, double lon, const LocalLevelFrame localLevelFrame, double localToEarth[][3])
+{
+  fillLocalToEarthMatrix(sin(lat), cos(lat), sin(lon), cos(lon), localLevelFrame, localToEarth);
+}
+
 /// convert vector between ENU and NED
 void CoordinateConverter::swapNedEnu(const Vec3 &inVec, Vec3 &outVec)
 {
@@ -2079,49 +2084,42 @@ int CoordinateConverter::convertEcefToEci(const Coordinate &ecefCoord, Coordinat
   return 0;
 }
 
-/// convert earth centered, earth fixed projection to geodetic (LLA) projection
-///@pre llaPos valid, ecefPos does not alias llaPos
-int CoordinateConverter::convertEcefToGeodeticPos(const Vec3 &ecefPos, Vec3 &llaPos)
+/// convert earth centered, earth fixed position to geodetic by Fukushima's method; handles every position
+///@return 0 on success, !0 on failure
+static int fukushimaEcefToGeodeticPos(double x, double y, double z, double& lat, double& lon, double& alt)
 {
-  // Test for same input/output -- this function cannot handle case of ecefPos == llaPos
-  if (&ecefPos == &llaPos)
+  if (x != 0.0)
   {
-    assert(0);
-    return 1;
-  }
-
-  if (ecefPos.x() != 0.0)
-  {
-    llaPos.setLon(atan2(ecefPos.y(), ecefPos.x()));
+    lon = atan2(y, x);
   }
   else
   {
-    if (ecefPos.y() > 0.0)
+    if (y > 0.0)
     {
-      llaPos.setLon(M_PI_2);
+      lon = M_PI_2;
     }
-    else if (ecefPos.y() < 0.0)
+    else if (y < 0.0)
     {
-      llaPos.setLon(-M_PI_2);
+      lon = -M_PI_2;
     }
     else
     {
       // at pole or at center of the earth
-      llaPos.setLon(0.0);
-      if (ecefPos.z() > 0.0)
+      lon = 0.0;
+      if (z > 0.0)
       { // north pole
-        llaPos.setLat(M_PI_2);
-        llaPos.setAlt(ecefPos.z() - WGS_B);
+        lat = M_PI_2;
+        alt = z - WGS_B;
       }
-      else if (ecefPos.z() < 0.0)
+      else if (z < 0.0)
       { // south pole
-        llaPos.setLat(-M_PI_2);
-        llaPos.setAlt(-ecefPos.z() - WGS_B);
+        lat = -M_PI_2;
+        alt = -z - WGS_B;
       }
       else
       { // center of earth
-        llaPos.setLat(M_PI_2);
-        llaPos.setAlt(-WGS_B);
+        lat = M_PI_2;
+        alt = -WGS_B;
       }
       return 0;
     }
@@ -2133,10 +2131,10 @@ int CoordinateConverter::convertEcefToGeodeticPos(const Vec3 &ecefPos, Vec3 &lla
   // Note: Variable names follow the notation therein
 
   // p is distance from Z axis
-  const double p = sqrt(square(ecefPos.x()) + square(ecefPos.y()));
+  const double p = sqrt(square(x) + square(y));
   // in the Fukushima document, this is notated as: P
   const double PP = p / WGS_A;
-  const double Z = FUKUSHIMA_eP * fabs(ecefPos.z()) / WGS_A;
+  const double Z = FUKUSHIMA_eP * fabs(z) / WGS_A;
   double S = Z;
   double C = WGS_ESQC * PP;
   double Cc = C * FUKUSHIMA_eP;
@@ -2172,16 +2170,150 @@ int CoordinateConverter::convertEcefToGeodeticPos(const Vec3 &ecefPos, Vec3 &lla
     // where one-iteration condition was not met. testing suggests that
     // 2 iterations produces an acceptable result in these cases.
   }
-  const double lat = sign(ecefPos.z()) * atan(S / Cc);
-  const double num = Cc * p + fabs(ecefPos.z()) * S - WGS_B * (sqrt(C * C + S * S));
+  lat = sign(z) * atan(S / Cc);
+  const double num = Cc * p + fabs(z) * S - WGS_B * (sqrt(C * C + S * S));
   const double den = sqrt(Cc * Cc + S * S);
-  llaPos.setLat(lat);
   // den cannot be 0.0 if C != 0.0
-  llaPos.setAlt(num/den);
+  alt = num/den;
+
+  return 0;
+}
+
+/// distance from the center of the earth (m) below which the closed form conversions defer to Fukushima's method
+static const double CLOSED_FORM_MIN_RADIUS = 100000.0;
+
+/// convert earth centered, earth fixed position to geodetic by Vermeille's closed form
+///@return 0 on success, !0 on failure
+static int vermeilleEcefToGeodeticPos(double x, double y, double z, double& lat, double& lon, double& alt)
+{
+  // derived from:
+  // Vermeille H., (2004) : Computing geodetic coordinates from geocentric coordinates
+  //   Journal of Geodesy, Vol. 78, pp. 94-95.
+  // Note: Variable names follow the notation therein
+  const double w2 = square(x) + square(y);
+  const double e4 = square(WGS_ESQ);
+  const double p = w2 / WGS_A2;
+  const double q = WGS_ESQC * square(z) / WGS_A2;
+  const double r = (p + q - e4) / 6.0;
+  // near the center of the earth and on the Z axis the cubic degenerates
+  if (w2 == 0.0 || r <= 0.0 || (w2 + square(z)) < square(CLOSED_FORM_MIN_RADIUS))
+    return fukushimaEcefToGeodeticPos(x, y, z, lat, lon, alt);
+
+  const double s = e4 * p * q / (4.0 * r * r * r);
+  const double t = cbrt(1.0 + s + sqrt(s * (2.0 + s)));
+  const double u = r * (1.0 + t + 1.0 / t);
+  const double v = sqrt(square(u) + e4 * q);
+  const double w = WGS_ESQ * (u + v - q) / (2.0 * v);
+  const double k = sqrt(u + v + square(w)) - w;
+  const double D = k * sqrt(w2) / (k + WGS_ESQ);
+  const double Dz = sqrt(square(D) + square(z));
+  lat = 2.0 * atan2(z, D + Dz);
+  lon = atan2(y, x);
+  alt = (k + WGS_ESQ - 1.0) / k * Dz;
+  return 0;
+}
+
+/// convert earth centered, earth fixed position to geodetic by Olson's closed form with one correction
+///@return 0 on success, !0 on failure
+static int olsonEcefToGeodeticPos(double x, double y, double z, double& lat, double& lon, double& alt)
+{
+  const double w2 = square(x) + square(y);
+  const double r2 = w2 + square(z);
+  // on the Z axis and near the center of the earth the series diverge
+  if (w2 == 0.0 || r2 < square(CLOSED_FORM_MIN_RADIUS))
+    return fukushimaEcefToGeodeticPos(x, y, z, lat, lon, alt);
 
+  // derived from:
+  // Olson D. K., (1996) : Converting earth-centered, earth-fixed coordinates to geodetic coordinates
+  //   IEEE Transactions on Aerospace and Electronic Systems, Vol. 32, No. 1, pp. 473-476.
+  static const double a1 = WGS_A * WGS_ESQ;
+  static const double a2 = a1 * a1;
+  static const double a3 = a1 * WGS_ESQ / 2.0;
+  static const double a4 = 2.5 * a2;
+  static const double a5 = a1 + a3;
+
+  const double zp = fabs(z);
+  const double w = sqrt(w2);
+  const double r = sqrt(r2);
+  const double s2 = square(z) / r2;
+  const double c2 = w2 / r2;
+  double u = a2 / r;
+  double v = a3 - a4 / r;
+  double s;
+  double c;
+  double phi;
+  // first guess of latitude, from whichever of sine and cosine is better conditioned
+  if (c2 > 0.3)
+  {
+    s = (zp / r) * (1.0 + c2 * (a1 + u + s2 * v) / r);
+    phi = asin(s);
+    c = sqrt(1.0 - s * s);
+  }
+  else
+  {
+    c = (w / r) * (1.0 - s2 * (a5 - u - c2 * v) / r);
+    phi = acos(c);
+    s = sqrt(1.0 - c * c);
+  }
+  // one Newton correction
+  const double g = 1.0 - WGS_ESQ * s * s;
+  const double rg = WGS_A / sqrt(g);
+  const double rf = WGS_ESQC * rg;
+  u = w - rg * c;
+  v = zp - rf * s;
+  const double f = c * u + s * v;
+  const double m = c * v - s * u;
+  const double correction = m / (rf / g + f);
+
+  lat = (z < 0.0) ? -(phi + correction) : (phi + correction);
+  lon = atan2(y, x);
+  alt = f + m * correction / 2.0;
   return 0;
 }
 
+/// convert earth centered, earth fixed position to geodetic; shared by the single and batch conversions
+///@return 0 on success, !0 on failure
+static int ecefToGeodeticPos(double x, double y, double z, double& lat, double& lon, double& alt, CoordinateConverter::EcefToGeodeticAlgorithm algorithm)
+{
+  switch (algorithm)
+  {
+  case CoordinateConverter::ECEF_TO_GEODETIC_VERMEILLE:
+    return vermeilleEcefToGeodeticPos(x, y, z, lat, lon, alt);
+  case CoordinateConverter::ECEF_TO_GEODETIC_OLSON:
+    return olsonEcefToGeodeticPos(x, y, z, lat, lon, alt);
+  case CoordinateConverter::ECEF_TO_GEODETIC_FUKUSHIMA:
+    break;
+  }
+  return fukushimaEcefToGeodeticPos(x, y, z, lat, lon, alt);
+}
+
+/// convert earth centered, earth fixed projection to geodetic (LLA) projection
+///@pre llaPos valid, ecefPos does not alias llaPos
+int CoordinateConverter::convertEcefToGeodeticPos(const Vec3 &ecefPos, Vec3 &llaPos)
+{
+  return convertEcefToGeodeticPos(ecefPos, llaPos, ECEF_TO_GEODETIC_OLSON);
+}
+
+/// convert earth centered, earth fixed projection to geodetic (LLA) projection with the given algorithm
+///@pre llaPos valid, ecefPos does not alias llaPos
+int CoordinateConverter::convertEcefToGeodeticPos(const Vec3 &ecefPos, Vec3 &llaPos, EcefToGeodeticAlgorithm algorithm)
+{
+  // Test for same input/output -- this function cannot handle case of ecefPos == llaPos
+  if (&ecefPos == &llaPos)
+  {
+    assert(0);
+    return 1;
+  }
+
+  double lat = 0.0;
+  double lon = 0.0;
+  double alt = 0.0;
+  const int rv = ecefToGeodeticPos(ecefPos.x(), ecefPos.y(), ecefPos.z(), lat, lon, alt, algorithm);
+  if (rv == 0)
+    llaPos.set(lat, lon, alt);
+  return rv;
+}
+
 /// convert geodetic projection to earth centered, earth fixed projection
 ///@pre ecefPos valid
 void CoordinateConverter::convertGeodeticPosToEcef(const Vec3 &llaPos, Vec3 &ecefPos, const double semiMajor, const double eccentricitySquared)
@@ -2196,6 +2328,428 @@ void CoordinateConverter::convertGeodeticPosToEcef(const Vec3 &llaPos, Vec3 &ece
     (Rn * (1.0-eccentricitySquared) + llaPos.alt()) * sLat);
 }
 
+//------------------------------------------------------------------------
+// Batch position conversions
+
+/// Points converted by each thread of a batch conversion before another thread is worth starting
+static const size_t BATCH_MIN_POINTS_PER_THREAD = 4096;
+/// Points taken through all the steps of a batch conversion together, small enough for the intermediate values to stay in cache
+static const size_t BATCH_BLOCK_SIZE = 512;
+
+/// Input arrays of a batch conversion step; steps never write to their input
+typedef const double* __restrict BatchInArray;
+/// Output arrays of a batch conversion step
+typedef double* __restrict BatchOutArray;
+
+/**
+ * One step of a batch conversion over a block of points.  first is the index of the block's first
+ * point in the whole batch.  Written as straight loops over separate arrays so that the compiler
+ * can vectorize the steps that have no calls into the math library.
+ */
+typedef std::function<void(size_t first, size_t count, BatchInArray inX, BatchInArray inY, BatchInArray inZ,
+  BatchOutArray outX, BatchOutArray outY, BatchOutArray outZ)> BatchStep;
+
+/// Returns true if the three arrays of the positions all have the given size
+template <typename T>
+static bool hasSize(const PositionSpans<T>& pos, size_t count)
+{
+  return pos.x.size() == count && pos.y.size() == count && pos.z.size() == count;
+}
+
+/// Same arithmetic as convertGeodeticPosToEcef(const Vec3&, Vec3&, double, double) with the WGS-84 ellipsoid
+static void geodeticToEcefStep(size_t /*first*/, size_t count, BatchInArray lat, BatchInArray lon, BatchInArray alt, BatchOutArray x, BatchOutArray y, BatchOutArray z)
+{
+  for (size_t ii = 0; ii < count; ++ii)
+  {
+    const double sLat = sin(lat[ii]);
+    const double Rn = WGS_A / sqrt(1.0 - WGS_ESQ * square(sLat));
+    const double cLat = cos(lat[ii]);
+    x[ii] = (Rn + alt[ii]) * cLat * cos(lon[ii]);
+    y[ii] = (Rn + alt[ii]) * cLat * sin(lon[ii]);
+    z[ii] = (Rn * (1.0 - WGS_ESQ) + alt[ii]) * sLat;
+  }
+}
+
+static BatchStep ecefToGeodeticStep(CoordinateConverter::EcefToGeodeticAlgorithm algorithm)
+{
+  return [algorithm](size_t /*first*/, size_t count, BatchInArray x, BatchInArray y, BatchInArray z, BatchOutArray lat, BatchOutArray lon, BatchOutArray alt)
+  {
+    for (size_t ii = 0; ii < count; ++ii)
+      ecefToGeodeticPos(x[ii], y[ii], z[ii], lat[ii], lon[ii], alt[ii], algorithm);
+  };
+}
+
+/// Rotation about the Z axis between ECI and ECEF; rotationRate is negative for ECI to ECEF, as in convertEciEcef_()
+static BatchStep eciEcefStep(double rotationRate, std::span<const double> elapsedEciTimes)
+{
+  // One time for all points rotates every point the same
+  if (elapsedEciTimes.size() == 1)
+  {
+    const double eciRotation = angFix2PI(rotationRate * elapsedEciTimes[0]);
+    const double cosOmega = cos(eciRotation);
+    const double sinOmega = sin(eciRotation);
+    return [cosOmega, sinOmega](size_t /*first*/, size_t count, BatchInArray inX, BatchInArray inY, BatchInArray inZ, BatchOutArray outX, BatchOutArray outY, BatchOutArray outZ)
+    {
+      for (size_t ii = 0; ii < count; ++ii)
+      {
+        outX[ii] = cosOmega * inX[ii] - sinOmega * inY[ii];
+        outY[ii] = cosOmega * inY[ii] + sinOmega * inX[ii];
+        outZ[ii] = inZ[ii];
+      }
+    };
+  }
+  return [rotationRate, elapsedEciTimes](size_t first, size_t count, BatchInArray inX, BatchInArray inY, BatchInArray inZ, BatchOutArray outX, BatchOutArray outY, BatchOutArray outZ)
+  {
+    const double* times = elapsedEciTimes.data() + first;
+    for (size_t ii = 0; ii < count; ++ii)
+    {
+      const double eciRotation = angFix2PI(rotationRate * times[ii]);
+      const double cosOmega = cos(eciRotation);
+      const double sinOmega = sin(eciRotation);
+      outX[ii] = cosOmega * inX[ii] - sinOmega * inY[ii];
+      outY[ii] = cosOmega * inY[ii] + sinOmega * inX[ii];
+      outZ[ii] = inZ[ii];
+    }
+  };
+}
+
+/// Copies the positions of a conversion between the same systems
+static void copyStep(size_t /*first*/, size_t count, BatchInArray inX, BatchInArray inY, BatchInArray inZ, BatchOutArray outX, BatchOutArray outY, BatchOutArray outZ)
+{
+  std::copy(inX, inX + count, outX);
+  std::copy(inY, inY + count, outY);
+  std::copy(inZ, inZ + count, outZ);
+}
+
+/// Reorders and negates the axes between scaled flat earth systems, as swapNedEnu(), swapNedNwu(), convertEnuToNwu() and convertNwuToEnu()
+static BatchStep flatToFlatStep(CoordinateSystem inSystem, CoordinateSystem outSystem)
+{
+  const bool outEnu = (outSystem == COORD_SYS_ENU);
+  // X is east in ENU and north in NED and NWU
+  const bool swapXY = ((inSystem == COORD_SYS_ENU) != outEnu);
+  const double inEastSign = (inSystem == COORD_SYS_NWU) ? -1.0 : 1.0;
+  const double outEastSign = (outSystem == COORD_SYS_NWU) ? -1.0 : 1.0;
+  // Negation is exact, so multiplying by these signs gives the same values as the swaps
+  const double xSign = outEnu ? inEastSign : 1.0;
+  const double ySign = outEnu ? 1.0 : (inEastSign * outEastSign);
+  const double zSign = ((inSystem == COORD_SYS_NED) == (outSystem == COORD_SYS_NED)) ? 1.0 : -1.0;
+  return [swapXY, xSign, ySign, zSign](size_t /*first*/, size_t count, BatchInArray inX, BatchInArray inY, BatchInArray inZ, BatchOutArray outX, BatchOutArray outY, BatchOutArray outZ)
+  {
+    BatchInArray fromX = swapXY ? inY : inX;
+    BatchInArray fromY = swapXY ? inX : inY;
+    for (size_t ii = 0; ii < count; ++ii)
+    {
+      outX[ii] = xSign * fromX[ii];
+      outY[ii] = ySign * fromY[ii];
+      outZ[ii] = zSign * inZ[ii];
+    }
+  };
+}
+
+/// Same arithmetic as convertGeodeticToFlat_(); system is NED, NWU or ENU
+static BatchStep geodeticToFlatStep(CoordinateSystem system, const Vec3& origin, double latRadius, double lonRadius)
+{
+  const bool enu = (system == COORD_SYS_ENU);
+  const double eastSign = (system == COORD_SYS_NWU) ? -1.0 : 1.0;
+  const double upSign = (system == COORD_SYS_NED) ? -1.0 : 1.0;
+  const double originLat = origin.lat();
+  const double originLon = origin.lon();
+  const double originAlt = origin.alt();
+  return [=](size_t /*first*/, size_t count, BatchInArray lat, BatchInArray lon, BatchInArray alt, BatchOutArray outX, BatchOutArray outY, BatchOutArray outZ)
+  {
+    for (size_t ii = 0; ii < count; ++ii)
+    {
+      const double north = angFixPI(lat[ii] - originLat) * latRadius;
+      const double east = angFixPI(lon[ii] - originLon) * lonRadius;
+      const double up = alt[ii] - originAlt;
+      outX[ii] = enu ? east : north;
+      outY[ii] = enu ? north : (eastSign * east);
+      outZ[ii] = upSign * up;
+    }
+  };
+}
+
+/// Same arithmetic as convertFlatToGeodetic_(); system is NED, NWU or ENU
+static BatchStep flatToGeodeticStep(CoordinateSystem system, const Vec3& origin, double invLatRadius, double invLonRadius)
+{
+  const bool enu = (system == COORD_SYS_ENU);
+  const double eastSign = (system == COORD_SYS_NWU) ? -1.0 : 1.0;
+  const double upSign = (system == COORD_SYS_NED) ? -1.0 : 1.0;
+  const double originLat = origin.lat();
+  const double originLon = origin.lon();
+  const double originAlt = origin.alt();
+  return [=](size_t /*first*/, size_t count, BatchInArray inX, BatchInArray inY, BatchInArray inZ, BatchOutArray lat, BatchOutArray lon, BatchOutArray alt)
+  {
+    for (size_t ii = 0; ii < count; ++ii)
+    {
+      const double north = enu ? inY[ii] : inX[ii];
+      const double east = eastSign * (enu ? inX[ii] : inY[ii]);
+      lat[ii] = north * invLatRadius + originLat;
+      lon[ii] = east * invLonRadius + originLon;
+      alt[ii] = upSign * inZ[ii] + originAlt;
+    }
+  };
+}
+
+/// Same arithmetic as the position of convertEcefToXEast_()
+static BatchStep ecefToXEastStep(const double rotation[][3], const Vec3& translation)
+{
+  const double m00 = rotation[0][0], m01 = rotation[0][1], m02 = rotation[0][2];
+  const double m10 = rotation[1][0], m11 = rotation[1][1], m12 = rotation[1][2];
+  const double m20 = rotation[2][0], m21 = rotation[2][1], m22 = rotation[2][2];
+  const double tx = translation.x();
+  const double ty = translation.y();
+  const double tz = translation.z();
+  return [=](size_t /*first*/, size_t count, BatchInArray inX, BatchInArray inY, BatchInArray inZ, BatchOutArray outX, BatchOutArray outY, BatchOutArray outZ)
+  {
+    for (size_t ii = 0; ii < count; ++ii)
+    {
+      const double x = inX[ii] - tx;
+      const double y = inY[ii] - ty;
+      const double z = inZ[ii] - tz;
+      outX[ii] = m00 * x + m01 * y + m02 * z;
+      outY[ii] = m10 * x + m11 * y + m12 * z;
+      outZ[ii] = m20 * x + m21 * y + m22 * z;
+    }
+  };
+}
+
+/// Same arithmetic as the position of convertXEastToEcef_()
+static BatchStep xEastToEcefStep(const double rotation[][3], const Vec3& translation)
+{
+  const double m00 = rotation[0][0], m01 = rotation[0][1], m02 = rotation[0][2];
+  const double m10 = rotation[1][0], m11 = rotation[1][1], m12 = rotation[1][2];
+  const double m20 = rotation[2][0], m21 = rotation[2][1], m22 = rotation[2][2];
+  const double tx = translation.x();
+  const double ty = translation.y();
+  const double tz = translation.z();
+  return [=](size_t /*first*/, size_t count, BatchInArray inX, BatchInArray inY, BatchInArray inZ, BatchOutArray outX, BatchOutArray outY, BatchOutArray outZ)
+  {
+    for (size_t ii = 0; ii < count; ++ii)
+    {
+      outX[ii] = (m00 * inX[ii] + m10 * inY[ii] + m20 * inZ[ii]) + tx;
+      outY[ii] = (m01 * inX[ii] + m11 * inY[ii] + m21 * inZ[ii]) + ty;
+      outZ[ii] = (m02 * inX[ii] + m12 * inY[ii] + m22 * inZ[ii]) + tz;
+    }
+  };
+}
+
+/// Same arithmetic as the position of applyTPOffsetRotate_()
+static BatchStep applyTPOffsetRotateStep(double offsetX, double offsetY, double cosRotation, double sinRotation)
+{
+  return [=](size_t /*first*/, size_t count, BatchInArray inX, BatchInArray inY, BatchInArray inZ, BatchOutArray outX, BatchOutArray outY, BatchOutArray outZ)
+  {
+    for (size_t ii = 0; ii < count; ++ii)
+    {
+      outX[ii] = (inX[ii] - offsetX) * cosRotation - (inY[ii] - offsetY) * sinRotation;
+      outY[ii] = (inX[ii] - offsetX) * sinRotation + (inY[ii] - offsetY) * cosRotation;
+      outZ[ii] = inZ[ii];
+    }
+  };
+}
+
+/// Same arithmetic as the position of reverseTPOffsetRotate_()
+static BatchStep reverseTPOffsetRotateStep(double offsetX, double offsetY, double cosRotation, double sinRotation)
+{
+  return [=](size_t /*first*/, size_t count, BatchInArray inX, BatchInArray inY, BatchInArray inZ, BatchOutArray outX, BatchOutArray outY, BatchOutArray outZ)
+  {
+    for (size_t ii = 0; ii < count; ++ii)
+    {
+      outX[ii] = (inX[ii] * cosRotation + inY[ii] * sinRotation) + offsetX;
+      outY[ii] = (-inX[ii] * sinRotation + inY[ii] * cosRotation) + offsetY;
+      outZ[ii] = inZ[ii];
+    }
+  };
+}
+
+/**
+ * Runs the steps in order over all the positions, in blocks, split into numThreads ranges on the shared worker threads.
+ * The first step reads inPos and the last writes outPos; intermediate values alternate between
+ * two scratch blocks, so that no step reads the array it writes.
+ * @pre steps not empty, positions all the same size
+ */
+static void runBatchSteps(const std::vector<BatchStep>& steps, const PositionSpans<const double>& inPos, const PositionSpans<double>& outPos, unsigned int numThreads)
+{
+  const auto convertRange = [&steps, &inPos, &outPos](size_t begin, size_t end)
+  {
+    std::vector<double> scratch((steps.size() > 1) ? 6 * BATCH_BLOCK_SIZE : 0);
+    for (size_t first = begin; first < end; first += BATCH_BLOCK_SIZE)
+    {
+      const size_t count = std::min(BATCH_BLOCK_SIZE, end - first);
+      const double* inX = inPos.x.data() + first;
+      const double* inY = inPos.y.data() + first;
+      const double* inZ = inPos.z.data() + first;
+      for (size_t step = 0; step < steps.size(); ++step)
+      {
+        double* outX = outPos.x.data() + first;
+        double* outY = outPos.y.data() + first;
+        double* outZ = outPos.z.data() + first;
+        if (step + 1 < steps.size())
+        {
+          outX = scratch.data() + (step % 2) * 3 * BATCH_BLOCK_SIZE;
+          outY = outX + BATCH_BLOCK_SIZE;
+          outZ = outY + BATCH_BLOCK_SIZE;
+        }
+        steps[step](first, count, inX, inY, inZ, outX, outY, outZ);
+        inX = outX;
+        inY = outY;
+        inZ = outZ;
+      }
+    }
+  };
+
+  const size_t count = inPos.size();
+  const size_t maxRanges = (count + BATCH_MIN_POINTS_PER_THREAD - 1) / BATCH_MIN_POINTS_PER_THREAD;
+  const size_t numRanges = std::min<size_t>(std::max(numThreads, 1u), maxRanges);
+  if (numRanges <= 1)
+  {
+    convertRange(0, count);
+    return;
+  }
+
+  runRanges(count, numRanges, convertRange);
+}
+
+int CoordinateConverter::convertGeodeticPosToEcef(const PositionSpans<const double>& llaPos, const PositionSpans<double>& ecefPos, unsigned int numThreads)
+{
+  if (!hasSize(llaPos, llaPos.size()) || !hasSize(ecefPos, llaPos.size()))
+  {
+    SIM_ERROR << "convertGeodeticPosToEcef, position arrays differ in size: " << __LINE__ << std::endl;
+    return 1;
+  }
+  runBatchSteps({ geodeticToEcefStep }, llaPos, ecefPos, numThreads);
+  return 0;
+}
+
+int CoordinateConverter::convertEcefToGeodeticPos(const PositionSpans<const double>& ecefPos, const PositionSpans<double>& llaPos, unsigned int numThreads,
+  EcefToGeodeticAlgorithm algorithm)
+{
+  if (!hasSize(ecefPos, ecefPos.size()) || !hasSize(llaPos, ecefPos.size()))
+  {
+    SIM_ERROR << "convertEcefToGeodeticPos, position arrays differ in size: " << __LINE__ << std::endl;
+    return 1;
+  }
+  runBatchSteps({ ecefToGeodeticStep(algorithm) }, ecefPos, llaPos, numThreads);
+  return 0;
+}
+
+int CoordinateConverter::convertPositions(CoordinateSystem inSystem, const PositionSpans<const double>& inPos, CoordinateSystem outSystem, const PositionSpans<double>& outPos,
+  double elapsedEciTime, unsigned int numThreads) const
+{
+  return convertPositions(inSystem, inPos, outSystem, outPos, std::span<const double>(&elapsedEciTime, 1), numThreads);
+}
+
+int CoordinateConverter::convertPositions(CoordinateSystem inSystem, const PositionSpans<const double>& inPos, CoordinateSystem outSystem, const PositionSpans<double>& outPos,
+  std::span<const double> elapsedEciTimes, unsigned int numThreads) const
+{
+  const size_t count = inPos.size();
+  if (!hasSize(inPos, count) || !hasSize(outPos, count))
+  {
+    SIM_ERROR << "convertPositions, position arrays differ in size: " << __LINE__ << std::endl;
+    return 1;
+  }
+  if (inSystem <= COORD_SYS_NONE || inSystem >= COORD_SYS_MAX || outSystem <= COORD_SYS_NONE || outSystem >= COORD_SYS_MAX)
+  {
+    SIM_ERROR << "convertPositions, invalid coordinate system: " << __LINE__ << std::endl;
+    return 1;
+  }
+  const bool usesEci = (inSystem != outSystem) && (inSystem == COORD_SYS_ECI || outSystem == COORD_SYS_ECI);
+  // A single time applies to all the points
+  if (usesEci && elapsedEciTimes.size() != 1 && elapsedEciTimes.size() != count)
+  {
+    SIM_ERROR << "convertPositions, ECI times differ in size from positions: " << __LINE__ << std::endl;
+    return 1;
+  }
+
+  const auto isFlat = [](CoordinateSystem system) { return system == COORD_SYS_NED || system == COORD_SYS_NWU || system == COORD_SYS_ENU; };
+  const auto isTangentPlane = [](CoordinateSystem system) { return system == COORD_SYS_XEAST || system == COORD_SYS_GTP; };
+
+  // Same sequence of conversions as convert()
+  std::vector<BatchStep> steps;
+  if (inSystem == outSystem)
+    steps.push_back(copyStep);
+  else if (isFlat(inSystem) && isFlat(outSystem))
+    steps.push_back(flatToFlatStep(inSystem, outSystem));
+  else if (isTangentPlane(inSystem) && isTangentPlane(outSystem))
+  {
+    if (inSystem == COORD_SYS_GTP)
+      steps.push_back(reverseTPOffsetRotateStep(tangentPlaneOffsetX_, tangentPlaneOffsetY_, cosTPR_, sinTPR_));
+    else
+      steps.push_back(applyTPOffsetRotateStep(tangentPlaneOffsetX_, tangentPlaneOffsetY_, cosTPR_, sinTPR_));
+  }
+  else
+  {
+    const bool usesFlat = isFlat(inSystem) || isFlat(outSystem);
+    if ((usesFlat || isTangentPlane(inSystem) || isTangentPlane(outSystem)) && !hasReferenceOrigin())
+    {
+      SIM_ERROR << "convertPositions, reference origin not set: " << __LINE__ << std::endl;
+      return 1;
+    }
+    if (usesFlat && refOriginStatus_ == REF_ORIGIN_SCALED_FLAT_EARTH_DEGENERATE)
+    {
+      SIM_ERROR << "convertPositions, degenerate reference origin at/near pole: " << __LINE__ << std::endl;
+      return 1;
+    }
+
+    // Input to geodetic or ECEF, whichever it converts to directly
+    bool geodetic = false;
+    switch (inSystem)
+    {
+    case COORD_SYS_LLA:
+      geodetic = true;
+      break;
+    case COORD_SYS_NED:
+    case COORD_SYS_NWU:
+    case COORD_SYS_ENU:
+      steps.push_back(flatToGeodeticStep(inSystem, referenceOrigin_, invLatRadius_, invLonRadius_));
+      geodetic = true;
+      break;
+    case COORD_SYS_ECI:
+      steps.push_back(eciEcefStep(-EARTH_ROTATION_RATE, elapsedEciTimes));
+      break;
+    case COORD_SYS_GTP:
+      steps.push_back(reverseTPOffsetRotateStep(tangentPlaneOffsetX_, tangentPlaneOffsetY_, cosTPR_, sinTPR_));
+      steps.push_back(xEastToEcefStep(rotationMatrixENU_, tangentPlaneTranslation_));
+      break;
+    case COORD_SYS_XEAST:
+      steps.push_back(xEastToEcefStep(rotationMatrixENU_, tangentPlaneTranslation_));
+      break;
+    default:
+      break;
+    }
+
+    const bool outGeodetic = (outSystem == COORD_SYS_LLA || isFlat(outSystem));
+    if (geodetic && !outGeodetic)
+      steps.push_back(geodeticToEcefStep);
+    else if (!geodetic && outGeodetic)
+      steps.push_back(ecefToGeodeticStep(ECEF_TO_GEODETIC_OLSON));
+
+    switch (outSystem)
+    {
+    case COORD_SYS_NED:
+    case COORD_SYS_NWU:
+    case COORD_SYS_ENU:
+      steps.push_back(geodeticToFlatStep(outSystem, referenceOrigin_, latRadius_, lonRadius_));
+      break;
+    case COORD_SYS_ECI:
+      steps.push_back(eciEcefStep(EARTH_ROTATION_RATE, elapsedEciTimes));
+      break;
+    case COORD_SYS_XEAST:
+      steps.push_back(ecefToXEastStep(rotationMatrixENU_, tangentPlaneTranslation_));
+      break;
+    case COORD_SYS_GTP:
+      steps.push_back(ecefToXEastStep(rotationMatrixENU_, tangentPlaneTranslation_));
+      steps.push_back(applyTPOffsetRotateStep(tangentPlaneOffsetX_, tangentPlaneOffsetY_, cosTPR_, sinTPR_));
+      break;
+    default:
+      break;
+    }
+  }
+
+  runBatchSteps(steps, inPos, outPos, numThreads);
+  return 0;
+}
+
 /// Converts an Earth Centered Earth Fixed (ECEF) velocity to geodetic
 void CoordinateConverter::convertEcefToGeodeticVel(const Vec3 &llaPos, const Vec3 &ecefVel, Vec3 &llaVel, LocalLevelFrame localLevelFrame)
 {
@@ -2435,4 +2989,83 @@ Vec3 CoordinateConverter::convertEcefToGeodeticAccel(const Vec3& llaPos, const V
   return outAccel;
 }
 
+//--------------------------------------------------------------------------
+// LocalFrame
+
+LocalFrame::LocalFrame()
+  : LocalFrame(Vec3())
+{
+}
+
+LocalFrame::LocalFrame(const Vec3& originLla)
+{
+  computeOrigin_(originLla);
+}
+
+LocalFrame::~LocalFrame()
+{
+}
+
+void LocalFrame::setOrigin(const Vec3& originLla)
+{
+  if (origin_ != originLla)
+    computeOrigin_(originLla);
+}
+
+void LocalFrame::computeOrigin_(const Vec3& originLla)
+{
+  origin_ = originLla;
+  sinLat_ = sin(originLla.lat());
+  cosLat_ = cos(originLla.lat());
+  sinLon_ = sin(originLla.lon());
+  cosLon_ = cos(originLla.lon());
+
+  // Same as the CoordinateConverter X-East rotation and translation
+  ecefToEnu_[0][0] = -sinLon_;
+  ecefToEnu_[0][1] =  cosLon_;
+  ecefToEnu_[0][2] =  0.0;
+  ecefToEnu_[1][0] = -sinLat_ * cosLon_;
+  ecefToEnu_[1][1] = -sinLat_ * sinLon_;
+  ecefToEnu_[1][2] =  cosLat_;
+  ecefToEnu_[2][0] = cosLat_ * cosLon_;
+  ecefToEnu_[2][1] = cosLat_ * sinLon_;
+  ecefToEnu_[2][2] = sinLat_;
+
+  const double c3 = WGS_A / sqrt(1.0 - WGS_ESQ * sinLat_ * sinLat_);
+  const double c4 = (c3 + originLla.alt()) * cosLat_;
+  const double c5 = (WGS_ESQC * c3 + originLla.alt()) * sinLat_;
+  originEcef_.set(cosLon_ * c4, sinLon_ * c4, c5);
+}
+
+void LocalFrame::localToEarthMatrix(LocalLevelFrame localLevelFrame, double localToEarth[][3]) const
+{
+  fillLocalToEarthMatrix(sinLat_, cosLat_, sinLon_, cosLon_, localLevelFrame, localToEarth);
+}
+
+void LocalFrame::ecefToEnu(const Vec3& ecefPos, Vec3& enuPos) const
+{
+  d3Mv3Mult(ecefToEnu_, ecefPos - originEcef_, enuPos);
+}
+
+void LocalFrame::enuToEcef(const Vec3& enuPos, Vec3& ecefPos) const
+{
+  Vec3 pos;
+  d3MTv3Mult(ecefToEnu_, enuPos, pos);
+  ecefPos = pos + originEcef_;
+}
+
+void LocalFrame::geodeticToEnu(const Vec3& llaPos, Vec3& enuPos) const
+{
+  Vec3 ecefPos;
+  CoordinateConverter::convertGeodeticPosToEcef(llaPos, ecefPos);
+  ecefToEnu(ecefPos, enuPos);
+}
+
+void LocalFrame::enuToGeodetic(const Vec3& enuPos, Vec3& llaPos) const
+{
+  Vec3 ecefPos;
+  enuToEcef(enuPos, ecefPos);
+  CoordinateConverter::convertEcefToGeodeticPos(ecefPos, llaPos);
+}
+
 } // namespace simCore
@@ -24,7 +24,9 @@
 #define SIMCORE_CALC_COORDCONVERT_H
 
 #include <cassert>
+#include <cstddef>
 #include <optional>
+#include <span>
 
 #include "simCore/Common/Common.h"
 #include "simCore/Calc/CoordinateSystem.h"
@@ -110,6 +112,22 @@ namespace simCore
     LOCAL_LEVEL_FRAME_ENU     ///< Local level ENU frame: +X=East, +Y=North, +Z=Up, perpendicular to Earth surface
   };
 
+  /**
+  * Positions of many points held as three parallel arrays (structure of arrays), for the batch
+  * conversions of CoordinateConverter.  Components follow Vec3: x|lat, y|lon and z|alt, with
+  * angles in radians.  All three arrays must have the same size.
+  */
+  template <typename T>
+  struct PositionSpans
+  {
+    std::span<T> x;  ///< X (m) or latitude (rad)
+    std::span<T> y;  ///< Y (m) or longitude (rad)
+    std::span<T> z;  ///< Z (m) or altitude (m)
+
+    /// Number of positions, from the X array
+    size_t size() const { return x.size(); }
+  };
+
   class SDKCORE_EXPORT CoordinateConverter
   {
   public:
@@ -128,6 +146,23 @@ namespace simCore
       REF_ORIGIN_SCALED_FLAT_EARTH_DEGENERATE = 2
     };
 
+    /**
+    * Algorithms for converting ECEF positions to geodetic, selected per call.  Errors are the worst
+    * seen over the NGA gold data, altitudes -100 km to 50000 km; see GoldDataCoordConvertTest.
+    * Positions on the Z axis or within 100 km of the center of the earth always use Fukushima's method.
+    * convert(), convertPositions() and the conversions that do not name an algorithm use Olson's
+    * method, which was both the fastest and the most accurate over the gold data.
+    */
+    enum EcefToGeodeticAlgorithm
+    {
+      /** Fukushima (2006), Halley's method; within 1 mm */
+      ECEF_TO_GEODETIC_FUKUSHIMA = 0,
+      /** Vermeille (2004) exact closed form; within 1 micron, about twice the cost of Fukushima */
+      ECEF_TO_GEODETIC_VERMEILLE,
+      /** Olson (1996) closed form with one correction; within 1 micron, slightly faster than Fukushima.  The default */
+      ECEF_TO_GEODETIC_OLSON
+    };
+
     CoordinateConverter();
     /// copy constructor
     CoordinateConverter(const CoordinateConverter& other);
@@ -295,6 +330,37 @@ namespace simCore
     */
     int convert(const Coordinate &inCoord, Coordinate &outCoord, CoordinateSystem outSystem) const;
 
+    /**
+    * @brief Converts the positions of many points between the supported projections
+    *
+    * Positions only; gives the same results as convert() on each point.  Points are converted in
+    * blocks, one conversion step at a time over contiguous arrays, and split across the shared
+    * worker threads (see simCore::runRanges()) if numThreads is more than 1.
+    * @param[in ] inSystem Projection system of the input positions
+    * @param[in ] inPos Input positions
+    * @param[in ] outSystem Projection system of the output positions
+    * @param[out] outPos Output positions, same size as inPos; must not overlap inPos
+    * @param[in ] elapsedEciTime Elapsed ECI time of all the points (s), used when converting to/from ECI
+    * @param[in ] numThreads Number of threads to use, including the calling thread; 0 or 1 converts on the calling thread
+    * @return 0 on success, !0 on failure
+    */
+    int convertPositions(CoordinateSystem inSystem, const PositionSpans<const double>& inPos, CoordinateSystem outSystem, const PositionSpans<double>& outPos,
+      double elapsedEciTime = 0.0, unsigned int numThreads = 1) const;
+
+    /**
+    * @brief Converts the positions of many points, each with its own elapsed ECI time
+    *
+    * @param[in ] inSystem Projection system of the input positions
+    * @param[in ] inPos Input positions
+    * @param[in ] outSystem Projection system of the output positions
+    * @param[out] outPos Output positions, same size as inPos; must not overlap inPos
+    * @param[in ] elapsedEciTimes Elapsed ECI time of each point (s), same size as inPos; used when converting to/from ECI
+    * @param[in ] numThreads Number of threads to use, including the calling thread; 0 or 1 converts on the calling thread
+    * @return 0 on success, !0 on failure
+    */
+    int convertPositions(CoordinateSystem inSystem, const PositionSpans<const double>& inPos, CoordinateSystem outSystem, const PositionSpans<double>& outPos,
+      std::span<const double> elapsedEciTimes, unsigned int numThreads = 1) const;
+
     //------------------------------------------------------------------------
     // Static functions which perform coordinate system conversions but do not
     // maintain any state information in the CoordinateConverter class
@@ -487,6 +553,39 @@ namespace simCore
     */
     static int convertEcefToGeodeticPos(const Vec3 &ecefPos, Vec3 &llaPos);
 
+    /**
+    * @brief Converts an Earth Centered Earth Fixed (ECEF) position to geodetic with the given algorithm
+    *
+    * @param[in ] ecefPos
+    * @param[out] llaPos
+    * @param[in ] algorithm Algorithm to use
+    * @return 0 on success, !0 on failure
+    * @pre out param valid
+    */
+    static int convertEcefToGeodeticPos(const Vec3 &ecefPos, Vec3 &llaPos, EcefToGeodeticAlgorithm algorithm);
+
+    /**
+    * @brief Converts the positions of many points from geodetic to ECEF, using the WGS-84 ellipsoid
+    *
+    * @param[in ] llaPos Geodetic positions, lat(rad), lon(rad), alt(m)
+    * @param[out] ecefPos ECEF positions (m), same size as llaPos; must not overlap llaPos
+    * @param[in ] numThreads Number of threads to use, including the calling thread; 0 or 1 converts on the calling thread
+    * @return 0 on success, !0 on failure
+    */
+    static int convertGeodeticPosToEcef(const PositionSpans<const double>& llaPos, const PositionSpans<double>& ecefPos, unsigned int numThreads = 1);
+
+    /**
+    * @brief Converts the positions of many points from ECEF to geodetic
+    *
+    * @param[in ] ecefPos ECEF positions (m)
+    * @param[out] llaPos Geodetic positions, lat(rad), lon(rad), alt(m), same size as ecefPos; must not overlap ecefPos
+    * @param[in ] numThreads Number of threads to use, including the calling thread; 0 or 1 converts on the calling thread
+    * @param[in ] algorithm Algorithm to use
+    * @return 0 on success, !0 on failure
+    */
+    static int convertEcefToGeodeticPos(const PositionSpans<const double>& ecefPos, const PositionSpans<double>& llaPos, unsigned int numThreads = 1,
+      EcefToGeodeticAlgorithm algorithm = ECEF_TO_GEODETIC_OLSON);
+
     /**
     * @brief Converts an Earth Centered Earth Fixed (ECEF) velocity to geodetic
     *
@@ -841,6 +940,68 @@ namespace simCore
     void reverseTPOffsetRotate_(Coordinate& gtpCoord) const;
   };
 
+  /**
+  * Tangent plane frame at a reference LLA, with the trig terms, the ECEF position and the ENU rotation
+  * of the reference cached.  Converting many positions relative to one host, such as for the
+  * relative geometry in Calculations.h, reuses one frame instead of recomputing them per position.
+  * The local ENU system matches COORD_SYS_XEAST of a CoordinateConverter with the same reference origin.
+  */
+  class SDKCORE_EXPORT LocalFrame
+  {
+  public:
+    /** Frame at lat, lon, alt 0, 0, 0 */
+    LocalFrame();
+    /** Frame at a reference lat (rad), lon (rad) and alt (m) */
+    explicit LocalFrame(const Vec3& originLla);
+    virtual ~LocalFrame();
+
+    /** Moves the frame to a reference lat (rad), lon (rad) and alt (m); nothing is recomputed if it did not change */
+    void setOrigin(const Vec3& originLla);
+    /** Reference lat (rad), lon (rad) and alt (m) */
+    const Vec3& origin() const { return origin_; }
+    /** ECEF position of the reference (m) */
+    const Vec3& originEcef() const { return originEcef_; }
+
+    /** Sine of the reference latitude */
+    double sinLat() const { return sinLat_; }
+    /** Cosine of the reference latitude */
+    double cosLat() const { return cosLat_; }
+    /** Sine of the reference longitude */
+    double sinLon() const { return sinLon_; }
+    /** Cosine of the reference longitude */
+    double cosLon() const { return cosLon_; }
+
+    /**
+    * Fills the local to Earth rotation matrix at the reference, the same as
+    * CoordinateConverter::setLocalToEarthMatrix() without the trig
+    * @param[in ] localLevelFrame alignment of local geodetic horizon system (NED, ENU, NWU)
+    * @param[out] localToEarth 3x3 rotation matrix
+    */
+    void localToEarthMatrix(LocalLevelFrame localLevelFrame, double localToEarth[][3]) const;
+
+    /** Converts an ECEF position (m) to local ENU (m) */
+    void ecefToEnu(const Vec3& ecefPos, Vec3& enuPos) const;
+    /** Converts a local ENU position (m) to ECEF (m) */
+    void enuToEcef(const Vec3& enuPos, Vec3& ecefPos) const;
+    /** Converts an LLA position (rad, rad, m) to local ENU (m) */
+    void geodeticToEnu(const Vec3& llaPos, Vec3& enuPos) const;
+    /** Converts a local ENU position (m) to LLA (rad, rad, m) */
+    void enuToGeodetic(const Vec3& enuPos, Vec3& llaPos) const;
+
+  private:
+    /// Computes the cached values for the reference
+    void computeOrigin_(const Vec3& originLla);
+
+    Vec3 origin_;
+    Vec3 originEcef_;
+    double sinLat_;
+    double cosLat_;
+    double sinLon_;
+    double cosLon_;
+    /// ECEF to ENU rotation; rows are the east, north and up unit vectors
+    double ecefToEnu_[3][3];
+  };
+
 } // End namespace simCore
 
 #endif /* SIMCORE_CALC_COORDCONVERT_H */
@@ -0,0 +1,1008 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <utility>
+#include "simNotify/Notify.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Geodesic.h"
+#include "simCore/System/ParallelRanges.h"
+
+// Reference for the Karney solutions:
+// C. F. F. Karney, "Algorithms for geodesics", J. Geodesy 87, 43-55 (2013).
+// Series are to sixth order in the third flattening, following the author's GeographicLib.
+
+namespace simCore
+{
+
+/// Order of the series in the third flattening
+static const int GEODESIC_ORDER = 6;
+/// Size of the coefficient arrays; index 0 is not used by the sine series
+static const int GEODESIC_COEFFS = GEODESIC_ORDER + 1;
+/// Newton iterations before falling back to bisection
+static const unsigned int GEODESIC_MAX_NEWTON = 20;
+/// Total iterations, enough for bisection to reach full precision
+static const unsigned int GEODESIC_MAX_ITERATIONS = GEODESIC_MAX_NEWTON + DBL_MANT_DIG + 10;
+/// Fewest pairs worth giving a thread of their own
+static const size_t GEODESIC_MIN_PER_THREAD = 1024;
+
+static const double TINY = sqrt(DBL_MIN);
+static const double TOL0 = DBL_EPSILON;
+static const double TOL1 = 200 * TOL0;
+static const double TOL2 = sqrt(TOL0);
+static const double TOLB = TOL0 * TOL2;
+static const double XTHRESH = 1000 * TOL2;
+
+/** Evaluates a polynomial of order n with coefficients p, highest power first */
+static double polyval(int n, const double* p, double x)
+{
+  double y = (n < 0) ? 0 : *p++;
+  while (--n >= 0)
+    y = y * x + *p++;
+  return y;
+}
+
+/** Normalizes a sine and cosine pair */
+static void norm2(double& sinx, double& cosx)
+{
+  const double r = hypot(sinx, cosx);
+  sinx /= r;
+  cosx /= r;
+}
+
+/**
+* Clenshaw summation of sum(c[i] * sin(2*i*x), i = 1..n) if sinp, else sum(c[i] * cos((2*i+1)*x), i = 0..n-1)
+*/
+static double sinCosSeries(bool sinp, double sinx, double cosx, const double c[], int n)
+{
+  c += (n + (sinp ? 1 : 0));
+  // 2 * cos(2 * x)
+  const double ar = 2 * (cosx - sinx) * (cosx + sinx);
+  double y0 = (n & 1) ? *--c : 0;
+  double y1 = 0;
+  n /= 2;
+  while (n--)
+  {
+    y1 = ar * y0 - y1 + *--c;
+    y0 = ar * y1 - y0 + *--c;
+  }
+  return sinp ? 2 * sinx * cosx * y0 : cosx * (y0 - y1);
+}
+
+/** Positive root k of k^4 + 2k^3 - (x^2 + y^2 - 1)k^2 - 2y^2k - y^2 = 0 */
+static double astroid(double x, double y)
+{
+  const double p = x * x;
+  const double q = y * y;
+  const double r = (p + q - 1) / 6;
+  if (q == 0 && r <= 0)
+    return 0;
+
+  const double s = p * q / 4;
+  const double r2 = r * r;
+  const double r3 = r * r2;
+  // Zero on the evolute curve p^(1/3) + q^(1/3) = 1
+  const double disc = s * (s + 2 * r3);
+  double u = r;
+  if (disc >= 0)
+  {
+    // Sign of the root chosen to avoid cancellation
+    double t3 = s + r3;
+    t3 += (t3 < 0) ? -sqrt(disc) : sqrt(disc);
+    const double t = cbrt(t3);
+    u += t + (t != 0 ? r2 / t : 0);
+  }
+  else
+  {
+    const double ang = atan2(sqrt(-disc), -(s + r3));
+    u += 2 * r * cos(ang / 3);
+  }
+  const double v = sqrt(u * u + q);
+  const double uv = (u < 0) ? q / (v - u) : u + v;
+  const double w = (uv - q) / (2 * v);
+  return uv / (sqrt(uv + w * w) + w);
+}
+
+/** A1 - 1 */
+static double a1m1f(double eps)
+{
+  static const double coeff[] = { 1, 4, 64, 0, 256 };
+  const int m = GEODESIC_ORDER / 2;
+  const double t = polyval(m, coeff, eps * eps) / coeff[m + 1];
+  return (t + eps) / (1 - eps);
+}
+
+/** C1 coefficients into c[1..6] */
+static void c1f(double eps, double c[])
+{
+  static const double coeff[] = {
+    -1, 6, -16, 32,
+    -9, 64, -128, 2048,
+    9, -16, 768,
+    3, -5, 512,
+    -7, 1280,
+    -7, 2048,
+  };
+  const double eps2 = eps * eps;
+  double d = eps;
+  int o = 0;
+  for (int l = 1; l <= GEODESIC_ORDER; ++l)
+  {
+    const int m = (GEODESIC_ORDER - l) / 2;
+    c[l] = d * polyval(m, coeff + o, eps2) / coeff[o + m + 1];
+    o += m + 2;
+    d *= eps;
+  }
+}
+
+/** C1' coefficients, for the reverted distance series, into c[1..6] */
+static void c1pf(double eps, double c[])
+{
+  static const double coeff[] = {
+    205, -432, 768, 1536,
+    4005, -4736, 3840, 12288,
+    -225, 116, 384,
+    -7173, 2695, 7680,
+    3467, 7680,
+    38081, 61440,
+  };
+  const double eps2 = eps * eps;
+  double d = eps;
+  int o = 0;
+  for (int l = 1; l <= GEODESIC_ORDER; ++l)
+  {
+    const int m = (GEODESIC_ORDER - l) / 2;
+    c[l] = d * polyval(m, coeff + o, eps2) / coeff[o + m + 1];
+    o += m + 2;
+    d *= eps;
+  }
+}
+
+/** A2 - 1 */
+static double a2m1f(double eps)
+{
+  static const double coeff[] = { -11, -28, -192, 0, 256 };
+  const int m = GEODESIC_ORDER / 2;
+  const double t = polyval(m, coeff, eps * eps) / coeff[m + 1];
+  return (t - eps) / (1 + eps);
+}
+
+/** C2 coefficients into c[1..6] */
+static void c2f(double eps, double c[])
+{
+  static const double coeff[] = {
+    1, 2, 16, 32,
+    35, 64, 384, 2048,
+    15, 80, 768,
+    7, 35, 512,
+    63, 1280,
+    77, 2048,
+  };
+  const double eps2 = eps * eps;
+  double d = eps;
+  int o = 0;
+  for (int l = 1; l <= GEODESIC_ORDER; ++l)
+  {
+    const int m = (GEODESIC_ORDER - l) / 2;
+    c[l] = d * polyval(m, coeff + o, eps2) / coeff[o + m + 1];
+    o += m + 2;
+    d *= eps;
+  }
+}
+
+/** Fills a range of indices, splitting large counts across the shared worker threads */
+static void fillRanges(size_t count, unsigned int numThreads, const RangeFunction& fill)
+{
+  const size_t maxRanges = (count + GEODESIC_MIN_PER_THREAD - 1) / GEODESIC_MIN_PER_THREAD;
+  runRanges(count, std::min<size_t>(std::max(numThreads, 1u), maxRanges), fill);
+}
+
+/** Returns the common value of a one value array, or the value at the index */
+static double valueAt(std::span<const double> values, size_t index)
+{
+  return (values.size() == 1) ? values[0] : values[index];
+}
+
+///////////////////////////////////////////////////////////////////////
+
+struct Geodesic::Line
+{
+  double salp0 = 0.;
+  double calp0 = 0.;
+  double ssig1 = 0.;
+  double csig1 = 0.;
+  double somg1 = 0.;
+  double comg1 = 0.;
+  double k2 = 0.;
+  double a1m1 = 0.;
+  double b11 = 0.;
+  double stau1 = 0.;
+  double ctau1 = 0.;
+  double a3c = 0.;
+  double b31 = 0.;
+  double c1a[GEODESIC_COEFFS] = {};
+  double c1pa[GEODESIC_COEFFS] = {};
+  double c3a[GEODESIC_ORDER] = {};
+};
+
+struct Geodesic::SodanoOrigin
+{
+  double lat = 0.;
+  double sbet1 = 0.;
+  double cbet1 = 0.;
+  /// Eccentricity term of the direct solution
+  double directScale = 0.;
+};
+
+Geodesic::Geodesic(double equatorialRadius, double flattening)
+  : a_(equatorialRadius),
+    f_(flattening)
+{
+  assert(flattening >= 0. && flattening < 1.);
+  f1_ = 1. - f_;
+  e2_ = f_ * (2. - f_);
+  ep2_ = e2_ / (f1_ * f1_);
+  n_ = f_ / (2. - f_);
+  b_ = a_ * f1_;
+  etol2_ = 0.1 * TOL2 / sqrt(std::max(0.001, fabs(f_)) * std::min(1.0, 1. - f_ / 2.) / 2.);
+
+  // A3 coefficients of eps^5 down to eps^0, each a polynomial in n
+  static const double a3Coeff[] = {
+    -3, 128,
+    -2, -3, 64,
+    -1, -3, -1, 16,
+    3, -1, -2, 8,
+    1, -1, 2,
+    1, 1,
+  };
+  int o = 0;
+  int k = 0;
+  for (int j = GEODESIC_ORDER - 1; j >= 0; --j)
+  {
+    const int m = std::min(GEODESIC_ORDER - j - 1, j);
+    a3x_[k++] = polyval(m, a3Coeff + o, n_) / a3Coeff[o + m + 1];
+    o += m + 2;
+  }
+
+  // C3[l] coefficients of eps^5 down to eps^l, each a polynomial in n
+  static const double c3Coeff[] = {
+    3, 128,
+    2, 5, 128,
+    -1, 3, 3, 64,
+    -1, 0, 1, 8,
+    -1, 1, 4,
+    5, 256,
+    1, 3, 128,
+    -3, -2, 3, 64,
+    1, -3, 2, 32,
+    7, 512,
+    -10, 9, 384,
+    5, -9, 5, 192,
+    7, 512,
+    -14, 7, 512,
+    21, 2560,
+  };
+  o = 0;
+  k = 0;
+  for (int l = 1; l < GEODESIC_ORDER; ++l)
+  {
+    for (int j = GEODESIC_ORDER - 1; j >= l; --j)
+    {
+      const int m = std::min(GEODESIC_ORDER - j - 1, j);
+      c3x_[k++] = polyval(m, c3Coeff + o, n_) / c3Coeff[o + m + 1];
+      o += m + 2;
+    }
+  }
+
+  sodanoPolar_ = a_ * (1.0 - f_);
+  sodanoFlat_ = 1. - (sodanoPolar_ / a_);
+  sodanoEcc2_ = (a_ * a_ - sodanoPolar_ * sodanoPolar_) / (sodanoPolar_ * sodanoPolar_);
+  sodanoN_ = (a_ - sodanoPolar_) / (a_ + sodanoPolar_);
+}
+
+Geodesic::~Geodesic()
+{
+}
+
+double Geodesic::equatorialRadius() const
+{
+  return a_;
+}
+
+double Geodesic::flattening() const
+{
+  return f_;
+}
+
+double Geodesic::inverse(double lat1, double lon1, double lat2, double lon2, double* azFwd, double* azBck, Method method) const
+{
+  if (method == GEODESIC_SODANO)
+  {
+    SodanoOrigin origin;
+    initSodanoOrigin_(lat1, origin);
+    return sodanoInverse_(origin, lon1, lat2, lon2, azFwd, azBck);
+  }
+  return karneyInverse_(lat1, lon1, lat2, lon2, azFwd, azBck);
+}
+
+void Geodesic::direct(double lat1, double lon1, double azFwd, double distance, double* lat2, double* lon2, double* azBck, Method method) const
+{
+  if (method == GEODESIC_SODANO)
+  {
+    SodanoOrigin origin;
+    initSodanoOrigin_(lat1, origin);
+    sodanoDirect_(origin, lon1, azFwd, distance, lat2, lon2, azBck);
+    return;
+  }
+  Line line;
+  initLine_(lat1, azFwd, line);
+  linePosition_(line, lon1, distance, lat2, lon2, azBck);
+}
+
+int Geodesic::inverse(const GeodesicInverseInputs& inputs, const GeodesicInverseResults& results, Method method, unsigned int numThreads) const
+{
+  const size_t count = std::max({ inputs.lat1.size(), inputs.lon1.size(), inputs.lat2.size(), inputs.lon2.size() });
+  const auto inputOk = [count](size_t size) { return size == 1 || size == count; };
+  const auto resultOk = [count](size_t size) { return size == 0 || size == count; };
+  if (count == 0)
+    return 0;
+  if (!inputOk(inputs.lat1.size()) || !inputOk(inputs.lon1.size()) || !inputOk(inputs.lat2.size()) || !inputOk(inputs.lon2.size()) ||
+    !resultOk(results.distance.size()) || !resultOk(results.azFwd.size()) || !resultOk(results.azBck.size()))
+  {
+    SIM_ERROR << "Geodesic::inverse, array sizes differ: " << __LINE__ << std::endl;
+    return 1;
+  }
+
+  fillRanges(count, numThreads, [&](size_t begin, size_t end) { inverseRange_(inputs, results, method, begin, end); });
+  return 0;
+}
+
+int Geodesic::direct(const GeodesicDirectInputs& inputs, const GeodesicDirectResults& results, Method method, unsigned int numThreads) const
+{
+  const size_t count = std::max({ inputs.lat1.size(), inputs.lon1.size(), inputs.azFwd.size(), inputs.distance.size() });
+  const auto inputOk = [count](size_t size) { return size == 1 || size == count; };
+  const auto resultOk = [count](size_t size) { return size == 0 || size == count; };
+  if (count == 0)
+    return 0;
+  if (!inputOk(inputs.lat1.size()) || !inputOk(inputs.lon1.size()) || !inputOk(inputs.azFwd.size()) || !inputOk(inputs.distance.size()) ||
+    !resultOk(results.lat2.size()) || !resultOk(results.lon2.size()) || !resultOk(results.azBck.size()))
+  {
+    SIM_ERROR << "Geodesic::direct, array sizes differ: " << __LINE__ << std::endl;
+    return 1;
+  }
+
+  fillRanges(count, numThreads, [&](size_t begin, size_t end) { directRange_(inputs, results, method, begin, end); });
+  return 0;
+}
+
+void Geodesic::inverseRange_(const GeodesicInverseInputs& inputs, const GeodesicInverseResults& results, Method method, size_t begin, size_t end) const
+{
+  const bool oneOrigin = (inputs.lat1.size() == 1);
+  SodanoOrigin origin;
+  if (method == GEODESIC_SODANO && oneOrigin)
+    initSodanoOrigin_(inputs.lat1[0], origin);
+
+  for (size_t ii = begin; ii < end; ++ii)
+  {
+    double* azFwd = results.azFwd.empty() ? nullptr : &results.azFwd[ii];
+    double* azBck = results.azBck.empty() ? nullptr : &results.azBck[ii];
+    double distance;
+    if (method == GEODESIC_SODANO)
+    {
+      if (!oneOrigin)
+        initSodanoOrigin_(inputs.lat1[ii], origin);
+      distance = sodanoInverse_(origin, valueAt(inputs.lon1, ii), valueAt(inputs.lat2, ii), valueAt(inputs.lon2, ii), azFwd, azBck);
+    }
+    else
+      distance = karneyInverse_(valueAt(inputs.lat1, ii), valueAt(inputs.lon1, ii), valueAt(inputs.lat2, ii), valueAt(inputs.lon2, ii), azFwd, azBck);
+    if (!results.distance.empty())
+      results.distance[ii] = distance;
+  }
+}
+
+void Geodesic::directRange_(const GeodesicDirectInputs& inputs, const GeodesicDirectResults& results, Method method, size_t begin, size_t end) const
+{
+  const bool oneOrigin = (inputs.lat1.size() == 1);
+  // Lines with the same first point and azimuth differ only in length
+  const bool oneLine = oneOrigin && (inputs.azFwd.size() == 1);
+  SodanoOrigin origin;
+  Line line;
+  if (method == GEODESIC_SODANO && oneOrigin)
+    initSodanoOrigin_(inputs.lat1[0], origin);
+  else if (method == GEODESIC_KARNEY && oneLine)
+    initLine_(inputs.lat1[0], inputs.azFwd[0], line);
+
+  for (size_t ii = begin; ii < end; ++ii)
+  {
+    double* lat2 = results.lat2.empty() ? nullptr : &results.lat2[ii];
+    double* lon2 = results.lon2.empty() ? nullptr : &results.lon2[ii];
+    double* azBck = results.azBck.empty() ? nullptr : &results.azBck[ii];
+    if (method == GEODESIC_SODANO)
+    {
+      if (!oneOrigin)
+        initSodanoOrigin_(inputs.lat1[ii], origin);
+      sodanoDirect_(origin, valueAt(inputs.lon1, ii), valueAt(inputs.azFwd, ii), valueAt(inputs.distance, ii), lat2, lon2, azBck);
+    }
+    else
+    {
+      if (!oneLine)
+        initLine_(valueAt(inputs.lat1, ii), valueAt(inputs.azFwd, ii), line);
+      linePosition_(line, valueAt(inputs.lon1, ii), valueAt(inputs.distance, ii), lat2, lon2, azBck);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// Karney
+
+double Geodesic::a3f_(double eps) const
+{
+  return polyval(GEODESIC_ORDER - 1, a3x_, eps);
+}
+
+void Geodesic::c3f_(double eps, double c[]) const
+{
+  double mult = 1;
+  int o = 0;
+  for (int l = 1; l < GEODESIC_ORDER; ++l)
+  {
+    const int m = GEODESIC_ORDER - l - 1;
+    mult *= eps;
+    c[l] = mult * polyval(m, c3x_ + o, eps);
+    o += m + 1;
+  }
+}
+
+void Geodesic::lengths_(double eps, double sig12, double ssig1, double csig1, double dn1, double ssig2, double csig2, double dn2, double* s12b, double* m12b) const
+{
+  double ca[GEODESIC_COEFFS];
+  double cb[GEODESIC_COEFFS];
+  const double a1 = 1 + a1m1f(eps);
+  c1f(eps, ca);
+  const double b1 = sinCosSeries(true, ssig2, csig2, ca, GEODESIC_ORDER) - sinCosSeries(true, ssig1, csig1, ca, GEODESIC_ORDER);
+  if (s12b)
+    *s12b = a1 * (sig12 + b1);
+  if (!m12b)
+    return;
+
+  const double a2m1 = a2m1f(eps);
+  c2f(eps, cb);
+  const double m0 = (a1 - 1) - a2m1;
+  const double a2 = 1 + a2m1;
+  const double b2 = sinCosSeries(true, ssig2, csig2, cb, GEODESIC_ORDER) - sinCosSeries(true, ssig1, csig1, cb, GEODESIC_ORDER);
+  const double j12 = m0 * sig12 + (a1 * b1 - a2 * b2);
+  // Parentheses keep the cancellation accurate for coincident points
+  *m12b = dn2 * (csig1 * ssig2) - dn1 * (ssig1 * csig2) - csig1 * csig2 * j12;
+}
+
+double Geodesic::inverseStart_(double sbet1, double cbet1, double dn1, double sbet2, double cbet2, double dn2, double lam12, double slam12, double clam12,
+  double& salp1, double& calp1, double& salp2, double& calp2, double& dnm) const
+{
+  double sig12 = -1;
+  // bet12 = bet2 - bet1 in [0, pi); bet12a = bet2 + bet1 in (-pi, 0]
+  const double sbet12 = sbet2 * cbet1 - cbet2 * sbet1;
+  const double cbet12 = cbet2 * cbet1 + sbet2 * sbet1;
+  const double sbet12a = sbet2 * cbet1 + cbet2 * sbet1;
+  const bool shortLine = cbet12 >= 0 && sbet12 < 0.5 && cbet2 * lam12 < 0.5;
+  double somg12;
+  double comg12;
+  if (shortLine)
+  {
+    double sbetm2 = (sbet1 + sbet2) * (sbet1 + sbet2);
+    sbetm2 /= sbetm2 + (cbet1 + cbet2) * (cbet1 + cbet2);
+    dnm = sqrt(1 + ep2_ * sbetm2);
+    const double omg12 = lam12 / (f1_ * dnm);
+    somg12 = sin(omg12);
+    comg12 = cos(omg12);
+  }
+  else
+  {
+    somg12 = slam12;
+    comg12 = clam12;
+  }
+
+  salp1 = cbet2 * somg12;
+  calp1 = (comg12 >= 0) ?
+    sbet12 + cbet2 * sbet1 * somg12 * somg12 / (1 + comg12) :
+    sbet12a - cbet2 * sbet1 * somg12 * somg12 / (1 - comg12);
+
+  const double ssig12 = hypot(salp1, calp1);
+  const double csig12 = sbet1 * sbet2 + cbet1 * cbet2 * comg12;
+
+  if (shortLine && ssig12 < etol2_)
+  {
+    // Really short lines
+    salp2 = cbet1 * somg12;
+    calp2 = sbet12 - cbet1 * sbet2 * ((comg12 >= 0) ? somg12 * somg12 / (1 + comg12) : 1 - comg12);
+    norm2(salp2, calp2);
+    sig12 = atan2(ssig12, csig12);
+  }
+  else if (fabs(n_) > 0.1 || csig12 >= 0 || ssig12 >= 6 * fabs(n_) * M_PI * cbet1 * cbet1)
+  {
+    // Zeroth order spherical approximation is good enough
+  }
+  else
+  {
+    // Nearly antipodal; scale to coordinates where the antipodal point is at the origin and the singular point at (-1, 0)
+    const double lam12x = atan2(-slam12, -clam12);
+    const double k2 = sbet1 * sbet1 * ep2_;
+    const double eps = k2 / (2 * (1 + sqrt(1 + k2)) + k2);
+    const double lamscale = f_ * cbet1 * a3f_(eps) * M_PI;
+    const double betscale = lamscale * cbet1;
+    const double x = lam12x / lamscale;
+    const double y = sbet12a / betscale;
+
+    if (y > -TOL1 && x > -1 - XTHRESH)
+    {
+      // Strip near the cut
+      salp1 = std::min(1.0, -x);
+      calp1 = -sqrt(1 - salp1 * salp1);
+    }
+    else
+    {
+      // Estimate from the astroid problem
+      const double k = astroid(x, y);
+      const double omg12a = lamscale * (-x * k / (1 + k));
+      somg12 = sin(omg12a);
+      comg12 = -cos(omg12a);
+      salp1 = cbet2 * somg12;
+      calp1 = sbet12a - cbet2 * sbet1 * somg12 * somg12 / (1 - comg12);
+    }
+  }
+
+  // Backwards check allows NaN through
+  if (!(salp1 <= 0))
+    norm2(salp1, calp1);
+  else
+  {
+    salp1 = 1;
+    calp1 = 0;
+  }
+  return sig12;
+}
+
+double Geodesic::lambda12_(double sbet1, double cbet1, double dn1, double sbet2, double cbet2, double dn2, double salp1, double calp1, double slam120, double clam120,
+  double& salp2, double& calp2, double& sig12, double& ssig1, double& csig1, double& ssig2, double& csig2, double& eps, bool diffp, double& dlam12) const
+{
+  // Break the degeneracy of the equatorial line, which is handled before getting here
+  if (sbet1 == 0 && calp1 == 0)
+    calp1 = -TINY;
+
+  const double salp0 = salp1 * cbet1;
+  const double calp0 = hypot(calp1, salp1 * sbet1);
+
+  ssig1 = sbet1;
+  const double somg1 = salp0 * sbet1;
+  csig1 = calp1 * cbet1;
+  const double comg1 = csig1;
+  norm2(ssig1, csig1);
+
+  // Enforce symmetries when |bet2| = -bet1
+  salp2 = (cbet2 != cbet1) ? salp0 / cbet2 : salp1;
+  calp2 = (cbet2 != cbet1 || fabs(sbet2) != -sbet1) ?
+    sqrt(calp1 * cbet1 * calp1 * cbet1 + ((cbet1 < -sbet1) ? (cbet2 - cbet1) * (cbet1 + cbet2) : (sbet1 - sbet2) * (sbet1 + sbet2))) / cbet2 :
+    fabs(calp1);
+
+  ssig2 = sbet2;
+  const double somg2 = salp0 * sbet2;
+  csig2 = calp2 * cbet2;
+  const double comg2 = csig2;
+  norm2(ssig2, csig2);
+
+  // sig12 = sig2 - sig1 and omg12 = omg2 - omg1, limited to [0, pi]
+  sig12 = atan2(std::max(0.0, csig1 * ssig2 - ssig1 * csig2) + 0., csig1 * csig2 + ssig1 * ssig2);
+  const double somg12 = std::max(0.0, comg1 * somg2 - somg1 * comg2) + 0.;
+  const double comg12 = comg1 * comg2 + somg1 * somg2;
+  // eta = omg12 - lam120
+  const double eta = atan2(somg12 * clam120 - comg12 * slam120, comg12 * clam120 + somg12 * slam120);
+  const double k2 = calp0 * calp0 * ep2_;
+  eps = k2 / (2 * (1 + sqrt(1 + k2)) + k2);
+  double ca[GEODESIC_COEFFS];
+  c3f_(eps, ca);
+  const double b312 = sinCosSeries(true, ssig2, csig2, ca, GEODESIC_ORDER - 1) - sinCosSeries(true, ssig1, csig1, ca, GEODESIC_ORDER - 1);
+  const double domg12 = -f_ * a3f_(eps) * salp0 * (sig12 + b312);
+
+  if (diffp)
+  {
+    if (calp2 == 0)
+      dlam12 = -2 * f1_ * dn1 / sbet1;
+    else
+    {
+      lengths_(eps, sig12, ssig1, csig1, dn1, ssig2, csig2, dn2, nullptr, &dlam12);
+      dlam12 *= f1_ / (calp2 * cbet2);
+    }
+  }
+  return eta + domg12;
+}
+
+double Geodesic::karneyInverse_(double lat1, double lon1, double lat2, double lon2, double* azFwd, double* azBck) const
+{
+  // Transform to 0 <= lon12 <= pi, -pi/2 <= lat1 <= -0, lat1 <= lat2 <= -lat1; the signs record the transformation
+  double lon12 = std::remainder(lon2 - lon1, M_TWOPI);
+  int lonSign = std::signbit(lon12) ? -1 : 1;
+  lon12 *= lonSign;
+  const double lam12 = lon12;
+  const double slam12 = (lam12 == M_PI) ? 0. : sin(lam12);
+  const double clam12 = cos(lam12);
+  // Supplementary longitude difference
+  const double lon12s = M_PI - lon12;
+
+  // Point with the larger absolute latitude first
+  const int swapSign = (fabs(lat1) < fabs(lat2) || lat2 != lat2) ? -1 : 1;
+  if (swapSign < 0)
+  {
+    lonSign *= -1;
+    std::swap(lat1, lat2);
+  }
+  const int latSign = std::signbit(lat1) ? 1 : -1;
+  lat1 *= latSign;
+  lat2 *= latSign;
+
+  double sbet1 = f1_ * sin(lat1);
+  double cbet1 = cos(lat1);
+  norm2(sbet1, cbet1);
+  cbet1 = std::max(TINY, cbet1);
+  double sbet2 = f1_ * sin(lat2);
+  double cbet2 = cos(lat2);
+  norm2(sbet2, cbet2);
+  cbet2 = std::max(TINY, cbet2);
+
+  // Force bet2 = +/-bet1 exactly when the measure of |bet1| - |bet2| vanishes
+  if (cbet1 < -sbet1)
+  {
+    if (cbet2 == cbet1)
+      sbet2 = std::copysign(sbet1, sbet2);
+  }
+  else if (fabs(sbet2) == -sbet1)
+    cbet2 = cbet1;
+
+  const double dn1 = sqrt(1 + ep2_ * sbet1 * sbet1);
+  const double dn2 = sqrt(1 + ep2_ * sbet2 * sbet2);
+
+  double s12x = 0;
+  double m12x = 0;
+  double sig12 = 0;
+  double salp1 = 0;
+  double calp1 = 0;
+  double salp2 = 0;
+  double calp2 = 0;
+  bool meridian = (lat1 == -M_PI_2 || slam12 == 0);
+
+  if (meridian)
+  {
+    // Head to the target longitude, arriving heading north
+    calp1 = clam12;
+    salp1 = slam12;
+    calp2 = 1;
+    salp2 = 0;
+    const double ssig1 = sbet1;
+    const double csig1 = calp1 * cbet1;
+    const double ssig2 = sbet2;
+    const double csig2 = calp2 * cbet2;
+    sig12 = atan2(std::max(0.0, csig1 * ssig2 - ssig1 * csig2) + 0., csig1 * csig2 + ssig1 * ssig2);
+    lengths_(n_, sig12, ssig1, csig1, dn1, ssig2, csig2, dn2, &s12x, &m12x);
+    // A meridian with sig12 > pi/2 and m12 < 0 is not the shortest path
+    if (sig12 < 1 || m12x >= 0)
+    {
+      if (sig12 < 3 * TINY || (sig12 < TOL0 && (s12x < 0 || m12x < 0)))
+        sig12 = m12x = s12x = 0;
+      s12x *= b_;
+    }
+    else
+      meridian = false;
+  }
+
+  if (!meridian && sbet1 == 0 && (f_ <= 0 || lon12s >= f_ * M_PI))
+  {
+    // Along the equator
+    calp1 = calp2 = 0;
+    salp1 = salp2 = 1;
+    s12x = a_ * lam12;
+  }
+  else if (!meridian)
+  {
+    double dnm = 0;
+    sig12 = inverseStart_(sbet1, cbet1, dn1, sbet2, cbet2, dn2, lam12, slam12, clam12, salp1, calp1, salp2, calp2, dnm);
+    if (sig12 >= 0)
+    {
+      // Short line, solved by the starting estimate
+      s12x = sig12 * b_ * dnm;
+    }
+    else
+    {
+      // Newton's method on lambda12(alp1) - lam12 = 0, keeping a bracket (alp1a, alp1b) around the root and
+      // bisecting whenever a Newton step leaves it
+      double ssig1 = 0;
+      double csig1 = 0;
+      double ssig2 = 0;
+      double csig2 = 0;
+      double eps = 0;
+      double salp1a = TINY;
+      double calp1a = 1;
+      double salp1b = TINY;
+      double calp1b = -1;
+      bool tripn = false;
+      bool tripb = false;
+      for (unsigned int numit = 0; ; ++numit)
+      {
+        double dv = 0;
+        const double v = lambda12_(sbet1, cbet1, dn1, sbet2, cbet2, dn2, salp1, calp1, slam12, clam12,
+          salp2, calp2, sig12, ssig1, csig1, ssig2, csig2, eps, numit < GEODESIC_MAX_NEWTON, dv);
+        // Reversed test allows escape with NaNs
+        if (tripb || !(fabs(v) >= (tripn ? 8 : 1) * TOL0) || numit == GEODESIC_MAX_ITERATIONS)
+          break;
+        if (v > 0 && (numit > GEODESIC_MAX_NEWTON || calp1 / salp1 > calp1b / salp1b))
+        {
+          salp1b = salp1;
+          calp1b = calp1;
+        }
+        else if (v < 0 && (numit > GEODESIC_MAX_NEWTON || calp1 / salp1 < calp1a / salp1a))
+        {
+          salp1a = salp1;
+          calp1a = calp1;
+        }
+        if (numit < GEODESIC_MAX_NEWTON && dv > 0)
+        {
+          const double dalp1 = -v / dv;
+          if (fabs(dalp1) < M_PI)
+          {
+            const double sdalp1 = sin(dalp1);
+            const double cdalp1 = cos(dalp1);
+            const double nsalp1 = salp1 * cdalp1 + calp1 * sdalp1;
+            if (nsalp1 > 0)
+            {
+              calp1 = calp1 * cdalp1 - salp1 * sdalp1;
+              salp1 = nsalp1;
+              norm2(salp1, calp1);
+              // Convergence may be linear where the slope goes to 0
+              tripn = fabs(v) <= 16 * TOL0;
+              continue;
+            }
+          }
+        }
+        salp1 = (salp1a + salp1b) / 2;
+        calp1 = (calp1a + calp1b) / 2;
+        norm2(salp1, calp1);
+        tripn = false;
+        tripb = (fabs(salp1a - salp1) + (calp1a - calp1) < TOLB || fabs(salp1 - salp1b) + (calp1 - calp1b) < TOLB);
+      }
+      lengths_(eps, sig12, ssig1, csig1, dn1, ssig2, csig2, dn2, &s12x, nullptr);
+      s12x *= b_;
+    }
+  }
+
+  // Undo the transformation
+  if (swapSign < 0)
+  {
+    std::swap(salp1, salp2);
+    std::swap(calp1, calp2);
+  }
+  salp1 *= swapSign * lonSign;
+  calp1 *= swapSign * latSign;
+  salp2 *= swapSign * lonSign;
+  calp2 *= swapSign * latSign;
+
+  if (azFwd)
+    *azFwd = atan2(salp1, calp1);
+  if (azBck)
+    *azBck = atan2(-salp2, -calp2);
+  // Convert -0 to 0
+  return 0. + s12x;
+}
+
+void Geodesic::initLine_(double lat1, double azFwd, Line& line) const
+{
+  const double salp1 = sin(azFwd);
+  const double calp1 = cos(azFwd);
+  double sbet1 = f1_ * sin(lat1);
+  double cbet1 = cos(lat1);
+  norm2(sbet1, cbet1);
+  cbet1 = std::max(TINY, cbet1);
+
+  // sin(alp0) = sin(alp1) * cos(bet1)
+  line.salp0 = salp1 * cbet1;
+  line.calp0 = hypot(calp1, salp1 * sbet1);
+  // tan(bet1) = tan(sig1) * cos(alp1) and tan(omg1) = sin(alp0) * tan(sig1)
+  line.ssig1 = sbet1;
+  line.somg1 = line.salp0 * sbet1;
+  line.csig1 = line.comg1 = (sbet1 != 0 || calp1 != 0) ? cbet1 * calp1 : 1;
+  norm2(line.ssig1, line.csig1);
+
+  line.k2 = line.calp0 * line.calp0 * ep2_;
+  const double eps = line.k2 / (2 * (1 + sqrt(1 + line.k2)) + line.k2);
+
+  line.a1m1 = a1m1f(eps);
+  c1f(eps, line.c1a);
+  line.b11 = sinCosSeries(true, line.ssig1, line.csig1, line.c1a, GEODESIC_ORDER);
+  const double s = sin(line.b11);
+  const double c = cos(line.b11);
+  // tau1 = sig1 + B11
+  line.stau1 = line.ssig1 * c + line.csig1 * s;
+  line.ctau1 = line.csig1 * c - line.ssig1 * s;
+  c1pf(eps, line.c1pa);
+
+  c3f_(eps, line.c3a);
+  line.a3c = -f_ * line.salp0 * a3f_(eps);
+  line.b31 = sinCosSeries(true, line.ssig1, line.csig1, line.c3a, GEODESIC_ORDER - 1);
+}
+
+void Geodesic::linePosition_(const Line& line, double lon1, double distance, double* lat2, double* lon2, double* azBck) const
+{
+  // Reverted distance series gives the arc length
+  const double tau12 = distance / (b_ * (1 + line.a1m1));
+  const double s = sin(tau12);
+  const double c = cos(tau12);
+  const double b12 = -sinCosSeries(true, line.stau1 * c + line.ctau1 * s, line.ctau1 * c - line.stau1 * s, line.c1pa, GEODESIC_ORDER);
+  double sig12 = tau12 - (b12 - line.b11);
+  double ssig12 = sin(sig12);
+  double csig12 = cos(sig12);
+  if (fabs(f_) > 0.01)
+  {
+    // The reverted series is not accurate for larger flattening; correct with one Newton step
+    const double ssig2 = line.ssig1 * csig12 + line.csig1 * ssig12;
+    const double csig2 = line.csig1 * csig12 - line.ssig1 * ssig12;
+    const double b12b = sinCosSeries(true, ssig2, csig2, line.c1a, GEODESIC_ORDER);
+    const double serr = (1 + line.a1m1) * (sig12 + (b12b - line.b11)) - distance / b_;
+    sig12 = sig12 - serr / sqrt(1 + line.k2 * ssig2 * ssig2);
+    ssig12 = sin(sig12);
+    csig12 = cos(sig12);
+  }
+
+  // sig2 = sig1 + sig12
+  const double ssig2 = line.ssig1 * csig12 + line.csig1 * ssig12;
+  double csig2 = line.csig1 * csig12 - line.ssig1 * ssig12;
+  const double sbet2 = line.calp0 * ssig2;
+  double cbet2 = hypot(line.salp0, line.calp0 * csig2);
+  // Break the degeneracy of salp0 = 0 and csig2 = 0
+  if (cbet2 == 0)
+    cbet2 = csig2 = TINY;
+
+  if (lon2)
+  {
+    // tan(omg2) = sin(alp0) * tan(sig2)
+    const double somg2 = line.salp0 * ssig2;
+    const double comg2 = csig2;
+    const double omg12 = atan2(somg2 * line.comg1 - comg2 * line.somg1, comg2 * line.comg1 + somg2 * line.somg1);
+    const double lam12 = omg12 + line.a3c * (sig12 + (sinCosSeries(true, ssig2, csig2, line.c3a, GEODESIC_ORDER - 1) - line.b31));
+    *lon2 = angFixPI(lon1 + lam12);
+  }
+  if (lat2)
+    *lat2 = atan2(sbet2, f1_ * cbet2);
+  // tan(alp0) = cos(sig2) * tan(alp2)
+  if (azBck)
+    *azBck = atan2(-line.salp0, -line.calp0 * csig2);
+}
+
+///////////////////////////////////////////////////////////////////////
+// Sodano
+
+void Geodesic::initSodanoOrigin_(double lat1, SodanoOrigin& origin) const
+{
+  origin.lat = lat1;
+  const double beta1 = atan2((sodanoPolar_ * sin(lat1)), (a_ * cos(lat1)));
+  origin.sbet1 = sin(beta1);
+  origin.cbet1 = cos(beta1);
+  origin.directScale = 1. + 0.5 * sodanoEcc2_ * origin.sbet1 * origin.sbet1;
+}
+
+double Geodesic::sodanoInverse_(const SodanoOrigin& origin, double lon1, double lat2, double lon2, double* azFwd, double* azBck) const
+{
+  // Same steps as sodanoInverse(), with the ellipsoid and first point terms calculated ahead
+  const double refLat = origin.lat;
+  if (refLat == lat2 && lon1 == lon2)
+  {
+    if (azFwd) *azFwd = 0;
+    if (azBck) *azBck = 0;
+    return 0.0;
+  }
+
+  const double reqtr = a_;
+  const double rpolr = sodanoPolar_;
+  const double flat = sodanoFlat_;
+  const double deltaLon = lon2 - lon1;
+  const double beta2 = atan2((rpolr*sin(lat2)), (reqtr*cos(lat2)));
+  const double sbet1 = origin.sbet1;
+  const double sbet2 = sin(beta2);
+  const double cbet1 = origin.cbet1;
+  const double cbet2 = cos(beta2);
+  const double sl = sin(deltaLon);
+  const double sl2 = sin(0.5*deltaLon);
+
+  const double a = sbet1*sbet2;
+  const double b = cbet1*cbet2;
+  const double cdel = a + b*cos(deltaLon);
+  const double n = sodanoN_;
+  const double b2mb1 = (lat2-refLat) + 2.*(a*(n + n*n + n*n*n)-b*(n - n*n + n*n*n)) * sin(lat2-refLat);
+
+  const double d = sin(b2mb1) + 2.*cbet2*sbet1*sl2*sl2;
+  const double sdel = sqrt(sl*sl*cbet2*cbet2 + d*d);
+  const double delta = fabs(atan2(sdel, cdel));
+
+  const double c = b*sl/sdel;
+  const double m = 1. - c*c;
+  const double f2 = flat*flat;
+  const double d2 = delta*delta;
+
+  if (azFwd || azBck)
+  {
+    const double lamda = deltaLon+c*((flat+f2)*delta-0.5*a*f2*(sdel+2.*d2/sdel)+
+      0.25*m*f2*(sdel*cdel-5.*delta+4.*d2/tan(delta)));
+
+    const double slam = sin(lamda);
+    const double slam2 = sin(0.5*lamda);
+
+    if (azFwd) *azFwd = atan2((cbet2*slam), (sin(b2mb1) + 2.*cbet2*sbet1*slam2*slam2));
+    if (azBck) *azBck = atan2((-cbet1*slam), (2.*cbet1*sbet2*slam2*slam2 - sin(b2mb1)));
+  }
+
+  return rpolr*((1.+flat+f2)*delta + a*((flat+f2)*sdel-f2*d2/(2.*sdel))
+    -0.5*m*((flat+f2)*(delta+sdel*cdel)-f2*d2/tan(delta))
+    -0.5*a*a*f2*sdel*cdel+(f2*m*m/16.)
+    *(delta+sdel*cdel-2.*sdel*cdel*cdel*cdel-8.*d2/tan(delta))
+    +0.5*a*m*f2*(sdel*cdel*cdel+d2/sdel));
+}
+
+void Geodesic::sodanoDirect_(const SodanoOrigin& origin, double lon1, double azFwd, double distance, double* lat2, double* lon2, double* azBck) const
+{
+  // Same steps as sodanoDirect(), with the ellipsoid and first point terms calculated ahead
+  const double reqtr = a_;
+  const double rpolr = sodanoPolar_;
+  const double flat = sodanoFlat_;
+  const double ecc2 = sodanoEcc2_;
+  const double theta = distance / rpolr;
+
+  const double sbeta1 = origin.sbet1;
+  const double cbeta1 = origin.cbet1;
+  const double stheta = sin(theta);
+  const double ctheta = cos(theta);
+  const double saz = sin(azFwd);
+  const double caz = cos(azFwd);
+
+  const double g = cbeta1*caz;
+  const double h = cbeta1*saz;
+
+  const double m = origin.directScale*(1.-h*h)*0.5;
+  const double n = origin.directScale*(ctheta*sbeta1*sbeta1+g*sbeta1*stheta)*0.5;
+  const double length = h*(-flat*theta+3.*flat*flat*n*stheta+3.*flat*flat*m*(theta-stheta*ctheta)*0.5);
+  const double capm = m*ecc2;
+  const double capn = n*ecc2;
+  const double delta = theta - capn*stheta + 0.5*capm*(stheta*ctheta - theta) + (5./2.)*capn*capn*stheta*ctheta +
+    (capm*capm/16.)*(11.*theta-13.*stheta*ctheta-8.*theta*ctheta*ctheta+10.*stheta*ctheta*ctheta*ctheta)
+    + 0.5*capm*capn*(3.*stheta+2.*theta*ctheta-5.*stheta*ctheta*ctheta);
+
+  const double sdel = sin(delta);
+  const double cdel = cos(delta);
+  const double f = g*cdel - sbeta1*sdel;
+  const double sbeta2 = sbeta1*cdel + g*sdel;
+  const double cbeta2 = sqrt(h*h + f*f);
+  const double lamda = atan2((sdel*saz), (cbeta1*cdel - sbeta1*sdel*caz));
+
+  if (lat2) *lat2 = atan2(reqtr*sbeta2, rpolr*cbeta2);
+  if (lon2) *lon2 = lon1 + lamda + length;
+  if (azBck) *azBck = atan2(-h, (sbeta1*sdel - g*cdel));
+}
+
+}
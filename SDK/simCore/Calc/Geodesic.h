@@ -0,0 +1,214 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_CALC_GEODESIC_H
+#define SIMCORE_CALC_GEODESIC_H
+
+/** @file
+* Direct and inverse geodesic solutions on an ellipsoid, for single pairs of points or for arrays of pairs.
+* Units are meters for distance and radians for latitude, longitude and azimuth.
+*/
+
+#include <span>
+#include "simCore/Common/Common.h"
+#include "simCore/Calc/CoordinateSystem.h"
+
+namespace simCore
+{
+  /** Point pairs for Geodesic::inverse(); each array holds either one value, shared by every pair, or one value per pair */
+  struct GeodesicInverseInputs
+  {
+    std::span<const double> lat1;  ///< Latitude of the first point (rad)
+    std::span<const double> lon1;  ///< Longitude of the first point (rad)
+    std::span<const double> lat2;  ///< Latitude of the second point (rad)
+    std::span<const double> lon2;  ///< Longitude of the second point (rad)
+  };
+
+  /** Outputs of Geodesic::inverse(), one entry per pair; quantities with an empty array are not calculated */
+  struct GeodesicInverseResults
+  {
+    std::span<double> distance;  ///< Geodesic length from the first point to the second (m)
+    std::span<double> azFwd;     ///< Forward azimuth at the first point (rad)
+    std::span<double> azBck;     ///< Back azimuth at the second point, toward the first point (rad)
+  };
+
+  /** Starting points for Geodesic::direct(); each array holds either one value, shared by every line, or one value per line */
+  struct GeodesicDirectInputs
+  {
+    std::span<const double> lat1;      ///< Latitude of the first point (rad)
+    std::span<const double> lon1;      ///< Longitude of the first point (rad)
+    std::span<const double> azFwd;     ///< Forward azimuth at the first point (rad)
+    std::span<const double> distance;  ///< Geodesic length to the second point (m)
+  };
+
+  /** Outputs of Geodesic::direct(), one entry per line; quantities with an empty array are not calculated */
+  struct GeodesicDirectResults
+  {
+    std::span<double> lat2;   ///< Latitude of the second point (rad)
+    std::span<double> lon2;   ///< Longitude of the second point (rad)
+    std::span<double> azBck;  ///< Back azimuth at the second point, toward the first point (rad)
+  };
+
+  /**
+  * Solves the direct and inverse geodesic problems on an oblate ellipsoid.  Values that depend only on the
+  * ellipsoid are calculated once at construction, and the array versions also calculate values shared by
+  * every pair, such as a common first point, once per call.  Instances are not changed by the solutions, so
+  * one instance may be shared by several threads.
+  */
+  class SDKCORE_EXPORT Geodesic
+  {
+  public:
+    /** Solution methods */
+    enum Method
+    {
+      /**
+      * Karney (2013) series solution with Newton's method for the inverse problem; within 15 nanometers for
+      * any pair of points, including nearly antipodal points.  The default
+      */
+      GEODESIC_KARNEY = 0,
+      /**
+      * Sodano (1963) closed form, the same as sodanoDirect() and sodanoInverse(); about 3.5 times faster than
+      * Karney for the inverse problem and 1.7 times for the direct problem.  Distance errors are about 4 mm per
+      * 100 km, and reach tens of meters near antipodal points
+      */
+      GEODESIC_SODANO
+    };
+
+    /**
+    * Constructs a solver for an ellipsoid, WGS-84 by default
+    * @param[in ] equatorialRadius Semi-major axis of the ellipsoid (m)
+    * @param[in ] flattening Flattening of the ellipsoid, at least 0 and less than 1
+    */
+    explicit Geodesic(double equatorialRadius = WGS_A, double flattening = WGS_F);
+    virtual ~Geodesic();
+
+    /** Semi-major axis of the ellipsoid (m) */
+    double equatorialRadius() const;
+    /** Flattening of the ellipsoid */
+    double flattening() const;
+
+    /**
+    * Calculates the geodesic length and azimuths between two points
+    * @param[in ] lat1 Latitude of the first point (rad)
+    * @param[in ] lon1 Longitude of the first point (rad)
+    * @param[in ] lat2 Latitude of the second point (rad)
+    * @param[in ] lon2 Longitude of the second point (rad)
+    * @param[out] azFwd Forward azimuth at the first point (rad); may be nullptr
+    * @param[out] azBck Back azimuth at the second point, toward the first point (rad); may be nullptr
+    * @param[in ] method Solution method
+    * @return Geodesic length from the first point to the second (m)
+    */
+    double inverse(double lat1, double lon1, double lat2, double lon2, double* azFwd = nullptr, double* azBck = nullptr, Method method = GEODESIC_KARNEY) const;
+
+    /**
+    * Calculates the point at a geodesic length and forward azimuth from a first point
+    * @param[in ] lat1 Latitude of the first point (rad)
+    * @param[in ] lon1 Longitude of the first point (rad)
+    * @param[in ] azFwd Forward azimuth at the first point (rad)
+    * @param[in ] distance Geodesic length to the second point (m)
+    * @param[out] lat2 Latitude of the second point (rad); may be nullptr
+    * @param[out] lon2 Longitude of the second point (rad); may be nullptr
+    * @param[out] azBck Back azimuth at the second point, toward the first point (rad); may be nullptr
+    * @param[in ] method Solution method
+    */
+    void direct(double lat1, double lon1, double azFwd, double distance, double* lat2, double* lon2, double* azBck = nullptr, Method method = GEODESIC_KARNEY) const;
+
+    /**
+    * Calculates the geodesic lengths and azimuths of an array of point pairs.  Results are the same as the single
+    * pair inverse().  A ground distance matrix can be filled one row at a time, with one value in lat1 and lon1.
+    * @param[in ] inputs Point pairs
+    * @param[out] results Arrays to fill; each non-empty array must hold one value per pair
+    * @param[in ] method Solution method
+    * @param[in ] numThreads Most threads to use, including the calling thread
+    * @return 0 on success, non-zero if an array size does not match
+    */
+    int inverse(const GeodesicInverseInputs& inputs, const GeodesicInverseResults& results, Method method = GEODESIC_KARNEY, unsigned int numThreads = 1) const;
+
+    /**
+    * Calculates the end points of an array of geodesics.  Results are the same as the single line direct().
+    * Range rings can be filled with one value in lat1, lon1 and distance and an azimuth per point.
+    * @param[in ] inputs Starting points, azimuths and lengths
+    * @param[out] results Arrays to fill; each non-empty array must hold one value per line
+    * @param[in ] method Solution method
+    * @param[in ] numThreads Most threads to use, including the calling thread
+    * @return 0 on success, non-zero if an array size does not match
+    */
+    int direct(const GeodesicDirectInputs& inputs, const GeodesicDirectResults& results, Method method = GEODESIC_KARNEY, unsigned int numThreads = 1) const;
+
+  private:
+    /// Values of a geodesic that depend on its first point and azimuth
+    struct Line;
+    /// Values of the Sodano solutions that depend on the first point
+    struct SodanoOrigin;
+
+    /** Karney series solution of the inverse problem */
+    double karneyInverse_(double lat1, double lon1, double lat2, double lon2, double* azFwd, double* azBck) const;
+    /** Initializes a line for the Karney direct solution */
+    void initLine_(double lat1, double azFwd, Line& line) const;
+    /** Karney direct solution along an initialized line */
+    void linePosition_(const Line& line, double lon1, double distance, double* lat2, double* lon2, double* azBck) const;
+    /** Sodano inverse solution */
+    double sodanoInverse_(const SodanoOrigin& origin, double lon1, double lat2, double lon2, double* azFwd, double* azBck) const;
+    /** Sodano direct solution */
+    void sodanoDirect_(const SodanoOrigin& origin, double lon1, double azFwd, double distance, double* lat2, double* lon2, double* azBck) const;
+    /** Fills the Sodano values of a first point */
+    void initSodanoOrigin_(double lat1, SodanoOrigin& origin) const;
+
+    /** Evaluates the A3 series of Karney (2013) */
+    double a3f_(double eps) const;
+    /** Evaluates the C3 series coefficients of Karney (2013) into c[1..5] */
+    void c3f_(double eps, double c[]) const;
+    /** Distance and reduced length, both divided by the semi-minor axis; either output may be nullptr */
+    void lengths_(double eps, double sig12, double ssig1, double csig1, double dn1, double ssig2, double csig2, double dn2, double* s12b, double* m12b) const;
+    /** Starting azimuth for Newton's method; returns the arc length instead, and the final azimuth, for short lines */
+    double inverseStart_(double sbet1, double cbet1, double dn1, double sbet2, double cbet2, double dn2, double lam12, double slam12, double clam12,
+      double& salp1, double& calp1, double& salp2, double& calp2, double& dnm) const;
+    /** Longitude difference reached by an azimuth, less the target difference, and its derivative */
+    double lambda12_(double sbet1, double cbet1, double dn1, double sbet2, double cbet2, double dn2, double salp1, double calp1, double slam120, double clam120,
+      double& salp2, double& calp2, double& sig12, double& ssig1, double& csig1, double& ssig2, double& csig2, double& eps, bool diffp, double& dlam12) const;
+
+    /** Fills a range of pairs for inverse() */
+    void inverseRange_(const GeodesicInverseInputs& inputs, const GeodesicInverseResults& results, Method method, size_t begin, size_t end) const;
+    /** Fills a range of lines for direct() */
+    void directRange_(const GeodesicDirectInputs& inputs, const GeodesicDirectResults& results, Method method, size_t begin, size_t end) const;
+
+    double a_;     ///< Semi-major axis (m)
+    double f_;     ///< Flattening
+    double f1_;    ///< 1 - f
+    double e2_;    ///< First eccentricity squared
+    double ep2_;   ///< Second eccentricity squared
+    double n_;     ///< Third flattening
+    double b_;     ///< Semi-minor axis (m)
+    double etol2_; ///< Tolerance for really short lines
+    double a3x_[6];   ///< A3 coefficients for this ellipsoid, highest power first
+    double c3x_[15];  ///< C3 coefficients for this ellipsoid
+
+    /// Sodano constants, calculated as sodanoInverse() does so results match it
+    double sodanoPolar_;
+    double sodanoFlat_;
+    double sodanoEcc2_;
+    double sodanoN_;
+  };
+
+}
+
+#endif /* SIMCORE_CALC_GEODESIC_H */
@@ -242,6 +242,41 @@ void simCore::dQMult(const double q2[4], const double q1[4], double result[4])
   result[3] =  q2[1]*q1[2] - q2[2]*q1[1] + q2[3]*q1[0] + q2[0]*q1[3]; // z
 }
 
+/// Spherical linear interpolation of unit quaternions
+void simCore::dQSlerp(const double q1[4], const double q2[4], double t, double result[4])
+{
+  assert(q1);
+  assert(q2);
+  assert(result);
+  if (!q1 || !q2 || !result)
+    return;
+
+  // q and -q are the same rotation; flip q2 to take the shorter arc
+  double cosOmega = q1[0] * q2[0] + q1[1] * q2[1] + q1[2] * q2[2] + q1[3] * q2[3];
+  const double sign = (cosOmega < 0.0) ? -1.0 : 1.0;
+  cosOmega *= sign;
+
+  double scale1 = 1.0 - t;
+  double scale2 = t;
+  // Nearly equal rotations fall back to a normalized linear interpolation, avoiding a divide by sin(omega) near 0
+  if (cosOmega < 0.9995)
+  {
+    const double omega = acos(cosOmega);
+    const double invSinOmega = 1.0 / sin(omega);
+    scale1 = sin((1.0 - t) * omega) * invSinOmega;
+    scale2 = sin(t * omega) * invSinOmega;
+  }
+  scale2 *= sign;
+
+  const double q[4] = {
+    scale1 * q1[0] + scale2 * q2[0],
+    scale1 * q1[1] + scale2 * q2[1],
+    scale1 * q1[2] + scale2 * q2[2],
+    scale1 * q1[3] + scale2 * q2[3]
+  };
+  dQNorm(q, result, 0.0);
+}
+
 /// Convert a direction cosine matrix to Euler angles
 void simCore::d3DCMtoEuler(const double dcm[][3], Vec3 &ea)
 {
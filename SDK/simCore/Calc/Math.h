@@ -397,6 +397,16 @@ namespace simCore
   */
   SDKCORE_EXPORT void dQMult(const double q1[4], const double q2[4], double result[4]);
 
+  /**
+  * Spherical linear interpolation between two unit quaternions, along the shorter arc
+  * @param[in ] q1 4 element double vector unit quaternion, the result at t = 0
+  * @param[in ] q2 4 element double vector unit quaternion, the result at t = 1
+  * @param[in ] t Interpolation factor, [0,1]
+  * @param[out] result 4 element double vector unit quaternion between q1 and q2
+  * @pre All vectors valid
+  */
+  SDKCORE_EXPORT void dQSlerp(const double q1[4], const double q2[4], double t, double result[4]);
+
   //--------------------------------------------------------------------------
   //---Euler angle conversion functions
 
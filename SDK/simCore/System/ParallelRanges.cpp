@@ -0,0 +1,160 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "simCore/System/ParallelRanges.h"
+
+namespace simCore
+{
+
+namespace
+{
+
+/** Process wide queue of ranges, serviced by worker threads that run until the process exits */
+class SharedPool
+{
+public:
+  /// Returns the pool, starting its workers on first use
+  static SharedPool& instance()
+  {
+    // Never destroyed; workers waiting on the queue at exit are ended with the process, which
+    // avoids joining threads from static destructors, and unloading libraries, at exit
+    static SharedPool* pool = new SharedPool;
+    return *pool;
+  }
+
+  /// Adds a task to the queue
+  void push(std::function<void()>&& task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    condition_.notify_one();
+  }
+
+  /// Runs the oldest queued task on the calling thread; returns false if none are queued
+  bool runOne()
+  {
+    std::function<void()> task;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (tasks_.empty())
+        return false;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+    return true;
+  }
+
+private:
+  SharedPool()
+  {
+    const unsigned int hardware = std::thread::hardware_concurrency();
+    const unsigned int numWorkers = (hardware > 2) ? hardware - 1 : 1;
+    for (unsigned int k = 0; k < numWorkers; ++k)
+      std::thread(&SharedPool::workerLoop_, this).detach();
+  }
+
+  /// Thread function for the workers
+  void workerLoop_()
+  {
+    while (true)
+    {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this] { return !tasks_.empty(); });
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::mutex mutex_;
+  /// Signals workers that a task is queued
+  std::condition_variable condition_;
+  std::deque<std::function<void()> > tasks_;
+};
+
+/** Completion state of one runRanges() call */
+struct RangesJob
+{
+  std::atomic<size_t> pending;
+  std::mutex mutex;
+  std::condition_variable done;
+};
+
+}
+
+void runRanges(size_t count, size_t numRanges, const RangeFunction& fn)
+{
+  if (count == 0)
+    return;
+  if (numRanges > count)
+    numRanges = count;
+  if (numRanges <= 1)
+  {
+    fn(0, count);
+    return;
+  }
+
+  const size_t rangeSize = (count + numRanges - 1) / numRanges;
+  const size_t numQueued = (count - 1) / rangeSize;
+  auto job = std::make_shared<RangesJob>();
+  job->pending = numQueued;
+
+  // fn and job outlive the tasks, since this call does not return until every task has finished
+  SharedPool& pool = SharedPool::instance();
+  for (size_t begin = rangeSize; begin < count; begin += rangeSize)
+  {
+    const size_t end = std::min(count, begin + rangeSize);
+    pool.push([&fn, job, begin, end]
+      {
+        fn(begin, end);
+        if (--job->pending == 0)
+        {
+          std::lock_guard<std::mutex> lock(job->mutex);
+          job->done.notify_all();
+        }
+      });
+  }
+
+  fn(0, rangeSize);
+  while (job->pending > 0)
+  {
+    if (pool.runOne())
+      continue;
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->done.wait(lock, [&job] { return job->pending == 0; });
+  }
+}
+
+}
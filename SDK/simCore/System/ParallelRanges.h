@@ -0,0 +1,51 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_SYSTEM_PARALLELRANGES_H
+#define SIMCORE_SYSTEM_PARALLELRANGES_H
+
+#include <cstddef>
+#include <functional>
+#include "simCore/Common/Export.h"
+
+namespace simCore
+{
+
+/// Work function called with a half open range [begin, end) of item indices
+typedef std::function<void(size_t begin, size_t end)> RangeFunction;
+
+/**
+ * Calls fn over the items [0, count), split into numRanges contiguous ranges that are processed
+ * concurrently.  The calling thread processes the first range; the others go to a pool of worker
+ * threads that is shared by the whole process and started on first use, so no threads are created
+ * per call.  While waiting, the calling thread also processes queued ranges, so calls from several
+ * threads, or from within a work function, always make progress.  Blocks until all items have been
+ * processed.  A numRanges of 0 or 1 processes all the items on the calling thread.
+ * @param count Number of items
+ * @param numRanges Number of ranges to split the items into
+ * @param fn Function to process a range of items; must be safe to call concurrently
+ */
+SDKCORE_EXPORT void runRanges(size_t count, size_t numRanges, const RangeFunction& fn);
+
+}
+
+#endif /* SIMCORE_SYSTEM_PARALLELRANGES_H */
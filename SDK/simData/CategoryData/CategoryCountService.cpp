@@ -0,0 +1,282 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include "simData/DataStore.h"
+#include "simData/CategoryData/CategoryNameManager.h"
+#include "simData/CategoryData/CompiledCategoryFilter.h"
+#include "simData/CategoryData/CategoryCountService.h"
+
+namespace simData {
+
+/// Number of entities combined between checks for cancellation
+static const size_t CANCEL_CHECK_INTERVAL = 4096;
+
+CategoryCountService::CategoryCountService(const DataStore& dataStore)
+  : dataStore_(dataStore)
+{
+  thread_ = std::thread(&CategoryCountService::workerLoop_, this);
+}
+
+CategoryCountService::~CategoryCountService()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    pendingJob_.reset();
+    // Request 0 is never issued, so the count in progress stops
+    latestRequest_ = 0;
+  }
+  jobCondition_.notify_all();
+  if (thread_.joinable())
+    thread_.join();
+}
+
+void CategoryCountService::setResultsCallback(const ResultsCallback& callback)
+{
+  std::lock_guard<std::mutex> lock(callbackMutex_);
+  callback_ = callback;
+}
+
+void CategoryCountService::setObjectTypes(simData::ObjectType objectTypes)
+{
+  objectTypes_ = objectTypes;
+}
+
+uint64_t CategoryCountService::count(const CategoryFilter& filter)
+{
+  auto job = std::make_unique<Job>();
+  prepare_(dataStore_, filter, objectTypes_, *job);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  job->request = nextRequest_++;
+  latestRequest_ = job->request;
+  const uint64_t request = job->request;
+  pendingJob_ = std::move(job);
+  jobCondition_.notify_one();
+  return request;
+}
+
+void CategoryCountService::cancel()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  pendingJob_.reset();
+  latestRequest_ = nextRequest_++;
+}
+
+void CategoryCountService::wait()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  idleCondition_.wait(lock, [this] { return !busy_ && !pendingJob_; });
+}
+
+int CategoryCountService::lastResults(CategoryCounts& results) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!lastResults_)
+    return 1;
+  results = *lastResults_;
+  return 0;
+}
+
+void CategoryCountService::countNow(const DataStore& dataStore, const CategoryFilter& filter, simData::ObjectType objectTypes, CategoryCounts& results)
+{
+  Job job;
+  prepare_(dataStore, filter, objectTypes, job);
+  std::map<int, Column> columns;
+  count_(job, nullptr, columns, [] { return false; }, results);
+}
+
+void CategoryCountService::prepare_(const DataStore& dataStore, const CategoryFilter& filter, simData::ObjectType objectTypes, Job& job)
+{
+  // Copy all the current category data
+  dataStore.idList(&job.ids, objectTypes);
+  job.values.resize(job.ids.size());
+  for (size_t ii = 0; ii < job.ids.size(); ++ii)
+    CategoryFilter::getCurrentCategoryValues(dataStore, job.ids[ii], job.values[ii]);
+
+  // Compiling here keeps the worker away from the CategoryNameManager for values known now
+  job.filter = std::make_shared<CompiledCategoryFilter>(filter);
+  std::vector<int> filterNames;
+  filter.getNames(filterNames);
+  const CategoryFilter::CategoryCheck& checks = filter.getCategoryFilter();
+  for (int nameInt : filterNames)
+  {
+    Signature& signature = job.signatures[nameInt];
+    auto checkIter = checks.find(nameInt);
+    if (checkIter != checks.end())
+    {
+      signature.nameChecked = checkIter->second.first;
+      signature.values = checkIter->second.second;
+    }
+    signature.regExp = filter.getRegExpPattern(nameInt);
+  }
+
+  // Every known value starts at 0, as does NO VALUE
+  const CategoryNameManager& nameManager = dataStore.categoryNameManager();
+  for (int nameInt : nameManager.allCategoryNameInts())
+  {
+    CategoryCounts::ValueToCountMap& countMap = job.emptyCounts[nameInt];
+    for (int valueInt : nameManager.allValueIntsInCategory(nameInt))
+      countMap[valueInt] = 0;
+    countMap[CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME] = 0;
+  }
+}
+
+int CategoryCountService::count_(const Job& job, const Job* lastJob, std::map<int, Column>& columns, const std::function<bool()>& cancelled, CategoryCounts& results)
+{
+  // Columns only carry over if every entity has the values it had last time
+  const bool reuse = (lastJob != nullptr) && (lastJob->ids == job.ids) && (lastJob->values == job.values);
+  const size_t numIds = job.ids.size();
+
+  std::map<int, Column> newColumns;
+  for (const auto& nameAndSignature : job.signatures)
+  {
+    const int nameInt = nameAndSignature.first;
+    auto oldIter = columns.find(nameInt);
+    // Copied rather than moved, so that a cancelled count leaves the old columns intact
+    if (reuse && oldIter != columns.end() && oldIter->second.signature == nameAndSignature.second)
+    {
+      newColumns[nameInt] = oldIter->second;
+      continue;
+    }
+
+    if (cancelled())
+      return 1;
+    Column& column = newColumns[nameInt];
+    column.signature = nameAndSignature.second;
+    if (!job.filter->testsName(nameInt))
+      continue;
+    column.passes.resize(numIds);
+    for (size_t ii = 0; ii < numIds; ++ii)
+      column.passes[ii] = job.filter->matchName(nameInt, job.values[ii]) ? 1 : 0;
+  }
+
+  // Only categories that can fail take part in the combine
+  std::vector<std::pair<int, const std::vector<uint8_t>*> > tested;
+  for (const auto& nameAndColumn : newColumns)
+  {
+    if (!nameAndColumn.second.passes.empty())
+      tested.emplace_back(nameAndColumn.first, &nameAndColumn.second.passes);
+  }
+
+  // Checking value v alone in category N passes the entities that pass every other category and
+  // have value v for N.  Entities failing none of the categories count once in every category;
+  // entities failing exactly one count only in that one.
+  CategoryCounts counts;
+  counts.request = job.request;
+  counts.allCategories = job.emptyCounts;
+  size_t numPassing = 0;
+  std::map<int, size_t> passingWithValue;
+  for (size_t ii = 0; ii < numIds; ++ii)
+  {
+    if ((ii % CANCEL_CHECK_INTERVAL) == 0 && cancelled())
+      return 1;
+
+    int failedName = CategoryNameManager::NO_CATEGORY_NAME;
+    size_t numFailed = 0;
+    for (const auto& nameAndPasses : tested)
+    {
+      if ((*nameAndPasses.second)[ii] == 0)
+      {
+        failedName = nameAndPasses.first;
+        if (++numFailed > 1)
+          break;
+      }
+    }
+    if (numFailed > 1)
+      continue;
+
+    const CategoryFilter::CurrentCategoryValues& values = job.values[ii];
+    if (numFailed == 1)
+    {
+      auto countsIter = counts.allCategories.find(failedName);
+      if (countsIter == counts.allCategories.end())
+        continue;
+      auto valueIter = values.find(failedName);
+      const int valueInt = (valueIter == values.end()) ? static_cast<int>(CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME) : valueIter->second;
+      auto countIter = countsIter->second.find(valueInt);
+      if (countIter != countsIter->second.end())
+        ++countIter->second;
+      continue;
+    }
+
+    // NO VALUE counts for the entities passing everything are filled in after the loop
+    ++numPassing;
+    for (const auto& nameAndValue : values)
+    {
+      auto countsIter = counts.allCategories.find(nameAndValue.first);
+      if (countsIter == counts.allCategories.end())
+        continue;
+      ++passingWithValue[nameAndValue.first];
+      auto countIter = countsIter->second.find(nameAndValue.second);
+      if (countIter != countsIter->second.end())
+        ++countIter->second;
+    }
+  }
+  for (auto& nameAndCounts : counts.allCategories)
+  {
+    auto withIter = passingWithValue.find(nameAndCounts.first);
+    const size_t withValue = (withIter == passingWithValue.end()) ? 0 : withIter->second;
+    nameAndCounts.second[CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME] += numPassing - withValue;
+  }
+
+  columns.swap(newColumns);
+  results = std::move(counts);
+  return 0;
+}
+
+void CategoryCountService::workerLoop_()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    jobCondition_.wait(lock, [this] { return stop_ || pendingJob_; });
+    if (stop_)
+      return;
+
+    std::unique_ptr<Job> job = std::move(pendingJob_);
+    busy_ = true;
+    lock.unlock();
+
+    const uint64_t request = job->request;
+    const auto cancelled = [this, request] { return latestRequest_ != request; };
+    CategoryCounts results;
+    if (count_(*job, lastJob_.get(), columns_, cancelled, results) == 0)
+    {
+      lastJob_ = std::move(job);
+      lock.lock();
+      lastResults_ = std::make_unique<CategoryCounts>(results);
+      lock.unlock();
+
+      std::lock_guard<std::mutex> callbackLock(callbackMutex_);
+      if (callback_ && !cancelled())
+        callback_(results);
+    }
+
+    lock.lock();
+    busy_ = false;
+    if (!pendingJob_)
+      idleCondition_.notify_all();
+  }
+}
+
+}
@@ -0,0 +1,182 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_CATEGORYCOUNTSERVICE_H
+#define SIMDATA_CATEGORYCOUNTSERVICE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "simCore/Common/Common.h"
+#include "simData/DataTypes.h"
+#include "simData/ObjectId.h"
+#include "simData/CategoryData/CategoryFilter.h"
+
+namespace simData {
+
+class CompiledCategoryFilter;
+class DataStore;
+
+/** Results of a category count: the entities each category value would show if it were the only value checked */
+struct CategoryCounts
+{
+  /** Map of integer category value to number of entities, including NO_CATEGORY_VALUE_AT_TIME */
+  typedef std::map<int, size_t> ValueToCountMap;
+  /** Map of integer category name to the value-to-counts map */
+  typedef std::map<int, ValueToCountMap> AllCategories;
+
+  /** Request that produced the results, as returned by CategoryCountService::count() */
+  uint64_t request = 0;
+  /** Maps all known categories to the resulting values */
+  AllCategories allCategories;
+};
+
+/**
+ * Counts, for every category value, the entities that would pass the filter if that value were
+ * the only one checked in its category; the same counts as simQt::CategoryFilterCounter, without Qt.
+ *
+ * count() copies the current category values of the entities on the calling thread, which must be
+ * the data store's thread, then counts on a background thread.  A newer count() cancels the one in
+ * progress.  Each category's pass/fail state per entity is kept between counts, so a count whose
+ * entities and values did not change only re-evaluates the categories whose checks changed.
+ * Results are passed to the callback on the background thread, one call at a time.
+ */
+class SDKDATA_EXPORT CategoryCountService
+{
+public:
+  /** Called on the background thread with the results of each count that was not cancelled; must not call wait() or setResultsCallback() */
+  typedef std::function<void(const CategoryCounts& results)> ResultsCallback;
+
+  /** Counts the entities of the data store, which must outlive the service */
+  explicit CategoryCountService(const DataStore& dataStore);
+  /** Cancels any count in progress and stops the background thread */
+  virtual ~CategoryCountService();
+
+  SDK_DISABLE_COPY_MOVE(CategoryCountService);
+
+  /** Sets the function receiving results; may be called from any thread */
+  void setResultsCallback(const ResultsCallback& callback);
+  /** Restricts the counts to entities of the given types; applies to the next count() */
+  void setObjectTypes(simData::ObjectType objectTypes);
+
+  /**
+   * Starts counting the current entities against the filter, cancelling any count in progress.
+   * Must be called on the data store's thread.
+   * @return Identifier of the request, matching CategoryCounts::request of its results
+   */
+  uint64_t count(const CategoryFilter& filter);
+  /** Cancels any count in progress or pending; its results are not delivered */
+  void cancel();
+  /** Blocks until no count is in progress or pending */
+  void wait();
+
+  /** Copies the results of the last completed count; returns 0 on success, non-zero if no count completed */
+  int lastResults(CategoryCounts& results) const;
+
+  /**
+   * Counts on the calling thread, with the same results as count().  Must be called on the data
+   * store's thread.  Does not use or affect the background thread.
+   */
+  static void countNow(const DataStore& dataStore, const CategoryFilter& filter, simData::ObjectType objectTypes, CategoryCounts& results);
+
+private:
+  /// Checks of one category name in a filter; equal signatures pass and fail the same values
+  struct Signature
+  {
+    bool nameChecked = false;
+    CategoryFilter::ValuesCheck values;
+    std::string regExp;
+
+    bool operator==(const Signature& rhs) const
+    {
+      return nameChecked == rhs.nameChecked && values == rhs.values && regExp == rhs.regExp;
+    }
+  };
+
+  /// Everything a count needs, copied on the data store's thread
+  struct Job
+  {
+    uint64_t request = 0;
+    std::vector<ObjectId> ids;
+    std::vector<CategoryFilter::CurrentCategoryValues> values;
+    std::shared_ptr<const CompiledCategoryFilter> filter;
+    std::map<int, Signature> signatures;
+    /// Known names and values, with all counts 0
+    CategoryCounts::AllCategories emptyCounts;
+  };
+
+  /// Pass state of every entity for one category name
+  struct Column
+  {
+    Signature signature;
+    /// 1 if the entity passes the category's checks; empty if every entity passes
+    std::vector<uint8_t> passes;
+  };
+
+  /** Fills job from the data store on the calling thread */
+  static void prepare_(const DataStore& dataStore, const CategoryFilter& filter, simData::ObjectType objectTypes, Job& job);
+  /**
+   * Counts the job into results and replaces columns with the job's columns, reusing those whose
+   * signature is unchanged if lastJob had the same entities and values.  Returns non-zero without
+   * changing columns if cancelled() returned true.
+   */
+  static int count_(const Job& job, const Job* lastJob, std::map<int, Column>& columns, const std::function<bool()>& cancelled, CategoryCounts& results);
+
+  /// Thread function for the background thread
+  void workerLoop_();
+
+  const DataStore& dataStore_;
+  simData::ObjectType objectTypes_ = simData::ALL;
+
+  mutable std::mutex mutex_;
+  /// Signals the background thread that a job is pending or the service is stopping
+  std::condition_variable jobCondition_;
+  /// Signals wait() that the background thread is idle
+  std::condition_variable idleCondition_;
+  std::unique_ptr<Job> pendingJob_;
+  bool busy_ = false;
+  bool stop_ = false;
+  /// Request of the newest count(); older counts stop when they see it change
+  std::atomic<uint64_t> latestRequest_ = 0;
+  uint64_t nextRequest_ = 1;
+  ResultsCallback callback_;
+  std::unique_ptr<CategoryCounts> lastResults_;
+  /// Serializes calls to the callback with setResultsCallback()
+  std::mutex callbackMutex_;
+
+  /// Owned by the background thread: the last counted job and its columns, for reuse
+  std::unique_ptr<Job> lastJob_;
+  std::map<int, Column> columns_;
+
+  std::thread thread_;
+};
+
+}
+
+#endif /* SIMDATA_CATEGORYCOUNTSERVICE_H */
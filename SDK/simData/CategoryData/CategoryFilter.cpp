@@ -27,6 +27,7 @@
 #include "simData/DataStore.h"
 #include "simData/CategoryData/CategoryNameManager.h"
 #include "simData/CategoryData/CategoryFilter.h"
+#include "simData/CategoryData/CompiledCategoryFilter.h"
 
 namespace simData {
 
@@ -500,6 +501,16 @@ bool CategoryFilter::matchData(const CurrentCategoryValues& curCategoryData) con
   return true;
 }
 
+void CategoryFilter::matchAll(const simData::DataStore& dataStore, const std::vector<uint64_t>& ids, std::vector<uint8_t>& matches) const
+{
+  if (categoryCheck_.empty() && categoryRegExp_.empty())
+  {
+    matches.assign(ids.size(), 1);
+    return;
+  }
+  CompiledCategoryFilter(*this).matchAll(dataStore, ids, matches);
+}
+
 bool CategoryFilter::matchRegExpFilter_(const CurrentCategoryValues& curCategoryData) const
 {
   // no failure if no regular expressions
@@ -264,6 +264,16 @@ public:
   */
   bool matchData(const CurrentCategoryValues& curCategoryData) const;
 
+  /**
+  * Check the category data of many entities against the filter at once.  Compiles the filter into a
+  * simData::CompiledCategoryFilter, so is much faster than calling match() for each entity; hold on to a
+  * CompiledCategoryFilter to evaluate an unchanged filter repeatedly.
+  * @param[in] dataStore  Queried for the current category values of the entities
+  * @param[in] ids  Entities to test
+  * @param[out] matches  Resized to ids.size(); 1 where the entity passes the filter, 0 otherwise
+  */
+  void matchAll(const simData::DataStore& dataStore, const std::vector<uint64_t>& ids, std::vector<uint8_t>& matches) const;
+
   /**
   * Serialize the category filter into a SIMDIS 9 compatible string
   * @param simplify if true, return " " if all category values are checked
@@ -321,6 +331,7 @@ public:
 
 private:
   class CategoryFilterListener;
+  friend class CompiledCategoryFilter;
 
   /** Assignment operator; made private to force developers to use assign */
   CategoryFilter& operator=(const CategoryFilter& other);
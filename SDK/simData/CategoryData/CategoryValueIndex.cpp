@@ -0,0 +1,176 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <limits>
+#include "simData/CategoryData/CategoryNameManager.h"
+#include "simData/CategoryData/CategoryValueIndex.h"
+
+namespace simData {
+
+CategoryValueIndex::CategoryValueIndex()
+{
+}
+
+CategoryValueIndex::~CategoryValueIndex()
+{
+}
+
+void CategoryValueIndex::set(ObjectId id, const NameValues& values)
+{
+  if (values.empty())
+  {
+    remove(id);
+    return;
+  }
+
+  NameValues sorted = values;
+  std::sort(sorted.begin(), sorted.end());
+
+  auto iter = entities_.find(id);
+  if (iter == entities_.end())
+  {
+    for (const auto& nameValue : sorted)
+      add_(id, nameValue.first, nameValue.second);
+    entities_.emplace(id, std::move(sorted));
+    return;
+  }
+
+  // Both lists are sorted, so a merge touches only the pairs that changed
+  NameValues& old = iter->second;
+  auto oldIter = old.begin();
+  auto newIter = sorted.begin();
+  while (oldIter != old.end() || newIter != sorted.end())
+  {
+    if (newIter == sorted.end() || (oldIter != old.end() && *oldIter < *newIter))
+    {
+      erase_(id, oldIter->first, oldIter->second);
+      ++oldIter;
+    }
+    else if (oldIter == old.end() || *newIter < *oldIter)
+    {
+      add_(id, newIter->first, newIter->second);
+      ++newIter;
+    }
+    else
+    {
+      ++oldIter;
+      ++newIter;
+    }
+  }
+  old = std::move(sorted);
+}
+
+void CategoryValueIndex::remove(ObjectId id)
+{
+  auto iter = entities_.find(id);
+  if (iter == entities_.end())
+    return;
+  for (const auto& nameValue : iter->second)
+    erase_(id, nameValue.first, nameValue.second);
+  entities_.erase(iter);
+}
+
+void CategoryValueIndex::clear()
+{
+  names_.clear();
+  entities_.clear();
+}
+
+const std::set<ObjectId>& CategoryValueIndex::entities(int nameInt, int valueInt) const
+{
+  static const std::set<ObjectId> EMPTY;
+  auto nameIter = names_.find(nameInt);
+  if (nameIter == names_.end())
+    return EMPTY;
+  auto valueIter = nameIter->second.values.find(valueInt);
+  if (valueIter == nameIter->second.values.end())
+    return EMPTY;
+  return valueIter->second;
+}
+
+size_t CategoryValueIndex::count(int nameInt, int valueInt) const
+{
+  return entities(nameInt, valueInt).size();
+}
+
+size_t CategoryValueIndex::count(int nameInt) const
+{
+  auto nameIter = names_.find(nameInt);
+  return (nameIter == names_.end()) ? 0 : nameIter->second.count;
+}
+
+void CategoryValueIndex::valueCounts(int nameInt, std::map<int, size_t>& counts) const
+{
+  counts.clear();
+  auto nameIter = names_.find(nameInt);
+  if (nameIter == names_.end())
+    return;
+  for (const auto& valueEntities : nameIter->second.values)
+    counts[valueEntities.first] = valueEntities.second.size();
+}
+
+int CategoryValueIndex::value(ObjectId id, int nameInt) const
+{
+  const NameValues& nameValues = values(id);
+  auto iter = std::lower_bound(nameValues.begin(), nameValues.end(), std::make_pair(nameInt, std::numeric_limits<int>::lowest()));
+  if (iter == nameValues.end() || iter->first != nameInt)
+    return CategoryNameManager::NO_CATEGORY_VALUE;
+  return iter->second;
+}
+
+const CategoryValueIndex::NameValues& CategoryValueIndex::values(ObjectId id) const
+{
+  static const NameValues EMPTY;
+  auto iter = entities_.find(id);
+  return (iter == entities_.end()) ? EMPTY : iter->second;
+}
+
+size_t CategoryValueIndex::numEntities() const
+{
+  return entities_.size();
+}
+
+void CategoryValueIndex::add_(ObjectId id, int nameInt, int valueInt)
+{
+  NameEntry& entry = names_[nameInt];
+  if (entry.values[valueInt].insert(id).second)
+    ++entry.count;
+}
+
+void CategoryValueIndex::erase_(ObjectId id, int nameInt, int valueInt)
+{
+  auto nameIter = names_.find(nameInt);
+  if (nameIter == names_.end())
+    return;
+  auto valueIter = nameIter->second.values.find(valueInt);
+  if (valueIter == nameIter->second.values.end())
+    return;
+  if (valueIter->second.erase(id) != 0)
+    --nameIter->second.count;
+  if (valueIter->second.empty())
+    nameIter->second.values.erase(valueIter);
+  if (nameIter->second.values.empty())
+    names_.erase(nameIter);
+}
+
+}
@@ -0,0 +1,91 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_CATEGORYVALUEINDEX_H
+#define SIMDATA_CATEGORYVALUEINDEX_H
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+#include "simCore/Common/Common.h"
+#include "simData/ObjectId.h"
+
+namespace simData {
+
+/**
+ * Inverted index from category name and value ints to the entities that currently hold that
+ * value.  Entities are updated one at a time with their full set of current values, so that
+ * membership and count queries cost O(result) instead of a pass over every entity.
+ */
+class SDKDATA_EXPORT CategoryValueIndex
+{
+public:
+  /// Name int and value int pairs, as returned by CategoryDataSlice::allInts()
+  typedef std::vector<std::pair<int, int> > NameValues;
+
+  CategoryValueIndex();
+  virtual ~CategoryValueIndex();
+
+  SDK_DISABLE_COPY_MOVE(CategoryValueIndex);
+
+  /** Replaces the current category values of the entity; an empty list removes it */
+  void set(ObjectId id, const NameValues& values);
+  /** Removes the entity from the index */
+  void remove(ObjectId id);
+  /** Removes all entities */
+  void clear();
+
+  /** Returns the entities currently holding the value for the category; empty if none */
+  const std::set<ObjectId>& entities(int nameInt, int valueInt) const;
+  /** Returns the number of entities currently holding the value for the category */
+  size_t count(int nameInt, int valueInt) const;
+  /** Returns the number of entities with any current value for the category */
+  size_t count(int nameInt) const;
+  /** Fills counts with the number of entities holding each value of the category; values held by no entity are omitted */
+  void valueCounts(int nameInt, std::map<int, size_t>& counts) const;
+  /** Returns the current value int of the category for the entity, or CategoryNameManager::NO_CATEGORY_VALUE */
+  int value(ObjectId id, int nameInt) const;
+  /** Returns the current values of the entity, sorted by name int; empty if none */
+  const NameValues& values(ObjectId id) const;
+  /** Returns the number of entities with at least one current category value */
+  size_t numEntities() const;
+
+private:
+  /// Entities by value int for one category name
+  struct NameEntry
+  {
+    std::map<int, std::set<ObjectId> > values;
+    size_t count = 0;
+  };
+
+  /** Adds or removes the entity under the name and value */
+  void add_(ObjectId id, int nameInt, int valueInt);
+  void erase_(ObjectId id, int nameInt, int valueInt);
+
+  std::map<int, NameEntry> names_;
+  std::map<ObjectId, NameValues> entities_;
+};
+
+}
+
+#endif /* SIMDATA_CATEGORYVALUEINDEX_H */
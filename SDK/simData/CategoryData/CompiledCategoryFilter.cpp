@@ -0,0 +1,217 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include "simData/DataStore.h"
+#include "simData/CategoryData/CategoryData.h"
+#include "simData/CategoryData/CategoryNameManager.h"
+#include "simData/CategoryData/CompiledCategoryFilter.h"
+
+namespace simData {
+
+CompiledCategoryFilter::CompiledCategoryFilter(const CategoryFilter& filter)
+{
+  if (filter.dataStore_ != nullptr)
+    names_ = &filter.dataStore_->categoryNameManager();
+
+  // Same rules as CategoryFilter::matchData(): a valid regular expression replaces the checks of its category
+  for (const auto& nameAndValues : filter.categoryCheck_)
+  {
+    auto regIter = filter.categoryRegExp_.find(nameAndValues.first);
+    if (regIter != filter.categoryRegExp_.end() && regIter->second && !regIter->second->pattern().empty())
+      continue;
+    if (nameAndValues.first == CategoryNameManager::NO_CATEGORY_NAME || !nameAndValues.second.first)
+      continue;
+    addChecks_(nameAndValues.first, nameAndValues.second.second);
+  }
+
+  // Regular expressions are ignored without a data store to convert values to strings
+  if (names_ == nullptr)
+    return;
+  for (const auto& nameAndRegExp : filter.categoryRegExp_)
+  {
+    if (nameAndRegExp.second && !nameAndRegExp.second->pattern().empty())
+      addRegExp_(nameAndRegExp.first, nameAndRegExp.second);
+  }
+}
+
+CompiledCategoryFilter::~CompiledCategoryFilter()
+{
+}
+
+bool CompiledCategoryFilter::matchesAll() const
+{
+  return categories_.empty();
+}
+
+void CompiledCategoryFilter::addChecks_(int nameInt, const CategoryFilter::ValuesCheck& checks)
+{
+  Category category;
+  category.nameInt = nameInt;
+
+  // Values without a check fall back on the unlisted check, and a missing value on the no value check
+  auto iter = checks.find(CategoryNameManager::UNLISTED_CATEGORY_VALUE);
+  category.unlistedPass = (iter != checks.end()) && iter->second;
+  iter = checks.find(CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME);
+  const bool noValuePass = (iter != checks.end()) && iter->second;
+
+  const int maxValue = checks.empty() ? -1 : std::max(-1, checks.rbegin()->first);
+  category.valueEnd = static_cast<uint32_t>(maxValue + 1 + VALUE_OFFSET);
+  category.passes.assign(category.valueEnd + 3, category.unlistedPass ? 1 : 0);
+  for (const auto& valueAndCheck : checks)
+  {
+    if (valueAndCheck.first >= -VALUE_OFFSET)
+      category.passes[valueAndCheck.first + VALUE_OFFSET] = valueAndCheck.second ? 1 : 0;
+  }
+  category.passes[category.valueEnd] = noValuePass ? 1 : 0;
+  category.passes[category.valueEnd + 1] = 0;
+  category.passes[category.valueEnd + 2] = 1;
+
+  // A category that passes everything does not need testing
+  if (category.unlistedPass && std::all_of(category.passes.begin(), category.passes.begin() + category.valueEnd + 1, [](uint8_t pass) { return pass != 0; }))
+    return;
+
+  addCategory_(std::move(category));
+}
+
+void CompiledCategoryFilter::addRegExp_(int nameInt, const RegExpFilterPtr& regExp)
+{
+  Category category;
+  category.nameInt = nameInt;
+  category.regExp = regExp;
+
+  // Only the values of this category are evaluated; value ints are shared with other categories
+  const std::vector<int> values = names_->allValueIntsInCategory(nameInt);
+  const int maxValue = values.empty() ? -1 : std::max(-1, *std::max_element(values.begin(), values.end()));
+  category.valueEnd = static_cast<uint32_t>(maxValue + 1 + VALUE_OFFSET);
+  category.passes.assign(category.valueEnd + 3, NOT_EVALUATED);
+  for (int valueInt = -VALUE_OFFSET; valueInt < 0; ++valueInt)
+    category.passes[valueInt + VALUE_OFFSET] = regExp->match(names_->valueIntToString(valueInt)) ? 1 : 0;
+  for (int valueInt : values)
+  {
+    if (valueInt >= 0)
+      category.passes[valueInt + VALUE_OFFSET] = regExp->match(names_->valueIntToString(valueInt)) ? 1 : 0;
+  }
+  // An entity without the category is tested with an empty string
+  category.passes[category.valueEnd] = regExp->match("") ? 1 : 0;
+  category.passes[category.valueEnd + 1] = 0;
+  category.passes[category.valueEnd + 2] = 1;
+
+  // The checks of this name were skipped, so the slot is free
+  addCategory_(std::move(category));
+}
+
+void CompiledCategoryFilter::addCategory_(Category&& category)
+{
+  // A name that no entity can have keeps the no value code for every entity
+  if (category.nameInt >= 0)
+  {
+    if (static_cast<size_t>(category.nameInt) >= nameSlots_.size())
+      nameSlots_.resize(category.nameInt + 1, -1);
+    nameSlots_[category.nameInt] = static_cast<int>(categories_.size());
+  }
+  categories_.push_back(std::move(category));
+}
+
+uint32_t CompiledCategoryFilter::code_(const Category& category, int valueInt) const
+{
+  if (valueInt >= -VALUE_OFFSET && static_cast<uint32_t>(valueInt + VALUE_OFFSET) < category.valueEnd)
+  {
+    const uint32_t code = static_cast<uint32_t>(valueInt + VALUE_OFFSET);
+    if (category.passes[code] != NOT_EVALUATED)
+      return code;
+  }
+  if (!category.regExp)
+    return category.valueEnd + (category.unlistedPass ? 2 : 1);
+  // Value added since compiling
+  return category.valueEnd + (category.regExp->match(names_->valueIntToString(valueInt)) ? 2 : 1);
+}
+
+void CompiledCategoryFilter::matchAll(const simData::DataStore& dataStore, const std::vector<uint64_t>& ids, std::vector<uint8_t>& matches) const
+{
+  const size_t numIds = ids.size();
+  matches.assign(numIds, 1);
+  if (categories_.empty() || numIds == 0)
+    return;
+
+  // One column of codes per category, starting as no value
+  std::vector<uint32_t> codes(categories_.size() * numIds);
+  for (size_t cat = 0; cat < categories_.size(); ++cat)
+    std::fill(codes.begin() + cat * numIds, codes.begin() + (cat + 1) * numIds, categories_[cat].valueEnd);
+
+  std::vector<std::pair<int, int> > values;
+  for (size_t ii = 0; ii < numIds; ++ii)
+  {
+    const CategoryDataSlice* slice = dataStore.categoryDataSlice(ids[ii]);
+    if (slice == nullptr)
+      continue;
+    values.clear();
+    slice->allInts(values);
+    for (const auto& nameAndValue : values)
+    {
+      if (nameAndValue.first < 0 || static_cast<size_t>(nameAndValue.first) >= nameSlots_.size())
+        continue;
+      const int slot = nameSlots_[nameAndValue.first];
+      if (slot >= 0)
+        codes[slot * numIds + ii] = code_(categories_[slot], nameAndValue.second);
+    }
+  }
+
+  // Categories are combined with AND, one table lookup per entity and category
+  uint8_t* out = matches.data();
+  for (size_t cat = 0; cat < categories_.size(); ++cat)
+  {
+    const uint8_t* passes = categories_[cat].passes.data();
+    const uint32_t* column = codes.data() + cat * numIds;
+    for (size_t ii = 0; ii < numIds; ++ii)
+      out[ii] &= passes[column[ii]];
+  }
+}
+
+bool CompiledCategoryFilter::matchData(const CategoryFilter::CurrentCategoryValues& curCategoryData) const
+{
+  for (const auto& category : categories_)
+  {
+    auto iter = curCategoryData.find(category.nameInt);
+    const uint32_t code = (iter == curCategoryData.end()) ? category.valueEnd : code_(category, iter->second);
+    if (category.passes[code] == 0)
+      return false;
+  }
+  return true;
+}
+
+bool CompiledCategoryFilter::matchName(int nameInt, const CategoryFilter::CurrentCategoryValues& curCategoryData) const
+{
+  if (!testsName(nameInt))
+    return true;
+  const Category& category = categories_[nameSlots_[nameInt]];
+  auto iter = curCategoryData.find(nameInt);
+  const uint32_t code = (iter == curCategoryData.end()) ? category.valueEnd : code_(category, iter->second);
+  return category.passes[code] != 0;
+}
+
+bool CompiledCategoryFilter::testsName(int nameInt) const
+{
+  return nameInt >= 0 && static_cast<size_t>(nameInt) < nameSlots_.size() && nameSlots_[nameInt] >= 0;
+}
+
+}
@@ -0,0 +1,110 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_COMPILEDCATEGORYFILTER_H
+#define SIMDATA_COMPILEDCATEGORYFILTER_H
+
+#include <cstdint>
+#include <vector>
+#include "simCore/Common/Common.h"
+#include "simData/CategoryData/CategoryFilter.h"
+
+namespace simData {
+
+class CategoryNameManager;
+class DataStore;
+
+/**
+ * A CategoryFilter compiled into one pass/fail table per filtered category, indexed by category
+ * value int, for evaluating the same filter against many entities.  Regular expressions are
+ * evaluated once per value known to the CategoryNameManager at compile time; values added later
+ * are tested against the regular expression as they are seen.  Gives the same results as
+ * CategoryFilter::match(), but does not follow later changes to the filter.
+ */
+class SDKDATA_EXPORT CompiledCategoryFilter
+{
+public:
+  /** Compiles the current checks and regular expressions of the filter */
+  explicit CompiledCategoryFilter(const CategoryFilter& filter);
+  virtual ~CompiledCategoryFilter();
+
+  /** Returns true if the filter passes every entity, e.g. an empty filter */
+  bool matchesAll() const;
+
+  /**
+   * Evaluates the filter for each of the entities, using their current category values in the data store.
+   * @param[in] dataStore  Queried for the current category values
+   * @param[in] ids  Entities to test
+   * @param[out] matches  Resized to ids.size(); 1 where the entity passes the filter, 0 otherwise
+   */
+  void matchAll(const simData::DataStore& dataStore, const std::vector<uint64_t>& ids, std::vector<uint8_t>& matches) const;
+
+  /** Evaluates the filter for a single set of category values; same result as CategoryFilter::matchData() */
+  bool matchData(const CategoryFilter::CurrentCategoryValues& curCategoryData) const;
+
+  /** Returns false if the filter tests the category name and the values fail that test; matchData() is the AND of all names */
+  bool matchName(int nameInt, const CategoryFilter::CurrentCategoryValues& curCategoryData) const;
+  /** Returns true if the filter tests the category name, i.e. matchName() can fail for it */
+  bool testsName(int nameInt) const;
+
+private:
+  /// Lookup table for one category in the filter
+  struct Category
+  {
+    int nameInt = 0;
+    /**
+     * Pass state by code: value ints from -3 are offset by VALUE_OFFSET up to valueEnd, followed
+     * by the entries for no value, a failed value and a passed value
+     */
+    std::vector<uint8_t> passes;
+    /// Code of the entry for an entity without a value for the category
+    uint32_t valueEnd = 0;
+    /// Pass state for values past valueEnd; unused with a regular expression
+    bool unlistedPass = false;
+    /// Tests values added after compiling; nullptr for check-based categories
+    RegExpFilterPtr regExp;
+  };
+
+  /** Adds the table for a category tested by its checks, skipping it if it passes everything */
+  void addChecks_(int nameInt, const CategoryFilter::ValuesCheck& checks);
+  /** Adds the table for a category tested by a regular expression */
+  void addRegExp_(int nameInt, const RegExpFilterPtr& regExp);
+  /** Adds the category and maps its name to it */
+  void addCategory_(Category&& category);
+  /** Returns the code in the category's table for the value */
+  uint32_t code_(const Category& category, int valueInt) const;
+
+  /// Offset of value int 0 in Category::passes, so that the special values -3 to -1 have entries
+  static const int VALUE_OFFSET = 3;
+  /// Entry in Category::passes for a regular expression value not evaluated at compile time
+  static const uint8_t NOT_EVALUATED = 2;
+
+  std::vector<Category> categories_;
+  /// Index into categories_ by name int, or -1 for names that do not affect the filter
+  std::vector<int> nameSlots_;
+  /// Converts value ints to strings for regular expressions; nullptr if the filter has no data store
+  const CategoryNameManager* names_ = nullptr;
+};
+
+}
+
+#endif /* SIMDATA_COMPILEDCATEGORYFILTER_H */
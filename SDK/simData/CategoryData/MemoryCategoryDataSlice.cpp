@@ -1030,6 +1030,11 @@ size_t MemoryCategoryDataSlice::numItems() const
   return sliceSize_;
 }
 
+size_t MemoryCategoryDataSlice::memoryUsage() const
+{
+  return sliceSize_ * sizeof(TimeValuePair) + data_.size() * sizeof(EntityData::value_type);
+}
+
 bool MemoryCategoryDataSlice::isDuplicateValue(double time, const std::string& catName, const std::string& value) const
 {
   const int catInt = categoryNameManager_->nameToInt(catName);
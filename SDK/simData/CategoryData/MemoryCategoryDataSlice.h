@@ -60,6 +60,9 @@ public:
   /// Retrieves the total number of items in the slice
   size_t numItems() const;
 
+  /// Estimated number of bytes used by the items, from their count and size
+  size_t memoryUsage() const;
+
   /// Returns true if the key/value provided would be a duplicate/repeated value at the time given
   bool isDuplicateValue(double time, const std::string& catName, const std::string& value) const;
 
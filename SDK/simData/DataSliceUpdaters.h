@@ -33,6 +33,20 @@ namespace simData
 /// How long to do a sequential search before giving up and do a complete search
 const size_t FastSearchWidth = 3;
 
+/// Complete search of computeLowerBound(); specialized by storage that can search faster than std::lower_bound
+template <typename ForwardIterator, typename T>
+ForwardIterator searchLowerBound(ForwardIterator begin, ForwardIterator end, double time)
+{
+  return std::lower_bound(begin, end, time, UpdateComp<T>());
+}
+
+/// Complete search of computeUpperBound(); specialized by storage that can search faster than std::upper_bound
+template <typename ForwardIterator, typename T>
+ForwardIterator searchUpperBound(ForwardIterator begin, ForwardIterator end, double time)
+{
+  return std::upper_bound(begin, end, time, UpdateComp<T>());
+}
+
 /// Like std::lower_bound, but uses currentIt to find quickly a neighboring location.
 // (provides significant performance improvement when sequentially moving through time)
 template <typename ForwardIterator, typename T>
@@ -60,7 +74,7 @@ ForwardIterator computeLowerBound(ForwardIterator begin, ForwardIterator current
     }
   }
 
- return std::lower_bound(begin, end, time, UpdateComp<T>());
+ return searchLowerBound<ForwardIterator, T>(begin, end, time);
 }
 
 /// Like std::upper_bound, but uses currentIt to find quickly a neighboring location.
@@ -99,7 +113,7 @@ ForwardIterator computeUpperBound(ForwardIterator begin, ForwardIterator current
     }
   }
 
-  return std::upper_bound(begin, end, time, UpdateComp<T>());
+  return searchUpperBound<ForwardIterator, T>(begin, end, time);
 }
 
 /** Update slices to the specified time */
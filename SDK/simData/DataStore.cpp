@@ -20,11 +20,62 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <compare>
+#include <functional>
+#include <utility>
+#include "simData/CategoryData/CategoryFilter.h"
 #include "simData/DataStore.h"
 #include "simData/DataTable.h"
 
 namespace simData
 {
+
+namespace
+{
+
+/** Lower cases ASCII letters, matching the EntityNameCache folding */
+unsigned char foldChar(char c)
+{
+  const unsigned char u = static_cast<unsigned char>(c);
+  return (u >= 'A' && u <= 'Z') ? static_cast<unsigned char>(u + ('a' - 'A')) : u;
+}
+
+/** Returns true if the characters are equal, with optional case folding */
+bool sameChar(char lhs, char rhs, bool caseSensitive)
+{
+  return caseSensitive ? (lhs == rhs) : (foldChar(lhs) == foldChar(rhs));
+}
+
+/** Fills ids with the objects of type whose names match, ordered by name ignoring case and then by name */
+void idListByNameMatch(const DataStore& dataStore, ObjectType type, const std::function<bool(const std::string&)>& match, DataStore::IdList* ids)
+{
+  if (ids == nullptr)
+    return;
+  ids->clear();
+
+  DataStore::IdList all;
+  dataStore.idList(&all, type);
+  std::vector<std::pair<std::string, ObjectId> > matches;
+  for (ObjectId id : all)
+  {
+    DataStore::Transaction transaction;
+    const CommonPrefs* prefs = dataStore.commonPrefs(id, &transaction);
+    if (prefs && match(prefs->name()))
+      matches.emplace_back(prefs->name(), id);
+  }
+
+  std::stable_sort(matches.begin(), matches.end(), [](const auto& lhs, const auto& rhs) {
+    const auto folded = std::lexicographical_compare_three_way(lhs.first.begin(), lhs.first.end(), rhs.first.begin(), rhs.first.end(),
+      [](char l, char r) { return foldChar(l) <=> foldChar(r); });
+    return (folded != 0) ? (folded < 0) : (lhs.first < rhs.first);
+  });
+  for (const auto& nameAndId : matches)
+    ids->push_back(nameAndId.second);
+}
+
+}
+
 //----------------------------------------------------------------------------
 DataStore::Transaction::Transaction()
 {
@@ -65,5 +116,58 @@ DataStore::~DataStore()
 {
 }
 
+int DataStore::addPlatformUpdates(ObjectId id, std::span<const PlatformUpdate> updates)
+{
+  return addUpdates_(id, updates, &DataStore::addPlatformUpdate);
+}
+
+int DataStore::addBeamUpdates(ObjectId id, std::span<const BeamUpdate> updates)
+{
+  return addUpdates_(id, updates, &DataStore::addBeamUpdate);
+}
+
+int DataStore::addGateUpdates(ObjectId id, std::span<const GateUpdate> updates)
+{
+  return addUpdates_(id, updates, &DataStore::addGateUpdate);
+}
+
+template <typename UpdateType>
+int DataStore::addUpdates_(ObjectId id, std::span<const UpdateType> updates, UpdateType* (DataStore::*addUpdate)(ObjectId, Transaction*))
+{
+  if (objectType(id) == NONE)
+    return 1;
+  for (const auto& update : updates)
+  {
+    Transaction transaction;
+    UpdateType* newUpdate = (this->*addUpdate)(id, &transaction);
+    if (!newUpdate)
+      return 1;
+    *newUpdate = update;
+    transaction.commit();
+  }
+  return 0;
+}
+
+void DataStore::idListByNamePrefix(const std::string& prefix, IdList* ids, simData::ObjectType type, bool caseSensitive) const
+{
+  idListByNameMatch(*this, type, [&prefix, caseSensitive](const std::string& name) {
+    return (name.size() >= prefix.size()) && std::equal(prefix.begin(), prefix.end(), name.begin(),
+      [caseSensitive](char l, char r) { return sameChar(l, r, caseSensitive); });
+  }, ids);
+}
+
+void DataStore::idListByNameSubstring(const std::string& text, IdList* ids, simData::ObjectType type, bool caseSensitive) const
+{
+  idListByNameMatch(*this, type, [&text, caseSensitive](const std::string& name) {
+    return std::search(name.begin(), name.end(), text.begin(), text.end(),
+      [caseSensitive](char l, char r) { return sameChar(l, r, caseSensitive); }) != name.end();
+  }, ids);
+}
+
+void DataStore::idListByNameRegExp(const RegExpFilter& regExp, IdList* ids, simData::ObjectType type) const
+{
+  idListByNameMatch(*this, type, [&regExp](const std::string& name) { return regExp.match(name); }, ids);
+}
+
 } // namespace simData
 
@@ -26,6 +26,7 @@
 #include <cassert>
 #include <functional>
 #include <memory>
+#include <span>
 #include <vector>
 
 #include "simData/DataSlice.h"
@@ -43,6 +44,7 @@ class CategoryNameManager;
 class GenericDataSlice;
 class DataTableManager;
 class DataTable;
+class RegExpFilter;
 
 /** @brief Interface for storing and retrieving scenario data
  *
@@ -251,6 +253,14 @@ public:
 
     /// New update was added for the entity ID provided, at the time provided.  Query the data store for the contents of the update.
     virtual void onEntityUpdate(simData::DataStore* source, simData::ObjectId id, double dataTime) = 0;
+    /**
+     * A batch of updates was added for the entity ID provided, spanning the times provided.  Sent once per
+     * batch instead of once per update.  Default implementation forwards to onEntityUpdate() with the last time.
+     */
+    virtual void onEntityUpdates(simData::DataStore* source, simData::ObjectId id, double firstTime, double lastTime)
+    {
+      onEntityUpdate(source, id, lastTime);
+    }
     /// New table row was added for the entity ID provided, at the time provided.  Query the data table for contents of the row.
     virtual void onNewRowData(simData::DataStore* source, simData::DataTable& table, simData::ObjectId id, double dataTime) = 0;
     /// Notification of flush, which may interleave other entity updates.  @see simData::DataStore::Listener::onFlush()
@@ -465,6 +475,18 @@ public: // methods
   /// Retrieve a list of IDs for objects of 'type' with the given name. Does not respect alias.
   virtual void idListByName(const std::string& name, IdList* ids, simData::ObjectType type = simData::ALL) const = 0;
 
+  /**
+   * Retrieve a list of IDs for objects of 'type' whose names start with the prefix, ordered by name. Does not respect alias.
+   * The default checks the name of every object in idList(); implementations with a name index should override.
+   */
+  virtual void idListByNamePrefix(const std::string& prefix, IdList* ids, simData::ObjectType type = simData::ALL, bool caseSensitive = true) const;
+
+  /// Retrieve a list of IDs for objects of 'type' whose names contain the text. Does not respect alias. The default checks every name.
+  virtual void idListByNameSubstring(const std::string& text, IdList* ids, simData::ObjectType type = simData::ALL, bool caseSensitive = true) const;
+
+  /// Retrieve a list of IDs for objects of 'type' whose names match the regular expression. Does not respect alias. The default checks every name.
+  virtual void idListByNameRegExp(const RegExpFilter& regExp, IdList* ids, simData::ObjectType type = simData::ALL) const;
+
   /// Retrieve a list of IDs for objects with the given original id
   virtual void idListByOriginalId(IdList *ids, uint64_t originalId, simData::ObjectType type = simData::ALL) const = 0;
 
@@ -647,6 +669,19 @@ public: // methods
   //virtual        TableData*        addTableData(ObjectId id, Transaction *transaction) = 0;
   ///@}
 
+  /**@name Add a batch of data updates
+   * Adds copies of the updates to the entity in a single operation, with one
+   * NewUpdatesListener::onEntityUpdates() notification for the batch.  Updates sorted
+   * by time that are all later than the existing data are appended without a search.
+   * Default implementation adds the updates one transaction at a time.
+   * @return 0 on success, non-zero if the entity does not exist
+   * @{
+   */
+  virtual int addPlatformUpdates(ObjectId id, std::span<const PlatformUpdate> updates);
+  virtual int addBeamUpdates(ObjectId id, std::span<const BeamUpdate> updates);
+  virtual int addGateUpdates(ObjectId id, std::span<const GateUpdate> updates);
+  ///@}
+
   /**@name Retrieving read-only data slices
    * @note No locking performed for read-only update slice objects
    * @{
@@ -748,6 +783,11 @@ protected:
     virtual void  commit() = 0; ///< accept the updates connected to this transaction
     virtual void release() = 0; ///< reject the updates connected to this transaction
   };
+
+private:
+  /// Adds the updates one transaction at a time with the given add function
+  template <typename UpdateType>
+  int addUpdates_(ObjectId id, std::span<const UpdateType> updates, UpdateType* (DataStore::*addUpdate)(ObjectId, Transaction*));
 }; // End of class DataStore
 
 } // End of namespace simData
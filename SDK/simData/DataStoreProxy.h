@@ -147,6 +147,15 @@ public: // methods
   /// Retrieve a list of IDs for objects of 'type' with the given name
   void idListByName(const std::string& name, IdList* ids, simData::ObjectType type = simData::ALL) const override {dataStore_->idListByName(name, ids, type);}
 
+  /// Retrieve a list of IDs for objects of 'type' whose names start with the prefix, ordered by name
+  void idListByNamePrefix(const std::string& prefix, IdList* ids, simData::ObjectType type = simData::ALL, bool caseSensitive = true) const override {dataStore_->idListByNamePrefix(prefix, ids, type, caseSensitive);}
+
+  /// Retrieve a list of IDs for objects of 'type' whose names contain the text
+  void idListByNameSubstring(const std::string& text, IdList* ids, simData::ObjectType type = simData::ALL, bool caseSensitive = true) const override {dataStore_->idListByNameSubstring(text, ids, type, caseSensitive);}
+
+  /// Retrieve a list of IDs for objects of 'type' whose names match the regular expression
+  void idListByNameRegExp(const RegExpFilter& regExp, IdList* ids, simData::ObjectType type = simData::ALL) const override {dataStore_->idListByNameRegExp(regExp, ids, type);}
+
   /// Retrieve a list of IDs for objects with the given original id
   void idListByOriginalId(IdList *ids, uint64_t originalId, simData::ObjectType type = simData::ALL) const override {dataStore_->idListByOriginalId(ids, originalId, type);}
 
@@ -307,6 +316,15 @@ public: // methods
   CategoryData*   addCategoryData(ObjectId id, Transaction *transaction) override {return dataStore_->addCategoryData(id, transaction);}
   ///@}
 
+  /**@name Add a batch of data updates
+   * @return 0 on success, non-zero if the entity does not exist
+   * @{
+   */
+  int addPlatformUpdates(ObjectId id, std::span<const PlatformUpdate> updates) override {return dataStore_->addPlatformUpdates(id, updates);}
+  int addBeamUpdates(ObjectId id, std::span<const BeamUpdate> updates) override {return dataStore_->addBeamUpdates(id, updates);}
+  int addGateUpdates(ObjectId id, std::span<const GateUpdate> updates) override {return dataStore_->addGateUpdates(id, updates);}
+  ///@}
+
   /**@name Retrieving read-only data slices
    * @note No locking performed for read-only update slice objects
    * @{
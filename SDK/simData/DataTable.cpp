@@ -345,4 +345,94 @@ void TableRow::accept(TableRow::CellVisitor& visitor) const
 
 ////////////////////////////////////////////////////////////////////////
 
+TableRowBlock::TableRowBlock(const std::vector<TableColumnId>& columnIds)
+  : columnIds_(columnIds),
+    values_(columnIds.size())
+{
+}
+
+TableRowBlock::~TableRowBlock()
+{
+}
+
+const std::vector<TableColumnId>& TableRowBlock::columnIds() const
+{
+  return columnIds_;
+}
+
+size_t TableRowBlock::rowCount() const
+{
+  return times_.size();
+}
+
+bool TableRowBlock::empty() const
+{
+  return times_.empty();
+}
+
+void TableRowBlock::clear()
+{
+  times_.clear();
+  for (auto& columnValues : values_)
+    columnValues.clear();
+}
+
+void TableRowBlock::reserve(size_t numRows)
+{
+  times_.reserve(numRows);
+  for (auto& columnValues : values_)
+    columnValues.reserve(numRows);
+}
+
+TableStatus TableRowBlock::addRow(double time, std::span<const double> values)
+{
+  if (values.size() != values_.size())
+    return TableStatus::Error("Number of values does not match the number of columns.");
+  times_.push_back(time);
+  for (size_t ii = 0; ii < values.size(); ++ii)
+    values_[ii].push_back(values[ii]);
+  return TableStatus::Success();
+}
+
+const std::vector<double>& TableRowBlock::times() const
+{
+  return times_;
+}
+
+std::vector<double>& TableRowBlock::times()
+{
+  return times_;
+}
+
+const std::vector<double>& TableRowBlock::values(size_t columnIndex) const
+{
+  return values_[columnIndex];
+}
+
+std::vector<double>& TableRowBlock::values(size_t columnIndex)
+{
+  return values_[columnIndex];
+}
+
+void TableRowBlock::getRow(size_t rowIndex, TableRow& row) const
+{
+  row.clear();
+  row.setTime(times_[rowIndex]);
+  row.reserve(columnIds_.size());
+  for (size_t ii = 0; ii < columnIds_.size(); ++ii)
+    row.setValue(columnIds_[ii], values_[ii][rowIndex]);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void DataTable::TableObserver::onAddRows(DataTable& table, const TableRowBlock& block)
+{
+  TableRow row;
+  for (size_t ii = 0; ii < block.rowCount(); ++ii)
+  {
+    block.getRow(ii, row);
+    onAddRow(table, row);
+  }
+}
+
 }
@@ -24,6 +24,7 @@
 #define SIMDATA_DATATABLE_H
 
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 #include <deque>
@@ -64,9 +65,26 @@ enum VariableType
   VT_STRING
 };
 
+/** Maps a storage type to its VariableType, e.g. VariableTypeOf<double>::value is VT_DOUBLE */
+template <typename T> struct VariableTypeOf;
+/// @cond
+template <> struct VariableTypeOf<uint8_t> { static constexpr VariableType value = VT_UINT8; };
+template <> struct VariableTypeOf<int8_t> { static constexpr VariableType value = VT_INT8; };
+template <> struct VariableTypeOf<uint16_t> { static constexpr VariableType value = VT_UINT16; };
+template <> struct VariableTypeOf<int16_t> { static constexpr VariableType value = VT_INT16; };
+template <> struct VariableTypeOf<uint32_t> { static constexpr VariableType value = VT_UINT32; };
+template <> struct VariableTypeOf<int32_t> { static constexpr VariableType value = VT_INT32; };
+template <> struct VariableTypeOf<uint64_t> { static constexpr VariableType value = VT_UINT64; };
+template <> struct VariableTypeOf<int64_t> { static constexpr VariableType value = VT_INT64; };
+template <> struct VariableTypeOf<float> { static constexpr VariableType value = VT_FLOAT; };
+template <> struct VariableTypeOf<double> { static constexpr VariableType value = VT_DOUBLE; };
+template <> struct VariableTypeOf<std::string> { static constexpr VariableType value = VT_STRING; };
+/// @endcond
+
 class DataTable;
 class TableColumn;
 class TableRow;
+class TableRowBlock;
 class TableList;
 
 /// Column IDs are 64 bit integers; TODO should this be unsigned? 32 bits?
@@ -422,6 +440,16 @@ public:
    */
   virtual TableStatus addRow(const TableRow& row) = 0;
 
+  /**
+   * Adds a block of rows to the table, with the same contents as adding each row with addRow().
+   * Observers are notified once for the block, through TableObserver::onAddRows(), and data
+   * limiting is applied once after the block is added.  If adding a row fails, the rows before
+   * it remain and observers are notified of only those rows.
+   * @param block Rows to add to the table; every row has a value for each column of the block.
+   * @return Status indicating success or failure of row addition
+   */
+  virtual TableStatus addRows(const TableRowBlock& block) = 0;
+
   /**
    * Deletes all the data in the specified data table column, leaving the column empty.
    * @param id Column ID of the column to flush or -1 to flush all columns in the table
@@ -458,6 +486,14 @@ public:
    */
     virtual void onAddRow(DataTable& table, const TableRow& row) = 0;
 
+    /**
+    * Called after a block of rows is added, in DataTable::addRows.  The default implementation
+    * calls onAddRow() for each row of the block.
+    * @param table  reference to the parent DataTable
+    * @param block  reference to the newly added rows
+    */
+    virtual void onAddRows(DataTable& table, const TableRowBlock& block);
+
     /**
     * Called just before a TableColumn is removed from the table
     * @param table  reference to the parent DataTable
@@ -552,6 +588,68 @@ public:
   /// TimeContainer::Iterator lets users iterate over time/index values in-order
   typedef GenericIterator<IteratorDataPtr> Iterator;
 
+  /**
+   * Values of consecutive rows, stored contiguously and in time order.  Rows are held in two
+   * storage bins, and spans of different bins may overlap in time.  The pointer is valid until
+   * the table changes.
+   */
+  struct ValueSpan
+  {
+    /// Storage type of the values, matching variableType()
+    VariableType type = VT_DOUBLE;
+    /// First value
+    const void* data = nullptr;
+    /// Number of values
+    size_t size = 0;
+    /// Time of the first row
+    double beginTime = 0.0;
+    /// Time of the last row
+    double endTime = 0.0;
+
+    /** Returns the values, or an empty span if T is not the storage type */
+    template <typename T>
+    std::span<const T> values() const
+    {
+      if (type != VariableTypeOf<T>::value)
+        return std::span<const T>();
+      return std::span<const T>(static_cast<const T*>(data), size);
+    }
+  };
+
+  /** Statistics of the values in a time range, from statistics() */
+  struct Statistics
+  {
+    /// Number of values
+    size_t count = 0;
+    /// Smallest value; 0 if there are no values
+    double minimum = 0.0;
+    /// Largest value; 0 if there are no values
+    double maximum = 0.0;
+    /// Sum of the values
+    double sum = 0.0;
+    /// Mean of the values; 0 if there are no values
+    double mean = 0.0;
+    /// Number of values greater than the threshold
+    size_t countAboveThreshold = 0;
+  };
+
+  /** Smallest and largest values of the rows in one time interval, from getMinMaxBuckets() */
+  struct MinMaxBucket
+  {
+    /// Start of the interval
+    double beginTime = 0.0;
+    /// Number of rows in the interval, not counting NaN values; the rest of the fields are 0 if there are none
+    size_t count = 0;
+    /// Time of the row with the smallest value
+    double minTime = 0.0;
+    /// Smallest value
+    double minValue = 0.0;
+    /// Time of the row with the largest value
+    double maxTime = 0.0;
+    /// Largest value
+    double maxValue = 0.0;
+  };
+
   /**
    * Provides an interface to interpolate between data points.
    */
@@ -659,6 +757,41 @@ public:
    */
   virtual int getTimeRange(double& begin, double& end) const = 0;
   /// @}
+
+  /**
+   * Retrieves the values of rows with times in [beginTime, endTime) as contiguous spans, with no
+   * per-value conversion.  Spans of each storage bin are in time order.
+   * @param beginTime Inclusive start of the time range
+   * @param endTime Exclusive end of the time range
+   * @param spans Cleared, then filled with the spans covering the range
+   * @return Status return value
+   */
+  virtual TableStatus getValueSpans(double beginTime, double endTime, std::vector<ValueSpan>& spans) const = 0;
+
+  /**
+   * Computes statistics of the values of rows with times in [beginTime, endTime).  Not available
+   * for string columns.
+   * @param beginTime Inclusive start of the time range
+   * @param endTime Exclusive end of the time range
+   * @param threshold Values greater than this are counted in Statistics::countAboveThreshold
+   * @param stats Filled with the statistics
+   * @return Status return value; error for string columns
+   */
+  virtual TableStatus statistics(double beginTime, double endTime, double threshold, Statistics& stats) const = 0;
+
+  /**
+   * Divides [beginTime, endTime) into equal intervals and finds the smallest and largest value
+   * in each, e.g. one interval per pixel of a plot.  The column keeps a multi-resolution summary
+   * of its values, built by the first call and updated as rows are added, so that the cost
+   * depends on the number of intervals rather than the number of rows.  Not available for
+   * string columns.
+   * @param beginTime Inclusive start of the time range
+   * @param endTime Exclusive end of the time range
+   * @param numBuckets Number of intervals
+   * @param buckets Filled with one bucket per interval, in time order
+   * @return Status return value; error for string columns
+   */
+  virtual TableStatus getMinMaxBuckets(double beginTime, double endTime, size_t numBuckets, std::vector<MinMaxBucket>& buckets) const = 0;
 };
 
 /// Forward declare a cell class to be used internally by TableRow
@@ -811,6 +944,58 @@ private:
   TableCell* findCell_(TableColumnId id) const;
 };
 
+/**
+ * Rows for DataTable::addRows(), stored column-major: a time for each row and, for each of a
+ * fixed set of columns, a value for each row.  Every row has a value in every column of the
+ * block.  Values are held as double and converted to the storage type of their column, as
+ * with TableRow::setValue(TableColumnId, double).  Rows may be added with addRow(), or by
+ * filling times() and values() directly.
+ */
+class SDKDATA_EXPORT TableRowBlock
+{
+public:
+  /** Creates a block without rows for the given columns */
+  explicit TableRowBlock(const std::vector<TableColumnId>& columnIds);
+  virtual ~TableRowBlock();
+
+  /** Columns of the block; values(n) holds the values of columnIds()[n] */
+  const std::vector<TableColumnId>& columnIds() const;
+  /** Number of rows, i.e. the number of times */
+  size_t rowCount() const;
+  /** Returns true if there are no rows in the block */
+  bool empty() const;
+
+  /** Removes all rows, keeping the columns and the memory for reuse */
+  void clear();
+  /** Optionally reserves the space for the expected number of rows */
+  void reserve(size_t numRows);
+
+  /**
+   * Appends a row to the block.
+   * @param time Time stamp of the row
+   * @param values One value per column, in the order of columnIds()
+   * @return Error if the number of values does not match the number of columns
+   */
+  TableStatus addRow(double time, std::span<const double> values);
+
+  /** Times of the rows */
+  const std::vector<double>& times() const;
+  /** Times of the rows, for filling directly; each of values() must end up the same size */
+  std::vector<double>& times();
+  /** Values of the column at the index into columnIds(), one per row */
+  const std::vector<double>& values(size_t columnIndex) const;
+  /** Values of the column at the index into columnIds(), for filling directly */
+  std::vector<double>& values(size_t columnIndex);
+
+  /** Returns the row at the index as a TableRow */
+  void getRow(size_t rowIndex, TableRow& row) const;
+
+private:
+  std::vector<TableColumnId> columnIds_;
+  std::vector<double> times_;
+  std::vector<std::vector<double> > values_;
+};
+
 
 }
 
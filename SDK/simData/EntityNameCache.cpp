@@ -20,11 +20,54 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
 #include <cassert>
+#include "simData/CategoryData/CategoryFilter.h"
 #include "simData/EntityNameCache.h"
 
 namespace simData {
 
+/// Number of dropped names allowed before the indexes are compacted, regardless of the number of live names
+static const size_t MIN_DROPPED_TO_COMPACT = 1024;
+
+/** Lower cases ASCII letters */
+static inline unsigned char foldChar(char c)
+{
+  const unsigned char u = static_cast<unsigned char>(c);
+  return (u >= 'A' && u <= 'Z') ? static_cast<unsigned char>(u + ('a' - 'A')) : u;
+}
+
+/** Returns the key in the gram index of the three case-folded characters starting at text */
+static inline uint32_t gramKey(const char* text)
+{
+  return (static_cast<uint32_t>(foldChar(text[0])) << 16) | (static_cast<uint32_t>(foldChar(text[1])) << 8) | foldChar(text[2]);
+}
+
+/** Compares case-insensitively, returning negative, 0 or positive like strcmp */
+static int foldedCompare(std::string_view lhs, std::string_view rhs)
+{
+  const size_t length = std::min(lhs.size(), rhs.size());
+  for (size_t ii = 0; ii < length; ++ii)
+  {
+    const unsigned char l = foldChar(lhs[ii]);
+    const unsigned char r = foldChar(rhs[ii]);
+    if (l != r)
+      return (l < r) ? -1 : 1;
+  }
+  if (lhs.size() == rhs.size())
+    return 0;
+  return (lhs.size() < rhs.size()) ? -1 : 1;
+}
+
+/** Returns true if name contains text, with optional case folding */
+static bool contains(std::string_view name, std::string_view text, bool caseSensitive)
+{
+  if (caseSensitive)
+    return name.find(text) != std::string_view::npos;
+  return std::search(name.begin(), name.end(), text.begin(), text.end(),
+    [](char l, char r) { return foldChar(l) == foldChar(r); }) != name.end();
+}
+
 EntityNameEntry::EntityNameEntry(simData::ObjectId id, simData::ObjectType type)
   : id_(id),
     type_(type)
@@ -47,69 +90,214 @@ simData::ObjectType EntityNameEntry::type() const
 
 //---------------------------------------------------------------------------------------------------------------------------
 
+bool EntityNameCache::FoldedLess::operator()(NameId lhs, NameId rhs) const
+{
+  const std::string& lhsName = (*names)[lhs].name;
+  const std::string& rhsName = (*names)[rhs].name;
+  const int folded = foldedCompare(lhsName, rhsName);
+  return (folded != 0) ? (folded < 0) : (lhsName < rhsName);
+}
+
+bool EntityNameCache::FoldedLess::operator()(NameId lhs, std::string_view rhs) const
+{
+  return foldedCompare((*names)[lhs].name, rhs) < 0;
+}
+
+bool EntityNameCache::FoldedLess::operator()(std::string_view lhs, NameId rhs) const
+{
+  return foldedCompare(lhs, (*names)[rhs].name) < 0;
+}
+
 EntityNameCache::EntityNameCache()
+  : sorted_(FoldedLess{ &names_ })
 {
 }
 
 EntityNameCache::~EntityNameCache()
 {
-  for (EntityMap::iterator iter = entries_.begin(); iter != entries_.end(); ++iter)
-    delete iter->second;
+  for (const Name& name : names_)
+  {
+    for (EntityNameEntry* entry : name.entries)
+      delete entry;
+  }
 }
 
-void EntityNameCache::getEntries(const std::string& name, simData::ObjectType type, std::vector<const EntityNameEntry*>& entries) const
+void EntityNameCache::appendEntries_(const Name& name, simData::ObjectType type, std::vector<const EntityNameEntry*>& entries)
 {
-  const std::pair<EntityMap::const_iterator, EntityMap::const_iterator> range = entries_.equal_range(name);
-  for (EntityMap::const_iterator iter = range.first; iter != range.second; ++iter)
+  for (const EntityNameEntry* entry : name.entries)
   {
-    if (iter->second->type() & type)
-      entries.push_back(iter->second);
+    if (entry->type() & type)
+      entries.push_back(entry);
   }
 }
 
-void EntityNameCache::addEntity(const std::string& name, simData::ObjectId newId, simData::ObjectType ot)
+void EntityNameCache::getEntries(const std::string& name, simData::ObjectType type, std::vector<const EntityNameEntry*>& entries) const
 {
-  entries_.insert(std::pair<std::string, EntityNameEntry*>(name, new EntityNameEntry(newId, ot)));
+  const NameId nameId = findName_(name);
+  if (nameId < names_.size())
+    appendEntries_(names_[nameId], type, entries);
 }
 
-void EntityNameCache::removeEntity(const std::string& name, simData::ObjectId removedId, simData::ObjectType ot)
+void EntityNameCache::getEntriesWithPrefix(const std::string& prefix, simData::ObjectType type, bool caseSensitive, std::vector<const EntityNameEntry*>& entries) const
 {
-  const std::pair<EntityMap::iterator, EntityMap::iterator> range = entries_.equal_range(name);
-  for (EntityMap::iterator iter = range.first; iter != range.second; ++iter)
+  // Names starting with the prefix, ignoring case, follow the first name not less than the prefix
+  for (auto iter = sorted_.lower_bound(std::string_view(prefix)); iter != sorted_.end(); ++iter)
   {
-    if (iter->second->id() == removedId)
+    const Name& name = names_[*iter];
+    if (name.name.size() < prefix.size() || foldedCompare(std::string_view(name.name).substr(0, prefix.size()), prefix) != 0)
+      break;
+    if (!caseSensitive || name.name.compare(0, prefix.size(), prefix) == 0)
+      appendEntries_(name, type, entries);
+  }
+}
+
+void EntityNameCache::getEntriesContaining(const std::string& text, simData::ObjectType type, bool caseSensitive, std::vector<const EntityNameEntry*>& entries) const
+{
+  if (text.size() < 3)
+  {
+    for (NameId nameId : sorted_)
     {
-      delete iter->second;
-      entries_.erase(iter);
-      return;
+      if (contains(names_[nameId].name, text, caseSensitive))
+        appendEntries_(names_[nameId], type, entries);
     }
+    return;
+  }
+
+  // Every match contains every sequence of the text, so only the names with the rarest one need testing
+  const std::vector<NameId>* candidates = nullptr;
+  for (size_t ii = 0; ii + 3 <= text.size(); ++ii)
+  {
+    auto gramIter = grams_.find(gramKey(&text[ii]));
+    if (gramIter == grams_.end())
+      return;
+    if (candidates == nullptr || gramIter->second.size() < candidates->size())
+      candidates = &gramIter->second;
   }
 
-  // The map entries_ is not consistent with the datastore
-  assert(false);
+  for (NameId nameId : *candidates)
+  {
+    const Name& name = names_[nameId];
+    if (!name.entries.empty() && contains(name.name, text, caseSensitive))
+      appendEntries_(name, type, entries);
+  }
+}
+
+void EntityNameCache::getEntriesMatching(const RegExpFilter& regExp, simData::ObjectType type, std::vector<const EntityNameEntry*>& entries) const
+{
+  for (NameId nameId : sorted_)
+  {
+    const Name& name = names_[nameId];
+    if (regExp.match(name.name))
+      appendEntries_(name, type, entries);
+  }
+}
+
+void EntityNameCache::addEntity(const std::string& name, simData::ObjectId newId, simData::ObjectType ot)
+{
+  names_[addName_(name)].entries.push_back(new EntityNameEntry(newId, ot));
+}
+
+void EntityNameCache::removeEntity(const std::string& name, simData::ObjectId removedId, simData::ObjectType ot)
+{
+  EntityNameEntry* entry = detach_(name, removedId);
+  // The cache is not consistent with the datastore
+  assert(entry != nullptr);
+  delete entry;
 }
 
 void EntityNameCache::nameChange(const std::string& newName, const std::string& oldName, simData::ObjectId changeId)
 {
-  const std::pair<EntityMap::iterator, EntityMap::iterator> range = entries_.equal_range(oldName);
-  for (EntityMap::iterator iter = range.first; iter != range.second; ++iter)
+  // Make sure name actually changed; onNameChanged gets call when switching between name and alias
+  if (newName == oldName)
   {
-    if (iter->second->id() == changeId)
-    {
-      // Make sure name actually changed; onNameChanged gets call when switching between name and alias
-      if (iter->first != newName)
-      {
-        EntityNameEntry* entry = iter->second;
-        entries_.erase(iter);
-        entries_.insert(std::pair<std::string, EntityNameEntry*>(newName, entry));
-      }
+    assert(findName_(oldName) < names_.size());
+    return;
+  }
 
-      return;
-    }
+  EntityNameEntry* entry = detach_(oldName, changeId);
+  // The cache is not consistent with the datastore
+  assert(entry != nullptr);
+  if (entry != nullptr)
+    names_[addName_(newName)].entries.push_back(entry);
+}
+
+EntityNameCache::NameId EntityNameCache::findName_(std::string_view name) const
+{
+  auto iter = exact_.find(name);
+  return (iter == exact_.end()) ? static_cast<NameId>(names_.size()) : iter->second;
+}
+
+EntityNameCache::NameId EntityNameCache::addName_(const std::string& name)
+{
+  NameId nameId = findName_(name);
+  if (nameId < names_.size())
+    return nameId;
+
+  // IDs only increase between compactions, keeping the lists in grams_ sorted
+  nameId = static_cast<NameId>(names_.size());
+  names_.emplace_back();
+  names_.back().name = name;
+  exact_.emplace(std::string_view(names_.back().name), nameId);
+  sorted_.insert(nameId);
+  indexGrams_(nameId);
+  return nameId;
+}
+
+EntityNameEntry* EntityNameCache::detach_(const std::string& name, simData::ObjectId id)
+{
+  const NameId nameId = findName_(name);
+  if (nameId >= names_.size())
+    return nullptr;
+
+  Name& entry = names_[nameId];
+  auto iter = std::find_if(entry.entries.begin(), entry.entries.end(), [id](const EntityNameEntry* e) { return e->id() == id; });
+  if (iter == entry.entries.end())
+    return nullptr;
+  EntityNameEntry* detached = *iter;
+  entry.entries.erase(iter);
+  if (!entry.entries.empty())
+    return detached;
+
+  // The name stays in grams_, where queries skip it, until there are enough dropped names to compact
+  sorted_.erase(nameId);
+  exact_.erase(std::string_view(entry.name));
+  std::string().swap(entry.name);
+  ++numDropped_;
+  if (numDropped_ >= MIN_DROPPED_TO_COMPACT && numDropped_ > exact_.size())
+    compact_();
+  return detached;
+}
+
+void EntityNameCache::indexGrams_(NameId nameId)
+{
+  const std::string& name = names_[nameId].name;
+  for (size_t ii = 0; ii + 3 <= name.size(); ++ii)
+  {
+    std::vector<NameId>& ids = grams_[gramKey(&name[ii])];
+    // A name's sequences are added together, so a repeated sequence shows up at the back
+    if (ids.empty() || ids.back() != nameId)
+      ids.push_back(nameId);
   }
+}
 
-  // The map entries_ is not consistent with the datastore
-  assert(false);
+void EntityNameCache::compact_()
+{
+  sorted_.clear();
+  exact_.clear();
+  grams_.clear();
+  std::deque<Name> oldNames;
+  oldNames.swap(names_);
+  for (Name& name : oldNames)
+  {
+    if (name.entries.empty())
+      continue;
+    const NameId nameId = static_cast<NameId>(names_.size());
+    names_.push_back(std::move(name));
+    exact_.emplace(std::string_view(names_.back().name), nameId);
+    sorted_.insert(nameId);
+    indexGrams_(nameId);
+  }
+  numDropped_ = 0;
 }
 
 
@@ -20,18 +20,24 @@
  * disclose, or release this software.
  *
  */
-
 #ifndef SIMDATA_ENTITY_NAME_CACHE_H
 #define SIMDATA_ENTITY_NAME_CACHE_H
 
-#include <map>
+#include <cstdint>
+#include <deque>
+#include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#include "simCore/Common/Common.h"
 #include "simData/ObjectId.h"
 
 namespace simData {
 
+class RegExpFilter;
+
 /// Information that is stored per entity name
 class SDKDATA_EXPORT EntityNameEntry
 {
@@ -50,29 +56,83 @@ private:
   simData::ObjectType type_;
 };
 
-/// Manages a multimap keyed on entity name
+/**
+ * Indexes entities by name.  Exact lookups are hashed; prefix lookups use a case-insensitive
+ * sorted index; substring lookups use an index of the three-character sequences in each name, so
+ * that searches examine only names sharing the rarest sequence of the search text.  Case folding
+ * applies to ASCII letters only.
+ */
 class SDKDATA_EXPORT EntityNameCache
 {
 public:
   EntityNameCache();
   virtual ~EntityNameCache();
 
-  /// Adds the given entity to the multimap
+  SDK_DISABLE_COPY_MOVE(EntityNameCache);
+
+  /// Adds the given entity to the cache
   void addEntity(const std::string& name, simData::ObjectId newId, simData::ObjectType ot);
-  /// Removes the given entity from the multimap
+  /// Removes the given entity from the cache
   void removeEntity(const std::string& name, simData::ObjectId removedId, simData::ObjectType ot);
   /// Changes the name of the given entity
   void nameChange(const std::string& newName, const std::string& oldName, simData::ObjectId changeId);
   /// Returns a vector of EntityNameEntry for the given name and given type
   void getEntries(const std::string& name, simData::ObjectType type, std::vector<const EntityNameEntry*>& entries) const;
+  /// Appends the entries of the given type whose names start with prefix, ordered by name
+  void getEntriesWithPrefix(const std::string& prefix, simData::ObjectType type, bool caseSensitive, std::vector<const EntityNameEntry*>& entries) const;
+  /// Appends the entries of the given type whose names contain text; text shorter than three characters tests every name
+  void getEntriesContaining(const std::string& text, simData::ObjectType type, bool caseSensitive, std::vector<const EntityNameEntry*>& entries) const;
+  /// Appends the entries of the given type whose names match the regular expression, which is tested once per distinct name
+  void getEntriesMatching(const RegExpFilter& regExp, simData::ObjectType type, std::vector<const EntityNameEntry*>& entries) const;
 
 private:
-  typedef std::multimap<std::string, EntityNameEntry*> EntityMap;  /// Keyed off entity name
-  EntityMap entries_;
+  /// Index into names_
+  typedef uint32_t NameId;
+
+  /// The entities sharing one name; a name without entities stays in grams_ until the next compact_()
+  struct Name
+  {
+    std::string name;
+    std::vector<EntityNameEntry*> entries;
+  };
+
+  /// Orders names case-insensitively, then exactly; compares with a string_view case-insensitively for prefix lookups
+  struct FoldedLess
+  {
+    typedef void is_transparent;
+    const std::deque<Name>* names;
+
+    bool operator()(NameId lhs, NameId rhs) const;
+    bool operator()(NameId lhs, std::string_view rhs) const;
+    bool operator()(std::string_view lhs, NameId rhs) const;
+  };
+
+  /** Returns the ID of the live name, or names_.size() if there is none */
+  NameId findName_(std::string_view name) const;
+  /** Returns the ID of the live name, adding it to the indexes if needed */
+  NameId addName_(const std::string& name);
+  /** Detaches the entry of the entity from the name, dropping the name if it has no entities left; returns nullptr if not found */
+  EntityNameEntry* detach_(const std::string& name, simData::ObjectId id);
+  /** Adds the three-character sequences of the name to grams_ */
+  void indexGrams_(NameId nameId);
+  /** Rebuilds the indexes without the dropped names */
+  void compact_();
+  /** Appends the entries of the name that match the type */
+  static void appendEntries_(const Name& name, simData::ObjectType type, std::vector<const EntityNameEntry*>& entries);
+
+  /// Names do not move when the deque grows, so the indexes can view their strings
+  std::deque<Name> names_;
+  /// Live names
+  std::unordered_map<std::string_view, NameId> exact_;
+  /// Live names in case-insensitive order
+  std::set<NameId, FoldedLess> sorted_;
+  /// Maps three case-folded characters to the names containing them, in ascending order of ID
+  std::unordered_map<uint32_t, std::vector<NameId> > grams_;
+  /// Number of names without entities
+  size_t numDropped_ = 0;
 };
 
 
 }
 
 #endif
-
@@ -0,0 +1,169 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cassert>
+#include "simCore/Calc/Calculations.h"
+#include "simCore/Calc/Coordinate.h"
+#include "simCore/Calc/CoordinateConverter.h"
+#include "simCore/Calc/Interpolation.h"
+#include "simCore/Calc/Math.h"
+#include "simData/GeodesicInterpolator.h"
+
+namespace simData {
+
+GeodesicInterpolator::GeodesicInterpolator(size_t cacheSize)
+  : cache_(cacheSize)
+{
+}
+
+GeodesicInterpolator::~GeodesicInterpolator()
+{
+}
+
+bool GeodesicInterpolator::interpolate(double time, const PlatformUpdate &prev, const PlatformUpdate &next, PlatformUpdate *result)
+{
+  // Test for same input/output -- this function cannot handle case of prev == result, or next == result
+  if (!result || &prev == result || &next == result)
+  {
+    assert(0);
+    return false;
+  }
+  // time must be within bounds for interpolation to work
+  assert(prev.time() <= time && time <= next.time());
+
+  // The ends are copied, rather than matched to the accuracy of the geodesic solution
+  if (time <= prev.time() || time >= next.time())
+  {
+    *result = (time <= prev.time()) ? prev : next;
+    return false;
+  }
+
+  InterpolatorSegmentCache<Segment>::Key key;
+  InterpolatorSegmentCache<Segment>::makeKey(prev, next, key);
+  Segment segment;
+  if (!cache_.find(key, segment))
+  {
+    makeSegment_(prev, next, segment);
+    cache_.insert(key, segment);
+  }
+
+  const double factor = simCore::getFactor(prev.time(), time, next.time());
+  double lat = segment.lat;
+  double lon = segment.lon;
+  if (segment.distance > 0.0)
+    simCore::sodanoDirect(segment.lat, segment.lon, 0.0, factor * segment.distance, segment.azimuth, &lat, &lon);
+
+  simCore::Coordinate resultsLla(simCore::COORD_SYS_LLA, simCore::Vec3(lat, lon, simCore::linearInterpolate(segment.alt1, segment.alt2, factor)));
+  if (segment.hasOrientation)
+  {
+    double q[4];
+    simCore::dQSlerp(segment.q1, segment.q2, factor, q);
+    simCore::Vec3 ori;
+    simCore::d3QtoEuler(q, ori);
+    resultsLla.setOrientation(ori);
+  }
+  if (segment.hasVelocity)
+  {
+    resultsLla.setVelocity(simCore::linearInterpolate(segment.v1[0], segment.v2[0], factor),
+      simCore::linearInterpolate(segment.v1[1], segment.v2[1], factor),
+      simCore::linearInterpolate(segment.v1[2], segment.v2[2], factor));
+  }
+
+  simCore::Coordinate resultsEcef;
+  simCore::CoordinateConverter::convertGeodeticToEcef(resultsLla, resultsEcef);
+
+  result->set_time(time);
+  result->set_x(resultsEcef.x());
+  result->set_y(resultsEcef.y());
+  result->set_z(resultsEcef.z());
+
+  if (resultsEcef.hasVelocity())
+  {
+    result->set_vx(resultsEcef.vx());
+    result->set_vy(resultsEcef.vy());
+    result->set_vz(resultsEcef.vz());
+  }
+
+  if (resultsEcef.hasOrientation())
+  {
+    result->set_psi(resultsEcef.psi());
+    result->set_theta(resultsEcef.theta());
+    result->set_phi(resultsEcef.phi());
+  }
+
+  return true;
+}
+
+uint64_t GeodesicInterpolator::cacheHits() const
+{
+  return cache_.hits();
+}
+
+uint64_t GeodesicInterpolator::cacheMisses() const
+{
+  return cache_.misses();
+}
+
+void GeodesicInterpolator::makeSegment_(const PlatformUpdate &prev, const PlatformUpdate &next, Segment& segment)
+{
+  segment.hasOrientation = prev.has_orientation() && next.has_orientation();
+  segment.hasVelocity = prev.has_velocity() && next.has_velocity();
+
+  simCore::Coordinate prevEcef(simCore::COORD_SYS_ECEF, simCore::Vec3(prev.x(), prev.y(), prev.z()));
+  simCore::Coordinate nextEcef(simCore::COORD_SYS_ECEF, simCore::Vec3(next.x(), next.y(), next.z()));
+  if (segment.hasOrientation)
+  {
+    prevEcef.setOrientation(prev.psi(), prev.theta(), prev.phi());
+    nextEcef.setOrientation(next.psi(), next.theta(), next.phi());
+  }
+  if (segment.hasVelocity)
+  {
+    prevEcef.setVelocity(prev.vx(), prev.vy(), prev.vz());
+    nextEcef.setVelocity(next.vx(), next.vy(), next.vz());
+  }
+  simCore::Coordinate prevLla;
+  simCore::Coordinate nextLla;
+  simCore::CoordinateConverter::convertEcefToGeodetic(prevEcef, prevLla);
+  simCore::CoordinateConverter::convertEcefToGeodetic(nextEcef, nextLla);
+
+  segment.lat = prevLla.lat();
+  segment.lon = prevLla.lon();
+  segment.alt1 = prevLla.alt();
+  segment.alt2 = nextLla.alt();
+  segment.distance = simCore::sodanoInverse(prevLla.lat(), prevLla.lon(), 0.0, nextLla.lat(), nextLla.lon(), &segment.azimuth);
+
+  if (segment.hasOrientation)
+  {
+    simCore::d3EulertoQ(prevLla.orientation(), segment.q1);
+    simCore::d3EulertoQ(nextLla.orientation(), segment.q2);
+  }
+  if (segment.hasVelocity)
+  {
+    for (size_t ii = 0; ii < 3; ++ii)
+    {
+      segment.v1[ii] = prevLla.velocity()[ii];
+      segment.v2[ii] = nextLla.velocity()[ii];
+    }
+  }
+}
+
+}
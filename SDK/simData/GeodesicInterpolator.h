@@ -0,0 +1,89 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_GEODESIC_INTERPOLATOR_H
+#define SIMDATA_GEODESIC_INTERPOLATOR_H
+
+#include <cstdint>
+#include "simCore/Common/Export.h"
+#include "simData/InterpolatorSegmentCache.h"
+#include "simData/LinearInterpolator.h"
+
+namespace simData
+{
+
+/**
+ * Interpolates platform positions along the geodesic between the bracketing points, moving at a
+ * constant rate over the ellipsoid with the altitude interpolated linearly, so that widely spaced
+ * points follow the great circle route instead of the chord between them.  Orientation is a
+ * spherical interpolation and velocity a linear interpolation, both in the local level frame,
+ * rotated into ECEF at the interpolated position.  Other entity types are interpolated linearly.
+ *
+ * The geodetic conversions and the geodesic's length and azimuth are cached per segment, so
+ * repeated interpolation within a segment only walks the geodesic.  Safe to call from multiple threads.
+ */
+class SDKDATA_EXPORT GeodesicInterpolator : public LinearInterpolator
+{
+public:
+  /** Creates the interpolator, caching up to about cacheSize segments */
+  explicit GeodesicInterpolator(size_t cacheSize = 16384);
+  virtual ~GeodesicInterpolator();
+
+  using LinearInterpolator::interpolate;
+  /** @see Interpolator::interpolate() */
+  bool interpolate(double time, const PlatformUpdate &prev, const PlatformUpdate &next, PlatformUpdate *result) override;
+
+  /** Number of platform interpolations that reused a cached segment */
+  uint64_t cacheHits() const;
+  /** Number of platform interpolations that computed their segment */
+  uint64_t cacheMisses() const;
+
+private:
+  /// Geodesic and local frame values of a segment
+  struct Segment
+  {
+    double lat = 0.0;
+    double lon = 0.0;
+    double alt1 = 0.0;
+    double alt2 = 0.0;
+    /// Forward azimuth from the first point (rad) and length of the geodesic (m)
+    double azimuth = 0.0;
+    double distance = 0.0;
+    bool hasOrientation = false;
+    /// Local orientations of the ends as quaternions
+    double q1[4] = { 1.0, 0.0, 0.0, 0.0 };
+    double q2[4] = { 1.0, 0.0, 0.0, 0.0 };
+    bool hasVelocity = false;
+    /// Local ENU velocities of the ends
+    double v1[3] = { 0.0, 0.0, 0.0 };
+    double v2[3] = { 0.0, 0.0, 0.0 };
+  };
+
+  /** Computes the segment between prev and next */
+  static void makeSegment_(const PlatformUpdate &prev, const PlatformUpdate &next, Segment& segment);
+
+  InterpolatorSegmentCache<Segment> cache_;
+};
+
+}
+
+#endif
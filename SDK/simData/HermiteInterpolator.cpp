@@ -0,0 +1,115 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cassert>
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Interpolation.h"
+#include "simCore/Calc/Math.h"
+#include "simData/HermiteInterpolator.h"
+
+namespace simData {
+
+HermiteInterpolator::HermiteInterpolator()
+{
+}
+
+HermiteInterpolator::~HermiteInterpolator()
+{
+}
+
+bool HermiteInterpolator::interpolate(double time, const PlatformUpdate &prev, const PlatformUpdate &next, PlatformUpdate *result)
+{
+  // Test for same input/output -- this function cannot handle case of prev == result, or next == result
+  if (!result || &prev == result || &next == result)
+  {
+    assert(0);
+    return false;
+  }
+  // time must be within bounds for interpolation to work
+  assert(prev.time() <= time && time <= next.time());
+
+  // Without tangents there is no curve
+  if (!prev.has_velocity() || !next.has_velocity())
+    return LinearInterpolator::interpolate(time, prev, next, result);
+
+  Segment segment;
+  makeSegment_(prev, next, segment);
+
+  const double s = simCore::getFactor(prev.time(), time, next.time());
+  result->set_time(time);
+  result->set_x(segment.a[0] + s * (segment.b[0] + s * (segment.c[0] + s * segment.d[0])));
+  result->set_y(segment.a[1] + s * (segment.b[1] + s * (segment.c[1] + s * segment.d[1])));
+  result->set_z(segment.a[2] + s * (segment.b[2] + s * (segment.c[2] + s * segment.d[2])));
+
+  // Derivative with respect to s, scaled back to time
+  if (segment.duration > 0.0)
+  {
+    result->set_vx((segment.b[0] + s * (2.0 * segment.c[0] + s * 3.0 * segment.d[0])) / segment.duration);
+    result->set_vy((segment.b[1] + s * (2.0 * segment.c[1] + s * 3.0 * segment.d[1])) / segment.duration);
+    result->set_vz((segment.b[2] + s * (2.0 * segment.c[2] + s * 3.0 * segment.d[2])) / segment.duration);
+  }
+  else
+  {
+    result->set_vx(prev.vx());
+    result->set_vy(prev.vy());
+    result->set_vz(prev.vz());
+  }
+
+  if (segment.hasOrientation)
+  {
+    double q[4];
+    simCore::dQSlerp(segment.q1, segment.q2, s, q);
+    simCore::Vec3 ori;
+    simCore::d3QtoEuler(q, ori);
+    result->set_psi(simCore::angFix2PI(ori.psi()));
+    result->set_theta(ori.theta());
+    result->set_phi(ori.phi());
+  }
+
+  return true;
+}
+
+void HermiteInterpolator::makeSegment_(const PlatformUpdate &prev, const PlatformUpdate &next, Segment& segment)
+{
+  // Tangents are the velocities scaled to the segment's duration
+  segment.duration = next.time() - prev.time();
+  const double p0[3] = { prev.x(), prev.y(), prev.z() };
+  const double p1[3] = { next.x(), next.y(), next.z() };
+  const double m0[3] = { prev.vx() * segment.duration, prev.vy() * segment.duration, prev.vz() * segment.duration };
+  const double m1[3] = { next.vx() * segment.duration, next.vy() * segment.duration, next.vz() * segment.duration };
+  for (size_t ii = 0; ii < 3; ++ii)
+  {
+    segment.a[ii] = p0[ii];
+    segment.b[ii] = m0[ii];
+    segment.c[ii] = 3.0 * (p1[ii] - p0[ii]) - 2.0 * m0[ii] - m1[ii];
+    segment.d[ii] = 2.0 * (p0[ii] - p1[ii]) + m0[ii] + m1[ii];
+  }
+
+  segment.hasOrientation = prev.has_orientation() && next.has_orientation();
+  if (segment.hasOrientation)
+  {
+    simCore::d3EulertoQ(simCore::Vec3(prev.psi(), prev.theta(), prev.phi()), segment.q1);
+    simCore::d3EulertoQ(simCore::Vec3(next.psi(), next.theta(), next.phi()), segment.q2);
+  }
+}
+
+}
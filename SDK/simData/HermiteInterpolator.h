@@ -0,0 +1,74 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_HERMITE_INTERPOLATOR_H
+#define SIMDATA_HERMITE_INTERPOLATOR_H
+
+#include <array>
+#include "simCore/Common/Export.h"
+#include "simData/LinearInterpolator.h"
+
+namespace simData
+{
+
+/**
+ * Interpolates platform positions along the cubic Hermite curve through the bracketing points,
+ * using their ECEF velocities as the tangents, so that sparse tracks curve smoothly instead of
+ * turning at each point.  The interpolated velocity is the derivative of the curve, and the
+ * orientation is a spherical interpolation of the ECEF orientations.  Platforms without velocity
+ * on both points fall back to linear interpolation; other entity types are interpolated linearly.
+ *
+ * The curve coefficients are computed on each call; that costs about as much as looking them up
+ * in a shared cache would, without the locking.  Safe to call from multiple threads.
+ */
+class SDKDATA_EXPORT HermiteInterpolator : public LinearInterpolator
+{
+public:
+  HermiteInterpolator();
+  virtual ~HermiteInterpolator();
+
+  using LinearInterpolator::interpolate;
+  /** @see Interpolator::interpolate() */
+  bool interpolate(double time, const PlatformUpdate &prev, const PlatformUpdate &next, PlatformUpdate *result) override;
+
+private:
+  /// Polynomial coefficients of a segment, position = a + b*s + c*s^2 + d*s^3 for s in [0,1]
+  struct Segment
+  {
+    double duration = 0.0;
+    std::array<double, 3> a{};
+    std::array<double, 3> b{};
+    std::array<double, 3> c{};
+    std::array<double, 3> d{};
+    bool hasOrientation = false;
+    /// ECEF orientations of the ends as quaternions
+    double q1[4] = { 1.0, 0.0, 0.0, 0.0 };
+    double q2[4] = { 1.0, 0.0, 0.0, 0.0 };
+  };
+
+  /** Computes the segment between prev and next, which both have velocity */
+  static void makeSegment_(const PlatformUpdate &prev, const PlatformUpdate &next, Segment& segment);
+};
+
+}
+
+#endif
@@ -0,0 +1,165 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_INGESTQUEUE_H
+#define SIMDATA_INGESTQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include "simCore/Common/Common.h"
+#include "simData/ObjectId.h"
+
+namespace simData
+{
+
+/**
+ * Bounded lock-free queue for passing items from any number of producer threads to
+ * consumer threads.  Each slot carries a sequence number that tells producers and
+ * consumers whether the slot is free or filled for their position, so neither side
+ * takes a lock and a full queue fails the push instead of blocking.
+ */
+template <typename T>
+class IngestQueue
+{
+public:
+  /** Creates the queue; capacity is rounded up to a power of two, minimum 2 */
+  explicit IngestQueue(size_t capacity)
+  {
+    size_t rounded = 2;
+    while (rounded < capacity)
+      rounded <<= 1;
+    mask_ = rounded - 1;
+    slots_.reset(new Slot[rounded]);
+    for (size_t ii = 0; ii < rounded; ++ii)
+      slots_[ii].sequence.store(ii, std::memory_order_relaxed);
+  }
+
+  SDK_DISABLE_COPY_MOVE(IngestQueue);
+
+  /// Maximum number of items in the queue
+  size_t capacity() const
+  {
+    return mask_ + 1;
+  }
+
+  /// Approximate number of items in the queue; exact only when no thread is pushing or popping
+  size_t size() const
+  {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t head = head_.load(std::memory_order_relaxed);
+    return (tail > head) ? (tail - head) : 0;
+  }
+
+  /** Adds the item to the queue; returns 0 on success, non-zero if the queue is full. Thread safe. */
+  int push(T&& item)
+  {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    while (true)
+    {
+      slot = &slots_[pos & mask_];
+      // Signed difference handles wrap around of the positions
+      const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(slot->sequence.load(std::memory_order_acquire) - pos);
+      if (diff == 0)
+      {
+        // Slot is free for this position; claim it
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+        return 1;
+      else
+        pos = tail_.load(std::memory_order_relaxed);
+    }
+
+    slot->item = std::move(item);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return 0;
+  }
+
+  /** Adds a copy of the item to the queue; returns 0 on success, non-zero if the queue is full. Thread safe. */
+  int push(const T& item)
+  {
+    T copy(item);
+    return push(std::move(copy));
+  }
+
+  /** Removes the oldest item from the queue; returns 0 on success, non-zero if the queue is empty. Thread safe. */
+  int pop(T& item)
+  {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    while (true)
+    {
+      slot = &slots_[pos & mask_];
+      const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(slot->sequence.load(std::memory_order_acquire) - (pos + 1));
+      if (diff == 0)
+      {
+        // Slot is filled for this position; claim it
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+        return 1;
+      else
+        pos = head_.load(std::memory_order_relaxed);
+    }
+
+    item = std::move(slot->item);
+    // Free the slot for the producer one lap ahead
+    slot->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return 0;
+  }
+
+private:
+  /// Cache line size used to keep the producer and consumer positions apart
+  static constexpr size_t CACHE_LINE_SIZE = 64;
+
+  struct Slot
+  {
+    std::atomic<size_t> sequence;
+    T item;
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_ = 0;
+  /// Next position to push; kept on its own cache line to avoid false sharing with head_
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_ = 0;
+  /// Next position to pop
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_ = 0;
+};
+
+/// An item queued for an entity, such as a PlatformUpdate for a platform
+template <typename T>
+struct IngestRecord
+{
+  /// Entity that receives the item
+  ObjectId id = 0;
+  /// Queued item
+  T data;
+};
+
+}
+
+#endif /* SIMDATA_INGESTQUEUE_H */
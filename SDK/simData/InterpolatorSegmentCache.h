@@ -0,0 +1,134 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_INTERPOLATORSEGMENTCACHE_H
+#define SIMDATA_INTERPOLATORSEGMENTCACHE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "simData/DataTypes.h"
+
+namespace simData
+{
+
+/**
+ * Fixed size cache of the per segment values an interpolator computes from a pair of bracketing
+ * platform updates, so that interpolating again between the same pair skips that work.  Entries
+ * are keyed by the values of the updates rather than their addresses, since slices may hand out
+ * short-lived copies.  Each key maps to one slot, replacing whatever the slot held.  Safe to use
+ * from multiple threads.
+ */
+template <typename Segment>
+class InterpolatorSegmentCache
+{
+public:
+  /// Values of a pair of updates: time, position, orientation and velocity of each, and which are set
+  typedef std::array<double, 21> Key;
+
+  /** Creates a cache with at least the given number of slots, rounded up to a power of 2 */
+  explicit InterpolatorSegmentCache(size_t numSlots)
+  {
+    size_t size = 1;
+    while (size < numSlots)
+      size <<= 1;
+    slots_.resize(size);
+  }
+
+  /** Fills in the key for the segment between prev and next */
+  static void makeKey(const PlatformUpdate& prev, const PlatformUpdate& next, Key& key)
+  {
+    key = { prev.time(), prev.x(), prev.y(), prev.z(), prev.psi(), prev.theta(), prev.phi(), prev.vx(), prev.vy(), prev.vz(),
+      next.time(), next.x(), next.y(), next.z(), next.psi(), next.theta(), next.phi(), next.vx(), next.vy(), next.vz(),
+      static_cast<double>((prev.has_orientation() ? 1 : 0) + (prev.has_velocity() ? 2 : 0) + (next.has_orientation() ? 4 : 0) + (next.has_velocity() ? 8 : 0)) };
+  }
+
+  /** Copies the segment for the key; returns false if it is not cached */
+  bool find(const Key& key, Segment& segment) const
+  {
+    const Slot& slot = slots_[slotIndex_(key)];
+    std::lock_guard<std::mutex> lock(locks_[lockIndex_(slot)]);
+    if (!slot.valid || slot.key != key)
+    {
+      ++misses_;
+      return false;
+    }
+    segment = slot.segment;
+    ++hits_;
+    return true;
+  }
+
+  /** Stores the segment for the key */
+  void insert(const Key& key, const Segment& segment)
+  {
+    Slot& slot = slots_[slotIndex_(key)];
+    std::lock_guard<std::mutex> lock(locks_[lockIndex_(slot)]);
+    slot.key = key;
+    slot.segment = segment;
+    slot.valid = true;
+  }
+
+  /** Number of find() calls that found their segment */
+  uint64_t hits() const { return hits_; }
+  /** Number of find() calls that did not find their segment */
+  uint64_t misses() const { return misses_; }
+
+private:
+  struct Slot
+  {
+    Key key{};
+    Segment segment{};
+    bool valid = false;
+  };
+
+  /// Number of locks guarding the slots; a slot's lock is chosen by its position
+  static constexpr size_t NUM_LOCKS = 64;
+
+  size_t slotIndex_(const Key& key) const
+  {
+    uint64_t hash = 14695981039346656037ull;
+    for (double value : key)
+    {
+      uint64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      hash = (hash ^ bits) * 1099511628211ull;
+    }
+    return static_cast<size_t>(hash ^ (hash >> 32)) & (slots_.size() - 1);
+  }
+
+  size_t lockIndex_(const Slot& slot) const
+  {
+    return static_cast<size_t>(&slot - slots_.data()) % NUM_LOCKS;
+  }
+
+  std::vector<Slot> slots_;
+  mutable std::array<std::mutex, NUM_LOCKS> locks_;
+  mutable std::atomic<uint64_t> hits_ = 0;
+  mutable std::atomic<uint64_t> misses_ = 0;
+};
+
+}
+
+#endif /* SIMDATA_INTERPOLATORSEGMENTCACHE_H */
@@ -159,6 +159,20 @@ void LobGroupMemoryDataSlice::insert(LobGroupUpdate *data)
   dirty_ = true;
 }
 
+void LobGroupMemoryDataSlice::insertBatch(std::span<LobGroupUpdate*> updates)
+{
+  for (LobGroupUpdate* update : updates)
+    insert(update);
+}
+
+size_t LobGroupMemoryDataSlice::memoryUsage() const
+{
+  size_t rv = MemoryDataSlice<LobGroupUpdate>::memoryUsage();
+  for (const LobGroupUpdate* update : updates_)
+    rv += update->datapoints().capacity() * sizeof(LobGroupUpdatePoint);
+  return rv;
+}
+
 
 void LobGroupMemoryDataSlice::setMaxDataPoints(size_t maxDataPoints)
 {
@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <vector>
 #include "simData/DataStore.h"
 #include "simData/DataTypeReflection.h"
 
@@ -535,6 +536,66 @@ void MemoryDataSlice<T>::insert(T *data)
   dirty_ = true;
 }
 
+template<typename T>
+void MemoryDataSlice<T>::insertBatch(std::span<T*> updates)
+{
+  if (updates.empty())
+    return;
+
+  if (notifierFn_)
+    notifierFn_();
+
+  // Stable sort keeps the batch order of equal times, so the last one wins
+  if (!std::is_sorted(updates.begin(), updates.end(), UpdateComp<T>()))
+    std::stable_sort(updates.begin(), updates.end(), UpdateComp<T>());
+
+  // Adds the batch update unless a later batch update has the same time
+  size_t next = 0;
+  auto appendNext = [this, &updates, &next]()
+  {
+    T* update = updates[next++];
+    if ((next < updates.size()) && (updates[next]->time() == update->time()))
+      delete update;
+    else
+      updates_.push_back(update);
+  };
+
+  if (updates_.empty() || (updates_.back()->time() < updates.front()->time()))
+  {
+    while (next < updates.size())
+      appendNext();
+  }
+  else
+  {
+    // Pull off the existing updates that overlap the batch, then merge them back with the batch
+    const auto first = std::lower_bound(updates_.begin(), updates_.end(), updates.front(), UpdateComp<T>());
+    const std::vector<T*> existing(first, updates_.end());
+    updates_.erase(first, updates_.end());
+
+    for (T* update : existing)
+    {
+      while ((next < updates.size()) && (updates[next]->time() < update->time()))
+        appendNext();
+
+      if ((next < updates.size()) && (updates[next]->time() == update->time()))
+      {
+        // null the current ptr, if we are replacing the update it aliases; current will become valid upon update
+        if (current_ == update)
+          setCurrent(nullptr);
+        delete update;
+      }
+      else
+        updates_.push_back(update);
+    }
+
+    while (next < updates.size())
+      appendNext();
+  }
+
+  fastUpdate_.invalidate();
+  dirty_ = true;
+}
+
 template<typename T>
 void MemoryDataSlice<T>::limitByTime(double timeWindow)
 {
@@ -567,6 +628,12 @@ void MemoryDataSlice<T>::limitByPrefs(const CommonPrefs &prefs)
   limitByTime(prefs.datalimittime());
 }
 
+template<typename T>
+size_t MemoryDataSlice<T>::memoryUsage() const
+{
+  return updates_.size() * (sizeof(T) + sizeof(T*));
+}
+
 template<typename T>
 double MemoryDataSlice<T>::firstTime() const
 {
@@ -945,6 +1012,12 @@ void MemoryCommandSlice<CommandType, PrefType>::limitByPrefs(const CommonPrefs &
   limitByTime(prefs.datalimittime());
 }
 
+template<class CommandType, class PrefType>
+size_t MemoryCommandSlice<CommandType, PrefType>::memoryUsage() const
+{
+  return updates_.size() * (sizeof(CommandType) + sizeof(CommandType*));
+}
+
 template<class CommandType, class PrefType>
 typename DataSlice<CommandType>::Iterator MemoryCommandSlice<CommandType, PrefType>::lower_bound(double timeValue) const
 {
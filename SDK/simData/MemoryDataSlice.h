@@ -25,6 +25,7 @@
 
 #include <deque>
 #include <optional>
+#include <span>
 #include "simData/DataTypes.h"
 #include "simData/DataSlice.h"
 #include "simData/DataSliceUpdaters.h"
@@ -239,7 +240,7 @@ public:
    * @param endTime The end time of the time range that has the same current_ as time
    * @return true if the slice's current_changes
   */
-  void update(double time, std::optional<double>& startTime, std::optional<double>& endTime);
+  virtual void update(double time, std::optional<double>& startTime, std::optional<double>& endTime);
 
   /// A function that is called every time the slice is modified
   void installNotifier(const std::function<void()>& fn);
@@ -258,17 +259,29 @@ public:
    */
   virtual void insert(T *data);
 
+  /**
+   * Inserts a batch of updates, taking ownership of them.  The batch is sorted by time if
+   * needed, then appended if it starts after the last update, or otherwise merged into the
+   * existing updates in a single pass.  As with insert(), an update replaces an existing
+   * update with the same time, and the last of several batch updates with the same time wins.
+   * @param updates Updates to insert; the span is reordered
+   */
+  virtual void insertBatch(std::span<T*> updates);
+
   /// reduce the data store to only have points within the given 'timeWindow'
   /// @param timeWindow amount of time to keep in window (negative for no limit)
-  void limitByTime(double timeWindow);
+  virtual void limitByTime(double timeWindow);
 
   /// reduce the data store to only have 'limitPoints' points
   /// @param limitPoints number of points to keep (0 is no limit)
-  void limitByPoints(uint32_t limitPoints);
+  virtual void limitByPoints(uint32_t limitPoints);
 
   /** Performs both point and time limiting based on the settings in prefs */
   virtual void limitByPrefs(const CommonPrefs &prefs);
 
+  /** Estimated number of bytes used by the updates, from their count and size */
+  virtual size_t memoryUsage() const;
+
   /** Retrieves the earliest time stored in this slice */
   double firstTime() const override;
 
@@ -403,6 +416,9 @@ public:
   /** Performs both point and time limiting based on the settings in prefs */
   virtual void limitByPrefs(const CommonPrefs &prefs);
 
+  /** Estimated number of bytes used by the commands, from their count and size */
+  size_t memoryUsage() const;
+
   /**
    * Returns the first iterator at or after the time value
    * @param timeValue
@@ -576,6 +592,12 @@ public:
   */
   void insert(LobGroupUpdate *data) override;
 
+  /** Inserts each update with insert() so that the points of updates with the same time are merged */
+  void insertBatch(std::span<LobGroupUpdate*> updates) override;
+
+  /** Adds the bytes of the data points of each update */
+  size_t memoryUsage() const override;
+
   /// remove all data in the slice
   void flush(bool keepStatic = true) override;
 
@@ -22,10 +22,13 @@
  */
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <float.h>
 #include <functional>
 #include <limits>
 #include <optional>
+#include <unordered_map>
+#include <unordered_set>
 #ifdef HAVE_ENTT
 #include "entt/container/dense_map.hpp"
 #endif
@@ -36,6 +39,7 @@
 #include "simCore/Calc/Interpolation.h"
 #include "simCore/Calc/MultiFrameCoordinate.h"
 #include "simCore/Common/Common.h"
+#include "simCore/System/ParallelRanges.h"
 #include "simCore/Time/Clock.h"
 #include "simData/MemoryDataStore.h"
 #include "simData/DataEntry.h"
@@ -45,14 +49,20 @@
 #include "simData/EntityNameCache.h"
 #include "simData/CategoryData/MemoryCategoryDataSlice.h"
 #include "simData/CategoryData/CategoryNameManager.h"
+#include "simData/CategoryData/CategoryValueIndex.h"
 #include "simData/MemoryTable/DataLimitsProvider.h"
 #include "simData/MemoryTable/TableManager.h"
+#include "simData/PlatformInterpolationBatch.h"
+#include "simData/SpillFile.h"
+#include "simData/StringArena.h"
 
 namespace simData
 {
 
-/// If there are more than USE_THREAD_FOR_GENERIC_DATA entities, then use a worker thread for the update
-constexpr size_t USE_THREAD_FOR_GENERIC_DATA = 1000;
+/// Default minimum number of entities of a type needed to update that type in parallel
+constexpr size_t DEFAULT_PARALLEL_UPDATE_THRESHOLD = 1000;
+/// Default capacity of each ingest queue, enough for over a million records per second at 20 updates per second
+constexpr size_t DEFAULT_INGEST_QUEUE_CAPACITY = 65536;
 
 //----------------------------------------------------------------------------
 // Functions local to compilation unit, for implementation of common operations
@@ -213,10 +223,578 @@ private:
   simData::DataStore& dataStore_;
 };
 
+/**
+ * Tracks the time range over which the cached slice state of each entity stays the same, so
+ * that an update only visits the entities whose range does not contain the new time.  Ranges
+ * are held in a min-heap on end time and a max-heap on start time, so both forward and backward
+ * time changes find the expired entities without looking at the others.
+ *
+ * Each entity is either pending (visited on the next collect()), ranged, or being visited.
+ * The ids returned by collect() are being visited; the caller must give each one a new range
+ * with setRange() or make it pending again with invalidate().
+ */
+class TimeRangeIndex
+{
+public:
+  /** Entity needs a visit on the next collect() */
+  void invalidate(ObjectId id)
+  {
+    Range& range = ranges_[id];
+    range.ranged = false;
+    ++range.generation;
+    if (!range.pending)
+    {
+      range.pending = true;
+      pending_.push_back(id);
+    }
+  }
+
+  /** Entity does not need a visit while startTime <= time < endTime; ignored if the entity is pending */
+  void setRange(ObjectId id, double startTime, double endTime)
+  {
+    auto it = ranges_.find(id);
+    if ((it == ranges_.end()) || it->second.pending)
+      return;
+
+    Range& range = it->second;
+    range.startTime = startTime;
+    range.endTime = endTime;
+    range.ranged = true;
+    ++range.generation;
+    pushEntry_(endHeap_, HeapEntry{ endTime, id, range.generation }, EndCompare());
+    pushEntry_(startHeap_, HeapEntry{ startTime, id, range.generation }, StartCompare());
+
+    // Superseded heap entries are only dropped when they reach the top, so occasionally rebuild
+    if (endHeap_.size() > 2 * ranges_.size() + MIN_COMPACT_SIZE)
+      compact_();
+  }
+
+  /** Forgets the entity */
+  void remove(ObjectId id)
+  {
+    ranges_.erase(id);
+  }
+
+  /** Forgets all entities */
+  void clear()
+  {
+    ranges_.clear();
+    pending_.clear();
+    endHeap_.clear();
+    startHeap_.clear();
+  }
+
+  /** Returns the sorted ids of the pending entities and of the entities whose range does not contain time */
+  void collect(double time, std::vector<ObjectId>& ids)
+  {
+    ids.clear();
+    for (ObjectId id : pending_)
+    {
+      auto it = ranges_.find(id);
+      if ((it != ranges_.end()) && it->second.pending)
+      {
+        it->second.pending = false;
+        ids.push_back(id);
+      }
+    }
+    pending_.clear();
+
+    while (!endHeap_.empty() && (endHeap_.front().time <= time))
+    {
+      expire_(endHeap_.front(), ids);
+      std::pop_heap(endHeap_.begin(), endHeap_.end(), EndCompare());
+      endHeap_.pop_back();
+    }
+
+    while (!startHeap_.empty() && (startHeap_.front().time > time))
+    {
+      expire_(startHeap_.front(), ids);
+      std::pop_heap(startHeap_.begin(), startHeap_.end(), StartCompare());
+      startHeap_.pop_back();
+    }
+
+    // Visit in ID order, the same as iterating the cache maps
+    std::sort(ids.begin(), ids.end());
+  }
+
+private:
+  /// Heaps smaller than this are not compacted
+  static constexpr size_t MIN_COMPACT_SIZE = 1024;
+
+  struct Range
+  {
+    double startTime = 0.0;
+    double endTime = 0.0;
+    /// Incremented on each change so that superseded heap entries can be recognized
+    uint64_t generation = 0;
+    bool ranged = false;
+    bool pending = false;
+  };
+
+  struct HeapEntry
+  {
+    double time;
+    ObjectId id;
+    uint64_t generation;
+  };
+
+  /// Orders the heap with the earliest end time at the top
+  struct EndCompare
+  {
+    bool operator()(const HeapEntry& lhs, const HeapEntry& rhs) const { return lhs.time > rhs.time; }
+  };
+
+  /// Orders the heap with the latest start time at the top
+  struct StartCompare
+  {
+    bool operator()(const HeapEntry& lhs, const HeapEntry& rhs) const { return lhs.time < rhs.time; }
+  };
+
+  template <typename Compare>
+  static void pushEntry_(std::vector<HeapEntry>& heap, const HeapEntry& entry, Compare compare)
+  {
+    heap.push_back(entry);
+    std::push_heap(heap.begin(), heap.end(), compare);
+  }
+
+  /** Moves the entity of the heap entry into ids if the entry is current */
+  void expire_(const HeapEntry& entry, std::vector<ObjectId>& ids)
+  {
+    auto it = ranges_.find(entry.id);
+    if ((it == ranges_.end()) || !it->second.ranged || (it->second.generation != entry.generation))
+      return;
+
+    it->second.ranged = false;
+    ++it->second.generation;
+    ids.push_back(entry.id);
+  }
+
+  /** Rebuilds the heaps from the current ranges */
+  void compact_()
+  {
+    endHeap_.clear();
+    startHeap_.clear();
+    for (const auto& [id, range] : ranges_)
+    {
+      if (!range.ranged)
+        continue;
+      endHeap_.push_back(HeapEntry{ range.endTime, id, range.generation });
+      startHeap_.push_back(HeapEntry{ range.startTime, id, range.generation });
+    }
+    std::make_heap(endHeap_.begin(), endHeap_.end(), EndCompare());
+    std::make_heap(startHeap_.begin(), startHeap_.end(), StartCompare());
+  }
+
+  std::unordered_map<ObjectId, Range> ranges_;
+  std::vector<ObjectId> pending_;
+  std::vector<HeapEntry> endHeap_;
+  std::vector<HeapEntry> startHeap_;
+};
+
+/**
+ * Pops the records in the queue at the time of the call, sorted by entity and then time.
+ * Records for the same entity and time stay in queue order, so the last one wins on insert.
+ */
+template <typename RecordType>
+void popIngestRecords(IngestQueue<RecordType>& queue, std::vector<RecordType>& records)
+{
+  // Limit to the current size so that busy producers cannot keep the drain going
+  const size_t count = queue.size();
+  records.resize(count);
+  size_t popped = 0;
+  while ((popped < count) && (queue.pop(records[popped]) == 0))
+    ++popped;
+  records.resize(popped);
+
+  std::stable_sort(records.begin(), records.end(), [](const RecordType& lhs, const RecordType& rhs)
+  {
+    if (lhs.id != rhs.id)
+      return lhs.id < rhs.id;
+    return lhs.data.time() < rhs.data.time();
+  });
+}
+
+/// Returns the slice that receives the ingest records of an entity
+template <typename EntryType>
+auto ingestSlice(EntryType* entry)
+{
+  return entry->updates();
+}
+
+/// Category data is stored directly in the slice map
+MemoryCategoryDataSlice* ingestSlice(MemoryCategoryDataSlice* slice)
+{
+  return slice;
+}
+
+/// Generic data is stored directly in the slice map
+MemoryGenericDataSlice* ingestSlice(MemoryGenericDataSlice* slice)
+{
+  return slice;
+}
+
+/// Inserts copies of the updates into the slice with a single batch insert
+template <typename T>
+void insertUpdateBatch(MemoryDataSlice<T>* slice, std::span<const T> updates)
+{
+  std::vector<T*> copies;
+  copies.reserve(updates.size());
+  for (const auto& update : updates)
+    copies.push_back(new T(update));
+  slice->insertBatch(copies);
+}
+
+/// Platform slices copy the updates straight into columnar storage
+void insertUpdateBatch(PlatformMemoryDataSlice* slice, std::span<const PlatformUpdate> updates)
+{
+  slice->insertBatch(updates);
+}
+
+/// Inserts a run of ingest records, sorted by time, into an entity update slice as one batch
+template <typename SliceType, typename RecordIterator>
+void insertRecords(SliceType* slice, RecordIterator first, RecordIterator last, bool ignoreDuplicates)
+{
+  typedef std::decay_t<decltype(first->data)> UpdateType;
+  std::vector<UpdateType> batch;
+  batch.reserve(std::distance(first, last));
+  for (; first != last; ++first)
+    batch.push_back(std::move(first->data));
+  insertUpdateBatch(slice, std::span<const UpdateType>(batch));
+}
+
+/// Category data slices insert one record at a time
+template <typename RecordIterator>
+void insertRecords(MemoryCategoryDataSlice* slice, RecordIterator first, RecordIterator last, bool ignoreDuplicates)
+{
+  for (; first != last; ++first)
+    slice->insert(new CategoryData(std::move(first->data)));
+}
+
+/// Generic data slices insert one record at a time and can ignore duplicate values
+template <typename RecordIterator>
+void insertRecords(MemoryGenericDataSlice* slice, RecordIterator first, RecordIterator last, bool ignoreDuplicates)
+{
+  for (; first != last; ++first)
+    slice->insert(new GenericData(std::move(first->data)), ignoreDuplicates);
+}
+
+/// Estimated bytes of one value of a data table column
+size_t variableTypeSize(VariableType type)
+{
+  switch (type)
+  {
+  case VT_UINT8:
+  case VT_INT8:
+    return 1;
+  case VT_UINT16:
+  case VT_INT16:
+    return 2;
+  case VT_UINT32:
+  case VT_INT32:
+  case VT_FLOAT:
+    return 4;
+  case VT_UINT64:
+  case VT_INT64:
+  case VT_DOUBLE:
+    return 8;
+  case VT_STRING:
+    return sizeof(std::string);
+  }
+  return sizeof(double);
+}
+
+/// Totals the estimated bytes, the number of rows and the oldest time of a data table
+class TableSizer : public DataTable::ColumnVisitor
+{
+public:
+  void visit(TableColumn* column) override
+  {
+    valueBytes += column->size() * variableTypeSize(column->variableType());
+    rows = std::max(rows, column->size());
+    double begin = 0.0;
+    double end = 0.0;
+    if (!column->empty() && (column->getTimeRange(begin, end) == 0))
+      firstTime = std::min(firstTime, begin);
+  }
+
+  /// Column values plus one time stamp and index per row, since the columns share their times
+  size_t bytes() const
+  {
+    return valueBytes + rows * (sizeof(double) + sizeof(size_t));
+  }
+
+  size_t valueBytes = 0;
+  size_t rows = 0;
+  double firstTime = std::numeric_limits<double>::max();
+};
+
+/// Sums the estimated bytes of the tables in a list
+class TableListSizer : public TableList::Visitor
+{
+public:
+  void visit(DataTable* table) override
+  {
+    TableSizer sizer;
+    table->accept(sizer);
+    bytes += sizer.bytes();
+  }
+
+  size_t bytes = 0;
+};
+
+/// Estimated bytes of all the tables of an owner
+size_t tableMemoryUsage(const DataTableManager& manager, ObjectId ownerId)
+{
+  const TableList* tables = manager.tablesForOwner(ownerId);
+  if (tables == nullptr)
+    return 0;
+  TableListSizer sizer;
+  tables->accept(sizer);
+  return sizer.bytes;
+}
+
+/// Estimated bytes of the update and command slices of an entity
+template <typename EntryMapType>
+void entryMemoryUsage(const EntryMapType& entries, ObjectId id, MemoryDataStore::MemoryUsage& usage)
+{
+  auto iter = entries.find(id);
+  if (iter == entries.end())
+    return;
+  usage.updates = iter->second->updates()->memoryUsage();
+  usage.commands = iter->second->commands()->memoryUsage();
+}
+
+/// Update slice or data table whose oldest points can be removed to meet the memory budget
+class EvictionCandidate
+{
+public:
+  explicit EvictionCandidate(ObjectId owner)
+    : owner_(owner)
+  {
+  }
+  virtual ~EvictionCandidate() = default;
+  /// Entity that holds the data, or 0 for the scenario
+  ObjectId owner() const
+  {
+    return owner_;
+  }
+  /// Time of the oldest point
+  virtual double firstTime() const = 0;
+  /// Number of points
+  virtual size_t numPoints() const = 0;
+  /// Estimated bytes
+  virtual size_t bytes() const = 0;
+  /// Removes up to maxPoints of the oldest points at or before throughTime, always keeping the last; returns the number removed
+  virtual size_t evict(size_t maxPoints, double throughTime) = 0;
+
+private:
+  ObjectId owner_;
+};
+
+/// Removes the oldest points of an update slice
+template <typename SliceType>
+class SliceEviction : public EvictionCandidate
+{
+public:
+  SliceEviction(ObjectId owner, SliceType* slice)
+    : EvictionCandidate(owner),
+      slice_(slice)
+  {
+  }
+
+  double firstTime() const override
+  {
+    return slice_->firstTime();
+  }
+
+  size_t numPoints() const override
+  {
+    return slice_->numItems();
+  }
+
+  size_t bytes() const override
+  {
+    return slice_->memoryUsage();
+  }
+
+  size_t evict(size_t maxPoints, double throughTime) override
+  {
+    const size_t points = slice_->numItems();
+    if (points < 2)
+      return 0;
+    const size_t limit = std::min(maxPoints, points - 1);
+    size_t count = 0;
+    auto iter = slice_->lower_bound(-std::numeric_limits<double>::max());
+    while ((count < limit) && iter.hasNext() && (iter.peekNext()->time() <= throughTime))
+    {
+      iter.next();
+      ++count;
+    }
+    if (count != 0)
+      slice_->limitByPoints(static_cast<uint32_t>(points - count));
+    return count;
+  }
+
+private:
+  SliceType* slice_;
+};
+
+/// Removes the oldest rows of a data table
+class TableEviction : public EvictionCandidate
+{
+public:
+  TableEviction(ObjectId owner, DataTable* table)
+    : EvictionCandidate(owner),
+      table_(table)
+  {
+  }
+
+  double firstTime() const override
+  {
+    return size_().firstTime;
+  }
+
+  size_t numPoints() const override
+  {
+    return size_().rows;
+  }
+
+  size_t bytes() const override
+  {
+    return size_().bytes();
+  }
+
+  size_t evict(size_t maxPoints, double throughTime) override
+  {
+    OldestRows oldest(maxPoints, throughTime);
+    table_->accept(-std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), oldest);
+    // The row that stopped the visit is kept, so the last row is never removed
+    if ((oldest.count == 0) || !oldest.keptTime.has_value())
+      return 0;
+    table_->flush(-std::numeric_limits<double>::max(), *oldest.keptTime);
+    return oldest.count;
+  }
+
+private:
+  /// Counts the rows to remove and finds the time of the first row kept
+  class OldestRows : public DataTable::RowVisitor
+  {
+  public:
+    OldestRows(size_t maxRows, double throughTime)
+      : maxRows_(maxRows),
+        throughTime_(throughTime)
+    {
+    }
+
+    VisitReturn visit(const TableRow& row) override
+    {
+      if ((count == maxRows_) || (row.time() > throughTime_))
+      {
+        keptTime = row.time();
+        return VISIT_STOP;
+      }
+      ++count;
+      return VISIT_CONTINUE;
+    }
+
+    size_t count = 0;
+    std::optional<double> keptTime;
+
+  private:
+    size_t maxRows_;
+    double throughTime_;
+  };
+
+  TableSizer size_() const
+  {
+    TableSizer sizer;
+    table_->accept(sizer);
+    return sizer;
+  }
+
+  DataTable* table_;
+};
+
+/// Returns true if the slice moves its old history to disk instead of holding it in memory
+template <typename SliceType>
+bool spillsHistory(const SliceType* slice)
+{
+  return false;
+}
+
+/// Returns true if the slice moves its old history to disk instead of holding it in memory
+bool spillsHistory(const PlatformMemoryDataSlice* slice)
+{
+  return slice->spillWindow() > 0.0;
+}
+
+/**
+ * Adds the update slices that have more than one point and keep all their history in memory.  A slice
+ * that spills keeps only its spill window in memory; removing its oldest points would drop spilled
+ * history, freeing disk rather than memory, so it is left for the spill window to bound.
+ */
+template <typename EntryMapType>
+void addSliceEvictions(const EntryMapType& entries, std::vector<std::unique_ptr<EvictionCandidate> >& candidates)
+{
+  for (const auto& idEntry : entries)
+  {
+    auto* slice = idEntry.second->updates();
+    if ((slice->numItems() > 1) && !spillsHistory(slice))
+      candidates.push_back(std::make_unique<SliceEviction<std::remove_pointer_t<decltype(slice)> > >(idEntry.first, slice));
+  }
+}
+
+/// Adds the tables of an owner's list that have more than one row
+class TableEvictionCollector : public TableList::Visitor
+{
+public:
+  TableEvictionCollector(ObjectId owner, std::vector<std::unique_ptr<EvictionCandidate> >& candidates)
+    : owner_(owner),
+      candidates_(candidates)
+  {
+  }
+
+  void visit(DataTable* table) override
+  {
+    auto candidate = std::make_unique<TableEviction>(owner_, table);
+    if (candidate->numPoints() > 1)
+      candidates_.push_back(std::move(candidate));
+  }
+
+private:
+  ObjectId owner_;
+  std::vector<std::unique_ptr<EvictionCandidate> >& candidates_;
+};
+
 } // End of anonymous namespace
 
 //----------------------------------------------------------------------------
 
+template <typename EntryMapType, typename Function>
+void MemoryDataStore::forEachEntry_(EntryMapType& entries, const Function& fn)
+{
+  if (!useUpdatePool_(entries.size()))
+  {
+    for (auto&& idEntry : entries)
+      fn(idEntry.first, idEntry.second);
+    return;
+  }
+
+  // Map iterators are not random access, so gather pointers to the entries for the pool
+  std::vector<std::pair<ObjectId, std::remove_reference_t<decltype(entries.begin()->second)>*> > items;
+  items.reserve(entries.size());
+  for (auto&& idEntry : entries)
+    items.push_back(std::make_pair(idEntry.first, &idEntry.second));
+
+  simCore::runRanges(items.size(), updateThreadCount_, [&items, &fn](size_t begin, size_t end)
+  {
+    for (size_t ii = begin; ii < end; ++ii)
+      fn(items[ii].first, *items[ii].second);
+  });
+}
+
+//----------------------------------------------------------------------------
+
 /** Look for transitions from Live mode to File mode to force an update to hide expired platforms */
 class MemoryDataStore::ClockModeMonitor : public simCore::Clock::ModeChangeObserver
 {
@@ -491,7 +1069,7 @@ public:
       return;
     }
 
-    categoryCache_[newId] = CategoryCache(categoryIt->second);
+    categoryCache_[newId] = CategoryCache(categoryIt->second, newId, &categoryIndex_);
 
     auto genericIt = mds_.genericData_.find(newId);
     if (genericIt == mds_.genericData_.end())
@@ -512,8 +1090,8 @@ public:
         assert(false);
         return;
       }
-      platformCache_[newId] = PlatformCache(it->second);
-      platformCommandCache_[newId] = CommandCache(it->second->commands(), newId);
+      platformCache_[newId] = PlatformCache(it->second, newId, &platformIndex_);
+      platformCommandCache_[newId] = CommandCache(it->second->commands(), newId, &platformCommandIndex_);
     }
     else if (ot == simData::CUSTOM_RENDERING)
     {
@@ -524,7 +1102,7 @@ public:
         assert(false);
         return;
       }
-      customRenderingCommandCache_[newId] = CommandCache(it->second->commands(), newId);
+      customRenderingCommandCache_[newId] = CommandCache(it->second->commands(), newId, &customRenderingCommandIndex_);
     }
     else if (ot == simData::BEAM)
     {
@@ -535,7 +1113,7 @@ public:
         assert(false);
         return;
       }
-      beamCommandCache_[newId] = CommandCache<MemoryCommandSlice<BeamCommand, BeamPrefs>>(it->second->commands(), newId);
+      beamCommandCache_[newId] = CommandCache<MemoryCommandSlice<BeamCommand, BeamPrefs>>(it->second->commands(), newId, &beamCommandIndex_);
     }
     else if (ot == simData::GATE)
     {
@@ -546,7 +1124,7 @@ public:
         assert(false);
         return;
       }
-      gateCommandCache_[newId] = CommandCache<MemoryCommandSlice<GateCommand, GatePrefs>>(it->second->commands(), newId);
+      gateCommandCache_[newId] = CommandCache<MemoryCommandSlice<GateCommand, GatePrefs>>(it->second->commands(), newId, &gateCommandIndex_);
     }
     else if (ot == simData::LASER)
     {
@@ -557,7 +1135,7 @@ public:
         assert(false);
         return;
       }
-      laserCommandCache_[newId] = CommandCache<MemoryCommandSlice<LaserCommand, LaserPrefs>>(it->second->commands(), newId);
+      laserCommandCache_[newId] = CommandCache<MemoryCommandSlice<LaserCommand, LaserPrefs>>(it->second->commands(), newId, &laserCommandIndex_);
     }
     else if (ot == simData::LOB_GROUP)
     {
@@ -568,7 +1146,7 @@ public:
         assert(false);
         return;
       }
-      lobCommandCache_[newId] = CommandCache<MemoryCommandSlice<LobGroupCommand, LobGroupPrefs>>(it->second->commands(), newId);
+      lobCommandCache_[newId] = CommandCache<MemoryCommandSlice<LobGroupCommand, LobGroupPrefs>>(it->second->commands(), newId, &lobCommandIndex_);
     }
     else if (ot == simData::PROJECTOR)
     {
@@ -579,36 +1157,59 @@ public:
         assert(false);
         return;
       }
-      projectorCommandCache_[newId] = CommandCache<MemoryCommandSlice<ProjectorCommand, ProjectorPrefs>>(it->second->commands(), newId);
+      projectorCommandCache_[newId] = CommandCache<MemoryCommandSlice<ProjectorCommand, ProjectorPrefs>>(it->second->commands(), newId, &projectorCommandIndex_);
     }
   }
 
   void onRemoveEntity(DataStore* source, ObjectId removedId, simData::ObjectType ot) override
   {
     categoryCache_.erase(removedId);
+    categoryIndex_.remove(removedId);
+    if (categoryValueIndex_)
+      categoryValueIndex_->remove(removedId);
     if (platformCache_.erase(removedId) == 1)
     {
+      platformIndex_.remove(removedId);
       platformCommandCache_.erase(removedId);
+      platformCommandIndex_.remove(removedId);
       return;
     }
 
     if (customRenderingCommandCache_.erase(removedId) == 1)
+    {
+      customRenderingCommandIndex_.remove(removedId);
       return;
+    }
 
     if (beamCommandCache_.erase(removedId) == 1)
+    {
+      beamCommandIndex_.remove(removedId);
       return;
+    }
 
     if (gateCommandCache_.erase(removedId) == 1)
+    {
+      gateCommandIndex_.remove(removedId);
       return;
+    }
 
     if (laserCommandCache_.erase(removedId) == 1)
+    {
+      laserCommandIndex_.remove(removedId);
       return;
+    }
 
     if (lobCommandCache_.erase(removedId) == 1)
+    {
+      lobCommandIndex_.remove(removedId);
       return;
+    }
 
     if (projectorCommandCache_.erase(removedId) == 1)
+    {
+      projectorCommandIndex_.remove(removedId);
       return;
+    }
   }
 
   void onPrefsChange(DataStore* source, ObjectId id) override
@@ -630,6 +1231,18 @@ public:
     laserCommandCache_.clear();
     lobCommandCache_.clear();
     projectorCommandCache_.clear();
+
+    categoryIndex_.clear();
+    platformIndex_.clear();
+    platformCommandIndex_.clear();
+    if (categoryValueIndex_)
+      categoryValueIndex_->clear();
+    customRenderingCommandIndex_.clear();
+    beamCommandIndex_.clear();
+    gateCommandIndex_.clear();
+    laserCommandIndex_.clear();
+    lobCommandIndex_.clear();
+    projectorCommandIndex_.clear();
   }
 
   void installSliceTimeRangeMonitor(ObjectId id, std::function<void(double startTime, double endTime)> fn)
@@ -641,25 +1254,53 @@ public:
   /// Update category slices to the give time and return the ids slices that changed due to the update
   void updateCategoryData_(double time, std::vector<simData::ObjectId>& ids)
   {
-#ifdef HAVE_ENTT
-    for (const auto& [id, entry] : categoryCache_)
-#else
-    for (auto& [id, entry] : categoryCache_)
-#endif
+    categoryIndex_.collect(time, visitIds_);
+    for (auto id : visitIds_)
     {
-      if (entry.update(time))
+      auto it = categoryCache_.find(id);
+      if (it == categoryCache_.end())
+        continue;
+
+      if (it->second.update(time))
         ids.push_back(id);
+      updateIndex_(categoryIndex_, id, it->second);
+      // Only entities outside their quiet range are visited, so the value index stays O(changes)
+      if (categoryValueIndex_)
+        refreshValueIndex_(id);
+    }
+  }
+
+  /// Turns the category value index on or off; turning it on indexes the current values of every entity
+  void setCategoryValueIndexing(bool indexing)
+  {
+    if (!indexing)
+    {
+      categoryValueIndex_.reset();
+      return;
     }
+    if (categoryValueIndex_)
+      return;
+
+    categoryValueIndex_ = std::make_unique<CategoryValueIndex>();
+    for (const auto& idCache : categoryCache_)
+      refreshValueIndex_(idCache.first);
+  }
+
+  const CategoryValueIndex* categoryValueIndex() const
+  {
+    return categoryValueIndex_.get();
   }
 
   void updateCommands(double time, std::map<simData::ObjectId, CommitResult>& allResults)
   {
-#ifdef HAVE_ENTT
-    for (const auto& [id, entry] : platformCommandCache_)
-#else
-    for (auto& [id, entry] : platformCommandCache_)
-#endif
+    platformCommandIndex_.collect(time, visitIds_);
+    for (auto id : visitIds_)
     {
+      auto commandIt = platformCommandCache_.find(id);
+      if (commandIt == platformCommandCache_.end())
+        continue;
+
+      auto& entry = commandIt->second;
       auto results = entry.update(&mds_, id, time);
 
       if (results != CommitResult::NO_CHANGE)
@@ -671,14 +1312,15 @@ public:
         if (it != platformCache_.end())
           it->second.resetPreferences();
       }
+      updateIndex_(platformCommandIndex_, id, entry);
     }
 
-    updateCommands_(customRenderingCommandCache_, time, allResults);
-    updateCommands_(beamCommandCache_, time, allResults);
-    updateCommands_(gateCommandCache_, time, allResults);
-    updateCommands_(laserCommandCache_, time, allResults);
-    updateCommands_(lobCommandCache_, time, allResults);
-    updateCommands_(projectorCommandCache_, time, allResults);
+    updateCommands_(customRenderingCommandCache_, customRenderingCommandIndex_, time, allResults);
+    updateCommands_(beamCommandCache_, beamCommandIndex_, time, allResults);
+    updateCommands_(gateCommandCache_, gateCommandIndex_, time, allResults);
+    updateCommands_(laserCommandCache_, laserCommandIndex_, time, allResults);
+    updateCommands_(lobCommandCache_, lobCommandIndex_, time, allResults);
+    updateCommands_(projectorCommandCache_, projectorCommandIndex_, time, allResults);
   }
 
   /// Update platforms to the given time and return the IDs of platforms with changes due to command processing
@@ -689,13 +1331,63 @@ public:
       interpolateEnabled = InterpolatorState::OFF;
 
     const bool fileMode = isFileMode_();
-
+    if ((fileMode != lastFileMode_) || (interpolateEnabled != lastInterpolatorState_))
+    {
+      // Life spans depend on the mode and the interpolator skips the time ranges, so every platform needs a visit
+      lastFileMode_ = fileMode;
+      lastInterpolatorState_ = interpolateEnabled;
 #ifdef HAVE_ENTT
-    for (const auto& [id, entry] : platformCache_)
+      for (const auto& [id, entry] : platformCache_)
 #else
-    for (auto& [id, entry] : platformCache_)
+      for (auto& [id, entry] : platformCache_)
 #endif
-      entry.update(&mds_, id, interpolateEnabled, fileMode, time);
+        platformIndex_.invalidate(id);
+    }
+
+    // Only visit the platforms whose cached state might not hold at the new time
+    platformIndex_.collect(time, visitIds_);
+    std::vector<std::pair<ObjectId, PlatformCache*> > entries;
+    entries.reserve(visitIds_.size());
+    for (auto id : visitIds_)
+    {
+      auto it = platformCache_.find(id);
+      if (it != platformCache_.end())
+        entries.push_back(std::make_pair(id, &it->second));
+    }
+
+    // Platforms between two points are collected into a batch and interpolated together
+    if (mds_.useUpdatePool_(entries.size()))
+    {
+      // Raise the time range callbacks on this thread before updating the slices in parallel
+      for (const auto& [id, entry] : entries)
+        entry->updateSliceTimeRange();
+
+      // Each range interpolates its own batch, so all results are written before run() returns
+      simCore::runRanges(entries.size(), mds_.updateThreadCount_, [this, &entries, interpolateEnabled, fileMode, time](size_t begin, size_t end)
+      {
+        PlatformInterpolationBatch batch;
+        batch.reserve(end - begin);
+        for (size_t ii = begin; ii < end; ++ii)
+          entries[ii].second->update(&mds_, entries[ii].first, interpolateEnabled, fileMode, time, batch);
+        batch.interpolate();
+      });
+    }
+    else
+    {
+      for (const auto& [id, entry] : entries)
+        entry->update(&mds_, id, interpolateEnabled, fileMode, time, interpolationBatch_);
+      interpolationBatch_.interpolate();
+    }
+
+    for (const auto& [id, entry] : entries)
+    {
+      double startTime;
+      double endTime;
+      if (entry->quietRange(interpolateEnabled, fileMode, time, startTime, endTime))
+        platformIndex_.setRange(id, startTime, endTime);
+      else
+        platformIndex_.invalidate(id);
+    }
   }
 
   void resetPlatforms()
@@ -713,8 +1405,10 @@ private:
    class CategoryCache
   {
   public:
-    explicit CategoryCache(MemoryCategoryDataSlice* slice = nullptr)
-      : slice_(slice)
+    explicit CategoryCache(MemoryCategoryDataSlice* slice = nullptr, simData::ObjectId id = 0, TimeRangeIndex* index = nullptr)
+      : slice_(slice),
+        id_(id),
+        index_(index)
     {
       reset();
       if (slice_)
@@ -728,7 +1422,9 @@ private:
     CategoryCache(CategoryCache&& other) noexcept
       : startTime_(std::move(other.startTime_)),
         endTime_(std::move(other.endTime_)),
-        slice_(std::move(other.slice_))
+        slice_(std::move(other.slice_)),
+        id_(std::move(other.id_)),
+        index_(std::move(other.index_))
     {
       if (slice_)
         slice_->installNotifier([this] { reset(); });
@@ -739,6 +1435,8 @@ private:
       startTime_ = std::move(other.startTime_);
       endTime_ = std::move(other.endTime_);
       slice_ = std::move(other.slice_);
+      id_ = std::move(other.id_);
+      index_ = std::move(other.index_);
 
       if (slice_)
         slice_->installNotifier([this] { reset(); });
@@ -763,12 +1461,27 @@ private:
     {
       startTime_.reset();
       endTime_.reset();
+      if (index_)
+        index_->invalidate(id_);
+    }
+
+    /// Returns true if update() has no effect while startTime <= time < endTime
+    bool quietRange(double& startTime, double& endTime) const
+    {
+      if (!startTime_.has_value() || !endTime_.has_value())
+        return false;
+
+      startTime = *startTime_;
+      endTime = *endTime_;
+      return true;
     }
 
   private:
     std::optional<double> startTime_;
     std::optional<double> endTime_;
     MemoryCategoryDataSlice* slice_ = nullptr;
+    simData::ObjectId id_ = 0;
+    TimeRangeIndex* index_ = nullptr;
   };
 
   /** Maintains the time range for a command slice state and only updates the slice state if a new time is outside the time range. */
@@ -776,9 +1489,10 @@ private:
   class CommandCache
   {
   public:
-    explicit CommandCache(SliceType* slice = nullptr, simData::ObjectId id = 0)
+    explicit CommandCache(SliceType* slice = nullptr, simData::ObjectId id = 0, TimeRangeIndex* index = nullptr)
       : slice_(slice),
-        id_(id)
+        id_(id),
+        index_(index)
     {
       reset();
       if (slice_)
@@ -793,6 +1507,8 @@ private:
       : startTime_(std::move(other.startTime_)),
         endTime_(std::move(other.endTime_)),
         slice_(std::move(other.slice_)),
+        id_(std::move(other.id_)),
+        index_(std::move(other.index_)),
         dirty_(std::move(other.dirty_))
     {
       if (slice_)
@@ -804,6 +1520,8 @@ private:
       startTime_ = std::move(other.startTime_);
       endTime_ = std::move(other.endTime_);
       slice_ = std::move(other.slice_);
+      id_ = std::move(other.id_);
+      index_ = std::move(other.index_);
       dirty_ = std::move(other.dirty_);
 
       if (slice_)
@@ -831,6 +1549,19 @@ private:
       startTime_.reset();
       endTime_.reset();
       dirty_ = true;
+      if (index_)
+        index_->invalidate(id_);
+    }
+
+    /// Returns true if update() has no effect while startTime <= time < endTime
+    bool quietRange(double& startTime, double& endTime) const
+    {
+      if (!startTime_.has_value() || !endTime_.has_value())
+        return false;
+
+      startTime = *startTime_;
+      endTime = *endTime_;
+      return true;
     }
 
     bool getAndClearDirty_()
@@ -845,6 +1576,7 @@ private:
     std::optional<double> endTime_;
     SliceType* slice_ = nullptr;
     simData::ObjectId id_ = 0;
+    TimeRangeIndex* index_ = nullptr;
     bool dirty_ = true;
   };
 
@@ -852,8 +1584,10 @@ private:
   class PlatformCache
   {
   public:
-    explicit PlatformCache(PlatformEntry* entry = nullptr)
-      : entry_(entry)
+    explicit PlatformCache(PlatformEntry* entry = nullptr, simData::ObjectId id = 0, TimeRangeIndex* index = nullptr)
+      : entry_(entry),
+        id_(id),
+        index_(index)
     {
       resetPreferences();
       reset();
@@ -871,6 +1605,8 @@ private:
         sliceStartTime_(std::move(other.sliceStartTime_)),
         sliceEndTime_(std::move(other.sliceEndTime_)),
         entry_(std::move(other.entry_)),
+        id_(std::move(other.id_)),
+        index_(std::move(other.index_)),
         sliceSize_(std::move(other.sliceSize_)),
         dataDraw_(std::move(other.dataDraw_)),
         interpolatePos_(std::move(other.interpolatePos_)),
@@ -892,6 +1628,8 @@ private:
       sliceStartTime_ = std::move(other.sliceStartTime_);
       sliceEndTime_ = std::move(other.sliceEndTime_);
       entry_ = std::move(other.entry_);
+      id_ = std::move(other.id_);
+      index_ = std::move(other.index_);
       sliceSize_ = std::move(other.sliceSize_);
       dataDraw_ = std::move(other.dataDraw_);
       interpolatePos_ = std::move(other.interpolatePos_);
@@ -915,18 +1653,11 @@ private:
      * @param interpolateState Type of interpolation, if any
      * @param fileMode True if the data store is in file mode
      * @param time The scenario time to update the slices to
+     * @param batch Collects the points to interpolate for INTERNAL interpolation; the caller interpolates the batch
      */
-    void update(simData::DataStore* ds, simData::ObjectId id, DataStore::InterpolatorState interpolateState, bool fileMode, double time)
+    void update(simData::DataStore* ds, simData::ObjectId id, DataStore::InterpolatorState interpolateState, bool fileMode, double time, PlatformInterpolationBatch& batch)
     {
-      // Set the slice time range
-      if (!sliceStartTime_.has_value())
-      {
-        sliceStartTime_ = entry_->updates()->firstTime();
-        sliceEndTime_ = entry_->updates()->lastTime();
-        sliceSize_ = entry_->updates()->numItems();
-        if (timeRangeMonitorFn_)
-          timeRangeMonitorFn_(*sliceStartTime_, *sliceEndTime_);
-      }
+      updateSliceTimeRange();
 
       // Return early if not drawing
       if (!dataDraw_)
@@ -979,14 +1710,35 @@ private:
           updateEndTime_ = sliceEndTime_;
       }
       else if (interpolateState == InterpolatorState::INTERNAL)
-        update_(time);
+        update_(time, batch);
       else
         entry_->updates()->update(time, ds->interpolator());
     }
 
+    /** Sets the slice time range if the slice changed, notifying the time range monitor */
+    void updateSliceTimeRange()
+    {
+      if (sliceStartTime_.has_value())
+        return;
+
+      sliceStartTime_ = entry_->updates()->firstTime();
+      sliceEndTime_ = entry_->updates()->lastTime();
+      sliceSize_ = entry_->updates()->numItems();
+      if (timeRangeMonitorFn_)
+        timeRangeMonitorFn_(*sliceStartTime_, *sliceEndTime_);
+    }
+
     /** Called when the slice is modified so that the next call to update will not kick out early */
     void reset()
     {
+      // Current may point at one of the entries about to be released
+      if (entry_)
+      {
+        const auto current = entry_->updates()->current();
+        if ((current != nullptr) && ((entry1_.has_value() && (current == &entry1_->update)) || (entry2_.has_value() && (current == &entry2_->update))))
+          entry_->updates()->setCurrent(nullptr);
+      }
+
       updateStartTime_.reset();
       updateEndTime_.reset();
       sliceStartTime_.reset();
@@ -996,6 +1748,53 @@ private:
       sliceSize_ = 0;
       entry1_.reset();
       entry2_.reset();
+      if (index_)
+        index_->invalidate(id_);
+    }
+
+    /**
+     * Returns true if update() has no effect while startTime <= time < endTime; mirrors the
+     * early outs of update() and must be called right after update() with the same arguments
+     */
+    bool quietRange(DataStore::InterpolatorState interpolateState, bool fileMode, double time, double& startTime, double& endTime) const
+    {
+      if (!dataDraw_)
+      {
+        startTime = std::numeric_limits<double>::lowest();
+        endTime = std::numeric_limits<double>::max();
+        return true;
+      }
+
+      // Interpolated values change with every time
+      if ((interpolateState != InterpolatorState::OFF) && interpolatePos_)
+        return false;
+
+      if ((time >= updateStartTime_.value_or(std::numeric_limits<double>::max())) && (time < updateEndTime_.value_or(std::numeric_limits<double>::lowest())))
+      {
+        // The changed flag still needs to be cleared on the next update
+        if (needToClear_)
+          return false;
+
+        startTime = *updateStartTime_;
+        endTime = *updateEndTime_;
+        return true;
+      }
+
+      if (!fileMode || isFileModePlatformActive_(time) || needToSetToNull_)
+        return false;
+
+      // Inactive until the time reaches the life span of the platform
+      if (time < sliceStartTime_.value_or(std::numeric_limits<double>::lowest()))
+      {
+        startTime = std::numeric_limits<double>::lowest();
+        endTime = *sliceStartTime_;
+      }
+      else
+      {
+        startTime = std::nextafter(sliceEndTime_.value_or(std::numeric_limits<double>::max()), std::numeric_limits<double>::max());
+        endTime = std::numeric_limits<double>::max();
+      }
+      return true;
     }
 
     void resetPreferences()
@@ -1065,7 +1864,7 @@ private:
      * Updates the interpolated value.
      * Maps to void MemoryDataSlice<T>::update(double time, Interpolator *interpolator)
      */
-    void update_(double time)
+    void update_(double time, PlatformInterpolationBatch& batch)
     {
       const auto slice = entry_->updates();
       const auto current = slice->current();
@@ -1077,7 +1876,8 @@ private:
         return;
 
       // If necessary calculate a new range
-      if ((time < updateStartTime_.value_or(std::numeric_limits<double>::max())) || (time > updateEndTime_.value_or(std::numeric_limits<double>::lowest())))
+      const bool newRange = (time < updateStartTime_.value_or(std::numeric_limits<double>::max())) || (time > updateEndTime_.value_or(std::numeric_limits<double>::lowest()));
+      if (newRange)
       {
         auto it = slice->upper_bound(time);
 
@@ -1115,7 +1915,10 @@ private:
       bool isBounded = false;
 
       // note that computeTimeUpdate can return a ptr to a real update, or pointer to currentInterpolated_
-      slice->setCurrent(computeTimeUpdate_(time, isBounded, slice->currentInterpolated(), bounds));
+      slice->setCurrent(computeTimeUpdate_(time, isBounded, slice->currentInterpolated(), bounds, batch));
+      // The entries are copies at fixed addresses, so setCurrent() cannot detect a change of range
+      if (newRange && (slice->current() != nullptr))
+        slice->setChanged();
       slice->setInterpolated(isBounded, bounds);
     }
 
@@ -1123,7 +1926,7 @@ private:
      * Returns the update for the given time; can return null.
      * Maps to T *computeTimeUpdate(ForwardIterator begin, ForwardIterator& currentIt, ForwardIterator end, double time, Interpolator *interpolator, bool *isInterpolated, T *interpolatedPoint, B *bounds)
      */
-    simData::PlatformUpdate* computeTimeUpdate_(double time, bool& isInterpolated, simData::PlatformUpdate* interpolatedPoint, DataSlice<simData::PlatformUpdate>::Bounds& bounds)
+    simData::PlatformUpdate* computeTimeUpdate_(double time, bool& isInterpolated, simData::PlatformUpdate* interpolatedPoint, DataSlice<simData::PlatformUpdate>::Bounds& bounds, PlatformInterpolationBatch& batch)
     {
       isInterpolated = false;
       bounds = { nullptr, nullptr };
@@ -1133,150 +1936,35 @@ private:
 
       // Closest update is the last point
       if (!entry1_.has_value() && entry2_.has_value())
-        return const_cast<simData::PlatformUpdate*>(entry2_->update);
+        return &entry2_->update;
 
       // time is at or before the first point
       if (entry1_.has_value() && !entry2_.has_value())
       {
         // updateEndTime_ is correct, because the compare needs the end time.
         if (simCore::areEqual(time, updateEndTime_.value()))
-          return const_cast<simData::PlatformUpdate*>(entry1_->update);
+          return &entry1_->update;
 
         return nullptr;
       }
 
       // time is between points, but first check to see if the time is on the boundary
       if (simCore::areEqual(time, updateStartTime_.value()))
-        return const_cast<simData::PlatformUpdate*>(entry1_->update);
+        return &entry1_->update;
 
       // Check end boundary
       if (simCore::areEqual(time, updateEndTime_.value()))
-        return const_cast<simData::PlatformUpdate*>(entry2_->update);
+        return &entry2_->update;
 
       // If gotten this far, then it must be an interpolation
       isInterpolated = true;
-      bounds = { const_cast<simData::PlatformUpdate*>(entry1_->update), const_cast<simData::PlatformUpdate*>(entry2_->update) };
-      interpolate_(time, *entry1_->mfc, *entry2_->mfc, *interpolatedPoint);
-      return interpolatedPoint;
-    }
-
-    /**
-     * Returns the interpolated TSPI point between mfc1 and mfc2 as specified by the time
-     * Maps to bool LinearInterpolator::interpolate(double time, const PlatformUpdate &prev, const PlatformUpdate &next, PlatformUpdate *result)
-     */
-    void interpolate_(double time, simCore::MultiFrameCoordinate& mfc1, simCore::MultiFrameCoordinate& mfc2, PlatformUpdate& result) const
-    {
+      bounds = { &entry1_->update, &entry2_->update };
       // time must be within bounds for interpolation to work
       assert(updateStartTime_.value() <= time && time <= updateEndTime_.value());
-
-      // compute time ratio
-      const double factor = simCore::getFactor(updateStartTime_.value(), time, updateEndTime_.value());
-
-      const auto& prev = mfc1.ecefCoordinate();
-      const auto& prevLla = mfc1.llaCoordinate();
-      const auto& next = mfc2.ecefCoordinate();
-      const auto& nextLla = mfc2.llaCoordinate();
-
-      // do the interpolation in geocentric, this way the
-       // interpolation is correct at N/S and E/W transitions
-      simCore::Vec3 xyz(simCore::linearInterpolate(prev.x(), next.x(), factor),
-        simCore::linearInterpolate(prev.y(), next.y(), factor),
-        simCore::linearInterpolate(prev.z(), next.z(), factor));
-
-      simCore::Vec3 lla;
-      simCore::CoordinateConverter::convertEcefToGeodeticPos(xyz, lla);
-
-      // Use interpolated geodetic altitude to prevent short cuts through the earth
-      simCore::Coordinate resultsLla;
-      resultsLla.setCoordinateSystem(simCore::COORD_SYS_LLA);
-      resultsLla.setPositionLLA(lla.lat(), lla.lon(), simCore::linearInterpolate(prevLla.z(), nextLla.z(), factor));
-
-      if (prev.hasOrientation() && next.hasOrientation())
-      {
-        const double l_yaw = simCore::angFix2PI(prevLla.yaw());
-        const double l_pitch = simCore::angFix2PI(prevLla.pitch());
-        const double l_roll = simCore::angFix2PI(prevLla.roll());
-        const double h_yaw = simCore::angFix2PI(nextLla.yaw());
-        const double h_pitch = simCore::angFix2PI(nextLla.pitch());
-        const double h_roll = simCore::angFix2PI(nextLla.roll());
-
-        // orientations assumed to be between 0 and 360
-        const double delta_yaw = (h_yaw - l_yaw);
-        const double delta_pitch = (h_pitch - l_pitch);
-        const double delta_roll = (h_roll - l_roll);
-
-        double yaw = 0.0;
-        double pitch = 0.0;
-        double roll = 0.0;
-
-        if (delta_yaw == 0.)
-          yaw = l_yaw;
-        else if (std::abs(delta_yaw) < M_PI)
-          yaw = (l_yaw + factor * delta_yaw);
-        else
-        {
-          if (delta_yaw > 0)
-            yaw = (l_yaw - factor * (M_TWOPI - delta_yaw));
-          else
-            yaw = (l_yaw + factor * (M_TWOPI + delta_yaw));
-        }
-
-        if (delta_pitch == 0.)
-          pitch = l_pitch;
-        else if (std::abs(delta_pitch) < M_PI)
-          pitch = (l_pitch + factor * delta_pitch);
-        else
-        {
-          if (delta_pitch > 0)
-            pitch = (l_pitch - factor * (M_TWOPI - delta_pitch));
-          else
-            pitch = (l_pitch + factor * (M_TWOPI + delta_pitch));
-        }
-
-        if (delta_roll == 0.)
-          roll = l_roll;
-        else if (std::abs(delta_roll) < M_PI)
-          roll = (l_roll + factor * delta_roll);
-        else
-        {
-          if (delta_roll > 0)
-            roll = (l_roll - factor * (M_TWOPI - delta_roll));
-          else
-            roll = (l_roll + factor * (M_TWOPI + delta_roll));
-        }
-
-        resultsLla.setOrientation(yaw, pitch, roll);
-      }
-
-      if (prev.hasVelocity() && next.hasVelocity())
-      {
-        resultsLla.setVelocity(simCore::linearInterpolate(prevLla.vx(), nextLla.vx(), factor),
-          simCore::linearInterpolate(prevLla.vy(), nextLla.vy(), factor),
-          simCore::linearInterpolate(prevLla.vz(), nextLla.vz(), factor));
-      }
-
-      simCore::Coordinate resultsEcef;
-      simCore::CoordinateConverter::convertGeodeticToEcef(resultsLla, resultsEcef);
-
-      result.set_time(time);
-
-      result.set_x(resultsEcef.x());
-      result.set_y(resultsEcef.y());
-      result.set_z(resultsEcef.z());
-
-      if (resultsEcef.hasVelocity())
-      {
-        result.set_vx(resultsEcef.vx());
-        result.set_vy(resultsEcef.vy());
-        result.set_vz(resultsEcef.vz());
-      }
-
-      if (resultsEcef.hasOrientation())
-      {
-        result.set_psi(resultsEcef.psi());
-        result.set_theta(resultsEcef.theta());
-        result.set_phi(resultsEcef.phi());
-      }
+      // The point is written when the batch is interpolated, after every platform has been visited
+      batch.add(time, simCore::getFactor(updateStartTime_.value(), time, updateEndTime_.value()), entry1_->mfc->ecefCoordinate(),
+        entry1_->mfc->llaCoordinate(), entry2_->mfc->ecefCoordinate(), entry2_->mfc->llaCoordinate(), interpolatedPoint);
+      return interpolatedPoint;
     }
 
     /** Convert a simData::PlatformUpdate into a simCore::MultiFrameCoordinate */
@@ -1311,6 +1999,8 @@ private:
     std::optional<double> sliceStartTime_;
     std::optional<double> sliceEndTime_;
     PlatformEntry* entry_ = nullptr;
+    simData::ObjectId id_ = 0;
+    TimeRangeIndex* index_ = nullptr;
     size_t sliceSize_ = 0;
     bool dataDraw_ = false;
     bool interpolatePos_ = false;
@@ -1321,11 +2011,12 @@ private:
     /** Keep track of a platform update / MultiFrameCoordinate pair */
     struct Entry
     {
-      const simData::PlatformUpdate* update = nullptr;
+      /// A copy, since iterators over columnar storage return short-lived pointers
+      simData::PlatformUpdate update;
       std::optional<simCore::MultiFrameCoordinate> mfc;
 
       Entry(const simData::PlatformUpdate* inUpdate, std::optional<simCore::MultiFrameCoordinate> inMfc)
-        : update(inUpdate),
+        : update(*inUpdate),
           mfc(inMfc)
       {
       }
@@ -1353,21 +2044,46 @@ private:
 
   /** Generic routine for updating command slices to the given time */
   template <typename Cache>
-  void updateCommands_(Cache& cache, double time, std::map<simData::ObjectId, CommitResult>& allResults) const
+  void updateCommands_(Cache& cache, TimeRangeIndex& index, double time, std::map<simData::ObjectId, CommitResult>& allResults)
   {
-#ifdef HAVE_ENTT
-    for (const auto& [id, entry] : cache)
-#else
-    for (auto& [id, entry] : cache)
-#endif
+    index.collect(time, visitIds_);
+    for (auto id : visitIds_)
     {
-      auto results = entry.update(&mds_, id, time);
+      auto it = cache.find(id);
+      if (it == cache.end())
+        continue;
+
+      auto results = it->second.update(&mds_, id, time);
 
       if (results != CommitResult::NO_CHANGE)
         allResults[id] = results;
+      updateIndex_(index, id, it->second);
     }
   }
 
+  /** Records when a visited cache next needs a visit */
+  template <typename CacheEntry>
+  static void updateIndex_(TimeRangeIndex& index, ObjectId id, const CacheEntry& entry)
+  {
+    double startTime;
+    double endTime;
+    if (entry.quietRange(startTime, endTime))
+      index.setRange(id, startTime, endTime);
+    else
+      index.invalidate(id);
+  }
+
+  /// Replaces the entity's entry in the category value index with the current values of its slice
+  void refreshValueIndex_(simData::ObjectId id)
+  {
+    auto it = mds_.categoryData_.find(id);
+    if (it == mds_.categoryData_.end())
+      return;
+    valueIndexScratch_.clear();
+    it->second->allInts(valueIndexScratch_);
+    categoryValueIndex_->set(id, valueIndexScratch_);
+  }
+
   MemoryDataStore& mds_;
 #ifdef HAVE_ENTT
   entt::dense_map<simData::ObjectId, CategoryCache> categoryCache_;
@@ -1390,6 +2106,29 @@ private:
   std::map<simData::ObjectId, CommandCache<MemoryCommandSlice<LobGroupCommand, LobGroupPrefs>>> lobCommandCache_;
   std::map<simData::ObjectId, CommandCache<MemoryCommandSlice<ProjectorCommand, ProjectorPrefs>>> projectorCommandCache_;
 #endif
+
+  // Indexes of when each cache above next needs a visit
+  TimeRangeIndex categoryIndex_;
+  TimeRangeIndex platformIndex_;
+  TimeRangeIndex platformCommandIndex_;
+  TimeRangeIndex customRenderingCommandIndex_;
+  TimeRangeIndex beamCommandIndex_;
+  TimeRangeIndex gateCommandIndex_;
+  TimeRangeIndex laserCommandIndex_;
+  TimeRangeIndex lobCommandIndex_;
+  TimeRangeIndex projectorCommandIndex_;
+  /// Scratch list of the ids to visit, kept to avoid reallocation on each update
+  std::vector<ObjectId> visitIds_;
+  /// Points to interpolate when platforms are updated on this thread, kept to avoid reallocation on each update
+  PlatformInterpolationBatch interpolationBatch_;
+  /// Entities by category name and value as of the last update; nullptr when indexing is off
+  std::unique_ptr<CategoryValueIndex> categoryValueIndex_;
+  /// Scratch list of category values, kept to avoid reallocation on each update
+  std::vector<std::pair<int, int> > valueIndexScratch_;
+  /// File mode of the last platform update
+  bool lastFileMode_ = true;
+  /// Interpolator state of the last platform update
+  DataStore::InterpolatorState lastInterpolatorState_ = DataStore::InterpolatorState::OFF;
 };
 
 //----------------------------------------------------------------------------
@@ -1520,6 +2259,7 @@ public:
 
   void onNewRowData(simData::DataTable& table, simData::ObjectId id, double dataTime) override
   {
+    dataStore_.memoryChanged_(id);
     for (const auto& listenerPtr : dataStore_.newUpdatesListeners_)
       listenerPtr->onNewRowData(&dataStore_, table, id, dataTime);
   }
@@ -1612,6 +2352,25 @@ private: // data
 
 //----------------------------------------------------------------------------
 
+/** Queues for the ingest methods; created on the first ingest since most data stores never use them */
+struct MemoryDataStore::IngestQueues
+{
+  explicit IngestQueues(size_t capacity)
+    : platformUpdates(capacity),
+      beamUpdates(capacity),
+      gateUpdates(capacity),
+      categoryData(capacity),
+      genericData(capacity)
+  {
+  }
+
+  IngestQueue<IngestRecord<PlatformUpdate> > platformUpdates;
+  IngestQueue<IngestRecord<BeamUpdate> > beamUpdates;
+  IngestQueue<IngestRecord<GateUpdate> > gateUpdates;
+  IngestQueue<IngestRecord<CategoryData> > categoryData;
+  IngestQueue<IngestRecord<GenericData> > genericData;
+};
+
 ///constructor
 MemoryDataStore::MemoryDataStore()
 : baseId_(0),
@@ -1620,6 +2379,8 @@ MemoryDataStore::MemoryDataStore()
   interpolationEnabled_(InterpolatorState::OFF),
   interpolator_(nullptr),
   dataLimiting_(false),
+  parallelUpdateThreshold_(DEFAULT_PARALLEL_UPDATE_THRESHOLD),
+  ingestQueueCapacity_(DEFAULT_INGEST_QUEUE_CAPACITY),
   categoryNameManager_(new CategoryNameManager),
   dataLimitsProvider_(nullptr),
   dataTableManager_(nullptr),
@@ -1644,6 +2405,8 @@ MemoryDataStore::MemoryDataStore(const ScenarioProperties &properties)
   interpolationEnabled_(InterpolatorState::OFF),
   interpolator_(nullptr),
   dataLimiting_(false),
+  parallelUpdateThreshold_(DEFAULT_PARALLEL_UPDATE_THRESHOLD),
+  ingestQueueCapacity_(DEFAULT_INGEST_QUEUE_CAPACITY),
   categoryNameManager_(new CategoryNameManager),
   dataLimitsProvider_(nullptr),
   dataTableManager_(nullptr),
@@ -1668,6 +2431,7 @@ MemoryDataStore::~MemoryDataStore()
     boundClock_->removeModeChangeCallback(clockModeMonitor_);
 
   clearMemory_();
+  delete ingestQueues_.exchange(nullptr);
   delete categoryNameManager_;
   categoryNameManager_ = nullptr;
   delete dataTableManager_;
@@ -1734,6 +2498,9 @@ void MemoryDataStore::clearMemory_()
 
   // clear out the category name manager, since categories are scenario specific data
   categoryNameManager_->clear();
+  memoryBytes_.clear();
+  memoryChangedIds_.clear();
+  memoryTotal_ = 0;
 
   // dataTableManager_ will be cleared out by calls to deleteEntries_()
   // entityNameCache_ will be cleared out by calls to deleteEntries_()
@@ -1890,20 +2657,19 @@ void MemoryDataStore::updateTargetBeam_(ObjectId id, BeamEntry* beam, double tim
 
 void MemoryDataStore::updateBeams_(double time)
 {
-  for (Beams::iterator iter = beams_.begin(); iter != beams_.end(); ++iter)
+  // Target beams only read the current values of their platforms, which are updated before the beams
+  forEachEntry_(beams_, [this, time](ObjectId id, BeamEntry* beamEntry)
   {
-    BeamEntry* beamEntry = iter->second;
-
     // until we have datadraw, send nullptr; once we have datadraw, we'll immediately update with valid data
     if (!beamEntry->preferences()->commonprefs().datadraw())
       beamEntry->updates()->setCurrent(nullptr);
     else if (beamEntry->properties()->type() == BeamProperties::Type::TARGET)
-      updateTargetBeam_(iter->first, beamEntry, time);
+      updateTargetBeam_(id, beamEntry, time);
     else if (isInterpolationEnabled() && beamEntry->preferences()->interpolatebeampos())
       beamEntry->updates()->update(time, interpolator_);
     else
       beamEntry->updates()->update(time);
-  }
+  });
 }
 
 simData::MemoryDataStore::BeamEntry* MemoryDataStore::getBeamForGate_(uint64_t gateID)
@@ -2024,10 +2790,9 @@ bool MemoryDataStore::gateUsesBeamBeamwidth_(GateEntry* gate) const
 
 void MemoryDataStore::updateGates_(double time)
 {
-  for (Gates::iterator iter = gates_.begin(); iter != gates_.end(); ++iter)
+  // Target gates only read the properties of their beams and the current values of platforms
+  forEachEntry_(gates_, [this, time](ObjectId, GateEntry* gateEntry)
   {
-    GateEntry* gateEntry = iter->second;
-
     // until we have datadraw, send nullptr; once we have datadraw, we'll immediately update with valid data
     if (!gateEntry->preferences()->commonprefs().datadraw())
       gateEntry->updates()->setCurrent(nullptr);
@@ -2050,15 +2815,13 @@ void MemoryDataStore::updateGates_(double time)
         gateEntry->updates()->setChanged();
       }
     }
-  }
+  });
 }
 
 void MemoryDataStore::updateLasers_(double time)
 {
-  for (Lasers::iterator iter = lasers_.begin(); iter != lasers_.end(); ++iter)
+  forEachEntry_(lasers_, [this, time](ObjectId, LaserEntry* laserEntry)
   {
-    LaserEntry* laserEntry = iter->second;
-
     // until we have datadraw, send nullptr; once we have datadraw, we'll immediately update with valid data
     if (!laserEntry->preferences()->commonprefs().datadraw())
       laserEntry->updates()->setCurrent(nullptr);
@@ -2067,24 +2830,23 @@ void MemoryDataStore::updateLasers_(double time)
       laserEntry->updates()->update(time, interpolator_);
     else
       laserEntry->updates()->update(time);
-  }
+  });
 }
 
 void MemoryDataStore::updateProjectors_(double time)
 {
-  for (Projectors::iterator iter = projectors_.begin(); iter != projectors_.end(); ++iter)
+  forEachEntry_(projectors_, [this, time](ObjectId, ProjectorEntry* projectorEntry)
   {
-    ProjectorEntry* projectorEntry = iter->second;
-
     if (isInterpolationEnabled() && projectorEntry->preferences()->interpolateprojectorfov())
       projectorEntry->updates()->update(time, interpolator_);
     else
       projectorEntry->updates()->update(time);
-  }
+  });
 }
 
 void MemoryDataStore::updateLobGroups_(double time)
 {
+  // Serial since the preferences are read through a transaction and the slice update can apply data limits
   //for each entry
   for (LobGroups::iterator iter = lobGroups_.begin(); iter != lobGroups_.end(); ++iter)
   {
@@ -2106,6 +2868,7 @@ void MemoryDataStore::updateLobGroups_(double time)
 
 void MemoryDataStore::flushEntity_(ObjectId id, simData::ObjectType type, FlushScope flushScope, FlushFields flushFields, double startTime, double endTime, bool notifyListener)
 {
+  memoryChanged_(id);
   const bool recursive = (flushScope == FLUSH_RECURSIVE);
   const bool flushUpdates = ((flushFields & FLUSH_UPDATES) != 0);
   const bool flushCommands = ((flushFields & FLUSH_COMMANDS) != 0);
@@ -2216,6 +2979,7 @@ void MemoryDataStore::flushDataTables_(ObjectId id)
     }
   };
 
+  memoryChanged_(id);
   // Visit all tables and flush them
   const simData::TableList* ownerTables = dataTableManager().tablesForOwner(id);
   if (ownerTables != nullptr)
@@ -2248,6 +3012,7 @@ void MemoryDataStore::flushDataTables_(ObjectId id, double startTime, double end
     double endTime_;
   };
 
+  memoryChanged_(id);
   // Visit all tables and flush them
   const simData::TableList* ownerTables = dataTableManager().tablesForOwner(id);
   if (ownerTables != nullptr)
@@ -2282,9 +3047,13 @@ simData::PlatformPrefs MemoryDataStore::defaultPlatformPrefs() const
 ///Update internal data to show 'time' as current
 void MemoryDataStore::update(double time)
 {
+  drainIngestQueues();
   if (!hasChanged_ && time == lastUpdateTime_)
     return;
 
+  if (memoryBudget_ != 0)
+    enforceMemoryBudget();
+
   std::map<simData::ObjectId, CommitResult> results;
   sliceCacheObserver_->updateCommands(time, results);
   // Need to handle recursion so make a local copy
@@ -2388,6 +3157,302 @@ bool MemoryDataStore::dataLimiting() const
   return dataLimiting_;
 }
 
+void MemoryDataStore::setColumnarPlatformStorage(bool columnar)
+{
+  if (columnarPlatformStorage_ == columnar)
+    return;
+
+  columnarPlatformStorage_ = columnar;
+  for (const auto& idEntry : platforms_)
+    idEntry.second->updates()->setColumnarStorage(columnar);
+  resetMemoryTotals_();
+  hasChanged_ = true;
+}
+
+bool MemoryDataStore::columnarPlatformStorage() const
+{
+  return columnarPlatformStorage_;
+}
+
+void MemoryDataStore::setPlatformCompression(const PlatformUpdateColumns::Compression* compression)
+{
+  if (compression)
+    platformCompression_ = std::make_unique<PlatformUpdateColumns::Compression>(*compression);
+  else
+    platformCompression_.reset();
+  for (const auto& idEntry : platforms_)
+    idEntry.second->updates()->setCompression(compression);
+  resetMemoryTotals_();
+  hasChanged_ = true;
+}
+
+const PlatformUpdateColumns::Compression* MemoryDataStore::platformCompression() const
+{
+  return platformCompression_.get();
+}
+
+int MemoryDataStore::setHistorySpill(double window, const std::string& directory)
+{
+  if (window <= 0.0)
+  {
+    spillWindow_ = 0.0;
+    for (const auto& idEntry : platforms_)
+      idEntry.second->updates()->setSpill(nullptr, 0.0);
+    spillFile_.reset();
+    resetMemoryTotals_();
+    return 0;
+  }
+
+  if (!spillFile_)
+  {
+    auto file = std::make_shared<SpillFile>(directory);
+    if (!file->isOpen())
+    {
+      SIM_ERROR << "Unable to create platform history spill file in " << (directory.empty() ? "the temporary directory" : directory) << "\n";
+      return 1;
+    }
+    spillFile_ = file;
+  }
+
+  spillWindow_ = window;
+  for (const auto& idEntry : platforms_)
+    idEntry.second->updates()->setSpill(spillFile_, spillWindow_);
+  resetMemoryTotals_();
+  return 0;
+}
+
+double MemoryDataStore::historySpillWindow() const
+{
+  return spillWindow_;
+}
+
+void MemoryDataStore::setCategoryValueIndexing(bool indexing)
+{
+  sliceCacheObserver_->setCategoryValueIndexing(indexing);
+}
+
+const CategoryValueIndex* MemoryDataStore::categoryValueIndex() const
+{
+  return sliceCacheObserver_->categoryValueIndex();
+}
+
+void MemoryDataStore::setGenericDataInterning(bool interning)
+{
+  if (interning == genericDataInterning())
+    return;
+
+  if (interning)
+    genericStringArena_ = std::make_shared<StringArena>();
+  else
+    genericStringArena_.reset();
+  for (const auto& idSlice : genericData_)
+    idSlice.second->setStringArena(genericStringArena_);
+  resetMemoryTotals_();
+  hasChanged_ = true;
+}
+
+bool MemoryDataStore::genericDataInterning() const
+{
+  return genericStringArena_ != nullptr;
+}
+
+void MemoryDataStore::setUpdateThreadCount(unsigned int numThreads)
+{
+  updateThreadCount_ = std::max(numThreads, 1u);
+}
+
+unsigned int MemoryDataStore::updateThreadCount() const
+{
+  return updateThreadCount_;
+}
+
+void MemoryDataStore::setParallelUpdateThreshold(size_t numEntities)
+{
+  parallelUpdateThreshold_ = numEntities;
+}
+
+size_t MemoryDataStore::parallelUpdateThreshold() const
+{
+  return parallelUpdateThreshold_;
+}
+
+MemoryDataStore::IngestQueues* MemoryDataStore::ingestQueuesForPush_()
+{
+  IngestQueues* queues = ingestQueues_.load(std::memory_order_acquire);
+  if (queues)
+    return queues;
+
+  // Producers can race to create the queues; only the first to store its queues wins
+  IngestQueues* created = new IngestQueues(ingestQueueCapacity_);
+  if (ingestQueues_.compare_exchange_strong(queues, created, std::memory_order_acq_rel))
+    return created;
+  delete created;
+  return queues;
+}
+
+int MemoryDataStore::ingestPlatformUpdate(ObjectId id, const PlatformUpdate& update)
+{
+  return ingestQueuesForPush_()->platformUpdates.push(IngestRecord<PlatformUpdate>{ id, update });
+}
+
+int MemoryDataStore::ingestBeamUpdate(ObjectId id, const BeamUpdate& update)
+{
+  return ingestQueuesForPush_()->beamUpdates.push(IngestRecord<BeamUpdate>{ id, update });
+}
+
+int MemoryDataStore::ingestGateUpdate(ObjectId id, const GateUpdate& update)
+{
+  return ingestQueuesForPush_()->gateUpdates.push(IngestRecord<GateUpdate>{ id, update });
+}
+
+int MemoryDataStore::ingestCategoryData(ObjectId id, const CategoryData& data)
+{
+  return ingestQueuesForPush_()->categoryData.push(IngestRecord<CategoryData>{ id, data });
+}
+
+int MemoryDataStore::ingestGenericData(ObjectId id, const GenericData& data)
+{
+  return ingestQueuesForPush_()->genericData.push(IngestRecord<GenericData>{ id, data });
+}
+
+size_t MemoryDataStore::drainIngestQueues()
+{
+  IngestQueues* queues = ingestQueues_.load(std::memory_order_acquire);
+  if (!queues)
+    return 0;
+
+  size_t drained = drainUpdates_<PlatformEntry>(queues->platformUpdates, platforms_, true);
+  drained += drainUpdates_<BeamEntry>(queues->beamUpdates, beams_, true);
+  drained += drainUpdates_<GateEntry>(queues->gateUpdates, gates_, true);
+  drained += drainUpdates_<MemoryCategoryDataSlice>(queues->categoryData, categoryData_, false);
+  drained += drainUpdates_<MemoryGenericDataSlice>(queues->genericData, genericData_, false);
+  if (drained > 0)
+    hasChanged_ = true;
+  return drained;
+}
+
+void MemoryDataStore::setIngestQueueCapacity(size_t capacity)
+{
+  if (capacity == ingestQueueCapacity_)
+    return;
+
+  drainIngestQueues();
+  ingestQueueCapacity_ = capacity;
+  // Queues are created with the new capacity on the next ingest
+  delete ingestQueues_.exchange(nullptr);
+}
+
+size_t MemoryDataStore::ingestQueueCapacity() const
+{
+  return ingestQueueCapacity_;
+}
+
+int MemoryDataStore::addPlatformUpdates(ObjectId id, std::span<const PlatformUpdate> updates)
+{
+  return addUpdates_<PlatformEntry>(id, platforms_, updates);
+}
+
+int MemoryDataStore::addBeamUpdates(ObjectId id, std::span<const BeamUpdate> updates)
+{
+  return addUpdates_<BeamEntry>(id, beams_, updates);
+}
+
+int MemoryDataStore::addGateUpdates(ObjectId id, std::span<const GateUpdate> updates)
+{
+  return addUpdates_<GateEntry>(id, gates_, updates);
+}
+
+template <typename EntryType, typename EntryMapType, typename UpdateType>
+int MemoryDataStore::addUpdates_(ObjectId id, const EntryMapType& entries, std::span<const UpdateType> updates)
+{
+  EntryType* entry = getEntry<EntryType, EntryMapType>(id, &entries);
+  if (!entry)
+    return 1;
+  if (updates.empty())
+    return 0;
+
+  insertUpdateBatch(entry->updates(), updates);
+  memoryChanged_(id);
+  applyDataLimits_(id, entry->updates());
+  hasChanged_ = true;
+
+  const auto [minIt, maxIt] = std::minmax_element(updates.begin(), updates.end(), [](const UpdateType& lhs, const UpdateType& rhs) { return lhs.time() < rhs.time(); });
+  for (const auto& listenerPtr : newUpdatesListeners_)
+    listenerPtr->onEntityUpdates(this, id, minIt->time(), maxIt->time());
+  return 0;
+}
+
+template <typename EntryType, typename EntryMapType, typename UpdateType>
+size_t MemoryDataStore::drainUpdates_(IngestQueue<IngestRecord<UpdateType> >& queue, const EntryMapType& entries, bool isEntityUpdate)
+{
+  std::vector<IngestRecord<UpdateType> > records;
+  popIngestRecords(queue, records);
+
+  const bool ignoreDuplicates = dataLimiting() && properties_.ignoreduplicategenericdata();
+  auto first = records.begin();
+  while (first != records.end())
+  {
+    const ObjectId id = first->id;
+    const auto last = std::find_if(first, records.end(), [id](const IngestRecord<UpdateType>& record) { return record.id != id; });
+
+    EntryType* entry = getEntry<EntryType, EntryMapType>(id, &entries);
+    if (entry)
+    {
+      // Insert moves the data, so grab the times first
+      const double firstTime = first->data.time();
+      const double lastTime = (last - 1)->data.time();
+      auto* slice = ingestSlice(entry);
+      insertRecords(slice, first, last, ignoreDuplicates);
+      memoryChanged_(id);
+      applyDataLimits_(id, slice);
+
+      if (isEntityUpdate)
+      {
+        for (const auto& listenerPtr : newUpdatesListeners_)
+          listenerPtr->onEntityUpdates(this, id, firstTime, lastTime);
+      }
+    }
+    first = last;
+  }
+  return records.size();
+}
+
+template <typename SliceType>
+void MemoryDataStore::applyDataLimits_(ObjectId id, SliceType* slice)
+{
+  if (!dataLimiting())
+    return;
+
+  Transaction t;
+  if (id == 0)
+  {
+    // Scenario generic data uses the scenario limits, like NewScenarioGenericUpdateTransactionImpl
+    const ScenarioProperties* properties = scenarioProperties(&t);
+    CommonPrefs prefs;
+    prefs.set_datalimitpoints(properties->datalimitpoints());
+    prefs.set_datalimittime(properties->datalimittime());
+    slice->limitByPrefs(prefs);
+    return;
+  }
+
+  const CommonPrefs* prefs = commonPrefs(id, &t);
+  if (prefs)
+    slice->limitByPrefs(*prefs);
+}
+
+bool MemoryDataStore::useUpdatePool_(size_t numEntities) const
+{
+  return (updateThreadCount_ > 1) && (numEntities >= parallelUpdateThreshold_);
+}
+
+void MemoryDataStore::initUpdateSlice_(PlatformMemoryDataSlice* slice)
+{
+  slice->setCompression(platformCompression_.get());
+  slice->setColumnarStorage(columnarPlatformStorage_);
+  if (spillFile_)
+    slice->setSpill(spillFile_, spillWindow_);
+}
+
 void MemoryDataStore::flush(ObjectId flushId, FlushType flushType)
 {
   if (flushId == 0)
@@ -2447,6 +3512,7 @@ int MemoryDataStore::flush(ObjectId id, FlushScope scope, FlushFields fields, do
     }
 
     hasChanged_ = true;
+    memoryChanged_(0);
     sendFlushToListeners_(0);
   }
   else
@@ -2465,6 +3531,7 @@ void MemoryDataStore::applyDataLimiting_(ObjectId id)
 {
   if (!dataLimiting_)
     return;
+  memoryChanged_(id);
   // first get common prefs object
   Transaction t;
   const CommonPrefs* prefs = commonPrefs(id, &t);
@@ -2506,6 +3573,216 @@ void MemoryDataStore::applyDataLimiting_(ObjectId id)
     catIter->second->limitByPrefs(*prefs);
 }
 
+void MemoryDataStore::setMemoryBudget(size_t bytes)
+{
+  const bool hadBudget = (memoryBudget_ != 0);
+  memoryBudget_ = bytes;
+  // Changes are not tracked without a budget, so everything is measured again when one is set
+  if (hadBudget != (bytes != 0))
+  {
+    resetMemoryTotals_();
+    updateNewRowDataListener_();
+  }
+  // Enforced by the next update()
+  hasChanged_ = true;
+}
+
+size_t MemoryDataStore::memoryBudget() const
+{
+  return memoryBudget_;
+}
+
+MemoryDataStore::MemoryUsage MemoryDataStore::memoryUsage(ObjectId id) const
+{
+  MemoryUsage usage;
+  usage.id = id;
+  usage.type = (id == 0) ? NONE : objectType(id);
+  switch (usage.type)
+  {
+  case PLATFORM:
+    entryMemoryUsage(platforms_, id, usage);
+    break;
+  case BEAM:
+    entryMemoryUsage(beams_, id, usage);
+    break;
+  case GATE:
+    entryMemoryUsage(gates_, id, usage);
+    break;
+  case LASER:
+    entryMemoryUsage(lasers_, id, usage);
+    break;
+  case LOB_GROUP:
+    entryMemoryUsage(lobGroups_, id, usage);
+    break;
+  case PROJECTOR:
+    entryMemoryUsage(projectors_, id, usage);
+    break;
+  case CUSTOM_RENDERING:
+    entryMemoryUsage(customRenderings_, id, usage);
+    break;
+  case ALL:
+  case NONE:
+    break;
+  }
+
+  CategoryDataMap::const_iterator catIter = categoryData_.find(id);
+  if (catIter != categoryData_.end())
+    usage.categoryData = catIter->second->memoryUsage();
+
+  GenericDataMap::const_iterator genIter = genericData_.find(id);
+  if (genIter != genericData_.end())
+    usage.genericData = genIter->second->memoryUsage();
+  // Interned strings are shared by all entities, so they are charged to the scenario
+  if (id == 0 && genericStringArena_)
+    usage.genericData += genericStringArena_->memoryUsage();
+
+  usage.dataTables = tableMemoryUsage(*dataTableManager_, id);
+  return usage;
+}
+
+MemoryDataStore::MemoryStatistics MemoryDataStore::memoryStatistics() const
+{
+  MemoryStatistics stats = evictionTotals_;
+  stats.budget = memoryBudget_;
+
+  IdList ids;
+  idList(&ids);
+  stats.usage.reserve(ids.size() + 1);
+  stats.usage.push_back(memoryUsage(0));
+  for (ObjectId id : ids)
+    stats.usage.push_back(memoryUsage(id));
+
+  for (const MemoryUsage& usage : stats.usage)
+    stats.totalBytes += usage.total();
+  std::stable_sort(stats.usage.begin(), stats.usage.end(), [](const MemoryUsage& lhs, const MemoryUsage& rhs) {
+    return lhs.total() > rhs.total();
+  });
+  return stats;
+}
+
+void MemoryDataStore::memoryChanged_(ObjectId id)
+{
+  if (memoryBudget_ != 0)
+    memoryChangedIds_.insert(id);
+}
+
+void MemoryDataStore::resetMemoryTotals_()
+{
+  memoryBytes_.clear();
+  memoryChangedIds_.clear();
+  memoryTotal_ = 0;
+  if (memoryBudget_ == 0)
+    return;
+
+  IdList ids;
+  idList(&ids);
+  memoryChangedIds_.insert(ids.begin(), ids.end());
+  memoryChangedIds_.insert(0);
+}
+
+void MemoryDataStore::measureChangedMemory_()
+{
+  for (ObjectId id : memoryChangedIds_)
+  {
+    // Removed entities measure 0 bytes
+    const size_t bytes = memoryUsage(id).total();
+    auto iter = memoryBytes_.find(id);
+    if (iter != memoryBytes_.end())
+    {
+      memoryTotal_ -= std::min(memoryTotal_, iter->second);
+      if (bytes == 0)
+        memoryBytes_.erase(iter);
+      else
+        iter->second = bytes;
+    }
+    else if (bytes != 0)
+      memoryBytes_[id] = bytes;
+    memoryTotal_ += bytes;
+  }
+  memoryChangedIds_.clear();
+}
+
+size_t MemoryDataStore::enforceMemoryBudget()
+{
+  if (memoryBudget_ == 0)
+    return 0;
+
+  // Only the entities that changed since the last call are measured
+  measureChangedMemory_();
+  size_t total = memoryTotal_;
+  if (total <= memoryBudget_)
+    return 0;
+
+  IdList ids;
+  idList(&ids);
+  std::vector<std::unique_ptr<EvictionCandidate> > candidates;
+  addSliceEvictions(platforms_, candidates);
+  addSliceEvictions(beams_, candidates);
+  addSliceEvictions(gates_, candidates);
+  addSliceEvictions(lasers_, candidates);
+  addSliceEvictions(lobGroups_, candidates);
+  addSliceEvictions(projectors_, candidates);
+  addSliceEvictions(customRenderings_, candidates);
+  ids.push_back(0);
+  for (ObjectId id : ids)
+  {
+    const TableList* tables = dataTableManager_->tablesForOwner(id);
+    if (tables == nullptr)
+      continue;
+    TableEvictionCollector tableCollector(id, candidates);
+    tables->accept(tableCollector);
+  }
+
+  // Min heap on the time of the oldest point, so the oldest data across all entities goes first
+  typedef std::pair<double, EvictionCandidate*> TimeAndCandidate;
+  const auto laterFirst = [](const TimeAndCandidate& lhs, const TimeAndCandidate& rhs) { return lhs.first > rhs.first; };
+  std::vector<TimeAndCandidate> heap;
+  heap.reserve(candidates.size());
+  for (const auto& candidate : candidates)
+    heap.push_back(TimeAndCandidate(candidate->firstTime(), candidate.get()));
+  std::make_heap(heap.begin(), heap.end(), laterFirst);
+
+  size_t evictedBytes = 0;
+  size_t evictedPoints = 0;
+  while ((total > memoryBudget_) && !heap.empty())
+  {
+    std::pop_heap(heap.begin(), heap.end(), laterFirst);
+    EvictionCandidate* candidate = heap.back().second;
+    heap.pop_back();
+
+    // Remove points up to the oldest point of the next candidate, but no more than needed to meet the budget
+    const double throughTime = heap.empty() ? std::numeric_limits<double>::max() : heap.front().first;
+    const size_t before = candidate->bytes();
+    const size_t bytesPerPoint = std::max<size_t>(1, before / std::max<size_t>(1, candidate->numPoints()));
+    const size_t maxPoints = (total - memoryBudget_ + bytesPerPoint - 1) / bytesPerPoint;
+    const size_t removed = candidate->evict(maxPoints, throughTime);
+    if (removed == 0)
+      continue;
+
+    const size_t after = candidate->bytes();
+    const size_t freed = (before > after) ? (before - after) : 0;
+    total -= std::min(total, freed);
+    evictedBytes += freed;
+    evictedPoints += removed;
+    memoryChanged_(candidate->owner());
+    if (candidate->numPoints() > 1)
+    {
+      heap.push_back(TimeAndCandidate(candidate->firstTime(), candidate));
+      std::push_heap(heap.begin(), heap.end(), laterFirst);
+    }
+  }
+
+  if (evictedPoints != 0)
+  {
+    measureChangedMemory_();
+    ++evictionTotals_.evictions;
+    evictionTotals_.evictedPoints += evictedPoints;
+    evictionTotals_.evictedBytes += evictedBytes;
+    hasChanged_ = true;
+  }
+  return evictedBytes;
+}
+
 ///Retrieves the number of objects of 'type' contained by the DataStore
 size_t MemoryDataStore::idCount(simData::ObjectType type) const
 {
@@ -2612,6 +3889,51 @@ void MemoryDataStore::idListByName(const std::string& name, IdList* ids, simData
     ids->push_back((*it)->id());
 }
 
+/// Retrieve a list of IDs for objects of 'type' whose names start with the prefix
+void MemoryDataStore::idListByNamePrefix(const std::string& prefix, IdList* ids, simData::ObjectType type, bool caseSensitive) const
+{
+  if (ids == nullptr)
+    return;
+  ids->clear();
+  if (entityNameCache_ == nullptr)
+    return;
+
+  std::vector<const EntityNameEntry*> entries;
+  entityNameCache_->getEntriesWithPrefix(prefix, type, caseSensitive, entries);
+  for (const EntityNameEntry* entry : entries)
+    ids->push_back(entry->id());
+}
+
+/// Retrieve a list of IDs for objects of 'type' whose names contain the text
+void MemoryDataStore::idListByNameSubstring(const std::string& text, IdList* ids, simData::ObjectType type, bool caseSensitive) const
+{
+  if (ids == nullptr)
+    return;
+  ids->clear();
+  if (entityNameCache_ == nullptr)
+    return;
+
+  std::vector<const EntityNameEntry*> entries;
+  entityNameCache_->getEntriesContaining(text, type, caseSensitive, entries);
+  for (const EntityNameEntry* entry : entries)
+    ids->push_back(entry->id());
+}
+
+/// Retrieve a list of IDs for objects of 'type' whose names match the regular expression
+void MemoryDataStore::idListByNameRegExp(const RegExpFilter& regExp, IdList* ids, simData::ObjectType type) const
+{
+  if (ids == nullptr)
+    return;
+  ids->clear();
+  if (entityNameCache_ == nullptr)
+    return;
+
+  std::vector<const EntityNameEntry*> entries;
+  entityNameCache_->getEntriesMatching(regExp, type, entries);
+  for (const EntityNameEntry* entry : entries)
+    ids->push_back(entry->id());
+}
+
 
 /// Retrieve a list of IDs for objects with the given original id
 void MemoryDataStore::idListByOriginalId(IdList *ids, uint64_t originalId, simData::ObjectType type) const
@@ -2844,6 +4166,7 @@ void MemoryDataStore::removeEntity(ObjectId id)
     return; // entity with given id not found
 
   hasChanged_ = true;
+  memoryChanged_(id);
 
   // Need to handle recursion so make a local copy
   ListenerList localCopy = listeners_;
@@ -2958,6 +4281,7 @@ int MemoryDataStore::removeCategoryDataPoint(ObjectId id, double time, int catNa
     return -1;
 
   hasChanged_ = true;
+  memoryChanged_(id);
   return slice->removePoint(time, catNameInt, valueInt) ? 0 : 1;
 }
 
@@ -2968,6 +4292,7 @@ int MemoryDataStore::removeGenericDataTag(ObjectId id, const std::string& tag)
     return -1;
 
   hasChanged_ = true;
+  memoryChanged_(id);
   return slice->removeTag(tag);
 }
 
@@ -3739,6 +5064,7 @@ int MemoryDataStore::modifyPlatformCommandSlice(ObjectId id, VisitableDataSlice<
     {
       entry->commands()->modify(modifier);
       hasChanged_ = true;
+      memoryChanged_(id);
       return 0;
     }
   }
@@ -3754,6 +5080,7 @@ int MemoryDataStore::modifyProjectorCommandSlice(ObjectId id, VisitableDataSlice
     {
       entry->commands()->modify(modifier);
       hasChanged_ = true;
+      memoryChanged_(id);
       return 0;
     }
   }
@@ -3769,6 +5096,7 @@ int MemoryDataStore::modifyCustomRenderingCommandSlice(ObjectId id, VisitableDat
     {
       entry->commands()->modify(modifier);
       hasChanged_ = true;
+      memoryChanged_(id);
       return 0;
     }
   }
@@ -3844,7 +5172,7 @@ void MemoryDataStore::addNewUpdatesListener(NewUpdatesListenerPtr callback)
   newUpdatesListeners_.push_back(callback);
   // Update table manager if going from empty to non-empty, so it starts sending us updates
   if (newUpdatesListeners_.size() == 1)
-    static_cast<MemoryTable::TableManager*>(dataTableManager_)->setNewRowDataListener(newRowDataListener_);
+    updateNewRowDataListener_();
 }
 
 void MemoryDataStore::removeNewUpdatesListener(NewUpdatesListenerPtr callback)
@@ -3858,7 +5186,14 @@ void MemoryDataStore::removeNewUpdatesListener(NewUpdatesListenerPtr callback)
 
   // If clearing out the updates listener, then also clear out the memory table's listener for performance
   if (newUpdatesListeners_.empty())
-    static_cast<MemoryTable::TableManager*>(dataTableManager_)->setNewRowDataListener({});
+    updateNewRowDataListener_();
+}
+
+void MemoryDataStore::updateNewRowDataListener_()
+{
+  // The memory budget also listens for new rows, to know which owners to measure again
+  const bool listen = !newUpdatesListeners_.empty() || (memoryBudget_ != 0);
+  static_cast<MemoryTable::TableManager*>(dataTableManager_)->setNewRowDataListener(listen ? newRowDataListener_ : MemoryTable::TableManager::NewRowDataListenerPtr());
 }
 
 CategoryNameManager& MemoryDataStore::categoryNameManager() const
@@ -4138,8 +5473,10 @@ void MemoryDataStore::NewEntryTransactionImpl<T, P>::commit()
       delete i->second;
       i->second = entry_;
     }
+    store_->initUpdateSlice_(entry_->updates());
     MemoryGenericDataSlice *genericData = dynamic_cast<MemoryGenericDataSlice *>(entry_->genericData());
     assert(genericData);
+    genericData->setStringArena(store_->genericStringArena_);
     store_->genericData_[entry_->properties()->id()] = genericData;
 
     MemoryCategoryDataSlice *categoryData = dynamic_cast<MemoryCategoryDataSlice *>(entry_->categoryData());
@@ -4203,6 +5540,7 @@ void MemoryDataStore::NewUpdateTransactionImpl<T, SliceType>::commit()
     // need to grab time here, since update_ object may be deleted in the following insert call
     double updateTime = update_->time();
     insert_();
+    dataStore_->memoryChanged_(id_);
     // this applies data limiting to all implementations of the DataSlice
     // e.g. MemoryDataSlice, MemoryCommandSlice, MemoryGenericDataSlice, MemoryCategoryDataSlice, etc.
     if (dataStore_->dataLimiting())
@@ -4266,6 +5604,7 @@ void MemoryDataStore::NewScenarioGenericUpdateTransactionImpl<T, SliceType>::com
     committed_ = true;
     // Sorted insert
     slice_->insert(update_, dataStore_->dataLimiting() && dataStore_->properties_.ignoreduplicategenericdata());
+    dataStore_->memoryChanged_(0);
     if (dataStore_->dataLimiting())
     {
       Transaction t;
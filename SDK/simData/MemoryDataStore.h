@@ -23,18 +23,28 @@
 #ifndef SIMDATA_MEMORYDATASTORE_H
 #define SIMDATA_MEMORYDATASTORE_H
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "simData/IngestQueue.h"
 #include "simData/MemoryDataEntry.h"
+#include "simData/PlatformMemoryDataSlice.h"
 #include "simData/DataStore.h"
 
 namespace simCore { class Clock; }
 
 namespace simData {
 
+class CategoryValueIndex;
 class EntityNameCache;
 class GenericDataSlice;
 class MemoryCategoryDataSlice;
+class SpillFile;
+class StringArena;
 namespace MemoryTable { class DataLimitsProvider; }
 
 /** @brief Implementation of DataStore using plain memory
@@ -84,6 +94,122 @@ public:
   /// returns flag indicating if data limiting is set
   bool dataLimiting() const override;
 
+  /**
+  * Enables columnar storage of platform updates, which avoids a heap allocation per point.
+  * Applies to existing and future platforms.  With columnar storage, platform update
+  * pointers returned by slice iterators are copies owned by the slice; see PlatformMemoryDataSlice.
+  * @param[in] columnar True to use columnar storage
+  */
+  void setColumnarPlatformStorage(bool columnar);
+
+  /// returns flag indicating if platform updates use columnar storage
+  bool columnarPlatformStorage() const;
+
+  /**
+  * Enables compression of columnar platform storage with the given quantization, or disables it
+  * for nullptr.  Applies to existing and future platforms while columnar platform storage is on.
+  * Positions, angles and velocities are lossy within the quantization; see PlatformUpdateColumns::Compression.
+  * @param[in] compression Quantization settings, copied; nullptr to turn compression off
+  */
+  void setPlatformCompression(const PlatformUpdateColumns::Compression* compression);
+
+  /// returns the platform compression settings, or nullptr if platform updates are not compressed
+  const PlatformUpdateColumns::Compression* platformCompression() const;
+
+  /**
+  * Moves platform update history more than window seconds older than the current time into
+  * compressed blocks in a temporary file, keeping memory flat during long live runs.  Spilled
+  * history is read back when update() or a slice query reaches it.  Applies to existing and
+  * future platforms.  Platforms spilling history are not trimmed to meet the memory budget.
+  * @param[in] window Seconds of history kept in memory; 0 turns spilling off and reads back all history
+  * @param[in] directory Directory for the spill file, used when spilling is turned on; the system temporary directory if empty
+  * @return 0 on success, non-zero if the spill file cannot be created
+  */
+  int setHistorySpill(double window, const std::string& directory = "");
+
+  /// returns the seconds of platform history kept in memory, or 0 if history is not spilled
+  double historySpillWindow() const;
+
+  /**
+  * Maintains an index from category name and value to the entities holding that value,
+  * refreshed by update() for only the entities whose category values may have changed.
+  * Turning indexing on builds the index from the values as of the last update().
+  * @param[in] indexing True to maintain the index, false to discard it
+  */
+  void setCategoryValueIndexing(bool indexing);
+
+  /// returns the category value index as of the last update(), or nullptr if indexing is off
+  const CategoryValueIndex* categoryValueIndex() const;
+
+  /**
+  * Stores generic data keys and values of all entities in one shared, reference counted string
+  * arena, so that each distinct string is held once and is freed when flushing or data limiting
+  * removes its last use.  Applies to existing and future entities.  The arena's memory is
+  * reported in the scenario's memoryUsage(0).genericData.
+  * @param[in] interning True to intern generic data strings, false to pool values per key
+  */
+  void setGenericDataInterning(bool interning);
+
+  /// returns flag indicating if generic data strings are interned in a shared arena
+  bool genericDataInterning() const;
+
+  /**
+  * Sets the number of threads used by update() to update the entity slices.  Platforms, beams,
+  * gates, lasers and projectors are updated in parallel when there are at least
+  * parallelUpdateThreshold() entities of that type.  Hosts are updated before the beams and
+  * gates that depend on them, and listener callbacks are raised on the calling thread in the
+  * same order as a serial update.  The interpolator must be safe to call from multiple threads.
+  * The work runs on the process-wide worker threads of simCore::runRanges().
+  * @param[in] numThreads Number of threads including the calling thread; 0 or 1 updates serially
+  */
+  void setUpdateThreadCount(unsigned int numThreads);
+
+  /// returns the number of threads used by update(), 1 when updating serially
+  unsigned int updateThreadCount() const;
+
+  /// Sets the minimum number of entities of a type needed to update that type in parallel
+  void setParallelUpdateThreshold(size_t numEntities);
+
+  /// returns the minimum number of entities of a type needed to update that type in parallel
+  size_t parallelUpdateThreshold() const;
+
+  /**
+  * Queues a platform update for the given platform.  Unlike addPlatformUpdate(), the ingest
+  * methods may be called from any number of threads concurrently; records go into bounded
+  * lock-free queues and are inserted by drainIngestQueues(), which update() calls first.
+  * Records for entities that do not exist when drained are discarded.
+  * @param[in] id Platform that receives the update
+  * @param[in] update Update to insert; must have a time
+  * @return 0 on success, non-zero if the queue is full
+  */
+  int ingestPlatformUpdate(ObjectId id, const PlatformUpdate& update);
+  /// Queues a beam update for the given beam; see ingestPlatformUpdate()
+  int ingestBeamUpdate(ObjectId id, const BeamUpdate& update);
+  /// Queues a gate update for the given gate; see ingestPlatformUpdate()
+  int ingestGateUpdate(ObjectId id, const GateUpdate& update);
+  /// Queues category data for the given entity; see ingestPlatformUpdate()
+  int ingestCategoryData(ObjectId id, const CategoryData& data);
+  /// Queues generic data for the given entity, or the scenario for id 0; see ingestPlatformUpdate()
+  int ingestGenericData(ObjectId id, const GenericData& data);
+
+  /**
+  * Inserts the queued ingest records into their slices, sorted by entity and time so that
+  * each slice receives its records in one pass.  Must be called from the thread that owns
+  * the data store; update() calls it automatically.
+  * @return Number of records removed from the queues, including discarded records
+  */
+  size_t drainIngestQueues();
+
+  /**
+  * Sets the capacity of each ingest queue, rounded up to a power of two.  Queued records are
+  * drained first.  Must not be called while other threads are ingesting.
+  * @param[in] capacity Maximum number of records per entity type
+  */
+  void setIngestQueueCapacity(size_t capacity);
+
+  /// returns the capacity of each ingest queue
+  size_t ingestQueueCapacity() const;
+
   /// flush all the updates, command, category data and generic data for the specified id,
   /// if 0 is passed in flushes the entire scenario, except for static entities
   [[deprecated("Use flush(ObjectId, FlushScope, FlushFields) instead.")]]
@@ -139,6 +265,15 @@ public:
   /// Retrieve a list of IDs for objects of 'type' with the given name
   void idListByName(const std::string& name, IdList* ids, simData::ObjectType type = simData::ALL) const override;
 
+  /// Retrieve a list of IDs for objects of 'type' whose names start with the prefix, ordered by name
+  void idListByNamePrefix(const std::string& prefix, IdList* ids, simData::ObjectType type = simData::ALL, bool caseSensitive = true) const override;
+
+  /// Retrieve a list of IDs for objects of 'type' whose names contain the text
+  void idListByNameSubstring(const std::string& text, IdList* ids, simData::ObjectType type = simData::ALL, bool caseSensitive = true) const override;
+
+  /// Retrieve a list of IDs for objects of 'type' whose names match the regular expression
+  void idListByNameRegExp(const RegExpFilter& regExp, IdList* ids, simData::ObjectType type = simData::ALL) const override;
+
   /// Retrieve a list of IDs for objects with the given original id
   void idListByOriginalId(IdList *ids, uint64_t originalId, simData::ObjectType type = simData::ALL) const override;
 
@@ -282,6 +417,10 @@ public:
   CustomRenderingCommand *addCustomRenderingCommand(ObjectId id, Transaction *transaction) override;
   GenericData *addGenericData(ObjectId id, Transaction *transaction) override;
   CategoryData *addCategoryData(ObjectId id, Transaction *transaction) override;
+
+  int addPlatformUpdates(ObjectId id, std::span<const PlatformUpdate> updates) override;
+  int addBeamUpdates(ObjectId id, std::span<const BeamUpdate> updates) override;
+  int addGateUpdates(ObjectId id, std::span<const GateUpdate> updates) override;
   ///@}
 
   /**@name Retrieving read-only data slices
@@ -363,6 +502,90 @@ public:
    */
   DataTableManager& dataTableManager() const override;
 
+  /**@name Binary snapshots
+   * A snapshot holds the scenario properties, the default preferences, every entity with
+   * its properties, preferences, updates, commands, category data and generic data, and
+   * the data tables.  Restoring a snapshot is much faster than repeating the original
+   * transactions: the file is memory mapped, updates are stored as columns and inserted
+   * in batches, and entities keep their IDs.  Fields are stored by name, so a snapshot
+   * remains readable when fields are added in later versions.
+   * @{
+   */
+  /// Version of the snapshot format written by saveSnapshot()
+  static constexpr uint32_t SNAPSHOT_VERSION = 1;
+  /**
+   * Writes the contents of the data store to a snapshot file
+   * @param filename File to write, replaced if it exists
+   * @return 0 on success, non-zero on error
+   */
+  int saveSnapshot(const std::string& filename) const;
+  /**
+   * Restores a snapshot written by saveSnapshot().  Listeners are notified as the
+   * entities are added.
+   * @param filename File to read
+   * @return 0 on success, non-zero if the data store has entities or data tables, or if the
+   *   file cannot be read; on a read error the entities restored before the error remain
+   */
+  int loadSnapshot(const std::string& filename);
+  ///@}
+
+  /**@name Memory budget
+   * A memory budget bounds the data held by the whole data store, rather than by each entity
+   * as the data limiting preferences do.  When a budget is set, update() totals the bytes of
+   * every update, command, category data and generic data slice and of every data table, and
+   * while the total is over the budget it removes the oldest update points and table rows across
+   * all entities, always keeping the most recent point of each slice and table.  Commands,
+   * category data and generic data count toward the total but are never removed, since later
+   * states depend on them.  Byte counts are estimated from item counts and sizes.
+   * @{
+   */
+  /// Estimated bytes held for an entity, or for the scenario
+  struct MemoryUsage
+  {
+    /// Entity ID, or 0 for the scenario
+    ObjectId id = 0;
+    /// Entity type, or NONE for the scenario
+    ObjectType type = NONE;
+    size_t updates = 0;      ///< Update slice
+    size_t commands = 0;     ///< Command slice
+    size_t categoryData = 0; ///< Category data slice
+    size_t genericData = 0;  ///< Generic data slice
+    size_t dataTables = 0;   ///< Data tables owned by the entity or scenario
+    /// Sum of the bytes
+    size_t total() const { return updates + commands + categoryData + genericData + dataTables; }
+  };
+
+  /// Memory use of the data store and the data removed to meet the budget
+  struct MemoryStatistics
+  {
+    size_t budget = 0;        ///< Budget in bytes; 0 for no budget
+    size_t totalBytes = 0;    ///< Estimated bytes held by the scenario and all entities
+    std::vector<MemoryUsage> usage; ///< Scenario and each entity, largest total first
+    size_t evictions = 0;     ///< Number of times data was removed to meet the budget
+    size_t evictedPoints = 0; ///< Update points and table rows removed
+    size_t evictedBytes = 0;  ///< Estimated bytes removed
+  };
+
+  /** Sets the memory budget in bytes, enforced by update(); 0, the default, for no budget */
+  void setMemoryBudget(size_t bytes);
+  /** Returns the memory budget in bytes; 0 for no budget */
+  size_t memoryBudget() const;
+  /** Returns the estimated memory use of an entity, or of the scenario for ID 0 */
+  MemoryUsage memoryUsage(ObjectId id) const;
+  /** Returns the estimated memory use of everything in the data store */
+  MemoryStatistics memoryStatistics() const;
+  /**
+   * Removes the oldest update points and table rows until the data store is within the budget;
+   * called by update(), but can be called directly after a large load.  The data store keeps a
+   * running total of its estimated bytes, measuring only the entities whose data changed since
+   * the last call, and looks for data to remove only when that total is over the budget.
+   * Platforms that spill their history to disk keep only their spill window in memory, so their
+   * points count toward the budget but are not removed to meet it.
+   * @return Estimated number of bytes removed
+   */
+  size_t enforceMemoryBudget();
+  ///@}
+
 protected:
   /// generate a unique id
   ObjectId genUniqueId_();
@@ -370,6 +593,8 @@ protected:
 
 private:
   class NewRowDataToNewUpdatesAdapter;
+  /// Writes and reads snapshot files
+  class Snapshot;
 
   /// delete all entries in a map
   template <typename EntryMapType>
@@ -382,6 +607,41 @@ private:
   void dataLimit_(std::map<ObjectId, EntryMapType*>& entryMap, ObjectId id, const CommonPrefs* prefs);
   ///@}
 
+  /// Applies data store settings to the update slice of a new entity; no-op for most types
+  template <typename SliceType>
+  void initUpdateSlice_(SliceType* slice) {}
+  /// Applies the columnar storage, compression and history spill settings to the update slice of a new platform
+  void initUpdateSlice_(PlatformMemoryDataSlice* slice);
+
+  /// Returns true if numEntities entities of a type should be updated in parallel
+  bool useUpdatePool_(size_t numEntities) const;
+  /// Queues for the ingest methods
+  struct IngestQueues;
+  /// Returns the ingest queues, creating them if needed; thread safe
+  IngestQueues* ingestQueuesForPush_();
+  /// Inserts the queued records of one type into their slices; returns the number of records drained
+  template <typename EntryType, typename EntryMapType, typename UpdateType>
+  size_t drainUpdates_(IngestQueue<IngestRecord<UpdateType> >& queue, const EntryMapType& entries, bool isEntityUpdate);
+  /// Applies data limiting to the slice after a batch of data is added
+  template <typename SliceType>
+  void applyDataLimits_(ObjectId id, SliceType* slice);
+  /// Adds a batch of updates to the slice of an entity; returns 0 on success
+  template <typename EntryType, typename EntryMapType, typename UpdateType>
+  int addUpdates_(ObjectId id, const EntryMapType& entries, std::span<const UpdateType> updates);
+
+  /// Marks the data of an entity, or of the scenario for ID 0, as changed so the memory budget measures it again
+  void memoryChanged_(ObjectId id);
+  /// Forgets all measurements, so the memory budget measures the scenario and every entity again
+  void resetMemoryTotals_();
+  /// Measures the entities whose data changed, bringing memoryTotal_ up to date
+  void measureChangedMemory_();
+  /// Sets the table manager's new row listener when there are new update listeners or a memory budget
+  void updateNewRowDataListener_();
+
+  /// Calls fn(id, entry) for each (id, entry) pair of the map or vector, in parallel if useUpdatePool_() allows
+  template <typename EntryMapType, typename Function>
+  void forEachEntry_(EntryMapType& entries, const Function& fn);
+
   /// Execute the onPostRemoveEntity callback
   void fireOnPostRemoveEntity_(ObjectId id, ObjectType ot);
 
@@ -396,8 +656,8 @@ private:
 public:
   // Types for SIMDIS
 
-  /// PlatformEntry uses its own PlatformMemoryCommandSlice instead of a template MemoryCommandSlice
-  typedef MemoryDataEntry<PlatformProperties, PlatformPrefs, MemoryDataSlice<PlatformUpdate>,    MemoryCommandSlice<PlatformCommand, PlatformPrefs> >  PlatformEntry;
+  /// PlatformEntry uses its own PlatformMemoryDataSlice instead of a template MemoryDataSlice
+  typedef MemoryDataEntry<PlatformProperties, PlatformPrefs, PlatformMemoryDataSlice,            MemoryCommandSlice<PlatformCommand, PlatformPrefs> >  PlatformEntry;
   /// BeamEntry;  note that it uses a BeamMemoryCommandSlice instead of a template MemoryCommandSlice
   typedef MemoryDataEntry<BeamProperties,      BeamPrefs,      MemoryDataSlice<BeamUpdate>,      BeamMemoryCommandSlice >      BeamEntry;
   /// GateEntry
@@ -785,6 +1045,34 @@ private:
   std::vector<NewUpdatesListenerPtr> newUpdatesListeners_;
   /// Flag indicating if data limiting is set
   bool dataLimiting_;
+  /// Flag indicating if platform updates use columnar storage
+  bool columnarPlatformStorage_ = false;
+  /// Quantization of compressed platform updates; nullptr when platform updates are not compressed
+  std::unique_ptr<PlatformUpdateColumns::Compression> platformCompression_;
+  /// File receiving spilled platform history; nullptr when history is not spilled
+  std::shared_ptr<SpillFile> spillFile_;
+  /// Seconds of platform history kept in memory when spilling
+  double spillWindow_ = 0.0;
+  /// Shared generic data strings; nullptr when each generic data key pools its own values
+  std::shared_ptr<StringArena> genericStringArena_;
+  /// Memory budget in bytes; 0 for no budget
+  size_t memoryBudget_ = 0;
+  /// Running totals of the data removed to meet the memory budget
+  MemoryStatistics evictionTotals_;
+  /// Last measured bytes of the scenario and of each entity with data; only kept while there is a budget
+  std::unordered_map<ObjectId, size_t> memoryBytes_;
+  /// Scenario and entities whose data changed since they were last measured
+  std::unordered_set<ObjectId> memoryChangedIds_;
+  /// Sum of memoryBytes_
+  size_t memoryTotal_ = 0;
+  /// Number of ranges the entity slice updates are split into for simCore::runRanges(); 1 when updating serially
+  unsigned int updateThreadCount_ = 1;
+  /// Minimum number of entities of a type needed to update that type in parallel
+  size_t parallelUpdateThreshold_;
+  /// Queues for the ingest methods, one per type of record; created by the first ingest
+  std::atomic<IngestQueues*> ingestQueues_ = nullptr;
+  /// Capacity of each ingest queue
+  size_t ingestQueueCapacity_;
   /// The CategoryNameManager coordinates string/int values
   CategoryNameManager* categoryNameManager_;
   /// Correlates data store preferences to limit values for the table manager
@@ -0,0 +1,1538 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "simData/CategoryData/MemoryCategoryDataSlice.h"
+#include "simData/DataTable.h"
+#include "simData/DataTypeReflection.h"
+#include "simData/MemoryDataStore.h"
+
+namespace simData
+{
+
+namespace
+{
+
+/// Identifies a snapshot file
+const char SNAPSHOT_MAGIC[8] = { 'S', 'I', 'M', 'D', 'S', 'N', 'A', 'P' };
+/// Written as a native integer to reject files written with a different byte order
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+/// Number of entity types with entries in the data store
+const size_t NUM_ENTITY_TYPES = 7;
+
+/// Index of the entity type, used to order the field list kinds; NUM_ENTITY_TYPES for unknown types
+size_t entityTypeIndex(ObjectType type)
+{
+  switch (type)
+  {
+  case PLATFORM: return 0;
+  case BEAM: return 1;
+  case GATE: return 2;
+  case LASER: return 3;
+  case PROJECTOR: return 4;
+  case LOB_GROUP: return 5;
+  case CUSTOM_RENDERING: return 6;
+  case NONE:
+  case ALL:
+    break;
+  }
+  return NUM_ENTITY_TYPES;
+}
+
+/// Field lists written with reflection; the values are part of the file format
+enum FieldListKind : uint32_t
+{
+  SCENARIO_PROPERTIES = 0,
+  /// Followed by the properties of the other entity types, in entityTypeIndex() order
+  PLATFORM_PROPERTIES = 1,
+  PLATFORM_PREFS = PLATFORM_PROPERTIES + NUM_ENTITY_TYPES,
+  PLATFORM_COMMANDS = PLATFORM_PREFS + NUM_ENTITY_TYPES,
+  NUM_FIELD_LIST_KINDS = PLATFORM_COMMANDS + NUM_ENTITY_TYPES
+};
+
+/// Returns the reflection for the field list kind
+std::unique_ptr<Reflection> makeReflection(uint32_t kind)
+{
+  typedef std::unique_ptr<Reflection>(*MakeFunction)();
+  static const MakeFunction PROPERTIES[NUM_ENTITY_TYPES] = {
+    &Reflection::makePlatformProperty, &Reflection::makeBeamProperty, &Reflection::makeGateProperty, &Reflection::makeLaserProperty,
+    &Reflection::makeProjectorProperty, &Reflection::makeLobGroupProperty, &Reflection::makeCustomRenderingProperty };
+  static const MakeFunction PREFS[NUM_ENTITY_TYPES] = {
+    &Reflection::makePlatformPreferences, &Reflection::makeBeamPreferences, &Reflection::makeGatePreferences, &Reflection::makeLaserPreferences,
+    &Reflection::makeProjectorPreferences, &Reflection::makeLobGroupPreferences, &Reflection::makeCustomRenderingPreferences };
+  static const MakeFunction COMMANDS[NUM_ENTITY_TYPES] = {
+    &Reflection::makePlatformCommands, &Reflection::makeBeamCommands, &Reflection::makeGateCommands, &Reflection::makeLaserCommands,
+    &Reflection::makeProjectorCommands, &Reflection::makeLobGroupCommands, &Reflection::makeCustomRenderingCommands };
+
+  if (kind == SCENARIO_PROPERTIES)
+    return Reflection::makeScenarioProperty();
+  if (kind < PLATFORM_PREFS)
+    return PROPERTIES[kind - PLATFORM_PROPERTIES]();
+  if (kind < PLATFORM_COMMANDS)
+    return PREFS[kind - PLATFORM_PREFS]();
+  if (kind < NUM_FIELD_LIST_KINDS)
+    return COMMANDS[kind - PLATFORM_COMMANDS]();
+  return nullptr;
+}
+
+//----------------------------------------------------------------------------
+
+/// Read only memory mapping of a whole file
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::string& filename)
+  {
+#ifdef WIN32
+    file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+      return;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0)
+      return;
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr)
+      return;
+    void* data = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr)
+      return;
+    data_ = static_cast<const char*>(data);
+    size_ = static_cast<size_t>(size.QuadPart);
+#else
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+      void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED)
+      {
+        // The snapshot is read front to back
+        madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(data);
+        size_ = static_cast<size_t>(info.st_size);
+      }
+    }
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+#endif
+  }
+
+  ~MappedFile()
+  {
+#ifdef WIN32
+    if (data_)
+      UnmapViewOfFile(data_);
+    if (mapping_)
+      CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE)
+      CloseHandle(file_);
+#else
+    if (data_)
+      munmap(const_cast<char*>(data_), size_);
+#endif
+  }
+
+  SDK_DISABLE_COPY_MOVE(MappedFile);
+
+  /// Contents of the file; nullptr if the file could not be mapped
+  const char* data() const { return data_; }
+  /// Size of the file in bytes
+  size_t size() const { return size_; }
+
+private:
+#ifdef WIN32
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = nullptr;
+#endif
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+/// Writes the primitive values of a snapshot
+class SnapshotWriter
+{
+public:
+  explicit SnapshotWriter(const std::string& filename)
+    : out_(filename, std::ios::out | std::ios::binary | std::ios::trunc)
+  {
+  }
+
+  /// Returns true if all writes succeeded
+  bool ok() const { return out_.good(); }
+
+  /// Writes the bytes of a trivially copyable value
+  template <typename T>
+  void write(const T& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written");
+    out_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  /// Writes the length and characters of the string
+  void writeString(const std::string& value)
+  {
+    write<uint32_t>(static_cast<uint32_t>(value.size()));
+    out_.write(value.data(), value.size());
+  }
+
+  /// Writes the values without a length
+  template <typename T>
+  void writeArray(const std::vector<T>& values)
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written");
+    out_.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+  }
+
+  /// Flushes the file; returns true on success
+  bool close()
+  {
+    out_.close();
+    return !out_.fail();
+  }
+
+private:
+  std::ofstream out_;
+};
+
+/// Reads the primitive values of a snapshot from memory; reads past the end fail and set ok() to false
+class SnapshotReader
+{
+public:
+  SnapshotReader(const char* data, size_t size)
+    : pos_(data),
+      end_(data + size)
+  {
+  }
+
+  /// Returns true if all reads succeeded
+  bool ok() const { return ok_; }
+
+  /// Number of bytes left to read
+  size_t remaining() const { return static_cast<size_t>(end_ - pos_); }
+
+  /// Returns a pointer to the next count items of the given size and skips them; nullptr on error
+  const char* take(uint64_t count, size_t itemSize)
+  {
+    if (!ok_ || (itemSize != 0 && count > remaining() / itemSize))
+    {
+      ok_ = false;
+      return nullptr;
+    }
+    const char* rv = pos_;
+    pos_ += count * itemSize;
+    return rv;
+  }
+
+  /// Reads a trivially copyable value; returns true on success
+  template <typename T>
+  bool read(T& value)
+  {
+    const char* bytes = take(1, sizeof(T));
+    if (!bytes)
+      return false;
+    std::memcpy(&value, bytes, sizeof(T));
+    return true;
+  }
+
+  /// Reads a value written by SnapshotWriter::writeString(); returns true on success
+  bool readString(std::string& value)
+  {
+    uint32_t length = 0;
+    if (!read(length))
+      return false;
+    const char* bytes = take(length, 1);
+    if (!bytes)
+      return false;
+    value.assign(bytes, length);
+    return true;
+  }
+
+  /// Returns item index of an array of T returned by take()
+  template <typename T>
+  static T item(const char* array, size_t index)
+  {
+    T value;
+    std::memcpy(&value, array + index * sizeof(T), sizeof(T));
+    return value;
+  }
+
+private:
+  const char* pos_;
+  const char* end_;
+  bool ok_ = true;
+};
+
+//----------------------------------------------------------------------------
+
+/// Field paths of a field list kind, in the order written to the file
+class FieldListSchema
+{
+public:
+  explicit FieldListSchema(uint32_t kind)
+    : reflection_(makeReflection(kind))
+  {
+    reflection_->reflection("", [this](const std::string& path, ReflectionDataType type) {
+      fields_.emplace_back(path, type);
+    });
+  }
+
+  /// Reflection for the field list
+  const Reflection& reflection() const { return *reflection_; }
+  /// Path and type of each field
+  const std::vector<std::pair<std::string, ReflectionDataType> >& fields() const { return fields_; }
+
+private:
+  std::unique_ptr<Reflection> reflection_;
+  std::vector<std::pair<std::string, ReflectionDataType> > fields_;
+};
+
+/// Writes the value in the encoding for its type
+void writeValue(SnapshotWriter& out, const ReflectionValue& value)
+{
+  switch (value.type())
+  {
+  case ReflectionDataType::Boolean:
+    out.write<uint8_t>(value.getBoolean() ? 1 : 0);
+    break;
+  case ReflectionDataType::Int32:
+  case ReflectionDataType::Enumeration:
+    out.write<int32_t>(value.getInt32());
+    break;
+  case ReflectionDataType::Uint32:
+    out.write<uint32_t>(value.getUint32());
+    break;
+  case ReflectionDataType::Uint64:
+    out.write<uint64_t>(value.getUint64());
+    break;
+  case ReflectionDataType::Float:
+    out.write<float>(value.getFloat());
+    break;
+  case ReflectionDataType::Double:
+    out.write<double>(value.getDouble());
+    break;
+  case ReflectionDataType::String:
+    out.writeString(value.getString());
+    break;
+  case ReflectionDataType::StringVector:
+  {
+    const auto strings = value.getStrings();
+    out.write<uint32_t>(static_cast<uint32_t>(strings.size()));
+    for (const auto& string : strings)
+      out.writeString(string);
+    break;
+  }
+  case ReflectionDataType::IdVector:
+  {
+    const auto ids = value.getIds();
+    out.write<uint32_t>(static_cast<uint32_t>(ids.size()));
+    out.writeArray(ids);
+    break;
+  }
+  case ReflectionDataType::Unknown:
+    break;
+  }
+}
+
+/// Reads a value written by writeValue(); returns empty on error
+std::optional<ReflectionValue> readValue(SnapshotReader& in, ReflectionDataType type)
+{
+  switch (type)
+  {
+  case ReflectionDataType::Boolean:
+  {
+    uint8_t value = 0;
+    if (in.read(value))
+      return ReflectionValue(value != 0);
+    break;
+  }
+  case ReflectionDataType::Int32:
+  case ReflectionDataType::Enumeration:
+  {
+    int32_t value = 0;
+    if (in.read(value))
+      return ReflectionValue(value);
+    break;
+  }
+  case ReflectionDataType::Uint32:
+  {
+    uint32_t value = 0;
+    if (in.read(value))
+      return ReflectionValue(value);
+    break;
+  }
+  case ReflectionDataType::Uint64:
+  {
+    uint64_t value = 0;
+    if (in.read(value))
+      return ReflectionValue(value);
+    break;
+  }
+  case ReflectionDataType::Float:
+  {
+    float value = 0.f;
+    if (in.read(value))
+      return ReflectionValue(value);
+    break;
+  }
+  case ReflectionDataType::Double:
+  {
+    double value = 0.0;
+    if (in.read(value))
+      return ReflectionValue(value);
+    break;
+  }
+  case ReflectionDataType::String:
+  {
+    std::string value;
+    if (in.readString(value))
+      return ReflectionValue(value);
+    break;
+  }
+  case ReflectionDataType::StringVector:
+  {
+    uint32_t count = 0;
+    if (!in.read(count))
+      break;
+    std::vector<std::string> values(std::min<size_t>(count, in.remaining()));
+    for (auto& value : values)
+      in.readString(value);
+    if (in.ok() && values.size() == count)
+      return ReflectionValue(values);
+    break;
+  }
+  case ReflectionDataType::IdVector:
+  {
+    uint32_t count = 0;
+    if (!in.read(count))
+      break;
+    const char* ids = in.take(count, sizeof(uint64_t));
+    if (!ids)
+      break;
+    std::vector<uint64_t> values(count);
+    std::memcpy(values.data(), ids, count * sizeof(uint64_t));
+    return ReflectionValue(values);
+  }
+  case ReflectionDataType::Unknown:
+    break;
+  }
+  return {};
+}
+
+/// Writes the fields that are set as (field index, type, value) triples
+void writeFieldList(SnapshotWriter& out, const FieldListSchema& schema, const FieldList& fields)
+{
+  std::vector<std::pair<uint32_t, ReflectionValue> > values;
+  const auto& paths = schema.fields();
+  for (size_t ii = 0; ii < paths.size(); ++ii)
+  {
+    auto value = schema.reflection().getValue(&fields, paths[ii].first);
+    if (value.has_value())
+      values.emplace_back(static_cast<uint32_t>(ii), std::move(*value));
+  }
+
+  out.write<uint32_t>(static_cast<uint32_t>(values.size()));
+  for (const auto& [index, value] : values)
+  {
+    out.write<uint32_t>(index);
+    out.write<uint8_t>(static_cast<uint8_t>(value.type()));
+    writeValue(out, value);
+  }
+}
+
+/// Field paths of a field list kind as written in the file, matched to the fields known to this version
+class LoadedFieldList
+{
+public:
+  LoadedFieldList() = default;
+  SDK_DISABLE_COPY_MOVE(LoadedFieldList);
+
+  /// Reads the paths for the kind from the file; returns 0 on success
+  int read(SnapshotReader& in, uint32_t kind)
+  {
+    schema_ = std::make_unique<FieldListSchema>(kind);
+    std::map<std::string, ReflectionDataType> known(schema_->fields().begin(), schema_->fields().end());
+
+    uint32_t count = 0;
+    if (!in.read(count))
+      return 1;
+    paths_.clear();
+    for (uint32_t ii = 0; ii < count && in.ok(); ++ii)
+    {
+      std::string path;
+      uint8_t type = 0;
+      in.readString(path);
+      in.read(type);
+      // Fields removed or changed in later versions are read and dropped
+      auto it = known.find(path);
+      if (it == known.end() || static_cast<uint8_t>(it->second) != type)
+        path.clear();
+      paths_.push_back(path);
+    }
+    return in.ok() ? 0 : 1;
+  }
+
+  /// Reads a field list written by writeFieldList() into fields; returns 0 on success
+  int readFields(SnapshotReader& in, FieldList& fields) const
+  {
+    if (!schema_)
+      return 1;
+    uint32_t count = 0;
+    if (!in.read(count))
+      return 1;
+    for (uint32_t ii = 0; ii < count; ++ii)
+    {
+      uint32_t index = 0;
+      uint8_t type = 0;
+      if (!in.read(index) || !in.read(type))
+        return 1;
+      auto value = readValue(in, static_cast<ReflectionDataType>(type));
+      if (!value.has_value())
+        return 1;
+      if (index < paths_.size() && !paths_[index].empty())
+        schema_->reflection().setValue(&fields, *value, paths_[index]);
+    }
+    return 0;
+  }
+
+private:
+  std::unique_ptr<FieldListSchema> schema_;
+  /// Path for each field index in the file; empty for fields unknown to this version
+  std::vector<std::string> paths_;
+};
+
+//----------------------------------------------------------------------------
+
+/// Optional double field of an update type
+template <typename T>
+struct UpdateField
+{
+  bool (T::*has)() const;
+  double (T::*get)() const;
+  void (T::*set)(double);
+  /// True if the field holds a float
+  bool isFloat;
+};
+
+/// Returns the fields of the update type other than time, in file order
+template <typename T>
+std::span<const UpdateField<T> > updateFields();
+
+template <>
+std::span<const UpdateField<PlatformUpdate> > updateFields<PlatformUpdate>()
+{
+  static const UpdateField<PlatformUpdate> FIELDS[] = {
+    { &PlatformUpdate::has_x, &PlatformUpdate::x, &PlatformUpdate::set_x, false },
+    { &PlatformUpdate::has_y, &PlatformUpdate::y, &PlatformUpdate::set_y, false },
+    { &PlatformUpdate::has_z, &PlatformUpdate::z, &PlatformUpdate::set_z, false },
+    { &PlatformUpdate::has_psi, &PlatformUpdate::psi, &PlatformUpdate::set_psi, true },
+    { &PlatformUpdate::has_theta, &PlatformUpdate::theta, &PlatformUpdate::set_theta, true },
+    { &PlatformUpdate::has_phi, &PlatformUpdate::phi, &PlatformUpdate::set_phi, true },
+    { &PlatformUpdate::has_vx, &PlatformUpdate::vx, &PlatformUpdate::set_vx, true },
+    { &PlatformUpdate::has_vy, &PlatformUpdate::vy, &PlatformUpdate::set_vy, true },
+    { &PlatformUpdate::has_vz, &PlatformUpdate::vz, &PlatformUpdate::set_vz, true }
+  };
+  return FIELDS;
+}
+
+template <>
+std::span<const UpdateField<BeamUpdate> > updateFields<BeamUpdate>()
+{
+  static const UpdateField<BeamUpdate> FIELDS[] = {
+    { &BeamUpdate::has_range, &BeamUpdate::range, &BeamUpdate::set_range, false },
+    { &BeamUpdate::has_azimuth, &BeamUpdate::azimuth, &BeamUpdate::set_azimuth, false },
+    { &BeamUpdate::has_elevation, &BeamUpdate::elevation, &BeamUpdate::set_elevation, false }
+  };
+  return FIELDS;
+}
+
+template <>
+std::span<const UpdateField<GateUpdate> > updateFields<GateUpdate>()
+{
+  static const UpdateField<GateUpdate> FIELDS[] = {
+    { &GateUpdate::has_azimuth, &GateUpdate::azimuth, &GateUpdate::set_azimuth, false },
+    { &GateUpdate::has_elevation, &GateUpdate::elevation, &GateUpdate::set_elevation, false },
+    { &GateUpdate::has_width, &GateUpdate::width, &GateUpdate::set_width, false },
+    { &GateUpdate::has_height, &GateUpdate::height, &GateUpdate::set_height, false },
+    { &GateUpdate::has_minrange, &GateUpdate::minrange, &GateUpdate::set_minrange, false },
+    { &GateUpdate::has_maxrange, &GateUpdate::maxrange, &GateUpdate::set_maxrange, false },
+    { &GateUpdate::has_centroid, &GateUpdate::centroid, &GateUpdate::set_centroid, false }
+  };
+  return FIELDS;
+}
+
+template <>
+std::span<const UpdateField<LaserUpdate> > updateFields<LaserUpdate>()
+{
+  static const UpdateField<LaserUpdate> FIELDS[] = {
+    { &LaserUpdate::has_yaw, &LaserUpdate::yaw, &LaserUpdate::set_yaw, false },
+    { &LaserUpdate::has_pitch, &LaserUpdate::pitch, &LaserUpdate::set_pitch, false },
+    { &LaserUpdate::has_roll, &LaserUpdate::roll, &LaserUpdate::set_roll, false }
+  };
+  return FIELDS;
+}
+
+template <>
+std::span<const UpdateField<ProjectorUpdate> > updateFields<ProjectorUpdate>()
+{
+  static const UpdateField<ProjectorUpdate> FIELDS[] = {
+    { &ProjectorUpdate::has_fov, &ProjectorUpdate::fov, &ProjectorUpdate::set_fov, false },
+    { &ProjectorUpdate::has_hfov, &ProjectorUpdate::hfov, &ProjectorUpdate::set_hfov, false }
+  };
+  return FIELDS;
+}
+
+template <>
+std::span<const UpdateField<CustomRenderingUpdate> > updateFields<CustomRenderingUpdate>()
+{
+  return {};
+}
+
+/// Presence of a column of update values
+enum ColumnPresence : uint8_t
+{
+  /// No update has the field; no values follow
+  COLUMN_NONE = 0,
+  /// Every update has the field; one value per update follows
+  COLUMN_ALL,
+  /// One presence byte per update follows, then one value per update with the field
+  COLUMN_SOME
+};
+
+/// Writes the values of one field of the updates as a column
+template <typename T, typename ValueType>
+void writeColumn(SnapshotWriter& out, const std::vector<T>& updates, const UpdateField<T>& field)
+{
+  std::vector<uint8_t> present(updates.size());
+  std::vector<ValueType> values;
+  values.reserve(updates.size());
+  for (size_t ii = 0; ii < updates.size(); ++ii)
+  {
+    if ((updates[ii].*field.has)())
+    {
+      present[ii] = 1;
+      values.push_back(static_cast<ValueType>((updates[ii].*field.get)()));
+    }
+  }
+
+  if (values.empty())
+  {
+    out.write<uint8_t>(COLUMN_NONE);
+    return;
+  }
+  out.write<uint8_t>(values.size() == updates.size() ? COLUMN_ALL : COLUMN_SOME);
+  if (values.size() != updates.size())
+    out.writeArray(present);
+  out.writeArray(values);
+}
+
+/// Writes the updates as columns: the times, then one column per field
+template <typename T>
+void writeUpdates(SnapshotWriter& out, const std::vector<T>& updates)
+{
+  out.write<uint64_t>(updates.size());
+  std::vector<double> times;
+  times.reserve(updates.size());
+  for (const auto& update : updates)
+    times.push_back(update.time());
+  out.writeArray(times);
+
+  const auto fields = updateFields<T>();
+  out.write<uint8_t>(static_cast<uint8_t>(fields.size()));
+  for (const auto& field : fields)
+  {
+    out.write<uint8_t>(field.isFloat ? sizeof(float) : sizeof(double));
+    if (field.isFloat)
+      writeColumn<T, float>(out, updates, field);
+    else
+      writeColumn<T, double>(out, updates, field);
+  }
+}
+
+/// Reads updates written by writeUpdates(); returns 0 on success
+template <typename T>
+int readUpdates(SnapshotReader& in, std::vector<T>& updates)
+{
+  uint64_t count = 0;
+  in.read(count);
+  const char* times = in.take(count, sizeof(double));
+  if (!times)
+    return 1;
+  updates.resize(count);
+  for (size_t ii = 0; ii < count; ++ii)
+    updates[ii].set_time(SnapshotReader::item<double>(times, ii));
+
+  const auto fields = updateFields<T>();
+  uint8_t numFields = 0;
+  in.read(numFields);
+  for (uint8_t fieldIndex = 0; fieldIndex < numFields && in.ok(); ++fieldIndex)
+  {
+    uint8_t width = 0;
+    uint8_t presence = COLUMN_NONE;
+    in.read(width);
+    in.read(presence);
+    if (presence == COLUMN_NONE)
+      continue;
+    const char* present = (presence == COLUMN_SOME) ? in.take(count, 1) : nullptr;
+    size_t numValues = count;
+    if (present)
+      numValues = std::count_if(present, present + count, [](char flag) { return flag != 0; });
+    const char* values = in.take(numValues, width);
+    if (!values)
+      return 1;
+
+    // Columns added by later versions are skipped
+    if (fieldIndex >= fields.size())
+      continue;
+    const UpdateField<T>& field = fields[fieldIndex];
+    if (width != (field.isFloat ? sizeof(float) : sizeof(double)))
+      return 1;
+    size_t valueIndex = 0;
+    for (size_t ii = 0; ii < count; ++ii)
+    {
+      if (present && !present[ii])
+        continue;
+      const double value = field.isFloat ? SnapshotReader::item<float>(values, valueIndex) : SnapshotReader::item<double>(values, valueIndex);
+      (updates[ii].*field.set)(value);
+      ++valueIndex;
+    }
+  }
+  return in.ok() ? 0 : 1;
+}
+
+/// Bits of the presence mask of a LobGroupUpdatePoint
+enum LobPointBits : uint8_t
+{
+  LOB_TIME = 1 << 0,
+  LOB_RANGE = 1 << 1,
+  LOB_AZIMUTH = 1 << 2,
+  LOB_ELEVATION = 1 << 3
+};
+
+/// LOB group updates hold a variable number of points, so they are written a row at a time
+template <>
+void writeUpdates<LobGroupUpdate>(SnapshotWriter& out, const std::vector<LobGroupUpdate>& updates)
+{
+  out.write<uint64_t>(updates.size());
+  for (const auto& update : updates)
+  {
+    out.write<double>(update.time());
+    out.write<uint32_t>(static_cast<uint32_t>(update.datapoints_size()));
+    for (const auto& point : update.datapoints())
+    {
+      const uint8_t mask = (point.has_time() ? LOB_TIME : 0) | (point.has_range() ? LOB_RANGE : 0) |
+        (point.has_azimuth() ? LOB_AZIMUTH : 0) | (point.has_elevation() ? LOB_ELEVATION : 0);
+      out.write<uint8_t>(mask);
+      if (mask & LOB_TIME)
+        out.write<double>(point.time());
+      if (mask & LOB_RANGE)
+        out.write<double>(point.range());
+      if (mask & LOB_AZIMUTH)
+        out.write<double>(point.azimuth());
+      if (mask & LOB_ELEVATION)
+        out.write<double>(point.elevation());
+    }
+  }
+}
+
+template <>
+int readUpdates<LobGroupUpdate>(SnapshotReader& in, std::vector<LobGroupUpdate>& updates)
+{
+  uint64_t count = 0;
+  in.read(count);
+  // Each update takes at least 12 bytes
+  if (count > in.remaining() / 12)
+    return 1;
+  updates.resize(count);
+  for (auto& update : updates)
+  {
+    double time = 0.0;
+    uint32_t numPoints = 0;
+    in.read(time);
+    in.read(numPoints);
+    if (!in.ok() || numPoints > in.remaining())
+      return 1;
+    update.set_time(time);
+    for (uint32_t ii = 0; ii < numPoints && in.ok(); ++ii)
+    {
+      LobGroupUpdatePoint* point = update.add_datapoints();
+      uint8_t mask = 0;
+      double value = 0.0;
+      in.read(mask);
+      if ((mask & LOB_TIME) && in.read(value))
+        point->set_time(value);
+      if ((mask & LOB_RANGE) && in.read(value))
+        point->set_range(value);
+      if ((mask & LOB_AZIMUTH) && in.read(value))
+        point->set_azimuth(value);
+      if ((mask & LOB_ELEVATION) && in.read(value))
+        point->set_elevation(value);
+    }
+  }
+  return in.ok() ? 0 : 1;
+}
+
+/// Copies every item of a slice
+template <typename T, typename VisitorType>
+class CopyVisitor : public VisitorType
+{
+public:
+  explicit CopyVisitor(std::vector<T>& items)
+    : items_(items)
+  {
+  }
+
+  void operator()(const T* item) override
+  {
+    items_.push_back(*item);
+  }
+
+private:
+  std::vector<T>& items_;
+};
+
+/// Returns copies of the items of the slice
+template <typename T>
+std::vector<T> sliceItems(const VisitableDataSlice<T>& slice)
+{
+  std::vector<T> items;
+  CopyVisitor<T, typename VisitableDataSlice<T>::Visitor> visitor(items);
+  slice.visit(&visitor);
+  return items;
+}
+
+/// Returns copies of the category data of the slice, one entry per item
+std::vector<CategoryData> sliceItems(const CategoryDataSlice& slice)
+{
+  std::vector<CategoryData> items;
+  CopyVisitor<CategoryData, CategoryDataSlice::Visitor> visitor(items);
+  slice.visit(&visitor);
+  return items;
+}
+
+/// Reads updates written by writeUpdates() and inserts them into the slice as a batch; returns 0 on success
+template <typename T>
+int loadUpdates(SnapshotReader& in, MemoryDataSlice<T>* slice)
+{
+  std::vector<T> updates;
+  if (readUpdates(in, updates) != 0)
+    return 1;
+  std::vector<T*> copies;
+  copies.reserve(updates.size());
+  for (auto& update : updates)
+    copies.push_back(new T(std::move(update)));
+  slice->insertBatch(copies);
+  return 0;
+}
+
+/// Platforms insert straight into their storage, without allocating each update
+int loadUpdates(SnapshotReader& in, PlatformMemoryDataSlice* slice)
+{
+  std::vector<PlatformUpdate> updates;
+  if (readUpdates(in, updates) != 0)
+    return 1;
+  slice->insertBatch(std::span<const PlatformUpdate>(updates));
+  return 0;
+}
+
+/// Reads commands written with writeFieldList() into the slice; returns 0 on success
+template <typename CommandType, typename PrefType>
+int loadCommands(SnapshotReader& in, const LoadedFieldList& fieldList, MemoryCommandSlice<CommandType, PrefType>* slice)
+{
+  uint64_t count = 0;
+  in.read(count);
+  for (uint64_t ii = 0; ii < count && in.ok(); ++ii)
+  {
+    auto command = std::make_unique<CommandType>();
+    if (fieldList.readFields(in, *command) != 0)
+      return 1;
+    slice->insert(command.release());
+  }
+  return in.ok() ? 0 : 1;
+}
+
+//----------------------------------------------------------------------------
+
+/// Writes the cells of a table row as (column index, type, value) triples
+class CellWriter : public TableRow::CellVisitor
+{
+public:
+  CellWriter(SnapshotWriter& out, const std::map<TableColumnId, uint32_t>& columnIndices)
+    : out_(out),
+      columnIndices_(columnIndices)
+  {
+  }
+
+  void visit(TableColumnId columnId, uint8_t value) override { write_(columnId, VT_UINT8, value); }
+  void visit(TableColumnId columnId, int8_t value) override { write_(columnId, VT_INT8, value); }
+  void visit(TableColumnId columnId, uint16_t value) override { write_(columnId, VT_UINT16, value); }
+  void visit(TableColumnId columnId, int16_t value) override { write_(columnId, VT_INT16, value); }
+  void visit(TableColumnId columnId, uint32_t value) override { write_(columnId, VT_UINT32, value); }
+  void visit(TableColumnId columnId, int32_t value) override { write_(columnId, VT_INT32, value); }
+  void visit(TableColumnId columnId, uint64_t value) override { write_(columnId, VT_UINT64, value); }
+  void visit(TableColumnId columnId, int64_t value) override { write_(columnId, VT_INT64, value); }
+  void visit(TableColumnId columnId, float value) override { write_(columnId, VT_FLOAT, value); }
+  void visit(TableColumnId columnId, double value) override { write_(columnId, VT_DOUBLE, value); }
+  void visit(TableColumnId columnId, const std::string& value) override
+  {
+    writeHeader_(columnId, VT_STRING);
+    out_.writeString(value);
+  }
+
+private:
+  void writeHeader_(TableColumnId columnId, VariableType type)
+  {
+    auto it = columnIndices_.find(columnId);
+    out_.write<uint32_t>(it == columnIndices_.end() ? std::numeric_limits<uint32_t>::max() : it->second);
+    out_.write<uint8_t>(static_cast<uint8_t>(type));
+  }
+
+  template <typename T>
+  void write_(TableColumnId columnId, VariableType type, T value)
+  {
+    writeHeader_(columnId, type);
+    out_.write<T>(value);
+  }
+
+  SnapshotWriter& out_;
+  const std::map<TableColumnId, uint32_t>& columnIndices_;
+};
+
+/// Reads a cell value of type T into the row
+template <typename T>
+bool readCell(SnapshotReader& in, TableRow& row, TableColumnId columnId)
+{
+  T value;
+  if (!in.read(value))
+    return false;
+  row.setValue(columnId, value);
+  return true;
+}
+
+/// Reads a cell written by CellWriter into the row; returns 0 on success
+int readCell(SnapshotReader& in, TableRow& row, const std::vector<TableColumnId>& columnIds)
+{
+  uint32_t index = 0;
+  uint8_t type = 0;
+  if (!in.read(index) || !in.read(type) || index >= columnIds.size())
+    return 1;
+  const TableColumnId columnId = columnIds[index];
+  bool ok = false;
+  switch (static_cast<VariableType>(type))
+  {
+  case VT_UINT8: ok = readCell<uint8_t>(in, row, columnId); break;
+  case VT_INT8: ok = readCell<int8_t>(in, row, columnId); break;
+  case VT_UINT16: ok = readCell<uint16_t>(in, row, columnId); break;
+  case VT_INT16: ok = readCell<int16_t>(in, row, columnId); break;
+  case VT_UINT32: ok = readCell<uint32_t>(in, row, columnId); break;
+  case VT_INT32: ok = readCell<int32_t>(in, row, columnId); break;
+  case VT_UINT64: ok = readCell<uint64_t>(in, row, columnId); break;
+  case VT_INT64: ok = readCell<int64_t>(in, row, columnId); break;
+  case VT_FLOAT: ok = readCell<float>(in, row, columnId); break;
+  case VT_DOUBLE: ok = readCell<double>(in, row, columnId); break;
+  case VT_STRING:
+  {
+    std::string value;
+    ok = in.readString(value);
+    if (ok)
+      row.setValue(columnId, value);
+    break;
+  }
+  }
+  return ok ? 0 : 1;
+}
+
+/// Collects the tables of an owner
+class TableCollector : public TableList::Visitor
+{
+public:
+  explicit TableCollector(std::vector<DataTable*>& tables)
+    : tables_(tables)
+  {
+  }
+
+  void visit(DataTable* table) override
+  {
+    tables_.push_back(table);
+  }
+
+private:
+  std::vector<DataTable*>& tables_;
+};
+
+/// Collects the columns of a table
+class ColumnCollector : public DataTable::ColumnVisitor
+{
+public:
+  void visit(TableColumn* column) override
+  {
+    columns.push_back(column);
+  }
+
+  std::vector<TableColumn*> columns;
+};
+
+/// Writes each row of a table
+class RowWriter : public DataTable::RowVisitor
+{
+public:
+  RowWriter(SnapshotWriter& out, const std::map<TableColumnId, uint32_t>& columnIndices)
+    : out_(out),
+      cells_(out, columnIndices)
+  {
+  }
+
+  VisitReturn visit(const TableRow& row) override
+  {
+    out_.write<double>(row.time());
+    out_.write<uint32_t>(static_cast<uint32_t>(row.cellCount()));
+    row.accept(cells_);
+    ++count;
+    return VISIT_CONTINUE;
+  }
+
+  uint64_t count = 0;
+
+private:
+  SnapshotWriter& out_;
+  CellWriter cells_;
+};
+
+/// Counts the rows of a table
+class RowCounter : public DataTable::RowVisitor
+{
+public:
+  VisitReturn visit(const TableRow& row) override
+  {
+    ++count;
+    return VISIT_CONTINUE;
+  }
+
+  uint64_t count = 0;
+};
+
+}
+
+//----------------------------------------------------------------------------
+
+/// Writes and reads the snapshot sections; nested so it can reach the entity maps
+class MemoryDataStore::Snapshot
+{
+public:
+  explicit Snapshot(MemoryDataStore& store)
+    : store_(store)
+  {
+  }
+
+  SDK_DISABLE_COPY_MOVE(Snapshot);
+
+  /// Writes the whole data store; returns 0 on success
+  int save(const std::string& filename)
+  {
+    SnapshotWriter out(filename);
+    if (!out.ok())
+      return 1;
+
+    out.write(SNAPSHOT_MAGIC);
+    out.write<uint32_t>(MemoryDataStore::SNAPSHOT_VERSION);
+    out.write<uint32_t>(BYTE_ORDER_MARK);
+    out.write<uint64_t>(store_.baseId_);
+
+    // Field paths, so that files stay readable when fields are added or removed
+    std::vector<std::unique_ptr<FieldListSchema> > schemas;
+    out.write<uint32_t>(NUM_FIELD_LIST_KINDS);
+    for (uint32_t kind = 0; kind < NUM_FIELD_LIST_KINDS; ++kind)
+    {
+      schemas.push_back(std::make_unique<FieldListSchema>(kind));
+      out.write<uint32_t>(kind);
+      out.write<uint32_t>(static_cast<uint32_t>(schemas.back()->fields().size()));
+      for (const auto& [path, type] : schemas.back()->fields())
+      {
+        out.writeString(path);
+        out.write<uint8_t>(static_cast<uint8_t>(type));
+      }
+    }
+    schemas_ = &schemas;
+
+    writeFieldList(out, *schemas[SCENARIO_PROPERTIES], store_.properties_);
+    writeFieldList(out, *schemas[PLATFORM_PREFS + 0], store_.defaultPlatformPrefs_);
+    writeFieldList(out, *schemas[PLATFORM_PREFS + 1], store_.defaultBeamPrefs_);
+    writeFieldList(out, *schemas[PLATFORM_PREFS + 2], store_.defaultGatePrefs_);
+    writeFieldList(out, *schemas[PLATFORM_PREFS + 3], store_.defaultLaserPrefs_);
+    writeFieldList(out, *schemas[PLATFORM_PREFS + 4], store_.defaultProjectorPrefs_);
+    writeFieldList(out, *schemas[PLATFORM_PREFS + 5], store_.defaultLobGroupPrefs_);
+    writeFieldList(out, *schemas[PLATFORM_PREFS + 6], store_.defaultCustomRenderingPrefs_);
+    writeGenericData_(out, 0);
+
+    // Entities in ID order so hosts are restored before their children
+    std::vector<std::pair<ObjectId, ObjectType> > entities;
+    collectIds_(store_.platforms_, PLATFORM, entities);
+    collectIds_(store_.beams_, BEAM, entities);
+    collectIds_(store_.gates_, GATE, entities);
+    collectIds_(store_.lasers_, LASER, entities);
+    collectIds_(store_.projectors_, PROJECTOR, entities);
+    collectIds_(store_.lobGroups_, LOB_GROUP, entities);
+    collectIds_(store_.customRenderings_, CUSTOM_RENDERING, entities);
+    std::sort(entities.begin(), entities.end());
+
+    out.write<uint64_t>(entities.size());
+    for (const auto& [id, type] : entities)
+    {
+      out.write<uint32_t>(static_cast<uint32_t>(type));
+      out.write<uint64_t>(id);
+      switch (type)
+      {
+      case PLATFORM: writeEntity_(out, *store_.platforms_[id], type); break;
+      case BEAM: writeEntity_(out, *store_.beams_[id], type); break;
+      case GATE: writeEntity_(out, *store_.gates_[id], type); break;
+      case LASER: writeEntity_(out, *store_.lasers_[id], type); break;
+      case PROJECTOR: writeEntity_(out, *store_.projectors_[id], type); break;
+      case LOB_GROUP: writeEntity_(out, *store_.lobGroups_[id], type); break;
+      case CUSTOM_RENDERING: writeEntity_(out, *store_.customRenderings_[id], type); break;
+      case NONE:
+      case ALL:
+        break;
+      }
+    }
+
+    // Data tables of the scenario and of each entity
+    std::vector<DataTable*> tables;
+    TableCollector collector(tables);
+    std::vector<ObjectId> owners(1, 0);
+    for (const auto& entity : entities)
+      owners.push_back(entity.first);
+    for (ObjectId owner : owners)
+    {
+      const TableList* list = store_.dataTableManager_->tablesForOwner(owner);
+      if (list)
+        list->accept(collector);
+    }
+    out.write<uint64_t>(tables.size());
+    for (DataTable* table : tables)
+      writeTable_(out, *table);
+
+    schemas_ = nullptr;
+    return out.close() ? 0 : 1;
+  }
+
+  /// Restores a file written by save(); returns 0 on success
+  int load(const std::string& filename)
+  {
+    MappedFile file(filename);
+    if (!file.data())
+      return 1;
+    SnapshotReader in(file.data(), file.size());
+
+    const char* magic = in.take(sizeof(SNAPSHOT_MAGIC), 1);
+    uint32_t version = 0;
+    uint32_t byteOrder = 0;
+    uint64_t baseId = 0;
+    in.read(version);
+    in.read(byteOrder);
+    in.read(baseId);
+    if (!in.ok() || std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || byteOrder != BYTE_ORDER_MARK ||
+      version == 0 || version > MemoryDataStore::SNAPSHOT_VERSION)
+      return 1;
+
+    uint32_t numKinds = 0;
+    in.read(numKinds);
+    std::vector<std::unique_ptr<LoadedFieldList> > fieldLists;
+    for (uint32_t kind = 0; kind < NUM_FIELD_LIST_KINDS; ++kind)
+      fieldLists.push_back(std::make_unique<LoadedFieldList>());
+    for (uint32_t ii = 0; ii < numKinds && in.ok(); ++ii)
+    {
+      uint32_t kind = 0;
+      in.read(kind);
+      if (kind < NUM_FIELD_LIST_KINDS)
+      {
+        if (fieldLists[kind]->read(in, kind) != 0)
+          return 1;
+      }
+      else
+      {
+        // Kind from a later version; read past its paths
+        LoadedFieldList unknown;
+        if (unknown.read(in, SCENARIO_PROPERTIES) != 0)
+          return 1;
+      }
+    }
+    fieldLists_ = &fieldLists;
+
+    int rv = loadScenario_(in);
+    uint64_t numEntities = 0;
+    in.read(numEntities);
+    for (uint64_t ii = 0; ii < numEntities && rv == 0; ++ii)
+      rv = loadEntity_(in);
+    uint64_t numTables = 0;
+    in.read(numTables);
+    for (uint64_t ii = 0; ii < numTables && rv == 0; ++ii)
+      rv = loadTable_(in);
+
+    store_.baseId_ = std::max(store_.baseId_, baseId);
+    store_.hasChanged_ = true;
+    // Everything loaded is new to the memory budget
+    store_.resetMemoryTotals_();
+    fieldLists_ = nullptr;
+    return (rv == 0 && in.ok()) ? 0 : 1;
+  }
+
+private:
+  /// Adds the IDs of the map to ids
+  template <typename EntryMapType>
+  void collectIds_(const EntryMapType& entries, ObjectType type, std::vector<std::pair<ObjectId, ObjectType> >& ids) const
+  {
+    for (const auto& entry : entries)
+      ids.emplace_back(entry.first, type);
+  }
+
+  /// Writes the properties, prefs, updates, commands, category data and generic data of an entity
+  template <typename EntryType>
+  void writeEntity_(SnapshotWriter& out, EntryType& entry, ObjectType type)
+  {
+    const size_t typeIndex = entityTypeIndex(type);
+    const ObjectId id = entry.properties()->id();
+    writeFieldList(out, *(*schemas_)[PLATFORM_PROPERTIES + typeIndex], *entry.properties());
+    writeFieldList(out, *(*schemas_)[PLATFORM_PREFS + typeIndex], *entry.preferences());
+    writeUpdates(out, sliceItems(*entry.updates()));
+
+    const auto commands = sliceItems(*entry.commands());
+    out.write<uint64_t>(commands.size());
+    for (const auto& command : commands)
+      writeFieldList(out, *(*schemas_)[PLATFORM_COMMANDS + typeIndex], command);
+
+    std::vector<CategoryData> categories;
+    auto categoryIt = store_.categoryData_.find(id);
+    if (categoryIt != store_.categoryData_.end())
+      categories = sliceItems(*categoryIt->second);
+    out.write<uint64_t>(categories.size());
+    for (const auto& category : categories)
+    {
+      out.write<double>(category.time());
+      out.write<uint32_t>(static_cast<uint32_t>(category.entry_size()));
+      for (const auto& item : category.entry())
+      {
+        out.writeString(item.key());
+        out.writeString(item.value());
+      }
+    }
+
+    writeGenericData_(out, id);
+  }
+
+  /// Writes the generic data of the entity, or of the scenario for ID 0
+  void writeGenericData_(SnapshotWriter& out, ObjectId id)
+  {
+    std::vector<GenericData> generics;
+    auto it = store_.genericData_.find(id);
+    if (it != store_.genericData_.end())
+      generics = sliceItems<GenericData>(*it->second);
+    out.write<uint64_t>(generics.size());
+    for (const auto& generic : generics)
+    {
+      out.write<double>(generic.time());
+      out.write<uint8_t>(generic.has_duration() ? 1 : 0);
+      if (generic.has_duration())
+        out.write<double>(generic.duration());
+      out.write<uint32_t>(static_cast<uint32_t>(generic.entry_size()));
+      for (const auto& item : generic.entry())
+      {
+        out.writeString(item.key());
+        out.writeString(item.value());
+      }
+    }
+  }
+
+  /// Writes the columns and rows of a table
+  void writeTable_(SnapshotWriter& out, const DataTable& table)
+  {
+    out.write<uint64_t>(table.ownerId());
+    out.writeString(table.tableName());
+
+    ColumnCollector columns;
+    table.accept(columns);
+    std::map<TableColumnId, uint32_t> columnIndices;
+    out.write<uint32_t>(static_cast<uint32_t>(columns.columns.size()));
+    for (const TableColumn* column : columns.columns)
+    {
+      columnIndices[column->columnId()] = static_cast<uint32_t>(columnIndices.size());
+      out.writeString(column->name());
+      out.write<uint8_t>(static_cast<uint8_t>(column->variableType()));
+      out.write<int32_t>(column->unitType());
+    }
+
+    RowCounter counter;
+    table.accept(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max(), counter);
+    out.write<uint64_t>(counter.count);
+    RowWriter rows(out, columnIndices);
+    table.accept(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max(), rows);
+  }
+
+  /// Reads the scenario properties, default prefs and scenario generic data; returns 0 on success
+  int loadScenario_(SnapshotReader& in)
+  {
+    ScenarioProperties properties;
+    if ((*fieldLists_)[SCENARIO_PROPERTIES]->readFields(in, properties) != 0)
+      return 1;
+    Transaction transaction;
+    store_.mutable_scenarioProperties(&transaction)->CopyFrom(properties);
+    transaction.commit();
+
+    int rv = readDefaultPrefs_(in, 0, store_.defaultPlatformPrefs_);
+    rv += readDefaultPrefs_(in, 1, store_.defaultBeamPrefs_);
+    rv += readDefaultPrefs_(in, 2, store_.defaultGatePrefs_);
+    rv += readDefaultPrefs_(in, 3, store_.defaultLaserPrefs_);
+    rv += readDefaultPrefs_(in, 4, store_.defaultProjectorPrefs_);
+    rv += readDefaultPrefs_(in, 5, store_.defaultLobGroupPrefs_);
+    rv += readDefaultPrefs_(in, 6, store_.defaultCustomRenderingPrefs_);
+    if (rv != 0)
+      return 1;
+    return readGenericData_(in, 0);
+  }
+
+  /// Replaces the default prefs with the prefs in the file; returns 0 on success
+  template <typename PrefsType>
+  int readDefaultPrefs_(SnapshotReader& in, size_t typeIndex, PrefsType& prefs)
+  {
+    PrefsType loaded;
+    if ((*fieldLists_)[PLATFORM_PREFS + typeIndex]->readFields(in, loaded) != 0)
+      return 1;
+    prefs = loaded;
+    return 0;
+  }
+
+  /// Reads an entity and adds it with its saved ID; returns 0 on success
+  int loadEntity_(SnapshotReader& in)
+  {
+    uint32_t type = 0;
+    uint64_t id = 0;
+    in.read(type);
+    in.read(id);
+    if (!in.ok() || id == 0 || store_.objectType(id) != NONE)
+      return 1;
+
+    switch (static_cast<ObjectType>(type))
+    {
+    case PLATFORM:
+      return loadEntity_(in, id, PLATFORM, store_.platforms_, &MemoryDataStore::addPlatform, &MemoryDataStore::mutable_platformPrefs);
+    case BEAM:
+      return loadEntity_(in, id, BEAM, store_.beams_, &MemoryDataStore::addBeam, &MemoryDataStore::mutable_beamPrefs);
+    case GATE:
+      return loadEntity_(in, id, GATE, store_.gates_, &MemoryDataStore::addGate, &MemoryDataStore::mutable_gatePrefs);
+    case LASER:
+      return loadEntity_(in, id, LASER, store_.lasers_, &MemoryDataStore::addLaser, &MemoryDataStore::mutable_laserPrefs);
+    case PROJECTOR:
+      return loadEntity_(in, id, PROJECTOR, store_.projectors_, &MemoryDataStore::addProjector, &MemoryDataStore::mutable_projectorPrefs);
+    case LOB_GROUP:
+      return loadEntity_(in, id, LOB_GROUP, store_.lobGroups_, &MemoryDataStore::addLobGroup, &MemoryDataStore::mutable_lobGroupPrefs);
+    case CUSTOM_RENDERING:
+      return loadEntity_(in, id, CUSTOM_RENDERING, store_.customRenderings_, &MemoryDataStore::addCustomRendering, &MemoryDataStore::mutable_customRenderingPrefs);
+    case NONE:
+    case ALL:
+      break;
+    }
+    return 1;
+  }
+
+  /// Adds the entity through the regular transactions so that listeners and caches see it, then fills its slices
+  template <typename EntryType, typename PropertiesType, typename PrefsType>
+  int loadEntity_(SnapshotReader& in, ObjectId id, ObjectType type, std::map<ObjectId, EntryType*>& entries,
+    PropertiesType* (MemoryDataStore::*add)(Transaction*), PrefsType* (MemoryDataStore::*mutablePrefs)(ObjectId, Transaction*, CommitResult*))
+  {
+    const size_t typeIndex = entityTypeIndex(type);
+
+    // Add the entity with its saved ID
+    store_.baseId_ = id - 1;
+    Transaction transaction;
+    PropertiesType* properties = (store_.*add)(&transaction);
+    if ((*fieldLists_)[PLATFORM_PROPERTIES + typeIndex]->readFields(in, *properties) != 0)
+    {
+      transaction.release(&properties);
+      return 1;
+    }
+    properties->set_id(id);
+    transaction.commit();
+
+    PrefsType prefs;
+    if ((*fieldLists_)[PLATFORM_PREFS + typeIndex]->readFields(in, prefs) != 0)
+      return 1;
+    (store_.*mutablePrefs)(id, &transaction, nullptr)->CopyFrom(prefs);
+    transaction.commit();
+
+    EntryType* entry = entries[id];
+    if (loadUpdates(in, entry->updates()) != 0 ||
+      loadCommands(in, *(*fieldLists_)[PLATFORM_COMMANDS + typeIndex], entry->commands()) != 0)
+      return 1;
+
+    uint64_t numCategories = 0;
+    in.read(numCategories);
+    auto categoryIt = store_.categoryData_.find(id);
+    for (uint64_t ii = 0; ii < numCategories && in.ok(); ++ii)
+    {
+      auto category = std::make_unique<CategoryData>();
+      double time = 0.0;
+      uint32_t numEntries = 0;
+      in.read(time);
+      in.read(numEntries);
+      category->set_time(time);
+      for (uint32_t jj = 0; jj < numEntries && in.ok(); ++jj)
+      {
+        CategoryData::Entry* item = category->add_entry();
+        std::string value;
+        in.readString(value);
+        item->set_key(value);
+        in.readString(value);
+        item->set_value(value);
+      }
+      if (in.ok() && categoryIt != store_.categoryData_.end())
+        categoryIt->second->insert(category.release());
+    }
+
+    return readGenericData_(in, id);
+  }
+
+  /// Reads generic data into the slice of the entity, or of the scenario for ID 0; returns 0 on success
+  int readGenericData_(SnapshotReader& in, ObjectId id)
+  {
+    uint64_t count = 0;
+    in.read(count);
+    auto it = store_.genericData_.find(id);
+    for (uint64_t ii = 0; ii < count && in.ok(); ++ii)
+    {
+      auto generic = std::make_unique<GenericData>();
+      double value = 0.0;
+      uint8_t hasDuration = 0;
+      uint32_t numEntries = 0;
+      in.read(value);
+      generic->set_time(value);
+      in.read(hasDuration);
+      if (hasDuration && in.read(value))
+        generic->set_duration(value);
+      in.read(numEntries);
+      for (uint32_t jj = 0; jj < numEntries && in.ok(); ++jj)
+      {
+        GenericData::Entry* item = generic->add_entry();
+        std::string text;
+        in.readString(text);
+        item->set_key(text);
+        in.readString(text);
+        item->set_value(text);
+      }
+      if (in.ok() && it != store_.genericData_.end())
+        it->second->insert(generic.release(), false);
+    }
+    return in.ok() ? 0 : 1;
+  }
+
+  /// Reads a table written by writeTable_() and adds it to the table manager; returns 0 on success
+  int loadTable_(SnapshotReader& in)
+  {
+    uint64_t owner = 0;
+    std::string name;
+    uint32_t numColumns = 0;
+    in.read(owner);
+    in.readString(name);
+    in.read(numColumns);
+    if (!in.ok())
+      return 1;
+
+    DataTable* table = nullptr;
+    if (store_.dataTableManager_->addDataTable(owner, name, &table).isError() || !table)
+      return 1;
+    std::vector<TableColumnId> columnIds;
+    for (uint32_t ii = 0; ii < numColumns && in.ok(); ++ii)
+    {
+      std::string columnName;
+      uint8_t type = 0;
+      int32_t units = 0;
+      in.readString(columnName);
+      in.read(type);
+      in.read(units);
+      TableColumn* column = nullptr;
+      if (!in.ok() || table->addColumn(columnName, static_cast<VariableType>(type), units, &column).isError() || !column)
+        return 1;
+      columnIds.push_back(column->columnId());
+    }
+
+    uint64_t numRows = 0;
+    in.read(numRows);
+    TableRow row;
+    for (uint64_t ii = 0; ii < numRows && in.ok(); ++ii)
+    {
+      double time = 0.0;
+      uint32_t numCells = 0;
+      in.read(time);
+      in.read(numCells);
+      row.clear();
+      row.setTime(time);
+      for (uint32_t jj = 0; jj < numCells; ++jj)
+      {
+        if (readCell(in, row, columnIds) != 0)
+          return 1;
+      }
+      table->addRow(row);
+    }
+    return in.ok() ? 0 : 1;
+  }
+
+  MemoryDataStore& store_;
+  /// Schemas of the field list kinds while saving
+  std::vector<std::unique_ptr<FieldListSchema> >* schemas_ = nullptr;
+  /// Field lists of the file while loading
+  std::vector<std::unique_ptr<LoadedFieldList> >* fieldLists_ = nullptr;
+};
+
+int MemoryDataStore::saveSnapshot(const std::string& filename) const
+{
+  // Saving only reads the data store; the visitors and table accessors are not const
+  Snapshot snapshot(const_cast<MemoryDataStore&>(*this));
+  return snapshot.save(filename);
+}
+
+int MemoryDataStore::loadSnapshot(const std::string& filename)
+{
+  if (!platforms_.empty() || !beams_.empty() || !gates_.empty() || !lasers_.empty() || !projectors_.empty() ||
+    !lobGroups_.empty() || !customRenderings_.empty() || dataTableManager_->tableCount() != 0)
+    return 1;
+  Snapshot snapshot(*this);
+  return snapshot.load(filename);
+}
+
+}
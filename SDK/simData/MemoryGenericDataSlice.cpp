@@ -38,20 +38,52 @@ static const int COUNT_DOWN = 5;
 /// Holds all the values for one Generic Data Key
 class MemoryGenericDataSlice::Key
 {
+public:
+  virtual ~Key()
+  {
+  }
+
+  /// Removes all times and values
+  virtual void flush() = 0;
+  /// Removes the times and values in the time range; up to but not including endTime
+  virtual void flush(double startTime, double endTime) = 0;
+  /// Data limit by preferences
+  virtual void limitByPrefs(const CommonPrefs& prefs) = 0;
+  /// if ignoreDuplicates is true; successive duplicate values, with different times, will not be added
+  virtual void insert(double time, const std::string& value, bool ignoreDuplicates) = 0;
+  /// Updates to the given time, putting results in genericData
+  virtual void update(double time, GenericData& genericData) = 0;
+  /** Returns true if last update dirty */
+  virtual bool hasChanged() const = 0;
+  /** Retrieves number of items */
+  virtual size_t numItems() const = 0;
+  /** Estimated number of bytes used by the key's own storage */
+  virtual size_t memoryUsage() const = 0;
+  /** Returns the key; the view is valid for the life of this object */
+  virtual std::string_view name() const = 0;
+  /** Retrieve the time and value at the given index, returning true on success */
+  virtual bool getItem(size_t index, double& time, std::string& value) const = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------
+
+/// Holds the values for one key in a deque of strings local to the key
+class MemoryGenericDataSlice::DequeKey : public MemoryGenericDataSlice::Key
+{
 public:
   /** Constructor */
-  explicit Key(const std::string& key)
+  explicit DequeKey(const std::string& key)
     : key_(key)
   {
     flush();
   }
 
-  virtual ~Key()
+  virtual ~DequeKey()
   {
   }
 
   /// Removes all times and values
-  void flush()
+  void flush() override
   {
     // No static entries (-1 time) so just clear everything
     times_.clear();
@@ -60,7 +92,7 @@ public:
     lastUpdateDirty_ = true;
   }
 
-  void flush(double startTime, double endTime)
+  void flush(double startTime, double endTime) override
   {
     // Instead of attempting to delete entries and update the data structure,
     // just save what is needed to a temporary vector, flush the data and rebuild.
@@ -176,7 +208,7 @@ public:
   }
 
   /// Data limit by preferences
-  void limitByPrefs(const CommonPrefs& prefs)
+  void limitByPrefs(const CommonPrefs& prefs) override
   {
     const bool pointChanged = limitByPoints_(prefs.datalimitpoints());
     const bool timeChanged = limitByTime_(prefs.datalimittime());
@@ -193,12 +225,12 @@ public:
   }
 
   /// if ignoreDuplicates is true; successive duplicate values, with different times, will not be added to times_
-  void insert(double time, const std::string& value, bool ignoreDuplicates)
+  void insert(double time, const std::string& value, bool ignoreDuplicates) override
   {
     // Find location
     TimeList::iterator start = times_.end();
     if (!times_.empty() && (time <= times_.back().time))
-      start = std::lower_bound(times_.begin(), times_.end(), TimeIndex(time), Key::lessByTime);
+      start = std::lower_bound(times_.begin(), times_.end(), TimeIndex(time), DequeKey::lessByTime);
 
     // prevent duplicates at the same time; independent of the ignoreDuplicates
     for (; start != times_.end(); ++start)
@@ -259,7 +291,7 @@ public:
   }
 
   /// Updates to the given time, putting results in genericData
-  void update(double time, GenericData& genericData)
+  void update(double time, GenericData& genericData) override
   {
     lastUpdateDirty_ = false;
 
@@ -268,7 +300,7 @@ public:
     if (times_.empty())
       return;
 
-    TimeList::const_iterator it = std::upper_bound(times_.begin(), times_.end(), TimeIndex(time), Key::lessByTime);
+    TimeList::const_iterator it = std::upper_bound(times_.begin(), times_.end(), TimeIndex(time), DequeKey::lessByTime);
     if (it == times_.begin())
       return;
 
@@ -280,25 +312,34 @@ public:
   }
 
   /** Returns true if last update dirty */
-  bool hasChanged() const
+  bool hasChanged() const override
   {
     return lastUpdateDirty_;
   }
 
   /** Retrieves number of items */
-  size_t numItems() const
+  size_t numItems() const override
   {
     return times_.size();
   }
 
+  /** Estimated number of bytes used by the times and the distinct values */
+  size_t memoryUsage() const override
+  {
+    size_t rv = sizeof(DequeKey) + key_.size() + times_.size() * sizeof(TimeIndex);
+    for (const auto& value : values_)
+      rv += sizeof(ValueIndex) + value.value.size();
+    return rv;
+  }
+
   /** Returns the key */
-  std::string name() const
+  std::string_view name() const override
   {
     return key_;
   }
 
   /** Retrieve the time and value at the given index, returning true on success */
-  bool getItem(size_t index, double& time, std::string& value) const
+  bool getItem(size_t index, double& time, std::string& value) const override
   {
     // Asking for an index that does not exist
     assert(index < times_.size());
@@ -349,6 +390,144 @@ private:
 };
 
 
+//------------------------------------------------------------------------------------------------------------------
+
+/// Holds the values for one key as parallel time and string ID arrays, with the key and values in a shared StringArena
+class MemoryGenericDataSlice::InternedKey : public MemoryGenericDataSlice::Key
+{
+public:
+  /** Constructor */
+  InternedKey(const std::string& key, StringArena& arena)
+    : arena_(arena),
+      key_(arena.intern(key))
+  {
+  }
+
+  virtual ~InternedKey()
+  {
+    flush();
+    arena_.release(key_);
+  }
+
+  /// Removes all times and values
+  void flush() override
+  {
+    erase_(0, times_.size());
+  }
+
+  void flush(double startTime, double endTime) override
+  {
+    const auto first = std::lower_bound(times_.begin(), times_.end(), startTime);
+    const auto last = std::lower_bound(first, times_.end(), endTime);
+    erase_(first - times_.begin(), last - times_.begin());
+  }
+
+  void limitByPrefs(const CommonPrefs& prefs) override
+  {
+    size_t amount = 0;
+    // zero is special case for "no limit"
+    const uint32_t limitPoints = prefs.datalimitpoints();
+    if ((limitPoints != 0) && (times_.size() > limitPoints))
+      amount = times_.size() - limitPoints;
+    const double timeLimit = prefs.datalimittime();
+    if ((timeLimit > 0.0) && !times_.empty())
+    {
+      const double cutoff = times_.back() - timeLimit;
+      amount = std::max(amount, static_cast<size_t>(std::lower_bound(times_.begin(), times_.end(), cutoff) - times_.begin()));
+    }
+    erase_(0, amount);
+  }
+
+  void insert(double time, const std::string& value, bool ignoreDuplicates) override
+  {
+    // Find location
+    size_t start = times_.size();
+    if (!times_.empty() && (time <= times_.back()))
+      start = std::lower_bound(times_.begin(), times_.end(), time) - times_.begin();
+
+    // prevent duplicates at the same time; independent of the ignoreDuplicates
+    for (; (start < times_.size()) && (times_[start] == time); ++start)
+    {
+      if (arena_.value(ids_[start]) == value)
+        return; // no assert, user provided data
+    }
+
+    // If necessary ignore historical duplicates
+    if (ignoreDuplicates && (start != 0) && (arena_.value(ids_[start - 1]) == value))
+      return;
+
+    times_.insert(times_.begin() + start, time);
+    ids_.insert(ids_.begin() + start, arena_.intern(value));
+
+    // lazy update requires this
+    lastUpdateDirty_ = true;
+  }
+
+  void update(double time, GenericData& genericData) override
+  {
+    lastUpdateDirty_ = false;
+
+    const size_t index = std::upper_bound(times_.begin(), times_.end(), time) - times_.begin();
+    if (index == 0)
+      return;
+
+    simData::GenericData_Entry* newEntry = genericData.add_entry();
+    newEntry->set_key(arena_.value(key_));
+    newEntry->set_value(arena_.value(ids_[index - 1]));
+  }
+
+  bool hasChanged() const override
+  {
+    return lastUpdateDirty_;
+  }
+
+  size_t numItems() const override
+  {
+    return times_.size();
+  }
+
+  /** Estimated number of bytes used by the times and IDs; the strings are counted by the arena */
+  size_t memoryUsage() const override
+  {
+    return sizeof(InternedKey) + times_.size() * (sizeof(double) + sizeof(StringArena::StringId));
+  }
+
+  std::string_view name() const override
+  {
+    return arena_.value(key_);
+  }
+
+  bool getItem(size_t index, double& time, std::string& value) const override
+  {
+    // Asking for an index that does not exist
+    assert(index < times_.size());
+    if (index >= times_.size())
+      return false;
+
+    time = times_[index];
+    value = arena_.value(ids_[index]);
+    return true;
+  }
+
+private:
+  /// Removes the items [first, last), releasing their value strings
+  void erase_(size_t first, size_t last)
+  {
+    if (first >= last)
+      return;
+    for (size_t ii = first; ii < last; ++ii)
+      arena_.release(ids_[ii]);
+    times_.erase(times_.begin() + first, times_.begin() + last);
+    ids_.erase(ids_.begin() + first, ids_.begin() + last);
+    lastUpdateDirty_ = true;
+  }
+
+  StringArena& arena_;  ///< Holds the key and value strings
+  StringArena::StringId key_;  ///< The key for this generic data
+  std::deque<double> times_;  ///< Sorted times
+  std::deque<StringArena::StringId> ids_;  ///< Value string of each time
+  bool lastUpdateDirty_ = true; ///< True if changes have been made since last update
+};
 
 //------------------------------------------------------------------------------------------------------------------
 
@@ -440,9 +619,10 @@ MemoryGenericDataSlice::~MemoryGenericDataSlice()
 void MemoryGenericDataSlice::flush()
 {
   // No static entries (-1 time) so just clear everything
-  for (GenericDataMap::const_iterator it = genericData_.begin(); it != genericData_.end(); ++it)
+  GenericDataMap oldData;
+  oldData.swap(genericData_);
+  for (GenericDataMap::const_iterator it = oldData.begin(); it != oldData.end(); ++it)
     delete it->second;
-  genericData_.clear();
   lastTime_ = -1.0;
 }
 
@@ -481,6 +661,44 @@ void MemoryGenericDataSlice::setTimeGetter(const std::function<double()>& fn)
   fn_ = fn;
 }
 
+void MemoryGenericDataSlice::setStringArena(const std::shared_ptr<StringArena>& arena)
+{
+  if (arena == arena_)
+    return;
+
+  // Copy each key into the new storage before the old arena can be released
+  GenericDataMap oldData;
+  oldData.swap(genericData_);
+  std::shared_ptr<StringArena> oldArena = arena_;
+  arena_ = arena;
+  for (const auto& nameAndKey : oldData)
+  {
+    Key* newKey = newKey_(std::string(nameAndKey.first));
+    double time;
+    std::string value;
+    for (size_t ii = 0; ii < nameAndKey.second->numItems(); ++ii)
+    {
+      if (nameAndKey.second->getItem(ii, time, value))
+        newKey->insert(time, value, false);
+    }
+    genericData_[newKey->name()] = newKey;
+    delete nameAndKey.second;
+  }
+  force_ = true;
+}
+
+const std::shared_ptr<StringArena>& MemoryGenericDataSlice::stringArena() const
+{
+  return arena_;
+}
+
+MemoryGenericDataSlice::Key* MemoryGenericDataSlice::newKey_(const std::string& key) const
+{
+  if (arena_)
+    return new InternedKey(key, *arena_);
+  return new DequeKey(key);
+}
+
 void MemoryGenericDataSlice::insert(GenericData* data, bool ignoreDuplicates)
 {
   // Should always pass data in
@@ -496,9 +714,10 @@ void MemoryGenericDataSlice::insert(GenericData* data, bool ignoreDuplicates)
     GenericDataMap::const_iterator it = genericData_.find(key);
     if (it == genericData_.end())
     {
-      Key* newKey = new Key(key);
+      Key* newKey = newKey_(key);
       newKey->insert(data->time(), value, ignoreDuplicates);
-      genericData_[key] = newKey;
+      // The map views the key's own copy of the name
+      genericData_[newKey->name()] = newKey;
     }
     else
       it->second->insert(data->time(), value, ignoreDuplicates);
@@ -513,8 +732,10 @@ int MemoryGenericDataSlice::removeTag(const std::string& tag)
   if (it == genericData_.end())
     return 1;
 
-  delete it->second;
+  // Erase before deleting, since the map key views the key's name
+  Key* key = it->second;
   genericData_.erase(it);
+  delete key;
   force_ = true;
   return 0;
 }
@@ -633,4 +854,13 @@ size_t MemoryGenericDataSlice::numItems() const
   return rv;
 }
 
+size_t MemoryGenericDataSlice::memoryUsage() const
+{
+  size_t rv = 0;
+  for (GenericDataMap::const_iterator it = genericData_.begin(); it != genericData_.end(); ++it)
+    rv += it->second->memoryUsage();
+
+  return rv;
+}
+
 }
@@ -25,10 +25,14 @@
 
 #include <deque>
 #include <functional>
+#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
 
 #include "simCore/Common/Common.h"
 #include "simData/DataSlice.h"
+#include "simData/StringArena.h"
 
 namespace simData
 {
@@ -49,6 +53,11 @@ namespace simData
  * value will get a new index in the queue.  The older repeating value can be data limited out without adversely
  * affecting the indexes.   Without the kick out it would theoretically be possible to stall the data limiting
  * of the std::deque and have it grow without bound.
+ *
+ * Alternatively, setStringArena() stores each key as (time, string ID) pairs, with the key and value
+ * strings interned in a reference counted StringArena shared with other slices.  Each distinct string
+ * is then held once across all entities, and is freed when flushing or data limiting removes its
+ * last use.
  */
 class SDKDATA_EXPORT MemoryGenericDataSlice : public GenericDataSlice
 {
@@ -71,6 +80,16 @@ public:
   /// Calling update can be expensive so instead install a time get function that can be called only when needed
   void setTimeGetter(const std::function<double()>& fn);
 
+  /**
+   * Stores keys and values in the given shared arena, or in per-key pools for nullptr.
+   * Existing data is moved to the new storage.
+   * @param arena Arena for the strings; must only be used on the data store's thread
+   */
+  void setStringArena(const std::shared_ptr<StringArena>& arena);
+
+  /// Returns the arena holding the strings, or nullptr if each key pools its own values
+  const std::shared_ptr<StringArena>& stringArena() const;
+
   /**
    * Insert data into the slice.
    * Note that normal DataSlice behavior is to take ownership of the data;
@@ -102,9 +121,16 @@ public:
   /// Retrieve total number of items in the data slice
   size_t numItems() const override;
 
+  /// Estimated number of bytes used by the items; repeated values of a key are stored once.  Strings in a StringArena are counted by the arena.
+  size_t memoryUsage() const;
+
 private:
   /// Holds the data for individual generic data keys
   class Key;
+  /// Key with its own pool of values
+  class DequeKey;
+  /// Key with its strings in arena_
+  class InternedKey;
   /// Collects data for the visitor pattern
   class Collector;
 
@@ -120,10 +146,16 @@ private:
   /// If set used to grab the current scenario time from the data store
   std::function<double()> fn_;
 
-  // All the generic data keyed by generic data key
-  typedef std::map<std::string, Key*> GenericDataMap;
+  /** Creates an empty key using the current storage */
+  Key* newKey_(const std::string& key) const;
+
+  // All the generic data keyed by generic data key, viewing the name held by the Key
+  typedef std::map<std::string_view, Key*> GenericDataMap;
   mutable GenericDataMap genericData_;
 
+  /// Holds the key and value strings when set
+  std::shared_ptr<StringArena> arena_;
+
   /// force a re-calculation of current_
   mutable bool force_;
 };
@@ -20,15 +20,46 @@
  * disclose, or release this software.
  *
  */
-#include <deque>
+#include <algorithm>
+#include <vector>
 #include <cassert>
 #include "simCore/Calc/Interpolation.h"
 #include "simData/DataTable.h"
 #include "simData/TableCellTranslator.h"
+#include "simData/TableColumnStatistics.h"
 #include "simData/MemoryTable/DataColumn.h"
+#include "simData/MemoryTable/MinMaxPyramid.h"
 
 namespace simData { namespace MemoryTable {
 
+/** Returns the values of a container holding T */
+template <typename T>
+static std::span<const T> numericValues(const DataContainer& container)
+{
+  return std::span<const T>(static_cast<const T*>(container.data()), container.size());
+}
+
+/** Calls func with the values of the container as a span of its storage type; returns non-zero for strings */
+template <typename Func>
+static int visitNumericValues(VariableType variableType, const DataContainer& container, Func&& func)
+{
+  switch (variableType)
+  {
+  case VT_UINT8: func(numericValues<uint8_t>(container)); return 0;
+  case VT_INT8: func(numericValues<int8_t>(container)); return 0;
+  case VT_UINT16: func(numericValues<uint16_t>(container)); return 0;
+  case VT_INT16: func(numericValues<int16_t>(container)); return 0;
+  case VT_UINT32: func(numericValues<uint32_t>(container)); return 0;
+  case VT_INT32: func(numericValues<int32_t>(container)); return 0;
+  case VT_UINT64: func(numericValues<uint64_t>(container)); return 0;
+  case VT_INT64: func(numericValues<int64_t>(container)); return 0;
+  case VT_FLOAT: func(numericValues<float>(container)); return 0;
+  case VT_DOUBLE: func(numericValues<double>(container)); return 0;
+  case VT_STRING: break;
+  }
+  return 1;
+}
+
 /**
  * Implementation of the TableColumn::IteratorData interface.  This interface provides
  * access to get and set values inside the data container so that a user can iterate
@@ -38,8 +69,10 @@ class DataColumn::IteratorDataImpl : public simData::TableColumn::IteratorData
 {
 public:
   /** Constructs a new IteratorDataImpl */
-  IteratorDataImpl(DataContainer* data, size_t position, double time)
-    : data_(data),
+  IteratorDataImpl(const DataColumn* column, bool isFreshBin, DataContainer* data, size_t position, double time)
+    : column_(column),
+      isFreshBin_(isFreshBin),
+      data_(data),
       position_(position),
       time_(time)
   {
@@ -65,19 +98,31 @@ public:
   TableStatus getValue(double& value) const override { return data_->getValue(position_, value); }
   TableStatus getValue(std::string& value) const override { return data_->getValue(position_, value); }
 
-  TableStatus setValue(uint8_t value) override { return data_->replace(position_, value); }
-  TableStatus setValue(int8_t value) override { return data_->replace(position_, value); }
-  TableStatus setValue(uint16_t value) override { return data_->replace(position_, value); }
-  TableStatus setValue(int16_t value) override { return data_->replace(position_, value); }
-  TableStatus setValue(uint32_t value) override { return data_->replace(position_, value); }
-  TableStatus setValue(int32_t value) override { return data_->replace(position_, value); }
-  TableStatus setValue(uint64_t value) override { return data_->replace(position_, value); }
-  TableStatus setValue(int64_t value) override { return data_->replace(position_, value); }
-  TableStatus setValue(float value) override { return data_->replace(position_, value); }
-  TableStatus setValue(double value) override { return data_->replace(position_, value); }
-  TableStatus setValue(const std::string& value) override { return data_->replace(position_, value); }
+  TableStatus setValue(uint8_t value) override { return setValue_(value); }
+  TableStatus setValue(int8_t value) override { return setValue_(value); }
+  TableStatus setValue(uint16_t value) override { return setValue_(value); }
+  TableStatus setValue(int16_t value) override { return setValue_(value); }
+  TableStatus setValue(uint32_t value) override { return setValue_(value); }
+  TableStatus setValue(int32_t value) override { return setValue_(value); }
+  TableStatus setValue(uint64_t value) override { return setValue_(value); }
+  TableStatus setValue(int64_t value) override { return setValue_(value); }
+  TableStatus setValue(float value) override { return setValue_(value); }
+  TableStatus setValue(double value) override { return setValue_(value); }
+  TableStatus setValue(const std::string& value) override { return setValue_(value); }
 
 private:
+  /// Replaces the value, keeping the column's summary up to date
+  template <typename T>
+  TableStatus setValue_(const T& value)
+  {
+    const TableStatus rv = data_->replace(position_, value);
+    if (rv.isSuccess())
+      column_->summarizeReplace_(isFreshBin_, position_);
+    return rv;
+  }
+
+  const DataColumn* column_;
+  bool isFreshBin_;
   DataContainer* data_;
   size_t position_;
   double time_;
@@ -93,8 +138,9 @@ class DataColumn::ColumnIteratorImpl : public TableColumn::IteratorImpl
 {
 public:
   /** Constructs a new ColumnIteratorImpl */
-  ColumnIteratorImpl(DataContainer* freshData, DataContainer* staleData, TimeContainer::Iterator timeIter)
-    : freshData_(freshData),
+  ColumnIteratorImpl(const DataColumn* column, DataContainer* freshData, DataContainer* staleData, TimeContainer::Iterator timeIter)
+    : column_(column),
+      freshData_(freshData),
       staleData_(staleData),
       timeIter_(timeIter)
   {
@@ -142,10 +188,11 @@ public:
 
   GenericIteratorImpl<IteratorDataPtr>* clone() const override
   {
-    return new ColumnIteratorImpl(freshData_, staleData_, timeIter_);
+    return new ColumnIteratorImpl(column_, freshData_, staleData_, timeIter_);
   }
 
 private:
+  const DataColumn* column_;
   DataContainer* freshData_;
   DataContainer* staleData_;
   TimeContainer::Iterator timeIter_;
@@ -154,8 +201,8 @@ private:
   IteratorDataImpl* newIteratorDataImpl_(TimeContainer::IteratorData data) const
   {
     if (data.isFreshBin())
-      return new IteratorDataImpl(freshData_, data.index(), data.time());
-    return new IteratorDataImpl(staleData_, data.index(), data.time());
+      return new IteratorDataImpl(column_, true, freshData_, data.index(), data.time());
+    return new IteratorDataImpl(column_, false, staleData_, data.index(), data.time());
   }
 };
 
@@ -185,6 +232,24 @@ public:
   void insert(size_t position, double value) override { insert_(position, value); }
   void insert(size_t position, const std::string& value) override { insert_(position, value); }
 
+  /** Appends the values, reserving space for all of them at once */
+  void append(std::span<const double> values) override
+  {
+    // Growing at least geometrically keeps appending many small blocks amortized constant time;
+    // space of removed items is reclaimed before growing
+    if ((data_.size() + values.size() > data_.capacity()) && (head_ != 0))
+      compact_();
+    const size_t needed = data_.size() + values.size();
+    if (needed > data_.capacity())
+      data_.reserve(std::max(needed, 2 * data_.capacity()));
+    for (double value : values)
+    {
+      T localValue;
+      TableCellTranslator::cast(value, localValue);
+      data_.push_back(localValue);
+    }
+  }
+
   // Replace item in the data container at the given position
   TableStatus replace(size_t position, uint8_t value) override { return replace_(position, value); }
   TableStatus replace(size_t position, int8_t value) override { return replace_(position, value); }
@@ -224,42 +289,75 @@ public:
     return TableStatus::Success();
   }
 
+  /** Returns the first item of the contiguous storage */
+  const void* data() const override { return data_.data() + head_; }
+
   /** Removes the entries starting at the given index */
   void erase(size_t position, size_t number = 1) override
   {
-    if (position < size())
+    if (position >= size())
+      return;
+    number = std::min(number, size() - position);
+    // Performance optimization (SIMSDK-260): removing from the front only moves the head, like the deque's pop_front()
+    if (position == 0)
     {
-      // Performance optimization (SIMSDK-260): pop_front() when able
-      if ((position == 0) && (number == 1))
-        data_.pop_front();
-      else
-        data_.erase(data_.begin() + position, data_.begin() + position + number);
+      head_ += number;
+      if (head_ == data_.size())
+        clear();
+      else if ((head_ >= MIN_COMPACT) && (2 * head_ >= data_.size()))
+        compact_();
+      return;
     }
+    data_.erase(data_.begin() + head_ + position, data_.begin() + head_ + position + number);
   }
   /** Total size of the data structure */
-  size_t size() const override { return data_.size(); }
+  size_t size() const override { return data_.size() - head_; }
   /** True if the structure is empty */
-  bool empty() const override { return data_.empty(); }
+  bool empty() const override { return size() == 0; }
   /** Removes all items from container */
-  void clear() override { data_.clear(); }
+  void clear() override
+  {
+    data_.clear();
+    head_ = 0;
+  }
 
 private:
+  /// Fewest removed items at the front worth moving the rest of the items for
+  static constexpr size_t MIN_COMPACT = 64;
+
   /**
-   * All data is stored in a deque.  Deque chosen for faster insertion
-   * (due to no need to double size on add, relative to vector), and faster
-   * removal (due to no need to shift all items every time).
+   * All data is stored in a vector so that ranges of rows can be read as spans.  Rows are
+   * appended as they arrive; erasing happens in ranges, after the time container has already
+   * visited every row to fix its indices, and data limiting swaps whole containers.  Items
+   * removed from the front stay in data_ before head_ until they are at least half of it, so
+   * removing the oldest rows one at a time is amortized constant time.
    */
-  typename std::deque<T> data_;
+  typename std::vector<T> data_;
+  /// Number of removed items at the front of data_
+  size_t head_ = 0;
+
+  /// Releases the removed items at the front of data_
+  void compact_()
+  {
+    data_.erase(data_.begin(), data_.begin() + head_);
+    head_ = 0;
+  }
 
   /// Template implementation of insertion at position
   template <typename DataType>
   void insert_(size_t position, const DataType& value)
   {
-    typename std::deque<T>::iterator pos = data_.end();
-    if (position < size())
-      pos = data_.begin() + position;
     T localValue;
     TableCellTranslator::cast(value, localValue);
+    // Reuse a removed item in front of the head
+    if ((position == 0) && (head_ != 0))
+    {
+      data_[--head_] = localValue;
+      return;
+    }
+    typename std::vector<T>::iterator pos = data_.end();
+    if (position < size())
+      pos = data_.begin() + head_ + position;
     data_.insert(pos, localValue);
   }
 
@@ -269,7 +367,7 @@ private:
   {
     if (position >= size())
       return TableStatus::Error("Column replacement: invalid index.");
-    TableCellTranslator::cast(value, *(data_.begin() + position));
+    TableCellTranslator::cast(value, data_[head_ + position]);
     return TableStatus::Success();
   }
 
@@ -279,7 +377,7 @@ private:
   {
     if (position >= size())
       return TableStatus::Error("Column getValue: invalid index.");
-    TableCellTranslator::cast(*(data_.begin() + position), value);
+    TableCellTranslator::cast(data_[head_ + position], value);
     return TableStatus::Success();
   }
 };
@@ -315,9 +413,36 @@ DataColumn::~DataColumn()
   delete freshData_;
 }
 
+void DataColumn::append(bool freshContainer, size_t position, std::span<const double> values)
+{
+  DataContainer* container = dataContainer_(freshContainer);
+  const size_t oldSize = container->size();
+  // Assertion failure means the time container and the data container are out of sync
+  assert(position == oldSize);
+  container->append(values);
+
+  std::unique_ptr<MinMaxPyramid>& summary = summary_(freshContainer);
+  if (!summary)
+    return;
+  if (summary->size() != oldSize)
+  {
+    summary.reset();
+    return;
+  }
+  visitNumericValues(variableType_, *container, [&summary](auto columnValues) { summary->append(columnValues); });
+}
+
 void DataColumn::erase(bool freshContainer, size_t position, size_t number)
 {
   dataContainer_(freshContainer)->erase(position, number);
+  std::unique_ptr<MinMaxPyramid>& summary = summary_(freshContainer);
+  if (!summary)
+    return;
+  // Data limiting removes from the front, which the summary follows; other removals shift indices, so rebuild when next needed
+  if (position == 0 && summary->size() >= number)
+    summary->eraseFront(number);
+  else
+    summary.reset();
 }
 
 size_t DataColumn::size() const
@@ -357,6 +482,8 @@ private:
 DelayedFlushContainerPtr DataColumn::flush()
 {
   // Optimize for case where both are empty (no memory allocation)
+  freshSummary_.reset();
+  staleSummary_.reset();
   if (freshData_->empty() && staleData_->empty())
     return DelayedFlushContainerPtr();
   return DelayedFlushContainerPtr(new FlushContainer(*this));
@@ -463,30 +590,30 @@ void DataColumn::fillRow(const TimeContainer::IteratorData& timeIdxData, TableRo
 // Start iteration at the beginning of the container (smallest time).
 TableColumn::Iterator DataColumn::begin() const
 {
-  return Iterator(new ColumnIteratorImpl(freshData_, staleData_, timeContainer_->begin()));
+  return Iterator(new ColumnIteratorImpl(this, freshData_, staleData_, timeContainer_->begin()));
 }
 
 // Iterator representing the back of the container (largest time).
 TableColumn::Iterator DataColumn::end() const
 {
-  return Iterator(new ColumnIteratorImpl(freshData_, staleData_, timeContainer_->end()));
+  return Iterator(new ColumnIteratorImpl(this, freshData_, staleData_, timeContainer_->end()));
 }
 
 // Returns lower_bound() iterator into container
 TableColumn::Iterator DataColumn::lower_bound(double timeValue) const
 {
-  return Iterator(new ColumnIteratorImpl(freshData_, staleData_, timeContainer_->lower_bound(timeValue)));
+  return Iterator(new ColumnIteratorImpl(this, freshData_, staleData_, timeContainer_->lower_bound(timeValue)));
 }
 
 // Returns upper_bound() iterator into container
 TableColumn::Iterator DataColumn::upper_bound(double timeValue) const
 {
-  return Iterator(new ColumnIteratorImpl(freshData_, staleData_, timeContainer_->upper_bound(timeValue)));
+  return Iterator(new ColumnIteratorImpl(this, freshData_, staleData_, timeContainer_->upper_bound(timeValue)));
 }
 
 TableColumn::Iterator DataColumn::findAtOrBeforeTime(double timeValue) const
 {
-  return Iterator(new ColumnIteratorImpl(freshData_, staleData_, timeContainer_->findTimeAtOrBeforeGivenTime(timeValue)));
+  return Iterator(new ColumnIteratorImpl(this, freshData_, staleData_, timeContainer_->findTimeAtOrBeforeGivenTime(timeValue)));
 }
 
 DataContainer* DataColumn::newDataContainer_(simData::VariableType variableType) const
@@ -515,6 +642,12 @@ void DataColumn::swapFreshStaleData()
   DataContainer* tmpNew = freshData_;
   freshData_ = staleData_;
   staleData_ = tmpNew;
+
+  // Keep summarizing new data if the old data was summarized
+  const bool summarized = (freshSummary_ != nullptr);
+  staleSummary_ = std::move(freshSummary_);
+  if (summarized)
+    freshSummary_ = std::make_unique<MinMaxPyramid>();
 }
 
 DataContainer* DataColumn::dataContainer_(bool freshContainer) const
@@ -526,4 +659,155 @@ int DataColumn::getTimeRange(double& begin, double& end) const
 {
   return timeContainer_->getTimeRange(begin, end);
 }
+
+TableStatus DataColumn::getValueSpans(double beginTime, double endTime, std::vector<ValueSpan>& spans) const
+{
+  spans.clear();
+  std::vector<TimeContainer::IndexRun> runs;
+  timeContainer_->getIndexRuns(beginTime, endTime, runs);
+  for (const auto& run : runs)
+  {
+    const DataContainer* container = dataContainer_(run.isFreshBin);
+    // Assertion failure means the time container and data container are out of sync
+    assert(run.firstIndex + run.count <= container->size());
+    if (run.firstIndex + run.count > container->size())
+      return TableStatus::Error("Column data out of sync with times.");
+
+    ValueSpan span;
+    span.type = variableType_;
+    span.data = valueAt_(container, run.firstIndex);
+    span.size = run.count;
+    span.beginTime = run.beginTime;
+    span.endTime = run.endTime;
+    spans.push_back(span);
+  }
+  return TableStatus::Success();
+}
+
+TableStatus DataColumn::statistics(double beginTime, double endTime, double threshold, Statistics& stats) const
+{
+  stats = Statistics();
+  if (variableType_ == VT_STRING)
+    return TableStatus::Error("Statistics not available for string columns.");
+  std::vector<ValueSpan> spans;
+  TableStatus rv = getValueSpans(beginTime, endTime, spans);
+  if (!rv.isSuccess())
+    return rv;
+  for (const auto& span : spans)
+    accumulateStatistics(span, threshold, stats);
+  return TableStatus::Success();
+}
+
+TableStatus DataColumn::getMinMaxBuckets(double beginTime, double endTime, size_t numBuckets, std::vector<MinMaxBucket>& buckets) const
+{
+  buckets.clear();
+  if (variableType_ == VT_STRING)
+    return TableStatus::Error("Min/max buckets not available for string columns.");
+  if (numBuckets == 0 || endTime <= beginTime)
+    return TableStatus::Success();
+
+  // Summaries are built on first use, then kept up to date as values change
+  for (bool fresh : { false, true })
+  {
+    std::unique_ptr<MinMaxPyramid>& summary = summary_(fresh);
+    const DataContainer& container = *dataContainer_(fresh);
+    if (summary && summary->size() == container.size())
+      continue;
+    summary = std::make_unique<MinMaxPyramid>();
+    visitNumericValues(variableType_, container, [&summary](auto values) { summary->rebuild(values); });
+  }
+
+  buckets.resize(numBuckets);
+  const double width = (endTime - beginTime) / static_cast<double>(numBuckets);
+  std::vector<TimeContainer::IndexRun> runs;
+  for (size_t ii = 0; ii < numBuckets; ++ii)
+  {
+    MinMaxBucket& bucket = buckets[ii];
+    // Computing both ends the same way keeps adjacent buckets from overlapping
+    bucket.beginTime = beginTime + width * ii;
+    const double bucketEnd = (ii + 1 == numBuckets) ? endTime : beginTime + width * (ii + 1);
+    runs.clear();
+    timeContainer_->getIndexRuns(bucket.beginTime, bucketEnd, runs);
+
+    MinMaxPyramid::Extremes extremes;
+    const TimeContainer::IndexRun* minRun = nullptr;
+    const TimeContainer::IndexRun* maxRun = nullptr;
+    for (const auto& run : runs)
+    {
+      const MinMaxPyramid& summary = *summary_(run.isFreshBin);
+      MinMaxPyramid::Extremes runExtremes;
+      visitNumericValues(variableType_, *dataContainer_(run.isFreshBin), [&](auto values) {
+        runExtremes = summary.query(values, run.firstIndex, run.count);
+      });
+      if (runExtremes.numValid != 0 && (extremes.numValid == 0 || runExtremes.minValue < extremes.minValue))
+        minRun = &run;
+      if (runExtremes.numValid != 0 && (extremes.numValid == 0 || runExtremes.maxValue > extremes.maxValue))
+        maxRun = &run;
+      extremes.add(runExtremes);
+    }
+
+    bucket.count = extremes.numValid;
+    if (extremes.numValid == 0)
+      continue;
+    bucket.minValue = extremes.minValue;
+    bucket.minTime = timeContainer_->positionTime(minRun->isFreshBin, minRun->firstPosition + (extremes.minIndex - minRun->firstIndex));
+    bucket.maxValue = extremes.maxValue;
+    bucket.maxTime = timeContainer_->positionTime(maxRun->isFreshBin, maxRun->firstPosition + (extremes.maxIndex - maxRun->firstIndex));
+  }
+  return TableStatus::Success();
+}
+
+std::unique_ptr<MinMaxPyramid>& DataColumn::summary_(bool freshContainer) const
+{
+  return freshContainer ? freshSummary_ : staleSummary_;
+}
+
+void DataColumn::summarizeInsert_(bool freshContainer, size_t position)
+{
+  std::unique_ptr<MinMaxPyramid>& summary = summary_(freshContainer);
+  if (!summary)
+    return;
+  const DataContainer& container = *dataContainer_(freshContainer);
+  // Rows are appended in practice; anything else shifts indices, so rebuild when next needed
+  if (position + 1 < container.size() || summary->size() + 1 != container.size())
+  {
+    summary.reset();
+    return;
+  }
+  visitNumericValues(variableType_, container, [&summary](auto values) { summary->append(values); });
+}
+
+void DataColumn::summarizeReplace_(bool freshContainer, size_t position) const
+{
+  std::unique_ptr<MinMaxPyramid>& summary = summary_(freshContainer);
+  if (!summary)
+    return;
+  const DataContainer& container = *dataContainer_(freshContainer);
+  if (summary->size() != container.size())
+  {
+    summary.reset();
+    return;
+  }
+  visitNumericValues(variableType_, container, [&summary, position](auto values) { summary->update(values, position); });
+}
+
+const void* DataColumn::valueAt_(const DataContainer* container, size_t index) const
+{
+  const char* first = static_cast<const char*>(container->data());
+  switch (variableType_)
+  {
+  case VT_UINT8: return first + index * sizeof(uint8_t);
+  case VT_INT8: return first + index * sizeof(int8_t);
+  case VT_UINT16: return first + index * sizeof(uint16_t);
+  case VT_INT16: return first + index * sizeof(int16_t);
+  case VT_UINT32: return first + index * sizeof(uint32_t);
+  case VT_INT32: return first + index * sizeof(int32_t);
+  case VT_UINT64: return first + index * sizeof(uint64_t);
+  case VT_INT64: return first + index * sizeof(int64_t);
+  case VT_FLOAT: return first + index * sizeof(float);
+  case VT_DOUBLE: return first + index * sizeof(double);
+  case VT_STRING: return first + index * sizeof(std::string);
+  }
+  return nullptr;
+}
 } }
@@ -23,6 +23,8 @@
 #ifndef SIMDATA_MEMORYTABLE_DATACOLUMN_H
 #define SIMDATA_MEMORYTABLE_DATACOLUMN_H
 
+#include <memory>
+#include <span>
 #include <string>
 #include "simData/DataTable.h"
 #include "simData/MemoryTable/DataContainer.h"
@@ -30,11 +32,13 @@
 
 namespace simData { namespace MemoryTable {
 
+class MinMaxPyramid;
+
 /**
  * Implementation of the table column.  Private inside the .cpp to prevent others from
  * accessing the internal public functions that aren't in the virtual interface.
- * This implementation holds onto data in a deque and lets the time container dictate
- * where values ought to be placed inside the deque.
+ * This implementation holds onto data in a vector and lets the time container dictate
+ * where values ought to be placed inside the vector.
  */
 class DataColumn : public simData::TableColumn
 {
@@ -49,13 +53,20 @@ public:
   void insert(bool freshContainer, size_t position, const DataType& value)
   {
     dataContainer_(freshContainer)->insert(position, value);
+    summarizeInsert_(freshContainer, position);
   }
 
+  /** Appends values to a data container, whose size must be position; the rows must be after all rows of the container */
+  void append(bool freshContainer, size_t position, std::span<const double> values);
+
   /** Replaces a value in a data container with a template value */
   template <typename DataType>
   TableStatus replace(bool freshContainer, size_t position, const DataType& value)
   {
-    return dataContainer_(freshContainer)->replace(position, value);
+    const TableStatus rv = dataContainer_(freshContainer)->replace(position, value);
+    if (rv.isSuccess())
+      summarizeReplace_(freshContainer, position);
+    return rv;
   }
 
   /** Retrieves the value of a data cell using templates */
@@ -134,15 +145,33 @@ public:
    */
   int getTimeRange(double& begin, double& end) const override;
 
+  /** Retrieves the values of rows in [beginTime, endTime) as contiguous spans, one or more per bin */
+  TableStatus getValueSpans(double beginTime, double endTime, std::vector<ValueSpan>& spans) const override;
+  /** Computes statistics of the values of rows in [beginTime, endTime) from the value spans */
+  TableStatus statistics(double beginTime, double endTime, double threshold, Statistics& stats) const override;
+  /** Finds the smallest and largest values of equal intervals of [beginTime, endTime) from the summary of each bin */
+  TableStatus getMinMaxBuckets(double beginTime, double endTime, size_t numBuckets, std::vector<MinMaxBucket>& buckets) const override;
+
 private:
   /// Allocates a new data container based on the data storage type
   DataContainer* newDataContainer_(simData::VariableType variableType) const;
   /// Retrieves the data container, fresh or stale, as requested
   DataContainer* dataContainer_(bool freshContainer) const;
+  /// Returns the address of the value at the index of the container
+  const void* valueAt_(const DataContainer* container, size_t index) const;
+  /// Retrieves the summary of the fresh or stale data
+  std::unique_ptr<MinMaxPyramid>& summary_(bool freshContainer) const;
+  /// Updates the summary, if any, after a value was inserted
+  void summarizeInsert_(bool freshContainer, size_t position);
+  /// Updates the summary, if any, after a value was replaced
+  void summarizeReplace_(bool freshContainer, size_t position) const;
 
   TimeContainer* timeContainer_;
   DataContainer* freshData_;
   DataContainer* staleData_;
+  /// Summaries of the fresh and stale data for getMinMaxBuckets(); null until first needed
+  mutable std::unique_ptr<MinMaxPyramid> freshSummary_;
+  mutable std::unique_ptr<MinMaxPyramid> staleSummary_;
 
   std::string name_;
   TableId tableId_;
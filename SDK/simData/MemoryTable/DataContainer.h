@@ -23,6 +23,7 @@
 #ifndef SIMDATA_MEMORYTABLE_DATACONTAINER_H
 #define SIMDATA_MEMORYTABLE_DATACONTAINER_H
 
+#include <span>
 #include "simData/DataTable.h"
 
 namespace simData { namespace MemoryTable {
@@ -50,6 +51,9 @@ public:
   virtual void insert(size_t position, const std::string& value) = 0;
   ///@}
 
+  /** Appends the values to the end of the data container, converted to the container's type */
+  virtual void append(std::span<const double> values) = 0;
+
   /**@name Data Container replace() methods
    * @{
    */
@@ -87,6 +91,9 @@ public:
   /** Copies the contents of a given position into a row at cell position whichCell */
   virtual TableStatus copyToRowCell(TableRow& row, simData::TableColumnId whichCell, size_t position) const = 0;
 
+  /** Returns the first item; items are stored contiguously, as the type of the container's column */
+  virtual const void* data() const = 0;
+
   /** Removes the elements starting at the given index */
   virtual void erase(size_t position, size_t number = 1) = 0;
   /** Number of items inside the data container */
@@ -410,6 +410,7 @@ DoubleBufferTimeContainer::DoubleBufferTimeContainer()
 {
   times_[BIN_STALE] = &timesA_;
   times_[BIN_FRESH] = &timesB_;
+  inOrder_[BIN_STALE] = inOrder_[BIN_FRESH] = true;
 }
 
 DoubleBufferTimeContainer::DoubleBufferTimeContainer(const DoubleBufferTimeContainer& copyFrom)
@@ -427,6 +428,8 @@ DoubleBufferTimeContainer::DoubleBufferTimeContainer(const DoubleBufferTimeConta
     times_[BIN_FRESH] = &timesA_;
     times_[BIN_STALE] = &timesB_;
   }
+  inOrder_[BIN_STALE] = copyFrom.inOrder_[BIN_STALE];
+  inOrder_[BIN_FRESH] = copyFrom.inOrder_[BIN_FRESH];
 }
 
 DoubleBufferTimeContainer::~DoubleBufferTimeContainer()
@@ -573,19 +576,37 @@ TimeContainer::Iterator DoubleBufferTimeContainer::findOrAddTime(double timeValu
   // performance testing, and to test the validity of iterator crossing containers
   //if (size() % 2 == 0)
   //  return newIterator_(BIN_STALE, staleDeq.insert(iterStale, itemToInsert), iterFresh);
+  // Data is appended, so a row inserted before the last time breaks the time order of the data
+  if (iterFresh != freshDeq.end())
+    inOrder_[BIN_FRESH] = false;
   return newIterator_(BIN_FRESH, iterStale, freshDeq.insert(iterFresh, itemToInsert));
 }
 
+size_t DoubleBufferTimeContainer::appendTimes(std::span<const double> times, bool& isFreshBin)
+{
+  // Same as findOrAddTime() for each time, which adds a time after all others at the end of the fresh bin
+  TimeIndexDeque& freshDeq = freshTimes_();
+  const size_t firstIndex = freshDeq.size();
+  for (size_t ii = 0; ii < times.size(); ++ii)
+    freshDeq.emplace_back(times[ii], firstIndex + ii);
+  isFreshBin = true;
+  return firstIndex;
+}
+
 void DoubleBufferTimeContainer::erase(TimeContainer::Iterator iter, TimeContainer::EraseBehavior eraseBehavior)
 {
   DoubleBufferIterator* dbIter = dynamic_cast<DoubleBufferIterator*>(iter.impl());
   if (dbIter != nullptr)
     dbIter->erase(eraseBehavior);
+  // Fixing the offsets keeps the order; a quick erase leaves a gap in the indices
+  if (eraseBehavior == ERASE_QUICK)
+    inOrder_[BIN_STALE] = inOrder_[BIN_FRESH] = false;
 }
 
 simData::DelayedFlushContainerPtr DoubleBufferTimeContainer::flush()
 {
   // Optimize for case where both are empty (no memory allocation)
+  inOrder_[BIN_STALE] = inOrder_[BIN_FRESH] = true;
   if (timesA_.empty() && timesB_.empty())
     return DelayedFlushContainerPtr();
   return DelayedFlushContainerPtr(new FlushContainer(timesA_, timesB_));
@@ -736,6 +757,8 @@ void DoubleBufferTimeContainer::swapFreshStaleData(DataTable* table, const std::
   times_[BIN_STALE] = times_[BIN_FRESH];
   times_[BIN_FRESH] = tmp;
   times_[BIN_FRESH]->clear();
+  inOrder_[BIN_STALE] = inOrder_[BIN_FRESH];
+  inOrder_[BIN_FRESH] = true;
 }
 
 void DoubleBufferTimeContainer::limitData(size_t maxPoints, double latestInvalidTime,
@@ -807,4 +830,63 @@ int DoubleBufferTimeContainer::getTimeRange(double& begin, double& end) const
   return 0;
 }
 
+void DoubleBufferTimeContainer::getIndexRuns(double beginTime, double endTime, std::vector<IndexRun>& runs) const
+{
+  getIndexRuns_(BIN_STALE, beginTime, endTime, runs);
+  getIndexRuns_(BIN_FRESH, beginTime, endTime, runs);
+}
+
+void DoubleBufferTimeContainer::getIndexRuns_(size_t whichBin, double beginTime, double endTime, std::vector<IndexRun>& runs) const
+{
+  if (endTime <= beginTime)
+    return;
+  const TimeIndexDeque& deq = *times_[whichBin];
+  LessThan lessThan;
+  const auto start = std::lower_bound(deq.begin(), deq.end(), beginTime, lessThan);
+  const auto end = std::lower_bound(start, deq.end(), endTime, lessThan);
+  if (start == end)
+    return;
+
+  IndexRun run;
+  run.isFreshBin = (whichBin == BIN_FRESH);
+  run.firstIndex = start->second;
+  run.firstPosition = std::distance(deq.begin(), start);
+  run.beginTime = start->first;
+  if (inOrder_[whichBin])
+  {
+    // Position and data index match, so the whole range is one run
+    run.count = std::distance(start, end);
+    run.endTime = (end - 1)->first;
+    runs.push_back(run);
+    return;
+  }
+
+  // Start a new run wherever the next row's data does not follow the previous row's
+  run.count = 1;
+  run.endTime = start->first;
+  for (auto iter = start + 1; iter != end; ++iter)
+  {
+    if (iter->second == run.firstIndex + run.count)
+    {
+      ++run.count;
+      run.endTime = iter->first;
+      continue;
+    }
+    runs.push_back(run);
+    run.firstIndex = iter->second;
+    run.firstPosition = std::distance(deq.begin(), iter);
+    run.count = 1;
+    run.beginTime = run.endTime = iter->first;
+  }
+  runs.push_back(run);
+}
+
+double DoubleBufferTimeContainer::positionTime(bool isFreshBin, size_t position) const
+{
+  const TimeIndexDeque& deq = *times_[isFreshBin ? BIN_FRESH : BIN_STALE];
+  // Assertion failure means the position did not come from an IndexRun of this container
+  assert(position < deq.size());
+  return deq[position].first;
+}
+
 } }
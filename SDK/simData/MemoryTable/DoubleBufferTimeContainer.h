@@ -63,6 +63,7 @@ public:
   TimeContainer::Iterator findTimeAtOrBeforeGivenTime(double timeValue) override;
   TimeContainer::Iterator find(double timeValue) override;
   TimeContainer::Iterator findOrAddTime(double timeValue, bool* exactMatch=nullptr) override;
+  size_t appendTimes(std::span<const double> times, bool& isFreshBin) override;
   void erase(Iterator iter, EraseBehavior eraseBehavior) override;
   DelayedFlushContainerPtr flush() override;
   void flush(const std::vector<DataColumn*>& columns, double startTime, double endTime) override;
@@ -79,6 +80,11 @@ public:
    */
   int getTimeRange(double& begin, double& end) const override;
 
+  /// @copydoc TimeContainer::getIndexRuns()
+  void getIndexRuns(double beginTime, double endTime, std::vector<IndexRun>& runs) const override;
+  /// @copydoc TimeContainer::positionTime()
+  double positionTime(bool isFreshBin, size_t position) const override;
+
   /** Swaps the fresh to stale, stale to fresh, and clears out the fresh vector; announces all items removed */
   void swapFreshStaleData(DataTable* table, const std::vector<DataTable::TableObserverPtr>& observers);
 
@@ -89,6 +95,7 @@ private:
   void flush_(TimeIndexDeque& deq, bool fresh, const std::vector<DataColumn*>& columns, double startTime, double endTime);
   TimeIndexDeque::iterator lowerBound_(TimeIndexDeque& deq, double timeValue, bool* exactMatch=nullptr) const;
   TimeIndexDeque::iterator upperBound_(TimeIndexDeque& deq, double timeValue) const;
+  void getIndexRuns_(size_t whichBin, double beginTime, double endTime, std::vector<IndexRun>& runs) const;
   TimeContainer::Iterator newIterator_(size_t whichBin, TimeIndexDeque::iterator staleIter, TimeIndexDeque::iterator freshIter);
 
   TimeIndexDeque& freshTimes_() const;
@@ -97,6 +104,8 @@ private:
   TimeIndexDeque timesA_;
   TimeIndexDeque timesB_;
   TimeIndexDeque* times_[2];
+  /// True for a bin whose entry at each position has that position as its data index, i.e. rows were added in time order
+  bool inOrder_[2];
   class DoubleBufferIterator;
   class FlushContainer;
 };
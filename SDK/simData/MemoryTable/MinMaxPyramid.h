@@ -0,0 +1,260 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_MEMORYTABLE_MINMAXPYRAMID_H
+#define SIMDATA_MEMORYTABLE_MINMAXPYRAMID_H
+
+#include <algorithm>
+#include <cassert>
+#include <span>
+#include <vector>
+
+namespace simData { namespace MemoryTable {
+
+/**
+ * Multi-resolution summary of the smallest and largest values of a data container, indexed like
+ * the container.  The lowest level summarizes blocks of LEAF_SIZE values, each higher level
+ * blocks of FANOUT blocks below it.  The smallest and largest values of any index range then
+ * take O(LEAF_SIZE + FANOUT * levels) steps instead of one per value.  Appending values updates
+ * one block per level.  NaN values are not summarized.
+ *
+ * Removing values from the front, as data limiting does, only moves a front offset.  Blocks are
+ * indexed from the first value ever summarized, so blocks that start at or after the front stay
+ * valid; blocks before the front are released once they make up half of the summary.
+ */
+class MinMaxPyramid
+{
+public:
+  /// Smallest and largest values of a range, and their indices
+  struct Extremes
+  {
+    /// Number of values that are not NaN; the rest of the fields are only valid if non-zero
+    size_t numValid = 0;
+    double minValue = 0.0;
+    size_t minIndex = 0;
+    double maxValue = 0.0;
+    size_t maxIndex = 0;
+
+    /** Adds a value at the given index */
+    void add(double value, size_t index)
+    {
+      if (value != value)
+        return;
+      if (numValid == 0 || value < minValue)
+      {
+        minValue = value;
+        minIndex = index;
+      }
+      if (numValid == 0 || value > maxValue)
+      {
+        maxValue = value;
+        maxIndex = index;
+      }
+      ++numValid;
+    }
+
+    /** Adds the values summarized by other */
+    void add(const Extremes& other)
+    {
+      if (other.numValid == 0)
+        return;
+      if (numValid == 0 || other.minValue < minValue)
+      {
+        minValue = other.minValue;
+        minIndex = other.minIndex;
+      }
+      if (numValid == 0 || other.maxValue > maxValue)
+      {
+        maxValue = other.maxValue;
+        maxIndex = other.maxIndex;
+      }
+      numValid += other.numValid;
+    }
+  };
+
+  /// Number of values in a lowest level block
+  static constexpr size_t LEAF_SIZE = 64;
+  /// Number of blocks of one level in a block of the next level
+  static constexpr size_t FANOUT = 8;
+
+  /** Number of values summarized */
+  size_t size() const
+  {
+    return end_ - head_;
+  }
+
+  /** Summarizes all of the values, replacing the current summary */
+  template <typename T>
+  void rebuild(std::span<const T> values)
+  {
+    levels_.clear();
+    head_ = 0;
+    end_ = 0;
+    append(values);
+  }
+
+  /** Summarizes the values past size(); values before size() must be unchanged */
+  template <typename T>
+  void append(std::span<const T> values)
+  {
+    for (size_t index = end_; index < head_ + values.size(); ++index)
+    {
+      const double value = static_cast<double>(values[index - head_]);
+      size_t blockSize = LEAF_SIZE;
+      for (size_t level = 0; ; ++level, blockSize *= FANOUT)
+      {
+        // Add a higher level once it would hold more than one block
+        if (level == levels_.size())
+        {
+          if (level > 0 && index < blockSize)
+            break;
+          levels_.emplace_back();
+          if (level > 0)
+          {
+            // The first block of the new level covers the blocks below it before this value's
+            levels_.back().emplace_back();
+            for (size_t ii = 0; ii < FANOUT; ++ii)
+              levels_.back().back().add(levels_[level - 1][ii]);
+          }
+        }
+        std::vector<Extremes>& blocks = levels_[level];
+        if (index / blockSize == blocks.size())
+          blocks.emplace_back();
+        blocks.back().add(value, index);
+      }
+    }
+    end_ = head_ + values.size();
+  }
+
+  /** Drops the first count values, after they were removed from the front of the values */
+  void eraseFront(size_t count)
+  {
+    assert(count <= size());
+    head_ += count;
+    if (head_ == end_)
+    {
+      levels_.clear();
+      head_ = 0;
+      end_ = 0;
+      return;
+    }
+    compact_();
+  }
+
+  /** Resummarizes the blocks holding the value at index, after the value changed */
+  template <typename T>
+  void update(std::span<const T> values, size_t index)
+  {
+    assert(index < size() && values.size() == size());
+    index += head_;
+    size_t blockSize = LEAF_SIZE;
+    for (size_t level = 0; level < levels_.size(); ++level, blockSize *= FANOUT)
+    {
+      const size_t block = index / blockSize;
+      Extremes& extremes = levels_[level][block];
+      extremes = Extremes();
+      if (level == 0)
+      {
+        const size_t end = std::min(end_, (block + 1) * LEAF_SIZE);
+        for (size_t ii = std::max(head_, block * LEAF_SIZE); ii < end; ++ii)
+          extremes.add(static_cast<double>(values[ii - head_]), ii);
+        continue;
+      }
+      const std::vector<Extremes>& below = levels_[level - 1];
+      const size_t end = std::min(below.size(), (block + 1) * FANOUT);
+      for (size_t ii = block * FANOUT; ii < end; ++ii)
+        extremes.add(below[ii]);
+    }
+  }
+
+  /** Returns the extremes of the count values starting at first */
+  template <typename T>
+  Extremes query(std::span<const T> values, size_t first, size_t count) const
+  {
+    assert(values.size() == size() && first + count <= size());
+    Extremes extremes;
+    const size_t end = head_ + first + count;
+    size_t index = head_ + first;
+    while (index < end)
+    {
+      // Take the largest whole block starting here, or a single value if none fits
+      size_t level = levels_.size();
+      size_t blockSize = LEAF_SIZE;
+      for (size_t ii = 0; ii < levels_.size() && index % blockSize == 0 && index + blockSize <= end; ++ii, blockSize *= FANOUT)
+        level = ii;
+      if (level == levels_.size())
+      {
+        extremes.add(static_cast<double>(values[index - head_]), index);
+        ++index;
+        continue;
+      }
+      blockSize = LEAF_SIZE;
+      for (size_t ii = 0; ii < level; ++ii)
+        blockSize *= FANOUT;
+      extremes.add(levels_[level][index / blockSize]);
+      index += blockSize;
+    }
+    // Blocks used start at or after the front, so hold no dropped values
+    extremes.minIndex -= head_;
+    extremes.maxIndex -= head_;
+    return extremes;
+  }
+
+private:
+  /**
+   * Releases the blocks before the front once they are half of the summary, in whole blocks of
+   * the highest level so that block boundaries stay aligned on every level
+   */
+  void compact_()
+  {
+    size_t topBlockSize = LEAF_SIZE;
+    for (size_t level = 1; level < levels_.size(); ++level)
+      topBlockSize *= FANOUT;
+    const size_t shift = (head_ / topBlockSize) * topBlockSize;
+    if (shift == 0 || 2 * head_ < end_)
+      return;
+
+    size_t blockSize = LEAF_SIZE;
+    for (std::vector<Extremes>& blocks : levels_)
+    {
+      blocks.erase(blocks.begin(), blocks.begin() + shift / blockSize);
+      for (Extremes& extremes : blocks)
+      {
+        extremes.minIndex -= shift;
+        extremes.maxIndex -= shift;
+      }
+      blockSize *= FANOUT;
+    }
+    head_ -= shift;
+    end_ -= shift;
+  }
+
+  std::vector<std::vector<Extremes> > levels_;
+  /// Index of the first value, counted from the first value summarized
+  size_t head_ = 0;
+  /// Index past the last value, counted from the first value summarized
+  size_t end_ = 0;
+};
+
+}}
+
+#endif /* SIMDATA_MEMORYTABLE_MINMAXPYRAMID_H */
@@ -459,6 +459,43 @@ SubTable::AddRowTransactionPtr SubTable::addRow(double timeStamp, SplitObserverP
   return AddRowTransactionPtr(new AddRowTransactionImpl(*this, timeStamp, splitObserver));
 }
 
+TableStatus SubTable::appendRows(std::span<const double> times, const std::vector<ColumnValues>& columnValues)
+{
+  if (times.empty())
+    return TableStatus::Success();
+  if (columnValues.size() != columns_.size())
+    return TableStatus::Error("Appended rows must have a value for every column in subtable.");
+  for (const auto& idAndValues : columnValues)
+  {
+    if (findColumn_(idAndValues.first) == nullptr)
+      return TableStatus::Error("Column does not exist in subtable.");
+    if (idAndValues.second.size() != times.size())
+      return TableStatus::Error("Appended rows must have a value for every column in subtable.");
+  }
+  double beginTime = 0.0;
+  double endTime = 0.0;
+  if (timeContainer_->getTimeRange(beginTime, endTime) == 0 && !(times.front() > endTime))
+    return TableStatus::Error("Appended rows must be after all rows in subtable.");
+  for (size_t ii = 1; ii < times.size(); ++ii)
+  {
+    if (!(times[ii] > times[ii - 1]))
+      return TableStatus::Error("Appended rows must be in increasing time order.");
+  }
+
+  bool isFreshBin = true;
+  const size_t firstIndex = timeContainer_->appendTimes(times, isFreshBin);
+  for (const auto& idAndValues : columnValues)
+  {
+    findColumn_(idAndValues.first)->append(isFreshBin, firstIndex, idAndValues.second);
+  }
+  return TableStatus::Success();
+}
+
+int SubTable::getTimeRange(double& begin, double& end) const
+{
+  return timeContainer_->getTimeRange(begin, end);
+}
+
 SubTable::Iterator SubTable::begin()
 {
   return Iterator(new IteratorImpl(this, timeContainer_->begin()));
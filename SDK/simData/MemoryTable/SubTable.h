@@ -25,6 +25,7 @@
 
 #include <map>
 #include <memory>
+#include <span>
 #include <vector>
 #include <utility>
 #include "simData/GenericIterator.h"
@@ -111,6 +112,25 @@ public:
    */
   AddRowTransactionPtr addRow(double timeStamp, SplitObserverPtr splitObserver);
 
+  /** Column ID and the values of that column for appendRows(), one per row */
+  typedef std::pair<TableColumnId, std::span<const double> > ColumnValues;
+  /**
+   * Adds rows with a value for every column of the subtable, appending each column's values at
+   * once.  Rows are added after all rows of the subtable, so no split can occur.
+   * @param times Row times, increasing and later than every time in the subtable
+   * @param columnValues Values of each column of the subtable, one per row
+   * @return Error, without adding any rows, if the times or columns do not meet the requirements
+   */
+  TableStatus appendRows(std::span<const double> times, const std::vector<ColumnValues>& columnValues);
+
+  /**
+   * Returns the begin and end time of the rows
+   * @param begin Returns the begin time
+   * @param end Returns the end time
+   * @returns 0 if begin and end are set
+   */
+  int getTimeRange(double& begin, double& end) const;
+
   /**
    * Creates a column with given parameters, returning it to the caller.  This call
    * will fail if there is any data in the subtable (i.e. if rowCount() > 0).
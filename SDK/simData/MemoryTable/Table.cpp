@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <cassert>
 #include <limits>
+#include <optional>
 #include <set>
 #include "simCore/Calc/Math.h"
 #include "simData/TableCellTranslator.h"
@@ -492,18 +493,113 @@ TableStatus Table::addRow(const TableRow& row)
   // Do data limiting when rows are added
   // TODO: This could feasibly be optimized across the data store with a parallel for-each
   //   that does data limiting at preset intervals
-  if (dataLimits_ != nullptr)
+  applyDataLimits_();
+  return rv;
+}
+
+TableStatus Table::addRows(const TableRowBlock& block)
+{
+  if (block.empty())
+    return TableStatus::Error("Cannot add empty block of rows.");
+  const std::vector<TableColumnId>& columnIds = block.columnIds();
+  if (columnIds.empty())
+    return TableStatus::Error("Cannot add rows without columns.");
+  const std::vector<double>& times = block.times();
+
+  // Group the values by subtable, checking each column before adding anything
+  std::map<SubTable*, std::vector<SubTable::ColumnValues> > valuesBySubTable;
+  std::set<TableColumnId> blockColumns;
+  for (size_t ii = 0; ii < columnIds.size(); ++ii)
+  {
+    SubTable* subTable = subTableForId_(columnIds[ii]);
+    if (subTable == nullptr)
+      return TableStatus::Error("Table column ID not found.");
+    if (!blockColumns.insert(columnIds[ii]).second)
+      return TableStatus::Error("Duplicate column ID in block of rows.");
+    if (block.values(ii).size() != times.size())
+      return TableStatus::Error("Block of rows must have a value for every column in every row.");
+    valuesBySubTable[subTable].emplace_back(columnIds[ii], block.values(ii));
+  }
+
+  // Rows in time order after all rows of their subtables, with values for all of the subtables'
+  // columns, are appended a column at a time.  Anything else goes row by row as in addRow(), which
+  // finds each time and splits subtables as needed.
+  bool append = true;
+  for (size_t ii = 1; ii < times.size() && append; ++ii)
+    append = (times[ii] > times[ii - 1]);
+  for (auto i = valuesBySubTable.begin(); i != valuesBySubTable.end() && append; ++i)
+  {
+    double beginTime = 0.0;
+    double endTime = 0.0;
+    append = (i->second.size() == i->first->columnCount()) &&
+      (i->first->getTimeRange(beginTime, endTime) != 0 || times.front() > endTime);
+  }
+
+  TableStatus rv = TableStatus::Success();
+  size_t numAdded = 0;
+  if (append)
   {
-    size_t pointsLimit = 0;
-    double secondsLimit = 0.0;
-    if (dataLimits_->getLimits(*this, pointsLimit, secondsLimit).isSuccess())
+    for (auto i = valuesBySubTable.begin(); i != valuesBySubTable.end() && rv.isSuccess(); ++i)
+      rv = i->first->appendRows(times, i->second);
+    if (rv.isError())
+      return rv;
+    numAdded = times.size();
+  }
+  else
+  {
+    TableRow row;
+    for (; numAdded < times.size(); ++numAdded)
     {
-      limitData_(pointsLimit, secondsLimit);
+      block.getRow(numAdded, row);
+      TransferCellsToSubTables transferCells(*this, row.time());
+      row.accept(transferCells);
+      rv = transferCells.visitStatus();
+      transferCells.finish();
+      if (rv.isError())
+        break;
     }
+    if (numAdded == 0)
+      return rv;
+  }
+
+  // Observers only hear of the rows that were added, which on a failure are the rows before it
+  std::optional<TableRowBlock> addedRows;
+  if (numAdded < times.size())
+  {
+    addedRows.emplace(columnIds);
+    addedRows->times().assign(times.begin(), times.begin() + numAdded);
+    for (size_t ii = 0; ii < columnIds.size(); ++ii)
+      addedRows->values(ii).assign(block.values(ii).begin(), block.values(ii).begin() + numAdded);
   }
+  const TableRowBlock& added = addedRows ? *addedRows : block;
+
+  const auto minMaxTime = std::minmax_element(added.times().begin(), added.times().end());
+  if (*minMaxTime.second > endTime_)
+    endTime_ = *minMaxTime.second;
+
+  // Alert the Data Store of the earliest and latest times, which bound the new time values
+  tableManager_.fireOnNewRowData(*this, *minMaxTime.first);
+  if (*minMaxTime.second != *minMaxTime.first)
+    tableManager_.fireOnNewRowData(*this, *minMaxTime.second);
+
+  // As in addRow(), notify before data limiting, which is done once for the whole block
+  fireOnAddRows_(added);
+  applyDataLimits_();
   return rv;
 }
 
+void Table::applyDataLimits_()
+{
+  if (dataLimits_ == nullptr)
+    return;
+  size_t pointsLimit = 0;
+  double secondsLimit = 0.0;
+  if (dataLimits_->getLimits(*this, pointsLimit, secondsLimit).isSuccess())
+  {
+    limitData_(pointsLimit, secondsLimit);
+  }
+}
+
 void Table::limitData_(size_t numToKeep, double timeWindow)
 {
   // Break out early if no limiting
@@ -579,6 +675,15 @@ void Table::fireOnAddRow_(const TableRow& row) const
   }
 }
 
+void Table::fireOnAddRows_(const TableRowBlock& block) const
+{
+  auto observersCopy = observers_;
+  for (TableObserverList::const_iterator i = observersCopy.begin(); i != observersCopy.end(); ++i)
+  {
+    (*i)->onAddRows(*const_cast<Table*>(this), block);
+  }
+}
+
 // TODO make calls to these when rows/columns are removed, which is not currently implemented
 void Table::fireOnPreRemoveColumn_(const TableColumn& column) const
 {
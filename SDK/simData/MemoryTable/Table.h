@@ -79,6 +79,8 @@ public:
   void accept(DataTable::ColumnVisitor& visitor) const override;
   /** Adds a row to the table. */
   TableStatus addRow(const TableRow& row) override;
+  /** Adds a block of rows to the table, appending each column's values at once when possible. */
+  TableStatus addRows(const TableRowBlock& block) override;
   /** Clears data out of the given column or all columns if given -1 */
   DelayedFlushContainerPtr flush(TableColumnId id = -1) override;
   /** Remove rows in the given time range; up to but not including endTime */
@@ -95,6 +97,8 @@ private:
   void fireOnAddColumn_(const TableColumn& column) const;
   /** Notify observers of new row */
   void fireOnAddRow_(const TableRow& row) const;
+  /** Notify observers of new block of rows */
+  void fireOnAddRows_(const TableRowBlock& block) const;
   /** Notify observers of column about to be removed */
   void fireOnPreRemoveColumn_(const TableColumn& column) const;
   /** Notify observers of row about to be removed */
@@ -106,6 +110,8 @@ private:
    * @param timeWindow Number of seconds of data to keep in memory
    */
   void limitData_(size_t numToKeep, double timeWindow);
+  /** Performs data limiting on the table using the limits from the provider, if any */
+  void applyDataLimits_();
 
 
   /// Pointer back to the owning table manager.
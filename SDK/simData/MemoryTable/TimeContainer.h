@@ -23,7 +23,9 @@
 #ifndef SIMDATA_MEMORYTABLE_TIMECONTAINER_H
 #define SIMDATA_MEMORYTABLE_TIMECONTAINER_H
 
+#include <span>
 #include <utility>
+#include <vector>
 #include "simCore/Common/Common.h"
 #include "simData/GenericIterator.h"
 #include "simData/DataTable.h"
@@ -153,6 +155,14 @@ public:
    * @param exactMatch If non-nullptr, will be set to false if added row, or true if found row
    */
   virtual Iterator findOrAddTime(double timeValue, bool* exactMatch=nullptr) = 0;
+  /**
+   * Adds times that are increasing and later than every time in the container.  The data of the
+   * new rows belong at consecutive indices at the end of one bin's data containers.
+   * @param times Times to add, in increasing order
+   * @param isFreshBin Set to true if the rows are in the 'fresh' bin, or false for 'stale'
+   * @return Data container index of the first new row
+   */
+  virtual size_t appendTimes(std::span<const double> times, bool& isFreshBin) = 0;
 
   /**
    * Performs data limiting for the container and associated columns
@@ -187,6 +197,31 @@ public:
    * @returns 0 if begin and end are set
    */
   virtual int getTimeRange(double& begin, double& end) const = 0;
+
+  /** Rows of one bin, in time order, whose data sit at consecutive indices of the data containers */
+  struct IndexRun
+  {
+    /// True for the 'fresh' bin, or false for the 'stale' bin
+    bool isFreshBin = true;
+    /// Data container index of the first row
+    size_t firstIndex = 0;
+    /// Position of the first row among the bin's times, for positionTime()
+    size_t firstPosition = 0;
+    /// Number of rows
+    size_t count = 0;
+    /// Time of the first row
+    double beginTime = 0.0;
+    /// Time of the last row
+    double endTime = 0.0;
+  };
+
+  /**
+   * Appends the runs covering the rows with times in [beginTime, endTime), for bulk access to
+   * the data containers.  Runs of each bin are in time order.
+   */
+  virtual void getIndexRuns(double beginTime, double endTime, std::vector<IndexRun>& runs) const = 0;
+  /** Returns the time at the position among the bin's times; the row at firstIndex + n of an IndexRun is at firstPosition + n */
+  virtual double positionTime(bool isFreshBin, size_t position) const = 0;
 };
 
 } }
@@ -0,0 +1,317 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cassert>
+#include <cmath>
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Coordinate.h"
+#include "simCore/Calc/CoordinateConverter.h"
+#include "simCore/Calc/Interpolation.h"
+#include "simCore/Calc/Math.h"
+#include "simData/PlatformInterpolationBatch.h"
+
+namespace simData
+{
+
+PlatformInterpolationBatch::PlatformInterpolationBatch()
+{
+}
+
+PlatformInterpolationBatch::~PlatformInterpolationBatch()
+{
+}
+
+void PlatformInterpolationBatch::clear()
+{
+  for (auto& component : values_)
+    component.clear();
+  times_.clear();
+  flags_.clear();
+  results_.clear();
+}
+
+void PlatformInterpolationBatch::reserve(size_t count)
+{
+  for (auto& component : values_)
+    component.reserve(count);
+  times_.reserve(count);
+  flags_.reserve(count);
+  results_.reserve(count);
+}
+
+size_t PlatformInterpolationBatch::size() const
+{
+  return results_.size();
+}
+
+void PlatformInterpolationBatch::add(double time, double factor, const simCore::Coordinate& prevEcef, const simCore::Coordinate& prevLla,
+  const simCore::Coordinate& nextEcef, const simCore::Coordinate& nextLla, PlatformUpdate* result)
+{
+  assert(result != nullptr);
+  uint8_t flags = 0;
+  if (prevEcef.hasOrientation() && nextEcef.hasOrientation())
+    flags |= HAS_ORIENTATION;
+  if (prevEcef.hasVelocity() && nextEcef.hasVelocity())
+    flags |= HAS_VELOCITY;
+
+  values_[PREV_X].push_back(prevEcef.x());
+  values_[PREV_Y].push_back(prevEcef.y());
+  values_[PREV_Z].push_back(prevEcef.z());
+  values_[NEXT_X].push_back(nextEcef.x());
+  values_[NEXT_Y].push_back(nextEcef.y());
+  values_[NEXT_Z].push_back(nextEcef.z());
+  values_[PREV_ALT].push_back(prevLla.alt());
+  values_[NEXT_ALT].push_back(nextLla.alt());
+
+  // Points without a component still get a slot, so that every array stays the same length
+  const bool hasOrientation = (flags & HAS_ORIENTATION) != 0;
+  values_[PREV_YAW].push_back(hasOrientation ? simCore::angFix2PI(prevLla.yaw()) : 0.0);
+  values_[PREV_PITCH].push_back(hasOrientation ? simCore::angFix2PI(prevLla.pitch()) : 0.0);
+  values_[PREV_ROLL].push_back(hasOrientation ? simCore::angFix2PI(prevLla.roll()) : 0.0);
+  values_[NEXT_YAW].push_back(hasOrientation ? simCore::angFix2PI(nextLla.yaw()) : 0.0);
+  values_[NEXT_PITCH].push_back(hasOrientation ? simCore::angFix2PI(nextLla.pitch()) : 0.0);
+  values_[NEXT_ROLL].push_back(hasOrientation ? simCore::angFix2PI(nextLla.roll()) : 0.0);
+
+  const bool hasVelocity = (flags & HAS_VELOCITY) != 0;
+  values_[PREV_VX].push_back(hasVelocity ? prevLla.vx() : 0.0);
+  values_[PREV_VY].push_back(hasVelocity ? prevLla.vy() : 0.0);
+  values_[PREV_VZ].push_back(hasVelocity ? prevLla.vz() : 0.0);
+  values_[NEXT_VX].push_back(hasVelocity ? nextLla.vx() : 0.0);
+  values_[NEXT_VY].push_back(hasVelocity ? nextLla.vy() : 0.0);
+  values_[NEXT_VZ].push_back(hasVelocity ? nextLla.vz() : 0.0);
+
+  values_[FACTOR].push_back(factor);
+  times_.push_back(time);
+  flags_.push_back(flags);
+  results_.push_back(result);
+}
+
+void PlatformInterpolationBatch::interpolate()
+{
+  interpolateComponents_();
+  for (size_t ii = 0; ii < results_.size(); ++ii)
+    writeResult_(ii);
+  clear();
+}
+
+void PlatformInterpolationBatch::interpolateComponents_()
+{
+  const size_t count = results_.size();
+  for (size_t component = X; component < NUM_COMPONENTS; ++component)
+    values_[component].resize(count);
+  const double* factor = values_[FACTOR].data();
+
+  // Same arithmetic as simCore::linearInterpolate(), in loops without branches
+  const auto lerp = [this, count, factor](Component prev, Component next, Component out)
+  {
+    const double* low = values_[prev].data();
+    const double* high = values_[next].data();
+    double* result = values_[out].data();
+    for (size_t ii = 0; ii < count; ++ii)
+      result[ii] = low[ii] + (high[ii] - low[ii]) * factor[ii];
+  };
+  lerp(PREV_X, NEXT_X, X);
+  lerp(PREV_Y, NEXT_Y, Y);
+  lerp(PREV_Z, NEXT_Z, Z);
+  lerp(PREV_ALT, NEXT_ALT, ALT);
+  lerp(PREV_VX, NEXT_VX, VX);
+  lerp(PREV_VY, NEXT_VY, VY);
+  lerp(PREV_VZ, NEXT_VZ, VZ);
+
+  // Angles in [0, 2PI) take the short way around; the selects give the same values as the branches of interpolate()
+  const auto angleLerp = [this, count, factor](Component prev, Component next, Component out)
+  {
+    const double* low = values_[prev].data();
+    const double* high = values_[next].data();
+    double* result = values_[out].data();
+    for (size_t ii = 0; ii < count; ++ii)
+    {
+      const double delta = high[ii] - low[ii];
+      const double shortDelta = (delta >= M_PI) ? (delta - M_TWOPI) : ((delta <= -M_PI) ? (delta + M_TWOPI) : delta);
+      result[ii] = (delta == 0.0) ? low[ii] : (low[ii] + factor[ii] * shortDelta);
+    }
+  };
+  angleLerp(PREV_YAW, NEXT_YAW, YAW);
+  angleLerp(PREV_PITCH, NEXT_PITCH, PITCH);
+  angleLerp(PREV_ROLL, NEXT_ROLL, ROLL);
+}
+
+void PlatformInterpolationBatch::writeResult_(size_t index)
+{
+  simCore::Vec3 lla;
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(simCore::Vec3(values_[X][index], values_[Y][index], values_[Z][index]), lla);
+
+  // Geodetic to ECEF with the interpolated altitude, as in CoordinateConverter::convertGeodeticPosToEcef()
+  const double sLat = sin(lla.lat());
+  const double cLat = cos(lla.lat());
+  const double sLon = sin(lla.lon());
+  const double cLon = cos(lla.lon());
+  const double alt = values_[ALT][index];
+  const double rn = simCore::WGS_A / sqrt(1.0 - simCore::WGS_ESQ * simCore::square(sLat));
+
+  PlatformUpdate& result = *results_[index];
+  result.set_time(times_[index]);
+  result.set_x((rn + alt) * cLat * cLon);
+  result.set_y((rn + alt) * cLat * sLon);
+  result.set_z((rn * (1.0 - simCore::WGS_ESQ) + alt) * sLat);
+
+  const uint8_t flags = flags_[index];
+  if (flags == 0)
+    return;
+
+  // NED local to earth matrix from the same sines and cosines, as in CoordinateConverter::setLocalToEarthMatrix()
+  const double localToEarth[3][3] = {
+    { -sLat * cLon, -sLat * sLon, cLat },
+    { -sLon, cLon, 0.0 },
+    { -cLat * cLon, -cLat * sLon, -sLat }
+  };
+
+  if ((flags & HAS_ORIENTATION) != 0)
+  {
+    double bodyToLocal[3][3];
+    double bodyToEarth[3][3];
+    simCore::d3EulertoDCM(simCore::Vec3(values_[YAW][index], values_[PITCH][index], values_[ROLL][index]), bodyToLocal);
+    simCore::d3MMmult(bodyToLocal, localToEarth, bodyToEarth);
+    simCore::Vec3 ori;
+    simCore::d3DCMtoEuler(bodyToEarth, ori);
+    result.set_psi(ori.psi());
+    result.set_theta(ori.theta());
+    result.set_phi(ori.phi());
+  }
+
+  if ((flags & HAS_VELOCITY) != 0)
+  {
+    // Local velocity is ENU; the matrix is NED
+    const simCore::Vec3 ned(values_[VY][index], values_[VX][index], -values_[VZ][index]);
+    simCore::Vec3 vel;
+    simCore::d3MTv3Mult(localToEarth, ned, vel);
+    result.set_vx(vel.x());
+    result.set_vy(vel.y());
+    result.set_vz(vel.z());
+  }
+}
+
+void PlatformInterpolationBatch::interpolate(double time, double factor, const simCore::Coordinate& prevEcef, const simCore::Coordinate& prevLla,
+  const simCore::Coordinate& nextEcef, const simCore::Coordinate& nextLla, PlatformUpdate& result)
+{
+  // do the interpolation in geocentric, this way the
+  // interpolation is correct at N/S and E/W transitions
+  simCore::Vec3 xyz(simCore::linearInterpolate(prevEcef.x(), nextEcef.x(), factor),
+    simCore::linearInterpolate(prevEcef.y(), nextEcef.y(), factor),
+    simCore::linearInterpolate(prevEcef.z(), nextEcef.z(), factor));
+
+  simCore::Vec3 lla;
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(xyz, lla);
+
+  // Use interpolated geodetic altitude to prevent short cuts through the earth
+  simCore::Coordinate resultsLla;
+  resultsLla.setCoordinateSystem(simCore::COORD_SYS_LLA);
+  resultsLla.setPositionLLA(lla.lat(), lla.lon(), simCore::linearInterpolate(prevLla.z(), nextLla.z(), factor));
+
+  if (prevEcef.hasOrientation() && nextEcef.hasOrientation())
+  {
+    const double l_yaw = simCore::angFix2PI(prevLla.yaw());
+    const double l_pitch = simCore::angFix2PI(prevLla.pitch());
+    const double l_roll = simCore::angFix2PI(prevLla.roll());
+    const double h_yaw = simCore::angFix2PI(nextLla.yaw());
+    const double h_pitch = simCore::angFix2PI(nextLla.pitch());
+    const double h_roll = simCore::angFix2PI(nextLla.roll());
+
+    // orientations assumed to be between 0 and 360
+    const double delta_yaw = (h_yaw - l_yaw);
+    const double delta_pitch = (h_pitch - l_pitch);
+    const double delta_roll = (h_roll - l_roll);
+
+    double yaw = 0.0;
+    double pitch = 0.0;
+    double roll = 0.0;
+
+    if (delta_yaw == 0.)
+      yaw = l_yaw;
+    else if (std::abs(delta_yaw) < M_PI)
+      yaw = (l_yaw + factor * delta_yaw);
+    else
+    {
+      if (delta_yaw > 0)
+        yaw = (l_yaw - factor * (M_TWOPI - delta_yaw));
+      else
+        yaw = (l_yaw + factor * (M_TWOPI + delta_yaw));
+    }
+
+    if (delta_pitch == 0.)
+      pitch = l_pitch;
+    else if (std::abs(delta_pitch) < M_PI)
+      pitch = (l_pitch + factor * delta_pitch);
+    else
+    {
+      if (delta_pitch > 0)
+        pitch = (l_pitch - factor * (M_TWOPI - delta_pitch));
+      else
+        pitch = (l_pitch + factor * (M_TWOPI + delta_pitch));
+    }
+
+    if (delta_roll == 0.)
+      roll = l_roll;
+    else if (std::abs(delta_roll) < M_PI)
+      roll = (l_roll + factor * delta_roll);
+    else
+    {
+      if (delta_roll > 0)
+        roll = (l_roll - factor * (M_TWOPI - delta_roll));
+      else
+        roll = (l_roll + factor * (M_TWOPI + delta_roll));
+    }
+
+    resultsLla.setOrientation(yaw, pitch, roll);
+  }
+
+  if (prevEcef.hasVelocity() && nextEcef.hasVelocity())
+  {
+    resultsLla.setVelocity(simCore::linearInterpolate(prevLla.vx(), nextLla.vx(), factor),
+      simCore::linearInterpolate(prevLla.vy(), nextLla.vy(), factor),
+      simCore::linearInterpolate(prevLla.vz(), nextLla.vz(), factor));
+  }
+
+  simCore::Coordinate resultsEcef;
+  simCore::CoordinateConverter::convertGeodeticToEcef(resultsLla, resultsEcef);
+
+  result.set_time(time);
+  result.set_x(resultsEcef.x());
+  result.set_y(resultsEcef.y());
+  result.set_z(resultsEcef.z());
+
+  if (resultsEcef.hasVelocity())
+  {
+    result.set_vx(resultsEcef.vx());
+    result.set_vy(resultsEcef.vy());
+    result.set_vz(resultsEcef.vz());
+  }
+
+  if (resultsEcef.hasOrientation())
+  {
+    result.set_psi(resultsEcef.psi());
+    result.set_theta(resultsEcef.theta());
+    result.set_phi(resultsEcef.phi());
+  }
+}
+
+}
@@ -0,0 +1,117 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_PLATFORMINTERPOLATIONBATCH_H
+#define SIMDATA_PLATFORMINTERPOLATIONBATCH_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "simCore/Common/Common.h"
+#include "simData/DataTypes.h"
+
+namespace simCore { class Coordinate; }
+
+namespace simData
+{
+
+/**
+ * Linearly interpolates many platform updates at once, with the same results as interpolating
+ * each one on its own with interpolate().  Positions are interpolated in ECEF with the geodetic
+ * altitude interpolated separately; orientations and velocities are interpolated in the local
+ * frame.  The bracketing points are laid out contiguously, one array per component, so that the
+ * interpolation itself runs as straight loops the compiler can vectorize; the trigonometry of the
+ * conversion back to ECEF is computed once per point and shared by position, orientation and velocity.
+ *
+ * Not thread safe; use one batch per thread.
+ */
+class SDKDATA_EXPORT PlatformInterpolationBatch
+{
+public:
+  PlatformInterpolationBatch();
+  virtual ~PlatformInterpolationBatch();
+
+  SDK_DISABLE_COPY_MOVE(PlatformInterpolationBatch);
+
+  /** Removes all points, keeping the memory for reuse */
+  void clear();
+  /** Reserves room for the given number of points */
+  void reserve(size_t count);
+  /** Returns the number of points added since the last clear() or interpolate() */
+  size_t size() const;
+
+  /**
+   * Adds a point to interpolate.  Orientation and velocity are interpolated only if both
+   * bracketing points have them.  The result is not written until interpolate().
+   * @param time Time of the interpolated point
+   * @param factor Fraction of the way from prev to next, [0,1]
+   * @param prevEcef Earlier bracketing point, in ECEF
+   * @param prevLla Earlier bracketing point, in LLA
+   * @param nextEcef Later bracketing point, in ECEF
+   * @param nextLla Later bracketing point, in LLA
+   * @param result Receives the interpolated point; must remain valid until interpolate()
+   */
+  void add(double time, double factor, const simCore::Coordinate& prevEcef, const simCore::Coordinate& prevLla,
+    const simCore::Coordinate& nextEcef, const simCore::Coordinate& nextLla, PlatformUpdate* result);
+
+  /** Interpolates all the points added, writes their results, then clears the batch */
+  void interpolate();
+
+  /** Interpolates a single point, one component at a time; the reference for the batch results */
+  static void interpolate(double time, double factor, const simCore::Coordinate& prevEcef, const simCore::Coordinate& prevLla,
+    const simCore::Coordinate& nextEcef, const simCore::Coordinate& nextLla, PlatformUpdate& result);
+
+private:
+  /// Per point arrays; each name is one component of every point
+  enum Component
+  {
+    PREV_X, PREV_Y, PREV_Z, NEXT_X, NEXT_Y, NEXT_Z,
+    PREV_ALT, NEXT_ALT,
+    PREV_YAW, PREV_PITCH, PREV_ROLL, NEXT_YAW, NEXT_PITCH, NEXT_ROLL,
+    PREV_VX, PREV_VY, PREV_VZ, NEXT_VX, NEXT_VY, NEXT_VZ,
+    FACTOR,
+    // Interpolated values, in ECEF for the position and local frame for the rest
+    X, Y, Z, ALT, YAW, PITCH, ROLL, VX, VY, VZ,
+    NUM_COMPONENTS
+  };
+
+  /// Flags of the components a point has
+  enum Flags : uint8_t
+  {
+    HAS_ORIENTATION = 1,
+    HAS_VELOCITY = 2
+  };
+
+  /** Interpolates the position, altitude, orientation and velocity of all points */
+  void interpolateComponents_();
+  /** Converts the interpolated point to ECEF and writes it to the result */
+  void writeResult_(size_t index);
+
+  std::array<std::vector<double>, NUM_COMPONENTS> values_;
+  std::vector<double> times_;
+  std::vector<uint8_t> flags_;
+  std::vector<PlatformUpdate*> results_;
+};
+
+}
+
+#endif /* SIMDATA_PLATFORMINTERPOLATIONBATCH_H */
@@ -0,0 +1,2183 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "simNotify/Notify.h"
+#include "simData/SpillFile.h"
+#include "simData/PlatformMemoryDataSlice.h"
+
+namespace simData
+{
+
+namespace
+{
+/// Capacity of the first chunk, which doubles in size until reaching CHUNK_ROWS; keeps short slices small
+const size_t INITIAL_CHUNK_ROWS = 4;
+/// Marks an invalid row index
+const size_t NO_ROW = std::numeric_limits<size_t>::max();
+
+/** Accessors for one PlatformUpdate field, used to encode spill blocks field by field */
+struct SpillField
+{
+  uint16_t bit;
+  bool (PlatformUpdate::*has)() const;
+  double (PlatformUpdate::*get)() const;
+  void (PlatformUpdate::*set)(double);
+};
+
+/// Fields in the order they are written to a spill block
+const SpillField SPILL_FIELDS[] = {
+  { PlatformUpdateColumns::TIME_BIT, &PlatformUpdate::has_time, &PlatformUpdate::time, &PlatformUpdate::set_time },
+  { PlatformUpdateColumns::X_BIT, &PlatformUpdate::has_x, &PlatformUpdate::x, &PlatformUpdate::set_x },
+  { PlatformUpdateColumns::Y_BIT, &PlatformUpdate::has_y, &PlatformUpdate::y, &PlatformUpdate::set_y },
+  { PlatformUpdateColumns::Z_BIT, &PlatformUpdate::has_z, &PlatformUpdate::z, &PlatformUpdate::set_z },
+  { PlatformUpdateColumns::PSI_BIT, &PlatformUpdate::has_psi, &PlatformUpdate::psi, &PlatformUpdate::set_psi },
+  { PlatformUpdateColumns::THETA_BIT, &PlatformUpdate::has_theta, &PlatformUpdate::theta, &PlatformUpdate::set_theta },
+  { PlatformUpdateColumns::PHI_BIT, &PlatformUpdate::has_phi, &PlatformUpdate::phi, &PlatformUpdate::set_phi },
+  { PlatformUpdateColumns::VX_BIT, &PlatformUpdate::has_vx, &PlatformUpdate::vx, &PlatformUpdate::set_vx },
+  { PlatformUpdateColumns::VY_BIT, &PlatformUpdate::has_vy, &PlatformUpdate::vy, &PlatformUpdate::set_vy },
+  { PlatformUpdateColumns::VZ_BIT, &PlatformUpdate::has_vz, &PlatformUpdate::vz, &PlatformUpdate::set_vz },
+};
+
+/// Control byte of a value equal to the previous value of its field
+const uint8_t XOR_SAME_VALUE = 0x80;
+
+/// Appends the little endian bytes of value
+template <typename T>
+void appendLittleEndian(std::vector<uint8_t>& bytes, T value)
+{
+  for (size_t ii = 0; ii < sizeof(T); ++ii)
+    bytes.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * ii)));
+}
+
+/// Reads a little endian value at pos, advancing pos; returns false at the end of the bytes
+template <typename T>
+bool readLittleEndian(const std::vector<uint8_t>& bytes, size_t& pos, T& value)
+{
+  if (pos + sizeof(T) > bytes.size())
+    return false;
+  uint64_t rv = 0;
+  for (size_t ii = 0; ii < sizeof(T); ++ii)
+    rv |= static_cast<uint64_t>(bytes[pos++]) << (8 * ii);
+  value = static_cast<T>(rv);
+  return true;
+}
+
+/**
+ * Appends value XORed with the previous value of its column.  Slowly changing values share their
+ * sign, exponent and high mantissa bits, so only the middle bytes that differ are written after
+ * a control byte holding the count of leading and trailing zero bytes.  Lossless.
+ */
+void appendXorValue(std::vector<uint8_t>& bytes, uint64_t& previous, double value)
+{
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint64_t delta = bits ^ previous;
+  previous = bits;
+  if (delta == 0)
+  {
+    bytes.push_back(XOR_SAME_VALUE);
+    return;
+  }
+
+  int leading = 0;
+  while (((delta >> (56 - 8 * leading)) & 0xff) == 0)
+    ++leading;
+  int trailing = 0;
+  while (((delta >> (8 * trailing)) & 0xff) == 0)
+    ++trailing;
+  bytes.push_back(static_cast<uint8_t>((leading << 4) | trailing));
+  for (int byte = 7 - leading; byte >= trailing; --byte)
+    bytes.push_back(static_cast<uint8_t>(delta >> (8 * byte)));
+}
+
+/** Reads a value written by appendXorValue() at pos, advancing pos; returns false on malformed bytes */
+bool readXorValue(const uint8_t* bytes, size_t size, size_t& pos, uint64_t& previous, double& value)
+{
+  if (pos >= size)
+    return false;
+
+  const uint8_t control = bytes[pos++];
+  uint64_t delta = 0;
+  if (control != XOR_SAME_VALUE)
+  {
+    const int leading = control >> 4;
+    const int trailing = control & 0x0f;
+    if ((leading + trailing > 7) || (pos + 8 - leading - trailing > size))
+      return false;
+    for (int byte = 7 - leading; byte >= trailing; --byte)
+      delta |= static_cast<uint64_t>(bytes[pos++]) << (8 * byte);
+  }
+
+  previous ^= delta;
+  std::memcpy(&value, &previous, sizeof(value));
+  return true;
+}
+
+/** Encodes the updates into a spill block; each field is stored as a column of its present values */
+void encodeSpillBlock(const std::vector<PlatformUpdate>& rows, std::vector<uint8_t>& bytes)
+{
+  appendLittleEndian(bytes, static_cast<uint32_t>(rows.size()));
+  for (const auto& row : rows)
+  {
+    uint16_t presence = 0;
+    for (const auto& field : SPILL_FIELDS)
+    {
+      if ((row.*field.has)())
+        presence |= field.bit;
+    }
+    appendLittleEndian(bytes, presence);
+  }
+
+  for (const auto& field : SPILL_FIELDS)
+  {
+    uint64_t previous = 0;
+    for (const auto& row : rows)
+    {
+      if (!(row.*field.has)())
+        continue;
+
+      appendXorValue(bytes, previous, (row.*field.get)());
+    }
+  }
+}
+
+/** Decodes a spill block, appending its updates to rows; returns 0 on success */
+int decodeSpillBlock(const std::vector<uint8_t>& bytes, std::vector<PlatformUpdate>& rows)
+{
+  size_t pos = 0;
+  uint32_t count = 0;
+  if (!readLittleEndian(bytes, pos, count))
+    return 1;
+
+  const size_t first = rows.size();
+  std::vector<uint16_t> presence(count);
+  for (auto& mask : presence)
+  {
+    if (!readLittleEndian(bytes, pos, mask))
+      return 1;
+  }
+
+  rows.resize(first + count);
+  for (const auto& field : SPILL_FIELDS)
+  {
+    uint64_t previous = 0;
+    for (uint32_t ii = 0; ii < count; ++ii)
+    {
+      if ((presence[ii] & field.bit) == 0)
+        continue;
+
+      double value;
+      if (!readXorValue(bytes.data(), bytes.size(), pos, previous, value))
+      {
+        rows.resize(first);
+        return 1;
+      }
+      (rows[first + ii].*field.set)(value);
+    }
+  }
+  return 0;
+}
+
+/// Ticks per second of compressed times; times that are not whole ticks are stored losslessly instead
+const double TIME_TICKS_PER_SECOND = 1e6;
+/// Largest magnitude of a quantized value, keeping quantized values exact in a double
+const double MAX_QUANTIZED = 9.0e15;
+
+/// Encoding of a column in a packed chunk
+enum PackedColumn : uint8_t
+{
+  /// Values XORed with the previous value, see appendXorValue()
+  PACKED_XOR = 0,
+  /// Whole time ticks, delta-of-delta encoded
+  PACKED_TICKS = 1,
+  /// Values quantized to the field's quantum, delta-of-delta encoded
+  PACKED_QUANTIZED = 2
+};
+
+/// Appends value as a variable length integer, 7 bits per byte
+void appendVarint(std::vector<uint8_t>& bytes, uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    bytes.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  bytes.push_back(static_cast<uint8_t>(value));
+}
+
+/// Reads a variable length integer at pos, advancing pos
+uint64_t readVarint(const uint8_t* bytes, size_t& pos)
+{
+  uint64_t rv = 0;
+  int shift = 0;
+  while (bytes[pos] & 0x80)
+  {
+    rv |= static_cast<uint64_t>(bytes[pos++] & 0x7f) << shift;
+    shift += 7;
+  }
+  return rv | (static_cast<uint64_t>(bytes[pos++]) << shift);
+}
+
+/// Maps signed values to unsigned so that small magnitudes give short varints
+uint64_t zigzag(int64_t value)
+{
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+/// Inverse of zigzag()
+int64_t unzigzag(uint64_t value)
+{
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/**
+ * Delta-of-delta encoder for a column of integers.  Track data changes at a nearly constant
+ * rate between samples, so the second difference is usually a single byte.
+ */
+class IntegerColumnWriter
+{
+public:
+  explicit IntegerColumnWriter(std::vector<uint8_t>& bytes)
+    : bytes_(bytes)
+  {
+  }
+
+  /// Appends the next value of the column
+  void append(int64_t value)
+  {
+    const int64_t delta = value - previous_;
+    appendVarint(bytes_, zigzag(delta - previousDelta_));
+    previous_ = value;
+    previousDelta_ = delta;
+  }
+
+private:
+  std::vector<uint8_t>& bytes_;
+  int64_t previous_ = 0;
+  int64_t previousDelta_ = 0;
+};
+
+/// Decoder for a column written by IntegerColumnWriter
+class IntegerColumnReader
+{
+public:
+  IntegerColumnReader(const uint8_t* bytes, size_t& pos)
+    : bytes_(bytes),
+      pos_(pos)
+  {
+  }
+
+  /// Reads the next value of the column
+  int64_t next()
+  {
+    const int64_t delta = previousDelta_ + unzigzag(readVarint(bytes_, pos_));
+    previous_ += delta;
+    previousDelta_ = delta;
+    return previous_;
+  }
+
+private:
+  const uint8_t* bytes_;
+  size_t& pos_;
+  int64_t previous_ = 0;
+  int64_t previousDelta_ = 0;
+};
+
+/// Returns the quantum for a column of a packed chunk, 0 for exact storage; column 0 is time
+double packedQuantum(size_t column, const PlatformUpdateColumns::Compression& compression)
+{
+  if (column == 0)
+    return 0.0;
+  if (column < 4)
+    return compression.positionQuantum;
+  if (column < 7)
+    return compression.angleQuantum;
+  return compression.velocityQuantum;
+}
+}
+
+/**
+ * Block of column data.  The double, float and presence columns share a single allocation,
+ * which holds the encoded columns instead while the chunk is packed.
+ */
+struct PlatformUpdateColumns::Chunk
+{
+  /// Number of columns, in FieldBit order
+  static constexpr size_t NUM_COLUMNS = 10;
+
+  explicit Chunk(size_t inCapacity)
+    : capacity(static_cast<uint32_t>(inCapacity))
+  {
+    allocate();
+  }
+
+  /// Allocates storage for the columns
+  void allocate()
+  {
+    storage.reset(new uint8_t[capacity * BYTES_PER_ROW]);
+    packedSize = 0;
+  }
+
+  /// Returns true if storage holds encoded columns
+  bool isPacked() const { return packedSize != 0; }
+
+  /// Columns 0-3 are time, x, y, z
+  double* doubleColumn(size_t column) const { return reinterpret_cast<double*>(storage.get()) + column * capacity; }
+  /// Columns 0-5 are psi, theta, phi, vx, vy, vz
+  float* floatColumn(size_t column) const { return reinterpret_cast<float*>(storage.get() + 4 * sizeof(double) * capacity) + column * capacity; }
+  /// Presence mask of each row
+  uint16_t* presenceColumn() const { return reinterpret_cast<uint16_t*>(storage.get() + (4 * sizeof(double) + 6 * sizeof(float)) * capacity); }
+
+  /// Copies the first 'rows' rows of all columns from other
+  void copyFrom(const Chunk& other, size_t rows)
+  {
+    for (size_t column = 0; column < 4; ++column)
+      std::copy(other.doubleColumn(column), other.doubleColumn(column) + rows, doubleColumn(column));
+    for (size_t column = 0; column < 6; ++column)
+      std::copy(other.floatColumn(column), other.floatColumn(column) + rows, floatColumn(column));
+    std::copy(other.presenceColumn(), other.presenceColumn() + rows, presenceColumn());
+  }
+
+  /// Value of a column, in FieldBit order
+  double value(size_t column, size_t slot) const
+  {
+    return (column < 4) ? doubleColumn(column)[slot] : floatColumn(column - 4)[slot];
+  }
+
+  /// Sets the value of a column, in FieldBit order
+  void setValue(size_t column, size_t slot, double value)
+  {
+    if (column < 4)
+      doubleColumn(column)[slot] = value;
+    else
+      floatColumn(column - 4)[slot] = static_cast<float>(value);
+  }
+
+  /// Replaces the columns with their encoding
+  void pack(const Compression& compression)
+  {
+    const uint16_t* presence = presenceColumn();
+    std::vector<uint8_t> packed;
+    uint16_t previousMask = 0;
+    for (size_t slot = 0; slot < capacity; ++slot)
+    {
+      appendVarint(packed, presence[slot] ^ previousMask);
+      previousMask = presence[slot];
+    }
+
+    for (size_t column = 0; column < NUM_COLUMNS; ++column)
+    {
+      const uint16_t bit = static_cast<uint16_t>(1 << column);
+      const double quantum = packedQuantum(column, compression);
+      // Quantize only if every value fits; times must also round trip exactly
+      bool quantize = (column == 0) || (quantum > 0.0);
+      for (size_t slot = 0; quantize && slot < capacity; ++slot)
+      {
+        if ((presence[slot] & bit) == 0)
+          continue;
+        const double fieldValue = value(column, slot);
+        const double scaled = (column == 0) ? fieldValue * TIME_TICKS_PER_SECOND : fieldValue / quantum;
+        if (!(std::fabs(scaled) < MAX_QUANTIZED))
+          quantize = false;
+        else if ((column == 0) && (static_cast<double>(std::llround(scaled)) / TIME_TICKS_PER_SECOND != fieldValue))
+          quantize = false;
+      }
+
+      if (!quantize)
+      {
+        packed.push_back(PACKED_XOR);
+        uint64_t previous = 0;
+        for (size_t slot = 0; slot < capacity; ++slot)
+        {
+          if (presence[slot] & bit)
+            appendXorValue(packed, previous, value(column, slot));
+        }
+        continue;
+      }
+
+      packed.push_back((column == 0) ? PACKED_TICKS : PACKED_QUANTIZED);
+      IntegerColumnWriter writer(packed);
+      for (size_t slot = 0; slot < capacity; ++slot)
+      {
+        if ((presence[slot] & bit) == 0)
+          continue;
+        const double fieldValue = value(column, slot);
+        writer.append(std::llround((column == 0) ? fieldValue * TIME_TICKS_PER_SECOND : fieldValue / quantum));
+      }
+    }
+
+    firstTime = doubleColumn(0)[0];
+    lastTime = doubleColumn(0)[capacity - 1];
+    storage.reset(new uint8_t[packed.size()]);
+    std::copy(packed.begin(), packed.end(), storage.get());
+    packedSize = static_cast<uint32_t>(packed.size());
+  }
+
+  /// Decodes the packed columns into out, which has the same capacity and is not packed
+  void decodeInto(const Compression& compression, Chunk& out) const
+  {
+    const uint8_t* bytes = storage.get();
+    uint16_t* presence = out.presenceColumn();
+    size_t pos = 0;
+    uint16_t mask = 0;
+    for (size_t slot = 0; slot < capacity; ++slot)
+    {
+      mask ^= static_cast<uint16_t>(readVarint(bytes, pos));
+      presence[slot] = mask;
+    }
+
+    for (size_t column = 0; column < NUM_COLUMNS; ++column)
+    {
+      const uint16_t bit = static_cast<uint16_t>(1 << column);
+      const uint8_t encoding = bytes[pos++];
+      if (encoding == PACKED_XOR)
+      {
+        uint64_t previous = 0;
+        for (size_t slot = 0; slot < capacity; ++slot)
+        {
+          double value = 0.0;
+          if (presence[slot] & bit)
+            readXorValue(bytes, packedSize, pos, previous, value);
+          out.setValue(column, slot, value);
+        }
+        continue;
+      }
+
+      const double quantum = packedQuantum(column, compression);
+      IntegerColumnReader reader(bytes, pos);
+      for (size_t slot = 0; slot < capacity; ++slot)
+      {
+        double value = 0.0;
+        if (presence[slot] & bit)
+        {
+          const double quantized = static_cast<double>(reader.next());
+          value = (encoding == PACKED_TICKS) ? quantized / TIME_TICKS_PER_SECOND : quantized * quantum;
+        }
+        out.setValue(column, slot, value);
+      }
+    }
+  }
+
+  /// Decodes the packed columns back into place
+  void unpack(const Compression& compression)
+  {
+    Chunk unpacked(capacity);
+    decodeInto(compression, unpacked);
+    storage = std::move(unpacked.storage);
+    packedSize = 0;
+  }
+
+  /// Bytes of storage
+  size_t storageSize() const { return isPacked() ? packedSize : capacity * BYTES_PER_ROW; }
+
+  uint32_t capacity;
+  /// Size of the encoded columns; 0 when not packed
+  uint32_t packedSize = 0;
+  /// Times of the first and last slots, kept while packed so searches need not decode
+  double firstTime = 0.0;
+  double lastTime = 0.0;
+  std::unique_ptr<uint8_t[]> storage;
+};
+
+/**
+ * Most recently decoded packed chunks, replaced round robin.  Readers on other threads may
+ * still hold a replaced chunk, so each replacement is a new allocation.
+ */
+struct PlatformUpdateColumns::DecodedChunks
+{
+  /// Guards the entries, which const readers fill
+  std::mutex mutex;
+  /// Packed chunk decoded into each entry, nullptr if unused
+  const Chunk* sources[DECODED_CHUNK_CACHE] = {};
+  /// Decoded columns
+  std::shared_ptr<const Chunk> chunks[DECODED_CHUNK_CACHE];
+  /// Next entry to replace
+  size_t next = 0;
+};
+
+PlatformUpdateColumns::PlatformUpdateColumns()
+{
+}
+
+PlatformUpdateColumns::~PlatformUpdateColumns()
+{
+}
+
+size_t PlatformUpdateColumns::size() const
+{
+  return size_;
+}
+
+bool PlatformUpdateColumns::empty() const
+{
+  return size_ == 0;
+}
+
+PlatformUpdateColumns::RowIterator PlatformUpdateColumns::begin() const
+{
+  return RowIterator(this, 0);
+}
+
+PlatformUpdateColumns::RowIterator PlatformUpdateColumns::end() const
+{
+  return RowIterator(this, size_);
+}
+
+const PlatformUpdateColumns::Chunk* PlatformUpdateColumns::readChunk_(size_t row, size_t& slot, std::shared_ptr<const Chunk>& hold) const
+{
+  assert(row < size_);
+  const size_t physical = offset_ + row;
+  slot = physical % CHUNK_ROWS;
+  const Chunk* chunk = chunks_[physical / CHUNK_ROWS].get();
+  if (!chunk->isPacked())
+    return chunk;
+
+  DecodedChunks& decoded = *decoded_;
+  std::lock_guard<std::mutex> lock(decoded.mutex);
+  for (size_t ii = 0; ii < DECODED_CHUNK_CACHE; ++ii)
+  {
+    if (decoded.sources[ii] == chunk)
+    {
+      hold = decoded.chunks[ii];
+      return hold.get();
+    }
+  }
+
+  auto out = std::make_shared<Chunk>(CHUNK_ROWS);
+  chunk->decodeInto(*compression_, *out);
+  const size_t entry = decoded.next;
+  decoded.next = (entry + 1) % DECODED_CHUNK_CACHE;
+  decoded.sources[entry] = chunk;
+  decoded.chunks[entry] = out;
+  hold = std::move(out);
+  return hold.get();
+}
+
+double PlatformUpdateColumns::chunkLastTime_(size_t chunkIndex) const
+{
+  const Chunk* chunk = chunks_[chunkIndex].get();
+  return chunk->isPacked() ? chunk->lastTime : chunk->doubleColumn(0)[chunk->capacity - 1];
+}
+
+size_t PlatformUpdateColumns::bound_(double time, size_t first, size_t last, bool upper) const
+{
+  last = std::min(last, size_);
+  if (first >= last)
+    return last;
+
+  // Every chunk before the one holding the last row is full, so its last time is known without
+  // decoding; find the first of them that reaches time, else the chunk of the last row
+  const size_t firstChunk = (offset_ + first) / CHUNK_ROWS;
+  size_t lowChunk = firstChunk;
+  size_t highChunk = (offset_ + last - 1) / CHUNK_ROWS;
+  while (lowChunk < highChunk)
+  {
+    const size_t mid = lowChunk + (highChunk - lowChunk) / 2;
+    const double midTime = chunkLastTime_(mid);
+    if (upper ? (midTime > time) : (midTime >= time))
+      highChunk = mid;
+    else
+      lowChunk = mid + 1;
+  }
+
+  // Then search the rows of that chunk, holding the decoded chunk for the whole search
+  const size_t chunkFirst = (lowChunk == firstChunk) ? first : lowChunk * CHUNK_ROWS - offset_;
+  const size_t chunkLast = std::min(last, (lowChunk + 1) * CHUNK_ROWS - offset_);
+  size_t slot;
+  std::shared_ptr<const Chunk> hold;
+  const Chunk* chunk = readChunk_(chunkFirst, slot, hold);
+  const double* times = chunk->doubleColumn(0) + slot;
+  const double* end = times + (chunkLast - chunkFirst);
+  const double* found = upper ? std::upper_bound(times, end, time) : std::lower_bound(times, end, time);
+  return chunkFirst + (found - times);
+}
+
+size_t PlatformUpdateColumns::lowerBound(double time, size_t first, size_t last) const
+{
+  return bound_(time, first, last, false);
+}
+
+size_t PlatformUpdateColumns::upperBound(double time, size_t first, size_t last) const
+{
+  return bound_(time, first, last, true);
+}
+
+PlatformUpdateColumns::Chunk* PlatformUpdateColumns::writeChunk_(size_t row, size_t& slot)
+{
+  assert(row < size_);
+  const size_t physical = offset_ + row;
+  slot = physical % CHUNK_ROWS;
+  const size_t index = physical / CHUNK_ROWS;
+  Chunk* chunk = chunks_[index].get();
+  if (chunk->isPacked())
+  {
+    clearDecoded_();
+    chunk->unpack(*compression_);
+    if (index + 1 < chunks_.size())
+      repack_ = true;
+  }
+  return chunk;
+}
+
+void PlatformUpdateColumns::packFullChunks_()
+{
+  for (size_t ii = 0; ii + 1 < chunks_.size(); ++ii)
+  {
+    if (!chunks_[ii]->isPacked())
+      chunks_[ii]->pack(*compression_);
+  }
+  repack_ = false;
+}
+
+void PlatformUpdateColumns::clearDecoded_()
+{
+  if (!decoded_)
+    return;
+  std::lock_guard<std::mutex> lock(decoded_->mutex);
+  std::fill(decoded_->sources, decoded_->sources + DECODED_CHUNK_CACHE, nullptr);
+  for (auto& chunk : decoded_->chunks)
+    chunk.reset();
+}
+
+double PlatformUpdateColumns::time(size_t row) const
+{
+  // The first and last times of a packed chunk are kept unpacked
+  const size_t physical = offset_ + row;
+  const Chunk* chunk = chunks_[physical / CHUNK_ROWS].get();
+  if (chunk->isPacked())
+  {
+    const size_t slot = physical % CHUNK_ROWS;
+    if (slot == 0)
+      return chunk->firstTime;
+    if (slot == chunk->capacity - 1)
+      return chunk->lastTime;
+  }
+
+  size_t slot;
+  std::shared_ptr<const Chunk> hold;
+  return readChunk_(row, slot, hold)->doubleColumn(0)[slot];
+}
+
+uint16_t PlatformUpdateColumns::presence(size_t row) const
+{
+  size_t slot;
+  std::shared_ptr<const Chunk> hold;
+  return readChunk_(row, slot, hold)->presenceColumn()[slot];
+}
+
+void PlatformUpdateColumns::get(size_t row, PlatformUpdate& update) const
+{
+  size_t slot;
+  std::shared_ptr<const Chunk> hold;
+  const Chunk* chunk = readChunk_(row, slot, hold);
+  const uint16_t mask = chunk->presenceColumn()[slot];
+
+  update = PlatformUpdate();
+  if (mask & TIME_BIT)
+    update.set_time(chunk->doubleColumn(0)[slot]);
+  if (mask & X_BIT)
+    update.set_x(chunk->doubleColumn(1)[slot]);
+  if (mask & Y_BIT)
+    update.set_y(chunk->doubleColumn(2)[slot]);
+  if (mask & Z_BIT)
+    update.set_z(chunk->doubleColumn(3)[slot]);
+  if (mask & PSI_BIT)
+    update.set_psi(chunk->floatColumn(0)[slot]);
+  if (mask & THETA_BIT)
+    update.set_theta(chunk->floatColumn(1)[slot]);
+  if (mask & PHI_BIT)
+    update.set_phi(chunk->floatColumn(2)[slot]);
+  if (mask & VX_BIT)
+    update.set_vx(chunk->floatColumn(3)[slot]);
+  if (mask & VY_BIT)
+    update.set_vy(chunk->floatColumn(4)[slot]);
+  if (mask & VZ_BIT)
+    update.set_vz(chunk->floatColumn(5)[slot]);
+}
+
+void PlatformUpdateColumns::set(size_t row, const PlatformUpdate& update)
+{
+  size_t slot;
+  Chunk* chunk = writeChunk_(row, slot);
+  uint16_t mask = 0;
+
+  // Absent fields are stored as zero so that the columns never hold uninitialized values
+  chunk->doubleColumn(0)[slot] = update.has_time() ? update.time() : 0.0;
+  chunk->doubleColumn(1)[slot] = update.has_x() ? update.x() : 0.0;
+  chunk->doubleColumn(2)[slot] = update.has_y() ? update.y() : 0.0;
+  chunk->doubleColumn(3)[slot] = update.has_z() ? update.z() : 0.0;
+  chunk->floatColumn(0)[slot] = update.has_psi() ? static_cast<float>(update.psi()) : 0.f;
+  chunk->floatColumn(1)[slot] = update.has_theta() ? static_cast<float>(update.theta()) : 0.f;
+  chunk->floatColumn(2)[slot] = update.has_phi() ? static_cast<float>(update.phi()) : 0.f;
+  chunk->floatColumn(3)[slot] = update.has_vx() ? static_cast<float>(update.vx()) : 0.f;
+  chunk->floatColumn(4)[slot] = update.has_vy() ? static_cast<float>(update.vy()) : 0.f;
+  chunk->floatColumn(5)[slot] = update.has_vz() ? static_cast<float>(update.vz()) : 0.f;
+
+  if (update.has_time())
+    mask |= TIME_BIT;
+  if (update.has_x())
+    mask |= X_BIT;
+  if (update.has_y())
+    mask |= Y_BIT;
+  if (update.has_z())
+    mask |= Z_BIT;
+  if (update.has_psi())
+    mask |= PSI_BIT;
+  if (update.has_theta())
+    mask |= THETA_BIT;
+  if (update.has_phi())
+    mask |= PHI_BIT;
+  if (update.has_vx())
+    mask |= VX_BIT;
+  if (update.has_vy())
+    mask |= VY_BIT;
+  if (update.has_vz())
+    mask |= VZ_BIT;
+  chunk->presenceColumn()[slot] = mask;
+  // Pack again any full chunks unpacked by this write or the shift of an insert
+  if (repack_)
+    packFullChunks_();
+}
+
+void PlatformUpdateColumns::reserveBack_()
+{
+  const size_t physical = offset_ + size_;
+  const size_t chunkIndex = physical / CHUNK_ROWS;
+  if (chunkIndex == chunks_.size())
+  {
+    chunks_.push_back(std::make_unique<Chunk>(chunks_.empty() ? INITIAL_CHUNK_ROWS : CHUNK_ROWS));
+    // The previous chunk is now full
+    if (compression_ && (chunks_.size() > 1))
+    {
+      if (repack_)
+        packFullChunks_();
+      else if (!chunks_[chunks_.size() - 2]->isPacked())
+        chunks_[chunks_.size() - 2]->pack(*compression_);
+    }
+    return;
+  }
+
+  // Only the first chunk can be short; grow it by doubling
+  Chunk* last = chunks_.back().get();
+  const size_t slot = physical % CHUNK_ROWS;
+  if (slot < last->capacity)
+    return;
+
+  auto bigger = std::make_unique<Chunk>(std::min<size_t>(last->capacity * 2, CHUNK_ROWS));
+  bigger->copyFrom(*last, slot);
+  chunks_.back() = std::move(bigger);
+}
+
+void PlatformUpdateColumns::copyRow_(size_t dst, size_t src)
+{
+  size_t dstSlot;
+  size_t srcSlot;
+  // Unpacking the destination clears the decoded chunks, so it comes first
+  Chunk* dstChunk = writeChunk_(dst, dstSlot);
+  std::shared_ptr<const Chunk> hold;
+  const Chunk* srcChunk = readChunk_(src, srcSlot, hold);
+  for (size_t column = 0; column < 4; ++column)
+    dstChunk->doubleColumn(column)[dstSlot] = srcChunk->doubleColumn(column)[srcSlot];
+  for (size_t column = 0; column < 6; ++column)
+    dstChunk->floatColumn(column)[dstSlot] = srcChunk->floatColumn(column)[srcSlot];
+  dstChunk->presenceColumn()[dstSlot] = srcChunk->presenceColumn()[srcSlot];
+}
+
+void PlatformUpdateColumns::push_back(const PlatformUpdate& update)
+{
+  reserveBack_();
+  ++size_;
+  set(size_ - 1, update);
+}
+
+void PlatformUpdateColumns::insert(size_t row, const PlatformUpdate& update)
+{
+  if (row >= size_)
+  {
+    push_back(update);
+    return;
+  }
+
+  // Out of order data is rare, so shift the trailing rows down one at a time
+  reserveBack_();
+  ++size_;
+  for (size_t ii = size_ - 1; ii > row; --ii)
+    copyRow_(ii, ii - 1);
+  set(row, update);
+}
+
+void PlatformUpdateColumns::erase(size_t first, size_t last)
+{
+  last = std::min(last, size_);
+  if (first >= last)
+    return;
+
+  if (first == 0 && last == size_)
+  {
+    clear();
+    return;
+  }
+
+  const size_t count = last - first;
+  if (first == 0)
+  {
+    // Removing from the front only moves the offset
+    offset_ += count;
+    size_ -= count;
+    while (offset_ >= CHUNK_ROWS)
+    {
+      clearDecoded_();
+      chunks_.pop_front();
+      offset_ -= CHUNK_ROWS;
+    }
+    return;
+  }
+
+  for (size_t ii = last; ii < size_; ++ii)
+    copyRow_(ii - count, ii);
+  size_ -= count;
+
+  // Release chunks that no longer hold any rows
+  const size_t neededChunks = (offset_ + size_ + CHUNK_ROWS - 1) / CHUNK_ROWS;
+  clearDecoded_();
+  while (chunks_.size() > neededChunks)
+    chunks_.pop_back();
+  if (repack_)
+    packFullChunks_();
+}
+
+void PlatformUpdateColumns::clear()
+{
+  clearDecoded_();
+  chunks_.clear();
+  offset_ = 0;
+  size_ = 0;
+}
+
+size_t PlatformUpdateColumns::memoryUsage() const
+{
+  size_t rv = sizeof(PlatformUpdateColumns);
+  for (const auto& chunk : chunks_)
+    rv += sizeof(Chunk) + sizeof(std::unique_ptr<Chunk>) + chunk->storageSize();
+  if (compression_)
+    rv += sizeof(Compression) + sizeof(DecodedChunks);
+  if (decoded_)
+  {
+    std::lock_guard<std::mutex> lock(decoded_->mutex);
+    for (const auto& chunk : decoded_->chunks)
+    {
+      if (chunk)
+        rv += sizeof(Chunk) + CHUNK_ROWS * BYTES_PER_ROW;
+    }
+  }
+  return rv;
+}
+
+void PlatformUpdateColumns::setCompression(const Compression* compression)
+{
+  // Unpack with the old settings before changing them
+  clearDecoded_();
+  if (compression_)
+  {
+    for (const auto& chunk : chunks_)
+    {
+      if (chunk->isPacked())
+        chunk->unpack(*compression_);
+    }
+  }
+  repack_ = false;
+
+  if (!compression)
+  {
+    compression_.reset();
+    decoded_.reset();
+    return;
+  }
+
+  compression_ = std::make_unique<Compression>(*compression);
+  if (!decoded_)
+    decoded_ = std::make_unique<DecodedChunks>();
+  packFullChunks_();
+}
+
+const PlatformUpdateColumns::Compression* PlatformUpdateColumns::compression() const
+{
+  return compression_.get();
+}
+
+//----------------------------------------------------------------------------
+namespace MemorySliceHelper
+{
+
+int limitByTime(PlatformUpdateColumns& updates, double timeLimit)
+{
+  if (updates.empty() || timeLimit < 0.0)
+    return -1; // nothing to do
+
+  // get an iterator to the first point after the limit
+  auto newFirstPt = PlatformUpdateColumns::RowIterator(&updates, updates.upperBound(timeLimit, 0, updates.size()));
+
+  // always leave one point
+  if (newFirstPt == updates.end())
+    --newFirstPt;
+
+  if (newFirstPt == updates.begin())
+    return -1; // nothing to do
+
+  updates.erase(0, newFirstPt.index());
+  return 0;
+}
+
+int limitByPoints(PlatformUpdateColumns& updates, uint32_t limitPoints)
+{
+  // zero is special case for "no limit"
+  if (limitPoints == 0)
+    return -1;
+
+  const size_t curPoints = updates.size();
+  if (curPoints == 0 || curPoints <= limitPoints)
+    return -1; // nothing to do
+
+  updates.erase(0, curPoints - limitPoints);
+  return 0;
+}
+
+int flush(PlatformUpdateColumns& updates, bool keepStatic)
+{
+  // don't flush static entities
+  if (keepStatic && updates.size() == 1 && updates.time(0) == -1.0)
+    return 1;
+
+  updates.clear();
+  return 0;
+}
+
+int flush(PlatformUpdateColumns& updates, double startTime, double endTime)
+{
+  auto start = PlatformUpdateColumns::RowIterator(&updates, updates.lowerBound(startTime, 0, updates.size()));
+  if ((start == updates.end()) || ((*start).time() >= endTime))
+    return 1;
+
+  // endTime is non-inclusive
+  auto end = PlatformUpdateColumns::RowIterator(&updates, updates.lowerBound(endTime, start.index(), updates.size()));
+  updates.erase(start.index(), end.index());
+  return 0;
+}
+
+} // namespace MemorySliceHelper
+
+//----------------------------------------------------------------------------
+/** Iterator over the updates by index, spilled updates first; rows are read through the slice's row_() */
+class PlatformMemoryDataSlice::IndexIterator : public DataSlice<PlatformUpdate>::IteratorImpl
+{
+public:
+  explicit IndexIterator(const PlatformMemoryDataSlice* slice, size_t nextIndex = 0)
+    : slice_(slice),
+      nextIndex_(nextIndex)
+  {
+  }
+
+  const PlatformUpdate* const next() override
+  {
+    if (!hasNext())
+      return nullptr;
+    return row_(nextIndex_++);
+  }
+
+  const PlatformUpdate* const peekNext() const override
+  {
+    if (!hasNext())
+      return nullptr;
+    return row_(nextIndex_);
+  }
+
+  const PlatformUpdate* const previous() override
+  {
+    if (!hasPrevious())
+      return nullptr;
+    return row_(--nextIndex_);
+  }
+
+  const PlatformUpdate* const peekPrevious() const override
+  {
+    if (!hasPrevious())
+      return nullptr;
+    return row_(nextIndex_ - 1);
+  }
+
+  void toFront() override
+  {
+    nextIndex_ = 0;
+  }
+
+  void toBack() override
+  {
+    nextIndex_ = slice_->numItems();
+  }
+
+  bool hasNext() const override
+  {
+    return nextIndex_ < slice_->numItems();
+  }
+
+  bool hasPrevious() const override
+  {
+    return nextIndex_ > 0 && nextIndex_ <= slice_->numItems();
+  }
+
+  DataSlice<PlatformUpdate>::IteratorImpl* clone() const override
+  {
+    return new IndexIterator(slice_, nextIndex_);
+  }
+
+private:
+  /// Number of row copies each iterator keeps alive
+  static constexpr size_t HELD_ROWS = 4;
+
+  /// Reads the row, keeping a copy from columnar storage alive for the last HELD_ROWS rows read
+  const PlatformUpdate* row_(size_t index) const
+  {
+    const PlatformUpdate* row = slice_->row_(index, held_[nextHeld_]);
+    nextHeld_ = (nextHeld_ + 1) % HELD_ROWS;
+    return row;
+  }
+
+  const PlatformMemoryDataSlice* slice_;
+  size_t nextIndex_;
+  /// Copies of the rows most recently returned
+  mutable std::shared_ptr<const PlatformUpdate> held_[HELD_ROWS];
+  mutable size_t nextHeld_ = 0;
+};
+
+/** Copies of rows handed out by a slice using columnar storage */
+struct PlatformMemoryDataSlice::RowCopies
+{
+  /// Copy of the current row
+  PlatformUpdate current;
+  /// Copies of the interpolation bounds
+  PlatformUpdate bounds[2];
+  /// Guards rows and nextSlot, which const queries fill from any thread
+  std::mutex rowsMutex;
+  /// Copies of recently read rows by row index, replaced in turn; empty slots have no copy
+  std::pair<size_t, std::shared_ptr<const PlatformUpdate> > rows[ROW_COPIES];
+  /// Slot to replace next
+  size_t nextSlot = 0;
+};
+
+/** Spilled history of a slice; blocks are in time order, each holds SPILL_BLOCK_ROWS updates, and all precede the in-memory updates */
+struct PlatformMemoryDataSlice::Spill
+{
+  /// A block of updates in the spill file
+  struct Block
+  {
+    SpillFile::Block location;
+    double firstTime = 0.0;
+    double lastTime = 0.0;
+    size_t rows = 0;
+  };
+
+  std::shared_ptr<SpillFile> file;
+  double window = 0.0;
+  /// Time of the last update() call; nothing at or after it is spilled
+  double lastUpdateTime = std::numeric_limits<double>::max();
+  std::vector<Block> blocks;
+  /// Total number of updates in blocks
+  size_t rows = 0;
+  /// Guards decoded, which const queries fill from any thread
+  std::mutex decodedMutex;
+  /// Copies of spilled blocks read by queries, by block index; released by update() and when the blocks change
+  std::unordered_map<size_t, std::vector<PlatformUpdate> > decoded;
+};
+
+//----------------------------------------------------------------------------
+PlatformMemoryDataSlice::PlatformMemoryDataSlice()
+  : MemoryDataSlice<PlatformUpdate>(),
+    currentIndex_(NO_ROW),
+    fastRow_(0)
+{
+}
+
+PlatformMemoryDataSlice::~PlatformMemoryDataSlice()
+{
+  if (spill_)
+    dropSpilled_(spill_->blocks.size());
+}
+
+void PlatformMemoryDataSlice::setColumnarStorage(bool columnar)
+{
+  if (columnar == columnarStorage())
+    return;
+
+  if (columnar)
+  {
+    columns_ = std::make_unique<PlatformUpdateColumns>();
+    copies_ = std::make_unique<RowCopies>();
+    for (PlatformUpdate* update : updates_)
+    {
+      columns_->push_back(*update);
+      delete update;
+    }
+    updates_.clear();
+    fastUpdate_.invalidate();
+    columns_->setCompression(compression_.get());
+  }
+  else
+  {
+    for (size_t row = 0; row < columns_->size(); ++row)
+    {
+      PlatformUpdate* update = new PlatformUpdate;
+      columns_->get(row, *update);
+      updates_.push_back(update);
+    }
+    columns_.reset();
+    copies_.reset();
+    fastUpdate_.invalidate();
+  }
+
+  // Pointers into the old storage are no longer valid
+  if (copies_)
+    clearRowCache_();
+  current_ = nullptr;
+  currentIndex_ = NO_ROW;
+  fastRow_ = 0;
+  interpolated_ = false;
+  bounds_ = DataSlice<PlatformUpdate>::Bounds(nullptr, nullptr);
+  dirty_ = true;
+  if (notifierFn_)
+    notifierFn_();
+}
+
+bool PlatformMemoryDataSlice::columnarStorage() const
+{
+  return columns_ != nullptr;
+}
+
+void PlatformMemoryDataSlice::setCompression(const PlatformUpdateColumns::Compression* compression)
+{
+  if (compression)
+    compression_ = std::make_unique<PlatformUpdateColumns::Compression>(*compression);
+  else
+    compression_.reset();
+  if (!columns_)
+    return;
+
+  // Quantization changes the stored values, so copies of rows are out of date
+  columns_->setCompression(compression);
+  clearRowCache_();
+  current_ = nullptr;
+  currentIndex_ = NO_ROW;
+  interpolated_ = false;
+  bounds_ = DataSlice<PlatformUpdate>::Bounds(nullptr, nullptr);
+  dirty_ = true;
+  if (notifierFn_)
+    notifierFn_();
+}
+
+const PlatformUpdateColumns::Compression* PlatformMemoryDataSlice::compression() const
+{
+  return compression_.get();
+}
+
+size_t PlatformMemoryDataSlice::memoryUsage() const
+{
+  if (columns_)
+  {
+    size_t rowCopies = 0;
+    std::lock_guard<std::mutex> lock(copies_->rowsMutex);
+    for (const auto& slot : copies_->rows)
+    {
+      if (slot.second)
+        ++rowCopies;
+    }
+    return columns_->memoryUsage() + sizeof(RowCopies) + rowCopies * sizeof(PlatformUpdate);
+  }
+  return MemoryDataSlice<PlatformUpdate>::memoryUsage();
+}
+
+void PlatformMemoryDataSlice::setSpill(std::shared_ptr<SpillFile> file, double window)
+{
+  // History that cannot be read back stays in the old file, so spilling stays on
+  if (spill_ && (spill_->file != file))
+  {
+    if (restoreAll_() != 0)
+      return;
+    spill_.reset();
+  }
+  if (!file || window <= 0.0)
+  {
+    if (restoreAll_() == 0)
+      spill_.reset();
+    return;
+  }
+
+  if (!spill_)
+  {
+    spill_ = std::make_unique<Spill>();
+    spill_->file = file;
+  }
+  spill_->window = window;
+  spillOld_();
+}
+
+double PlatformMemoryDataSlice::spillWindow() const
+{
+  return spill_ ? spill_->window : 0.0;
+}
+
+size_t PlatformMemoryDataSlice::spilledItems() const
+{
+  return spill_ ? spill_->rows : 0;
+}
+
+size_t PlatformMemoryDataSlice::residentItems_() const
+{
+  return columns_ ? columns_->size() : updates_.size();
+}
+
+double PlatformMemoryDataSlice::residentTime_(size_t row) const
+{
+  return columns_ ? columns_->time(row) : updates_[row]->time();
+}
+
+void PlatformMemoryDataSlice::spillUpdateTime_(double time)
+{
+  if (!spill_)
+    return;
+  spill_->lastUpdateTime = time;
+  clearSpilledCopies_();
+  // History left behind by moving forward, including any read back for an earlier time, is spilled again
+  spillOld_();
+  restoreThrough_(time);
+}
+
+void PlatformMemoryDataSlice::spillOld_()
+{
+  if (!spill_)
+    return;
+
+  const double boundary = std::min(lastTime(), spill_->lastUpdateTime) - spill_->window;
+  std::vector<PlatformUpdate> rows(SPILL_BLOCK_ROWS);
+  std::vector<uint8_t> bytes;
+  // The update after the block must be at or before the last update() time, so that the
+  // current update and the interpolation bounds stay in memory
+  while ((residentItems_() > SPILL_BLOCK_ROWS) && (residentTime_(SPILL_BLOCK_ROWS - 1) < boundary) &&
+    (residentTime_(SPILL_BLOCK_ROWS) <= spill_->lastUpdateTime))
+  {
+    for (size_t row = 0; row < SPILL_BLOCK_ROWS; ++row)
+    {
+      if (columns_)
+        columns_->get(row, rows[row]);
+      else
+        rows[row] = *updates_[row];
+    }
+
+    bytes.clear();
+    encodeSpillBlock(rows, bytes);
+    Spill::Block block;
+    // Keep the updates in memory if the file cannot be written
+    if (spill_->file->write(bytes, block.location) != 0)
+      return;
+    block.firstTime = rows.front().time();
+    block.lastTime = rows.back().time();
+    block.rows = SPILL_BLOCK_ROWS;
+    spill_->blocks.push_back(block);
+    spill_->rows += SPILL_BLOCK_ROWS;
+
+    if (columns_)
+    {
+      columns_->erase(0, SPILL_BLOCK_ROWS);
+      frontRowsRemoved_(SPILL_BLOCK_ROWS);
+    }
+    else
+    {
+      // update() spills before finding its new current update, so the old one may be spilled
+      bool spilledCurrent = false;
+      for (size_t row = 0; row < SPILL_BLOCK_ROWS; ++row)
+      {
+        if ((updates_[row] == current_) || (updates_[row] == bounds_.first) || (updates_[row] == bounds_.second))
+          spilledCurrent = true;
+        delete updates_[row];
+      }
+      updates_.erase(updates_.begin(), updates_.begin() + SPILL_BLOCK_ROWS);
+      fastUpdate_.invalidate();
+      if (spilledCurrent)
+      {
+        current_ = nullptr;
+        interpolated_ = false;
+        bounds_ = DataSlice<PlatformUpdate>::Bounds(nullptr, nullptr);
+        dirty_ = true;
+      }
+    }
+  }
+}
+
+int PlatformMemoryDataSlice::restoreThrough_(double time)
+{
+  if (!spill_ || spill_->blocks.empty())
+    return 0;
+  // In-memory updates cover any time after the first of them
+  if ((residentItems_() != 0) && (time > residentTime_(0)))
+    return 0;
+
+  const auto& blocks = spill_->blocks;
+  auto iter = std::lower_bound(blocks.begin(), blocks.end(), time,
+    [](const Spill::Block& block, double value) { return block.lastTime < value; });
+  // The block before holds the update preceding time
+  if (iter != blocks.begin())
+    --iter;
+  return restoreFrom_(iter - blocks.begin());
+}
+
+int PlatformMemoryDataSlice::restoreAll_()
+{
+  if (spill_ && !spill_->blocks.empty())
+    return restoreFrom_(0);
+  return 0;
+}
+
+int PlatformMemoryDataSlice::restoreFrom_(size_t firstBlock)
+{
+  clearSpilledCopies_();
+
+  // Blocks must stay in front of the in-memory updates, so they are read back from the last one;
+  // a block that cannot be read stays spilled, along with every block before it
+  std::vector<std::vector<PlatformUpdate> > blockRows;
+  std::vector<uint8_t> bytes;
+  size_t keep = spill_->blocks.size();
+  int rv = 0;
+  while (keep > firstBlock)
+  {
+    std::vector<PlatformUpdate> rows;
+    if ((spill_->file->read(spill_->blocks[keep - 1].location, bytes) != 0) || (decodeSpillBlock(bytes, rows) != 0))
+    {
+      SIM_ERROR << "Unable to read platform history from spill file " << spill_->file->filename() << "\n";
+      rv = 1;
+      break;
+    }
+    blockRows.push_back(std::move(rows));
+    --keep;
+  }
+  if (blockRows.empty())
+    return rv;
+
+  std::vector<PlatformUpdate> rows;
+  rows.reserve(blockRows.size() * SPILL_BLOCK_ROWS);
+  for (auto iter = blockRows.rbegin(); iter != blockRows.rend(); ++iter)
+    rows.insert(rows.end(), iter->begin(), iter->end());
+  for (size_t ii = keep; ii < spill_->blocks.size(); ++ii)
+  {
+    spill_->file->release(spill_->blocks[ii].location);
+    spill_->rows -= spill_->blocks[ii].rows;
+  }
+  spill_->blocks.resize(keep);
+
+  if (columns_)
+  {
+    std::vector<const PlatformUpdate*> pointers;
+    pointers.reserve(rows.size());
+    for (const auto& row : rows)
+      pointers.push_back(&row);
+    insertRows_(pointers);
+    return rv;
+  }
+
+  std::vector<PlatformUpdate*> copies;
+  copies.reserve(rows.size());
+  for (const auto& row : rows)
+    copies.push_back(new PlatformUpdate(row));
+  updates_.insert(updates_.begin(), copies.begin(), copies.end());
+  fastUpdate_.invalidate();
+  dirty_ = true;
+  return rv;
+}
+
+void PlatformMemoryDataSlice::clearSpilledCopies_()
+{
+  std::lock_guard<std::mutex> lock(spill_->decodedMutex);
+  spill_->decoded.clear();
+}
+
+const std::vector<PlatformUpdate>* PlatformMemoryDataSlice::spilledBlock_(size_t block) const
+{
+  std::lock_guard<std::mutex> lock(spill_->decodedMutex);
+  auto iter = spill_->decoded.find(block);
+  if (iter != spill_->decoded.end())
+    return &iter->second;
+
+  std::vector<uint8_t> bytes;
+  std::vector<PlatformUpdate> rows;
+  if ((spill_->file->read(spill_->blocks[block].location, bytes) != 0) || (decodeSpillBlock(bytes, rows) != 0))
+  {
+    SIM_ERROR << "Unable to read platform history from spill file " << spill_->file->filename() << "\n";
+    return nullptr;
+  }
+  return &spill_->decoded.emplace(block, std::move(rows)).first->second;
+}
+
+const PlatformUpdate* PlatformMemoryDataSlice::row_(size_t index, std::shared_ptr<const PlatformUpdate>& hold) const
+{
+  const size_t spilled = spilledItems();
+  if (index < spilled)
+  {
+    const std::vector<PlatformUpdate>* rows = spilledBlock_(index / SPILL_BLOCK_ROWS);
+    return rows ? &(*rows)[index % SPILL_BLOCK_ROWS] : nullptr;
+  }
+  if (!columns_)
+    return updates_[index - spilled];
+  hold = cachedRow_(index - spilled);
+  return hold.get();
+}
+
+size_t PlatformMemoryDataSlice::residentBound_(double time, bool upper) const
+{
+  if (columns_)
+    return upper ? columns_->upperBound(time, 0, columns_->size()) : columns_->lowerBound(time, 0, columns_->size());
+  if (upper)
+    return std::upper_bound(updates_.begin(), updates_.end(), time, UpdateComp<PlatformUpdate>()) - updates_.begin();
+  return std::lower_bound(updates_.begin(), updates_.end(), time, UpdateComp<PlatformUpdate>()) - updates_.begin();
+}
+
+size_t PlatformMemoryDataSlice::spillBound_(double time, bool upper) const
+{
+  // First block holding an update at or after time, or after time for upper
+  const auto& blocks = spill_->blocks;
+  const auto iter = upper ?
+    std::upper_bound(blocks.begin(), blocks.end(), time, [](double value, const Spill::Block& block) { return value < block.lastTime; }) :
+    std::lower_bound(blocks.begin(), blocks.end(), time, [](const Spill::Block& block, double value) { return block.lastTime < value; });
+  if (iter == blocks.end())
+    return spill_->rows + residentBound_(time, upper);
+
+  const size_t block = iter - blocks.begin();
+  const std::vector<PlatformUpdate>* rows = spilledBlock_(block);
+  if (!rows)
+    return block * SPILL_BLOCK_ROWS;
+  const auto rowIter = upper ?
+    std::upper_bound(rows->begin(), rows->end(), time, [](double value, const PlatformUpdate& row) { return value < row.time(); }) :
+    std::lower_bound(rows->begin(), rows->end(), time, [](const PlatformUpdate& row, double value) { return row.time() < value; });
+  return block * SPILL_BLOCK_ROWS + (rowIter - rows->begin());
+}
+
+void PlatformMemoryDataSlice::dropSpilled_(size_t count)
+{
+  clearSpilledCopies_();
+  for (size_t ii = 0; ii < count; ++ii)
+  {
+    spill_->file->release(spill_->blocks[ii].location);
+    spill_->rows -= spill_->blocks[ii].rows;
+  }
+  spill_->blocks.erase(spill_->blocks.begin(), spill_->blocks.begin() + count);
+}
+
+bool PlatformMemoryDataSlice::limitSpilledByTime_(double timeLimit)
+{
+  if (!spill_ || spill_->blocks.empty() || timeLimit < 0.0)
+    return false;
+
+  // Whole blocks at or before the limit are dropped; a block straddling the limit is read back
+  size_t count = 0;
+  while ((count < spill_->blocks.size()) && (spill_->blocks[count].lastTime <= timeLimit))
+    ++count;
+  dropSpilled_(count);
+  if (!spill_->blocks.empty() && (spill_->blocks.front().firstTime <= timeLimit))
+    restoreAll_();
+  return count != 0;
+}
+
+bool PlatformMemoryDataSlice::limitSpilledByPoints_(uint32_t limitPoints)
+{
+  if (!spill_ || spill_->blocks.empty() || limitPoints == 0)
+    return false;
+
+  size_t total = residentItems_() + spill_->rows;
+  size_t count = 0;
+  while ((count < spill_->blocks.size()) && (total - spill_->blocks[count].rows >= limitPoints))
+    total -= spill_->blocks[count++].rows;
+  dropSpilled_(count);
+  if (!spill_->blocks.empty() && (total > limitPoints))
+    restoreAll_();
+  return count != 0;
+}
+
+std::shared_ptr<const PlatformUpdate> PlatformMemoryDataSlice::cachedRow_(size_t row) const
+{
+  {
+    std::lock_guard<std::mutex> lock(copies_->rowsMutex);
+    for (const auto& slot : copies_->rows)
+    {
+      if (slot.second && slot.first == row)
+        return slot.second;
+    }
+  }
+
+  // Reading the columns is safe from several threads, so only the slots are locked
+  auto copy = std::make_shared<PlatformUpdate>();
+  columns_->get(row, *copy);
+  std::lock_guard<std::mutex> lock(copies_->rowsMutex);
+  copies_->rows[copies_->nextSlot] = { row, copy };
+  copies_->nextSlot = (copies_->nextSlot + 1) % ROW_COPIES;
+  return copy;
+}
+
+void PlatformMemoryDataSlice::clearRowCache_()
+{
+  std::lock_guard<std::mutex> lock(copies_->rowsMutex);
+  for (auto& slot : copies_->rows)
+    slot.second.reset();
+}
+
+void PlatformMemoryDataSlice::setCurrentRow_(size_t row)
+{
+  if (row >= columns_->size())
+  {
+    currentIndex_ = NO_ROW;
+    setCurrent(nullptr);
+    return;
+  }
+
+  // Same row and still the current value; nothing changed
+  if (row == currentIndex_ && current_ == &copies_->current)
+    return;
+
+  columns_->get(row, copies_->current);
+  currentIndex_ = row;
+  current_ = &copies_->current;
+  setChanged();
+}
+
+void PlatformMemoryDataSlice::frontRowsRemoved_(size_t count)
+{
+  clearRowCache_();
+  if (currentIndex_ != NO_ROW)
+  {
+    if (currentIndex_ >= count)
+      currentIndex_ -= count;
+    else
+      currentIndex_ = NO_ROW;
+  }
+  fastRow_ = columns_->size();
+}
+
+void PlatformMemoryDataSlice::flush(bool keepStatic)
+{
+  if (spill_)
+    dropSpilled_(spill_->blocks.size());
+  if (!columns_)
+  {
+    MemoryDataSlice<PlatformUpdate>::flush(keepStatic);
+    return;
+  }
+
+  clearRowCache_();
+  if (MemorySliceHelper::flush(*columns_, keepStatic) == 0)
+  {
+    current_ = nullptr;
+    currentIndex_ = NO_ROW;
+  }
+  fastRow_ = columns_->size();
+  dirty_ = true;
+
+  if (notifierFn_)
+    notifierFn_();
+}
+
+void PlatformMemoryDataSlice::flush(double startTime, double endTime)
+{
+  restoreThrough_(startTime);
+  if (!columns_)
+  {
+    MemoryDataSlice<PlatformUpdate>::flush(startTime, endTime);
+    return;
+  }
+
+  clearRowCache_();
+  if (MemorySliceHelper::flush(*columns_, startTime, endTime) == 0)
+  {
+    current_ = nullptr;
+    currentIndex_ = NO_ROW;
+  }
+  fastRow_ = columns_->size();
+  dirty_ = true;
+
+  if (notifierFn_)
+    notifierFn_();
+}
+
+DataSlice<PlatformUpdate>::Iterator PlatformMemoryDataSlice::lower_bound(double timeValue) const
+{
+  // Spilled history is read into copies, leaving the slice as it is
+  if (spill_ && !spill_->blocks.empty())
+    return DataSlice<PlatformUpdate>::Iterator(new IndexIterator(this, spillBound_(timeValue, false)));
+  if (!columns_)
+    return MemoryDataSlice<PlatformUpdate>::lower_bound(timeValue);
+
+  const auto iter = computeLowerBound<PlatformUpdateColumns::RowIterator, PlatformUpdateColumns::Row>(columns_->begin(),
+    PlatformUpdateColumns::RowIterator(columns_.get(), std::min(fastRow_, columns_->size())), columns_->end(), timeValue);
+  fastRow_ = iter.index();
+  return DataSlice<PlatformUpdate>::Iterator(new IndexIterator(this, iter.index()));
+}
+
+DataSlice<PlatformUpdate>::Iterator PlatformMemoryDataSlice::upper_bound(double timeValue) const
+{
+  if (spill_ && !spill_->blocks.empty())
+    return DataSlice<PlatformUpdate>::Iterator(new IndexIterator(this, spillBound_(timeValue, true)));
+  if (!columns_)
+    return MemoryDataSlice<PlatformUpdate>::upper_bound(timeValue);
+
+  const auto iter = computeUpperBound<PlatformUpdateColumns::RowIterator, PlatformUpdateColumns::Row>(columns_->begin(),
+    PlatformUpdateColumns::RowIterator(columns_.get(), std::min(fastRow_, columns_->size())), columns_->end(), timeValue);
+  fastRow_ = iter.index();
+  return DataSlice<PlatformUpdate>::Iterator(new IndexIterator(this, iter.index()));
+}
+
+size_t PlatformMemoryDataSlice::numItems() const
+{
+  return residentItems_() + spilledItems();
+}
+
+void PlatformMemoryDataSlice::visit(DataSlice<PlatformUpdate>::Visitor* visitor) const
+{
+  if (spill_)
+  {
+    // Spilled blocks are read one at a time, without keeping copies
+    std::vector<uint8_t> bytes;
+    std::vector<PlatformUpdate> rows;
+    for (const Spill::Block& block : spill_->blocks)
+    {
+      rows.clear();
+      if ((spill_->file->read(block.location, bytes) != 0) || (decodeSpillBlock(bytes, rows) != 0))
+      {
+        SIM_ERROR << "Unable to read platform history from spill file " << spill_->file->filename() << "\n";
+        continue;
+      }
+      for (const auto& row : rows)
+        (*visitor)(&row);
+    }
+  }
+
+  if (!columns_)
+  {
+    MemoryDataSlice<PlatformUpdate>::visit(visitor);
+    return;
+  }
+
+  PlatformUpdate update;
+  for (size_t row = 0; row < columns_->size(); ++row)
+  {
+    columns_->get(row, update);
+    (*visitor)(&update);
+  }
+}
+
+void PlatformMemoryDataSlice::update(double time)
+{
+  spillUpdateTime_(time);
+  if (!columns_)
+  {
+    MemoryDataSlice<PlatformUpdate>::update(time);
+    return;
+  }
+
+  // start by marking as unchanged, new hasChanged status is outcome of this update
+  clearChanged();
+
+  // early out when there are no changes to this slice
+  if (!dirty_ && (current_ != nullptr) && ((current_->time() == time) || (current_->time() == -1.0)))
+    return;
+
+  dirty_ = false;
+
+  interpolated_ = false;
+  const auto end = columns_->end();
+  const auto iter = computeTimeUpdate<PlatformUpdateColumns::RowIterator, PlatformUpdateColumns::Row>(columns_->begin(),
+    PlatformUpdateColumns::RowIterator(columns_.get(), std::min(fastRow_, columns_->size())), end, time);
+  fastRow_ = iter.index();
+  setCurrentRow_(iter == end ? NO_ROW : iter.index());
+}
+
+void PlatformMemoryDataSlice::update(double time, std::optional<double>& startTime, std::optional<double>& endTime)
+{
+  spillUpdateTime_(time);
+  if (!columns_)
+  {
+    MemoryDataSlice<PlatformUpdate>::update(time, startTime, endTime);
+    return;
+  }
+
+  // start by marking as unchanged, new hasChanged status is outcome of this update
+  clearChanged();
+
+  // assume entire range then narrow down
+  startTime = 0;
+  endTime = std::numeric_limits<double>::max();
+
+  // early out when there are no changes to this slice
+  if (!dirty_ && (current_ != nullptr) && ((current_->time() == time) || (current_->time() == -1.0)))
+    return;
+
+  dirty_ = false;
+
+  interpolated_ = false;
+
+  const size_t size = columns_->size();
+  if (size == 0)
+  {
+    setCurrentRow_(NO_ROW);
+    return;
+  }
+
+  size_t row = columns_->lowerBound(time, 0, columns_->size());
+
+  if (row == 0) // At the start
+  {
+    if (columns_->time(row) == time)
+    {
+      // The first point matches the given time so the time range is from time to the time of the next point, if any
+      startTime = time;
+      if (row + 1 < size)
+        endTime = columns_->time(row + 1);
+    }
+    else
+    {
+      // The first point is greater than the given time so the time range is from 0 to the time of the first point
+      endTime = columns_->time(0);
+      row = NO_ROW;
+    }
+  }
+  else if (row < size) // In the middle
+  {
+    if (columns_->time(row) == time)
+    {
+      // The point matches the given time so the time range is from time to the time of the next point, if any
+      startTime = time;
+      if (row + 1 < size)
+        endTime = columns_->time(row + 1);
+    }
+    else
+    {
+      // The point time is greater than the given time so the time range is the time of the points that straddle the time.
+      endTime = columns_->time(row);
+      --row;
+      startTime = columns_->time(row);
+    }
+  }
+  else
+  {
+    // The given time is greater than all points to the time span is the last point to the end of time
+    startTime = columns_->time(size - 1);
+    row = size - 1;
+  }
+
+  setCurrentRow_(row);
+}
+
+void PlatformMemoryDataSlice::update(double time, Interpolator* interpolator)
+{
+  spillUpdateTime_(time);
+  if (!columns_)
+  {
+    MemoryDataSlice<PlatformUpdate>::update(time, interpolator);
+    return;
+  }
+
+  // start by marking as unchanged, new hasChanged status is outcome of this update
+  clearChanged();
+
+  // early out when there are no changes to this slice
+  if (!dirty_ && (current_ != nullptr) && ((current_->time() == time) || (current_->time() == -1.0)))
+    return;
+
+  // update is processing the changes to the slice, clear the flag
+  dirty_ = false;
+
+  // Mirrors the interpolating computeTimeUpdate(), copying the bounds out of the columns
+  const DataSlice<PlatformUpdate>::Bounds noBounds(nullptr, nullptr);
+  const auto begin = columns_->begin();
+  const auto end = columns_->end();
+  if (begin == end)
+  {
+    setCurrentRow_(NO_ROW);
+    setInterpolated(false, noBounds);
+    return;
+  }
+
+  const auto iter = computeUpperBound<PlatformUpdateColumns::RowIterator, PlatformUpdateColumns::Row>(begin,
+    PlatformUpdateColumns::RowIterator(columns_.get(), std::min(fastRow_, columns_->size())), end, time);
+  fastRow_ = iter.index();
+
+  // Closest update is the last point
+  if (iter == end)
+  {
+    setCurrentRow_(columns_->size() - 1);
+    setInterpolated(false, noBounds);
+    return;
+  }
+
+  // time is before the first point
+  if (iter == begin)
+  {
+    setCurrentRow_(NO_ROW);
+    setInterpolated(false, noBounds);
+    return;
+  }
+
+  // time is between points
+  const size_t previousRow = iter.index() - 1;
+  if (simCore::areEqual(time, columns_->time(previousRow)))
+  {
+    setCurrentRow_(previousRow);
+    setInterpolated(false, noBounds);
+    return;
+  }
+
+  columns_->get(previousRow, copies_->bounds[0]);
+  columns_->get(iter.index(), copies_->bounds[1]);
+  interpolator->interpolate(time, copies_->bounds[0], copies_->bounds[1], &currentInterpolated_);
+  currentIndex_ = NO_ROW;
+  setCurrent(&currentInterpolated_);
+  setInterpolated(true, DataSlice<PlatformUpdate>::Bounds(&copies_->bounds[0], &copies_->bounds[1]));
+}
+
+void PlatformMemoryDataSlice::insert(PlatformUpdate* data)
+{
+  if (!columns_)
+  {
+    if (restoreThrough_(data->time()) != 0)
+    {
+      SIM_ERROR << "Platform update at time " << data->time() << " dropped, since the spilled history it belongs in cannot be read\n";
+      delete data;
+      return;
+    }
+    MemoryDataSlice<PlatformUpdate>::insert(data);
+    spillOld_();
+    return;
+  }
+
+  insert(*data);
+  delete data;
+}
+
+void PlatformMemoryDataSlice::insert(const PlatformUpdate& update)
+{
+  if (restoreThrough_(update.time()) != 0)
+  {
+    SIM_ERROR << "Platform update at time " << update.time() << " dropped, since the spilled history it belongs in cannot be read\n";
+    return;
+  }
+  if (!columns_)
+  {
+    MemoryDataSlice<PlatformUpdate>::insert(new PlatformUpdate(update));
+    spillOld_();
+    return;
+  }
+
+  if (notifierFn_)
+    notifierFn_();
+
+  clearRowCache_();
+  size_t row = columns_->size();
+  if (!columns_->empty() && columns_->time(row - 1) >= update.time())
+  {
+    row = columns_->lowerBound(update.time(), 0, columns_->size());
+    if (columns_->time(row) == update.time())
+    {
+      // null the current ptr, if we are replacing the row it copies; current will become valid upon update
+      if (currentIndex_ == row)
+      {
+        currentIndex_ = NO_ROW;
+        setCurrent(nullptr);
+      }
+
+      columns_->set(row, update);
+      dirty_ = true;
+      return;
+    }
+  }
+
+  columns_->insert(row, update);
+  if (currentIndex_ != NO_ROW && row <= currentIndex_)
+    ++currentIndex_;
+  fastRow_ = columns_->size();
+  dirty_ = true;
+  spillOld_();
+}
+
+void PlatformMemoryDataSlice::insertBatch(std::span<PlatformUpdate*> updates)
+{
+  if (updates.empty())
+    return;
+  if (spill_)
+  {
+    const auto earliest = std::min_element(updates.begin(), updates.end(), UpdateComp<PlatformUpdate>());
+    if (restoreThrough_((*earliest)->time()) != 0)
+    {
+      SIM_ERROR << "Platform updates dropped, since the spilled history they belong in cannot be read\n";
+      for (PlatformUpdate* update : updates)
+        delete update;
+      return;
+    }
+  }
+
+  if (!columns_)
+    MemoryDataSlice<PlatformUpdate>::insertBatch(updates);
+  else
+  {
+    if (notifierFn_)
+      notifierFn_();
+    std::vector<const PlatformUpdate*> rows(updates.begin(), updates.end());
+    insertRows_(rows);
+    for (PlatformUpdate* update : updates)
+      delete update;
+  }
+  spillOld_();
+}
+
+void PlatformMemoryDataSlice::insertBatch(std::span<const PlatformUpdate> updates)
+{
+  if (updates.empty())
+    return;
+  if (spill_)
+  {
+    const auto earliest = std::min_element(updates.begin(), updates.end(),
+      [](const PlatformUpdate& lhs, const PlatformUpdate& rhs) { return lhs.time() < rhs.time(); });
+    if (restoreThrough_(earliest->time()) != 0)
+    {
+      SIM_ERROR << "Platform updates dropped, since the spilled history they belong in cannot be read\n";
+      return;
+    }
+  }
+
+  if (!columns_)
+  {
+    std::vector<PlatformUpdate*> copies;
+    copies.reserve(updates.size());
+    for (const auto& update : updates)
+      copies.push_back(new PlatformUpdate(update));
+    MemoryDataSlice<PlatformUpdate>::insertBatch(copies);
+  }
+  else
+  {
+    if (notifierFn_)
+      notifierFn_();
+    std::vector<const PlatformUpdate*> rows;
+    rows.reserve(updates.size());
+    for (const auto& update : updates)
+      rows.push_back(&update);
+    insertRows_(rows);
+  }
+  spillOld_();
+}
+
+void PlatformMemoryDataSlice::insertRows_(std::vector<const PlatformUpdate*>& rows)
+{
+  if (rows.empty())
+    return;
+
+  // Stable sort keeps the batch order of equal times, so the last one wins
+  if (!std::is_sorted(rows.begin(), rows.end(), UpdateComp<PlatformUpdate>()))
+    std::stable_sort(rows.begin(), rows.end(), UpdateComp<PlatformUpdate>());
+
+  clearRowCache_();
+  size_t next = 0;
+  auto appendNext = [this, &rows, &next]()
+  {
+    const PlatformUpdate* update = rows[next++];
+    if ((next == rows.size()) || (rows[next]->time() != update->time()))
+      columns_->push_back(*update);
+  };
+
+  size_t firstRow = columns_->size();
+  if (!columns_->empty() && (columns_->time(firstRow - 1) >= rows.front()->time()))
+    firstRow = columns_->lowerBound(rows.front()->time(), 0, columns_->size());
+
+  if (firstRow == columns_->size())
+  {
+    while (next < rows.size())
+      appendNext();
+  }
+  else
+  {
+    // Pull off the existing rows that overlap the batch, then merge them back with the batch
+    std::vector<PlatformUpdate> existing(columns_->size() - firstRow);
+    for (size_t ii = 0; ii < existing.size(); ++ii)
+      columns_->get(firstRow + ii, existing[ii]);
+    columns_->erase(firstRow, columns_->size());
+
+    const size_t oldCurrentIndex = currentIndex_;
+    if ((currentIndex_ != NO_ROW) && (currentIndex_ >= firstRow))
+      currentIndex_ = NO_ROW;
+
+    for (size_t ii = 0; ii < existing.size(); ++ii)
+    {
+      while ((next < rows.size()) && (rows[next]->time() < existing[ii].time()))
+        appendNext();
+
+      if ((next < rows.size()) && (rows[next]->time() == existing[ii].time()))
+      {
+        // null the current ptr, if we are replacing the row it copies; current will become valid upon update
+        if (oldCurrentIndex == firstRow + ii)
+          setCurrent(nullptr);
+        continue;
+      }
+
+      if (oldCurrentIndex == firstRow + ii)
+        currentIndex_ = columns_->size();
+      columns_->push_back(existing[ii]);
+    }
+
+    while (next < rows.size())
+      appendNext();
+  }
+
+  fastRow_ = columns_->size();
+  dirty_ = true;
+}
+
+void PlatformMemoryDataSlice::limitByTime(double timeWindow)
+{
+  if (!columns_)
+  {
+    if ((timeWindow >= 0) && limitSpilledByTime_(lastTime() - timeWindow) && notifierFn_)
+      notifierFn_();
+    MemoryDataSlice<PlatformUpdate>::limitByTime(timeWindow);
+    return;
+  }
+
+  if (timeWindow >= 0)
+  {
+    if (limitSpilledByTime_(lastTime() - timeWindow) && notifierFn_)
+      notifierFn_();
+    const size_t before = columns_->size();
+    if (MemorySliceHelper::limitByTime(*columns_, lastTime() - timeWindow) == 0)
+    {
+      frontRowsRemoved_(before - columns_->size());
+      if (notifierFn_)
+        notifierFn_();
+    }
+  }
+}
+
+void PlatformMemoryDataSlice::limitByPoints(uint32_t limitPoints)
+{
+  if (limitSpilledByPoints_(limitPoints) && notifierFn_)
+    notifierFn_();
+  if (!columns_)
+  {
+    MemoryDataSlice<PlatformUpdate>::limitByPoints(limitPoints);
+    return;
+  }
+
+  const size_t before = columns_->size();
+  if (MemorySliceHelper::limitByPoints(*columns_, limitPoints) == 0)
+  {
+    frontRowsRemoved_(before - columns_->size());
+    if (notifierFn_)
+      notifierFn_();
+  }
+}
+
+double PlatformMemoryDataSlice::firstTime() const
+{
+  if (spill_ && !spill_->blocks.empty())
+    return spill_->blocks.front().firstTime;
+  if (!columns_)
+    return MemoryDataSlice<PlatformUpdate>::firstTime();
+
+  if (columns_->empty())
+    return std::numeric_limits<double>::max();
+  return columns_->time(0);
+}
+
+double PlatformMemoryDataSlice::lastTime() const
+{
+  if (!columns_)
+    return MemoryDataSlice<PlatformUpdate>::lastTime();
+
+  if (columns_->empty())
+    return -std::numeric_limits<double>::max();
+  return columns_->time(columns_->size() - 1);
+}
+
+double PlatformMemoryDataSlice::deltaTime(double time) const
+{
+  if (spill_ && !spill_->blocks.empty() && (time >= 0.0) && ((residentItems_() == 0) || (time <= residentTime_(0))))
+  {
+    const size_t index = spillBound_(time, false);
+    std::shared_ptr<const PlatformUpdate> holdNext;
+    std::shared_ptr<const PlatformUpdate> holdPrevious;
+    const PlatformUpdate* next = (index < numItems()) ? row_(index, holdNext) : nullptr;
+    if (next && next->time() == time)
+      return 0.0;
+    const PlatformUpdate* previous = (index > 0) ? row_(index - 1, holdPrevious) : nullptr;
+    // Check for static point
+    if (!previous || previous->time() < 0.0)
+      return -1.0;
+    return time - previous->time();
+  }
+  if (!columns_)
+    return MemoryDataSlice<PlatformUpdate>::deltaTime(time);
+
+  if (columns_->empty() || (time < 0.0))
+    return -1.0;
+
+  auto it = computeLowerBound<PlatformUpdateColumns::RowIterator, PlatformUpdateColumns::Row>(columns_->begin(),
+    PlatformUpdateColumns::RowIterator(columns_.get(), std::min(fastRow_, columns_->size())), columns_->end(), time);
+
+  if (it != columns_->end())
+  {
+    if ((*it).time() == time)
+      return 0.0;
+
+    if (it == columns_->begin())
+      return -1.0;
+  }
+
+  --it;
+
+  // Check for static point
+  if ((*it).time() < 0.0)
+    return -1.0;
+
+  return time - (*it).time();
+}
+
+void PlatformMemoryDataSlice::modify(DataSlice<PlatformUpdate>::Modifier* modifier)
+{
+  restoreAll_();
+  MemoryDataSlice<PlatformUpdate>::modify(modifier);
+}
+
+DataSlice<PlatformUpdate>::IteratorImpl* PlatformMemoryDataSlice::iterator_() const
+{
+  if (!columns_ && (!spill_ || spill_->blocks.empty()))
+    return MemoryDataSlice<PlatformUpdate>::iterator_();
+  return new IndexIterator(this);
+}
+
+} // End of namespace simData
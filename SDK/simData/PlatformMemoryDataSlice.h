@@ -0,0 +1,479 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_PLATFORMMEMORYDATASLICE_H
+#define SIMDATA_PLATFORMMEMORYDATASLICE_H
+
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <vector>
+#include "simCore/Common/Common.h"
+#include "simData/MemoryDataSlice.h"
+
+namespace simData
+{
+
+class SpillFile;
+
+/**
+ * Structure-of-arrays storage for platform TSPI.  Each PlatformUpdate field is held in
+ * its own column, and a 16 bit presence mask per row replaces the per-field optionals.
+ * Columns are stored in fixed size chunks so that appending and trimming from the
+ * front (the common live mode pattern) never moves existing rows.
+ *
+ * With compression enabled, each full chunk is packed into a byte stream: times as
+ * delta-of-delta microsecond ticks (exact; chunks whose times are not whole microseconds
+ * are stored losslessly), and positions, angles and velocities as delta-of-deltas of values
+ * quantized per Compression.  Packed chunks are decoded on access into a small cache of
+ * DECODED_CHUNK_CACHE chunks, so sequential access decodes each chunk once.  The first and
+ * last time of each packed chunk are also kept unpacked, so lowerBound() and upperBound()
+ * find the chunk holding a time without decoding and then decode only that chunk.  Const
+ * methods may be called from several threads at once.
+ */
+class SDKDATA_EXPORT PlatformUpdateColumns
+{
+public:
+  /// Bits of the presence mask, one per PlatformUpdate field
+  enum FieldBit : uint16_t
+  {
+    TIME_BIT = 1 << 0,
+    X_BIT = 1 << 1,
+    Y_BIT = 1 << 2,
+    Z_BIT = 1 << 3,
+    PSI_BIT = 1 << 4,
+    THETA_BIT = 1 << 5,
+    PHI_BIT = 1 << 6,
+    VX_BIT = 1 << 7,
+    VY_BIT = 1 << 8,
+    VZ_BIT = 1 << 9
+  };
+
+  /// Number of rows in a full chunk; must be a power of two
+  static constexpr size_t CHUNK_ROWS = 64;
+  /// Bytes of column storage used by a single row
+  static constexpr size_t BYTES_PER_ROW = 4 * sizeof(double) + 6 * sizeof(float) + sizeof(uint16_t);
+  /// Number of decoded chunks kept when compression is enabled
+  static constexpr size_t DECODED_CHUNK_CACHE = 4;
+
+  /**
+   * Quantization of compressed chunks.  A decoded value is within half a quantum of the
+   * inserted value; angles and velocities also carry the float rounding of the uncompressed
+   * columns.  A quantum of 0 stores that field exactly.
+   */
+  struct Compression
+  {
+    /// Quantum of the ECEF position, meters
+    double positionQuantum = 0.001;
+    /// Quantum of the orientation angles, radians
+    double angleQuantum = 1e-6;
+    /// Quantum of the velocity, meters per second
+    double velocityQuantum = 0.001;
+  };
+
+  /// Light weight reference to a row; provides time() so the DataSliceUpdaters search helpers can be used
+  class Row
+  {
+  public:
+    /// Constructor
+    Row(const PlatformUpdateColumns* columns, size_t row)
+      : columns_(columns),
+        row_(row)
+    {
+    }
+    /// Time of the row
+    double time() const { return columns_->time(row_); }
+    /// Allows (*iter)->time() in the search helpers
+    const Row* operator->() const { return this; }
+    /// Index of the row
+    size_t index() const { return row_; }
+
+  private:
+    const PlatformUpdateColumns* columns_;
+    size_t row_;
+  };
+
+  /// Random access iterator over the rows; dereferences to a Row
+  class RowIterator
+  {
+  public:
+    /// STL iterator traits
+    typedef std::random_access_iterator_tag iterator_category;
+    /// STL iterator traits
+    typedef Row value_type;
+    /// STL iterator traits
+    typedef std::ptrdiff_t difference_type;
+    /// STL iterator traits
+    typedef const Row* pointer;
+    /// STL iterator traits
+    typedef Row reference;
+
+    RowIterator() = default;
+    /// Constructs an iterator at the given row
+    RowIterator(const PlatformUpdateColumns* columns, size_t row)
+      : columns_(columns),
+        row_(row)
+    {
+    }
+
+    /// Index of the row pointed to
+    size_t index() const { return row_; }
+    /// Columns iterated over
+    const PlatformUpdateColumns* columns() const { return columns_; }
+
+    /// Dereference operators
+    Row operator*() const { return Row(columns_, row_); }
+    /// Dereference with offset
+    Row operator[](difference_type n) const { return Row(columns_, row_ + n); }
+
+    /// Increment and decrement operators
+    RowIterator& operator++() { ++row_; return *this; }
+    /// Increment and decrement operators
+    RowIterator operator++(int) { RowIterator rv(*this); ++row_; return rv; }
+    /// Increment and decrement operators
+    RowIterator& operator--() { --row_; return *this; }
+    /// Increment and decrement operators
+    RowIterator operator--(int) { RowIterator rv(*this); --row_; return rv; }
+    /// Arithmetic operators
+    RowIterator& operator+=(difference_type n) { row_ += n; return *this; }
+    /// Arithmetic operators
+    RowIterator& operator-=(difference_type n) { row_ -= n; return *this; }
+    /// Arithmetic operators
+    RowIterator operator+(difference_type n) const { return RowIterator(columns_, row_ + n); }
+    /// Arithmetic operators
+    RowIterator operator-(difference_type n) const { return RowIterator(columns_, row_ - n); }
+    /// Arithmetic operators
+    difference_type operator-(const RowIterator& rhs) const { return static_cast<difference_type>(row_) - static_cast<difference_type>(rhs.row_); }
+
+    /// Comparison operators
+    bool operator==(const RowIterator& rhs) const { return row_ == rhs.row_; }
+    /// Comparison operators
+    bool operator!=(const RowIterator& rhs) const { return row_ != rhs.row_; }
+    /// Comparison operators
+    bool operator<(const RowIterator& rhs) const { return row_ < rhs.row_; }
+    /// Comparison operators
+    bool operator>(const RowIterator& rhs) const { return row_ > rhs.row_; }
+    /// Comparison operators
+    bool operator<=(const RowIterator& rhs) const { return row_ <= rhs.row_; }
+    /// Comparison operators
+    bool operator>=(const RowIterator& rhs) const { return row_ >= rhs.row_; }
+
+  private:
+    const PlatformUpdateColumns* columns_ = nullptr;
+    size_t row_ = 0;
+  };
+
+  PlatformUpdateColumns();
+  ~PlatformUpdateColumns();
+
+  SDK_DISABLE_COPY_MOVE(PlatformUpdateColumns);
+
+  /// Number of rows
+  size_t size() const;
+  /// Returns true if there are no rows
+  bool empty() const;
+  /// Iterator to the first row
+  RowIterator begin() const;
+  /// Iterator past the last row
+  RowIterator end() const;
+
+  /// Time of the given row
+  double time(size_t row) const;
+  /// Presence mask of the given row, see FieldBit
+  uint16_t presence(size_t row) const;
+  /// Copies the given row into update
+  void get(size_t row, PlatformUpdate& update) const;
+  /// Index of the first row in [first, last) at or after time, or last if none; decodes at most one packed chunk
+  size_t lowerBound(double time, size_t first, size_t last) const;
+  /// Index of the first row in [first, last) after time, or last if none; decodes at most one packed chunk
+  size_t upperBound(double time, size_t first, size_t last) const;
+  /// Overwrites the given row with the values of update
+  void set(size_t row, const PlatformUpdate& update);
+
+  /// Adds update after the last row
+  void push_back(const PlatformUpdate& update);
+  /// Adds update before the given row
+  void insert(size_t row, const PlatformUpdate& update);
+  /// Removes rows [first, last)
+  void erase(size_t first, size_t last);
+  /// Removes all rows and releases all chunks
+  void clear();
+
+  /// Approximate number of bytes allocated for the column storage
+  size_t memoryUsage() const;
+
+  /// Enables compression of full chunks with the given quantization, or disables it for nullptr, unpacking all chunks
+  void setCompression(const Compression* compression);
+  /// Returns the compression settings, or nullptr if compression is disabled
+  const Compression* compression() const;
+
+private:
+  struct Chunk;
+  struct DecodedChunks;
+
+  /**
+   * Returns the chunk holding the row and the slot of the row within the chunk.  Packed chunks
+   * are decoded into the cache, and hold keeps the decoded chunk alive while it is read.
+   */
+  const Chunk* readChunk_(size_t row, size_t& slot, std::shared_ptr<const Chunk>& hold) const;
+  /// Time of the last row of a chunk other than the last chunk, without decoding
+  double chunkLastTime_(size_t chunkIndex) const;
+  /// Shared implementation of lowerBound() and upperBound()
+  size_t bound_(double time, size_t first, size_t last, bool upper) const;
+  /// Returns the chunk holding the row and the slot of the row within the chunk; packed chunks are unpacked
+  Chunk* writeChunk_(size_t row, size_t& slot);
+  /// Packs all full chunks that are not packed, except the last chunk
+  void packFullChunks_();
+  /// Drops the decoded chunks, which may point to chunks being changed or released
+  void clearDecoded_();
+  /// Makes room for one more row at the back
+  void reserveBack_();
+  /// Copies all columns of row src into row dst
+  void copyRow_(size_t dst, size_t src);
+
+  /// Chunks of column data; all chunks except the last hold CHUNK_ROWS rows
+  std::deque<std::unique_ptr<Chunk>> chunks_;
+  /// Number of rows removed from the front of the first chunk
+  size_t offset_ = 0;
+  /// Number of rows
+  size_t size_ = 0;
+  /// Compression settings; nullptr when compression is disabled
+  std::unique_ptr<Compression> compression_;
+  /// Cache of decoded packed chunks; nullptr when compression is disabled
+  std::unique_ptr<DecodedChunks> decoded_;
+  /// Set when a chunk other than the last was unpacked for writing and needs packing again
+  bool repack_ = false;
+};
+
+/// Comparison of column rows by time, for use with std::lower_bound and std::upper_bound
+template<>
+struct UpdateComp<PlatformUpdateColumns::Row>
+{
+  /// Less-than operator for time, two rows
+  bool operator()(const PlatformUpdateColumns::Row& lhs, const PlatformUpdateColumns::Row& rhs) const
+  {
+    return lhs.time() < rhs.time();
+  }
+
+  /// Less-than operator for time, LHS row
+  bool operator()(const PlatformUpdateColumns::Row& lhs, double rhs) const
+  {
+    return lhs.time() < rhs;
+  }
+
+  /// Less-than operator for time, RHS row
+  bool operator()(double lhs, const PlatformUpdateColumns::Row& rhs) const
+  {
+    return lhs < rhs.time();
+  }
+};
+
+/// Searches the columns by chunk, so a search decodes at most one packed chunk
+template <>
+inline PlatformUpdateColumns::RowIterator searchLowerBound<PlatformUpdateColumns::RowIterator, PlatformUpdateColumns::Row>(
+  PlatformUpdateColumns::RowIterator begin, PlatformUpdateColumns::RowIterator end, double time)
+{
+  if (begin == end)
+    return end;
+  return PlatformUpdateColumns::RowIterator(begin.columns(), begin.columns()->lowerBound(time, begin.index(), end.index()));
+}
+
+/// Searches the columns by chunk, so a search decodes at most one packed chunk
+template <>
+inline PlatformUpdateColumns::RowIterator searchUpperBound<PlatformUpdateColumns::RowIterator, PlatformUpdateColumns::Row>(
+  PlatformUpdateColumns::RowIterator begin, PlatformUpdateColumns::RowIterator end, double time)
+{
+  if (begin == end)
+    return end;
+  return PlatformUpdateColumns::RowIterator(begin.columns(), begin.columns()->upperBound(time, begin.index(), end.index()));
+}
+
+namespace MemorySliceHelper
+{
+/// Column storage version of limitByTime(); returns 0 if at least one row is removed
+SDKDATA_EXPORT int limitByTime(PlatformUpdateColumns& updates, double timeLimit);
+/// Column storage version of limitByPoints(); returns 0 if at least one row is removed
+SDKDATA_EXPORT int limitByPoints(PlatformUpdateColumns& updates, uint32_t limitPoints);
+/// Column storage version of flush(); returns non-zero if flush did not occur due to static case
+SDKDATA_EXPORT int flush(PlatformUpdateColumns& updates, bool keepStatic = true);
+/// Column storage version of flush(); removes rows up to but not including endTime
+SDKDATA_EXPORT int flush(PlatformUpdateColumns& updates, double startTime, double endTime);
+} // namespace MemorySliceHelper
+
+/**
+ * Platform specific implementation of the MemoryDataSlice used by the MemoryDataStore.
+ * By default the updates are stored the same as any other MemoryDataSlice.  When columnar
+ * storage is enabled the updates are copied into a PlatformUpdateColumns and deleted,
+ * removing the per-point heap allocation and pointer for large histories.
+ *
+ * With columnar storage, current() and interpolationBounds() point to copies owned by the
+ * slice.  Pointers returned by iterators point to row copies: the slice keeps copies of the
+ * last few rows read, and each iterator keeps the last few rows it returned, so a scan of the
+ * whole history holds only a handful of copies.  A pointer from an iterator remains valid
+ * while the iterator lives and has not returned four more rows, and otherwise until the slice
+ * is modified or reads ROW_COPIES other rows.  memoryUsage() counts the copies kept by the slice.
+ *
+ * With a spill file set, history older than the spill window is moved out of memory into
+ * compressed blocks of SPILL_BLOCK_ROWS updates.  update() reads back the spilled blocks it
+ * needs and spills them again once time moves past them; inserts, flushes and limits that
+ * reach spilled history also read it back.  Const queries such as lower_bound(), iterators
+ * and deltaTime() leave the slice unchanged, reading the blocks they reach into copies held
+ * until the next update() or change to the slice, and visit() reads one block at a time.
+ * A block that cannot be read back is reported and stays in the spill file.
+ */
+class SDKDATA_EXPORT PlatformMemoryDataSlice : public MemoryDataSlice<PlatformUpdate>
+{
+public:
+  /// Number of updates in each block written to the spill file
+  static constexpr size_t SPILL_BLOCK_ROWS = 1024;
+  /// Number of recently read rows whose copies a slice with columnar storage keeps
+  static constexpr size_t ROW_COPIES = 16;
+
+  PlatformMemoryDataSlice();
+  virtual ~PlatformMemoryDataSlice();
+
+  /// Switches between row and columnar storage, moving any existing updates
+  void setColumnarStorage(bool columnar);
+  /// Returns true if the updates are in columnar storage
+  bool columnarStorage() const;
+  /**
+   * Enables compression of the columnar storage with the given quantization, or disables it for
+   * nullptr.  The setting is kept while using row storage and applies once columnar storage is enabled.
+   */
+  void setCompression(const PlatformUpdateColumns::Compression* compression);
+  /// Returns the compression settings, or nullptr if compression is disabled
+  const PlatformUpdateColumns::Compression* compression() const;
+  /// Approximate number of bytes used to hold the updates, not counting allocator overhead
+  size_t memoryUsage() const override;
+
+  /**
+   * Moves updates more than window seconds older than both the last update and the time of the
+   * last call to update() into the spill file.  A null file turns spilling off, reading back all
+   * spilled updates.  Several slices may share one file.
+   */
+  void setSpill(std::shared_ptr<SpillFile> file, double window);
+  /// Seconds of history kept in memory, or 0 if spilling is off
+  double spillWindow() const;
+  /// Number of updates held in the spill file; included in numItems()
+  size_t spilledItems() const;
+
+  // From MemoryDataSlice
+  void flush(bool keepStatic = true) override;
+  void flush(double startTime, double endTime) override;
+  DataSlice<PlatformUpdate>::Iterator lower_bound(double timeValue) const override;
+  DataSlice<PlatformUpdate>::Iterator upper_bound(double timeValue) const override;
+  size_t numItems() const override;
+  void visit(DataSlice<PlatformUpdate>::Visitor* visitor) const override;
+  void update(double time) override;
+  void update(double time, std::optional<double>& startTime, std::optional<double>& endTime) override;
+  void insert(PlatformUpdate* data) override;
+  void insertBatch(std::span<PlatformUpdate*> updates) override;
+  void limitByTime(double timeWindow) override;
+  void limitByPoints(uint32_t limitPoints) override;
+  double firstTime() const override;
+  double lastTime() const override;
+  double deltaTime(double time) const override;
+  void modify(DataSlice<PlatformUpdate>::Modifier* modifier) override;
+
+  /** Inserts a copy of the update; with columnar storage no PlatformUpdate is allocated */
+  void insert(const PlatformUpdate& update);
+  /** Inserts copies of the updates as in insertBatch(); with columnar storage no PlatformUpdate is allocated */
+  void insertBatch(std::span<const PlatformUpdate> updates);
+
+  /**
+   * Hides MemoryDataSlice::update(double, Interpolator*), which is not virtual since
+   * not every update type supports interpolation
+   */
+  void update(double time, Interpolator* interpolator);
+
+protected:
+  DataSlice<PlatformUpdate>::IteratorImpl* iterator_() const override;
+
+private:
+  class IndexIterator;
+  struct RowCopies;
+  struct Spill;
+
+  /// Returns a copy of the row, reusing the copy of a recently read row; safe to call from several threads
+  std::shared_ptr<const PlatformUpdate> cachedRow_(size_t row) const;
+  /// Releases the row copies handed out by iterators
+  void clearRowCache_();
+  /// Sets current to the given row, or to nullptr if the row is out of range
+  void setCurrentRow_(size_t row);
+  /// Adjusts the cached row indices after rows are removed from the front
+  void frontRowsRemoved_(size_t count);
+  /// Sorts the updates by time, then merges them into the column storage
+  void insertRows_(std::vector<const PlatformUpdate*>& rows);
+
+  /// Number of updates held in memory
+  size_t residentItems_() const;
+  /// Time of the given in-memory update
+  double residentTime_(size_t row) const;
+  /// Records the time of an update() call and reads back spilled updates it needs
+  void spillUpdateTime_(double time);
+  /// Writes the oldest in-memory updates outside the spill window to the spill file
+  void spillOld_();
+  /// Reads back the spilled updates needed for time and later; returns 0 on success
+  int restoreThrough_(double time);
+  /// Reads back all spilled updates; returns 0 on success
+  int restoreAll_();
+  /// Reads back the spilled blocks from firstBlock on, adding them in front of the in-memory updates; returns 0 if all were read
+  int restoreFrom_(size_t firstBlock);
+  /// Releases the copies of spilled blocks made for queries
+  void clearSpilledCopies_();
+  /// Returns a copy of a spilled block, reading it from the spill file if needed; nullptr if it cannot be read
+  const std::vector<PlatformUpdate>* spilledBlock_(size_t block) const;
+  /**
+   * Returns the update at index, counting spilled updates first; nullptr if its spilled block cannot be read.
+   * A copy of a row from columnar storage is held by hold, keeping it valid after the slice reads other rows.
+   */
+  const PlatformUpdate* row_(size_t index, std::shared_ptr<const PlatformUpdate>& hold) const;
+  /// Index of the first in-memory update at or after time, or after time if upper
+  size_t residentBound_(double time, bool upper) const;
+  /// Index of the first update at or after time, or after time if upper, counting spilled updates first
+  size_t spillBound_(double time, bool upper) const;
+  /// Releases the first count spilled blocks without reading them back
+  void dropSpilled_(size_t count);
+  /// Drops or reads back spilled updates for limitByTime(); returns true if any update was removed
+  bool limitSpilledByTime_(double timeLimit);
+  /// Drops or reads back spilled updates for limitByPoints(); returns true if any update was removed
+  bool limitSpilledByPoints_(uint32_t limitPoints);
+
+  /// Column storage; nullptr when using row storage
+  std::unique_ptr<PlatformUpdateColumns> columns_;
+  /// Copies of rows pointed to by current(), the bounds and iterators; nullptr when using row storage
+  std::unique_ptr<RowCopies> copies_;
+  /// Index of the row copied into current()
+  size_t currentIndex_;
+  /// Used to optimize updates by looking at data near the last update
+  mutable size_t fastRow_;
+  /// Spill file state; nullptr when spilling is off
+  std::unique_ptr<Spill> spill_;
+  /// Compression settings for the column storage; nullptr when compression is off
+  std::unique_ptr<PlatformUpdateColumns::Compression> compression_;
+};
+
+} // End of namespace simData
+
+#endif // SIMDATA_PLATFORMMEMORYDATASLICE_H
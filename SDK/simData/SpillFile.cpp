@@ -0,0 +1,199 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include "simData/SpillFile.h"
+
+namespace simData {
+
+/// Mode for the spill file; trunc creates it empty
+static const std::ios::openmode SPILL_OPEN_MODE = std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc;
+
+SpillFile::SpillFile(const std::string& directory)
+{
+  std::error_code ec;
+  const std::filesystem::path dir = directory.empty() ? std::filesystem::temp_directory_path(ec) : std::filesystem::path(directory);
+  if (ec)
+    return;
+
+  // Process-wide counter plus a random tag keeps names unique across stores and processes
+  static std::atomic<unsigned int> counter = 0;
+  std::random_device random;
+  for (int attempt = 0; attempt < 10; ++attempt)
+  {
+    std::ostringstream name;
+    name << "simdata_spill_" << std::hex << random() << "_" << counter.fetch_add(1) << ".tmp";
+    const std::filesystem::path path = dir / name.str();
+    if (std::filesystem::exists(path, ec))
+      continue;
+    file_.open(path, SPILL_OPEN_MODE);
+    if (file_.is_open())
+    {
+      filename_ = path.string();
+      return;
+    }
+  }
+}
+
+SpillFile::~SpillFile()
+{
+  if (!file_.is_open())
+    return;
+  file_.close();
+  std::error_code ec;
+  std::filesystem::remove(filename_, ec);
+}
+
+bool SpillFile::isOpen() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return file_.is_open();
+}
+
+const std::string& SpillFile::filename() const
+{
+  return filename_;
+}
+
+int SpillFile::write(const std::vector<uint8_t>& bytes, Block& block)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!file_.is_open())
+    return 1;
+
+  // First released extent that fits; blocks are of similar sizes, so this keeps the file compact
+  const uint64_t size = bytes.size();
+  auto extent = std::find_if(free_.begin(), free_.end(), [size](const std::pair<const uint64_t, uint64_t>& free) { return free.second >= size; });
+  const uint64_t offset = (extent == free_.end()) ? fileSize_ : extent->first;
+
+  file_.clear();
+  file_.seekp(static_cast<std::streamoff>(offset));
+  file_.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(size));
+  if (!file_)
+  {
+    file_.clear();
+    return 1;
+  }
+
+  if (extent == free_.end())
+    fileSize_ += size;
+  else
+  {
+    const uint64_t remaining = extent->second - size;
+    free_.erase(extent);
+    if (remaining != 0)
+      free_[offset + size] = remaining;
+  }
+  block.offset = offset;
+  block.size = size;
+  liveBytes_ += size;
+  return 0;
+}
+
+int SpillFile::read(const Block& block, std::vector<uint8_t>& bytes)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!file_.is_open() || block.offset + block.size > fileSize_)
+    return 1;
+
+  bytes.resize(static_cast<size_t>(block.size));
+  file_.clear();
+  file_.seekg(static_cast<std::streamoff>(block.offset));
+  file_.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(block.size));
+  if (!file_)
+  {
+    file_.clear();
+    return 1;
+  }
+  return 0;
+}
+
+void SpillFile::release(const Block& block)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  liveBytes_ -= std::min(liveBytes_, block.size);
+  if (block.size == 0 || !file_.is_open())
+    return;
+
+  if (liveBytes_ == 0)
+  {
+    // Nothing left in the file; reopening with trunc gives the disk space back
+    file_.close();
+    file_.open(filename_, SPILL_OPEN_MODE);
+    fileSize_ = 0;
+    free_.clear();
+    return;
+  }
+
+  // Merge with the released extents on either side
+  uint64_t offset = block.offset;
+  uint64_t size = block.size;
+  auto next = free_.lower_bound(offset);
+  if ((next != free_.end()) && (offset + size == next->first))
+  {
+    size += next->second;
+    next = free_.erase(next);
+  }
+  if (next != free_.begin())
+  {
+    auto previous = std::prev(next);
+    if (previous->first + previous->second == offset)
+    {
+      offset = previous->first;
+      size += previous->second;
+      free_.erase(previous);
+    }
+  }
+
+  // Give released space at the end of the file back to the disk, or keep it for reuse if that fails
+  if (offset + size >= fileSize_)
+  {
+    file_.flush();
+    std::error_code ec;
+    std::filesystem::resize_file(filename_, offset, ec);
+    if (!ec)
+    {
+      fileSize_ = offset;
+      return;
+    }
+  }
+  free_[offset] = size;
+}
+
+uint64_t SpillFile::liveBytes() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return liveBytes_;
+}
+
+uint64_t SpillFile::fileSize() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return fileSize_;
+}
+
+}
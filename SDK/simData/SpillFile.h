@@ -0,0 +1,88 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_SPILLFILE_H
+#define SIMDATA_SPILLFILE_H
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "simCore/Common/Common.h"
+
+namespace simData
+{
+
+/**
+ * Temporary file holding blocks of data moved out of memory.  Blocks are read back by position.
+ * Released space is reused by later writes, and released space at the end of the file is
+ * truncated, so the file stays near the size of the blocks in use.  The file is removed when
+ * the SpillFile is destroyed.  Thread safe, so several slices can share one file.
+ */
+class SDKDATA_EXPORT SpillFile
+{
+public:
+  /// Position of a block in the file
+  struct Block
+  {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+  };
+
+  /** Creates a uniquely named file in directory, or in the system temporary directory if empty */
+  explicit SpillFile(const std::string& directory = "");
+  virtual ~SpillFile();
+
+  SDK_DISABLE_COPY_MOVE(SpillFile);
+
+  /// Returns true if the file was created and can be written
+  bool isOpen() const;
+  /// Full path of the file
+  const std::string& filename() const;
+
+  /** Writes bytes into released space large enough to hold them, or else appends them, returning their position in block; returns 0 on success */
+  int write(const std::vector<uint8_t>& bytes, Block& block);
+  /** Reads the block into bytes; returns 0 on success */
+  int read(const Block& block, std::vector<uint8_t>& bytes);
+  /** Marks the block as no longer needed, so later writes can reuse its space */
+  void release(const Block& block);
+
+  /// Bytes in blocks that have not been released
+  uint64_t liveBytes() const;
+  /// Bytes in the file, including released space that has not been reused
+  uint64_t fileSize() const;
+
+private:
+  mutable std::mutex mutex_;
+  std::string filename_;
+  std::fstream file_;
+  uint64_t liveBytes_ = 0;
+  uint64_t fileSize_ = 0;
+  /// Released extents, size by offset; adjacent extents are merged
+  std::map<uint64_t, uint64_t> free_;
+};
+
+}
+
+#endif /* SIMDATA_SPILLFILE_H */
@@ -0,0 +1,113 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cassert>
+#include "simData/StringArena.h"
+
+namespace simData
+{
+
+/** Returns the heap bytes of a string; short strings are held inside the std::string itself */
+static size_t heapBytes(const std::string& value)
+{
+  static const size_t SHORT_CAPACITY = std::string().capacity();
+  return (value.capacity() > SHORT_CAPACITY) ? value.capacity() + 1 : 0;
+}
+
+StringArena::StringArena()
+{
+}
+
+StringArena::~StringArena()
+{
+}
+
+StringArena::StringId StringArena::intern(std::string_view value)
+{
+  auto iter = index_.find(value);
+  if (iter != index_.end())
+  {
+    ++entries_[iter->second].references;
+    return iter->second;
+  }
+
+  StringId id;
+  if (freeIds_.empty())
+  {
+    id = static_cast<StringId>(entries_.size());
+    entries_.emplace_back();
+  }
+  else
+  {
+    id = freeIds_.back();
+    freeIds_.pop_back();
+  }
+
+  Entry& entry = entries_[id];
+  entry.value.assign(value.data(), value.size());
+  entry.references = 1;
+  stringBytes_ += heapBytes(entry.value);
+  // View the stored copy, not the caller's string
+  index_.emplace(std::string_view(entry.value), id);
+  return id;
+}
+
+void StringArena::addReference(StringId id)
+{
+  assert(id < entries_.size() && entries_[id].references != 0);
+  ++entries_[id].references;
+}
+
+void StringArena::release(StringId id)
+{
+  assert(id < entries_.size() && entries_[id].references != 0);
+  Entry& entry = entries_[id];
+  if (--entry.references != 0)
+    return;
+
+  index_.erase(std::string_view(entry.value));
+  stringBytes_ -= heapBytes(entry.value);
+  // Give back the memory of long strings; swap with an empty string rather than clear()
+  std::string().swap(entry.value);
+  freeIds_.push_back(id);
+}
+
+const std::string& StringArena::value(StringId id) const
+{
+  assert(id < entries_.size() && entries_[id].references != 0);
+  return entries_[id].value;
+}
+
+size_t StringArena::size() const
+{
+  return index_.size();
+}
+
+size_t StringArena::memoryUsage() const
+{
+  // Each index node holds a view and an ID, plus a bucket pointer and the node's next pointer
+  return sizeof(StringArena) + entries_.size() * sizeof(Entry) + freeIds_.capacity() * sizeof(StringId) +
+    index_.size() * (sizeof(std::string_view) + sizeof(StringId) + 2 * sizeof(void*)) +
+    index_.bucket_count() * sizeof(void*) + stringBytes_;
+}
+
+}
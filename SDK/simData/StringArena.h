@@ -0,0 +1,86 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_STRINGARENA_H
+#define SIMDATA_STRINGARENA_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "simCore/Common/Common.h"
+
+namespace simData
+{
+
+/**
+ * Reference counted pool of interned strings, shared by the generic data slices of a data store
+ * so that each distinct key and value is stored once.  A string is freed when its last reference
+ * is released, and its ID is reused.  Not thread safe.
+ */
+class SDKDATA_EXPORT StringArena
+{
+public:
+  /// Identifies an interned string
+  typedef uint32_t StringId;
+
+  StringArena();
+  virtual ~StringArena();
+
+  SDK_DISABLE_COPY_MOVE(StringArena);
+
+  /** Returns the ID of the string, adding it if needed, and adds a reference to it */
+  StringId intern(std::string_view value);
+  /** Adds a reference to an interned string */
+  void addReference(StringId id);
+  /** Removes a reference to an interned string, freeing the string when none remain */
+  void release(StringId id);
+
+  /** Returns the string for an ID; valid until the last reference is released */
+  const std::string& value(StringId id) const;
+
+  /** Returns the number of distinct strings held */
+  size_t size() const;
+  /** Estimated number of bytes used by the strings and the lookup table */
+  size_t memoryUsage() const;
+
+private:
+  /// An interned string and its reference count; 0 references marks a free slot
+  struct Entry
+  {
+    std::string value;
+    uint32_t references = 0;
+  };
+
+  /// Entries do not move when the deque grows, so the index can view their strings
+  std::deque<Entry> entries_;
+  std::vector<StringId> freeIds_;
+  std::unordered_map<std::string_view, StringId> index_;
+  /// Heap bytes of the held strings
+  size_t stringBytes_ = 0;
+};
+
+}
+
+#endif /* SIMDATA_STRINGARENA_H */
@@ -0,0 +1,63 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include "simData/TableColumnStatistics.h"
+
+namespace simData
+{
+
+int accumulateStatistics(const TableColumn::ValueSpan& span, double threshold, TableColumn::Statistics& stats)
+{
+  switch (span.type)
+  {
+  case VT_UINT8: accumulateStatistics(span.values<uint8_t>(), threshold, stats); return 0;
+  case VT_INT8: accumulateStatistics(span.values<int8_t>(), threshold, stats); return 0;
+  case VT_UINT16: accumulateStatistics(span.values<uint16_t>(), threshold, stats); return 0;
+  case VT_INT16: accumulateStatistics(span.values<int16_t>(), threshold, stats); return 0;
+  case VT_UINT32: accumulateStatistics(span.values<uint32_t>(), threshold, stats); return 0;
+  case VT_INT32: accumulateStatistics(span.values<int32_t>(), threshold, stats); return 0;
+  case VT_UINT64: accumulateStatistics(span.values<uint64_t>(), threshold, stats); return 0;
+  case VT_INT64: accumulateStatistics(span.values<int64_t>(), threshold, stats); return 0;
+  case VT_FLOAT: accumulateStatistics(span.values<float>(), threshold, stats); return 0;
+  case VT_DOUBLE: accumulateStatistics(span.values<double>(), threshold, stats); return 0;
+  case VT_STRING: break;
+  }
+  return 1;
+}
+
+void appendMinMaxSeries(const std::vector<TableColumn::MinMaxBucket>& buckets, std::vector<double>& times, std::vector<double>& values)
+{
+  for (const auto& bucket : buckets)
+  {
+    if (bucket.count == 0)
+      continue;
+    const bool minFirst = (bucket.minTime <= bucket.maxTime);
+    times.push_back(minFirst ? bucket.minTime : bucket.maxTime);
+    values.push_back(minFirst ? bucket.minValue : bucket.maxValue);
+    if (bucket.minTime == bucket.maxTime)
+      continue;
+    times.push_back(minFirst ? bucket.maxTime : bucket.minTime);
+    values.push_back(minFirst ? bucket.maxValue : bucket.minValue);
+  }
+}
+
+}
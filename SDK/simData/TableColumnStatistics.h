@@ -0,0 +1,115 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_TABLECOLUMNSTATISTICS_H
+#define SIMDATA_TABLECOLUMNSTATISTICS_H
+
+#include <limits>
+#include <span>
+#include "simData/DataTable.h"
+
+namespace simData
+{
+
+/**
+ * Adds the values to the statistics and updates the mean; call once per TableColumn::ValueSpan
+ * to combine spans.  The loop keeps several independent minimums, maximums and sums so that the
+ * compiler can vectorize it.  NaN values are left out of the minimum and maximum, which are
+ * infinite if every value is NaN.
+ * @param values Values to add
+ * @param threshold Values greater than this are counted in countAboveThreshold
+ * @param stats Statistics to update
+ */
+template <typename T>
+void accumulateStatistics(std::span<const T> values, double threshold, TableColumn::Statistics& stats)
+{
+  if (values.empty())
+    return;
+
+  static constexpr size_t LANES = 4;
+  // Comparisons with NaN are false, so starting from infinity keeps NaN out of the minimum and maximum
+  double minimum[LANES];
+  double maximum[LANES];
+  double sum[LANES];
+  size_t above[LANES];
+  for (size_t lane = 0; lane < LANES; ++lane)
+  {
+    minimum[lane] = (stats.count == 0) ? std::numeric_limits<double>::infinity() : stats.minimum;
+    maximum[lane] = (stats.count == 0) ? -std::numeric_limits<double>::infinity() : stats.maximum;
+    sum[lane] = 0.0;
+    above[lane] = 0;
+  }
+
+  const size_t size = values.size();
+  const size_t vectorSize = size - (size % LANES);
+  for (size_t ii = 0; ii < vectorSize; ii += LANES)
+  {
+    for (size_t lane = 0; lane < LANES; ++lane)
+    {
+      const double value = static_cast<double>(values[ii + lane]);
+      minimum[lane] = (value < minimum[lane]) ? value : minimum[lane];
+      maximum[lane] = (value > maximum[lane]) ? value : maximum[lane];
+      sum[lane] += value;
+      above[lane] += (value > threshold) ? 1 : 0;
+    }
+  }
+  for (size_t ii = vectorSize; ii < size; ++ii)
+  {
+    const double value = static_cast<double>(values[ii]);
+    minimum[0] = (value < minimum[0]) ? value : minimum[0];
+    maximum[0] = (value > maximum[0]) ? value : maximum[0];
+    sum[0] += value;
+    above[0] += (value > threshold) ? 1 : 0;
+  }
+
+  for (size_t lane = 0; lane < LANES; ++lane)
+  {
+    minimum[0] = (minimum[lane] < minimum[0]) ? minimum[lane] : minimum[0];
+    maximum[0] = (maximum[lane] > maximum[0]) ? maximum[lane] : maximum[0];
+  }
+  stats.minimum = minimum[0];
+  stats.maximum = maximum[0];
+  stats.sum += (sum[0] + sum[1]) + (sum[2] + sum[3]);
+  stats.countAboveThreshold += (above[0] + above[1]) + (above[2] + above[3]);
+  stats.count += size;
+  stats.mean = stats.sum / static_cast<double>(stats.count);
+}
+
+/**
+ * Adds the values of a span to the statistics, converting from its storage type.
+ * @return 0 on success, non-zero for string spans
+ */
+SDKDATA_EXPORT int accumulateStatistics(const TableColumn::ValueSpan& span, double threshold, TableColumn::Statistics& stats);
+
+/**
+ * Appends the smallest and largest value of each bucket as points of a series, in time order,
+ * for drawing a plot that keeps every peak of the data.  Buckets without values add no points;
+ * buckets whose smallest and largest value are the same row add one point.
+ * @param buckets Buckets from TableColumn::getMinMaxBuckets()
+ * @param times Receives the time of each point
+ * @param values Receives the value of each point
+ */
+SDKDATA_EXPORT void appendMinMaxSeries(const std::vector<TableColumn::MinMaxBucket>& buckets, std::vector<double>& times, std::vector<double>& values);
+
+}
+
+#endif /* SIMDATA_TABLECOLUMNSTATISTICS_H */
@@ -20,8 +20,10 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
 #include <cmath>
 #include <thread>
+#include <vector>
 #include "simCore/Common/SDKAssert.h"
 #include "simCore/Calc/Angle.h"
 #include "simCore/Calc/Math.h"
@@ -886,6 +888,204 @@ int testXEastGeodetic()
   return rv;
 }
 
+int testLocalFrame()
+{
+  int rv = 0;
+
+  // Hosts at the equator, typical latitudes, near the pole and at altitude; targets nearby and far away
+  const std::vector<simCore::Vec3> hosts = {
+    simCore::Vec3(0.0, 0.0, 0.0),
+    simCore::Vec3(22.0 * simCore::DEG2RAD, 45.0 * simCore::DEG2RAD, 1000.0),
+    simCore::Vec3(-33.5 * simCore::DEG2RAD, -150.25 * simCore::DEG2RAD, -50.0),
+    simCore::Vec3(89.4 * simCore::DEG2RAD, 10.0 * simCore::DEG2RAD, 35000.0)
+  };
+  const std::vector<simCore::Vec3> offsets = {
+    simCore::Vec3(0.01, 0.02, 500.0),
+    simCore::Vec3(-0.2, 0.3, -200.0),
+    simCore::Vec3(0.5, -1.5, 400000.0),
+    simCore::Vec3(0.0, 0.0, 10.0)
+  };
+
+  simCore::LocalFrame frame;
+  rv += SDK_ASSERT(frame.origin() == simCore::Vec3());
+  for (const simCore::Vec3& host : hosts)
+  {
+    frame.setOrigin(host);
+    rv += SDK_ASSERT(frame.origin() == host);
+    rv += SDK_ASSERT(simCore::areEqual(frame.sinLat(), sin(host.lat())) && simCore::areEqual(frame.cosLon(), cos(host.lon())));
+
+    simCore::CoordinateConverter cc;
+    cc.setReferenceOrigin(host);
+    simCore::Vec3 hostEcef;
+    simCore::CoordinateConverter::convertGeodeticPosToEcef(host, hostEcef);
+    rv += SDK_ASSERT(simCore::v3AreEqual(frame.originEcef(), hostEcef, 1e-6));
+
+    // Rotation matrices match CoordinateConverter's for every local level frame
+    for (simCore::LocalLevelFrame localLevelFrame : { simCore::LOCAL_LEVEL_FRAME_NED, simCore::LOCAL_LEVEL_FRAME_NWU, simCore::LOCAL_LEVEL_FRAME_ENU })
+    {
+      double expected[3][3];
+      double actual[3][3];
+      simCore::CoordinateConverter::setLocalToEarthMatrix(host.lat(), host.lon(), localLevelFrame, expected);
+      frame.localToEarthMatrix(localLevelFrame, actual);
+      for (int row = 0; row < 3; ++row)
+      {
+        for (int col = 0; col < 3; ++col)
+          rv += SDK_ASSERT(expected[row][col] == actual[row][col]);
+      }
+    }
+
+    for (const simCore::Vec3& offset : offsets)
+    {
+      const simCore::Vec3 target(host.lat() + offset.lat() * simCore::DEG2RAD, host.lon() + offset.lon() * simCore::DEG2RAD, host.alt() + offset.alt());
+
+      // Local ENU matches X-East, and converts back
+      const std::optional<simCore::Coordinate> xeast = cc.convert(simCore::Coordinate(simCore::COORD_SYS_LLA, target), simCore::COORD_SYS_XEAST);
+      rv += SDK_ASSERT(xeast.has_value());
+      simCore::Vec3 enu;
+      frame.geodeticToEnu(target, enu);
+      rv += SDK_ASSERT(simCore::v3AreEqual(enu, xeast->position(), 1e-6));
+      simCore::Vec3 lla;
+      frame.enuToGeodetic(enu, lla);
+      rv += SDK_ASSERT(simCore::v3AreEqual(lla, target, 1e-6));
+
+      // Calculations from the frame match those from the host position for both WGS 84 models
+      for (simCore::EarthModelCalculations model : { simCore::WGS_84, simCore::TANGENT_PLANE_WGS_84 })
+      {
+        const simCore::Vec3 ori(0.3, -0.1, 0.05);
+        double expectedAz = 0.0;
+        double expectedEl = 0.0;
+        double expectedCmp = 0.0;
+        double az = 0.0;
+        double el = 0.0;
+        double cmp = 0.0;
+        simCore::calculateRelAzEl(host, ori, target, &expectedAz, &expectedEl, &expectedCmp, model, nullptr);
+        simCore::calculateRelAzEl(frame, ori, target, &az, &el, &cmp);
+        rv += SDK_ASSERT(simCore::areEqual(az, expectedAz, 1e-9) && simCore::areEqual(el, expectedEl, 1e-9) && simCore::areEqual(cmp, expectedCmp, 1e-9));
+
+        simCore::calculateAbsAzEl(host, target, &expectedAz, &expectedEl, &expectedCmp, model, nullptr);
+        simCore::calculateAbsAzEl(frame, target, &az, &el, &cmp);
+        rv += SDK_ASSERT(simCore::areEqual(az, expectedAz, 1e-9) && simCore::areEqual(el, expectedEl, 1e-9) && simCore::areEqual(cmp, expectedCmp, 1e-9));
+
+        rv += SDK_ASSERT(simCore::areEqual(simCore::calculateSlant(frame, target), simCore::calculateSlant(host, target, model, nullptr), 1e-6));
+
+        double expectedDown = 0.0;
+        double expectedCross = 0.0;
+        double expectedDownValue = 0.0;
+        double down = 0.0;
+        double cross = 0.0;
+        double downValue = 0.0;
+        simCore::calculateDRCRDownValue(host, ori.yaw(), target, model, nullptr, &expectedDown, &expectedCross, &expectedDownValue);
+        simCore::calculateDRCRDownValue(frame, ori.yaw(), target, &down, &cross, &downValue);
+        rv += SDK_ASSERT(simCore::areEqual(down, expectedDown, 1e-6) && simCore::areEqual(cross, expectedCross, 1e-6) && simCore::areEqual(downValue, expectedDownValue, 1e-6));
+      }
+    }
+  }
+
+  // Constructing at an origin is the same as moving to it
+  const simCore::LocalFrame atHost(hosts[1]);
+  frame.setOrigin(hosts[1]);
+  rv += SDK_ASSERT(atHost.originEcef() == frame.originEcef());
+
+  return rv;
+}
+
+int testRelativeGeometry()
+{
+  int rv = 0;
+
+  const simCore::Vec3 fromLla(0.4, -1.2, 3000.0);
+  const simCore::Vec3 fromOri(0.7, 0.1, -0.05);
+  const simCore::Vec3 fromVel(120.0, -40.0, 5.0);
+
+  // Entities around the 'from' entity, out to a few hundred km, and one at its position
+  const size_t count = 10007;
+  std::vector<double> lat(count);
+  std::vector<double> lon(count);
+  std::vector<double> alt(count);
+  std::vector<double> velX(count);
+  std::vector<double> velY(count);
+  std::vector<double> velZ(count);
+  std::vector<double> yaw(count);
+  std::vector<double> pitch(count);
+  for (size_t ii = 0; ii < count; ++ii)
+  {
+    lat[ii] = fromLla.lat() + 0.03 * sin(0.37 * ii);
+    lon[ii] = fromLla.lon() + 0.03 * cos(0.91 * ii);
+    alt[ii] = 10000.0 * (ii % 13);
+    velX[ii] = 200.0 * sin(0.11 * ii);
+    velY[ii] = 150.0 * cos(0.23 * ii);
+    velZ[ii] = -3.0 * (ii % 5);
+    yaw[ii] = 0.013 * ii;
+    pitch[ii] = 0.4 * sin(0.05 * ii);
+  }
+  lat[17] = fromLla.lat();
+  lon[17] = fromLla.lon();
+  alt[17] = fromLla.alt();
+
+  simCore::CoordinateConverter cc;
+  cc.setReferenceOrigin(simCore::Vec3(0.41, -1.19, 0.0));
+
+  std::vector<double> slant(count);
+  std::vector<double> ground(count);
+  std::vector<double> relAz(count);
+  std::vector<double> relEl(count);
+  std::vector<double> relCmp(count);
+  std::vector<double> closing(count);
+  std::vector<double> aspect(count);
+  const simCore::RelativeGeometryTargets targets = { { lat, lon, alt }, { velX, velY, velZ }, yaw, pitch };
+  const simCore::RelativeGeometryResults results = { slant, ground, relAz, relEl, relCmp, closing, aspect };
+
+  for (simCore::EarthModelCalculations model : { simCore::WGS_84, simCore::TANGENT_PLANE_WGS_84, simCore::FLAT_EARTH })
+  {
+    for (unsigned int numThreads : { 1u, 4u })
+    {
+      std::fill(slant.begin(), slant.end(), -1.0);
+      std::fill(aspect.begin(), aspect.end(), -1.0);
+      rv += SDK_ASSERT(simCore::calculateRelativeGeometry(fromLla, fromOri, fromVel, targets, model, &cc, results, numThreads) == 0);
+
+      // Every value matches the single entity functions
+      int mismatches = 0;
+      for (size_t ii = 0; ii < count; ++ii)
+      {
+        const simCore::Vec3 toLla(lat[ii], lon[ii], alt[ii]);
+        const simCore::Vec3 toVel(velX[ii], velY[ii], velZ[ii]);
+        double az = 0.0;
+        double el = 0.0;
+        double cmp = 0.0;
+        simCore::calculateRelAzEl(fromLla, fromOri, toLla, &az, &el, &cmp, model, &cc);
+        if (!simCore::areEqual(slant[ii], simCore::calculateSlant(fromLla, toLla, model, &cc), 1e-6) ||
+          !simCore::areEqual(ground[ii], simCore::calculateGroundDist(fromLla, toLla, model, &cc), 1e-6) ||
+          !simCore::areEqual(relAz[ii], az, 1e-9) || !simCore::areEqual(relEl[ii], el, 1e-9) || !simCore::areEqual(relCmp[ii], cmp, 1e-9) ||
+          !simCore::areEqual(closing[ii], simCore::calculateClosingVelocity(fromLla, toLla, model, &cc, fromVel, toVel), 1e-6) ||
+          !simCore::areEqual(aspect[ii], simCore::calculateAspectAngle(fromLla, toLla, simCore::Vec3(yaw[ii], pitch[ii], 0.0)), 1e-9))
+          ++mismatches;
+      }
+      rv += SDK_ASSERT(mismatches == 0);
+    }
+  }
+
+  // Only the requested quantities are filled, and unused inputs may be empty
+  std::fill(slant.begin(), slant.end(), -1.0);
+  std::fill(relAz.begin(), relAz.end(), -1.0);
+  simCore::RelativeGeometryResults slantOnly;
+  slantOnly.slant = slant;
+  rv += SDK_ASSERT(simCore::calculateRelativeGeometry(fromLla, fromOri, fromVel, { { lat, lon, alt }, {}, {}, {} }, simCore::WGS_84, nullptr, slantOnly) == 0);
+  rv += SDK_ASSERT(simCore::areEqual(slant[0], simCore::calculateSlant(fromLla, simCore::Vec3(lat[0], lon[0], alt[0]), simCore::WGS_84, nullptr), 1e-6));
+  rv += SDK_ASSERT(relAz[0] == -1.0);
+
+  // Mismatched sizes, missing inputs, unsupported models and flat earth without a reference origin fail
+  std::vector<double> shortArray(count - 1);
+  simCore::RelativeGeometryResults shortResults;
+  shortResults.slant = shortArray;
+  rv += SDK_ASSERT(simCore::calculateRelativeGeometry(fromLla, fromOri, fromVel, targets, simCore::WGS_84, nullptr, shortResults) != 0);
+  rv += SDK_ASSERT(simCore::calculateRelativeGeometry(fromLla, fromOri, fromVel, { { lat, lon, alt }, {}, yaw, pitch }, simCore::WGS_84, nullptr, results) != 0);
+  rv += SDK_ASSERT(simCore::calculateRelativeGeometry(fromLla, fromOri, fromVel, { { lat, lon, alt }, { velX, velY, velZ }, {}, {} }, simCore::WGS_84, nullptr, results) != 0);
+  rv += SDK_ASSERT(simCore::calculateRelativeGeometry(fromLla, fromOri, fromVel, targets, simCore::PERFECT_SPHERE, nullptr, results) != 0);
+  rv += SDK_ASSERT(simCore::calculateRelativeGeometry(fromLla, fromOri, fromVel, targets, simCore::FLAT_EARTH, nullptr, results) != 0);
+
+  return rv;
+}
+
 int testCalculateGeodeticOriFromRelOri()
 {
   int rv = 0;
@@ -2159,6 +2359,8 @@ int CalculationTest(int argc, char* argv[])
   rv += testGeodeticEcef();
   rv += testXEastEcef();
   rv += testXEastGeodetic();
+  rv += testLocalFrame();
+  rv += testRelativeGeometry();
   rv += testCalculateGeodeticOriFromRelOri();
   rv += testRotateEulerAngle();
   rv += testGetClosestPoint();
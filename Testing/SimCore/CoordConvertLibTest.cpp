@@ -20,6 +20,9 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <vector>
 #include <string>
 #include <iomanip>
@@ -32,6 +35,7 @@
 #include "simCore/Calc/Vec3.h"
 #include "simCore/Calc/Angle.h"
 #include "simCore/Calc/Math.h"
+#include "simCore/System/ParallelRanges.h"
 
 namespace
 {
@@ -1066,6 +1070,247 @@ int testScaledFlatEarth()
   return rv;
 }
 
+/// Converts the points one at a time with convert() and as a batch, at 1 and 4 threads, for every pair of systems
+int testBatchConversions()
+{
+  int rv = 0;
+  simCore::CoordinateConverter cc;
+  cc.setReferenceOriginDegrees(37.5, -76.25, 12.);
+  cc.setTangentPlaneOffsets(1500., -2500., 30. * simCore::DEG2RAD);
+
+  // Enough points for several threads and a partial last block, spread up to a few hundred km from the origin
+  const size_t numPoints = 10007;
+  std::vector<simCore::Coordinate> llaPoints;
+  std::vector<double> times;
+  for (size_t ii = 0; ii < numPoints; ++ii)
+  {
+    const double lat = (37.5 + 3. * sin(ii * 0.37)) * simCore::DEG2RAD;
+    const double lon = (-76.25 + 3. * cos(ii * 0.71)) * simCore::DEG2RAD;
+    const double alt = 50000. * sin(ii * 0.13);
+    times.push_back(ii * 1.5);
+    llaPoints.push_back(simCore::Coordinate(simCore::COORD_SYS_LLA, simCore::Vec3(lat, lon, alt), times.back()));
+  }
+
+  for (int inSys = simCore::COORD_SYS_NONE + 1; inSys < simCore::COORD_SYS_MAX; ++inSys)
+  {
+    const simCore::CoordinateSystem inSystem = static_cast<simCore::CoordinateSystem>(inSys);
+    std::vector<simCore::Coordinate> inPoints(numPoints);
+    std::vector<double> inX(numPoints);
+    std::vector<double> inY(numPoints);
+    std::vector<double> inZ(numPoints);
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+      cc.convert(llaPoints[ii], inPoints[ii], inSystem);
+      inX[ii] = inPoints[ii].x();
+      inY[ii] = inPoints[ii].y();
+      inZ[ii] = inPoints[ii].z();
+    }
+
+    for (int outSys = simCore::COORD_SYS_NONE + 1; outSys < simCore::COORD_SYS_MAX; ++outSys)
+    {
+      const simCore::CoordinateSystem outSystem = static_cast<simCore::CoordinateSystem>(outSys);
+      std::vector<double> outX(numPoints);
+      std::vector<double> outY(numPoints);
+      std::vector<double> outZ(numPoints);
+      std::vector<double> threadedX(numPoints);
+      std::vector<double> threadedY(numPoints);
+      std::vector<double> threadedZ(numPoints);
+      rv += SDK_ASSERT(cc.convertPositions(inSystem, { inX, inY, inZ }, outSystem, { outX, outY, outZ }, times) == 0);
+      rv += SDK_ASSERT(cc.convertPositions(inSystem, { inX, inY, inZ }, outSystem, { threadedX, threadedY, threadedZ }, times, 4) == 0);
+
+      int failures = 0;
+      for (size_t ii = 0; ii < numPoints; ++ii)
+      {
+        simCore::Coordinate outCoord;
+        cc.convert(inPoints[ii], outCoord, outSystem);
+        // Same arithmetic as convert(), so differences come only from the compiler's choices
+        const simCore::Vec3& pos = outCoord.position();
+        if (!simCore::areEqual(pos.x(), outX[ii], 1e-9 * std::max(1., fabs(pos.x()))) ||
+          !simCore::areEqual(pos.y(), outY[ii], 1e-9 * std::max(1., fabs(pos.y()))) ||
+          !simCore::areEqual(pos.z(), outZ[ii], 1e-9 * std::max(1., fabs(pos.z()))))
+          ++failures;
+        if (threadedX[ii] != outX[ii] || threadedY[ii] != outY[ii] || threadedZ[ii] != outZ[ii])
+          ++failures;
+      }
+      if (failures != 0)
+        std::cout << "Batch conversion " << inSys << " to " << outSys << " failed for " << failures << " points" << std::endl;
+      rv += SDK_ASSERT(failures == 0);
+    }
+  }
+
+  // Threaded conversions share one pool of workers, so conversions started from several threads at once, and from
+  // within the ranges of another threaded call, all complete with the same results
+  {
+    std::vector<double> llaX(numPoints);
+    std::vector<double> llaY(numPoints);
+    std::vector<double> llaZ(numPoints);
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+      llaX[ii] = llaPoints[ii].x();
+      llaY[ii] = llaPoints[ii].y();
+      llaZ[ii] = llaPoints[ii].z();
+    }
+    std::vector<double> expectedX(numPoints);
+    std::vector<double> expectedY(numPoints);
+    std::vector<double> expectedZ(numPoints);
+    rv += SDK_ASSERT(simCore::CoordinateConverter::convertGeodeticPosToEcef({ llaX, llaY, llaZ }, { expectedX, expectedY, expectedZ }) == 0);
+
+    const size_t numCallers = 6;
+    std::vector<std::vector<double> > callerX(numCallers, std::vector<double>(numPoints));
+    std::vector<std::vector<double> > callerY(numCallers, std::vector<double>(numPoints));
+    std::vector<std::vector<double> > callerZ(numCallers, std::vector<double>(numPoints));
+    std::atomic<int> failures = 0;
+    const auto convertCaller = [&](size_t caller)
+    {
+      if (simCore::CoordinateConverter::convertGeodeticPosToEcef({ llaX, llaY, llaZ }, { callerX[caller], callerY[caller], callerZ[caller] }, 4) != 0)
+        ++failures;
+    };
+    std::vector<std::thread> threads;
+    for (size_t caller = 0; caller < 3; ++caller)
+      threads.emplace_back(convertCaller, caller);
+    simCore::runRanges(numCallers - 3, numCallers - 3, [&convertCaller](size_t begin, size_t end)
+      {
+        for (size_t caller = begin; caller < end; ++caller)
+          convertCaller(caller + 3);
+      });
+    for (auto& thread : threads)
+      thread.join();
+    rv += SDK_ASSERT(failures == 0);
+    for (size_t caller = 0; caller < numCallers; ++caller)
+    {
+      rv += SDK_ASSERT(callerX[caller] == expectedX);
+      rv += SDK_ASSERT(callerY[caller] == expectedY);
+      rv += SDK_ASSERT(callerZ[caller] == expectedZ);
+    }
+  }
+
+  // One ECI time for all points
+  std::vector<double> ecefX = { 6378137., 0., 4000000. };
+  std::vector<double> ecefY = { 0., 6378137., -3000000. };
+  std::vector<double> ecefZ = { 0., 0., 3500000. };
+  std::vector<double> eciX(3);
+  std::vector<double> eciY(3);
+  std::vector<double> eciZ(3);
+  rv += SDK_ASSERT(simCore::CoordinateConverter().convertPositions(simCore::COORD_SYS_ECEF, { ecefX, ecefY, ecefZ }, simCore::COORD_SYS_ECI, { eciX, eciY, eciZ }, 600.) == 0);
+  for (size_t ii = 0; ii < ecefX.size(); ++ii)
+  {
+    simCore::Coordinate eciCoord;
+    simCore::CoordinateConverter::convertEcefToEci(simCore::Coordinate(simCore::COORD_SYS_ECEF, simCore::Vec3(ecefX[ii], ecefY[ii], ecefZ[ii]), 600.), eciCoord);
+    rv += SDK_ASSERT(almostEqual(eciCoord.position(), simCore::Vec3(eciX[ii], eciY[ii], eciZ[ii]), 1e-6, 1e-6));
+  }
+
+  // Static geodetic conversions match the single position conversions
+  std::vector<double> lat(3);
+  std::vector<double> lon(3);
+  std::vector<double> alt(3);
+  rv += SDK_ASSERT(simCore::CoordinateConverter::convertEcefToGeodeticPos({ ecefX, ecefY, ecefZ }, { lat, lon, alt }) == 0);
+  rv += SDK_ASSERT(simCore::CoordinateConverter::convertGeodeticPosToEcef({ lat, lon, alt }, { eciX, eciY, eciZ }, 2) == 0);
+  for (size_t ii = 0; ii < ecefX.size(); ++ii)
+  {
+    simCore::Vec3 llaPos;
+    simCore::CoordinateConverter::convertEcefToGeodeticPos(simCore::Vec3(ecefX[ii], ecefY[ii], ecefZ[ii]), llaPos);
+    rv += SDK_ASSERT(llaPos == simCore::Vec3(lat[ii], lon[ii], alt[ii]));
+    rv += SDK_ASSERT(almostEqual(simCore::Vec3(ecefX[ii], ecefY[ii], ecefZ[ii]), simCore::Vec3(eciX[ii], eciY[ii], eciZ[ii]), 1e-6, 1e-6));
+  }
+
+  // Mismatched sizes, missing ECI times and a missing reference origin fail
+  std::vector<double> shortArray(2);
+  rv += SDK_ASSERT(cc.convertPositions(simCore::COORD_SYS_ECEF, { ecefX, ecefY, shortArray }, simCore::COORD_SYS_LLA, { lat, lon, alt }) != 0);
+  rv += SDK_ASSERT(cc.convertPositions(simCore::COORD_SYS_ECEF, { ecefX, ecefY, ecefZ }, simCore::COORD_SYS_ECI, { lat, lon, alt }, shortArray) != 0);
+  rv += SDK_ASSERT(simCore::CoordinateConverter::convertGeodeticPosToEcef({ lat, lon, alt }, { eciX, shortArray, eciZ }) != 0);
+  rv += SDK_ASSERT(simCore::CoordinateConverter().convertPositions(simCore::COORD_SYS_ECEF, { ecefX, ecefY, ecefZ }, simCore::COORD_SYS_ENU, { lat, lon, alt }) != 0);
+  rv += SDK_ASSERT(simCore::CoordinateConverter().convertPositions(simCore::COORD_SYS_ECEF, { ecefX, ecefY, ecefZ }, simCore::COORD_SYS_LLA, { lat, lon, alt }) == 0);
+
+  std::cout << std::endl << "Batch conversion test case: ";
+  std::cout << (rv==0 ? "PASSED" : "FAILED") << std::endl;
+  return rv;
+}
+
+int testEcefToGeodeticAlgorithms()
+{
+  int rv = 0;
+  const simCore::CoordinateConverter::EcefToGeodeticAlgorithm algorithms[] = {
+    simCore::CoordinateConverter::ECEF_TO_GEODETIC_VERMEILLE,
+    simCore::CoordinateConverter::ECEF_TO_GEODETIC_OLSON
+  };
+  // Worst allowed distance (m) from Fukushima's method, in the order of algorithms
+  const double tolerances[] = { 1e-3, 1e-3 };
+
+  // Surface, high altitude, deep interior, poles, center of the earth, and points on the Z axis
+  std::vector<simCore::Vec3> llaPositions;
+  for (int latDeg = -90; latDeg <= 90; latDeg += 15)
+  {
+    for (double alt : { -6300000.0, -100000.0, 0.0, 10000.0, 400000.0, 36000000.0 })
+      llaPositions.push_back(simCore::Vec3(latDeg * simCore::DEG2RAD, (latDeg * 7 - 150) * simCore::DEG2RAD, alt));
+  }
+  std::vector<simCore::Vec3> ecefPositions = { simCore::Vec3(), simCore::Vec3(0.0, 0.0, 1000.0), simCore::Vec3(0.0, 0.0, -7000000.0), simCore::Vec3(5000.0, -3000.0, 2000.0) };
+  for (const simCore::Vec3& lla : llaPositions)
+  {
+    simCore::Vec3 ecef;
+    simCore::CoordinateConverter::convertGeodeticPosToEcef(lla, ecef);
+    ecefPositions.push_back(ecef);
+  }
+
+  for (const simCore::Vec3& ecef : ecefPositions)
+  {
+    simCore::Vec3 reference;
+    rv += SDK_ASSERT(simCore::CoordinateConverter::convertEcefToGeodeticPos(ecef, reference, simCore::CoordinateConverter::ECEF_TO_GEODETIC_FUKUSHIMA) == 0);
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+      simCore::Vec3 lla;
+      rv += SDK_ASSERT(simCore::CoordinateConverter::convertEcefToGeodeticPos(ecef, lla, algorithms[ii]) == 0);
+      // Compare in ECEF, which is well behaved at the poles and the center
+      simCore::Vec3 roundTrip;
+      simCore::CoordinateConverter::convertGeodeticPosToEcef(lla, roundTrip);
+      simCore::Vec3 referenceEcef;
+      simCore::CoordinateConverter::convertGeodeticPosToEcef(reference, referenceEcef);
+      rv += SDK_ASSERT(simCore::v3Distance(roundTrip, referenceEcef) < tolerances[ii]);
+      rv += SDK_ASSERT(fabs(lla.alt() - reference.alt()) < tolerances[ii]);
+    }
+  }
+
+  // Batch conversions take the algorithm per call, and match the single position conversions
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> z;
+  for (const simCore::Vec3& ecef : ecefPositions)
+  {
+    x.push_back(ecef.x());
+    y.push_back(ecef.y());
+    z.push_back(ecef.z());
+  }
+  std::vector<double> lat(x.size());
+  std::vector<double> lon(x.size());
+  std::vector<double> alt(x.size());
+  for (simCore::CoordinateConverter::EcefToGeodeticAlgorithm algorithm : { simCore::CoordinateConverter::ECEF_TO_GEODETIC_FUKUSHIMA,
+    simCore::CoordinateConverter::ECEF_TO_GEODETIC_VERMEILLE, simCore::CoordinateConverter::ECEF_TO_GEODETIC_OLSON })
+  {
+    rv += SDK_ASSERT(simCore::CoordinateConverter::convertEcefToGeodeticPos({ x, y, z }, { lat, lon, alt }, 1, algorithm) == 0);
+    for (size_t ii = 0; ii < ecefPositions.size(); ++ii)
+    {
+      simCore::Vec3 lla;
+      simCore::CoordinateConverter::convertEcefToGeodeticPos(ecefPositions[ii], lla, algorithm);
+      rv += SDK_ASSERT(simCore::areEqual(lat[ii], lla.lat(), 1e-12) && simCore::areEqual(lon[ii], lla.lon(), 1e-12) && simCore::areEqual(alt[ii], lla.alt(), 1e-6));
+    }
+  }
+
+  // Conversions that do not name an algorithm use Olson's method
+  rv += SDK_ASSERT(simCore::CoordinateConverter::convertEcefToGeodeticPos({ x, y, z }, { lat, lon, alt }) == 0);
+  for (size_t ii = 0; ii < ecefPositions.size(); ++ii)
+  {
+    simCore::Vec3 lla;
+    simCore::CoordinateConverter::convertEcefToGeodeticPos(ecefPositions[ii], lla);
+    simCore::Vec3 olson;
+    simCore::CoordinateConverter::convertEcefToGeodeticPos(ecefPositions[ii], olson, simCore::CoordinateConverter::ECEF_TO_GEODETIC_OLSON);
+    rv += SDK_ASSERT(lla == olson);
+    rv += SDK_ASSERT(lat[ii] == olson.lat() && lon[ii] == olson.lon() && alt[ii] == olson.alt());
+  }
+
+  std::cout << std::endl << "ECEF to geodetic algorithms test case: ";
+  std::cout << (rv==0 ? "PASSED" : "FAILED") << std::endl;
+  return rv;
+}
+
 int testStringFunctions()
 {
   int rv = 0;
@@ -1185,6 +1430,8 @@ int CoordConvertLibTest(int _argc_, char *_argv_[])
   rv += testGtpRotation();
   rv += testScaledFlatEarthPole();
   rv += testScaledFlatEarth();
+  rv += testBatchConversions();
+  rv += testEcefToGeodeticAlgorithms();
   rv += testStringFunctions();
   return rv;
 }
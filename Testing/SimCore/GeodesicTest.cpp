@@ -0,0 +1,240 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Calculations.h"
+#include "simCore/Calc/Geodesic.h"
+#include "simCore/Calc/Math.h"
+
+namespace {
+
+/// Random point pairs from a few meters to antipodal
+struct PointPairs
+{
+  std::vector<double> lat1;
+  std::vector<double> lon1;
+  std::vector<double> lat2;
+  std::vector<double> lon2;
+};
+
+PointPairs makePairs(size_t count)
+{
+  PointPairs pairs;
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+  for (size_t ii = 0; ii < count; ++ii)
+  {
+    const double lat = asin(uniform(gen));
+    const double lon = M_PI * uniform(gen);
+    // Offsets spread evenly in magnitude from 1e-5 to 1 rad
+    const double scale = pow(10.0, -2.5 + 2.5 * uniform(gen));
+    pairs.lat1.push_back(lat);
+    pairs.lon1.push_back(lon);
+    pairs.lat2.push_back(std::clamp(lat + scale * uniform(gen), -M_PI_2, M_PI_2));
+    pairs.lon2.push_back(simCore::angFixPI(lon + M_PI * scale * uniform(gen)));
+  }
+  return pairs;
+}
+
+int testKarney()
+{
+  int rv = 0;
+  const simCore::Geodesic geodesic;
+
+  // Reference values from GeographicLib; Wellington to Salamanca is nearly antipodal
+  double azFwd = 0.;
+  double azBck = 0.;
+  double dist = geodesic.inverse(-41.32 * simCore::DEG2RAD, 174.81 * simCore::DEG2RAD, 40.96 * simCore::DEG2RAD, -5.50 * simCore::DEG2RAD, &azFwd, &azBck);
+  rv += SDK_ASSERT(simCore::areEqual(dist, 19959679.267353, 1e-5));
+  rv += SDK_ASSERT(simCore::areEqual(azFwd * simCore::RAD2DEG, 161.067669986159, 1e-9));
+  rv += SDK_ASSERT(simCore::areEqual(azBck * simCore::RAD2DEG, 18.825195123248 - 180., 1e-9));
+  // JFK to LHR
+  dist = geodesic.inverse(40.6 * simCore::DEG2RAD, -73.8 * simCore::DEG2RAD, 51.6 * simCore::DEG2RAD, -0.5 * simCore::DEG2RAD, &azFwd, &azBck);
+  rv += SDK_ASSERT(simCore::areEqual(dist, 5551759.400319, 1e-5));
+  rv += SDK_ASSERT(simCore::areEqual(azFwd * simCore::RAD2DEG, 51.198882845579, 1e-9));
+  rv += SDK_ASSERT(simCore::areEqual(azBck * simCore::RAD2DEG, 107.821776735514 - 180., 1e-9));
+
+  // Special cases: coincident points, along a meridian, along the equator, and pole to pole
+  rv += SDK_ASSERT(geodesic.inverse(0.3, 0.4, 0.3, 0.4) == 0.);
+  dist = geodesic.inverse(0., 0.2, 0.5, 0.2, &azFwd, &azBck);
+  rv += SDK_ASSERT(simCore::areEqual(azFwd, 0.) && simCore::areAnglesEqual(azBck, M_PI));
+  rv += SDK_ASSERT(simCore::areEqual(dist, simCore::sodanoInverse(0., 0.2, 0., 0.5, 0.2), 1e-7 * dist));
+  dist = geodesic.inverse(0., 0., 0., 0.1, &azFwd, &azBck);
+  rv += SDK_ASSERT(simCore::areEqual(dist, simCore::WGS_A * 0.1, 1e-6));
+  rv += SDK_ASSERT(simCore::areEqual(azFwd, M_PI_2) && simCore::areEqual(azBck, -M_PI_2));
+  dist = geodesic.inverse(M_PI_2, 0., -M_PI_2, 0.);
+  rv += SDK_ASSERT(simCore::areEqual(dist, 20003931.4586, 1e-3));
+
+  // Direct solution returns to the second point of each inverse solution
+  const PointPairs pairs = makePairs(2000);
+  double worst = 0.;
+  for (size_t ii = 0; ii < pairs.lat1.size(); ++ii)
+  {
+    dist = geodesic.inverse(pairs.lat1[ii], pairs.lon1[ii], pairs.lat2[ii], pairs.lon2[ii], &azFwd, &azBck);
+    double lat2 = 0.;
+    double lon2 = 0.;
+    double directBck = 0.;
+    geodesic.direct(pairs.lat1[ii], pairs.lon1[ii], azFwd, dist, &lat2, &lon2, &directBck);
+    worst = std::max(worst, geodesic.inverse(lat2, lon2, pairs.lat2[ii], pairs.lon2[ii]));
+    // Azimuth at a pole depends only on the longitude convention
+    if (fabs(pairs.lat2[ii]) != M_PI_2)
+      rv += SDK_ASSERT(simCore::areAnglesEqual(directBck, azBck, 1e-8));
+  }
+  rv += SDK_ASSERT(worst < 1e-7);
+
+  // Sodano errors are about the cube of the flattening times the distance
+  for (size_t ii = 0; ii < pairs.lat1.size(); ++ii)
+  {
+    dist = geodesic.inverse(pairs.lat1[ii], pairs.lon1[ii], pairs.lat2[ii], pairs.lon2[ii]);
+    if (dist < 10000000.)
+      rv += SDK_ASSERT(simCore::areEqual(dist, geodesic.inverse(pairs.lat1[ii], pairs.lon1[ii], pairs.lat2[ii], pairs.lon2[ii], nullptr, nullptr, simCore::Geodesic::GEODESIC_SODANO), 1e-7 * dist + 1e-6));
+  }
+
+  return rv;
+}
+
+int testSodano()
+{
+  int rv = 0;
+  // Sodano solutions match the free functions exactly, including at altitude
+  const double alt = 1000.;
+  const simCore::Geodesic geodesic(simCore::WGS_A + alt);
+  const PointPairs pairs = makePairs(500);
+  for (size_t ii = 0; ii < pairs.lat1.size(); ++ii)
+  {
+    double azFwd = 0.;
+    double azBck = 0.;
+    double expectFwd = 0.;
+    double expectBck = 0.;
+    const double dist = geodesic.inverse(pairs.lat1[ii], pairs.lon1[ii], pairs.lat2[ii], pairs.lon2[ii], &azFwd, &azBck, simCore::Geodesic::GEODESIC_SODANO);
+    rv += SDK_ASSERT(dist == simCore::sodanoInverse(pairs.lat1[ii], pairs.lon1[ii], alt, pairs.lat2[ii], pairs.lon2[ii], &expectFwd, &expectBck));
+    rv += SDK_ASSERT(azFwd == expectFwd && azBck == expectBck);
+
+    double lat2 = 0.;
+    double lon2 = 0.;
+    double expectLat = 0.;
+    double expectLon = 0.;
+    geodesic.direct(pairs.lat1[ii], pairs.lon1[ii], pairs.lon2[ii], dist, &lat2, &lon2, &azBck, simCore::Geodesic::GEODESIC_SODANO);
+    simCore::sodanoDirect(pairs.lat1[ii], pairs.lon1[ii], alt, dist, pairs.lon2[ii], &expectLat, &expectLon, &expectBck);
+    rv += SDK_ASSERT(lat2 == expectLat && lon2 == expectLon && azBck == expectBck);
+  }
+  return rv;
+}
+
+int testBatch()
+{
+  int rv = 0;
+  const simCore::Geodesic geodesic;
+  const PointPairs pairs = makePairs(5000);
+  const size_t count = pairs.lat1.size();
+
+  for (auto method : { simCore::Geodesic::GEODESIC_KARNEY, simCore::Geodesic::GEODESIC_SODANO })
+  {
+    // Pairs, then one first point to many, on 1 and 3 threads
+    for (unsigned int numThreads : { 1u, 3u })
+    {
+      std::vector<double> dist(count);
+      std::vector<double> azFwd(count);
+      std::vector<double> azBck(count);
+      rv += SDK_ASSERT(geodesic.inverse({ pairs.lat1, pairs.lon1, pairs.lat2, pairs.lon2 }, { dist, azFwd, azBck }, method, numThreads) == 0);
+      size_t mismatches = 0;
+      for (size_t ii = 0; ii < count; ++ii)
+      {
+        double expectFwd = 0.;
+        double expectBck = 0.;
+        const double expect = geodesic.inverse(pairs.lat1[ii], pairs.lon1[ii], pairs.lat2[ii], pairs.lon2[ii], &expectFwd, &expectBck, method);
+        if (dist[ii] != expect || azFwd[ii] != expectFwd || azBck[ii] != expectBck)
+          ++mismatches;
+      }
+      rv += SDK_ASSERT(mismatches == 0);
+
+      // Only the distances
+      const std::span<const double> oneLat(pairs.lat1.data(), 1);
+      const std::span<const double> oneLon(pairs.lon1.data(), 1);
+      rv += SDK_ASSERT(geodesic.inverse({ oneLat, oneLon, pairs.lat2, pairs.lon2 }, { dist, {}, {} }, method, numThreads) == 0);
+      mismatches = 0;
+      for (size_t ii = 0; ii < count; ++ii)
+      {
+        if (dist[ii] != geodesic.inverse(pairs.lat1[0], pairs.lon1[0], pairs.lat2[ii], pairs.lon2[ii], nullptr, nullptr, method))
+          ++mismatches;
+      }
+      rv += SDK_ASSERT(mismatches == 0);
+
+      // Range ring: one first point and length, an azimuth per point
+      std::vector<double> lat2(count);
+      std::vector<double> lon2(count);
+      const double ringRadius = 250000.;
+      rv += SDK_ASSERT(geodesic.direct({ oneLat, oneLon, pairs.lon2, std::span<const double>(&ringRadius, 1) }, { lat2, lon2, azBck }, method, numThreads) == 0);
+      mismatches = 0;
+      for (size_t ii = 0; ii < count; ++ii)
+      {
+        double expectLat = 0.;
+        double expectLon = 0.;
+        double expectBck = 0.;
+        geodesic.direct(pairs.lat1[0], pairs.lon1[0], pairs.lon2[ii], ringRadius, &expectLat, &expectLon, &expectBck, method);
+        if (lat2[ii] != expectLat || lon2[ii] != expectLon || azBck[ii] != expectBck)
+          ++mismatches;
+      }
+      rv += SDK_ASSERT(mismatches == 0);
+
+      // Points along one line
+      const double azimuth = 0.7;
+      rv += SDK_ASSERT(geodesic.direct({ oneLat, oneLon, std::span<const double>(&azimuth, 1), dist }, { lat2, lon2, {} }, method, numThreads) == 0);
+      mismatches = 0;
+      for (size_t ii = 0; ii < count; ++ii)
+      {
+        double expectLat = 0.;
+        double expectLon = 0.;
+        geodesic.direct(pairs.lat1[0], pairs.lon1[0], azimuth, dist[ii], &expectLat, &expectLon, nullptr, method);
+        if (lat2[ii] != expectLat || lon2[ii] != expectLon)
+          ++mismatches;
+      }
+      rv += SDK_ASSERT(mismatches == 0);
+    }
+  }
+
+  // Size mismatches are errors; empty inputs are not
+  std::vector<double> shortArray(count - 1);
+  rv += SDK_ASSERT(geodesic.inverse({ pairs.lat1, pairs.lon1, pairs.lat2, shortArray }, { shortArray, {}, {} }) != 0);
+  rv += SDK_ASSERT(geodesic.inverse({ pairs.lat1, pairs.lon1, pairs.lat2, pairs.lon2 }, { shortArray, {}, {} }) != 0);
+  rv += SDK_ASSERT(geodesic.direct({ pairs.lat1, pairs.lon1, pairs.lon2, shortArray }, { {}, {}, {} }) != 0);
+  rv += SDK_ASSERT(geodesic.inverse({}, {}) == 0);
+  return rv;
+}
+
+}
+
+int GeodesicTest(int argc, char* argv[])
+{
+  int rv = 0;
+  rv += SDK_ASSERT(testKarney() == 0);
+  rv += SDK_ASSERT(testSodano() == 0);
+  rv += SDK_ASSERT(testBatch() == 0);
+
+  std::cout << "GeodesicTest: " << (rv == 0 ? "PASSED" : "FAILED") << "\n";
+  return rv;
+}
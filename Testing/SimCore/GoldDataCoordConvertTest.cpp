@@ -41,10 +41,12 @@
 // Point of Contact: Coordinate Systems Analysis Team
 // phone (314) 676-9124, DSN 846-9124
 // coordsys@nga.mil
+#include "simCore/Calc/Angle.h"
 #include "simCore/Calc/CoordinateConverter.h"
 #include "simCore/Calc/Math.h"
 #include "simCore/String/UtfUtils.h"
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <cstdlib>
@@ -57,6 +59,8 @@ using namespace std;
 static const std::string STR_FMT_WHITE_SPACE = " \n\r\t";
 static const double CU_DEG2RAD  = 0.017453292519943295;
 
+namespace {
+
 //===========================================================================
 bool getStrippedLine(istream& is,
                             std::string& str)
@@ -153,6 +157,57 @@ int compareVec(vector<Coordinate> &inVec,
   return rv ? 1 : 0;
 }
 
+//===========================================================================
+// Converts the points as a batch, on 1 and 4 threads, and compares to the
+// single point conversions in scalarVec
+int compareBatch(const CoordinateConverter &coordConvertor,
+                 const vector<Coordinate> &inVec,
+                 const vector<Coordinate> &scalarVec,
+                 CoordinateSystem outSystem)
+{
+  const size_t count = inVec.size();
+  vector<double> inX(count), inY(count), inZ(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    inX[i] = inVec[i].x();
+    inY[i] = inVec[i].y();
+    inZ[i] = inVec[i].z();
+  }
+
+  int rv = 0;
+  for (unsigned int numThreads = 1; numThreads <= 4; numThreads += 3)
+  {
+    vector<double> outX(count), outY(count), outZ(count);
+    if (coordConvertor.convertPositions(inVec.front().coordinateSystem(), { inX, inY, inZ }, outSystem, { outX, outY, outZ }, 0.0, numThreads) != 0)
+    {
+      cout << "Batch conversion failed" << endl;
+      return 1;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      // Batch uses the same arithmetic as the single point conversions
+      const Vec3& pos = scalarVec[i].position();
+      if (!areEqual(pos[0], outX[i], 1e-9 * std::max(1.0, fabs(pos[0]))) ||
+          !areEqual(pos[1], outY[i], 1e-9 * std::max(1.0, fabs(pos[1]))) ||
+          !areEqual(pos[2], outZ[i], 1e-9 * std::max(1.0, fabs(pos[2]))))
+      {
+        cout << "Batch conversion failed, line #: " << i+1 << " threads: " << numThreads << endl;
+        cout << " " << pos[0] << " " << pos[1] << " " << pos[2] << " vs "
+             << outX[i] << " " << outY[i] << " " << outZ[i] << endl;
+        rv = 1;
+      }
+    }
+  }
+
+  if (rv == 0)
+  {
+    cout << "Batch Test Passed\n" << endl;
+  }
+
+  return rv;
+}
+
 //===========================================================================
 int loadGoldData(const std::string &fname, vector<Coordinate> &inVec,
   CoordinateSystem cs)
@@ -191,8 +246,74 @@ int loadGoldData(const std::string &fname, vector<Coordinate> &inVec,
 }
 
 //===========================================================================
-int GoldDataCoordConvertTest(int _argc_, char *_argv_[])
+// Horizontal and vertical distance (m) between two geodetic positions
+void geodeticError(const Vec3 &expected, const Vec3 &actual, double &horizontal, double &vertical)
+{
+  const double radius = WGS_A + expected.alt();
+  const double north = (actual.lat() - expected.lat()) * radius;
+  const double east = angFixPI(actual.lon() - expected.lon()) * radius * cos(expected.lat());
+  horizontal = sqrt(north * north + east * east);
+  vertical = fabs(actual.alt() - expected.alt());
+}
+
+//===========================================================================
+// Accuracy of each ECEF to geodetic algorithm against the gold data; see
+// DataStorePerformanceTest --benchmark for their throughput
+int testEcefToGeodeticAlgorithms(const vector<Coordinate> &geocentric,
+                                 const vector<Coordinate> &geodetic)
 {
+  struct Algorithm
+  {
+    CoordinateConverter::EcefToGeodeticAlgorithm algorithm;
+    const char* name;
+    // worst allowed distance (m) from the gold data
+    double tolerance;
+  };
+  static const Algorithm algorithms[] = {
+    { CoordinateConverter::ECEF_TO_GEODETIC_FUKUSHIMA, "Fukushima", 1e-3 },
+    { CoordinateConverter::ECEF_TO_GEODETIC_VERMEILLE, "Vermeille", 1e-5 },
+    { CoordinateConverter::ECEF_TO_GEODETIC_OLSON, "Olson", 1e-5 }
+  };
+
+  cout << endl;
+  cout << "====================================================" << endl;
+  cout << "ECEF to geodetic algorithms using NGA Gold Data v6.2" << endl;
+  cout << "====================================================" << endl;
+  cout.precision(4);
+
+  int rv = 0;
+  for (const Algorithm &alg : algorithms)
+  {
+    double goldHorizontal = 0.0;
+    double goldVertical = 0.0;
+    for (size_t i = 0; i < geocentric.size(); ++i)
+    {
+      Vec3 lla;
+      CoordinateConverter::convertEcefToGeodeticPos(geocentric[i].position(), lla, alg.algorithm);
+      double horizontal;
+      double vertical;
+      geodeticError(geodetic[i].position(), lla, horizontal, vertical);
+      goldHorizontal = std::max(goldHorizontal, horizontal);
+      goldVertical = std::max(goldVertical, vertical);
+    }
+
+    cout << alg.name << ": horizontal " << goldHorizontal << " m, vertical " << goldVertical << " m" << endl;
+    if (goldHorizontal > alg.tolerance || goldVertical > alg.tolerance)
+    {
+      cout << "ERROR: " << alg.name << " exceeds " << alg.tolerance << " m" << endl;
+      rv = 1;
+    }
+  }
+  return rv;
+}
+
+}
+
+//===========================================================================
+// Optional argument is the directory holding the gold data files
+int GoldDataCoordConvertTest(int argc, char *argv[])
+{
+  const std::string dataDir = (argc > 1) ? std::string(argv[1]) + "/" : "";
   static const char *const inFiles[COORD_SYS_MAX-1] = {
     "out1.dat",
     "out2.dat",
@@ -207,7 +328,7 @@ int GoldDataCoordConvertTest(int _argc_, char *_argv_[])
   vector<Coordinate> inData[COORD_SYS_MAX-1];
   for (unsigned sys = COORD_SYS_NONE+1; sys < COORD_SYS_MAX; ++sys)
   {
-    int rv = loadGoldData(inFiles[sys-1], inData[sys-1], CoordinateSystem(sys));
+    int rv = loadGoldData(dataDir + inFiles[sys-1], inData[sys-1], CoordinateSystem(sys));
     if (rv != 0)
     {
       cout << "Failed to load file " << inFiles[sys-1] << endl;
@@ -236,20 +357,14 @@ int GoldDataCoordConvertTest(int _argc_, char *_argv_[])
         ++iter)
     {
       Coordinate outCoord;
-      coordConvertor.convert(*iter, &outCoord, CoordinateSystem(sys2));
+      coordConvertor.convert(*iter, outCoord, CoordinateSystem(sys2));
       outputVec.push_back(outCoord);
     }
     rv += compareVec(inData[sys2-1], outputVec, sys2 == COORD_SYS_LLA, .9);
+    rv += compareBatch(coordConvertor, inData[sys1-1], outputVec, CoordinateSystem(sys2));
   }
 
-  return rv;
-}
+  rv += testEcefToGeodeticAlgorithms(inData[COORD_SYS_ECEF-1], inData[COORD_SYS_LLA-1]);
 
-int main(int argc, char **argv)
-{
-  int rv = GoldDataCoordConvertTest(argc, argv);
-  if (rv)
-    cerr << "Test failed" << std::endl;
   return rv;
 }
-
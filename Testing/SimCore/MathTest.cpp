@@ -271,6 +271,49 @@ int runQuaternionMultiplicationTest()
   return rv;
 }
 
+//===========================================================================
+int runQuaternionSlerpTest()
+{
+  int rv = 0;
+  std::cerr << "Testing simCore::dQSlerp ============================================== \n";
+
+  // Yaw of 10 and 70 degrees; halfway is a yaw of 40 degrees
+  double q1[4];
+  double q2[4];
+  double expected[4];
+  double output[4];
+  simCore::d3EulertoQ(simCore::Vec3(10.0 * simCore::DEG2RAD, 0.0, 0.0), q1);
+  simCore::d3EulertoQ(simCore::Vec3(70.0 * simCore::DEG2RAD, 0.0, 0.0), q2);
+  simCore::d3EulertoQ(simCore::Vec3(40.0 * simCore::DEG2RAD, 0.0, 0.0), expected);
+  simCore::dQSlerp(q1, q2, 0.5, output);
+  rv += SDK_ASSERT(vectorsAreEqual(output, expected, 4));
+
+  // Ends are exact
+  simCore::dQSlerp(q1, q2, 0.0, output);
+  rv += SDK_ASSERT(vectorsAreEqual(output, q1, 4));
+  simCore::dQSlerp(q1, q2, 1.0, output);
+  rv += SDK_ASSERT(vectorsAreEqual(output, q2, 4));
+
+  // Takes the short way across north: 350 to 30 degrees passes through 10 degrees
+  simCore::d3EulertoQ(simCore::Vec3(350.0 * simCore::DEG2RAD, 0.0, 0.0), q1);
+  simCore::d3EulertoQ(simCore::Vec3(30.0 * simCore::DEG2RAD, 0.0, 0.0), q2);
+  simCore::dQSlerp(q1, q2, 0.5, output);
+  simCore::Vec3 ea;
+  simCore::d3QtoEuler(output, ea);
+  rv += SDK_ASSERT(simCore::areAnglesEqual(ea.yaw(), 10.0 * simCore::DEG2RAD));
+
+  // Nearly equal rotations stay unit length
+  simCore::d3EulertoQ(simCore::Vec3(1.0, 0.2, 0.3), q1);
+  simCore::d3EulertoQ(simCore::Vec3(1.0 + 1e-9, 0.2, 0.3), q2);
+  simCore::dQSlerp(q1, q2, 0.25, output);
+  rv += SDK_ASSERT(simCore::areEqual(output[0] * output[0] + output[1] * output[1] + output[2] * output[2] + output[3] * output[3], 1.0));
+  rv += SDK_ASSERT(vectorsAreEqual(output, q1, 4));
+
+  std::cerr << ((rv == 0) ? "PASS" : "FAILED") << '\n';
+
+  return rv;
+}
+
 //===========================================================================
 static int d3QtoEulerTest(const double input[4], const double expected[3])
 {
@@ -935,6 +978,7 @@ int MathTest(int argc, char* argv[])
   rv += testIsFinite();
   rv += runQuaternionNormalTest();
   rv += runQuaternionMultiplicationTest();
+  rv += runQuaternionSlerpTest();
   rv += runD3QtoFromEulerTest();
   rv += runD3MMmult();
   rv += runD3MMTmult();
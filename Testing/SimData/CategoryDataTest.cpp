@@ -20,9 +20,11 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
 #include "simCore/Common/SDKAssert.h"
 #include "simData/CategoryData/CategoryNameManager.h"
 #include "simData/CategoryData/CategoryFilter.h"
+#include "simData/CategoryData/CompiledCategoryFilter.h"
 #include "simData/MemoryDataStore.h"
 #include "simUtil/DataStoreTestHelper.h"
 #include "simQt/RegExpImpl.h"
@@ -1691,6 +1693,94 @@ int testRemoveValue()
   return rv;
 }
 
+int testMatchAll()
+{
+  int rv = 0;
+  simUtil::DataStoreTestHelper dsHelper;
+  simData::DataStore& ds = *dsHelper.dataStore();
+  simQt::RegExpFilterFactoryImpl reFactory;
+
+  const std::vector<std::string> colors = { "red", "green", "blue", "darkred" };
+  const std::vector<std::string> shapes = { "round", "square", "" };
+  std::vector<uint64_t> ids;
+  for (size_t ii = 0; ii < 60; ++ii)
+  {
+    const uint64_t id = dsHelper.addPlatform();
+    ids.push_back(id);
+    // Every seventh platform has no category data, every fifth has no shape
+    if (ii % 7 == 0)
+      continue;
+    dsHelper.addCategoryData(id, "color", colors[ii % colors.size()], 0.0);
+    if (ii % 5 != 0)
+      dsHelper.addCategoryData(id, "shape", shapes[ii % shapes.size()], 0.0);
+  }
+  // An ID without an entity never has category data
+  ids.push_back(ids.back() + 1000);
+  ds.update(1.0);
+
+  const std::vector<std::string> rules = {
+    " ",
+    "color(0)~red(1)",
+    "color(1)~red(1)",
+    "color(1)~Unlisted Value(1)~blue(0)",
+    "color(1)~red(1)`shape(1)~round(1)",
+    "shape(1)~No Value(1)",
+    "shape(1)~No Value(0)~Unlisted Value(1)",
+    "shape(1)~No Value(1)~round(0)~Unlisted Value(1)",
+    "color(1)^red",
+    "color(1)^^red`shape(1)~square(1)",
+    "shape(1)^^$",
+    "color(1)^blue~blue(0)",
+  };
+
+  simData::CategoryFilter filter(&ds);
+  for (const auto& rule : rules)
+  {
+    rv += SDK_ASSERT(filter.deserialize(rule, reFactory));
+    std::vector<uint8_t> matches;
+    filter.matchAll(ds, ids, matches);
+    rv += SDK_ASSERT(matches.size() == ids.size());
+
+    const simData::CompiledCategoryFilter compiled(filter);
+    std::vector<uint8_t> compiledMatches;
+    compiled.matchAll(ds, ids, compiledMatches);
+    rv += SDK_ASSERT(compiledMatches == matches);
+
+    for (size_t ii = 0; ii < ids.size() && ii < matches.size(); ++ii)
+    {
+      const bool match = filter.match(ds, ids[ii]);
+      rv += SDK_ASSERT((matches[ii] != 0) == match);
+      simData::CategoryFilter::CurrentCategoryValues values;
+      simData::CategoryFilter::getCurrentCategoryValues(ds, ids[ii], values);
+      rv += SDK_ASSERT(compiled.matchData(values) == match);
+    }
+  }
+
+  // Empty filter and a simple count
+  rv += SDK_ASSERT(filter.deserialize(" ", reFactory));
+  rv += SDK_ASSERT(simData::CompiledCategoryFilter(filter).matchesAll());
+  rv += SDK_ASSERT(filter.deserialize("color(1)~red(1)", reFactory));
+  rv += SDK_ASSERT(!simData::CompiledCategoryFilter(filter).matchesAll());
+  std::vector<uint8_t> matches;
+  filter.matchAll(ds, ids, matches);
+  // Platforms 4, 8, 12, ... 56 minus those with no category data (28, 56)
+  rv += SDK_ASSERT(std::count(matches.begin(), matches.end(), 1) == 12);
+
+  // Values added after compiling are tested against the regular expression
+  rv += SDK_ASSERT(filter.deserialize("color(1)^red", reFactory));
+  const simData::CompiledCategoryFilter compiled(filter);
+  dsHelper.addCategoryData(ids[1], "color", "orangered", 2.0);
+  dsHelper.addCategoryData(ids[2], "color", "purple", 2.0);
+  ds.update(2.0);
+  compiled.matchAll(ds, ids, matches);
+  rv += SDK_ASSERT(matches[1] == 1);
+  rv += SDK_ASSERT(matches[2] == 0);
+  for (size_t ii = 0; ii < ids.size(); ++ii)
+    rv += SDK_ASSERT((matches[ii] != 0) == filter.match(ds, ids[ii]));
+
+  return rv;
+}
+
 int testCategoryNameManagerStrings()
 {
   int rv = 0;
@@ -1738,6 +1828,7 @@ int CategoryDataTest(int argc, char *argv[])
   rv += testRemoveName();
   rv += testRemoveValue();
   rv += testCategoryNameManagerStrings();
+  rv += testMatchAll();
 
   return rv;
 }
@@ -0,0 +1,1043 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <span>
+#include <sstream>
+
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Calculations.h"
+#include "simCore/Calc/CoordinateConverter.h"
+#include "simCore/Calc/Geodesic.h"
+#include "simCore/Calc/MathConstants.h"
+#include "simCore/Calc/MultiFrameCoordinate.h"
+#include "simCore/Common/Version.h"
+#include "simCore/String/Format.h"
+#include "simCore/String/Tokenizer.h"
+#include "simData/CategoryData/CategoryFilter.h"
+#include "simData/CategoryData/CategoryNameManager.h"
+#include "simData/DataTable.h"
+#include "simData/LinearInterpolator.h"
+#include "simData/MemoryDataStore.h"
+#include "simData/PlatformInterpolationBatch.h"
+#include "simUtil/DataStoreTestHelper.h"
+#include "DataStoreBenchmark.h"
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+/// Seconds elapsed since start
+double elapsedSince(Clock::time_point start)
+{
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/// Fills in a platform update on a slow circle near the surface, different for each platform
+void makeUpdate(double time, size_t index, simData::PlatformUpdate& update)
+{
+  const double radius = 6378137.0 + 1000.0 * static_cast<double>(index % 100);
+  const double angle = 0.0001 * time + 0.01 * static_cast<double>(index);
+  update.set_time(time);
+  update.set_x(radius * cos(angle));
+  update.set_y(radius * sin(angle));
+  update.set_z(1000.0 * static_cast<double>(index % 10));
+  update.set_psi(angle);
+  update.set_theta(0.01);
+  update.set_phi(0.0);
+  update.set_vx(-radius * 0.0001 * sin(angle));
+  update.set_vy(radius * 0.0001 * cos(angle));
+  update.set_vz(0.0);
+}
+
+/// Fills in the coordinate of makeUpdate(), converting it to LLA up front
+void makeCoordinate(double time, size_t index, simCore::MultiFrameCoordinate& coordinate)
+{
+  simData::PlatformUpdate update;
+  makeUpdate(time, index, update);
+  coordinate.setCoordinate(simCore::Coordinate(simCore::COORD_SYS_ECEF, simCore::Vec3(update.x(), update.y(), update.z()),
+    simCore::Vec3(update.psi(), update.theta(), update.phi()), simCore::Vec3(update.vx(), update.vy(), update.vz())));
+  coordinate.llaCoordinate();
+}
+
+/// A data store with platforms, optionally loaded with the scenario's updates
+class Scenario
+{
+public:
+  Scenario(const BenchmarkOptions& options, size_t numPlatforms, bool loadUpdates)
+    : helper_(&ds_)
+  {
+    ds_.setInterpolator(&interpolator_);
+    ds_.enableInterpolation(true);
+    ds_.setColumnarPlatformStorage(options.columnarStorage);
+    for (size_t ii = 0; ii < numPlatforms; ++ii)
+      ids_.push_back(helper_.addPlatform());
+    if (!loadUpdates)
+      return;
+
+    std::vector<simData::PlatformUpdate> updates(options.seconds * options.dataPerSecond);
+    for (size_t ii = 0; ii < ids_.size(); ++ii)
+    {
+      for (size_t jj = 0; jj < updates.size(); ++jj)
+        makeUpdate(static_cast<double>(jj) / options.dataPerSecond, ii, updates[jj]);
+      ds_.addPlatformUpdates(ids_[ii], updates);
+    }
+  }
+
+  simData::MemoryDataStore& ds() { return ds_; }
+  simUtil::DataStoreTestHelper& helper() { return helper_; }
+  const std::vector<simData::ObjectId>& ids() const { return ids_; }
+
+  /// Total platform updates held by the slices
+  size_t numItems() const
+  {
+    size_t rv = 0;
+    for (auto id : ids_)
+    {
+      const simData::PlatformUpdateSlice* slice = ds_.platformUpdateSlice(id);
+      if (slice != nullptr)
+        rv += slice->numItems();
+    }
+    return rv;
+  }
+
+private:
+  simData::MemoryDataStore ds_;
+  simData::LinearInterpolator interpolator_;
+  simUtil::DataStoreTestHelper helper_;
+  std::vector<simData::ObjectId> ids_;
+};
+
+/// Adds a double column table with the given number of rows to the data store
+simData::DataTable* makeTable(simData::DataStore& ds, simData::ObjectId owner, size_t numColumns, size_t numRows, std::vector<simData::TableColumnId>& columnIds)
+{
+  simData::DataTable* table = nullptr;
+  if (ds.dataTableManager().addDataTable(owner, "Benchmark", &table).isError() || table == nullptr)
+    return nullptr;
+
+  columnIds.clear();
+  for (size_t col = 0; col < numColumns; ++col)
+  {
+    simData::TableColumn* column = nullptr;
+    table->addColumn("Column " + std::to_string(col), simData::VT_DOUBLE, 0, &column);
+    if (column != nullptr)
+      columnIds.push_back(column->columnId());
+  }
+
+  simData::TableRow row;
+  for (size_t ii = 0; ii < numRows; ++ii)
+  {
+    row.clear();
+    row.setTime(static_cast<double>(ii));
+    for (size_t col = 0; col < columnIds.size(); ++col)
+      row.setValue(columnIds[col], static_cast<double>(ii + col));
+    table->addRow(row);
+  }
+  return table;
+}
+
+/// Counts the rows and sums the first column
+class SumRows : public simData::DataTable::RowVisitor
+{
+public:
+  explicit SumRows(simData::TableColumnId columnId)
+    : columnId_(columnId)
+  {
+  }
+
+  VisitReturn visit(const simData::TableRow& row) override
+  {
+    double value = 0.0;
+    if (row.value(columnId_, value).isSuccess())
+      sum_ += value;
+    ++rows_;
+    return VISIT_CONTINUE;
+  }
+
+  size_t rows() const { return rows_; }
+  double sum() const { return sum_; }
+
+private:
+  simData::TableColumnId columnId_;
+  size_t rows_ = 0;
+  double sum_ = 0.0;
+};
+
+/// Returns a copy of the samples in ascending order
+std::vector<double> sorted(const std::vector<double>& samples)
+{
+  std::vector<double> rv = samples;
+  std::sort(rv.begin(), rv.end());
+  return rv;
+}
+
+/// Escapes a string for a JSON value
+std::string jsonString(const std::string& value)
+{
+  std::string rv = "\"";
+  for (char c : value)
+  {
+    if (c == '"' || c == '\\')
+      rv += '\\';
+    rv += c;
+  }
+  return rv + "\"";
+}
+
+/// Current UTC time in ISO 8601
+std::string timestamp()
+{
+  const std::time_t now = std::time(nullptr);
+  std::tm utc{};
+#ifdef WIN32
+  gmtime_s(&utc, &now);
+#else
+  gmtime_r(&now, &utc);
+#endif
+  char buffer[32];
+  std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+  return buffer;
+}
+
+/// Parses a positive integer argument, returning 0 on failure
+size_t parseCount(const std::string& value)
+{
+  const int rv = atoi(value.c_str());
+  return rv > 0 ? static_cast<size_t>(rv) : 0;
+}
+
+}
+
+//----------------------------------------------------------------------------
+
+int BenchmarkOptions::setSize(const std::string& name)
+{
+  if (simCore::caseCompare(name, "small") == 0)
+  {
+    entityCounts = { 10, 100 };
+    seconds = 60;
+    dataPerSecond = 10;
+    tableRows = 50000;
+    points = 100000;
+    repeat = 3;
+  }
+  else if (simCore::caseCompare(name, "medium") == 0)
+  {
+    entityCounts = { 10, 100, 1000 };
+    seconds = 150;
+    dataPerSecond = 10;
+    tableRows = 100000;
+    points = 1000000;
+    repeat = 3;
+  }
+  else if (simCore::caseCompare(name, "large") == 0)
+  {
+    entityCounts = { 100, 1000, 10000 };
+    seconds = 300;
+    dataPerSecond = 20;
+    tableRows = 1000000;
+    points = 5000000;
+    repeat = 5;
+  }
+  else
+    return 1;
+
+  size = simCore::lowerCase(name);
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+
+double BenchmarkResult::meanMs() const
+{
+  if (samples.empty())
+    return 0.0;
+  return 1000.0 * std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+double BenchmarkResult::medianMs() const
+{
+  if (samples.empty())
+    return 0.0;
+  const std::vector<double> values = sorted(samples);
+  const size_t mid = values.size() / 2;
+  if (values.size() % 2 == 0)
+    return 500.0 * (values[mid - 1] + values[mid]);
+  return 1000.0 * values[mid];
+}
+
+double BenchmarkResult::p95Ms() const
+{
+  if (samples.empty())
+    return 0.0;
+  const std::vector<double> values = sorted(samples);
+  const size_t index = static_cast<size_t>(std::ceil(0.95 * values.size())) - 1;
+  return 1000.0 * values[std::min(index, values.size() - 1)];
+}
+
+double BenchmarkResult::minMs() const
+{
+  if (samples.empty())
+    return 0.0;
+  return 1000.0 * *std::min_element(samples.begin(), samples.end());
+}
+
+double BenchmarkResult::maxMs() const
+{
+  if (samples.empty())
+    return 0.0;
+  return 1000.0 * *std::max_element(samples.begin(), samples.end());
+}
+
+double BenchmarkResult::throughput() const
+{
+  const double median = medianMs();
+  if (median <= 0.0)
+    return 0.0;
+  return 1000.0 * static_cast<double>(itemsPerSample) / median;
+}
+
+//----------------------------------------------------------------------------
+
+BenchmarkSuite::BenchmarkSuite(const BenchmarkOptions& options)
+  : options_(options)
+{
+}
+
+const std::vector<BenchmarkResult>& BenchmarkSuite::results() const
+{
+  return results_;
+}
+
+int BenchmarkSuite::run()
+{
+  results_.clear();
+
+  int rv = 0;
+  rv += runCase_("ingest_transaction", [this](const std::string& name) { return ingestTransactions_(name); });
+  rv += runCase_("ingest_batch", [this](const std::string& name) { return ingestBatch_(name); });
+  rv += runCase_("ingest_queue", [this](const std::string& name) { return ingestQueue_(name); });
+  rv += runCase_("update_forward", [this](const std::string& name) { return playback_(name, 1); });
+  rv += runCase_("scrub_backward", [this](const std::string& name) { return playback_(name, -1); });
+  rv += runCase_("scrub_random", [this](const std::string& name) { return scrubRandom_(name); });
+  rv += runCase_("flush_all", [this](const std::string& name) { return flush_(name, false); });
+  rv += runCase_("flush_range", [this](const std::string& name) { return flush_(name, true); });
+  rv += runCase_("data_limiting", [this](const std::string& name) { return dataLimiting_(name); });
+  rv += runCase_("category_filter", [this](const std::string& name) { return categoryFilter_(name, false); });
+  rv += runCase_("category_filter_all", [this](const std::string& name) { return categoryFilter_(name, true); });
+  rv += runCase_("interpolate_scalar", [this](const std::string& name) { return interpolate_(name, false); });
+  rv += runCase_("interpolate_batch", [this](const std::string& name) { return interpolate_(name, true); });
+  rv += runCase_("table_append", [this](const std::string& name) { return tableAppend_(name); });
+  rv += runCase_("table_iterate", [this](const std::string& name) { return tableIterate_(name); });
+  rv += runCase_("ecef_to_geodetic_fukushima", [this](const std::string& name) { return ecefToGeodetic_(name, simCore::CoordinateConverter::ECEF_TO_GEODETIC_FUKUSHIMA); });
+  rv += runCase_("ecef_to_geodetic_vermeille", [this](const std::string& name) { return ecefToGeodetic_(name, simCore::CoordinateConverter::ECEF_TO_GEODETIC_VERMEILLE); });
+  rv += runCase_("ecef_to_geodetic_olson", [this](const std::string& name) { return ecefToGeodetic_(name, simCore::CoordinateConverter::ECEF_TO_GEODETIC_OLSON); });
+  rv += runCase_("geodesic_inverse_scalar", [this](const std::string& name) { return geodesic_(name, false, false, simCore::Geodesic::GEODESIC_SODANO); });
+  rv += runCase_("geodesic_inverse_sodano", [this](const std::string& name) { return geodesic_(name, false, true, simCore::Geodesic::GEODESIC_SODANO); });
+  rv += runCase_("geodesic_inverse_karney", [this](const std::string& name) { return geodesic_(name, false, true, simCore::Geodesic::GEODESIC_KARNEY); });
+  rv += runCase_("geodesic_direct_scalar", [this](const std::string& name) { return geodesic_(name, true, false, simCore::Geodesic::GEODESIC_SODANO); });
+  rv += runCase_("geodesic_direct_sodano", [this](const std::string& name) { return geodesic_(name, true, true, simCore::Geodesic::GEODESIC_SODANO); });
+  rv += runCase_("geodesic_direct_karney", [this](const std::string& name) { return geodesic_(name, true, true, simCore::Geodesic::GEODESIC_KARNEY); });
+  return rv;
+}
+
+int BenchmarkSuite::runCase_(const std::string& name, const std::function<int(const std::string&)>& body)
+{
+  if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos)
+    return 0;
+
+  std::cout << "Running " << name << std::endl;
+  const int rv = body(name);
+  if (rv != 0)
+    std::cerr << "Benchmark " << name << " failed its sanity check" << std::endl;
+  return rv;
+}
+
+int BenchmarkSuite::ingestTransactions_(const std::string& name)
+{
+  int rv = 0;
+  const size_t numTimes = options_.seconds * options_.dataPerSecond;
+  for (size_t numPlatforms : options_.entityCounts)
+  {
+    BenchmarkResult result{ name, numPlatforms, numPlatforms * numTimes, "records" };
+    for (size_t run = 0; run < options_.repeat; ++run)
+    {
+      Scenario scenario(options_, numPlatforms, false);
+      simData::PlatformUpdate update;
+      const Clock::time_point start = Clock::now();
+      for (size_t time = 0; time < numTimes; ++time)
+      {
+        for (size_t ii = 0; ii < numPlatforms; ++ii)
+        {
+          simData::DataStore::Transaction t;
+          simData::PlatformUpdate* newUpdate = scenario.ds().addPlatformUpdate(scenario.ids()[ii], &t);
+          makeUpdate(static_cast<double>(time) / options_.dataPerSecond, ii, update);
+          *newUpdate = update;
+          t.commit();
+        }
+      }
+      result.samples.push_back(elapsedSince(start));
+      if (scenario.numItems() != result.itemsPerSample)
+        rv = 1;
+    }
+    results_.push_back(result);
+  }
+  return rv;
+}
+
+int BenchmarkSuite::ingestBatch_(const std::string& name)
+{
+  int rv = 0;
+  const size_t numTimes = options_.seconds * options_.dataPerSecond;
+  for (size_t numPlatforms : options_.entityCounts)
+  {
+    BenchmarkResult result{ name, numPlatforms, numPlatforms * numTimes, "records" };
+    std::vector<simData::PlatformUpdate> updates(numTimes);
+    for (size_t run = 0; run < options_.repeat; ++run)
+    {
+      Scenario scenario(options_, numPlatforms, false);
+      const Clock::time_point start = Clock::now();
+      for (size_t ii = 0; ii < numPlatforms; ++ii)
+      {
+        for (size_t jj = 0; jj < numTimes; ++jj)
+          makeUpdate(static_cast<double>(jj) / options_.dataPerSecond, ii, updates[jj]);
+        scenario.ds().addPlatformUpdates(scenario.ids()[ii], updates);
+      }
+      result.samples.push_back(elapsedSince(start));
+      if (scenario.numItems() != result.itemsPerSample)
+        rv = 1;
+    }
+    results_.push_back(result);
+  }
+  return rv;
+}
+
+int BenchmarkSuite::ingestQueue_(const std::string& name)
+{
+  int rv = 0;
+  const size_t numTimes = options_.seconds * options_.dataPerSecond;
+  for (size_t numPlatforms : options_.entityCounts)
+  {
+    BenchmarkResult result{ name, numPlatforms, numPlatforms * numTimes, "records" };
+    for (size_t run = 0; run < options_.repeat; ++run)
+    {
+      Scenario scenario(options_, numPlatforms, false);
+      simData::PlatformUpdate update;
+      const Clock::time_point start = Clock::now();
+      for (size_t time = 0; time < numTimes; ++time)
+      {
+        for (size_t ii = 0; ii < numPlatforms; ++ii)
+        {
+          makeUpdate(static_cast<double>(time) / options_.dataPerSecond, ii, update);
+          // A single producer drains the queue itself when it fills
+          while (scenario.ds().ingestPlatformUpdate(scenario.ids()[ii], update) != 0)
+            scenario.ds().drainIngestQueues();
+        }
+      }
+      scenario.ds().drainIngestQueues();
+      result.samples.push_back(elapsedSince(start));
+      if (scenario.numItems() != result.itemsPerSample)
+        rv = 1;
+    }
+    results_.push_back(result);
+  }
+  return rv;
+}
+
+int BenchmarkSuite::playback_(const std::string& name, int direction)
+{
+  const size_t numFrames = options_.seconds * options_.frameRate;
+  for (size_t numPlatforms : options_.entityCounts)
+  {
+    BenchmarkResult result{ name, numPlatforms, 1, "updates" };
+    Scenario scenario(options_, numPlatforms, true);
+    for (size_t run = 0; run < options_.repeat; ++run)
+    {
+      for (size_t ii = 0; ii < numFrames; ++ii)
+      {
+        const size_t frame = (direction > 0) ? ii : (numFrames - 1 - ii);
+        // Add the 0.0001 so we never get an exact hit
+        const double time = 0.0001 + static_cast<double>(frame) / options_.frameRate;
+        const Clock::time_point start = Clock::now();
+        scenario.ds().update(time);
+        result.samples.push_back(elapsedSince(start));
+      }
+    }
+    results_.push_back(result);
+  }
+  return 0;
+}
+
+int BenchmarkSuite::scrubRandom_(const std::string& name)
+{
+  const size_t numJumps = options_.seconds * options_.frameRate;
+  for (size_t numPlatforms : options_.entityCounts)
+  {
+    BenchmarkResult result{ name, numPlatforms, 1, "updates" };
+    Scenario scenario(options_, numPlatforms, true);
+    // Fixed seed so every release scrubs to the same times
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<double> times(0.0, static_cast<double>(options_.seconds));
+    for (size_t run = 0; run < options_.repeat; ++run)
+    {
+      for (size_t ii = 0; ii < numJumps; ++ii)
+      {
+        const double time = times(generator);
+        const Clock::time_point start = Clock::now();
+        scenario.ds().update(time);
+        result.samples.push_back(elapsedSince(start));
+      }
+    }
+    results_.push_back(result);
+  }
+  return 0;
+}
+
+int BenchmarkSuite::flush_(const std::string& name, bool range)
+{
+  int rv = 0;
+  const size_t numTimes = options_.seconds * options_.dataPerSecond;
+  // The range flush removes the first half of the data
+  const size_t removedTimes = range ? numTimes / 2 : numTimes;
+  const double endTime = static_cast<double>(removedTimes) / options_.dataPerSecond;
+  for (size_t numPlatforms : options_.entityCounts)
+  {
+    BenchmarkResult result{ name, numPlatforms, numPlatforms * removedTimes, "records" };
+    for (size_t run = 0; run < options_.repeat; ++run)
+    {
+      Scenario scenario(options_, numPlatforms, true);
+      scenario.ds().update(static_cast<double>(options_.seconds));
+      const Clock::time_point start = Clock::now();
+      if (range)
+        scenario.ds().flush(0, simData::DataStore::FLUSH_RECURSIVE, simData::DataStore::FLUSH_UPDATES, 0.0, endTime);
+      else
+        scenario.ds().flush(0, simData::DataStore::FLUSH_RECURSIVE, simData::DataStore::FLUSH_ALL);
+      result.samples.push_back(elapsedSince(start));
+      if (scenario.numItems() != numPlatforms * (numTimes - removedTimes))
+        rv = 1;
+    }
+    results_.push_back(result);
+  }
+  return rv;
+}
+
+int BenchmarkSuite::dataLimiting_(const std::string& name)
+{
+  int rv = 0;
+  const size_t numTimes = options_.seconds * options_.dataPerSecond;
+  // Keep a quarter of the data so that most of the run is spent limiting
+  const size_t limitPoints = std::max<size_t>(1, numTimes / 4);
+  for (size_t numPlatforms : options_.entityCounts)
+  {
+    BenchmarkResult result{ name, numPlatforms, numPlatforms * numTimes, "records" };
+    for (size_t run = 0; run < options_.repeat; ++run)
+    {
+      Scenario scenario(options_, numPlatforms, false);
+      scenario.ds().setDataLimiting(true);
+      simData::PlatformPrefs prefs;
+      prefs.mutable_commonprefs()->set_datalimitpoints(static_cast<uint32_t>(limitPoints));
+      for (auto id : scenario.ids())
+        scenario.helper().updatePlatformPrefs(prefs, id);
+
+      // Simulates live mode, where every batch of updates is followed by a display update
+      std::vector<simData::PlatformUpdate> updates(1);
+      const Clock::time_point start = Clock::now();
+      for (size_t time = 0; time < numTimes; ++time)
+      {
+        const double seconds = static_cast<double>(time) / options_.dataPerSecond;
+        for (size_t ii = 0; ii < numPlatforms; ++ii)
+        {
+          makeUpdate(seconds, ii, updates[0]);
+          scenario.ds().addPlatformUpdates(scenario.ids()[ii], updates);
+        }
+        scenario.ds().update(seconds);
+      }
+      result.samples.push_back(elapsedSince(start));
+      if (scenario.numItems() > numPlatforms * limitPoints)
+        rv = 1;
+    }
+    results_.push_back(result);
+  }
+  return rv;
+}
+
+int BenchmarkSuite::categoryFilter_(const std::string& name, bool batch)
+{
+  int rv = 0;
+  for (size_t numPlatforms : options_.entityCounts)
+  {
+    BenchmarkResult result{ name, numPlatforms, numPlatforms, "entities" };
+    Scenario scenario(options_, numPlatforms, false);
+    for (size_t ii = 0; ii < numPlatforms; ++ii)
+    {
+      for (size_t cat = 0; cat < options_.categoryNames; ++cat)
+      {
+        const size_t value = (ii / (cat + 1)) % options_.categoryValues;
+        scenario.helper().addCategoryData(scenario.ids()[ii], "Name " + std::to_string(cat), "Value " + std::to_string(value), 0.0);
+      }
+    }
+    scenario.ds().update(1.0);
+
+    // Check all but the last value of every name, so that every entity is evaluated against every name
+    const simData::CategoryNameManager& names = scenario.ds().categoryNameManager();
+    simData::CategoryFilter filter(&scenario.ds());
+    for (size_t cat = 0; cat < options_.categoryNames; ++cat)
+    {
+      const int nameInt = names.nameToInt("Name " + std::to_string(cat));
+      for (size_t value = 0; value + 1 < options_.categoryValues; ++value)
+        filter.setValue(nameInt, names.valueToInt("Value " + std::to_string(value)), true);
+    }
+
+    size_t firstMatches = 0;
+    std::vector<uint8_t> matchFlags;
+    for (size_t run = 0; run < options_.repeat; ++run)
+    {
+      size_t matches = 0;
+      const Clock::time_point start = Clock::now();
+      if (batch)
+      {
+        filter.matchAll(scenario.ds(), scenario.ids(), matchFlags);
+        matches = std::count(matchFlags.begin(), matchFlags.end(), 1);
+      }
+      else
+      {
+        for (auto id : scenario.ids())
+        {
+          if (filter.match(scenario.ds(), id))
+            ++matches;
+        }
+      }
+      result.samples.push_back(elapsedSince(start));
+      if (run == 0)
+        firstMatches = matches;
+      else if (matches != firstMatches)
+        rv = 1;
+    }
+    results_.push_back(result);
+  }
+  return rv;
+}
+
+int BenchmarkSuite::interpolate_(const std::string& name, bool batch)
+{
+  int rv = 0;
+  const size_t numFrames = options_.seconds * options_.frameRate;
+  for (size_t numPlatforms : options_.entityCounts)
+  {
+    BenchmarkResult result{ name, numPlatforms, numPlatforms, "points" };
+
+    // Bracketing points one second apart, converted once as the data store caches them
+    std::vector<simCore::MultiFrameCoordinate> prev(numPlatforms);
+    std::vector<simCore::MultiFrameCoordinate> next(numPlatforms);
+    for (size_t ii = 0; ii < numPlatforms; ++ii)
+    {
+      makeCoordinate(0.0, ii, prev[ii]);
+      makeCoordinate(1.0, ii, next[ii]);
+    }
+
+    std::vector<simData::PlatformUpdate> points(numPlatforms);
+    simData::PlatformInterpolationBatch interpolationBatch;
+    interpolationBatch.reserve(numPlatforms);
+    for (size_t run = 0; run < options_.repeat; ++run)
+    {
+      for (size_t frame = 0; frame < numFrames; ++frame)
+      {
+        const double factor = static_cast<double>(frame % options_.frameRate + 1) / (options_.frameRate + 2);
+        const double time = static_cast<double>(frame);
+        const Clock::time_point start = Clock::now();
+        for (size_t ii = 0; ii < numPlatforms; ++ii)
+        {
+          if (batch)
+            interpolationBatch.add(time, factor, prev[ii].ecefCoordinate(), prev[ii].llaCoordinate(), next[ii].ecefCoordinate(), next[ii].llaCoordinate(), &points[ii]);
+          else
+            simData::PlatformInterpolationBatch::interpolate(time, factor, prev[ii].ecefCoordinate(), prev[ii].llaCoordinate(), next[ii].ecefCoordinate(), next[ii].llaCoordinate(), points[ii]);
+        }
+        if (batch)
+          interpolationBatch.interpolate();
+        result.samples.push_back(elapsedSince(start));
+        if (numPlatforms > 0 && points.back().time() != time)
+          rv = 1;
+      }
+    }
+    results_.push_back(result);
+  }
+  return rv;
+}
+
+int BenchmarkSuite::tableAppend_(const std::string& name)
+{
+  int rv = 0;
+  BenchmarkResult result{ name, 0, options_.tableRows, "rows" };
+  for (size_t run = 0; run < options_.repeat; ++run)
+  {
+    Scenario scenario(options_, 1, false);
+    std::vector<simData::TableColumnId> columnIds;
+    const Clock::time_point start = Clock::now();
+    const simData::DataTable* table = makeTable(scenario.ds(), scenario.ids()[0], options_.tableColumns, options_.tableRows, columnIds);
+    result.samples.push_back(elapsedSince(start));
+    if (table == nullptr || columnIds.size() != options_.tableColumns)
+      rv = 1;
+  }
+  results_.push_back(result);
+  return rv;
+}
+
+int BenchmarkSuite::tableIterate_(const std::string& name)
+{
+  BenchmarkResult result{ name, 0, options_.tableRows, "rows" };
+  Scenario scenario(options_, 1, false);
+  std::vector<simData::TableColumnId> columnIds;
+  const simData::DataTable* table = makeTable(scenario.ds(), scenario.ids()[0], options_.tableColumns, options_.tableRows, columnIds);
+  if (table == nullptr || columnIds.empty())
+    return 1;
+
+  int rv = 0;
+  for (size_t run = 0; run < options_.repeat; ++run)
+  {
+    SumRows visitor(columnIds[0]);
+    const Clock::time_point start = Clock::now();
+    table->accept(-std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), visitor);
+    result.samples.push_back(elapsedSince(start));
+    if (visitor.rows() != options_.tableRows)
+      rv = 1;
+  }
+  results_.push_back(result);
+  return rv;
+}
+
+int BenchmarkSuite::ecefToGeodetic_(const std::string& name, simCore::CoordinateConverter::EcefToGeodeticAlgorithm algorithm)
+{
+  // Random points from 100 km below the surface to 50000 km above it, as in the NGA gold data
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+  std::vector<simCore::Vec3> llaPositions(options_.points);
+  std::vector<simCore::Vec3> ecefPositions(options_.points);
+  for (size_t ii = 0; ii < options_.points; ++ii)
+  {
+    llaPositions[ii].set(asin(uniform(gen)), M_PI * uniform(gen), 24950000.0 + 25050000.0 * uniform(gen));
+    simCore::CoordinateConverter::convertGeodeticPosToEcef(llaPositions[ii], ecefPositions[ii]);
+  }
+
+  int rv = 0;
+  BenchmarkResult result{ name, 0, options_.points, "points" };
+  std::vector<simCore::Vec3> converted(options_.points);
+  for (size_t run = 0; run < options_.repeat; ++run)
+  {
+    const Clock::time_point start = Clock::now();
+    for (size_t ii = 0; ii < options_.points; ++ii)
+      simCore::CoordinateConverter::convertEcefToGeodeticPos(ecefPositions[ii], converted[ii], algorithm);
+    result.samples.push_back(elapsedSince(start));
+    for (size_t ii = 0; ii < options_.points; ++ii)
+    {
+      if (fabs(converted[ii].alt() - llaPositions[ii].alt()) > 0.01)
+        rv = 1;
+    }
+  }
+  results_.push_back(result);
+  return rv;
+}
+
+int BenchmarkSuite::geodesic_(const std::string& name, bool direct, bool batch, simCore::Geodesic::Method method)
+{
+  // Random point pairs from a few meters to antipodal; direct solutions run from the first
+  // point of each pair along a random azimuth for a range ring radius
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+  const size_t count = options_.points;
+  std::vector<double> lat1(count);
+  std::vector<double> lon1(count);
+  std::vector<double> lat2(count);
+  std::vector<double> lon2(count);
+  std::vector<double> azimuth(count);
+  for (size_t ii = 0; ii < count; ++ii)
+  {
+    const double scale = pow(10.0, -2.5 + 2.5 * uniform(gen));
+    lat1[ii] = asin(uniform(gen));
+    lon1[ii] = M_PI * uniform(gen);
+    lat2[ii] = std::clamp(lat1[ii] + scale * uniform(gen), -M_PI_2, M_PI_2);
+    lon2[ii] = simCore::angFixPI(lon1[ii] + M_PI * scale * uniform(gen));
+    azimuth[ii] = M_PI * uniform(gen);
+  }
+  const double ringRadius = 250000.0;
+
+  int rv = 0;
+  const simCore::Geodesic geodesic;
+  BenchmarkResult result{ name, 0, count, "pairs" };
+  std::vector<double> dist(count);
+  std::vector<double> outLat(count);
+  std::vector<double> outLon(count);
+  for (size_t run = 0; run < options_.repeat; ++run)
+  {
+    const Clock::time_point start = Clock::now();
+    if (direct && batch)
+      rv += geodesic.direct({ lat1, lon1, azimuth, std::span<const double>(&ringRadius, 1) }, { outLat, outLon, {} }, method);
+    else if (direct)
+    {
+      for (size_t ii = 0; ii < count; ++ii)
+        simCore::sodanoDirect(lat1[ii], lon1[ii], 0.0, ringRadius, azimuth[ii], &outLat[ii], &outLon[ii]);
+    }
+    else if (batch)
+      rv += geodesic.inverse({ lat1, lon1, lat2, lon2 }, { dist, {}, {} }, method);
+    else
+    {
+      for (size_t ii = 0; ii < count; ++ii)
+        dist[ii] = simCore::sodanoInverse(lat1[ii], lon1[ii], 0.0, lat2[ii], lon2[ii]);
+    }
+    result.samples.push_back(elapsedSince(start));
+
+    for (size_t ii = 0; ii < count; ++ii)
+    {
+      if (direct ? (fabs(outLat[ii]) > M_PI_2) : !(dist[ii] >= 0.0))
+        rv = 1;
+    }
+  }
+  results_.push_back(result);
+  return (rv == 0) ? 0 : 1;
+}
+
+void BenchmarkSuite::printSummary(std::ostream& os) const
+{
+  os << std::left << std::setw(28) << "Benchmark" << std::right << std::setw(9) << "Entities"
+    << std::setw(12) << "Median ms" << std::setw(12) << "P95 ms" << std::setw(12) << "Max ms"
+    << std::setw(16) << "Throughput" << "  Unit" << std::endl;
+  for (const auto& result : results_)
+  {
+    os << std::left << std::setw(28) << result.name << std::right << std::setw(9) << result.entities
+      << std::fixed << std::setprecision(4)
+      << std::setw(12) << result.medianMs() << std::setw(12) << result.p95Ms() << std::setw(12) << result.maxMs()
+      << std::setprecision(0) << std::setw(16) << result.throughput() << "  " << result.itemUnit << "/s"
+      << std::defaultfloat << std::endl;
+  }
+}
+
+int BenchmarkSuite::writeJson(std::ostream& os) const
+{
+  os << std::setprecision(9);
+  os << "{\n";
+  os << "  \"suite\": \"DataStoreBenchmark\",\n";
+  os << "  \"sdkVersion\": " << jsonString(simCore::versionString()) << ",\n";
+  os << "  \"timestamp\": " << jsonString(timestamp()) << ",\n";
+  os << "  \"options\": {\n";
+  os << "    \"size\": " << jsonString(options_.size) << ",\n";
+  os << "    \"entityCounts\": [";
+  for (size_t ii = 0; ii < options_.entityCounts.size(); ++ii)
+    os << (ii == 0 ? "" : ", ") << options_.entityCounts[ii];
+  os << "],\n";
+  os << "    \"seconds\": " << options_.seconds << ",\n";
+  os << "    \"dataPerSecond\": " << options_.dataPerSecond << ",\n";
+  os << "    \"frameRate\": " << options_.frameRate << ",\n";
+  os << "    \"categoryNames\": " << options_.categoryNames << ",\n";
+  os << "    \"categoryValues\": " << options_.categoryValues << ",\n";
+  os << "    \"tableRows\": " << options_.tableRows << ",\n";
+  os << "    \"tableColumns\": " << options_.tableColumns << ",\n";
+  os << "    \"repeat\": " << options_.repeat << ",\n";
+  os << "    \"columnarStorage\": " << (options_.columnarStorage ? "true" : "false") << "\n";
+  os << "  },\n";
+  os << "  \"results\": [";
+  for (size_t ii = 0; ii < results_.size(); ++ii)
+  {
+    const BenchmarkResult& result = results_[ii];
+    os << (ii == 0 ? "\n" : ",\n");
+    os << "    {\"name\": " << jsonString(result.name)
+      << ", \"entities\": " << result.entities
+      << ", \"itemsPerSample\": " << result.itemsPerSample
+      << ", \"itemUnit\": " << jsonString(result.itemUnit)
+      << ", \"samples\": " << result.samples.size()
+      << ", \"meanMs\": " << result.meanMs()
+      << ", \"medianMs\": " << result.medianMs()
+      << ", \"p95Ms\": " << result.p95Ms()
+      << ", \"minMs\": " << result.minMs()
+      << ", \"maxMs\": " << result.maxMs()
+      << ", \"throughputPerSecond\": " << result.throughput() << "}";
+  }
+  os << "\n  ]\n";
+  os << "}\n";
+  return os.good() ? 0 : 1;
+}
+
+int BenchmarkSuite::writeCsv(std::ostream& os) const
+{
+  os << std::setprecision(9);
+  os << "name,entities,items_per_sample,item_unit,samples,mean_ms,median_ms,p95_ms,min_ms,max_ms,throughput_per_s,size,sdk_version\n";
+  const std::string version = simCore::versionString();
+  for (const auto& result : results_)
+  {
+    os << result.name << "," << result.entities << "," << result.itemsPerSample << "," << result.itemUnit << ","
+      << result.samples.size() << "," << result.meanMs() << "," << result.medianMs() << "," << result.p95Ms() << ","
+      << result.minMs() << "," << result.maxMs() << "," << result.throughput() << ","
+      << options_.size << "," << version << "\n";
+  }
+  return os.good() ? 0 : 1;
+}
+
+//----------------------------------------------------------------------------
+
+void benchmarkUsage(std::ostream& os)
+{
+  os << "DataStorePerformanceTest --benchmark [options]" << std::endl;
+  os << "  --size small|medium|large  preset scenario sizes, applied before the other options (default small)" << std::endl;
+  os << "  --entities N[,N...]        platform counts for the entity-scaled benchmarks" << std::endl;
+  os << "  --seconds N                seconds of data per platform" << std::endl;
+  os << "  --rate N                   platform updates per second" << std::endl;
+  os << "  --frameRate N              update calls per second of data for playback and scrubbing" << std::endl;
+  os << "  --categories N             category names per platform" << std::endl;
+  os << "  --rows N                   rows for the data table benchmarks" << std::endl;
+  os << "  --columns N                columns for the data table benchmarks" << std::endl;
+  os << "  --points N                 points or point pairs for the coordinate conversion and geodesic benchmarks" << std::endl;
+  os << "  --repeat N                 runs of each benchmark" << std::endl;
+  os << "  --columnar                 store platform updates in columns" << std::endl;
+  os << "  --filter TEXT              run only the benchmarks whose name contains TEXT" << std::endl;
+  os << "  --json FILE                write the results as JSON" << std::endl;
+  os << "  --csv FILE                 write the results as CSV" << std::endl;
+}
+
+int benchmarkMain(int argc, char* argv[])
+{
+  BenchmarkOptions options;
+  std::vector<std::string> args(argv + 1, argv + argc);
+  // Skip the --benchmark flag itself
+  if (!args.empty() && args[0] == "--benchmark")
+    args.erase(args.begin());
+
+  // The preset goes first so that the other options override it
+  for (size_t ii = 0; ii + 1 < args.size(); ++ii)
+  {
+    if (args[ii] == "--size" && options.setSize(args[ii + 1]) != 0)
+    {
+      std::cerr << "Unknown benchmark size " << args[ii + 1] << std::endl;
+      return -1;
+    }
+  }
+
+  for (size_t ii = 0; ii < args.size(); ++ii)
+  {
+    const std::string& arg = args[ii];
+    if (arg == "--columnar")
+    {
+      options.columnarStorage = true;
+      continue;
+    }
+    if (arg == "--help")
+    {
+      benchmarkUsage(std::cerr);
+      return 0;
+    }
+    if (ii + 1 >= args.size())
+    {
+      std::cerr << "Missing value for " << arg << std::endl;
+      benchmarkUsage(std::cerr);
+      return -1;
+    }
+
+    const std::string& value = args[++ii];
+    size_t count = 0;
+    if (arg == "--size")
+      continue;
+    else if (arg == "--filter")
+      options.filter = value;
+    else if (arg == "--json")
+      options.jsonFile = value;
+    else if (arg == "--csv")
+      options.csvFile = value;
+    else if (arg == "--entities")
+    {
+      std::vector<std::string> tokens;
+      simCore::stringTokenizer(tokens, value, ",");
+      options.entityCounts.clear();
+      for (const auto& token : tokens)
+      {
+        count = parseCount(token);
+        if (count == 0)
+          break;
+        options.entityCounts.push_back(count);
+      }
+    }
+    else if ((count = parseCount(value)) == 0)
+    {
+      std::cerr << "Invalid value " << value << " for " << arg << std::endl;
+      return -1;
+    }
+    else if (arg == "--seconds")
+      options.seconds = count;
+    else if (arg == "--rate")
+      options.dataPerSecond = count;
+    else if (arg == "--frameRate")
+      options.frameRate = count;
+    else if (arg == "--categories")
+      options.categoryNames = count;
+    else if (arg == "--rows")
+      options.tableRows = count;
+    else if (arg == "--columns")
+      options.tableColumns = count;
+    else if (arg == "--points")
+      options.points = count;
+    else if (arg == "--repeat")
+      options.repeat = count;
+    else
+    {
+      std::cerr << "Unknown benchmark option " << arg << std::endl;
+      benchmarkUsage(std::cerr);
+      return -1;
+    }
+
+    if (arg == "--entities" && count == 0)
+    {
+      std::cerr << "Invalid entity counts " << value << std::endl;
+      return -1;
+    }
+  }
+
+  BenchmarkSuite suite(options);
+  int rv = suite.run();
+  suite.printSummary(std::cout);
+
+  if (!options.jsonFile.empty())
+  {
+    std::ofstream json(options.jsonFile);
+    if (!json.is_open() || suite.writeJson(json) != 0)
+    {
+      std::cerr << "Failed to write " << options.jsonFile << std::endl;
+      rv = -1;
+    }
+  }
+  if (!options.csvFile.empty())
+  {
+    std::ofstream csv(options.csvFile);
+    if (!csv.is_open() || suite.writeCsv(csv) != 0)
+    {
+      std::cerr << "Failed to write " << options.csvFile << std::endl;
+      rv = -1;
+    }
+  }
+  return (rv == 0) ? 0 : -1;
+}
@@ -0,0 +1,130 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef DATASTOREBENCHMARK_H
+#define DATASTOREBENCHMARK_H
+
+#include <functional>
+#include "simCore/Calc/CoordinateConverter.h"
+#include "simCore/Calc/Geodesic.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// Scenario sizes and output files for the benchmark suite
+struct BenchmarkOptions
+{
+  std::string size = "small";  ///< Name of the preset the sizes came from
+  std::vector<size_t> entityCounts = { 10, 100 };  ///< Platform counts for the entity-scaled benchmarks
+  size_t seconds = 60;  ///< Seconds of data per platform
+  size_t dataPerSecond = 10;  ///< Platform updates per second
+  size_t frameRate = 20;  ///< Update calls per second of data for the playback benchmarks
+  size_t categoryNames = 4;  ///< Category names per platform
+  size_t categoryValues = 8;  ///< Distinct values per category name
+  size_t tableRows = 50000;  ///< Rows for the data table benchmarks
+  size_t tableColumns = 8;  ///< Columns for the data table benchmarks
+  size_t points = 100000;  ///< Points or point pairs for the coordinate conversion and geodesic benchmarks
+  size_t repeat = 3;  ///< Times each benchmark runs
+  bool columnarStorage = false;  ///< True stores platform updates in columns
+  std::string filter;  ///< Runs only the benchmarks whose name contains this text; empty runs all
+  std::string jsonFile;  ///< Results are written as JSON if not empty
+  std::string csvFile;  ///< Results are written as CSV if not empty
+
+  /** Applies a preset: "small" (seconds, for CI), "medium" or "large"; returns 0 on success */
+  int setSize(const std::string& name);
+};
+
+/// Timings for one benchmark at one scenario size
+struct BenchmarkResult
+{
+  std::string name;  ///< Benchmark name, e.g. "update_forward"
+  size_t entities = 0;  ///< Platforms in the scenario; 0 if not entity-scaled
+  size_t itemsPerSample = 0;  ///< Records, rows or calls covered by each sample
+  std::string itemUnit;  ///< What the items are, e.g. "records"
+  std::vector<double> samples;  ///< Elapsed seconds of each sample
+
+  /// Statistics of the samples, in milliseconds
+  double meanMs() const;
+  double medianMs() const;
+  double p95Ms() const;
+  double minMs() const;
+  double maxMs() const;
+  /// Items per second based on the median sample
+  double throughput() const;
+};
+
+/** Runs the data store benchmarks and reports the results */
+class BenchmarkSuite
+{
+public:
+  explicit BenchmarkSuite(const BenchmarkOptions& options);
+
+  /** Runs every benchmark that passes the filter; returns 0 if all sanity checks passed */
+  int run();
+
+  /// Results of the last run
+  const std::vector<BenchmarkResult>& results() const;
+
+  /// Writes a human readable table
+  void printSummary(std::ostream& os) const;
+  /** Writes the results as JSON; returns 0 on success */
+  int writeJson(std::ostream& os) const;
+  /** Writes the results as CSV, one row per benchmark and entity count; returns 0 on success */
+  int writeCsv(std::ostream& os) const;
+
+private:
+  /// Runs body if name passes the filter, appending its results
+  int runCase_(const std::string& name, const std::function<int(const std::string&)>& body);
+
+  int ingestTransactions_(const std::string& name);
+  int ingestBatch_(const std::string& name);
+  int ingestQueue_(const std::string& name);
+  int playback_(const std::string& name, int direction);
+  int scrubRandom_(const std::string& name);
+  int flush_(const std::string& name, bool range);
+  int dataLimiting_(const std::string& name);
+  /// Evaluates the filter with CategoryFilter::matchAll() if batch, else match() per entity
+  int categoryFilter_(const std::string& name, bool batch);
+  /// Interpolates every platform between two points with a PlatformInterpolationBatch if batch, else one at a time
+  int interpolate_(const std::string& name, bool batch);
+  int tableAppend_(const std::string& name);
+  int tableIterate_(const std::string& name);
+  /// Converts ECEF points to geodetic one at a time with the given algorithm
+  int ecefToGeodetic_(const std::string& name, simCore::CoordinateConverter::EcefToGeodeticAlgorithm algorithm);
+  /// Solves the geodesic problem of each point pair with the Geodesic array functions if batch, else with sodanoInverse() or sodanoDirect()
+  int geodesic_(const std::string& name, bool direct, bool batch, simCore::Geodesic::Method method);
+
+  BenchmarkOptions options_;
+  std::vector<BenchmarkResult> results_;
+};
+
+/**
+ * Entry point for "DataStorePerformanceTest --benchmark ...": parses the benchmark
+ * arguments after the --benchmark flag, runs the suite and writes the requested files.
+ * @return 0 on success
+ */
+int benchmarkMain(int argc, char* argv[]);
+
+/// Prints the benchmark command line arguments
+void benchmarkUsage(std::ostream& os);
+
+#endif /* DATASTOREBENCHMARK_H */
@@ -20,12 +20,15 @@
  * disclose, or release this software.
  *
  */
+#include <atomic>
 #include <fstream>
+#include <thread>
 
 #include "simCore/Common/Version.h"
 #include "simCore/String/UtfUtils.h"
 #include "simData/MemoryDataStore.h"
 #include "simData/LinearInterpolator.h"
+#include "simData/PlatformMemoryDataSlice.h"
 #include "simData/DataTable.h"
 #include "simData/CategoryData/CategoryFilter.h"
 #include "simCore/Time/Utils.h"
@@ -34,6 +37,7 @@
 #include "simCore/String/Format.h"
 #include "simCore/String/Tokenizer.h"
 #include "simUtil/DataStoreTestHelper.h"
+#include "DataStoreBenchmark.h"
 
 
 enum TableSparsity
@@ -566,7 +570,10 @@ struct TopLevelOptions
     dataLimiting(false),
     playforward(true),
     addListener(true),
-    testCD(false)
+    testCD(false),
+    columnarStorage(false),
+    updateThreads(1),
+    ingestThreads(0)
   {
   }
 
@@ -578,6 +585,9 @@ struct TopLevelOptions
   bool playforward;  // True = move time forwards, False = move time backwards
   bool addListener;  // True = count the number of callbacks
   bool testCD;       // True = testing will include testing of CategoryData
+  bool columnarStorage;  // True = platform updates use columnar storage
+  int updateThreads;  // Number of threads for DataStore::update()
+  int ingestThreads;  // Number of producer threads for the ingest test; 0 to skip the test
 };
 
 /// Initializes the DataStore and creates all the entities
@@ -635,8 +645,39 @@ int cleanUpDataStore(simData::DataStore& ds, const TopLevelOptions& options, Ent
   return rv;
 }
 
+/// Plays back the loaded data once, returning the elapsed time in seconds
+double filePlayback(simData::DataStore& ds, const TopLevelOptions& options, Entities& entities)
+{
+  double direction = 1.0;
+  int offset = 0;
+  if (!options.playforward)
+  {
+    // Change the values to cause a reverse playback
+    direction *= -1.0;
+    offset = -options.numberOfSeconds*options.frameRate;
+  }
+
+  const double startTime = simCore::systemTimeToSecsBgnYr();
+  for (int ii = 0; ii < options.numberOfSeconds*options.frameRate; ii++)
+  {
+    // Add the 0.0001 so we never get an exact hit
+    const double time = 0.0001 + direction*static_cast<double>(ii+offset)/static_cast<double>(options.frameRate);
+    ds.update(time);
+    if (options.testCD && entities.platforms->initialId() > 0)
+    {
+      simData::CategoryFilter::CurrentCategoryValues curVals;
+      simData::CategoryFilter::getCurrentCategoryValues(ds, entities.platforms->initialId(), curVals);
+      simData::CategoryFilter::CurrentCategoryValues curVals2;
+      simData::CategoryFilter::getCurrentCategoryValues(ds, entities.platforms->lastId(), curVals2);
+    }
+  }
+
+  const double endTime = simCore::systemTimeToSecsBgnYr();
+  return endTime-startTime;
+}
+
 /// Simulates file mode by loading the data than doing one playback
-double fileMode(simData::DataStore& ds, simUtil::DataStoreTestHelper& helper, TopLevelOptions& options, Entities& entities)
+double fileMode(simData::MemoryDataStore& ds, simUtil::DataStoreTestHelper& helper, TopLevelOptions& options, Entities& entities, CallbackCounters& counters)
 {
   std::cout << "In File Mode" << std::endl;
   std::cout << "Creating Data" << std::endl;
@@ -663,32 +704,18 @@ double fileMode(simData::DataStore& ds, simUtil::DataStoreTestHelper& helper, To
   // The sleep helps with looking at the data in the Intel tools
   Sleep(1000);
 
-  double direction = 1.0;
-  int offset = 0;
-  if (!options.playforward)
+  // Show the scaling with fewer threads before the playback with the configured number of threads
+  for (int threads = 1; threads < options.updateThreads; threads *= 2)
   {
-    // Change the values to cause a reverse playback
-    direction *= -1.0;
-    offset = -options.numberOfSeconds*options.frameRate;
+    ds.setUpdateThreadCount(threads);
+    const double updateTime = filePlayback(ds, options, entities);
+    std::cout << "Threads = " << threads << ", Average Update Rate (milliseconds) = " << updateTime * 1000.0 / (options.numberOfSeconds*options.frameRate) << std::endl;
   }
+  // Only the final playback is checked by cleanUpDataStore()
+  counters.time = 0;
 
-  const double startTime = simCore::systemTimeToSecsBgnYr();
-  for (int ii = 0; ii < options.numberOfSeconds*options.frameRate; ii++)
-  {
-    // Add the 0.0001 so we never get an exact hit
-    const double time = 0.0001 + direction*static_cast<double>(ii+offset)/static_cast<double>(options.frameRate);
-    ds.update(time);
-    if (options.testCD && entities.platforms->initialId() > 0)
-    {
-      simData::CategoryFilter::CurrentCategoryValues curVals;
-      simData::CategoryFilter::getCurrentCategoryValues(ds, entities.platforms->initialId(), curVals);
-      simData::CategoryFilter::CurrentCategoryValues curVals2;
-      simData::CategoryFilter::getCurrentCategoryValues(ds, entities.platforms->lastId(), curVals2);
-    }
-  }
-
-  const double endTime = simCore::systemTimeToSecsBgnYr();
-  return endTime-startTime;
+  ds.setUpdateThreadCount(options.updateThreads);
+  return filePlayback(ds, options, entities);
 }
 
 /// Simulates live mode by repeatedly adding data and doing an update
@@ -772,6 +799,108 @@ double liveMode(simData::DataStore& ds, simUtil::DataStoreTestHelper& helper, To
   return endTime-startTime;
 }
 
+/// Adds the platform updates of numberOfSeconds to a new data store, once with transactions and once with ingest threads
+void ingestMode(const TopLevelOptions& options, Entities& entities)
+{
+  const size_t numPlatforms = entities.platforms->number();
+  const size_t numTimes = static_cast<size_t>(options.numberOfSeconds) * entities.platforms->dataPerSecond();
+  const size_t numRecords = numPlatforms * numTimes;
+  if (numRecords == 0)
+    return;
+
+  for (bool useIngest : { false, true })
+  {
+    simData::MemoryDataStore ds;
+    simUtil::DataStoreTestHelper helper(&ds);
+    ds.setColumnarPlatformStorage(options.columnarStorage);
+    ds.setDataLimiting(options.dataLimiting);
+    std::vector<simData::ObjectId> ids;
+    for (size_t ii = 0; ii < numPlatforms; ++ii)
+      ids.push_back(helper.addPlatform());
+
+    const double startTime = simCore::systemTimeToSecsBgnYr();
+    if (!useIngest)
+    {
+      for (size_t time = 0; time < numTimes; ++time)
+      {
+        for (auto id : ids)
+        {
+          simData::DataStore::Transaction t;
+          simData::PlatformUpdate* update = ds.addPlatformUpdate(id, &t);
+          update->set_time(static_cast<double>(time) / entities.platforms->dataPerSecond());
+          update->set_x(static_cast<double>(time));
+          t.commit();
+        }
+      }
+      ds.update(static_cast<double>(options.numberOfSeconds));
+    }
+    else
+    {
+      // Each producer owns a subset of the platforms, like one network feed per thread
+      std::atomic<int> running(options.ingestThreads);
+      std::vector<std::thread> producers;
+      for (int thread = 0; thread < options.ingestThreads; ++thread)
+      {
+        producers.emplace_back([&ds, &ids, &running, &entities, numTimes, thread, &options]()
+        {
+          simData::PlatformUpdate update;
+          for (size_t time = 0; time < numTimes; ++time)
+          {
+            update.set_time(static_cast<double>(time) / entities.platforms->dataPerSecond());
+            update.set_x(static_cast<double>(time));
+            for (size_t ii = thread; ii < ids.size(); ii += options.ingestThreads)
+            {
+              while (ds.ingestPlatformUpdate(ids[ii], update) != 0)
+                std::this_thread::yield();
+            }
+          }
+          --running;
+        });
+      }
+
+      // The display thread keeps updating while the producers run
+      double time = 0.0;
+      while (running > 0)
+      {
+        time += 1.0 / options.frameRate;
+        ds.update(time);
+      }
+      for (auto& producer : producers)
+        producer.join();
+      ds.update(static_cast<double>(options.numberOfSeconds));
+    }
+    const double elapsed = simCore::systemTimeToSecsBgnYr() - startTime;
+
+    if (useIngest)
+      std::cout << "Ingest Threads = " << options.ingestThreads;
+    else
+      std::cout << "Transactions";
+    std::cout << ", Records = " << numRecords << ", Records per second = " << static_cast<double>(numRecords) / elapsed << std::endl;
+  }
+}
+
+/// Reports the memory used by the platform updates
+void reportPlatformMemory(const simData::DataStore& ds)
+{
+  simData::DataStore::IdList ids;
+  ds.idList(&ids, simData::PLATFORM);
+
+  size_t bytes = 0;
+  size_t points = 0;
+  for (auto id : ids)
+  {
+    const auto* slice = dynamic_cast<const simData::PlatformMemoryDataSlice*>(ds.platformUpdateSlice(id));
+    if (slice == nullptr)
+      continue;
+    bytes += slice->memoryUsage();
+    points += slice->numItems();
+  }
+
+  if (points == 0)
+    return;
+  std::cout << "Platform points = " << points << ", Memory per point (bytes) = " << static_cast<double>(bytes) / points << std::endl;
+}
+
 void writeEntityConfigurationPart(std::ofstream& output, const std::string& entity, int number)
 {
   output << entity << " Number " << number << " # Number of entities, can be zero for all entity types except platforms" << std::endl;
@@ -804,6 +933,9 @@ void writeExampleConfigurationFile()
   output << "Interpolate true          # State of the DataStore interpolation" << std::endl;
   output << "NumberOfSeconds 150       # Seconds of data" << std::endl;
   output << "DataLimiting false        # Used in Live mode to limit the amount of data, limits are set below" << std::endl;
+  output << "ColumnarStorage false     # True stores platform updates in columns to reduce memory" << std::endl;
+  output << "UpdateThreads 1           # Threads for the DataStore update; in File mode values over 1 also time 1, 2, 4, ... threads" << std::endl;
+  output << "IngestThreads 0           # Producer threads for the platform ingest throughput test; 0 skips the test" << std::endl;
   output << std::endl;
 
   writeEntityConfigurationPart(output, "Platform", 1000);
@@ -817,8 +949,9 @@ void writeExampleConfigurationFile()
 
 void usage()
 {
-    std::cerr << "DataStorePerformanceTest InputConfigfile | --help | --testCD | --WriteExampleConfigFile" << std::endl;
+    std::cerr << "DataStorePerformanceTest InputConfigfile | --help | --testCD | --WriteExampleConfigFile | --benchmark [options]" << std::endl;
     std::cerr << "  InputConfigFile specifies the parameters for the performance test" << std::endl;
+    std::cerr << "  --benchmark runs the benchmark suite instead; see --benchmark --help" << std::endl;
     std::cerr << "  --testCD include testing of CategoryData" << std::endl;
     std::cerr << "  --WriteExampleConfigFile writes out an example configuration file to DataStorePerformanceTest.conf" << std::endl;
     std::cerr << "  --help display this text" << std::endl;
@@ -1038,6 +1171,12 @@ int loadConfigurationFile(const std::string& fileName, TopLevelOptions& options,
         options.numberOfSeconds = atoi(tokens[1].c_str());
       else if (simCore::caseCompare(tokens[0], "DataLimiting") == 0)
         options.dataLimiting = (simCore::caseCompare(tokens[1], "True") == 0);
+      else if (simCore::caseCompare(tokens[0], "ColumnarStorage") == 0)
+        options.columnarStorage = (simCore::caseCompare(tokens[1], "True") == 0);
+      else if (simCore::caseCompare(tokens[0], "UpdateThreads") == 0)
+        options.updateThreads = atoi(tokens[1].c_str());
+      else if (simCore::caseCompare(tokens[0], "IngestThreads") == 0)
+        options.ingestThreads = atoi(tokens[1].c_str());
       else
       {
         std::cerr << "Unknown command on line " << currentLineNumber << std::endl;
@@ -1093,6 +1232,10 @@ int main(int argc, char *argv[])
 {
   simCore::checkVersionThrow();
 
+  // The benchmark suite has its own arguments and does not use a configuration file
+  if (argc > 1 && std::string(argv[1]) == "--benchmark")
+    return benchmarkMain(argc, argv);
+
   // Need to get configuration file name
   std::string fileName;
   TopLevelOptions options;
@@ -1114,21 +1257,29 @@ int main(int argc, char *argv[])
     return -1;
   }
 
+  ds.setColumnarPlatformStorage(options.columnarStorage);
   simData::LinearInterpolator* interpolator = initializeDataStore(ds, helper, options, entities, &counters);
 
   double updateTime;
   if (options.fileMode)
-    updateTime = fileMode(ds, helper, options, entities);
+    updateTime = fileMode(ds, helper, options, entities, counters);
   else
+  {
+    ds.setUpdateThreadCount(options.updateThreads);
     updateTime = liveMode(ds, helper, options, entities);
+  }
 
-  std::cout << "Done, Average Update Rate (milliseconds) = " << updateTime * 1000.0 / (options.numberOfSeconds*options.frameRate) << std::endl;
+  std::cout << "Done, Threads = " << ds.updateThreadCount() << ", Average Update Rate (milliseconds) = " << updateTime * 1000.0 / (options.numberOfSeconds*options.frameRate) << std::endl;
+  reportPlatformMemory(ds);
   // The sleep helps with looking at the data in the Intel tools
   Sleep(1000);
 
   cleanUpDataStore(ds, options, entities, counters);
   delete interpolator;
 
+  if (options.ingestThreads > 0)
+    ingestMode(options, entities);
+
   return 0;
 }
 
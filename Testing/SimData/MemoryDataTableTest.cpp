@@ -20,14 +20,19 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <string>
 #include "simCore/Common/SDKAssert.h"
 #include "simCore/Calc/Math.h"
 #include "simData/DataTable.h"
 #include "simData/MemoryDataStore.h"
 #include "simData/MemoryTable/DoubleBufferTimeContainer.h"
+#include "simData/MemoryTable/MinMaxPyramid.h"
 #include "simData/MemoryTable/SubTable.h"
 #include "simData/MemoryTable/TableManager.h"
+#include "simData/TableColumnStatistics.h"
 #include "simUtil/DataStoreTestHelper.h"
 
 namespace
@@ -2313,6 +2318,506 @@ int maxSubTableRowTest()
   return rv;
 }
 
+/** Statistics of a column in [beginTime, endTime) computed one cell at a time through the iterator */
+simData::TableColumn::Statistics iteratedStatistics(const simData::TableColumn& column, double beginTime, double endTime, double threshold)
+{
+  simData::TableColumn::Statistics stats;
+  simData::TableColumn::Iterator iter = column.lower_bound(beginTime);
+  while (iter.hasNext() && iter.peekNext()->time() < endTime)
+  {
+    double value = 0.0;
+    iter.next()->getValue(value);
+    stats.minimum = (stats.count == 0) ? value : simCore::sdkMin(stats.minimum, value);
+    stats.maximum = (stats.count == 0) ? value : simCore::sdkMax(stats.maximum, value);
+    stats.sum += value;
+    if (value > threshold)
+      ++stats.countAboveThreshold;
+    ++stats.count;
+  }
+  if (stats.count != 0)
+    stats.mean = stats.sum / stats.count;
+  return stats;
+}
+
+/** Returns true if the statistics match */
+bool statisticsEqual(const simData::TableColumn::Statistics& lhs, const simData::TableColumn::Statistics& rhs)
+{
+  return lhs.count == rhs.count && lhs.countAboveThreshold == rhs.countAboveThreshold &&
+    lhs.minimum == rhs.minimum && lhs.maximum == rhs.maximum &&
+    simCore::areEqual(lhs.sum, rhs.sum) && simCore::areEqual(lhs.mean, rhs.mean);
+}
+
+int testValueSpans()
+{
+  simData::MemoryDataStore ds;
+  simData::DataTableManager& mgr = ds.dataTableManager();
+  simData::DataTable* table = nullptr;
+  int rv = 0;
+  rv += SDK_ASSERT(mgr.addDataTable(1, "Span Table", &table).isSuccess());
+  simData::TableColumn* doubles = nullptr;
+  simData::TableColumn* ints = nullptr;
+  simData::TableColumn* strings = nullptr;
+  table->addColumn("Doubles", simData::VT_DOUBLE, 0, &doubles);
+  table->addColumn("Ints", simData::VT_INT16, 0, &ints);
+  table->addColumn("Strings", simData::VT_STRING, 0, &strings);
+  for (int i = 0; i < 100; ++i)
+  {
+    simData::TableRow row;
+    row.setTime(i);
+    row.setValue(doubles->columnId(), 0.5 * i);
+    row.setValue(ints->columnId(), static_cast<int16_t>(50 - i));
+    row.setValue(strings->columnId(), std::to_string(i));
+    rv += SDK_ASSERT(table->addRow(row).isSuccess());
+  }
+
+  // Rows added in time order are one span
+  std::vector<simData::TableColumn::ValueSpan> spans;
+  rv += SDK_ASSERT(doubles->getValueSpans(10.0, 20.0, spans).isSuccess());
+  rv += SDK_ASSERT(spans.size() == 1);
+  if (spans.size() == 1)
+  {
+    const std::span<const double> values = spans[0].values<double>();
+    rv += SDK_ASSERT(values.size() == 10 && values.front() == 5.0 && values.back() == 9.5);
+    rv += SDK_ASSERT(spans[0].beginTime == 10.0 && spans[0].endTime == 19.0);
+    // Wrong type gives an empty span
+    rv += SDK_ASSERT(spans[0].values<float>().empty());
+  }
+  rv += SDK_ASSERT(strings->getValueSpans(98.0, 200.0, spans).isSuccess());
+  rv += SDK_ASSERT(spans.size() == 1 && spans[0].values<std::string>().size() == 2 && spans[0].values<std::string>()[1] == "99");
+  rv += SDK_ASSERT(ints->getValueSpans(200.0, 300.0, spans).isSuccess() && spans.empty());
+
+  simData::TableColumn::Statistics stats;
+  rv += SDK_ASSERT(doubles->statistics(0.0, 100.0, 40.0, stats).isSuccess());
+  rv += SDK_ASSERT(stats.count == 100 && stats.minimum == 0.0 && stats.maximum == 49.5 && stats.countAboveThreshold == 19);
+  rv += SDK_ASSERT(statisticsEqual(stats, iteratedStatistics(*doubles, 0.0, 100.0, 40.0)));
+  rv += SDK_ASSERT(ints->statistics(5.0, 57.0, 0.0, stats).isSuccess());
+  rv += SDK_ASSERT(statisticsEqual(stats, iteratedStatistics(*ints, 5.0, 57.0, 0.0)));
+  rv += SDK_ASSERT(stats.minimum == -6.0 && stats.maximum == 45.0);
+  rv += SDK_ASSERT(doubles->statistics(500.0, 600.0, 0.0, stats).isSuccess() && stats.count == 0);
+  rv += SDK_ASSERT(strings->statistics(0.0, 100.0, 0.0, stats).isError());
+
+  // Rows added out of time order split the spans, but each span stays in time order
+  for (double time : { 50.5, 20.5, 20.25 })
+  {
+    simData::TableRow row;
+    row.setTime(time);
+    row.setValue(doubles->columnId(), -time);
+    row.setValue(ints->columnId(), static_cast<int16_t>(time));
+    row.setValue(strings->columnId(), "late");
+    rv += SDK_ASSERT(table->addRow(row).isSuccess());
+  }
+  rv += SDK_ASSERT(doubles->getValueSpans(0.0, 100.0, spans).isSuccess());
+  rv += SDK_ASSERT(spans.size() == 6);
+  size_t total = 0;
+  double lastTime = -1.0;
+  for (const auto& span : spans)
+  {
+    total += span.size;
+    rv += SDK_ASSERT(span.beginTime > lastTime && span.endTime >= span.beginTime);
+    lastTime = span.endTime;
+  }
+  rv += SDK_ASSERT(total == 103);
+  rv += SDK_ASSERT(doubles->statistics(15.0, 60.0, 10.0, stats).isSuccess());
+  rv += SDK_ASSERT(statisticsEqual(stats, iteratedStatistics(*doubles, 15.0, 60.0, 10.0)));
+  rv += SDK_ASSERT(stats.minimum == -50.5);
+
+  // Partial flush keeps the spans in step with the times
+  table->flush(0.0, 30.0);
+  rv += SDK_ASSERT(doubles->statistics(0.0, 100.0, 10.0, stats).isSuccess());
+  rv += SDK_ASSERT(statisticsEqual(stats, iteratedStatistics(*doubles, 0.0, 100.0, 10.0)));
+  rv += SDK_ASSERT(stats.count == 71);
+
+  // Flushing the oldest row one at a time keeps the values in step with the times
+  for (int i = 30; i < 90; ++i)
+  {
+    table->flush(0.0, i + 1.0);
+    rv += SDK_ASSERT(doubles->statistics(0.0, 200.0, 0.0, stats).isSuccess() && stats.minimum == (i < 50 ? -50.5 : 0.5 * (i + 1)));
+  }
+  rv += SDK_ASSERT(stats.count == 10 && stats.maximum == 49.5);
+  simData::TableRow row;
+  row.setTime(100.0);
+  row.setValue(doubles->columnId(), 50.0);
+  row.setValue(ints->columnId(), static_cast<int16_t>(-50));
+  row.setValue(strings->columnId(), "100");
+  rv += SDK_ASSERT(table->addRow(row).isSuccess());
+  rv += SDK_ASSERT(strings->getValueSpans(0.0, 200.0, spans).isSuccess() && !spans.empty());
+  rv += SDK_ASSERT(spans.front().values<std::string>().front() == "90" && spans.back().values<std::string>().back() == "100");
+  rv += SDK_ASSERT(doubles->statistics(0.0, 200.0, 0.0, stats).isSuccess());
+  rv += SDK_ASSERT(statisticsEqual(stats, iteratedStatistics(*doubles, 0.0, 200.0, 0.0)) && stats.count == 11);
+
+  return rv;
+}
+
+int testIndexRuns()
+{
+  int rv = 0;
+  simData::MemoryTable::DoubleBufferTimeContainer times;
+  for (int i = 0; i < 10; ++i)
+    times.findOrAddTime(i);
+  std::vector<simData::MemoryTable::TimeContainer::IndexRun> runs;
+  times.getIndexRuns(2.0, 5.0, runs);
+  rv += SDK_ASSERT(runs.size() == 1 && runs[0].isFreshBin && runs[0].firstIndex == 2 && runs[0].count == 3);
+
+  // After a swap, stale runs come before fresh runs
+  times.swapFreshStaleData(nullptr, std::vector<simData::DataTable::TableObserverPtr>());
+  for (int i = 10; i < 15; ++i)
+    times.findOrAddTime(i);
+  runs.clear();
+  times.getIndexRuns(8.0, 12.0, runs);
+  rv += SDK_ASSERT(runs.size() == 2);
+  if (runs.size() == 2)
+  {
+    rv += SDK_ASSERT(!runs[0].isFreshBin && runs[0].firstIndex == 8 && runs[0].count == 2 && runs[0].endTime == 9.0);
+    rv += SDK_ASSERT(runs[1].isFreshBin && runs[1].firstIndex == 0 && runs[1].count == 2 && runs[1].beginTime == 10.0);
+  }
+
+  // A time before the last splits the fresh bin's run around its appended index
+  times.findOrAddTime(11.5);
+  runs.clear();
+  times.getIndexRuns(10.0, 100.0, runs);
+  rv += SDK_ASSERT(runs.size() == 3);
+  if (runs.size() == 3)
+  {
+    rv += SDK_ASSERT(runs[0].firstIndex == 0 && runs[0].count == 2);
+    rv += SDK_ASSERT(runs[1].firstIndex == 5 && runs[1].count == 1 && runs[1].beginTime == 11.5);
+    rv += SDK_ASSERT(runs[2].firstIndex == 2 && runs[2].count == 3);
+  }
+  runs.clear();
+  times.getIndexRuns(5.0, 5.0, runs);
+  rv += SDK_ASSERT(runs.empty());
+  return rv;
+}
+
+/** Returns the number of buckets that do not match the column's values found one cell at a time */
+int checkMinMaxBuckets(const simData::TableColumn& column, double beginTime, double endTime, size_t numBuckets)
+{
+  std::vector<simData::TableColumn::MinMaxBucket> buckets;
+  if (!column.getMinMaxBuckets(beginTime, endTime, numBuckets, buckets).isSuccess() || buckets.size() != numBuckets)
+    return 1;
+  int rv = 0;
+  for (size_t ii = 0; ii < numBuckets; ++ii)
+  {
+    const simData::TableColumn::MinMaxBucket& bucket = buckets[ii];
+    const double bucketEnd = (ii + 1 == numBuckets) ? endTime : buckets[ii + 1].beginTime;
+    simData::TableColumn::Statistics expected = iteratedStatistics(column, bucket.beginTime, bucketEnd, 0.0);
+    rv += SDK_ASSERT(bucket.count == expected.count);
+    if (bucket.count == 0)
+      continue;
+    rv += SDK_ASSERT(bucket.minValue == expected.minimum && bucket.maxValue == expected.maximum);
+    // The reported times hold the reported values
+    double value = 0.0;
+    rv += SDK_ASSERT(column.interpolate(value, bucket.minTime, nullptr).isSuccess() && value == bucket.minValue);
+    rv += SDK_ASSERT(column.interpolate(value, bucket.maxTime, nullptr).isSuccess() && value == bucket.maxValue);
+    rv += SDK_ASSERT(bucket.minTime >= bucket.beginTime && bucket.minTime < bucketEnd);
+  }
+  return rv;
+}
+
+int testMinMaxPyramid()
+{
+  int rv = 0;
+  std::vector<int32_t> values(40000);
+  for (size_t ii = 0; ii < values.size(); ++ii)
+    values[ii] = static_cast<int32_t>((ii * 7919) % 10007);
+  simData::MemoryTable::MinMaxPyramid pyramid;
+  // Grow in uneven steps to add the levels incrementally
+  for (size_t size = 1; size < values.size(); size = size * 3 + 1)
+    pyramid.append(std::span<const int32_t>(values.data(), size));
+  pyramid.append(std::span<const int32_t>(values));
+  rv += SDK_ASSERT(pyramid.size() == values.size());
+
+  values[33333] = -5;
+  pyramid.update(std::span<const int32_t>(values), 33333);
+  for (size_t first : { 0, 1, 63, 64, 511, 4000, 33333, 39999 })
+  {
+    for (size_t count : { 1, 2, 64, 100, 4096, 30000 })
+    {
+      if (first + count > values.size())
+        continue;
+      const auto extremes = pyramid.query(std::span<const int32_t>(values), first, count);
+      const auto minIter = std::min_element(values.begin() + first, values.begin() + first + count);
+      const auto maxIter = std::max_element(values.begin() + first, values.begin() + first + count);
+      rv += SDK_ASSERT(extremes.numValid == count);
+      rv += SDK_ASSERT(extremes.minValue == *minIter && values[extremes.minIndex] == *minIter);
+      rv += SDK_ASSERT(extremes.maxValue == *maxIter && values[extremes.maxIndex] == *maxIter);
+      rv += SDK_ASSERT(extremes.minIndex >= first && extremes.maxIndex < first + count);
+    }
+  }
+
+  // Rebuilding matches the incremental summary
+  simData::MemoryTable::MinMaxPyramid rebuilt;
+  rebuilt.rebuild(std::span<const int32_t>(values));
+  const auto extremes = rebuilt.query(std::span<const int32_t>(values), 1000, 38000);
+  rv += SDK_ASSERT(extremes.minValue == -5 && extremes.minIndex == 33333);
+
+  // A sliding window, as with data limiting, is followed by appending and removing from the front without rebuilding
+  simData::MemoryTable::MinMaxPyramid window;
+  size_t head = 0;
+  for (size_t end = 1; end <= values.size(); ++end)
+  {
+    window.append(std::span<const int32_t>(values.data() + head, end - head));
+    if (end - head > 3000)
+    {
+      const size_t removed = 1 + end % 5;
+      window.eraseFront(removed);
+      head += removed;
+    }
+    rv += SDK_ASSERT(window.size() == end - head);
+    if (end % 997 != 0)
+      continue;
+    const std::span<const int32_t> live(values.data() + head, end - head);
+    for (size_t first : { size_t(0), size_t(1), live.size() / 3 })
+    {
+      const size_t count = live.size() - first;
+      const auto windowExtremes = window.query(live, first, count);
+      const auto minIter = std::min_element(live.begin() + first, live.end());
+      const auto maxIter = std::max_element(live.begin() + first, live.end());
+      rv += SDK_ASSERT(windowExtremes.numValid == count);
+      rv += SDK_ASSERT(windowExtremes.minValue == *minIter && live[windowExtremes.minIndex] == *minIter);
+      rv += SDK_ASSERT(windowExtremes.maxValue == *maxIter && live[windowExtremes.maxIndex] == *maxIter);
+    }
+  }
+  window.eraseFront(window.size());
+  rv += SDK_ASSERT(window.size() == 0);
+  return rv;
+}
+
+int testMinMaxBuckets()
+{
+  simData::MemoryDataStore ds;
+  simData::DataTableManager& mgr = ds.dataTableManager();
+  simData::DataTable* table = nullptr;
+  int rv = 0;
+  rv += SDK_ASSERT(mgr.addDataTable(1, "Plot Table", &table).isSuccess());
+  simData::TableColumn* doubles = nullptr;
+  simData::TableColumn* strings = nullptr;
+  table->addColumn("Doubles", simData::VT_DOUBLE, 0, &doubles);
+  table->addColumn("Strings", simData::VT_STRING, 0, &strings);
+  const auto addRow = [&](double time, double value) {
+    simData::TableRow row;
+    row.setTime(time);
+    row.setValue(doubles->columnId(), value);
+    row.setValue(strings->columnId(), "x");
+    return table->addRow(row).isSuccess() ? 0 : 1;
+  };
+  for (int i = 0; i < 5000; ++i)
+    rv += addRow(0.01 * i, std::sin(0.003 * i) + ((i % 997 == 0) ? 3.0 : 0.0));
+
+  rv += checkMinMaxBuckets(*doubles, 0.0, 50.0, 7);
+  rv += checkMinMaxBuckets(*doubles, 3.333, 41.7, 640);
+  rv += checkMinMaxBuckets(*doubles, -10.0, 100.0, 3);
+
+  // Appended rows, a replaced value and a late row keep the summary correct
+  for (int i = 5000; i < 6000; ++i)
+    rv += addRow(0.01 * i, std::cos(0.002 * i));
+  rv += addRow(12.345, -7.0);
+  simData::TableColumn::Iterator iter = doubles->lower_bound(30.0);
+  rv += SDK_ASSERT(iter.hasNext() && iter.next()->setValue(9.0).isSuccess());
+  rv += checkMinMaxBuckets(*doubles, 0.0, 60.0, 100);
+  std::vector<simData::TableColumn::MinMaxBucket> buckets;
+  rv += SDK_ASSERT(doubles->getMinMaxBuckets(0.0, 60.0, 1, buckets).isSuccess() && buckets.size() == 1);
+  rv += SDK_ASSERT(buckets[0].minValue == -7.0 && buckets[0].minTime == 12.345 && buckets[0].maxValue == 9.0 && buckets[0].maxTime == 30.0);
+
+  // The series holds both extremes of each bucket in time order
+  std::vector<double> times;
+  std::vector<double> values;
+  simData::appendMinMaxSeries(buckets, times, values);
+  rv += SDK_ASSERT(times == std::vector<double>({ 12.345, 30.0 }) && values == std::vector<double>({ -7.0, 9.0 }));
+
+  // Removing rows rebuilds the summary
+  table->flush(10.0, 20.0);
+  rv += checkMinMaxBuckets(*doubles, 0.0, 60.0, 33);
+
+  rv += SDK_ASSERT(strings->getMinMaxBuckets(0.0, 60.0, 10, buckets).isError());
+  rv += SDK_ASSERT(doubles->getMinMaxBuckets(0.0, 60.0, 0, buckets).isSuccess() && buckets.empty());
+  return rv;
+}
+
+int testMinMaxBucketsDataLimiting()
+{
+  int rv = 0;
+  simUtil::DataStoreTestHelper testHelper;
+  simData::DataStore* ds = testHelper.dataStore();
+  const uint64_t platId = testHelper.addPlatform();
+  ds->setDataLimiting(true);
+  simData::DataStore::Transaction t;
+  simData::PlatformPrefs* prefs = ds->mutable_platformPrefs(platId, &t);
+  prefs->mutable_commonprefs()->set_datalimitpoints(700);
+  t.commit();
+
+  simData::DataTable* table = nullptr;
+  rv += SDK_ASSERT(ds->dataTableManager().addDataTable(platId, "Limited Plot Table", &table).isSuccess());
+  simData::TableColumn* doubles = nullptr;
+  rv += SDK_ASSERT(table->addColumn("Doubles", simData::VT_DOUBLE, 0, &doubles).isSuccess());
+
+  // Each new row removes the oldest from the front, and the summary follows the removals between queries
+  for (int i = 0; i < 6000; ++i)
+  {
+    simData::TableRow row;
+    row.setTime(0.01 * i);
+    row.setValue(doubles->columnId(), std::sin(0.0031 * i) + ((i % 613 == 0) ? 2.0 : 0.0));
+    rv += SDK_ASSERT(table->addRow(row).isSuccess());
+    if (i % 250 == 249)
+    {
+      rv += checkMinMaxBuckets(*doubles, 0.0, 60.0, 9);
+      rv += checkMinMaxBuckets(*doubles, 0.01 * (i - 500), 0.01 * i + 0.005, 13);
+    }
+  }
+  rv += SDK_ASSERT(doubles->size() <= 700);
+  return rv;
+}
+
+
+/** Counts rows and blocks seen by a table observer; rows of blocks arrive through the default onAddRows() */
+class RowCountObserver : public simData::DataTable::TableObserver
+{
+public:
+  explicit RowCountObserver(bool countBlocks)
+    : countBlocks_(countBlocks)
+  {
+  }
+  void onAddColumn(simData::DataTable& table, const simData::TableColumn& column) override {}
+  void onAddRow(simData::DataTable& table, const simData::TableRow& row) override { ++numRows; }
+  void onAddRows(simData::DataTable& table, const simData::TableRowBlock& block) override
+  {
+    ++numBlocks;
+    if (countBlocks_)
+      numRows += block.rowCount();
+    else
+      simData::DataTable::TableObserver::onAddRows(table, block);
+  }
+  void onPreRemoveColumn(simData::DataTable& table, const simData::TableColumn& column) override {}
+  void onPreRemoveRow(simData::DataTable& table, double rowTime) override {}
+
+  size_t numRows = 0;
+  size_t numBlocks = 0;
+
+private:
+  bool countBlocks_;
+};
+
+/** Returns 0 if the columns have the same times and values */
+int compareColumns(const simData::TableColumn& lhs, const simData::TableColumn& rhs)
+{
+  int rv = SDK_ASSERT(lhs.size() == rhs.size());
+  simData::TableColumn::Iterator lhsIter = lhs.begin();
+  simData::TableColumn::Iterator rhsIter = rhs.begin();
+  while (lhsIter.hasNext() && rhsIter.hasNext())
+  {
+    const auto lhsData = lhsIter.next();
+    const auto rhsData = rhsIter.next();
+    double lhsValue = 0.0;
+    double rhsValue = 0.0;
+    lhsData->getValue(lhsValue);
+    rhsData->getValue(rhsValue);
+    if (lhsData->time() != rhsData->time() || lhsValue != rhsValue)
+      return rv + 1;
+  }
+  return rv + SDK_ASSERT(!lhsIter.hasNext() && !rhsIter.hasNext());
+}
+
+int testAddRows()
+{
+  simData::MemoryDataStore ds;
+  simData::DataTableManager& mgr = ds.dataTableManager();
+  simData::DataTable* table = nullptr;
+  simData::DataTable* reference = nullptr;
+  int rv = 0;
+  rv += SDK_ASSERT(mgr.addDataTable(1, "Block Table", &table).isSuccess());
+  rv += SDK_ASSERT(mgr.addDataTable(1, "Row Table", &reference).isSuccess());
+  std::vector<simData::TableColumn*> columns(3);
+  std::vector<simData::TableColumn*> referenceColumns(3);
+  for (simData::DataTable* addTo : { table, reference })
+  {
+    std::vector<simData::TableColumn*>& added = (addTo == table) ? columns : referenceColumns;
+    addTo->addColumn("Doubles", simData::VT_DOUBLE, 0, &added[0]);
+    addTo->addColumn("Ints", simData::VT_INT32, 0, &added[1]);
+    addTo->addColumn("Unused", simData::VT_DOUBLE, 0, &added[2]);
+  }
+  auto rowObserver = std::make_shared<RowCountObserver>(false);
+  auto blockObserver = std::make_shared<RowCountObserver>(true);
+  table->addObserver(rowObserver);
+  table->addObserver(blockObserver);
+
+  // Adds the block to the table, and its rows one by one to the reference table
+  simData::TableRowBlock block({ columns[0]->columnId(), columns[1]->columnId() });
+  const auto addBlock = [&]() {
+    simData::TableRow row;
+    for (size_t ii = 0; ii < block.rowCount(); ++ii)
+    {
+      block.getRow(ii, row);
+      reference->addRow(row);
+    }
+    return table->addRows(block);
+  };
+  const auto compareTables = [&]() {
+    int errors = 0;
+    for (size_t ii = 0; ii < columns.size(); ++ii)
+      errors += compareColumns(*columns[ii], *referenceColumns[ii]);
+    return errors;
+  };
+
+  // First block does not fill the third column, so the table splits as it would with addRow()
+  for (int i = 0; i < 100; ++i)
+    rv += SDK_ASSERT(block.addRow(i, std::vector<double>({ 0.5 * i, 100.0 - i })).isSuccess());
+  rv += SDK_ASSERT(addBlock().isSuccess());
+  rv += compareTables();
+  rv += SDK_ASSERT(columns[0]->size() == 100 && columns[2]->empty());
+  rv += SDK_ASSERT(rowObserver->numBlocks == 1 && rowObserver->numRows == 100);
+  rv += SDK_ASSERT(blockObserver->numBlocks == 1 && blockObserver->numRows == 100);
+
+  // Later rows filled directly are appended a column at a time, keeping the summary up to date
+  std::vector<simData::TableColumn::MinMaxBucket> buckets;
+  rv += SDK_ASSERT(columns[0]->getMinMaxBuckets(0.0, 1000.0, 10, buckets).isSuccess());
+  block.clear();
+  for (int i = 100; i < 1000; ++i)
+  {
+    block.times().push_back(i);
+    block.values(0).push_back(std::sin(0.01 * i));
+    block.values(1).push_back(i % 17);
+  }
+  rv += SDK_ASSERT(addBlock().isSuccess());
+  rv += compareTables();
+  rv += checkMinMaxBuckets(*columns[0], 0.0, 1000.0, 37);
+  rv += SDK_ASSERT(rowObserver->numBlocks == 2 && rowObserver->numRows == 1000);
+
+  // Out of order, repeated and existing times go row by row; later values replace earlier ones
+  block.clear();
+  for (double time : { 2000.0, 50.5, 10.0, 10.0, 1500.0 })
+    rv += SDK_ASSERT(block.addRow(time, std::vector<double>({ -time, 7.0 })).isSuccess());
+  rv += SDK_ASSERT(addBlock().isSuccess());
+  rv += compareTables();
+  rv += SDK_ASSERT(columns[0]->size() == 1003);
+  rv += checkMinMaxBuckets(*columns[0], 0.0, 3000.0, 10);
+  rv += SDK_ASSERT(rowObserver->numBlocks == 3 && rowObserver->numRows == 1005);
+
+  // Errors leave the table unchanged and notify no one
+  rv += SDK_ASSERT(block.addRow(3000.0, std::vector<double>({ 1.0 })).isError());
+  block.clear();
+  rv += SDK_ASSERT(table->addRows(block).isError());
+  block.times().push_back(3000.0);
+  block.values(0).push_back(1.0);
+  rv += SDK_ASSERT(table->addRows(block).isError());
+  simData::TableRowBlock unknownColumn({ columns[0]->columnId(), 99 });
+  rv += SDK_ASSERT(unknownColumn.addRow(3000.0, std::vector<double>({ 1.0, 2.0 })).isSuccess());
+  rv += SDK_ASSERT(table->addRows(unknownColumn).isError());
+  simData::TableRowBlock repeatedColumn({ columns[0]->columnId(), columns[0]->columnId() });
+  rv += SDK_ASSERT(repeatedColumn.addRow(3000.0, std::vector<double>({ 1.0, 2.0 })).isSuccess());
+  rv += SDK_ASSERT(table->addRows(repeatedColumn).isError());
+  rv += SDK_ASSERT(columns[0]->size() == 1003 && rowObserver->numBlocks == 3);
+
+  // A block covering every column of the table
+  simData::TableRowBlock allColumns({ columns[2]->columnId(), columns[1]->columnId(), columns[0]->columnId() });
+  block = allColumns;
+  for (int i = 3000; i < 3100; ++i)
+    rv += SDK_ASSERT(block.addRow(i, std::vector<double>({ 1.0 * i, 2.0 * i, 3.0 * i })).isSuccess());
+  rv += SDK_ASSERT(addBlock().isSuccess());
+  rv += compareTables();
+  rv += SDK_ASSERT(columns[2]->size() == 100 && columns[1]->size() == 1103);
+  rv += SDK_ASSERT(blockObserver->numBlocks == 4 && blockObserver->numRows == 1105);
+
+  return rv;
+}
 }
 
 int MemoryDataTableTest(int argc, char* argv[])
@@ -2331,5 +2836,11 @@ int MemoryDataTableTest(int argc, char* argv[])
   rv += testPartialFlush();
   rv += getTimeRangeTest();
   rv += maxSubTableRowTest();
+  rv += testValueSpans();
+  rv += testIndexRuns();
+  rv += testMinMaxPyramid();
+  rv += testMinMaxBuckets();
+  rv += testMinMaxBucketsDataLimiting();
+  rv += testAddRows();
   return rv;
 }
@@ -0,0 +1,228 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "simCore/Common/SDKAssert.h"
+#include "simData/MemoryDataStore.h"
+#include "simData/CategoryData/CategoryCountService.h"
+#include "simData/CategoryData/CategoryFilter.h"
+#include "simData/CategoryData/CategoryNameManager.h"
+#include "simUtil/DataStoreTestHelper.h"
+
+namespace
+{
+
+/** Counts the way simQt::CategoryFilterCounter does: one filter per category value, tested against every entity */
+simData::CategoryCounts::AllCategories referenceCounts(const simData::DataStore& ds, const simData::CategoryFilter& filter)
+{
+  simData::CategoryCounts::AllCategories counts;
+  simData::DataStore::IdList ids;
+  ds.idList(&ids);
+  std::vector<simData::CategoryFilter::CurrentCategoryValues> values(ids.size());
+  for (size_t ii = 0; ii < ids.size(); ++ii)
+    simData::CategoryFilter::getCurrentCategoryValues(ds, ids[ii], values[ii]);
+
+  const simData::CategoryNameManager& names = ds.categoryNameManager();
+  for (int nameInt : names.allCategoryNameInts())
+  {
+    std::vector<int> valueInts = names.allValueIntsInCategory(nameInt);
+    valueInts.push_back(simData::CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME);
+    for (int valueInt : valueInts)
+    {
+      simData::CategoryFilter baseFilter(filter);
+      baseFilter.removeName(nameInt);
+      baseFilter.setValue(nameInt, valueInt, true);
+      size_t& count = counts[nameInt][valueInt];
+      for (const auto& entityValues : values)
+      {
+        if (baseFilter.matchData(entityValues))
+          ++count;
+      }
+    }
+  }
+  return counts;
+}
+
+/** Adds platforms with values for Side, Type and Mode, some without a value */
+void addScenario(simUtil::DataStoreTestHelper& testHelper)
+{
+  const std::vector<std::string> sides = { "Red", "Blue", "Green" };
+  const std::vector<std::string> types = { "Ship", "Aircraft", "Sub", "Boat" };
+  for (size_t ii = 0; ii < 40; ++ii)
+  {
+    const uint64_t id = testHelper.addPlatform();
+    testHelper.addCategoryData(id, "Side", sides[ii % sides.size()], 0.0);
+    if (ii % 5 != 0)
+      testHelper.addCategoryData(id, "Type", types[ii % types.size()], 0.0);
+    if (ii % 2 == 0)
+      testHelper.addCategoryData(id, "Mode", (ii % 4 == 0) ? "Active" : "Passive", 0.0);
+  }
+}
+
+/** Collects the results passed to the callback */
+struct ResultsCollector
+{
+  std::mutex mutex;
+  std::vector<simData::CategoryCounts> results;
+
+  void add(const simData::CategoryCounts& counts)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    results.push_back(counts);
+  }
+};
+
+int testCountNow()
+{
+  int rv = 0;
+  simData::MemoryDataStore ds;
+  simUtil::DataStoreTestHelper testHelper(&ds);
+  addScenario(testHelper);
+  ds.update(1.0);
+  const simData::CategoryNameManager& names = ds.categoryNameManager();
+
+  // Empty filter counts every entity under its own values
+  simData::CategoryFilter filter(&ds);
+  simData::CategoryCounts counts;
+  simData::CategoryCountService::countNow(ds, filter, simData::ALL, counts);
+  rv += SDK_ASSERT(counts.allCategories == referenceCounts(ds, filter));
+  rv += SDK_ASSERT(counts.allCategories[names.nameToInt("Side")][names.valueToInt("Red")] == 14);
+  rv += SDK_ASSERT(counts.allCategories[names.nameToInt("Type")][simData::CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME] == 8);
+
+  // One category checked
+  filter.setValue(names.nameToInt("Side"), names.valueToInt("Red"), true);
+  simData::CategoryCountService::countNow(ds, filter, simData::ALL, counts);
+  rv += SDK_ASSERT(counts.allCategories == referenceCounts(ds, filter));
+
+  // Two categories, including NO VALUE
+  filter.setValue(names.nameToInt("Mode"), names.valueToInt("Active"), true);
+  filter.setValue(names.nameToInt("Mode"), simData::CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME, true);
+  simData::CategoryCountService::countNow(ds, filter, simData::ALL, counts);
+  rv += SDK_ASSERT(counts.allCategories == referenceCounts(ds, filter));
+
+  // Unlisted values and an unchecked value
+  filter.setValue(names.nameToInt("Type"), simData::CategoryNameManager::UNLISTED_CATEGORY_VALUE, true);
+  filter.setValue(names.nameToInt("Type"), names.valueToInt("Sub"), false);
+  simData::CategoryCountService::countNow(ds, filter, simData::ALL, counts);
+  rv += SDK_ASSERT(counts.allCategories == referenceCounts(ds, filter));
+
+  // Object types restrict the entities
+  testHelper.addBeam(testHelper.addPlatform());
+  simData::CategoryCountService::countNow(ds, simData::CategoryFilter(&ds), simData::BEAM, counts);
+  rv += SDK_ASSERT(counts.allCategories[names.nameToInt("Side")][simData::CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME] == 1);
+  rv += SDK_ASSERT(counts.allCategories[names.nameToInt("Side")][names.valueToInt("Red")] == 0);
+
+  return rv;
+}
+
+int testAsyncCount()
+{
+  int rv = 0;
+  simData::MemoryDataStore ds;
+  simUtil::DataStoreTestHelper testHelper(&ds);
+  addScenario(testHelper);
+  ds.update(1.0);
+  const simData::CategoryNameManager& names = ds.categoryNameManager();
+
+  ResultsCollector collector;
+  simData::CategoryCountService service(ds);
+  simData::CategoryCounts counts;
+  rv += SDK_ASSERT(service.lastResults(counts) != 0);
+  service.setResultsCallback([&collector](const simData::CategoryCounts& results) { collector.add(results); });
+
+  simData::CategoryFilter filter(&ds);
+  filter.setValue(names.nameToInt("Side"), names.valueToInt("Blue"), true);
+  const uint64_t first = service.count(filter);
+  service.wait();
+  rv += SDK_ASSERT(service.lastResults(counts) == 0);
+  rv += SDK_ASSERT(counts.request == first);
+  rv += SDK_ASSERT(counts.allCategories == referenceCounts(ds, filter));
+  rv += SDK_ASSERT(collector.results.size() == 1 && collector.results.back().request == first);
+
+  // Changing one category's checks reuses the other columns and gives the same results
+  filter.setValue(names.nameToInt("Type"), names.valueToInt("Ship"), true);
+  service.count(filter);
+  service.wait();
+  rv += SDK_ASSERT(service.lastResults(counts) == 0);
+  rv += SDK_ASSERT(counts.allCategories == referenceCounts(ds, filter));
+  filter.setValue(names.nameToInt("Side"), names.valueToInt("Green"), true);
+  service.count(filter);
+  service.wait();
+  rv += SDK_ASSERT(service.lastResults(counts) == 0);
+  rv += SDK_ASSERT(counts.allCategories == referenceCounts(ds, filter));
+
+  // New values are picked up even though the checks did not change
+  testHelper.addCategoryData(1, "Side", "Blue", 2.0);
+  testHelper.addCategoryData(2, "Type", "Ship", 2.0);
+  ds.update(3.0);
+  service.count(filter);
+  service.wait();
+  rv += SDK_ASSERT(service.lastResults(counts) == 0);
+  rv += SDK_ASSERT(counts.allCategories == referenceCounts(ds, filter));
+
+  // A newer count replaces an older one; only the newest result is the last delivered
+  collector.results.clear();
+  simData::CategoryFilter older(filter);
+  older.removeName(names.nameToInt("Type"));
+  service.count(older);
+  const uint64_t newest = service.count(filter);
+  service.wait();
+  rv += SDK_ASSERT(!collector.results.empty() && collector.results.back().request == newest);
+  rv += SDK_ASSERT(collector.results.back().allCategories == referenceCounts(ds, filter));
+
+  // Cancelled counts are not delivered; holding gate keeps the worker in the callback of any earlier count
+  std::mutex gate;
+  service.setResultsCallback([&collector, &gate](const simData::CategoryCounts& results) {
+    std::lock_guard<std::mutex> lock(gate);
+    collector.add(results);
+  });
+  collector.results.clear();
+  gate.lock();
+  service.count(filter);
+  const uint64_t cancelled = service.count(older);
+  service.cancel();
+  gate.unlock();
+  service.wait();
+  for (const auto& results : collector.results)
+    rv += SDK_ASSERT(results.request != cancelled);
+  rv += SDK_ASSERT(service.lastResults(counts) == 0);
+  rv += SDK_ASSERT(counts.request != cancelled);
+
+  return rv;
+}
+
+}
+
+int TestCategoryCountService(int argc, char* argv[])
+{
+  int rv = 0;
+
+  rv += testCountNow();
+  rv += testAsyncCount();
+
+  std::cout << "TestCategoryCountService: " << (rv == 0 ? "PASSED" : "FAILED") << std::endl;
+
+  return rv;
+}
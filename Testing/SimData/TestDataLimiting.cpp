@@ -24,6 +24,7 @@
 #include <iostream>
 #include "simCore/Common/SDKAssert.h"
 #include "simCore/Common/Version.h"
+#include "simData/DataTable.h"
 #include "simData/MemoryDataStore.h"
 #include "simUtil/DataStoreTestHelper.h"
 
@@ -252,6 +253,117 @@ protected: // data
   uint64_t laserId_;
   uint64_t projId_;
 };
+
+int testMemoryBudget(bool columnar)
+{
+  int rv = 0;
+
+  simData::MemoryDataStore ds;
+  ds.setColumnarPlatformStorage(columnar);
+  simUtil::DataStoreTestHelper testHelper(&ds);
+  const uint64_t oldPlatform = testHelper.addPlatform();
+  const uint64_t newPlatform = testHelper.addPlatform();
+  const uint64_t staticPlatform = testHelper.addPlatform();
+  const uint64_t beam = testHelper.addBeam(oldPlatform);
+  // Old platform and beam hold the oldest data; the new platform starts at 500
+  for (int ii = 0; ii < 1000; ++ii)
+  {
+    testHelper.addPlatformUpdate(ii, oldPlatform);
+    testHelper.addPlatformUpdate(ii + 500, newPlatform);
+  }
+  for (int ii = 0; ii < 100; ++ii)
+    testHelper.addBeamUpdate(ii, beam);
+  testHelper.addPlatformUpdate(-1.0, staticPlatform);
+  addCategoryData(&ds, oldPlatform, 0.0);
+  addGenericData(&ds, oldPlatform, 0.0);
+  testHelper.addDataTable(oldPlatform, 200, "Table");
+  ds.update(0.0);
+
+  // Statistics without a budget
+  simData::MemoryDataStore::MemoryStatistics stats = ds.memoryStatistics();
+  rv += SDK_ASSERT(stats.budget == 0);
+  rv += SDK_ASSERT(stats.evictions == 0);
+  rv += SDK_ASSERT(stats.usage.size() == 5);
+  const simData::MemoryDataStore::MemoryUsage oldUsage = ds.memoryUsage(oldPlatform);
+  rv += SDK_ASSERT(oldUsage.type == simData::PLATFORM);
+  rv += SDK_ASSERT(oldUsage.updates > 0);
+  rv += SDK_ASSERT(oldUsage.categoryData > 0);
+  rv += SDK_ASSERT(oldUsage.genericData > 0);
+  rv += SDK_ASSERT(oldUsage.dataTables > 0);
+  rv += SDK_ASSERT(ds.memoryUsage(newPlatform).dataTables == 0);
+  rv += SDK_ASSERT(stats.usage.front().id == oldPlatform);
+  size_t sum = 0;
+  for (const auto& usage : stats.usage)
+    sum += usage.total();
+  rv += SDK_ASSERT(sum == stats.totalBytes);
+
+  // Without a budget nothing is removed
+  ds.update(1.0);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(oldPlatform)->numItems() == 1000);
+
+  // Needs about half of the old platform's history removed, which is older than the new platform's
+  const size_t budget = stats.totalBytes - oldUsage.updates / 2;
+  ds.setMemoryBudget(budget);
+  rv += SDK_ASSERT(ds.memoryBudget() == budget);
+  ds.update(1.0);
+  stats = ds.memoryStatistics();
+  rv += SDK_ASSERT(stats.totalBytes <= budget);
+  rv += SDK_ASSERT(stats.budget == budget);
+  rv += SDK_ASSERT(stats.evictions == 1);
+  rv += SDK_ASSERT(stats.evictedPoints > 0);
+  rv += SDK_ASSERT(stats.evictedBytes > 0);
+
+  // Oldest data went first, and the most recent point of each slice and table is kept
+  const double oldFirstTime = ds.platformUpdateSlice(oldPlatform)->firstTime();
+  rv += SDK_ASSERT(oldFirstTime > 99.0);
+  rv += SDK_ASSERT(oldFirstTime < 500.0);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(oldPlatform)->lastTime() == 999.0);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(newPlatform)->numItems() == 1000);
+  rv += SDK_ASSERT(ds.beamUpdateSlice(beam)->numItems() == 1);
+  rv += SDK_ASSERT(ds.beamUpdateSlice(beam)->firstTime() == 99.0);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(staticPlatform)->numItems() == 1);
+  const simData::DataTable* table = ds.dataTableManager().findTable(oldPlatform, "Table");
+  rv += SDK_ASSERT(table != nullptr);
+  if (table)
+  {
+    rv += SDK_ASSERT(table->column("Col0")->size() == 1);
+    rv += SDK_ASSERT(table->column("Col0")->findAtOrBeforeTime(200.0).next()->time() == 200.0);
+  }
+  // Category and generic data are never removed
+  rv += SDK_ASSERT(ds.memoryUsage(oldPlatform).categoryData == oldUsage.categoryData);
+  rv += SDK_ASSERT(ds.memoryUsage(oldPlatform).genericData == oldUsage.genericData);
+
+  // Still within budget, so nothing more is removed
+  ds.update(2.0);
+  rv += SDK_ASSERT(ds.memoryStatistics().evictions == 1);
+
+  // Enforced again as new data arrives
+  for (int ii = 1000; ii < 1200; ++ii)
+    testHelper.addPlatformUpdate(ii, oldPlatform);
+  ds.update(3.0);
+  stats = ds.memoryStatistics();
+  rv += SDK_ASSERT(stats.totalBytes <= budget);
+  rv += SDK_ASSERT(stats.evictions == 2);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(oldPlatform)->firstTime() > oldFirstTime);
+
+  // New table rows are counted too, and being the oldest data they are the first removed
+  testHelper.addDataTable(newPlatform, 200, "NewTable");
+  ds.update(3.5);
+  stats = ds.memoryStatistics();
+  rv += SDK_ASSERT(stats.totalBytes <= budget);
+  rv += SDK_ASSERT(stats.evictions == 3);
+  const simData::DataTable* newTable = ds.dataTableManager().findTable(newPlatform, "NewTable");
+  rv += SDK_ASSERT(newTable != nullptr && newTable->column("Col0")->size() < 200);
+
+  // A budget below what can be removed leaves the last point of everything
+  ds.setMemoryBudget(1);
+  ds.update(4.0);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(oldPlatform)->numItems() == 1);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(newPlatform)->numItems() == 1);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(oldPlatform)->lastTime() == 1199.0);
+
+  return rv;
+}
 } // anonymous namespace
 
 int TestDataLimiting(int argc, char *argv[])
@@ -263,6 +375,8 @@ int TestDataLimiting(int argc, char *argv[])
   th.init();
 
   rv += th.runTest();
+  rv += testMemoryBudget(false);
+  rv += testMemoryBudget(true);
 
   return rv;
 }
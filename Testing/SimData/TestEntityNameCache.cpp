@@ -20,9 +20,13 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
 #include <iostream>
+#include <string>
 #include "simCore/Common/SDKAssert.h"
+#include "simData/EntityNameCache.h"
 #include "simData/MemoryDataStore.h"
+#include "simData/CategoryData/CategoryFilter.h"
 #include "simUtil/DataStoreTestHelper.h"
 
 namespace
@@ -125,6 +129,233 @@ int testAliasInvalidation()
   return rv;
 }
 
+/** Matches names ending with a suffix, standing in for a regular expression */
+class SuffixFilter : public simData::RegExpFilter
+{
+public:
+  explicit SuffixFilter(const std::string& suffix) : suffix_(suffix) {}
+  bool match(const std::string& test) const override { return test.ends_with(suffix_); }
+  std::string pattern() const override { return suffix_ + "$"; }
+
+private:
+  std::string suffix_;
+};
+
+/** Returns the sorted IDs of the entries */
+std::vector<simData::ObjectId> sortedIds(const std::vector<const simData::EntityNameEntry*>& entries)
+{
+  std::vector<simData::ObjectId> ids;
+  for (const simData::EntityNameEntry* entry : entries)
+    ids.push_back(entry->id());
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+/** Lower cases ASCII letters */
+std::string lower(std::string text)
+{
+  std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return text;
+}
+
+int testPrefixAndSubstring()
+{
+  int rv = 0;
+  simData::EntityNameCache cache;
+  cache.addEntity("Alpha One", 1, simData::PLATFORM);
+  cache.addEntity("alpha two", 2, simData::PLATFORM);
+  cache.addEntity("Alpha One", 3, simData::BEAM);
+  cache.addEntity("Bravo", 4, simData::PLATFORM);
+  cache.addEntity("Al", 5, simData::GATE);
+  cache.addEntity("Charlie Alpha", 6, simData::PLATFORM);
+
+  std::vector<const simData::EntityNameEntry*> entries;
+  cache.getEntriesWithPrefix("Alpha", simData::ALL, true, entries);
+  rv += SDK_ASSERT(sortedIds(entries) == std::vector<simData::ObjectId>({ 1, 3 }));
+  entries.clear();
+  cache.getEntriesWithPrefix("alpha", simData::ALL, false, entries);
+  rv += SDK_ASSERT(sortedIds(entries) == std::vector<simData::ObjectId>({ 1, 2, 3 }));
+  entries.clear();
+  cache.getEntriesWithPrefix("AL", simData::PLATFORM, false, entries);
+  rv += SDK_ASSERT(sortedIds(entries) == std::vector<simData::ObjectId>({ 1, 2 }));
+  entries.clear();
+  cache.getEntriesWithPrefix("", simData::ALL, true, entries);
+  rv += SDK_ASSERT(entries.size() == 6);
+  entries.clear();
+  cache.getEntriesWithPrefix("Alpha One and more", simData::ALL, false, entries);
+  rv += SDK_ASSERT(entries.empty());
+
+  // Prefix results are ordered by name, ignoring case
+  entries.clear();
+  cache.getEntriesWithPrefix("", simData::PLATFORM, false, entries);
+  rv += SDK_ASSERT(entries.size() == 4 && entries[0]->id() == 1 && entries[1]->id() == 2 && entries[2]->id() == 4 && entries[3]->id() == 6);
+
+  entries.clear();
+  cache.getEntriesContaining("lpha", simData::ALL, true, entries);
+  rv += SDK_ASSERT(sortedIds(entries) == std::vector<simData::ObjectId>({ 1, 2, 3, 6 }));
+  entries.clear();
+  cache.getEntriesContaining("ALPHA", simData::ALL, true, entries);
+  rv += SDK_ASSERT(entries.empty());
+  entries.clear();
+  cache.getEntriesContaining("ALPHA", simData::ALL, false, entries);
+  rv += SDK_ASSERT(sortedIds(entries) == std::vector<simData::ObjectId>({ 1, 2, 3, 6 }));
+  entries.clear();
+  cache.getEntriesContaining("a O", simData::ALL, false, entries);
+  rv += SDK_ASSERT(sortedIds(entries) == std::vector<simData::ObjectId>({ 1, 3 }));
+  entries.clear();
+  cache.getEntriesContaining("zzz", simData::ALL, false, entries);
+  rv += SDK_ASSERT(entries.empty());
+
+  // Short text tests every name
+  entries.clear();
+  cache.getEntriesContaining("l", simData::ALL, true, entries);
+  rv += SDK_ASSERT(sortedIds(entries) == std::vector<simData::ObjectId>({ 1, 2, 3, 5, 6 }));
+  entries.clear();
+  cache.getEntriesContaining("", simData::GATE, true, entries);
+  rv += SDK_ASSERT(sortedIds(entries) == std::vector<simData::ObjectId>({ 5 }));
+
+  entries.clear();
+  cache.getEntriesMatching(SuffixFilter("pha"), simData::ALL, entries);
+  rv += SDK_ASSERT(sortedIds(entries) == std::vector<simData::ObjectId>({ 6 }));
+
+  // Renames and removals update every index
+  cache.nameChange("Delta", "Alpha One", 1);
+  cache.removeEntity("Charlie Alpha", 6, simData::PLATFORM);
+  entries.clear();
+  cache.getEntriesContaining("alpha", simData::ALL, false, entries);
+  rv += SDK_ASSERT(sortedIds(entries) == std::vector<simData::ObjectId>({ 2, 3 }));
+  entries.clear();
+  cache.getEntriesWithPrefix("D", simData::ALL, true, entries);
+  rv += SDK_ASSERT(sortedIds(entries) == std::vector<simData::ObjectId>({ 1 }));
+  entries.clear();
+  cache.getEntries("Alpha One", simData::ALL, entries);
+  rv += SDK_ASSERT(sortedIds(entries) == std::vector<simData::ObjectId>({ 3 }));
+  cache.removeEntity("Alpha One", 3, simData::BEAM);
+  entries.clear();
+  cache.getEntriesContaining("One", simData::ALL, true, entries);
+  rv += SDK_ASSERT(entries.empty());
+  entries.clear();
+  cache.getEntriesMatching(SuffixFilter("One"), simData::ALL, entries);
+  rv += SDK_ASSERT(entries.empty());
+
+  // A removed name can come back
+  cache.addEntity("Alpha One", 7, simData::PLATFORM);
+  entries.clear();
+  cache.getEntriesContaining("a On", simData::ALL, true, entries);
+  rv += SDK_ASSERT(sortedIds(entries) == std::vector<simData::ObjectId>({ 7 }));
+
+  return rv;
+}
+
+int testManyNames()
+{
+  int rv = 0;
+  simData::EntityNameCache cache;
+  std::vector<std::string> names;
+  for (simData::ObjectId id = 1; id <= 3000; ++id)
+  {
+    names.push_back((id % 3 == 0 ? "Ship " : "Plane ") + std::to_string(id * 7 % 1000));
+    cache.addEntity(names.back(), id, simData::PLATFORM);
+  }
+  // Renaming and removing most of the entities forces the indexes to compact
+  for (simData::ObjectId id = 1; id <= 3000; ++id)
+  {
+    std::string& name = names[id - 1];
+    if (id % 4 == 0)
+    {
+      const std::string newName = "SHIP_" + std::to_string(id);
+      cache.nameChange(newName, name, id);
+      name = newName;
+    }
+    else if (id % 4 != 1)
+    {
+      cache.removeEntity(name, id, simData::PLATFORM);
+      name.clear();
+    }
+  }
+
+  for (const std::string text : { "ship", "Ship", "SHIP_1", "ne 7", "7", "", "99", "_30" })
+  {
+    for (bool caseSensitive : { true, false })
+    {
+      std::vector<simData::ObjectId> contains;
+      std::vector<simData::ObjectId> startsWith;
+      for (simData::ObjectId id = 1; id <= names.size(); ++id)
+      {
+        const std::string& name = names[id - 1];
+        if (name.empty())
+          continue;
+        const std::string testName = caseSensitive ? name : lower(name);
+        const std::string testText = caseSensitive ? text : lower(text);
+        if (testName.find(testText) != std::string::npos)
+          contains.push_back(id);
+        if (testName.starts_with(testText))
+          startsWith.push_back(id);
+      }
+
+      std::vector<const simData::EntityNameEntry*> entries;
+      cache.getEntriesContaining(text, simData::ALL, caseSensitive, entries);
+      rv += SDK_ASSERT(sortedIds(entries) == contains);
+      entries.clear();
+      cache.getEntriesWithPrefix(text, simData::ALL, caseSensitive, entries);
+      rv += SDK_ASSERT(sortedIds(entries) == startsWith);
+    }
+  }
+
+  return rv;
+}
+
+int testDataStoreQueries()
+{
+  int rv = 0;
+  simUtil::DataStoreTestHelper testHelper;
+  simData::DataStore& dataStore = *testHelper.dataStore();
+  const uint64_t platform1 = testHelper.addPlatform();
+  const uint64_t platform2 = testHelper.addPlatform();
+  const uint64_t beam = testHelper.addBeam(platform1);
+
+  simData::DataStore::Transaction txn;
+  simData::PlatformPrefs* prefs = dataStore.mutable_platformPrefs(platform1, &txn);
+  prefs->mutable_commonprefs()->set_name("USS Example");
+  txn.complete(&prefs);
+  prefs = dataStore.mutable_platformPrefs(platform2, &txn);
+  prefs->mutable_commonprefs()->set_name("Example Two");
+  txn.complete(&prefs);
+  simData::BeamPrefs* beamPrefs = dataStore.mutable_beamPrefs(beam, &txn);
+  beamPrefs->mutable_commonprefs()->set_name("Example Beam");
+  txn.complete(&beamPrefs);
+
+  simData::DataStore::IdList ids;
+  dataStore.idListByNamePrefix("example", &ids, simData::ALL, false);
+  rv += SDK_ASSERT(ids == simData::DataStore::IdList({ beam, platform2 }));
+  dataStore.idListByNamePrefix("example", &ids);
+  rv += SDK_ASSERT(ids.empty());
+  dataStore.idListByNameSubstring("Example", &ids, simData::PLATFORM);
+  std::sort(ids.begin(), ids.end());
+  rv += SDK_ASSERT(ids == simData::DataStore::IdList({ platform1, platform2 }));
+  dataStore.idListByNameRegExp(SuffixFilter("Beam"), &ids);
+  rv += SDK_ASSERT(ids == simData::DataStore::IdList({ beam }));
+
+  // The DataStore defaults, for stores without a name index, scan for the same results
+  dataStore.DataStore::idListByNamePrefix("example", &ids, simData::ALL, false);
+  rv += SDK_ASSERT(ids == simData::DataStore::IdList({ beam, platform2 }));
+  dataStore.DataStore::idListByNamePrefix("example", &ids);
+  rv += SDK_ASSERT(ids.empty());
+  dataStore.DataStore::idListByNameSubstring("Example", &ids, simData::PLATFORM);
+  std::sort(ids.begin(), ids.end());
+  rv += SDK_ASSERT(ids == simData::DataStore::IdList({ platform1, platform2 }));
+  dataStore.DataStore::idListByNameSubstring("ple t", &ids, simData::ALL, false);
+  rv += SDK_ASSERT(ids == simData::DataStore::IdList({ platform2 }));
+  dataStore.DataStore::idListByNameRegExp(SuffixFilter("Beam"), &ids);
+  rv += SDK_ASSERT(ids == simData::DataStore::IdList({ beam }));
+
+  dataStore.removeEntity(platform2);
+  dataStore.idListByNameSubstring("two", &ids, simData::ALL, false);
+  rv += SDK_ASSERT(ids.empty());
+
+  return rv;
+}
+
 }
 
 int TestEntityNameCache(int argc, char* argv[])
@@ -132,6 +363,9 @@ int TestEntityNameCache(int argc, char* argv[])
   int rv = 0;
 
   rv += testAliasInvalidation();
+  rv += testPrefixAndSubstring();
+  rv += testManyNames();
+  rv += testDataStoreQueries();
 
   std::cout << "TestEntityNameCache: " << (rv == 0 ? "PASSED" : "FAILED") << std::endl;
 
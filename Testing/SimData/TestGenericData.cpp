@@ -21,8 +21,12 @@
  *
  */
 
+#include <algorithm>
+#include <string>
+#include <vector>
 #include "simCore/Common/SDKAssert.h"
 #include "simData/MemoryDataStore.h"
+#include "simData/StringArena.h"
 #include "simUtil/DataStoreTestHelper.h"
 
 namespace
@@ -323,6 +327,171 @@ int test_ignoreDuplicates()
   return rv;
 }
 
+/// Collects every time/key/value visited in a generic data slice
+struct GenericDataCollector : public simData::GenericDataSlice::Visitor
+{
+  std::vector<std::string> items;
+  void operator()(const simData::GenericData *update) override
+  {
+    if (update == nullptr)
+      return;
+    for (int k = 0; k < update->entry_size(); ++k)
+      items.push_back(std::to_string(update->time()) + " " + update->entry(k).key() + "=" + update->entry(k).value());
+  }
+};
+
+/// Returns the visited items of the entity's generic data
+std::vector<std::string> genericItems(const simData::DataStore& ds, uint64_t id)
+{
+  GenericDataCollector collector;
+  ds.genericDataSlice(id)->visit(&collector);
+  return collector.items;
+}
+
+/// Returns the current key=value entries of the entity's generic data
+std::vector<std::string> currentItems(const simData::DataStore& ds, uint64_t id)
+{
+  std::vector<std::string> items;
+  const simData::GenericData* current = ds.genericDataSlice(id)->current();
+  for (int k = 0; k < current->entry_size(); ++k)
+    items.push_back(current->entry(k).key() + "=" + current->entry(k).value());
+  return items;
+}
+
+int test_interning()
+{
+  int rv = 0;
+
+  // Same data into a store with per-key pools and a store with interned strings
+  simData::MemoryDataStore pooled;
+  simData::MemoryDataStore interned;
+  simUtil::DataStoreTestHelper pooledHelper(&pooled);
+  simUtil::DataStoreTestHelper internedHelper(&interned);
+  std::vector<uint64_t> ids;
+  for (int ii = 0; ii < 3; ++ii)
+  {
+    ids.push_back(pooledHelper.addPlatform());
+    internedHelper.addPlatform();
+  }
+  const auto addBoth = [&](uint64_t id, const std::string& key, const std::string& value, double time) {
+    pooledHelper.addGenericData(id, key, value, time);
+    internedHelper.addGenericData(id, key, value, time);
+  };
+
+  // Data added before interning is turned on is moved into the arena
+  addBoth(ids[0], "Mode", "Search", 1.0);
+  addBoth(0, "Mode", "Search", 1.0);
+  rv += SDK_ASSERT(!interned.genericDataInterning());
+  interned.setGenericDataInterning(true);
+  rv += SDK_ASSERT(interned.genericDataInterning());
+  const simData::MemoryGenericDataSlice* slice = dynamic_cast<const simData::MemoryGenericDataSlice*>(interned.genericDataSlice(ids[0]));
+  rv += SDK_ASSERT(slice != nullptr && slice->stringArena() != nullptr);
+  if (slice == nullptr || slice->stringArena() == nullptr)
+    return rv;
+  const simData::StringArena& arena = *slice->stringArena();
+  rv += SDK_ASSERT(arena.size() == 2);
+
+  // Repeated keys and values across entities are stored once
+  for (uint64_t id : ids)
+  {
+    addBoth(id, "Mode", "Track", 2.0);
+    addBoth(id, "Mode", "Search", 3.0);
+    addBoth(id, "Status", "Track", 2.5);
+    // Out of order and same time duplicates
+    addBoth(id, "Mode", "Idle", 0.5);
+    addBoth(id, "Mode", "Idle", 0.5);
+  }
+  rv += SDK_ASSERT(arena.size() == 5);
+  for (uint64_t id : ids)
+    rv += SDK_ASSERT(genericItems(pooled, id) == genericItems(interned, id));
+  for (double time : { 0.0, 0.5, 1.0, 2.2, 2.7, 10.0 })
+  {
+    pooled.update(time);
+    interned.update(time);
+    for (uint64_t id : ids)
+      rv += SDK_ASSERT(currentItems(pooled, id) == currentItems(interned, id));
+  }
+
+  // Unique values are freed by data limiting once their last use is gone
+  pooled.setDataLimiting(true);
+  interned.setDataLimiting(true);
+  simData::PlatformPrefs prefs;
+  prefs.mutable_commonprefs()->set_datalimitpoints(2);
+  pooledHelper.updatePlatformPrefs(prefs, ids[1]);
+  internedHelper.updatePlatformPrefs(prefs, ids[1]);
+  for (int ii = 0; ii < 10; ++ii)
+    addBoth(ids[1], "Counter", std::to_string(ii), 10.0 + ii);
+  rv += SDK_ASSERT(genericItems(pooled, ids[1]) == genericItems(interned, ids[1]));
+  // Counter key plus the last two values
+  rv += SDK_ASSERT(arena.size() == 8);
+
+  // Flushing and removing entities releases their strings
+  interned.flush(ids[1], simData::DataStore::FLUSH_NONRECURSIVE, simData::DataStore::FLUSH_GENERIC_DATA);
+  rv += SDK_ASSERT(arena.size() == 5);
+  interned.removeEntity(ids[0]);
+  interned.removeEntity(ids[2]);
+  // Only the scenario's Mode=Search remains
+  rv += SDK_ASSERT(arena.size() == 2);
+
+  // The arena is reported with the scenario
+  rv += SDK_ASSERT(interned.memoryUsage(0).genericData >= arena.memoryUsage());
+
+  // Turning interning off moves the data back to per-key pools
+  interned.setGenericDataInterning(false);
+  rv += SDK_ASSERT(dynamic_cast<const simData::MemoryGenericDataSlice*>(interned.genericDataSlice(0))->stringArena() == nullptr);
+  rv += SDK_ASSERT(genericItems(pooled, 0) == genericItems(interned, 0));
+
+  return rv;
+}
+
+/// Same time inserts give the same items and current values with and without interning
+int test_internedSameTime()
+{
+  int rv = 0;
+
+  for (bool ignoreDuplicates : { false, true })
+  {
+    simData::MemoryDataStore pooled;
+    simData::MemoryDataStore interned;
+    simUtil::DataStoreTestHelper pooledHelper(&pooled);
+    simUtil::DataStoreTestHelper internedHelper(&interned);
+    setIgnoreDupeGD_(pooled, ignoreDuplicates);
+    setIgnoreDupeGD_(interned, ignoreDuplicates);
+    interned.setGenericDataInterning(true);
+    const uint64_t id = pooledHelper.addPlatform();
+    internedHelper.addPlatform();
+    const auto addBoth = [&](const std::string& key, const std::string& value, double time) {
+      pooledHelper.addGenericData(id, key, value, time);
+      internedHelper.addGenericData(id, key, value, time);
+    };
+
+    // The later of two values at the same time is current, and a duplicate is compared to the last value at its time
+    addBoth("k", "a", 1.0);
+    addBoth("k", "b", 1.0);
+    addBoth("j", "x", 1.0);
+    addBoth("j", "y", 1.0);
+    addBoth("j", "x", 0.5);
+    addBoth("j", "y", 2.0);
+    addBoth("j", "x", 2.0);
+    addBoth("k", "b", 3.0);
+    rv += SDK_ASSERT(genericItems(pooled, id) == genericItems(interned, id));
+    rv += SDK_ASSERT(pooled.genericDataSlice(id)->numItems() == interned.genericDataSlice(id)->numItems());
+    for (double time : { 0.5, 1.0, 1.5, 2.0, 3.0 })
+    {
+      pooled.update(time);
+      interned.update(time);
+      rv += SDK_ASSERT(currentItems(pooled, id) == currentItems(interned, id));
+    }
+    pooled.update(1.0);
+    interned.update(1.0);
+    const std::vector<std::string> current = currentItems(interned, id);
+    rv += SDK_ASSERT(std::find(current.begin(), current.end(), "k=b") != current.end());
+    rv += SDK_ASSERT(std::find(current.begin(), current.end(), "j=y") != current.end());
+  }
+
+  return rv;
+}
+
 void testPerformanceRepeating()
 {
   simUtil::DataStoreTestHelper testHelper;
@@ -448,6 +617,8 @@ int TestGenericData(int argc, char *argv[])
   rv += test_limitTime();
   rv += test_Sim4722_CurrentGenData();
   rv += test_ignoreDuplicates();
+  rv += test_interning();
+  rv += test_internedSameTime();
   test_5743();
 
   // The performance tests are not part of the commit, since they take time and don't generate
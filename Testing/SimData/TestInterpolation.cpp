@@ -20,14 +20,25 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <vector>
 
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Calculations.h"
+#include "simCore/Calc/CoordinateConverter.h"
 #include "simCore/Calc/CoordinateSystem.h"
+#include "simCore/Calc/Math.h"
+#include "simCore/Calc/MultiFrameCoordinate.h"
 #include "simCore/Calc/Units.h"
 #include "simCore/Common/Version.h"
+#include "simData/GeodesicInterpolator.h"
+#include "simData/HermiteInterpolator.h"
 #include "simData/MemoryDataStore.h"
 #include "simData/LinearInterpolator.h"
 #include "simData/NearestNeighborInterpolator.h"
+#include "simData/PlatformInterpolationBatch.h"
 #include "simUtil/DataStoreTestHelper.h"
 
 using namespace std;
@@ -594,6 +605,298 @@ int testNoInterpolationLifeSpan()
   return rv;
 }
 
+/// Fills in a platform update with position, orientation and velocity that vary with the index
+void makeBatchUpdate(double time, size_t index, simData::PlatformUpdate& u)
+{
+  const double angle = 0.37 * static_cast<double>(index) + 0.01 * time;
+  const double radius = simCore::WGS_A + 100.0 * static_cast<double>(index);
+  u.set_time(time);
+  u.set_x(radius * cos(angle));
+  u.set_y(radius * sin(angle));
+  u.set_z(1000.0 * static_cast<double>(index % 7) - 3000.0);
+  // Some platforms have no orientation or velocity; yaw crosses north for the others
+  if (index % 5 != 1)
+  {
+    u.set_psi(angle + time);
+    u.set_theta(0.1 * time - 0.2);
+    u.set_phi(-time);
+  }
+  if (index % 5 != 2)
+  {
+    u.set_vx(10.0 * time);
+    u.set_vy(-20.0);
+    u.set_vz(static_cast<double>(index));
+  }
+}
+
+void assertClose(const simData::PlatformUpdate& expected, const simData::PlatformUpdate& actual)
+{
+  assertEquals(expected.time(), actual.time());
+  assertTrue(simCore::areEqual(expected.x(), actual.x(), 1e-6) && simCore::areEqual(expected.y(), actual.y(), 1e-6) && simCore::areEqual(expected.z(), actual.z(), 1e-6));
+  assertEquals(expected.has_orientation(), actual.has_orientation());
+  assertTrue(simCore::areEqual(expected.psi(), actual.psi(), 1e-9) && simCore::areEqual(expected.theta(), actual.theta(), 1e-9) && simCore::areEqual(expected.phi(), actual.phi(), 1e-9));
+  assertEquals(expected.has_velocity(), actual.has_velocity());
+  assertTrue(simCore::areEqual(expected.vx(), actual.vx(), 1e-9) && simCore::areEqual(expected.vy(), actual.vy(), 1e-9) && simCore::areEqual(expected.vz(), actual.vz(), 1e-9));
+}
+
+/// Fills in a platform update on a circular orbit in the equatorial plane, with its exact velocity
+void makeOrbitUpdate(double time, simData::PlatformUpdate& u)
+{
+  const double radius = simCore::WGS_A + 300000.0;
+  const double rate = 0.001;
+  u.set_time(time);
+  u.set_x(radius * cos(rate * time));
+  u.set_y(radius * sin(rate * time));
+  u.set_z(0.0);
+  u.set_vx(-radius * rate * sin(rate * time));
+  u.set_vy(radius * rate * cos(rate * time));
+  u.set_vz(0.0);
+  u.set_psi(rate * time);
+  u.set_theta(0.0);
+  u.set_phi(0.0);
+}
+
+void testInterpolation_hermite()
+{
+  simData::HermiteInterpolator hermite;
+  simData::LinearInterpolator linear;
+  simData::PlatformUpdate prev;
+  simData::PlatformUpdate next;
+  simData::PlatformUpdate truth;
+  simData::PlatformUpdate result;
+  simData::PlatformUpdate linearResult;
+
+  // Points 60 seconds apart on a curved track; the curve stays far closer to the track than the chord
+  makeOrbitUpdate(0.0, prev);
+  makeOrbitUpdate(60.0, next);
+  double hermiteError = 0.0;
+  double linearError = 0.0;
+  for (double time = 5.0; time < 60.0; time += 5.0)
+  {
+    makeOrbitUpdate(time, truth);
+    assertTrue(hermite.interpolate(time, prev, next, &result));
+    linear.interpolate(time, prev, next, &linearResult);
+    assertEquals(result.time(), time);
+    hermiteError = std::max(hermiteError, simCore::v3Distance(simCore::Vec3(truth.x(), truth.y(), truth.z()), simCore::Vec3(result.x(), result.y(), result.z())));
+    linearError = std::max(linearError, simCore::v3Distance(simCore::Vec3(truth.x(), truth.y(), truth.z()), simCore::Vec3(linearResult.x(), linearResult.y(), linearResult.z())));
+    // Velocity is the derivative of the curve
+    assertTrue(simCore::v3Distance(simCore::Vec3(truth.vx(), truth.vy(), truth.vz()), simCore::Vec3(result.vx(), result.vy(), result.vz())) < 1.0);
+    assertTrue(simCore::areAnglesEqual(result.psi(), truth.psi()));
+  }
+  assertTrue(hermiteError < 1.0);
+  assertTrue(hermiteError * 10.0 < linearError);
+
+  // Ends match the points, including their velocities
+  hermite.interpolate(0.0, prev, next, &result);
+  assertTrue(simCore::areEqual(result.x(), prev.x()) && simCore::areEqual(result.y(), prev.y()) && simCore::areEqual(result.vy(), prev.vy()));
+  hermite.interpolate(60.0, prev, next, &result);
+  assertTrue(simCore::areEqual(result.x(), next.x()) && simCore::areEqual(result.y(), next.y()) && simCore::areEqual(result.vx(), next.vx()));
+
+  // A different segment gives a different curve
+  hermite.interpolate(30.0, prev, next, &result);
+  const double middleX = result.x();
+  makeOrbitUpdate(120.0, next);
+  hermite.interpolate(30.0, prev, next, &result);
+  assertTrue(result.x() != middleX);
+
+  // Without velocity on both points, the result is linear
+  simData::PlatformUpdate noVelocity = prev;
+  noVelocity.clear_vx();
+  hermite.interpolate(20.0, noVelocity, next, &result);
+  linear.interpolate(20.0, noVelocity, next, &linearResult);
+  assertEquals(result.x(), linearResult.x());
+  assertEquals(result.y(), linearResult.y());
+  assertEquals(result.has_velocity(), linearResult.has_velocity());
+
+  // Works through the data store
+  simUtil::DataStoreTestHelper testHelper;
+  simData::DataStore* ds = testHelper.dataStore();
+  ds->setInterpolator(&hermite);
+  ds->enableInterpolation(true);
+  const uint64_t platId = testHelper.addPlatform();
+  for (double time : { 0.0, 60.0 })
+  {
+    simData::DataStore::Transaction t;
+    makeOrbitUpdate(time, *ds->addPlatformUpdate(platId, &t));
+    t.commit();
+  }
+  ds->update(25.0);
+  const simData::PlatformUpdateSlice* slice = ds->platformUpdateSlice(platId);
+  assertTrue(slice->current() != nullptr && slice->isInterpolated());
+  makeOrbitUpdate(25.0, truth);
+  assertTrue(simCore::v3Distance(simCore::Vec3(truth.x(), truth.y(), truth.z()), simCore::Vec3(slice->current()->x(), slice->current()->y(), slice->current()->z())) < 1.0);
+}
+
+/// Fills in an ECEF platform update from geodetic position, local orientation and ENU velocity
+void makeGeodeticUpdate(double time, const simCore::Vec3& lla, const simCore::Vec3& ori, const simCore::Vec3& vel, simData::PlatformUpdate& u)
+{
+  simCore::Coordinate ecef;
+  simCore::CoordinateConverter::convertGeodeticToEcef(simCore::Coordinate(simCore::COORD_SYS_LLA, lla, ori, vel), ecef);
+  u.set_time(time);
+  u.set_x(ecef.x());
+  u.set_y(ecef.y());
+  u.set_z(ecef.z());
+  u.set_psi(ecef.psi());
+  u.set_theta(ecef.theta());
+  u.set_phi(ecef.phi());
+  u.set_vx(ecef.vx());
+  u.set_vy(ecef.vy());
+  u.set_vz(ecef.vz());
+}
+
+/// Converts the position of an update to geodetic
+simCore::Vec3 toLla(const simData::PlatformUpdate& u)
+{
+  simCore::Vec3 lla;
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(simCore::Vec3(u.x(), u.y(), u.z()), lla);
+  return lla;
+}
+
+void testInterpolation_geodesic()
+{
+  simData::GeodesicInterpolator geodesic;
+  simData::PlatformUpdate prev;
+  simData::PlatformUpdate next;
+  simData::PlatformUpdate result;
+
+  // Widely spaced points: positions stay on the geodesic and advance at a constant rate
+  const simCore::Vec3 start(40.0 * simCore::DEG2RAD, 0.0, 1000.0);
+  const simCore::Vec3 end(40.0 * simCore::DEG2RAD, 60.0 * simCore::DEG2RAD, 3000.0);
+  makeGeodeticUpdate(0.0, start, simCore::Vec3(), simCore::Vec3(100.0, 0.0, 0.0), prev);
+  makeGeodeticUpdate(100.0, end, simCore::Vec3(), simCore::Vec3(100.0, 0.0, 0.0), next);
+  const double total = simCore::sodanoInverse(start.lat(), start.lon(), 0.0, end.lat(), end.lon());
+  for (double factor : { 0.1, 0.25, 0.5, 0.9 })
+  {
+    assertTrue(geodesic.interpolate(100.0 * factor, prev, next, &result));
+    const simCore::Vec3 lla = toLla(result);
+    const double fromStart = simCore::sodanoInverse(start.lat(), start.lon(), 0.0, lla.lat(), lla.lon());
+    const double toEnd = simCore::sodanoInverse(lla.lat(), lla.lon(), 0.0, end.lat(), end.lon());
+    assertTrue(std::abs(fromStart - factor * total) < 1.0);
+    assertTrue(std::abs(fromStart + toEnd - total) < 1.0);
+    assertTrue(simCore::areEqual(lla.alt(), 1000.0 + 2000.0 * factor, 1e-3));
+    // The route bends north of the starting latitude
+    assertTrue(lla.lat() > start.lat());
+  }
+  // Ends are copies of the points
+  assertTrue(!geodesic.interpolate(100.0, prev, next, &result));
+  assertEquals(result.x(), next.x());
+  assertEquals(result.y(), next.y());
+
+  // Orientation takes the short way around north in the local frame
+  const simCore::Vec3 nearby(40.0 * simCore::DEG2RAD, 0.0001, 1000.0);
+  makeGeodeticUpdate(0.0, start, simCore::Vec3(350.0 * simCore::DEG2RAD, 0.0, 0.0), simCore::Vec3(10.0, 0.0, 0.0), prev);
+  makeGeodeticUpdate(10.0, nearby, simCore::Vec3(30.0 * simCore::DEG2RAD, 0.0, 0.0), simCore::Vec3(30.0, 0.0, 0.0), next);
+  geodesic.interpolate(5.0, prev, next, &result);
+  simCore::Coordinate resultLla;
+  simCore::CoordinateConverter::convertEcefToGeodetic(simCore::Coordinate(simCore::COORD_SYS_ECEF, simCore::Vec3(result.x(), result.y(), result.z()),
+    simCore::Vec3(result.psi(), result.theta(), result.phi()), simCore::Vec3(result.vx(), result.vy(), result.vz())), resultLla);
+  assertTrue(simCore::areAnglesEqual(resultLla.yaw(), 10.0 * simCore::DEG2RAD, 1e-4));
+  assertTrue(simCore::areEqual(resultLla.vx(), 20.0, 1e-3));
+
+  // Repeated interpolation within a segment reuses it
+  const uint64_t misses = geodesic.cacheMisses();
+  geodesic.interpolate(6.0, prev, next, &result);
+  geodesic.interpolate(7.0, prev, next, &result);
+  assertEquals(geodesic.cacheMisses(), misses);
+  assertTrue(geodesic.cacheHits() >= 2);
+}
+
+void testInterpolation_batch()
+{
+  // Batch results match the points interpolated one at a time, including angle wraps both ways
+  const size_t numPoints = 37;
+  std::vector<simCore::MultiFrameCoordinate> prev(numPoints);
+  std::vector<simCore::MultiFrameCoordinate> next(numPoints);
+  std::vector<simData::PlatformUpdate> results(numPoints);
+  simData::PlatformInterpolationBatch batch;
+  for (size_t ii = 0; ii < numPoints; ++ii)
+  {
+    simData::PlatformUpdate prevUpdate;
+    simData::PlatformUpdate nextUpdate;
+    makeBatchUpdate(1.0, ii, prevUpdate);
+    makeBatchUpdate(5.0, ii, nextUpdate);
+    // Some points have orientation or velocity on only one side
+    if (ii % 11 == 3)
+      nextUpdate.clear_psi();
+    if (ii % 11 == 4)
+      prevUpdate.clear_vx();
+
+    simCore::Coordinate prevEcef(simCore::COORD_SYS_ECEF, simCore::Vec3(prevUpdate.x(), prevUpdate.y(), prevUpdate.z()));
+    simCore::Coordinate nextEcef(simCore::COORD_SYS_ECEF, simCore::Vec3(nextUpdate.x(), nextUpdate.y(), nextUpdate.z()));
+    if (prevUpdate.has_orientation())
+      prevEcef.setOrientation(prevUpdate.psi(), prevUpdate.theta(), prevUpdate.phi());
+    if (nextUpdate.has_orientation())
+      nextEcef.setOrientation(nextUpdate.psi(), nextUpdate.theta(), nextUpdate.phi());
+    if (prevUpdate.has_velocity())
+      prevEcef.setVelocity(prevUpdate.vx(), prevUpdate.vy(), prevUpdate.vz());
+    if (nextUpdate.has_velocity())
+      nextEcef.setVelocity(nextUpdate.vx(), nextUpdate.vy(), nextUpdate.vz());
+    prev[ii].setCoordinate(prevEcef);
+    next[ii].setCoordinate(nextEcef);
+
+    const double factor = static_cast<double>(ii % 10) / 9.0;
+    batch.add(1.0 + 4.0 * factor, factor, prev[ii].ecefCoordinate(), prev[ii].llaCoordinate(), next[ii].ecefCoordinate(), next[ii].llaCoordinate(), &results[ii]);
+  }
+  assertEquals(batch.size(), numPoints);
+  batch.interpolate();
+  assertEquals(batch.size(), static_cast<size_t>(0));
+
+  for (size_t ii = 0; ii < numPoints; ++ii)
+  {
+    const double factor = static_cast<double>(ii % 10) / 9.0;
+    simData::PlatformUpdate expected;
+    simData::PlatformInterpolationBatch::interpolate(1.0 + 4.0 * factor, factor, prev[ii].ecefCoordinate(), prev[ii].llaCoordinate(), next[ii].ecefCoordinate(), next[ii].llaCoordinate(), expected);
+    assertClose(expected, results[ii]);
+  }
+
+  // The data store's internal interpolation matches the LinearInterpolator, serially and with an update pool
+  for (unsigned int threads : { 1u, 4u })
+  {
+    simData::LinearInterpolator interpolator;
+    simUtil::DataStoreTestHelper internalHelper;
+    simUtil::DataStoreTestHelper externalHelper;
+    simData::MemoryDataStore* internalDs = dynamic_cast<simData::MemoryDataStore*>(internalHelper.dataStore());
+    simData::DataStore* externalDs = externalHelper.dataStore();
+    assertTrue(internalDs != nullptr);
+    internalDs->setUpdateThreadCount(threads);
+    internalDs->setInterpolator(&interpolator);
+    internalDs->enableInterpolation(simData::DataStore::InterpolatorState::INTERNAL);
+    externalDs->setInterpolator(&interpolator);
+    externalDs->enableInterpolation(simData::DataStore::InterpolatorState::EXTERNAL);
+
+    std::vector<uint64_t> internalIds;
+    std::vector<uint64_t> externalIds;
+    for (size_t ii = 0; ii < 200; ++ii)
+    {
+      internalIds.push_back(internalHelper.addPlatform());
+      externalIds.push_back(externalHelper.addPlatform());
+      for (double time : { 0.0, 10.0, 20.0 })
+      {
+        simData::DataStore::Transaction t;
+        makeBatchUpdate(time, ii, *internalDs->addPlatformUpdate(internalIds.back(), &t));
+        t.commit();
+        makeBatchUpdate(time, ii, *externalDs->addPlatformUpdate(externalIds.back(), &t));
+        t.commit();
+      }
+    }
+
+    for (double time : { 2.5, 7.25, 10.0, 13.0, 19.5, 1.0 })
+    {
+      internalDs->update(time);
+      externalDs->update(time);
+      for (size_t ii = 0; ii < internalIds.size(); ++ii)
+      {
+        const simData::PlatformUpdateSlice* internalSlice = internalDs->platformUpdateSlice(internalIds[ii]);
+        const simData::PlatformUpdateSlice* externalSlice = externalDs->platformUpdateSlice(externalIds[ii]);
+        assertTrue(internalSlice->current() != nullptr && externalSlice->current() != nullptr);
+        assertEquals(internalSlice->isInterpolated(), externalSlice->isInterpolated());
+        assertTrue(internalSlice->hasChanged());
+        assertClose(*externalSlice->current(), *internalSlice->current());
+      }
+    }
+  }
+}
+
 }
 
 int TestInterpolation(int argc, char* argv[])
@@ -608,6 +911,9 @@ int TestInterpolation(int argc, char* argv[])
     testInterpolation_linearAngle();
     testNoInterpolationForIndividualPlatform();
     testNoInterpolationLifeSpan();
+    testInterpolation_batch();
+    testInterpolation_hermite();
+    testInterpolation_geodesic();
 
     return 0;
   }
@@ -21,14 +21,22 @@
  *
  */
 #include <cfloat>
+#include <filesystem>
 #include <iostream>
 #include <limits>
+#include <map>
+#include <set>
+#include <thread>
 #include <vector>
 
 #include "simCore/Common/Version.h"
 #include "simCore/Time/ClockImpl.h"
 #include "simCore/Common/Common.h"
 #include "simData/DataStoreHelpers.h"
+#include "simData/DataTable.h"
+#include "simData/CategoryData/CategoryNameManager.h"
+#include "simData/CategoryData/CategoryValueIndex.h"
+#include "simData/IngestQueue.h"
 #include "simData/LinearInterpolator.h"
 #include "simData/MemoryDataStore.h"
 #include "simCore/Common/SDKAssert.h"
@@ -1978,6 +1986,808 @@ int testDataStorePlatformLifespan()
   return rv;
 }
 
+/// Adds platforms with beams, target beams, target gates and lasers for testParallelUpdate()
+void addParallelUpdateScenario(simData::MemoryDataStore& ds, std::vector<simData::ObjectId>& timeRangeIds)
+{
+  simUtil::DataStoreTestHelper testHelper(&ds);
+  const int numPlatforms = 40;
+  std::vector<simData::ObjectId> platforms;
+  for (int ii = 0; ii < numPlatforms; ++ii)
+  {
+    const simData::ObjectId platId = testHelper.addPlatform();
+    platforms.push_back(platId);
+    // Stagger the start times so that some platforms are not active at the early test times
+    for (int jj = 0; jj < 10; ++jj)
+      testHelper.addPlatformUpdate(ii * 0.1 + jj, platId);
+    ds.installSliceTimeRangeMonitor(platId, [platId, &timeRangeIds](double, double) { timeRangeIds.push_back(platId); });
+  }
+
+  for (int ii = 0; ii < numPlatforms; ++ii)
+  {
+    const simData::ObjectId beamId = testHelper.addBeam(platforms[ii]);
+    for (int jj = 0; jj < 5; ++jj)
+      testHelper.addBeamUpdate(ii * 0.2 + jj * 2, beamId);
+
+    const simData::ObjectId targetBeamId = testHelper.addBeam(platforms[ii], 0, true);
+    simData::BeamPrefs prefs;
+    prefs.set_targetid(platforms[(ii + 1) % numPlatforms]);
+    testHelper.updateBeamPrefs(prefs, targetBeamId);
+
+    const simData::ObjectId gateId = testHelper.addGate(targetBeamId, 0, true);
+    for (int jj = 0; jj < 5; ++jj)
+      testHelper.addGateUpdate(ii * 0.3 + jj * 2, gateId);
+
+    const simData::ObjectId laserId = testHelper.addLaser(platforms[ii]);
+    for (int jj = 0; jj < 5; ++jj)
+      testHelper.addLaserUpdate(ii * 0.1 + jj * 2, laserId);
+  }
+}
+
+/// Compares the current value of each slice of the given type between the two data stores
+template <typename SliceType>
+int compareCurrent(const SliceType* serial, const SliceType* parallel)
+{
+  if ((serial == nullptr) || (parallel == nullptr))
+    return 1;
+  if ((serial->current() == nullptr) || (parallel->current() == nullptr))
+    return SDK_ASSERT(serial->current() == parallel->current());
+  int rv = SDK_ASSERT(serial->current()->time() == parallel->current()->time());
+  rv += SDK_ASSERT(serial->hasChanged() == parallel->hasChanged());
+  return rv;
+}
+
+int testParallelUpdate()
+{
+  int rv = 0;
+
+  simData::MemoryDataStore serialDs;
+  simData::MemoryDataStore parallelDs;
+  rv += SDK_ASSERT(parallelDs.updateThreadCount() == 1);
+  parallelDs.setUpdateThreadCount(4);
+  parallelDs.setParallelUpdateThreshold(1);
+  rv += SDK_ASSERT(parallelDs.updateThreadCount() == 4);
+  rv += SDK_ASSERT(parallelDs.parallelUpdateThreshold() == 1);
+
+  std::vector<simData::ObjectId> serialTimeRangeIds;
+  std::vector<simData::ObjectId> parallelTimeRangeIds;
+  addParallelUpdateScenario(serialDs, serialTimeRangeIds);
+  addParallelUpdateScenario(parallelDs, parallelTimeRangeIds);
+
+  simData::LinearInterpolator interpolator;
+  for (auto* ds : { &serialDs, &parallelDs })
+  {
+    ds->setInterpolator(&interpolator);
+    ds->enableInterpolation(true);
+  }
+
+  for (double time : { 0.0, 0.55, 1.0, 2.25, 4.0, 5.5, 9.95, 20.0, 3.3 })
+  {
+    serialDs.update(time);
+    parallelDs.update(time);
+
+    simData::DataStore::IdList ids;
+    serialDs.idList(&ids);
+    for (simData::ObjectId id : ids)
+    {
+      switch (serialDs.objectType(id))
+      {
+      case simData::PLATFORM:
+      {
+        rv += compareCurrent(serialDs.platformUpdateSlice(id), parallelDs.platformUpdateSlice(id));
+        const simData::PlatformUpdate* serialUpdate = serialDs.platformUpdateSlice(id)->current();
+        const simData::PlatformUpdate* parallelUpdate = parallelDs.platformUpdateSlice(id)->current();
+        if (serialUpdate && parallelUpdate)
+          rv += SDK_ASSERT(serialUpdate->x() == parallelUpdate->x());
+        break;
+      }
+      case simData::BEAM:
+        rv += compareCurrent(serialDs.beamUpdateSlice(id), parallelDs.beamUpdateSlice(id));
+        break;
+      case simData::GATE:
+        rv += compareCurrent(serialDs.gateUpdateSlice(id), parallelDs.gateUpdateSlice(id));
+        break;
+      case simData::LASER:
+        rv += compareCurrent(serialDs.laserUpdateSlice(id), parallelDs.laserUpdateSlice(id));
+        break;
+      default:
+        break;
+      }
+    }
+  }
+
+  // Time range callbacks happen on this thread in the same order as a serial update
+  rv += SDK_ASSERT(!serialTimeRangeIds.empty());
+  rv += SDK_ASSERT(serialTimeRangeIds == parallelTimeRangeIds);
+
+  // Turning off the threads returns to a serial update
+  parallelDs.setUpdateThreadCount(0);
+  rv += SDK_ASSERT(parallelDs.updateThreadCount() == 1);
+  parallelDs.update(1.5);
+  serialDs.update(1.5);
+  rv += compareCurrent(serialDs.platformUpdateSlice(1), parallelDs.platformUpdateSlice(1));
+
+  return rv;
+}
+
+/// Returns the time of the current platform update, or -1 if there is no current update
+double currentTime(const simData::MemoryDataStore& ds, simData::ObjectId id)
+{
+  const simData::PlatformUpdate* current = ds.platformUpdateSlice(id)->current();
+  return (current == nullptr) ? -1.0 : current->time();
+}
+
+/// Verifies that entities skipped by update() because their state did not change still track slice, preference and mode changes
+int testIncrementalUpdate()
+{
+  int rv = 0;
+
+  simData::MemoryDataStore ds;
+  simUtil::DataStoreTestHelper testHelper(&ds);
+
+  CategoryChangeCounter* categoryCounter = new CategoryChangeCounter();
+  ds.addListener(simData::DataStore::ListenerPtr(categoryCounter));
+
+  // Platforms with different life spans so some are quiet while others change
+  const simData::ObjectId early = testHelper.addPlatform();
+  const simData::ObjectId late = testHelper.addPlatform();
+  const simData::ObjectId hidden = testHelper.addPlatform();
+  for (int ii = 0; ii < 5; ++ii)
+  {
+    testHelper.addPlatformUpdate(ii, early);
+    testHelper.addPlatformUpdate(10.0 + ii, late);
+    testHelper.addPlatformUpdate(ii, hidden);
+  }
+  testHelper.addCategoryData(early, "key", "value0", 0.0);
+  testHelper.addCategoryData(early, "key", "value1", 2.0);
+
+  simData::PlatformCommand command;
+  command.set_time(3.0);
+  command.mutable_updateprefs()->mutable_commonprefs()->set_datadraw(false);
+  testHelper.addPlatformCommand(command, hidden);
+
+  ds.update(0.5);
+  rv += SDK_ASSERT(currentTime(ds, early) == 0.0);
+  rv += SDK_ASSERT(currentTime(ds, late) == -1.0);
+  rv += SDK_ASSERT(currentTime(ds, hidden) == 0.0);
+  rv += SDK_ASSERT(categoryCounter->counter() == 1);
+  categoryCounter->clearCounter();
+
+  // Repeated and small steps leave the state alone but still clear the changed flags
+  ds.update(0.75);
+  ds.update(0.8);
+  rv += SDK_ASSERT(currentTime(ds, early) == 0.0);
+  rv += SDK_ASSERT(!ds.platformUpdateSlice(early)->hasChanged());
+  rv += SDK_ASSERT(categoryCounter->counter() == 0);
+
+  // Forward across points, category data and the datadraw command
+  ds.update(3.5);
+  rv += SDK_ASSERT(currentTime(ds, early) == 3.0);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(early)->hasChanged());
+  rv += SDK_ASSERT(currentTime(ds, late) == -1.0);
+  rv += SDK_ASSERT(currentTime(ds, hidden) == -1.0);
+  rv += SDK_ASSERT(categoryCounter->counter() == 1);
+  categoryCounter->clearCounter();
+
+  // Past the end of the first platform and into the second
+  ds.update(12.0);
+  rv += SDK_ASSERT(currentTime(ds, early) == -1.0);
+  rv += SDK_ASSERT(currentTime(ds, late) == 12.0);
+  rv += SDK_ASSERT(categoryCounter->counter() == 0);
+
+  // Backward in time; the datadraw command still applies since commands are not undone
+  ds.update(1.5);
+  rv += SDK_ASSERT(currentTime(ds, early) == 1.0);
+  rv += SDK_ASSERT(currentTime(ds, late) == -1.0);
+  rv += SDK_ASSERT(currentTime(ds, hidden) == -1.0);
+  rv += SDK_ASSERT(categoryCounter->counter() == 1);
+  categoryCounter->clearCounter();
+
+  // New data inside the quiet range of an entity takes effect on the next update
+  testHelper.addPlatformUpdate(1.25, early);
+  testHelper.addCategoryData(early, "key", "value2", 1.25);
+  ds.update(1.5);
+  rv += SDK_ASSERT(currentTime(ds, early) == 1.25);
+  rv += SDK_ASSERT(categoryCounter->counter() == 1);
+  categoryCounter->clearCounter();
+
+  // Preference changes without a time change
+  simData::PlatformPrefs prefs;
+  prefs.mutable_commonprefs()->set_datadraw(false);
+  testHelper.updatePlatformPrefs(prefs, early);
+  ds.update(1.5);
+  rv += SDK_ASSERT(currentTime(ds, early) == -1.0);
+  prefs.mutable_commonprefs()->set_datadraw(true);
+  testHelper.updatePlatformPrefs(prefs, early);
+  ds.update(1.5);
+  rv += SDK_ASSERT(currentTime(ds, early) == 1.25);
+
+  // Live mode keeps platforms past their last point
+  ds.setDataLimiting(true);
+  ds.update(20.0);
+  rv += SDK_ASSERT(currentTime(ds, early) == 4.0);
+  rv += SDK_ASSERT(currentTime(ds, late) == 14.0);
+  ds.setDataLimiting(false);
+
+  // Turning on interpolation inside a quiet range produces interpolated values
+  simData::LinearInterpolator interpolator;
+  ds.update(1.5);
+  rv += SDK_ASSERT(currentTime(ds, early) == 1.25);
+  ds.setInterpolator(&interpolator);
+  ds.enableInterpolation(true);
+  ds.update(1.5);
+  rv += SDK_ASSERT(currentTime(ds, early) == 1.5);
+  ds.enableInterpolation(false);
+  ds.update(1.6);
+  rv += SDK_ASSERT(currentTime(ds, early) == 1.25);
+
+  // Removed entities no longer take part
+  ds.removeEntity(early);
+  ds.update(12.5);
+  rv += SDK_ASSERT(currentTime(ds, late) == 12.0);
+
+  return rv;
+}
+
+int testIngestQueue()
+{
+  int rv = 0;
+
+  simData::IngestQueue<int> queue(3);
+  rv += SDK_ASSERT(queue.capacity() == 4);
+  int value = -1;
+  rv += SDK_ASSERT(queue.pop(value) != 0);
+
+  // Fill, overflow and empty the queue a few times to wrap around the slots
+  for (int lap = 0; lap < 3; ++lap)
+  {
+    for (int ii = 0; ii < 4; ++ii)
+      rv += SDK_ASSERT(queue.push(lap * 10 + ii) == 0);
+    rv += SDK_ASSERT(queue.push(99) != 0);
+    rv += SDK_ASSERT(queue.size() == 4);
+    for (int ii = 0; ii < 4; ++ii)
+    {
+      rv += SDK_ASSERT(queue.pop(value) == 0);
+      rv += SDK_ASSERT(value == lap * 10 + ii);
+    }
+    rv += SDK_ASSERT(queue.pop(value) != 0);
+    rv += SDK_ASSERT(queue.size() == 0);
+  }
+
+  return rv;
+}
+
+/// Counts the entity update notifications
+class EntityUpdateCounter : public simData::DataStore::DefaultNewUpdatesListener
+{
+public:
+  void onEntityUpdate(simData::DataStore* source, simData::ObjectId id, double dataTime) override
+  {
+    ++count;
+  }
+
+  void onEntityUpdates(simData::DataStore* source, simData::ObjectId id, double firstTime, double lastTime) override
+  {
+    ++batches;
+    this->firstTime = firstTime;
+    this->lastTime = lastTime;
+  }
+
+  int count = 0;
+  int batches = 0;
+  double firstTime = 0.0;
+  double lastTime = 0.0;
+};
+
+int testIngest(bool columnar)
+{
+  int rv = 0;
+
+  simData::MemoryDataStore ds;
+  ds.setColumnarPlatformStorage(columnar);
+  simUtil::DataStoreTestHelper testHelper(&ds);
+  auto counter = std::make_shared<EntityUpdateCounter>();
+  ds.addNewUpdatesListener(counter);
+
+  const size_t numPlatforms = 4;
+  std::vector<simData::ObjectId> platforms;
+  for (size_t ii = 0; ii < numPlatforms; ++ii)
+    platforms.push_back(testHelper.addPlatform());
+  const simData::ObjectId beamId = testHelper.addBeam(platforms[0]);
+  const simData::ObjectId gateId = testHelper.addGate(beamId);
+
+  // Several producers interleave updates for all the platforms
+  const int numThreads = 4;
+  const int updatesPerThread = 1000;
+  std::vector<std::thread> producers;
+  for (int thread = 0; thread < numThreads; ++thread)
+  {
+    producers.emplace_back([&ds, &platforms, thread, numPlatforms]()
+    {
+      for (int ii = 0; ii < updatesPerThread; ++ii)
+      {
+        simData::PlatformUpdate update;
+        update.set_time(ii * numThreads + thread);
+        update.set_x(thread);
+        while (ds.ingestPlatformUpdate(platforms[ii % numPlatforms], update) != 0)
+          std::this_thread::yield();
+      }
+    });
+  }
+  for (auto& producer : producers)
+    producer.join();
+
+  // Nothing reaches the slices until the queues are drained
+  rv += SDK_ASSERT(ds.platformUpdateSlice(platforms[0])->numItems() == 0);
+  rv += SDK_ASSERT(counter->batches == 0);
+  ds.update(0.0);
+  size_t total = 0;
+  for (auto id : platforms)
+  {
+    const simData::PlatformUpdateSlice* slice = ds.platformUpdateSlice(id);
+    total += slice->numItems();
+    double lastTime = -1.0;
+    auto iter = slice->lower_bound(-1.0);
+    while (iter.hasNext())
+    {
+      const double time = iter.next()->time();
+      rv += SDK_ASSERT(time > lastTime);
+      lastTime = time;
+    }
+  }
+  rv += SDK_ASSERT(total == numThreads * updatesPerThread);
+  // One notification for the records of each platform
+  rv += SDK_ASSERT(counter->batches == numPlatforms);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(platforms[0])->current() != nullptr);
+
+  // The last record for a time replaces the earlier ones
+  simData::PlatformUpdate update;
+  update.set_time(0.0);
+  update.set_x(100.0);
+  rv += SDK_ASSERT(ds.ingestPlatformUpdate(platforms[0], update) == 0);
+  update.set_x(200.0);
+  rv += SDK_ASSERT(ds.ingestPlatformUpdate(platforms[0], update) == 0);
+  // Records for unknown entities are dropped on drain
+  rv += SDK_ASSERT(ds.ingestPlatformUpdate(9999, update) == 0);
+  rv += SDK_ASSERT(ds.drainIngestQueues() == 3);
+  ds.update(0.5);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(platforms[0])->current()->x() == 200.0);
+
+  // Beams, gates, category and generic data
+  simData::BeamUpdate beamUpdate;
+  beamUpdate.set_time(0.0);
+  beamUpdate.set_range(10.0);
+  rv += SDK_ASSERT(ds.ingestBeamUpdate(beamId, beamUpdate) == 0);
+  simData::GateUpdate gateUpdate;
+  gateUpdate.set_time(0.0);
+  gateUpdate.set_minrange(1.0);
+  rv += SDK_ASSERT(ds.ingestGateUpdate(gateId, gateUpdate) == 0);
+  simData::CategoryData category;
+  category.set_time(0.0);
+  category.add_entry()->set_key("key");
+  rv += SDK_ASSERT(ds.ingestCategoryData(platforms[1], category) == 0);
+  simData::GenericData generic;
+  generic.set_time(0.0);
+  generic.add_entry()->set_key("key");
+  rv += SDK_ASSERT(ds.ingestGenericData(0, generic) == 0);
+  ds.update(1.0);
+  rv += SDK_ASSERT(ds.beamUpdateSlice(beamId)->numItems() == 1);
+  rv += SDK_ASSERT(ds.gateUpdateSlice(gateId)->numItems() == 1);
+  std::vector<std::string> names;
+  ds.categoryDataSlice(platforms[1])->allNames(names);
+  rv += SDK_ASSERT(names.size() == 1);
+  rv += SDK_ASSERT(ds.genericDataSlice(0)->numItems() == 1);
+
+  // Data limiting is applied to the ingested records
+  simData::PlatformPrefs prefs;
+  prefs.mutable_commonprefs()->set_datalimitpoints(10);
+  testHelper.updatePlatformPrefs(prefs, platforms[2]);
+  ds.setDataLimiting(true);
+  for (int ii = 0; ii < 100; ++ii)
+  {
+    update.set_time(10000.0 + ii);
+    rv += SDK_ASSERT(ds.ingestPlatformUpdate(platforms[2], update) == 0);
+  }
+  ds.update(10099.0);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(platforms[2])->numItems() == 10);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(platforms[2])->lastTime() == 10099.0);
+
+  // A full queue rejects records instead of blocking
+  ds.setIngestQueueCapacity(2);
+  rv += SDK_ASSERT(ds.ingestQueueCapacity() == 2);
+  rv += SDK_ASSERT(ds.ingestPlatformUpdate(platforms[3], update) == 0);
+  update.set_time(20000.0);
+  rv += SDK_ASSERT(ds.ingestPlatformUpdate(platforms[3], update) == 0);
+  rv += SDK_ASSERT(ds.ingestPlatformUpdate(platforms[3], update) != 0);
+  rv += SDK_ASSERT(ds.drainIngestQueues() == 2);
+
+  return rv;
+}
+
+int testAddUpdates(bool columnar)
+{
+  int rv = 0;
+
+  simData::MemoryDataStore ds;
+  ds.setColumnarPlatformStorage(columnar);
+  simUtil::DataStoreTestHelper testHelper(&ds);
+  auto counter = std::make_shared<EntityUpdateCounter>();
+  ds.addNewUpdatesListener(counter);
+  const simData::ObjectId platformId = testHelper.addPlatform();
+  const simData::ObjectId beamId = testHelper.addBeam(platformId);
+  const simData::ObjectId gateId = testHelper.addGate(beamId);
+
+  std::vector<simData::PlatformUpdate> updates(100);
+  for (size_t ii = 0; ii < updates.size(); ++ii)
+  {
+    updates[ii].set_time(static_cast<double>(ii));
+    updates[ii].set_x(static_cast<double>(ii));
+  }
+
+  // Unknown entities are rejected without notification; empty batches do nothing
+  rv += SDK_ASSERT(ds.addPlatformUpdates(9999, updates) != 0);
+  rv += SDK_ASSERT(ds.addPlatformUpdates(platformId, {}) == 0);
+  rv += SDK_ASSERT(counter->batches == 0);
+
+  // One notification for the whole batch
+  rv += SDK_ASSERT(ds.addPlatformUpdates(platformId, updates) == 0);
+  rv += SDK_ASSERT(counter->batches == 1);
+  rv += SDK_ASSERT(counter->count == 0);
+  rv += SDK_ASSERT(counter->firstTime == 0.0 && counter->lastTime == 99.0);
+  const simData::PlatformUpdateSlice* slice = ds.platformUpdateSlice(platformId);
+  rv += SDK_ASSERT(slice->numItems() == 100);
+  ds.update(50.0);
+  rv += SDK_ASSERT(slice->current() != nullptr && slice->current()->x() == 50.0);
+
+  // Out of order batch merges with the existing data, replacing duplicate times
+  std::vector<simData::PlatformUpdate> merge(3);
+  merge[0].set_time(200.0);
+  merge[0].set_x(200.0);
+  merge[1].set_time(50.0);
+  merge[1].set_x(-50.0);
+  merge[2].set_time(10.5);
+  merge[2].set_x(10.5);
+  rv += SDK_ASSERT(ds.addPlatformUpdates(platformId, merge) == 0);
+  rv += SDK_ASSERT(counter->batches == 2);
+  rv += SDK_ASSERT(counter->firstTime == 10.5 && counter->lastTime == 200.0);
+  rv += SDK_ASSERT(slice->numItems() == 102);
+  ds.update(50.0);
+  rv += SDK_ASSERT(slice->current() != nullptr && slice->current()->x() == -50.0);
+  rv += SDK_ASSERT(slice->lastTime() == 200.0);
+
+  // Data limiting applies to the batch
+  simData::PlatformPrefs prefs;
+  prefs.mutable_commonprefs()->set_datalimitpoints(10);
+  testHelper.updatePlatformPrefs(prefs, platformId);
+  ds.setDataLimiting(true);
+  for (auto& update : updates)
+    update.set_time(update.time() + 1000.0);
+  rv += SDK_ASSERT(ds.addPlatformUpdates(platformId, updates) == 0);
+  rv += SDK_ASSERT(slice->numItems() == 10);
+  rv += SDK_ASSERT(slice->firstTime() == 1090.0);
+
+  // Beams and gates
+  std::vector<simData::BeamUpdate> beamUpdates(5);
+  for (size_t ii = 0; ii < beamUpdates.size(); ++ii)
+    beamUpdates[ii].set_time(static_cast<double>(ii));
+  rv += SDK_ASSERT(ds.addBeamUpdates(beamId, beamUpdates) == 0);
+  rv += SDK_ASSERT(ds.beamUpdateSlice(beamId)->numItems() == 5);
+  rv += SDK_ASSERT(ds.addBeamUpdates(gateId, beamUpdates) != 0);
+  std::vector<simData::GateUpdate> gateUpdates(5);
+  for (size_t ii = 0; ii < gateUpdates.size(); ++ii)
+    gateUpdates[ii].set_time(static_cast<double>(ii));
+  rv += SDK_ASSERT(ds.addGateUpdates(gateId, gateUpdates) == 0);
+  rv += SDK_ASSERT(ds.gateUpdateSlice(gateId)->numItems() == 5);
+  rv += SDK_ASSERT(counter->batches == 5);
+
+  return rv;
+}
+
+/// Copies the items of a slice
+template <typename T>
+class SliceCopier : public simData::VisitableDataSlice<T>::Visitor
+{
+public:
+  void operator()(const T* item) override
+  {
+    items.push_back(*item);
+  }
+
+  std::vector<T> items;
+};
+
+/// Returns copies of the items of a slice
+template <typename T>
+std::vector<T> sliceItems(const simData::VisitableDataSlice<T>* slice)
+{
+  SliceCopier<T> copier;
+  if (slice)
+    slice->visit(&copier);
+  return copier.items;
+}
+
+/// Returns true if the platform updates match, including which fields are set
+bool samePlatformUpdates(const std::vector<simData::PlatformUpdate>& lhs, const std::vector<simData::PlatformUpdate>& rhs)
+{
+  if (lhs.size() != rhs.size())
+    return false;
+  for (size_t ii = 0; ii < lhs.size(); ++ii)
+  {
+    const simData::PlatformUpdate& a = lhs[ii];
+    const simData::PlatformUpdate& b = rhs[ii];
+    if (a.time() != b.time() || a.has_x() != b.has_x() || a.has_psi() != b.has_psi() || a.has_vz() != b.has_vz())
+      return false;
+    if (a.has_x() && (a.x() != b.x() || a.y() != b.y() || a.z() != b.z()))
+      return false;
+    if (a.has_psi() && (a.psi() != b.psi() || a.theta() != b.theta() || a.phi() != b.phi()))
+      return false;
+    if (a.has_vz() && (a.vx() != b.vx() || a.vy() != b.vy() || a.vz() != b.vz()))
+      return false;
+  }
+  return true;
+}
+
+int testSnapshot(bool columnar)
+{
+  int rv = 0;
+
+  simData::MemoryDataStore ds;
+  ds.setColumnarPlatformStorage(columnar);
+  simUtil::DataStoreTestHelper testHelper(&ds);
+
+  simData::DataStore::Transaction t;
+  simData::ScenarioProperties* scenario = ds.mutable_scenarioProperties(&t);
+  scenario->set_description("Snapshot test");
+  scenario->set_referenceyear(2020);
+  scenario->add_gogfile("one.gog");
+  t.commit();
+  simData::PlatformPrefs defaultPrefs;
+  defaultPrefs.set_icon("default.ive");
+  static_cast<simData::DataStore&>(ds).setDefaultPrefs(defaultPrefs);
+
+  // Removing an entity leaves a gap in the IDs, which must be kept
+  const simData::ObjectId platformId = testHelper.addPlatform(100);
+  ds.removeEntity(testHelper.addPlatform());
+  const simData::ObjectId otherPlatformId = testHelper.addPlatform(200);
+  const simData::ObjectId beamId = testHelper.addBeam(platformId);
+  const simData::ObjectId gateId = testHelper.addGate(beamId);
+  const simData::ObjectId laserId = testHelper.addLaser(platformId);
+  const simData::ObjectId lobId = testHelper.addLOB(otherPlatformId);
+  const simData::ObjectId projectorId = testHelper.addProjector(platformId);
+  const simData::ObjectId customId = testHelper.addCustomRendering(platformId);
+
+  simData::PlatformPrefs prefs;
+  prefs.mutable_commonprefs()->set_name("Snapshot Platform");
+  prefs.mutable_commonprefs()->add_acceptprojectorids(projectorId);
+  prefs.mutable_trackprefs()->set_tracklength(42);
+  testHelper.updatePlatformPrefs(prefs, platformId);
+
+  for (int ii = 0; ii < 200; ++ii)
+  {
+    testHelper.addPlatformUpdate(ii, platformId);
+    testHelper.addPlatformUpdate(ii * 0.5, otherPlatformId);
+  }
+  // Position only update
+  simData::PlatformUpdate* update = ds.addPlatformUpdate(platformId, &t);
+  update->set_time(300.0);
+  update->set_x(1.25);
+  update->set_y(2.5);
+  update->set_z(-3.75);
+  t.commit();
+  for (int ii = 0; ii < 10; ++ii)
+  {
+    testHelper.addBeamUpdate(ii, beamId);
+    testHelper.addGateUpdate(ii, gateId);
+    testHelper.addLaserUpdate(ii, laserId);
+    testHelper.addLOBUpdate(ii, lobId);
+    testHelper.addProjectorUpdate(ii, projectorId);
+  }
+
+  simData::PlatformCommand command;
+  command.set_time(5.0);
+  command.mutable_updateprefs()->mutable_commonprefs()->set_color(0xff0000ff);
+  testHelper.addPlatformCommand(command, platformId);
+  simData::BeamCommand beamCommand;
+  beamCommand.set_time(2.0);
+  beamCommand.mutable_updateprefs()->set_horizontalwidth(0.5);
+  testHelper.addBeamCommand(beamCommand, beamId);
+  simData::CustomRenderingCommand customCommand;
+  customCommand.set_time(1.0);
+  customCommand.mutable_updateprefs()->set_persistence(12.5);
+  testHelper.addCustomRenderingCommand(customCommand, customId);
+
+  testHelper.addCategoryData(platformId, "Type", "Ship", 1.0);
+  testHelper.addCategoryData(platformId, "Type", "Plane", 10.0);
+  testHelper.addCategoryData(beamId, "Mode", "Search", 0.0);
+  testHelper.addGenericData(platformId, "Key", "Value", 1.0);
+  testHelper.addGenericData(platformId, "Key", "Later", 20.0);
+  testHelper.addGenericData(0, "ScenarioKey", "ScenarioValue", 0.0);
+  testHelper.addDataTable(platformId, 5, "Platform Table");
+  testHelper.addDataTable(0, 3, "Scenario Table");
+
+  const std::string filename = (std::filesystem::temp_directory_path() / "TestMemoryDataStoreSnapshot.snap").string();
+  rv += SDK_ASSERT(ds.saveSnapshot(filename) == 0);
+
+  simData::MemoryDataStore loaded;
+  loaded.setColumnarPlatformStorage(columnar);
+  rv += SDK_ASSERT(loaded.loadSnapshot(filename) == 0);
+  // Only an empty data store can be restored
+  rv += SDK_ASSERT(loaded.loadSnapshot(filename) != 0);
+  rv += SDK_ASSERT(loaded.loadSnapshot(filename + ".missing") != 0);
+  // A truncated file fails to load
+  std::filesystem::resize_file(filename, std::filesystem::file_size(filename) / 2);
+  simData::MemoryDataStore truncated;
+  rv += SDK_ASSERT(truncated.loadSnapshot(filename) != 0);
+  std::filesystem::remove(filename);
+
+  // Same entities with the same IDs, properties and prefs
+  simData::DataStore::IdList ids;
+  simData::DataStore::IdList loadedIds;
+  ds.idList(&ids);
+  loaded.idList(&loadedIds);
+  rv += SDK_ASSERT(ids == loadedIds);
+  rv += SDK_ASSERT(*ds.scenarioProperties(&t) == *loaded.scenarioProperties(&t));
+  rv += SDK_ASSERT(static_cast<simData::DataStore&>(ds).defaultPlatformPrefs() == static_cast<simData::DataStore&>(loaded).defaultPlatformPrefs());
+  rv += SDK_ASSERT(*ds.platformProperties(platformId, &t) == *loaded.platformProperties(platformId, &t));
+  rv += SDK_ASSERT(*ds.platformPrefs(platformId, &t) == *loaded.platformPrefs(platformId, &t));
+  rv += SDK_ASSERT(*ds.platformPrefs(otherPlatformId, &t) == *loaded.platformPrefs(otherPlatformId, &t));
+  rv += SDK_ASSERT(*ds.beamProperties(beamId, &t) == *loaded.beamProperties(beamId, &t));
+  rv += SDK_ASSERT(*ds.beamPrefs(beamId, &t) == *loaded.beamPrefs(beamId, &t));
+  rv += SDK_ASSERT(*ds.gateProperties(gateId, &t) == *loaded.gateProperties(gateId, &t));
+  rv += SDK_ASSERT(*ds.laserPrefs(laserId, &t) == *loaded.laserPrefs(laserId, &t));
+  rv += SDK_ASSERT(*ds.lobGroupProperties(lobId, &t) == *loaded.lobGroupProperties(lobId, &t));
+  rv += SDK_ASSERT(*ds.projectorPrefs(projectorId, &t) == *loaded.projectorPrefs(projectorId, &t));
+  rv += SDK_ASSERT(*ds.customRenderingProperties(customId, &t) == *loaded.customRenderingProperties(customId, &t));
+  simData::DataStore::IdList named;
+  loaded.idListByName("Snapshot Platform", &named);
+  rv += SDK_ASSERT(named.size() == 1 && named.front() == platformId);
+  simData::DataStore::IdList originalIds;
+  loaded.idListByOriginalId(&originalIds, 200);
+  rv += SDK_ASSERT(originalIds.size() == 1 && originalIds.front() == otherPlatformId);
+
+  // Same updates and commands
+  rv += SDK_ASSERT(samePlatformUpdates(sliceItems(ds.platformUpdateSlice(platformId)), sliceItems(loaded.platformUpdateSlice(platformId))));
+  rv += SDK_ASSERT(samePlatformUpdates(sliceItems(ds.platformUpdateSlice(otherPlatformId)), sliceItems(loaded.platformUpdateSlice(otherPlatformId))));
+  rv += SDK_ASSERT(loaded.platformUpdateSlice(platformId)->numItems() == 201);
+  rv += SDK_ASSERT(loaded.beamUpdateSlice(beamId)->numItems() == 10);
+  rv += SDK_ASSERT(loaded.beamUpdateSlice(beamId)->lastTime() == 9.0);
+  rv += SDK_ASSERT(loaded.gateUpdateSlice(gateId)->numItems() == 10);
+  rv += SDK_ASSERT(loaded.laserUpdateSlice(laserId)->numItems() == 10);
+  rv += SDK_ASSERT(loaded.projectorUpdateSlice(projectorId)->numItems() == 10);
+  const auto lobs = sliceItems(ds.lobGroupUpdateSlice(lobId));
+  const auto loadedLobs = sliceItems(loaded.lobGroupUpdateSlice(lobId));
+  rv += SDK_ASSERT(lobs.size() == loadedLobs.size() && !lobs.empty());
+  if (!lobs.empty() && lobs.size() == loadedLobs.size())
+  {
+    rv += SDK_ASSERT(lobs.back().datapoints_size() == loadedLobs.back().datapoints_size());
+    rv += SDK_ASSERT(lobs.back().datapoints(0).range() == loadedLobs.back().datapoints(0).range());
+  }
+  const auto commands = sliceItems(loaded.platformCommandSlice(platformId));
+  rv += SDK_ASSERT(commands.size() == 1 && commands.front() == sliceItems(ds.platformCommandSlice(platformId)).front());
+  rv += SDK_ASSERT(sliceItems(loaded.beamCommandSlice(beamId)).size() == 1);
+  rv += SDK_ASSERT(sliceItems(loaded.customRenderingCommandSlice(customId)).size() == 1);
+
+  // Commands and category data apply as before
+  ds.update(15.0);
+  loaded.update(15.0);
+  rv += SDK_ASSERT(*ds.platformPrefs(platformId, &t) == *loaded.platformPrefs(platformId, &t));
+  rv += SDK_ASSERT(ds.platformUpdateSlice(platformId)->current()->x() == loaded.platformUpdateSlice(platformId)->current()->x());
+  std::vector<std::pair<std::string, std::string> > categories;
+  std::vector<std::pair<std::string, std::string> > loadedCategories;
+  ds.categoryDataSlice(platformId)->allStrings(categories);
+  loaded.categoryDataSlice(platformId)->allStrings(loadedCategories);
+  rv += SDK_ASSERT(categories == loadedCategories && !categories.empty());
+  loadedCategories.clear();
+  loaded.categoryDataSlice(beamId)->allStrings(loadedCategories);
+  rv += SDK_ASSERT(loadedCategories.size() == 1);
+  rv += SDK_ASSERT(loaded.genericDataSlice(platformId)->numItems() == ds.genericDataSlice(platformId)->numItems());
+  rv += SDK_ASSERT(loaded.genericDataSlice(0)->numItems() == 1);
+
+  // Data tables
+  rv += SDK_ASSERT(loaded.dataTableManager().tableCount() == ds.dataTableManager().tableCount());
+  const simData::DataTable* table = ds.dataTableManager().findTable(platformId, "Platform Table");
+  const simData::DataTable* loadedTable = loaded.dataTableManager().findTable(platformId, "Platform Table");
+  rv += SDK_ASSERT(table != nullptr && loadedTable != nullptr);
+  rv += SDK_ASSERT(loaded.dataTableManager().findTable(0, "Scenario Table") != nullptr);
+  if (table && loadedTable)
+  {
+    rv += SDK_ASSERT(table->columnCount() == loadedTable->columnCount());
+    const simData::TableColumn* column = table->column("Col1");
+    const simData::TableColumn* loadedColumn = loadedTable->column("Col1");
+    rv += SDK_ASSERT(column && loadedColumn && column->size() == loadedColumn->size() && column->size() == 5);
+    if (column && loadedColumn)
+    {
+      rv += SDK_ASSERT(loadedColumn->variableType() == simData::VT_DOUBLE);
+      double value = 0.0;
+      double loadedValue = 1.0;
+      column->findAtOrBeforeTime(10.0).next()->getValue(value);
+      loadedColumn->findAtOrBeforeTime(10.0).next()->getValue(loadedValue);
+      rv += SDK_ASSERT(value == loadedValue);
+    }
+  }
+
+  // New entities continue after the restored IDs
+  rv += SDK_ASSERT(simUtil::DataStoreTestHelper(&loaded).addPlatform() > customId);
+
+  return rv;
+}
+
+/// Verifies that the category value index follows update() through time changes, new data, removal and flush
+int testCategoryValueIndex()
+{
+  int rv = 0;
+
+  simData::MemoryDataStore ds;
+  simUtil::DataStoreTestHelper testHelper(&ds);
+  rv += SDK_ASSERT(ds.categoryValueIndex() == nullptr);
+
+  const simData::ObjectId first = testHelper.addPlatform();
+  const simData::ObjectId second = testHelper.addPlatform();
+  const simData::ObjectId third = testHelper.addPlatform();
+  testHelper.addCategoryData(first, "Side", "Red", 0.0);
+  testHelper.addCategoryData(first, "Side", "Blue", 10.0);
+  testHelper.addCategoryData(second, "Side", "Red", 5.0);
+  testHelper.addCategoryData(third, "Side", "Blue", 0.0);
+  testHelper.addCategoryData(third, "Type", "Ship", 0.0);
+  ds.update(1.0);
+
+  // Turning indexing on picks up the values of the last update
+  ds.setCategoryValueIndexing(true);
+  const simData::CategoryValueIndex* index = ds.categoryValueIndex();
+  rv += SDK_ASSERT(index != nullptr);
+  if (index == nullptr)
+    return rv;
+
+  const simData::CategoryNameManager& names = ds.categoryNameManager();
+  const int side = names.nameToInt("Side");
+  const int type = names.nameToInt("Type");
+  const int red = names.valueToInt("Red");
+  const int blue = names.valueToInt("Blue");
+  const int ship = names.valueToInt("Ship");
+  rv += SDK_ASSERT(index->numEntities() == 2);
+  rv += SDK_ASSERT(index->entities(side, red) == std::set<simData::ObjectId>({ first }));
+  rv += SDK_ASSERT(index->entities(side, blue) == std::set<simData::ObjectId>({ third }));
+  rv += SDK_ASSERT(index->count(type, ship) == 1);
+  rv += SDK_ASSERT(index->count(side) == 2);
+  rv += SDK_ASSERT(index->value(second, side) == simData::CategoryNameManager::NO_CATEGORY_VALUE);
+
+  // Advancing time moves entities between values
+  ds.update(6.0);
+  rv += SDK_ASSERT(index->entities(side, red) == std::set<simData::ObjectId>({ first, second }));
+  ds.update(11.0);
+  rv += SDK_ASSERT(index->entities(side, red) == std::set<simData::ObjectId>({ second }));
+  rv += SDK_ASSERT(index->entities(side, blue) == std::set<simData::ObjectId>({ first, third }));
+  std::map<int, size_t> counts;
+  index->valueCounts(side, counts);
+  rv += SDK_ASSERT(counts.size() == 2 && counts[red] == 1 && counts[blue] == 2);
+
+  // Going backwards undoes the changes
+  ds.update(1.0);
+  rv += SDK_ASSERT(index->entities(side, red) == std::set<simData::ObjectId>({ first }));
+  rv += SDK_ASSERT(index->value(first, side) == red);
+
+  // New data inside the current quiet range is picked up by the next update
+  testHelper.addCategoryData(third, "Side", "Red", 0.5);
+  ds.update(1.0);
+  rv += SDK_ASSERT(index->entities(side, red) == std::set<simData::ObjectId>({ first, third }));
+  rv += SDK_ASSERT(index->count(side, blue) == 0);
+
+  // Removed entities leave the index
+  ds.removeEntity(first);
+  rv += SDK_ASSERT(index->entities(side, red) == std::set<simData::ObjectId>({ third }));
+
+  // Flushed category data leaves the index on the next update
+  ds.flush(third, simData::DataStore::FLUSH_NONRECURSIVE, simData::DataStore::FLUSH_CATEGORY_DATA);
+  ds.update(2.0);
+  rv += SDK_ASSERT(index->count(side, red) == 0);
+  rv += SDK_ASSERT(index->count(type, ship) == 0);
+  rv += SDK_ASSERT(index->numEntities() == 0);
+
+  ds.setCategoryValueIndexing(false);
+  rv += SDK_ASSERT(ds.categoryValueIndex() == nullptr);
+
+  return rv;
+}
+
 }
 
 int TestMemoryDataStore(int argc, char* argv[])
@@ -2003,6 +2813,16 @@ int TestMemoryDataStore(int argc, char* argv[])
     rv += testOriginalId();
     rv += testDataStoreHelperPlatformLifespan();
     rv += testDataStorePlatformLifespan();
+    rv += testParallelUpdate();
+    rv += testIncrementalUpdate();
+    rv += testIngestQueue();
+    rv += testIngest(false);
+    rv += testIngest(true);
+    rv += testAddUpdates(false);
+    rv += testAddUpdates(true);
+    rv += testSnapshot(false);
+    rv += testSnapshot(true);
+    rv += testCategoryValueIndex();
     return rv;
   }
   catch (const MemDataStoreAssertException& e)
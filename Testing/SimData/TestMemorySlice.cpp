@@ -21,7 +21,17 @@
  *
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
 #include "simCore/Common/SDKAssert.h"
+#include "simData/LinearInterpolator.h"
+#include "simData/MemoryDataStore.h"
+#include "simData/PlatformMemoryDataSlice.h"
+#include "simData/SpillFile.h"
 #include "simUtil/DataStoreTestHelper.h"
 
 namespace
@@ -192,6 +202,664 @@ int testStaticPlatformUpdates()
   return rv;
 }
 
+
+void addFullPlatformUpdate(simData::DataStore* ds, uint64_t id, double time)
+{
+  simData::DataStore::Transaction t;
+  simData::PlatformUpdate *u = ds->addPlatformUpdate(id, &t);
+  u->set_time(time);
+  u->set_x(6378137.0 + time);
+  u->set_y(10.0 * time);
+  u->set_z(-time);
+  u->set_psi(0.001 * time);
+  u->set_theta(0.002 * time);
+  u->set_phi(0.003 * time);
+  u->set_vx(1.0);
+  u->set_vy(10.0);
+  u->set_vz(-1.0);
+  t.commit();
+}
+
+bool samePlatformUpdate(const simData::PlatformUpdate* lhs, const simData::PlatformUpdate* rhs)
+{
+  if (lhs == nullptr || rhs == nullptr)
+    return lhs == rhs;
+  return lhs->time() == rhs->time() && lhs->x() == rhs->x() && lhs->y() == rhs->y() && lhs->z() == rhs->z() &&
+    lhs->has_orientation() == rhs->has_orientation() && lhs->has_velocity() == rhs->has_velocity() &&
+    (!lhs->has_orientation() || (lhs->psi() == rhs->psi() && lhs->theta() == rhs->theta() && lhs->phi() == rhs->phi())) &&
+    (!lhs->has_velocity() || (lhs->vx() == rhs->vx() && lhs->vy() == rhs->vy() && lhs->vz() == rhs->vz()));
+}
+
+int testColumnarStorage()
+{
+  int rv = 0;
+
+  // Load the same data into a row store and a columnar store and compare
+  simData::MemoryDataStore rowDs;
+  simData::MemoryDataStore columnDs;
+  columnDs.setColumnarPlatformStorage(true);
+  rv += SDK_ASSERT(!rowDs.columnarPlatformStorage());
+  rv += SDK_ASSERT(columnDs.columnarPlatformStorage());
+  simUtil::DataStoreTestHelper rowHelper(&rowDs);
+  simUtil::DataStoreTestHelper columnHelper(&columnDs);
+  const uint64_t rowId = rowHelper.addPlatform();
+  const uint64_t columnId = columnHelper.addPlatform();
+
+  // Out of order, duplicate time and partial updates; more than one chunk of rows
+  for (int ii = 0; ii < 600; ii += 2)
+  {
+    addFullPlatformUpdate(&rowDs, rowId, ii);
+    addFullPlatformUpdate(&columnDs, columnId, ii);
+  }
+  for (int ii = 599; ii > 0; ii -= 2)
+  {
+    addPlatformUpdate(&rowDs, rowId, ii, 1.0, 2.0, 3.0);
+    addPlatformUpdate(&columnDs, columnId, ii, 1.0, 2.0, 3.0);
+  }
+  addPlatformUpdate(&rowDs, rowId, 10.0, 4.0, 5.0, 6.0);
+  addPlatformUpdate(&columnDs, columnId, 10.0, 4.0, 5.0, 6.0);
+
+  const simData::PlatformUpdateSlice* rowSlice = rowDs.platformUpdateSlice(rowId);
+  const simData::PlatformUpdateSlice* columnSlice = columnDs.platformUpdateSlice(columnId);
+  rv += SDK_ASSERT(columnSlice->numItems() == 600);
+  rv += SDK_ASSERT(rowSlice->numItems() == columnSlice->numItems());
+  rv += SDK_ASSERT(columnSlice->firstTime() == 0.0);
+  rv += SDK_ASSERT(columnSlice->lastTime() == 599.0);
+  rv += SDK_ASSERT(columnSlice->deltaTime(10.5) == 0.5);
+
+  // Iteration matches, and a row read twice has the same pointer
+  simData::PlatformUpdateSlice::Iterator rowIter = rowSlice->lower_bound(0.0);
+  simData::PlatformUpdateSlice::Iterator columnIter = columnSlice->lower_bound(0.0);
+  while (rowIter.hasNext() && columnIter.hasNext())
+  {
+    const simData::PlatformUpdate* peek = columnIter.peekNext();
+    rv += SDK_ASSERT(peek == columnIter.next());
+    rv += SDK_ASSERT(samePlatformUpdate(rowIter.next(), peek));
+  }
+  rv += SDK_ASSERT(!rowIter.hasNext() && !columnIter.hasNext());
+  rv += SDK_ASSERT(samePlatformUpdate(columnSlice->upper_bound(10.0).peekPrevious(), rowSlice->upper_bound(10.0).peekPrevious()));
+  rv += SDK_ASSERT(columnSlice->upper_bound(10.0).peekPrevious()->x() == 4.0);
+
+  // Row pointers outlive their iterator, and stay valid while the iterator that returned them reads a few more rows
+  const simData::PlatformUpdate* first = columnSlice->lower_bound(0.0).peekNext();
+  const simData::PlatformUpdate* tenth = columnSlice->upper_bound(10.0).peekPrevious();
+  rv += SDK_ASSERT(first == columnSlice->lower_bound(0.0).peekNext() && first->time() == 0.0);
+  rv += SDK_ASSERT(tenth == columnSlice->upper_bound(10.0).peekPrevious() && tenth->x() == 4.0);
+  {
+    auto iter = columnSlice->lower_bound(0.0);
+    const simData::PlatformUpdate* held = iter.next();
+    for (int ii = 0; ii < 3; ++ii)
+      iter.next();
+    rv += SDK_ASSERT(held->time() == 0.0);
+  }
+
+  // A scan of the whole history keeps only a few row copies
+  const simData::PlatformMemoryDataSlice* columnScanSlice = dynamic_cast<const simData::PlatformMemoryDataSlice*>(columnSlice);
+  rv += SDK_ASSERT(columnScanSlice != nullptr);
+  if (columnScanSlice)
+  {
+    const size_t beforeScan = columnScanSlice->memoryUsage();
+    for (int pass = 0; pass < 2; ++pass)
+    {
+      for (auto iter = columnSlice->lower_bound(0.0); iter.hasNext(); )
+        iter.next();
+    }
+    rv += SDK_ASSERT(columnScanSlice->memoryUsage() <= beforeScan + simData::PlatformMemoryDataSlice::ROW_COPIES * sizeof(simData::PlatformUpdate));
+  }
+
+  // Time updates, with and without interpolation
+  for (double time = -1.0; time < 602.0; time += 0.75)
+  {
+    rowDs.update(time);
+    columnDs.update(time);
+    rv += SDK_ASSERT(samePlatformUpdate(rowSlice->current(), columnSlice->current()));
+  }
+  simData::LinearInterpolator interpolator;
+  rowDs.setInterpolator(&interpolator);
+  columnDs.setInterpolator(&interpolator);
+  rowDs.enableInterpolation(true);
+  columnDs.enableInterpolation(true);
+  for (double time = 601.0; time > -1.0; time -= 0.75)
+  {
+    rowDs.update(time);
+    columnDs.update(time);
+    rv += SDK_ASSERT(samePlatformUpdate(rowSlice->current(), columnSlice->current()));
+    rv += SDK_ASSERT(rowSlice->isInterpolated() == columnSlice->isInterpolated());
+  }
+  rowDs.enableInterpolation(false);
+  columnDs.enableInterpolation(false);
+
+  // Columns use less memory, even before counting the allocator overhead of separately allocated updates; the
+  // few row copies kept for readers are not part of the storage
+  const simData::PlatformMemoryDataSlice* rowMemorySlice = dynamic_cast<const simData::PlatformMemoryDataSlice*>(rowSlice);
+  const simData::PlatformMemoryDataSlice* columnMemorySlice = dynamic_cast<const simData::PlatformMemoryDataSlice*>(columnSlice);
+  rv += SDK_ASSERT(rowMemorySlice != nullptr && columnMemorySlice != nullptr);
+  if (rowMemorySlice && columnMemorySlice)
+    rv += SDK_ASSERT(columnMemorySlice->memoryUsage() - simData::PlatformMemoryDataSlice::ROW_COPIES * sizeof(simData::PlatformUpdate) < rowMemorySlice->memoryUsage());
+
+  // Flush a range, then data limit
+  rowDs.flush(rowId, simData::DataStore::FLUSH_NONRECURSIVE, simData::DataStore::FLUSH_UPDATES, 100.0, 200.0);
+  columnDs.flush(columnId, simData::DataStore::FLUSH_NONRECURSIVE, simData::DataStore::FLUSH_UPDATES, 100.0, 200.0);
+  rv += SDK_ASSERT(columnSlice->numItems() == 500);
+  rv += SDK_ASSERT(columnSlice->upper_bound(150.0).peekPrevious()->time() == 99.0);
+  rv += SDK_ASSERT(columnSlice->upper_bound(150.0).peekNext()->time() == 200.0);
+
+  simData::DataStore::Transaction t;
+  simData::PlatformPrefs* prefs = columnDs.mutable_platformPrefs(columnId, &t);
+  prefs->mutable_commonprefs()->set_datalimitpoints(50);
+  t.commit();
+  columnDs.setDataLimiting(true);
+  for (int ii = 600; ii < 1000; ++ii)
+  {
+    addFullPlatformUpdate(&columnDs, columnId, ii);
+    columnDs.update(ii);
+    rv += SDK_ASSERT(columnSlice->current() != nullptr && columnSlice->current()->time() == ii);
+  }
+  rv += SDK_ASSERT(columnSlice->numItems() == 50);
+  rv += SDK_ASSERT(columnSlice->firstTime() == 950.0);
+
+  // Switching back to rows keeps the data
+  columnDs.setColumnarPlatformStorage(false);
+  rv += SDK_ASSERT(columnSlice->numItems() == 50);
+  rv += SDK_ASSERT(columnSlice->lower_bound(0.0).peekNext()->time() == 950.0);
+  columnDs.update(999.0);
+  rv += SDK_ASSERT(columnSlice->current() != nullptr && columnSlice->current()->time() == 999.0);
+
+  return rv;
+}
+
+/// Returns true if the slice times match the expected times, in order
+template <typename SliceType>
+bool sliceTimes(const SliceType& slice, const std::vector<double>& expected)
+{
+  std::vector<double> times;
+  auto iter = slice.lower_bound(-1e10);
+  while (iter.hasNext())
+    times.push_back(iter.next()->time());
+  return times == expected;
+}
+
+int testInsertBatch(bool columnar)
+{
+  int rv = 0;
+
+  simData::PlatformMemoryDataSlice slice;
+  slice.setColumnarStorage(columnar);
+
+  // Sorted batch appends
+  std::vector<simData::PlatformUpdate> updates(4);
+  for (size_t ii = 0; ii < updates.size(); ++ii)
+  {
+    updates[ii].set_time(static_cast<double>(ii));
+    updates[ii].set_x(static_cast<double>(ii));
+  }
+  slice.insertBatch(updates);
+  rv += SDK_ASSERT(sliceTimes(slice, { 0.0, 1.0, 2.0, 3.0 }));
+  slice.update(3.0);
+  rv += SDK_ASSERT(slice.current() != nullptr && slice.current()->x() == 3.0);
+
+  // Unsorted batch merges; the last of equal times wins, over the batch and the existing data
+  std::vector<simData::PlatformUpdate> merge(5);
+  const double mergeTimes[] = { 5.0, 1.5, 3.0, -1.0, 5.0 };
+  for (size_t ii = 0; ii < merge.size(); ++ii)
+  {
+    merge[ii].set_time(mergeTimes[ii]);
+    merge[ii].set_x(100.0 + ii);
+  }
+  slice.insertBatch(merge);
+  rv += SDK_ASSERT(sliceTimes(slice, { -1.0, 0.0, 1.0, 1.5, 2.0, 3.0, 5.0 }));
+  rv += SDK_ASSERT(slice.upper_bound(5.0).peekPrevious()->x() == 104.0);
+  // Current update was replaced, so the next update must find the new one
+  slice.update(3.0);
+  rv += SDK_ASSERT(slice.current() != nullptr && slice.current()->x() == 102.0);
+
+  // Pointer batches take ownership
+  std::vector<simData::PlatformUpdate*> owned;
+  for (int ii = 0; ii < 3; ++ii)
+  {
+    owned.push_back(new simData::PlatformUpdate);
+    owned.back()->set_time(10.0 - ii);
+  }
+  slice.insertBatch(owned);
+  rv += SDK_ASSERT(sliceTimes(slice, { -1.0, 0.0, 1.0, 1.5, 2.0, 3.0, 5.0, 8.0, 9.0, 10.0 }));
+  rv += SDK_ASSERT(slice.numItems() == 10);
+
+  // Base class implementation
+  simData::MemoryDataSlice<simData::BeamUpdate> beamSlice;
+  std::vector<simData::BeamUpdate*> beams;
+  for (double time : { 2.0, 0.0, 1.0 })
+  {
+    beams.push_back(new simData::BeamUpdate);
+    beams.back()->set_time(time);
+  }
+  beamSlice.insertBatch(beams);
+  rv += SDK_ASSERT(sliceTimes(beamSlice, { 0.0, 1.0, 2.0 }));
+  beams.clear();
+  for (double time : { 3.0, 1.0 })
+  {
+    beams.push_back(new simData::BeamUpdate);
+    beams.back()->set_time(time);
+    beams.back()->set_range(time);
+  }
+  beamSlice.insertBatch(beams);
+  rv += SDK_ASSERT(sliceTimes(beamSlice, { 0.0, 1.0, 2.0, 3.0 }));
+  rv += SDK_ASSERT(beamSlice.upper_bound(1.0).peekPrevious()->range() == 1.0);
+
+  return rv;
+}
+
+/// Returns the update at the given time of the spill test track; every third update has no velocity
+simData::PlatformUpdate spillTestUpdate(int ii)
+{
+  simData::PlatformUpdate update;
+  update.set_time(static_cast<double>(ii));
+  update.set_x(6378137.0 + 1.5 * ii);
+  update.set_y(-250.0 * ii);
+  update.set_z(1000.0);
+  update.set_psi(0.001 * ii);
+  update.set_theta(0.0);
+  update.set_phi(0.0);
+  if (ii % 3 != 0)
+  {
+    update.set_vx(1.5);
+    update.set_vy(-250.0);
+    update.set_vz(0.0);
+  }
+  return update;
+}
+
+/// Counts visited updates and checks that their times increase
+struct SpillOrderVisitor : public simData::PlatformUpdateSlice::Visitor
+{
+  void operator()(const simData::PlatformUpdate* update) override
+  {
+    inOrder = inOrder && (update->time() > lastTime);
+    lastTime = update->time();
+    ++count;
+  }
+
+  size_t count = 0;
+  double lastTime = -1.0;
+  bool inOrder = true;
+};
+
+int testSpill(bool columnar)
+{
+  int rv = 0;
+
+  auto file = std::make_shared<simData::SpillFile>();
+  rv += SDK_ASSERT(file->isOpen());
+  simData::PlatformMemoryDataSlice slice;
+  slice.setColumnarStorage(columnar);
+  simData::PlatformMemoryDataSlice reference;
+  reference.setColumnarStorage(columnar);
+  slice.setSpill(file, 100.0);
+  rv += SDK_ASSERT(slice.spillWindow() == 100.0);
+
+  // Live data keeps the window plus less than two blocks in memory
+  const int numPoints = 5000;
+  for (int ii = 0; ii < numPoints; ++ii)
+  {
+    slice.insert(spillTestUpdate(ii));
+    reference.insert(spillTestUpdate(ii));
+    slice.update(ii);
+  }
+  const size_t blockRows = simData::PlatformMemoryDataSlice::SPILL_BLOCK_ROWS;
+  rv += SDK_ASSERT(slice.spilledItems() > 0);
+  rv += SDK_ASSERT(slice.spilledItems() % blockRows == 0);
+  rv += SDK_ASSERT(numPoints - slice.spilledItems() < 2 * blockRows + 100);
+  rv += SDK_ASSERT(slice.numItems() == numPoints);
+  rv += SDK_ASSERT(slice.firstTime() == 0.0);
+  rv += SDK_ASSERT(slice.lastTime() == numPoints - 1);
+  rv += SDK_ASSERT(slice.memoryUsage() < reference.memoryUsage() / 2);
+  // Compressed to well under the 80 bytes of ten doubles per update
+  rv += SDK_ASSERT(file->liveBytes() > 0 && file->liveBytes() < slice.spilledItems() * 40);
+  rv += SDK_ASSERT(slice.current() != nullptr && slice.current()->time() == numPoints - 1);
+
+  // Updating to an old time reads back the spilled history it needs
+  const size_t spilled = slice.spilledItems();
+  slice.update(10.0);
+  rv += SDK_ASSERT(slice.current() != nullptr && samePlatformUpdate(slice.current(), reference.upper_bound(10.0).peekPrevious()));
+  rv += SDK_ASSERT(slice.spilledItems() < spilled);
+  rv += SDK_ASSERT(slice.numItems() == numPoints);
+  simData::LinearInterpolator interpolator;
+  slice.update(2500.5, &interpolator);
+  reference.update(2500.5, &interpolator);
+  rv += SDK_ASSERT(slice.isInterpolated() && samePlatformUpdate(slice.current(), reference.current()));
+  slice.update(numPoints - 1);
+  rv += SDK_ASSERT(slice.current() != nullptr && slice.current()->time() == numPoints - 1);
+
+  // More live data spills again; a seek reads back from the middle
+  for (int ii = numPoints; ii < numPoints + 100; ++ii)
+  {
+    slice.insert(spillTestUpdate(ii));
+    reference.insert(spillTestUpdate(ii));
+  }
+  rv += SDK_ASSERT(slice.spilledItems() > 0);
+
+  // Queries read spilled blocks without moving them back into the slice
+  const size_t spilledBeforeQueries = slice.spilledItems();
+  const uint64_t liveBeforeQueries = file->liveBytes();
+  simData::PlatformUpdateSlice::Iterator iter = slice.lower_bound(2000.0);
+  rv += SDK_ASSERT(iter.peekPrevious() != nullptr && iter.peekPrevious()->time() == 1999.0);
+  rv += SDK_ASSERT(samePlatformUpdate(iter.next(), reference.lower_bound(2000.0).next()));
+  rv += SDK_ASSERT(slice.upper_bound(2000.0).peekPrevious()->time() == 2000.0);
+  rv += SDK_ASSERT(slice.deltaTime(0.5) == 0.5);
+  rv += SDK_ASSERT(slice.deltaTime(1000.0) == 0.0);
+  rv += SDK_ASSERT(slice.spilledItems() == spilledBeforeQueries && file->liveBytes() == liveBeforeQueries);
+  SpillOrderVisitor visitor;
+  slice.visit(&visitor);
+  rv += SDK_ASSERT(visitor.count == numPoints + 100 && visitor.inOrder);
+  rv += SDK_ASSERT(slice.spilledItems() == spilledBeforeQueries);
+
+  // Iteration reads everything, exactly as inserted, and leaves the history spilled
+  slice.insert(spillTestUpdate(numPoints + 100));
+  reference.insert(spillTestUpdate(numPoints + 100));
+  simData::PlatformUpdateSlice::Iterator sliceIter = slice.lower_bound(-1.0);
+  simData::PlatformUpdateSlice::Iterator referenceIter = reference.lower_bound(-1.0);
+  size_t count = 0;
+  while (sliceIter.hasNext() && referenceIter.hasNext())
+  {
+    rv += SDK_ASSERT(samePlatformUpdate(sliceIter.next(), referenceIter.next()));
+    ++count;
+  }
+  rv += SDK_ASSERT(count == numPoints + 101 && !sliceIter.hasNext() && !referenceIter.hasNext());
+  rv += SDK_ASSERT(slice.spilledItems() == spilledBeforeQueries);
+
+  // Scrubbing back and forth spills the history again, reusing the released space in the file
+  uint64_t largestFile = 0;
+  for (int pass = 0; pass < 5; ++pass)
+  {
+    slice.update(5.0);
+    rv += SDK_ASSERT(slice.current() != nullptr && slice.current()->time() == 5.0);
+    slice.update(numPoints + 100);
+    rv += SDK_ASSERT(slice.spilledItems() == spilledBeforeQueries);
+    if (pass == 0)
+      largestFile = file->fileSize();
+    rv += SDK_ASSERT(file->fileSize() <= largestFile);
+  }
+  rv += SDK_ASSERT(file->liveBytes() <= file->fileSize() && file->fileSize() < 2 * file->liveBytes());
+
+  // Limits drop whole spilled blocks without reading them back
+  slice.insert(spillTestUpdate(numPoints + 101));
+  const size_t total = numPoints + 102;
+  rv += SDK_ASSERT(slice.spilledItems() == 4 * blockRows);
+  slice.limitByTime(slice.lastTime() - (2 * blockRows - 1));
+  rv += SDK_ASSERT(slice.spilledItems() == 2 * blockRows);
+  rv += SDK_ASSERT(slice.numItems() == total - 2 * blockRows);
+  rv += SDK_ASSERT(slice.firstTime() == 2 * blockRows);
+  slice.limitByPoints(static_cast<uint32_t>(total - 3 * blockRows));
+  rv += SDK_ASSERT(slice.spilledItems() == blockRows);
+  rv += SDK_ASSERT(slice.numItems() == total - 3 * blockRows);
+  rv += SDK_ASSERT(slice.firstTime() == 3 * blockRows);
+  // A limit inside a spilled block reads the block back
+  slice.limitByPoints(1000);
+  rv += SDK_ASSERT(slice.spilledItems() == 0);
+  rv += SDK_ASSERT(slice.numItems() == 1000 && slice.firstTime() == total - 1000);
+
+  // Turning spilling off reads back all history
+  slice.update(numPoints + 2000);
+  for (int ii = numPoints + 102; ii < numPoints + 2000; ++ii)
+    slice.insert(spillTestUpdate(ii));
+  rv += SDK_ASSERT(slice.spilledItems() > 0);
+  slice.setSpill(nullptr, 0.0);
+  rv += SDK_ASSERT(slice.spilledItems() == 0 && slice.spillWindow() == 0.0);
+  rv += SDK_ASSERT(slice.numItems() == 2898 && slice.firstTime() == total - 1000);
+  rv += SDK_ASSERT(file->liveBytes() == 0);
+
+  // Flush releases the spilled blocks
+  slice.setSpill(file, 100.0);
+  rv += SDK_ASSERT(slice.spilledItems() > 0);
+  slice.flush();
+  rv += SDK_ASSERT(slice.numItems() == 0 && slice.spilledItems() == 0);
+  rv += SDK_ASSERT(file->liveBytes() == 0);
+
+  return rv;
+}
+
+int testHistorySpill()
+{
+  int rv = 0;
+
+  simData::MemoryDataStore ds;
+  ds.setColumnarPlatformStorage(true);
+  rv += SDK_ASSERT(ds.historySpillWindow() == 0.0);
+  simUtil::DataStoreTestHelper helper(&ds);
+  const uint64_t before = helper.addPlatform();
+  rv += SDK_ASSERT(ds.setHistorySpill(60.0) == 0);
+  rv += SDK_ASSERT(ds.historySpillWindow() == 60.0);
+  const uint64_t after = helper.addPlatform();
+
+  // Platforms added before and after spilling is turned on both spill
+  for (int ii = 0; ii < 3000; ++ii)
+  {
+    addFullPlatformUpdate(&ds, before, ii);
+    addFullPlatformUpdate(&ds, after, ii);
+    ds.update(ii);
+  }
+  for (uint64_t id : { before, after })
+  {
+    const simData::PlatformUpdateSlice* slice = ds.platformUpdateSlice(id);
+    rv += SDK_ASSERT(slice->numItems() == 3000 && slice->firstTime() == 0.0);
+    rv += SDK_ASSERT(ds.memoryUsage(id).updates < 2 * simData::PlatformMemoryDataSlice::SPILL_BLOCK_ROWS * simData::PlatformUpdateColumns::BYTES_PER_ROW);
+  }
+
+  // Spilled history is read back for an old time
+  ds.update(5.0);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(after)->current() != nullptr && ds.platformUpdateSlice(after)->current()->x() == 6378137.0 + 5.0);
+
+  rv += SDK_ASSERT(ds.setHistorySpill(0.0) == 0);
+  rv += SDK_ASSERT(ds.historySpillWindow() == 0.0);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(before)->numItems() == 3000);
+  return rv;
+}
+
+/// Returns a point of a climbing, turning flight sampled at 10 Hz for the compression test
+simData::PlatformUpdate flightUpdate(int ii)
+{
+  const double time = ii / 10.0;
+  simData::PlatformUpdate update;
+  update.set_time(time);
+  update.set_x(4500000.0 + 200.0 * time + 30.0 * std::sin(0.01 * time));
+  update.set_y(-2000000.0 + 150.0 * time);
+  update.set_z(4000000.0 + 5.0 * time + 0.001 * time * time);
+  update.set_psi(std::fmod(0.01 * time, 6.0));
+  update.set_theta(0.05 + 0.01 * std::sin(0.1 * time));
+  update.set_phi(0.2 * std::cos(0.05 * time));
+  update.set_vx(200.0 + 0.3 * std::cos(0.01 * time));
+  update.set_vy(150.0);
+  update.set_vz(5.0 + 0.002 * time);
+  return update;
+}
+
+/// Returns true if lhs and rhs have the same fields, with values within the compression error bounds
+bool withinQuantum(const simData::PlatformUpdate& lhs, const simData::PlatformUpdate& rhs, const simData::PlatformUpdateColumns::Compression& compression)
+{
+  // Angles and velocities also carry float rounding
+  const double floatRounding = 2e-5;
+  return lhs.time() == rhs.time() &&
+    std::fabs(lhs.x() - rhs.x()) <= 0.5 * compression.positionQuantum + 1e-9 &&
+    std::fabs(lhs.y() - rhs.y()) <= 0.5 * compression.positionQuantum + 1e-9 &&
+    std::fabs(lhs.z() - rhs.z()) <= 0.5 * compression.positionQuantum + 1e-9 &&
+    std::fabs(lhs.psi() - rhs.psi()) <= 0.5 * compression.angleQuantum + 1e-6 &&
+    std::fabs(lhs.theta() - rhs.theta()) <= 0.5 * compression.angleQuantum + 1e-6 &&
+    std::fabs(lhs.phi() - rhs.phi()) <= 0.5 * compression.angleQuantum + 1e-6 &&
+    std::fabs(lhs.vx() - rhs.vx()) <= 0.5 * compression.velocityQuantum + floatRounding &&
+    std::fabs(lhs.vy() - rhs.vy()) <= 0.5 * compression.velocityQuantum + floatRounding &&
+    std::fabs(lhs.vz() - rhs.vz()) <= 0.5 * compression.velocityQuantum + floatRounding &&
+    lhs.has_vx() == rhs.has_vx();
+}
+
+int testCompression()
+{
+  int rv = 0;
+
+  const simData::PlatformUpdateColumns::Compression compression;
+  simData::PlatformMemoryDataSlice slice;
+  simData::PlatformMemoryDataSlice reference;
+  slice.setCompression(&compression);
+  rv += SDK_ASSERT(slice.compression() != nullptr);
+  slice.setColumnarStorage(true);
+  reference.setColumnarStorage(true);
+
+  const int numPoints = 20000;
+  for (int ii = 0; ii < numPoints; ++ii)
+  {
+    slice.insert(flightUpdate(ii));
+    reference.insert(flightUpdate(ii));
+  }
+  // A point between the 10 Hz samples is stored exactly, in a chunk that falls back to lossless times
+  simData::PlatformUpdate odd = flightUpdate(1000);
+  odd.set_time(100.0 + 1e-9);
+  odd.clear_vx();
+  slice.insert(odd);
+  reference.insert(odd);
+
+  rv += SDK_ASSERT(slice.numItems() == numPoints + 1);
+  rv += SDK_ASSERT(reference.memoryUsage() >= 4 * slice.memoryUsage());
+
+  // Every update decodes within the error bounds, times exactly
+  simData::PlatformUpdateSlice::Iterator sliceIter = slice.lower_bound(-1.0);
+  simData::PlatformUpdateSlice::Iterator referenceIter = reference.lower_bound(-1.0);
+  int count = 0;
+  while (sliceIter.hasNext() && referenceIter.hasNext())
+  {
+    const simData::PlatformUpdate* update = sliceIter.next();
+    const simData::PlatformUpdate* expected = referenceIter.next();
+    if (!withinQuantum(*update, *expected, compression))
+      break;
+    ++count;
+  }
+  rv += SDK_ASSERT(count == numPoints + 1);
+
+  // Time updates find the exact times, in order and out of order
+  for (int ii = 0; ii < numPoints; ii += 7)
+  {
+    slice.update(ii / 10.0);
+    rv += SDK_ASSERT(slice.current() != nullptr && slice.current()->time() == ii / 10.0);
+  }
+  slice.update(1234.5);
+  rv += SDK_ASSERT(slice.current() != nullptr && slice.current()->time() == 1234.5);
+  rv += SDK_ASSERT(slice.deltaTime(100.0 + 1e-9) == 0.0);
+  rv += SDK_ASSERT(slice.upper_bound(100.0).peekNext()->time() == 100.0 + 1e-9);
+
+  // Searches by chunk find the same rows as a search of every row, over whole and partial ranges
+  simData::PlatformUpdateColumns columns;
+  columns.setCompression(&compression);
+  for (int ii = 0; ii < 1000; ++ii)
+    columns.push_back(flightUpdate(ii / 2));
+  columns.erase(0, 10);
+  const size_t ranges[][2] = { { 0, columns.size() }, { 5, 700 }, { 64, 128 }, { 300, 301 }, { 400, 400 } };
+  for (const auto& range : ranges)
+  {
+    const auto first = columns.begin() + range[0];
+    const auto last = columns.begin() + range[1];
+    for (int ii = -2; ii < 1002; ii += 3)
+    {
+      const double time = ii / 20.0;
+      rv += SDK_ASSERT(columns.lowerBound(time, range[0], range[1]) == std::lower_bound(first, last, time, simData::UpdateComp<simData::PlatformUpdateColumns::Row>()).index());
+      rv += SDK_ASSERT(columns.upperBound(time, range[0], range[1]) == std::upper_bound(first, last, time, simData::UpdateComp<simData::PlatformUpdateColumns::Row>()).index());
+    }
+  }
+
+  // Packed chunks can be read from several threads at once
+  std::vector<simData::PlatformUpdate> expectedRows(columns.size());
+  for (size_t ii = 0; ii < columns.size(); ++ii)
+    columns.get(ii, expectedRows[ii]);
+  std::atomic<int> mismatches = 0;
+  std::vector<std::thread> readers;
+  for (size_t thread = 0; thread < 4; ++thread)
+  {
+    readers.emplace_back([&columns, &expectedRows, &mismatches, thread]() {
+      simData::PlatformUpdate row;
+      for (size_t pass = 0; pass < 20; ++pass)
+      {
+        // Each thread strides differently, so the threads keep replacing each other's decoded chunks
+        for (size_t ii = thread; ii < columns.size(); ii += 61 + thread)
+        {
+          columns.get(ii, row);
+          if (!samePlatformUpdate(&row, &expectedRows[ii]) || columns.lowerBound(row.time(), 0, columns.size()) > ii)
+            ++mismatches;
+        }
+      }
+    });
+  }
+  for (auto& reader : readers)
+    reader.join();
+  rv += SDK_ASSERT(mismatches == 0);
+
+  // Out of order inserts and trims unpack and repack chunks
+  simData::PlatformUpdate late = flightUpdate(500);
+  late.set_time(50.05);
+  slice.insert(late);
+  reference.insert(late);
+  for (int ii = numPoints; ii < numPoints + 200; ++ii)
+  {
+    slice.insert(flightUpdate(ii));
+    reference.insert(flightUpdate(ii));
+  }
+  slice.limitByPoints(numPoints);
+  reference.limitByPoints(numPoints);
+  slice.flush(1000.0, 1500.0);
+  reference.flush(1000.0, 1500.0);
+  rv += SDK_ASSERT(slice.numItems() == reference.numItems());
+  rv += SDK_ASSERT(slice.firstTime() == reference.firstTime());
+  rv += SDK_ASSERT(reference.memoryUsage() >= 4 * slice.memoryUsage());
+  sliceIter = slice.lower_bound(-1.0);
+  referenceIter = reference.lower_bound(-1.0);
+  count = 0;
+  while (sliceIter.hasNext() && referenceIter.hasNext() && withinQuantum(*sliceIter.next(), *referenceIter.next(), compression))
+    ++count;
+  rv += SDK_ASSERT(count == static_cast<int>(reference.numItems()));
+
+  // A quantum of zero stores exactly
+  simData::PlatformUpdateColumns::Compression exact;
+  exact.positionQuantum = 0.0;
+  exact.angleQuantum = 0.0;
+  exact.velocityQuantum = 0.0;
+  slice.setCompression(&exact);
+  reference.setCompression(nullptr);
+  rv += SDK_ASSERT(reference.memoryUsage() > slice.memoryUsage());
+  slice.flush();
+  reference.flush();
+  for (int ii = 0; ii < 1000; ++ii)
+  {
+    slice.insert(flightUpdate(ii));
+    reference.insert(flightUpdate(ii));
+  }
+  sliceIter = slice.lower_bound(-1.0);
+  referenceIter = reference.lower_bound(-1.0);
+  count = 0;
+  while (sliceIter.hasNext() && referenceIter.hasNext() && samePlatformUpdate(sliceIter.next(), referenceIter.next()))
+    ++count;
+  rv += SDK_ASSERT(count == 1000);
+
+  // Turning compression off keeps the stored values
+  slice.setCompression(nullptr);
+  rv += SDK_ASSERT(slice.compression() == nullptr);
+  // Also releases the reference's row copies, so that only the storage is compared
+  reference.setCompression(nullptr);
+  rv += SDK_ASSERT(slice.memoryUsage() == reference.memoryUsage());
+  rv += SDK_ASSERT(samePlatformUpdate(slice.upper_bound(10.0).peekPrevious(), reference.upper_bound(10.0).peekPrevious()));
+
+  // Data store setting applies to new platforms
+  simData::MemoryDataStore ds;
+  ds.setColumnarPlatformStorage(true);
+  ds.setPlatformCompression(&compression);
+  rv += SDK_ASSERT(ds.platformCompression() != nullptr && ds.platformCompression()->positionQuantum == compression.positionQuantum);
+  simUtil::DataStoreTestHelper helper(&ds);
+  const uint64_t id = helper.addPlatform();
+  for (int ii = 0; ii < 1000; ++ii)
+    addFullPlatformUpdate(&ds, id, ii);
+  ds.update(500.0);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(id)->current() != nullptr && ds.platformUpdateSlice(id)->current()->time() == 500.0);
+  ds.setPlatformCompression(nullptr);
+  rv += SDK_ASSERT(ds.platformCompression() == nullptr);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(id)->numItems() == 1000);
+
+  return rv;
+}
+
 }
 
 int TestMemorySlice(int argc, char* argv[])
@@ -201,6 +869,13 @@ int TestMemorySlice(int argc, char* argv[])
   rv += testDeltaTime();
   rv += duplicatePoints();
   rv += testStaticPlatformUpdates();
+  rv += testColumnarStorage();
+  rv += testInsertBatch(false);
+  rv += testInsertBatch(true);
+  rv += testSpill(false);
+  rv += testSpill(true);
+  rv += testHistorySpill();
+  rv += testCompression();
 
   return rv;
 }